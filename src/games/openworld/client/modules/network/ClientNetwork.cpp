@@ -4,6 +4,7 @@
 
 #include "ServerMessages_generated.h"
 #include "ClientNetwork.h"
+#include "network/MessageBatch.h"
 #include "core/Log.h"
 
 namespace network {
@@ -12,24 +13,37 @@ ClientNetwork::ClientNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRe
 		Super(protocolHandlerRegistry, eventBus) {
 }
 
-bool ClientNetwork::packetReceived(ENetEvent& event) {
-	flatbuffers::Verifier v(event.packet->data, event.packet->dataLength);
+void ClientNetwork::messageReceived(ENetPeer* peer, const uint8_t* data, size_t dataLength) {
+	flatbuffers::Verifier v(data, dataLength);
 
 	if (!VerifyServerMessageBuffer(v)) {
-		Log::error("Illegal server packet received with length: %i", (int)event.packet->dataLength);
-		return false;
+		Log::error("Illegal server message received with length: %i", (int)dataLength);
+		return;
 	}
-	const ServerMessage *req = GetServerMessage(event.packet->data);
+	const ServerMessage *req = GetServerMessage(data);
 	ServerMsgType type = req->data_type();
 	const char *typeName = EnumNameServerMsgType(type);
 	ProtocolHandlerPtr handler = _protocolHandlerRegistry->getHandler(type);
 	if (!handler) {
 		Log::error("No handler for server msg type %s", typeName);
-		return false;
+		return;
 	}
 	Log::debug("Received %s", typeName);
-	handler->executeWithRaw(event.peer, req->data(), (const uint8_t*)event.packet->data, event.packet->dataLength);
-	return true;
+	handler->executeWithRaw(peer, req->data(), data, dataLength);
+}
+
+bool ClientNetwork::packetReceived(ENetEvent& event) {
+	// the server coalesces all the messages of a tick into one packet - a message that can't be
+	// handled is skipped, the other messages of the packet are still dispatched
+	ENetPeer* peer = event.peer;
+	const bool valid = MessageBatch::unbatch(event.packet->data, event.packet->dataLength,
+		[this, peer] (const uint8_t* data, size_t dataLength) {
+			messageReceived(peer, data, dataLength);
+		});
+	if (!valid) {
+		Log::error("Illegal server packet received with length: %i", (int)event.packet->dataLength);
+	}
+	return valid;
 }
 
 }
@@ -11,6 +11,12 @@ namespace network {
 class ClientNetwork : public AbstractClientNetwork {
 private:
 	using Super = AbstractClientNetwork;
+
+	/**
+	 * @brief Dispatches one message of a @c MessageBatch to its protocol handler
+	 * @note Illegal messages and messages without handler are logged and dropped
+	 */
+	void messageReceived(ENetPeer* peer, const uint8_t* data, size_t dataLength);
 public:
 	ClientNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry, const core::EventBusPtr& eventBus);
 
@@ -8,18 +8,20 @@
 namespace animation {
 
 AnimationCache::AnimationCache(const voxelformat::MeshCachePtr& meshCache) :
-		_meshCache(meshCache) {
+		_meshCache(meshCache), _threadPool(2, "AnimationCache") {
 }
 
 bool AnimationCache::init() {
+	_threadPool.init();
 	return _meshCache->init();
 }
 
 void AnimationCache::shutdown() {
+	_threadPool.shutdown(true);
 	_meshCache->shutdown();
 }
 
-const voxel::Mesh* AnimationCache::getMesh(const char *fullPath) {
+AnimationCache::MeshPtr AnimationCache::getMesh(const char *fullPath) {
 	return _meshCache->getMesh(fullPath);
 }
 
@@ -32,13 +34,19 @@ bool AnimationCache::putMesh(const char* fullPath, const voxel::Mesh& mesh) {
 	return getMesh(fullPath) != nullptr;
 }
 
-bool AnimationCache::load(const core::String& filename, size_t meshIndex, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES]) {
+bool AnimationCache::load(const core::String& filename, size_t meshIndex, MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES]) {
 	meshes[meshIndex] = getMesh(filename.c_str());
 	return meshes[meshIndex] != nullptr;
 }
 
-bool AnimationCache::getMeshes(const AnimationSettings& settings, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES],
-		const std::function<bool(const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional) {
+bool AnimationCache::getMeshes(const AnimationSettings& settings, MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES],
+		const std::function<bool(MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional) {
+	// the meshes that are not yet cached are loaded in parallel - load() waits for them
+	for (size_t i = 0; i < AnimationSettings::MAX_ENTRIES; ++i) {
+		if (!settings.paths[i].empty()) {
+			_meshCache->loadAsync(settings.fullPath(i).c_str(), _threadPool);
+		}
+	}
 	int cnt = 0;
 	for (size_t i = 0; i < AnimationSettings::MAX_ENTRIES; ++i) {
 		if (settings.paths[i].empty()) {
@@ -63,8 +71,8 @@ bool AnimationCache::getMeshes(const AnimationSettings& settings, const voxel::M
 }
 
 bool AnimationCache::getModel(const AnimationSettings& settings, const char *fullPath, BoneId boneId, Vertices& vertices, Indices& indices) {
-	const voxel::Mesh* mesh = getMesh(fullPath);
-	if (mesh == nullptr) {
+	const MeshPtr& mesh = getMesh(fullPath);
+	if (!mesh) {
 		return false;
 	}
 
@@ -92,8 +100,8 @@ bool AnimationCache::getModel(const AnimationSettings& settings, const char *ful
 }
 
 bool AnimationCache::getBoneModel(const AnimationSettings& settings, Vertices& vertices, Indices& indices,
-		const std::function<bool(const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional) {
-	const voxel::Mesh* meshes[AnimationSettings::MAX_ENTRIES] {};
+		const std::function<bool(MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional) {
+	MeshPtr meshes[AnimationSettings::MAX_ENTRIES];
 	getMeshes(settings, meshes, loadAdditional);
 
 	vertices.clear();
@@ -104,7 +112,7 @@ bool AnimationCache::getBoneModel(const AnimationSettings& settings, Vertices& v
 	int meshCount = 0;
 	// merge everything into one buffer
 	for (size_t i = 0; i < AnimationSettings::MAX_ENTRIES; ++i) {
-		const voxel::Mesh *mesh = meshes[i];
+		const voxel::Mesh *mesh = meshes[i].get();
 		if (mesh == nullptr) {
 			continue;
 		}
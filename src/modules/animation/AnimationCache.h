@@ -9,6 +9,8 @@
 #include "core/Assert.h"
 #include "Vertex.h"
 #include "core/String.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
 #include <memory>
 
 namespace animation {
@@ -18,25 +20,34 @@ namespace animation {
  * @ingroup Animation
  */
 class AnimationCache : public core::IComponent {
+public:
+	using MeshPtr = voxelformat::MeshCache::MeshPtr;
 protected:
 	/**
 	 * @brief Load from cache or file and extract the mesh
 	 */
-	bool load(const core::String& filename, size_t meshIndex, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES]);
+	bool load(const core::String& filename, size_t meshIndex, MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES]);
 
 	/**
 	 * @brief Load and cache the voxel meshes that are needed to assmble the model as
 	 * defined by the given AnimationSettings
+	 * @note The meshes are loaded and extracted in parallel on the thread pool of the cache
 	 */
-	bool getMeshes(const AnimationSettings& settings, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES],
-			const std::function<bool(const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional = {});
+	bool getMeshes(const AnimationSettings& settings, MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES],
+			const std::function<bool(MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional = {});
 
 	voxelformat::MeshCachePtr _meshCache;
+	/** shut down before the mesh cache - the pending loads are referencing it */
+	core::ThreadPool _threadPool;
 
 public:
 	AnimationCache(const voxelformat::MeshCachePtr& meshCache);
 
-	const voxel::Mesh* getMesh(const char *fullPath);
+	/**
+	 * The returned mesh is shared with the mesh cache - keep the reference as long as you are using it.
+	 * @return @c nullptr if the mesh could not get loaded
+	 */
+	MeshPtr getMesh(const char *fullPath);
 	bool removeMesh(const char *fullPath);
 	bool putMesh(const char* fullPath, const voxel::Mesh& mesh);
 	bool init() override;
@@ -51,7 +62,7 @@ public:
 	 * @brief Map the bone indices to the vertices of the mesh and fill the vertex indices
 	 */
 	bool getBoneModel(const AnimationSettings& settings, Vertices& vertices, Indices& indices,
-			const std::function<bool(const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional = {});
+			const std::function<bool(MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES])>& loadAdditional = {});
 };
 
 using AnimationCachePtr = std::shared_ptr<AnimationCache>;
@@ -26,7 +26,7 @@ bool Character::initSettings(const core::String& luaString) {
 	return false;
 }
 
-bool Character::loadGlider(const AnimationCachePtr& cache, const AnimationSettings& settings, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES]) {
+bool Character::loadGlider(const AnimationCachePtr& cache, const AnimationSettings& settings, AnimationCache::MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES]) {
 	const int idx = settings.getMeshTypeIdxForName("glider");
 	if (idx < 0 || idx >= (int)AnimationSettings::MAX_ENTRIES) {
 		return false;
@@ -34,7 +34,7 @@ bool Character::loadGlider(const AnimationCachePtr& cache, const AnimationSettin
 	// TODO: model via inventory
 	const char *fullPath = "models/glider";
 	meshes[idx] = cache->getMesh(fullPath);
-	if (meshes[idx] == nullptr) {
+	if (!meshes[idx]) {
 		Log::error("Failed to load glider");
 		return false;
 	}
@@ -42,7 +42,7 @@ bool Character::loadGlider(const AnimationCachePtr& cache, const AnimationSettin
 }
 
 bool Character::initMesh(const AnimationCachePtr& cache) {
-	if (!cache->getBoneModel(_settings, _vertices, _indices, [&] (const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES]) {
+	if (!cache->getBoneModel(_settings, _vertices, _indices, [&] (AnimationCache::MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES]) {
 		return loadGlider(cache, _settings, meshes);
 	})) {
 		Log::warn("Failed to load the character model");
@@ -30,7 +30,7 @@ protected:
 	stock::ItemId _toolId = (stock::ItemId)-1;
 	ToolAnimationType _toolAnim = ToolAnimationType::None;
 
-	bool loadGlider(const AnimationCachePtr& cache, const AnimationSettings& settings, const voxel::Mesh* (&meshes)[AnimationSettings::MAX_ENTRIES]);
+	bool loadGlider(const AnimationCachePtr& cache, const AnimationSettings& settings, AnimationCache::MeshPtr (&meshes)[AnimationSettings::MAX_ENTRIES]);
 public:
 	void shutdown() override;
 	bool initMesh(const AnimationCachePtr& cache) override;
@@ -28,6 +28,8 @@ class Server;
 class AIRegistry;
 class TreeNode;
 typedef std::shared_ptr<TreeNode> TreeNodePtr;
+class CompiledTree;
+typedef std::shared_ptr<CompiledTree> CompiledTreePtr;
 
 class ICharacter;
 typedef core::SharedPtr<ICharacter> ICharacterPtr;
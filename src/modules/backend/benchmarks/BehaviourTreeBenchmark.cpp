@@ -0,0 +1,124 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "backend/entity/ai/tree/CompiledTree.h"
+#include "backend/entity/ai/tree/Idle.h"
+#include "backend/entity/ai/tree/Invert.h"
+#include "backend/entity/ai/tree/ITask.h"
+#include "backend/entity/ai/tree/Parallel.h"
+#include "backend/entity/ai/tree/PrioritySelector.h"
+#include "backend/entity/ai/tree/Sequence.h"
+#include "backend/entity/ai/tree/Succeed.h"
+#include "backend/entity/ai/condition/False.h"
+#include "backend/entity/ai/condition/True.h"
+
+namespace backend {
+
+/**
+ * @brief A leaf that alternates between running and finished - the tree doesn't just stay in one branch
+ */
+AI_TASK(BenchmarkTask) {
+	return (entity->getTime() / deltaMillis) % 3 == 0 ? ai::TreeNodeStatus::FINISHED : ai::TreeNodeStatus::RUNNING;
+}
+
+}
+
+/**
+ * @brief Ticks a few thousand entities with the same behaviour tree - once with the @c TreeNode
+ * runtime and once with the @c CompiledTree
+ */
+class BehaviourTreeBenchmark: public app::AbstractBenchmark {
+protected:
+	backend::TreeNodePtr _root;
+	backend::CompiledTreePtr _compiled;
+	std::vector<backend::AIPtr> _ais;
+
+	template<class NODE>
+	backend::TreeNodePtr create(const char* name, const char* parameters = "", const backend::ConditionPtr& condition = backend::True::get()) const {
+		typename NODE::Factory f;
+		backend::TreeNodeFactoryContext ctx(name, parameters, condition);
+		return f.create(&ctx);
+	}
+
+	/**
+	 * @brief Something like the usual animal behaviour - fleeing, attacking, wandering and idling
+	 */
+	backend::TreeNodePtr build() const {
+		const backend::TreeNodePtr& root = create<backend::PrioritySelector>("root");
+		const backend::TreeNodePtr& flee = create<backend::Sequence>("flee", "", backend::False::get());
+		flee->addChild(create<backend::BenchmarkTask>("flee1"));
+		flee->addChild(create<backend::BenchmarkTask>("flee2"));
+		root->addChild(flee);
+
+		const backend::TreeNodePtr& attack = create<backend::Invert>("attack");
+		const backend::TreeNodePtr& attackSequence = create<backend::Sequence>("attacksequence");
+		attackSequence->addChild(create<backend::BenchmarkTask>("select"));
+		attackSequence->addChild(create<backend::BenchmarkTask>("hit"));
+		attack->addChild(attackSequence);
+		root->addChild(attack);
+
+		const backend::TreeNodePtr& wander = create<backend::Parallel>("wander");
+		wander->addChild(create<backend::BenchmarkTask>("move"));
+		const backend::TreeNodePtr& look = create<backend::Succeed>("look");
+		look->addChild(create<backend::BenchmarkTask>("lookaround"));
+		wander->addChild(look);
+		root->addChild(wander);
+
+		root->addChild(create<backend::Idle>("idle", "1000"));
+		return root;
+	}
+
+	void createAIs(int amount, bool compiled) {
+		_root = build();
+		_compiled = compiled ? backend::CompiledTree::compile(_root) : backend::CompiledTreePtr();
+		_ais.clear();
+		_ais.reserve(amount);
+		// the character isn't used by the tree - and it's quite heavy because of the meta attributes
+		const backend::ICharacterPtr& chr = core::make_shared<backend::ICharacter>(1);
+		for (int i = 0; i < amount; ++i) {
+			const backend::AIPtr& ai = std::make_shared<backend::AI>(_root, _compiled);
+			ai->setCharacter(chr);
+			_ais.push_back(ai);
+		}
+	}
+
+	void tick() {
+		for (const backend::AIPtr& ai : _ais) {
+			ai->update(10, false);
+			backend::AI::execute(ai, 10);
+		}
+	}
+
+public:
+	void TearDown(benchmark::State& st) override {
+		_ais.clear();
+		_compiled = backend::CompiledTreePtr();
+		_root = backend::TreeNodePtr();
+		app::AbstractBenchmark::TearDown(st);
+	}
+};
+
+BENCHMARK_DEFINE_F(BehaviourTreeBenchmark, TreeNodes)(benchmark::State &state) {
+	createAIs((int)state.range(0), false);
+	for (auto _ : state) {
+		tick();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(BehaviourTreeBenchmark, Compiled)(benchmark::State &state) {
+	createAIs((int)state.range(0), true);
+	for (auto _ : state) {
+		tick();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(BehaviourTreeBenchmark, TreeNodes)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(BehaviourTreeBenchmark, Compiled)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
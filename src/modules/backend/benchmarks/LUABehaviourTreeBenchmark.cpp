@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "backend/entity/ai/LUAAIRegistry.h"
+#include "backend/entity/ai/tree/PrioritySelector.h"
+#include "backend/entity/ai/tree/Sequence.h"
+#include "backend/entity/ai/condition/True.h"
+#include "backend/entity/ai/zone/Zone.h"
+
+/**
+ * @brief Ticks a zone of entities with behaviour trees that are made of lua nodes and conditions - with
+ * different amounts of zone worker threads
+ */
+class LUABehaviourTreeBenchmark: public app::AbstractBenchmark {
+protected:
+	backend::AIRegistryPtr _registry;
+	backend::Zone* _zone = nullptr;
+
+	void createZone(int threads, int amount) {
+		_registry = std::make_shared<backend::LUAAIRegistry>();
+		_registry->init();
+		const char *script = ""
+			"local think = REGISTRY.createNode(\"BenchmarkThink\")\n"
+			"function think:execute(ai, deltaMillis)\n"
+			"  local sum = 0.0\n"
+			"  for i = 1, 32 do\n"
+			"    sum = sum + math.sin(i * ai:id())\n"
+			"  end\n"
+			"  if sum > 1000.0 then\n"
+			"    return FAILED\n"
+			"  end\n"
+			"  if (ai:time() // deltaMillis) % 3 == 0 then\n"
+			"    return FINISHED\n"
+			"  end\n"
+			"  return RUNNING\n"
+			"end\n"
+			"local hungry = REGISTRY.createCondition(\"BenchmarkHungry\")\n"
+			"function hungry:evaluate(ai)\n"
+			"  return ai:id() % 2 == 0\n"
+			"end\n";
+		_registry->evaluate(script, SDL_strlen(script));
+		_registry->reserveStates(threads);
+
+		const backend::TreeNodeFactoryContext rootCtx("root", "", backend::True::get());
+		const backend::TreeNodePtr& root = _registry->createNode("PrioritySelector", rootCtx);
+		const backend::ConditionFactoryContext conditionCtx("");
+		const backend::TreeNodeFactoryContext eatCtx("eat", "", _registry->createCondition("BenchmarkHungry", conditionCtx));
+		const backend::TreeNodePtr& eat = _registry->createNode("Sequence", eatCtx);
+		const backend::TreeNodeFactoryContext thinkCtx("think", "", backend::True::get());
+		eat->addChild(_registry->createNode("BenchmarkThink", thinkCtx));
+		eat->addChild(_registry->createNode("BenchmarkThink", thinkCtx));
+		root->addChild(eat);
+		root->addChild(_registry->createNode("BenchmarkThink", thinkCtx));
+
+		_zone = new backend::Zone("LUABenchmark", threads);
+		for (int i = 1; i <= amount; ++i) {
+			const backend::AIPtr& ai = std::make_shared<backend::AI>(root);
+			ai->setCharacter(core::make_shared<backend::ICharacter>(i));
+			_zone->addAI(ai);
+		}
+		// the first tick is adding the entities and binds the lua states to the worker threads
+		_zone->update(10);
+	}
+
+public:
+	void TearDown(benchmark::State& st) override {
+		delete _zone;
+		_zone = nullptr;
+		_registry = backend::AIRegistryPtr();
+		app::AbstractBenchmark::TearDown(st);
+	}
+};
+
+BENCHMARK_DEFINE_F(LUABehaviourTreeBenchmark, ZoneUpdate)(benchmark::State &state) {
+	const int amount = 500;
+	createZone((int)state.range(0), amount);
+	for (auto _ : state) {
+		_zone->update(10);
+	}
+	state.SetItemsProcessed(state.iterations() * amount);
+}
+
+BENCHMARK_REGISTER_F(LUABehaviourTreeBenchmark, ZoneUpdate)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,140 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/network/ServerMessageSender.h"
+#include "backend/network/ServerNetwork.h"
+#include "core/EventBus.h"
+#include "network/BuilderPool.h"
+#include "network/MessageBatch.h"
+#include "network/NetworkEvents.h"
+#include <stdlib.h>
+
+namespace {
+
+int allocations = 0;
+
+void* countingMalloc(size_t size) {
+	++allocations;
+	return malloc(size);
+}
+
+}
+
+/**
+ * @brief Sends entity updates from the server to a client over the loopback device and measures the
+ * messages per second and the enet allocations (packets and commands) per message
+ */
+class ServerMessageSenderBenchmark: public app::AbstractBenchmark, public core::IEventBusHandler<network::NewConnectionEvent> {
+protected:
+	core::EventBusPtr _eventBus;
+	network::ServerNetworkPtr _network;
+	network::ServerMessageSenderPtr _messageSender;
+	ENetHost* _client = nullptr;
+	ENetPeer* _serverPeer = nullptr;
+	int _received = 0;
+
+	void receive() {
+		ENetEvent event;
+		while (enet_host_service(_client, &event, 0) > 0) {
+			if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+				continue;
+			}
+			network::MessageBatch::unbatch(event.packet->data, event.packet->dataLength, [this] (const uint8_t*, size_t) {
+				++_received;
+			});
+			enet_packet_destroy(event.packet);
+		}
+	}
+
+	void send(int amount, bool flushEveryMessage) {
+		const network::Vec3 pos { 1.0f, 2.0f, 3.0f };
+		for (int i = 0; i < amount; ++i) {
+			network::PooledBuilder builder;
+			flatbuffers::FlatBufferBuilder& fbb = *builder;
+			_messageSender->sendServerMessage(_serverPeer, fbb, network::ServerMsgType::EntityUpdate,
+					network::CreateEntityUpdate(fbb, i, &pos, 0.0f, network::Animation::IDLE).Union(), 0u);
+			if (flushEveryMessage) {
+				_messageSender->flush();
+			}
+		}
+		_messageSender->flush();
+		_network->update();
+		receive();
+	}
+
+	void run(benchmark::State& state, bool flushEveryMessage) {
+		const int amount = (int)state.range(0);
+		allocations = 0;
+		_received = 0;
+		for (auto _ : state) {
+			send(amount, flushEveryMessage);
+		}
+		const int64_t messages = state.iterations() * amount;
+		state.SetItemsProcessed(messages);
+		state.counters["allocs/msg"] = benchmark::Counter((double)allocations / (double)messages);
+		state.counters["received"] = benchmark::Counter((double)_received / (double)messages);
+	}
+
+public:
+	void onEvent(const network::NewConnectionEvent& event) override {
+		_serverPeer = event.get();
+	}
+
+	void SetUp(benchmark::State& st) override {
+		app::AbstractBenchmark::SetUp(st);
+		const ENetCallbacks callbacks { countingMalloc, free, abort };
+		enet_initialize_with_callbacks(ENET_VERSION, &callbacks);
+		_eventBus = std::make_shared<core::EventBus>();
+		_eventBus->subscribe<network::NewConnectionEvent>(*this);
+		const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
+		_network = std::make_shared<network::ServerNetwork>(core::make_shared<network::ProtocolHandlerRegistry>(), _eventBus, metric);
+		_messageSender = std::make_shared<network::ServerMessageSender>(_network, metric);
+		_network->init();
+		const uint16_t port = 16337;
+		if (!_network->bind(port, "127.0.0.1")) {
+			st.SkipWithError("Failed to bind the server");
+			return;
+		}
+		_client = enet_host_create(nullptr, 1, 1, 0, 0);
+		enet_host_compress_with_range_coder(_client);
+		ENetAddress address;
+		enet_address_set_host(&address, "127.0.0.1");
+		address.port = port;
+		enet_host_connect(_client, &address, 1, 0);
+		for (int i = 0; i < 1000 && _serverPeer == nullptr; ++i) {
+			_network->update();
+			receive();
+		}
+		if (_serverPeer == nullptr) {
+			st.SkipWithError("Failed to connect to the server");
+		}
+	}
+
+	void TearDown(benchmark::State& st) override {
+		if (_client != nullptr) {
+			enet_host_destroy(_client);
+			_client = nullptr;
+		}
+		_serverPeer = nullptr;
+		_eventBus->unsubscribe<network::NewConnectionEvent>(*this);
+		_network->shutdown();
+		_messageSender = network::ServerMessageSenderPtr();
+		_network = network::ServerNetworkPtr();
+		const ENetCallbacks callbacks { malloc, free, abort };
+		enet_initialize_with_callbacks(ENET_VERSION, &callbacks);
+		app::AbstractBenchmark::TearDown(st);
+	}
+};
+
+BENCHMARK_DEFINE_F(ServerMessageSenderBenchmark, Batched)(benchmark::State &state) {
+	run(state, false);
+}
+
+BENCHMARK_DEFINE_F(ServerMessageSenderBenchmark, PacketPerMessage)(benchmark::State &state) {
+	run(state, true);
+}
+
+BENCHMARK_REGISTER_F(ServerMessageSenderBenchmark, Batched)->Arg(100)->Arg(1000);
+BENCHMARK_REGISTER_F(ServerMessageSenderBenchmark, PacketPerMessage)->Arg(100)->Arg(1000);
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "backend/entity/ai/movement/SteeringBatch.h"
+#include "backend/entity/ai/movement/SteeringQueue.h"
+#include "backend/entity/ai/movement/TargetFlee.h"
+#include "backend/entity/ai/movement/TargetSeek.h"
+#include "backend/entity/ai/movement/WeightedSteering.h"
+#include "core/concurrent/ThreadPool.h"
+
+/**
+ * @brief Evaluates a blended steering for a zone full of characters - one character at a time, as one batch
+ * and through the steering queue of a zone with several workers
+ */
+class SteeringBenchmark: public app::AbstractBenchmark {
+protected:
+	backend::movement::SteeringBatch _batch;
+	std::unique_ptr<backend::movement::WeightedSteering> _steering;
+
+	void create(int amount) {
+		backend::movement::WeightedSteerings s;
+		s.push_back(backend::movement::WeightedData(std::make_shared<backend::movement::TargetSeek>("10:0:10"), 0.7f));
+		s.push_back(backend::movement::WeightedData(std::make_shared<backend::movement::TargetFlee>("-10:0:-10"), 0.3f));
+		_steering.reset(new backend::movement::WeightedSteering(s));
+		_batch.clear();
+		for (int i = 1; i <= amount; ++i) {
+			const backend::AIPtr& ai = std::make_shared<backend::AI>(backend::TreeNodePtr());
+			const backend::ICharacterPtr& chr = core::make_shared<backend::ICharacter>(i);
+			chr->setPosition(glm::vec3((float)(i % 100), 0.0f, (float)(i / 100)));
+			ai->setCharacter(chr);
+			_batch.add(ai, 10.0f, 0.01f);
+		}
+	}
+
+public:
+	void TearDown(benchmark::State& st) override {
+		_batch.clear();
+		_steering.reset();
+		app::AbstractBenchmark::TearDown(st);
+	}
+};
+
+BENCHMARK_DEFINE_F(SteeringBenchmark, PerCharacter)(benchmark::State &state) {
+	const int amount = (int)state.range(0);
+	create(amount);
+	for (auto _ : state) {
+		for (int i = 0; i < amount; ++i) {
+			const backend::MoveVector& mv = _steering->execute(_batch.ais[i], _batch.speed[i]);
+			benchmark::DoNotOptimize(mv.getRotation());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * amount);
+}
+
+BENCHMARK_DEFINE_F(SteeringBenchmark, Batched)(benchmark::State &state) {
+	const int amount = (int)state.range(0);
+	create(amount);
+	backend::movement::SteeringResults results;
+	backend::movement::SteeringResults scratch;
+	for (auto _ : state) {
+		_steering->executeBatch(_batch, results, scratch);
+		benchmark::DoNotOptimize(results.rotation.data());
+	}
+	state.SetItemsProcessed(state.iterations() * amount);
+}
+
+BENCHMARK_DEFINE_F(SteeringBenchmark, Queue)(benchmark::State &state) {
+	const int amount = (int)state.range(0);
+	create(amount);
+	core::ThreadPool threadPool((size_t)state.range(1), "Steering");
+	threadPool.init();
+	backend::movement::SteeringQueue queue;
+	for (auto _ : state) {
+		for (int i = 0; i < amount; ++i) {
+			queue.push(_batch.ais[i], *_steering, 1, _batch.speed[i], 10);
+		}
+		queue.update(nullptr, threadPool);
+	}
+	threadPool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * amount);
+}
+
+BENCHMARK_REGISTER_F(SteeringBenchmark, PerCharacter)->Arg(100)->Arg(1000);
+BENCHMARK_REGISTER_F(SteeringBenchmark, Batched)->Arg(100)->Arg(1000);
+BENCHMARK_REGISTER_F(SteeringBenchmark, Queue)->Args({1000, 1})->Args({1000, 2})->Args({1000, 4});
@@ -14,6 +14,7 @@
 #include "backend/world/Map.h"
 #include "poi/PoiProvider.h"
 #include "backend/network/ServerMessageSender.h"
+#include "network/BuilderPool.h"
 #include "shared/ProtocolEnum.h"
 #include "attrib/ContainerProvider.h"
 #include <glm/trigonometric.hpp>
@@ -166,8 +167,10 @@ void Entity::broadcastAttribUpdate() {
 	}
 	core_assert_msg(dirtyCount > 0, "Unexpected dirty attributes - _dirtyAttributes and _dirtyAttributeTypes are out of sync.");
 	core_trace_scoped(BroadcastAttribUpdate);
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
 	auto iter = _dirtyAttributeTypes.begin();
-	auto attribs = _attribUpdateFBB.CreateVector<flatbuffers::Offset<network::AttribEntry>>(dirtyCount,
+	auto attribs = fbb.CreateVector<flatbuffers::Offset<network::AttribEntry>>(dirtyCount,
 		[&] (size_t i) {
 			while (iter->type == attrib::Type::NONE) {
 				++iter;
@@ -177,10 +180,10 @@ void Entity::broadcastAttribUpdate() {
 			// TODO: maybe not needed?
 			const network::AttribMode mode = network::AttribMode::Percentage;
 			const bool current = dirtyValue.current;
-			return network::CreateAttribEntry(_attribUpdateFBB, dirtyValue.type, (float)value, mode, current);
+			return network::CreateAttribEntry(fbb, dirtyValue.type, (float)value, mode, current);
 		});
-	sendToVisible(_attribUpdateFBB, network::ServerMsgType::AttribUpdate,
-			network::CreateAttribUpdate(_attribUpdateFBB, id(), attribs).Union(), true);
+	sendToVisible(fbb, network::ServerMsgType::AttribUpdate,
+			network::CreateAttribUpdate(fbb, id(), attribs).Union(), true);
 	_dirtyAttributeTypes.fill(attrib::DirtyValue{});
 }
 
@@ -222,9 +225,10 @@ void Entity::sendEntityUpdate(const EntityPtr& entity) const {
 	}
 	const glm::vec3& _pos = entity->pos();
 	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
-	_entityUpdateFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityUpdateFBB, network::ServerMsgType::EntityUpdate,
-			network::CreateEntityUpdate(_entityUpdateFBB, entity->id(), &pos, entity->orientation(), entity->animation()).Union());
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
+	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntityUpdate,
+			network::CreateEntityUpdate(fbb, entity->id(), &pos, entity->orientation(), entity->animation()).Union());
 }
 
 void Entity::sendEntitySpawn(const EntityPtr& entity) const {
@@ -234,19 +238,21 @@ void Entity::sendEntitySpawn(const EntityPtr& entity) const {
 	const glm::vec3& pos = entity->pos();
 	const network::Vec3 vec3 { pos.x, pos.y, pos.z };
 	const EntityId entityId = id();
-	_entitySpawnFBB.Clear();
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
 	// TODO: User::sendUserSpawn()?
-	_messageSender->sendServerMessage(_peer, _entitySpawnFBB, network::ServerMsgType::EntitySpawn,
-			network::CreateEntitySpawn(_entitySpawnFBB, entity->id(), entity->entityType(), &vec3, entityId, entity->animation()).Union());
+	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntitySpawn,
+			network::CreateEntitySpawn(fbb, entity->id(), entity->entityType(), &vec3, entityId, entity->animation()).Union());
 }
 
 void Entity::sendEntityRemove(const EntityPtr& entity) const {
 	if (_peer == nullptr) {
 		return;
 	}
-	_entityRemoveFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityRemoveFBB, network::ServerMsgType::EntityRemove,
-			network::CreateEntityRemove(_entityRemoveFBB, entity->id()).Union());
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
+	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntityRemove,
+			network::CreateEntityRemove(fbb, entity->id()).Union());
 }
 
 bool Entity::inFrustum(const glm::vec3& position) const {
@@ -35,11 +35,6 @@ class Entity {
 private:
 	core::ReadWriteLock _visibleLock {"Entity"};
 	EntitySet _visible core_thread_guarded_by(_visibleLock);
-	// they are stored as members to reduce memory allocations
-	mutable flatbuffers::FlatBufferBuilder _attribUpdateFBB;
-	mutable flatbuffers::FlatBufferBuilder _entityUpdateFBB;
-	mutable flatbuffers::FlatBufferBuilder _entitySpawnFBB;
-	mutable flatbuffers::FlatBufferBuilder _entityRemoveFBB;
 
 protected:
 	// network stuff
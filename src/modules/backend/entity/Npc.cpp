@@ -15,19 +15,26 @@
 #include "backend/world/Map.h"
 #include <glm/trigonometric.hpp>
 #include <glm/gtc/constants.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
 
 namespace backend {
 
+namespace {
+/** a waypoint counts as reached if the npc is this close to it - in the xz plane */
+constexpr float WaypointDistanceSquare = 1.0f;
+}
+
 std::atomic<EntityId> Npc::_nextNpcId(0);
 
-Npc::Npc(network::EntityType type, const TreeNodePtr& behaviour,
+Npc::Npc(network::EntityType type, const TreeNodePtr& behaviour, const CompiledTreePtr& compiledBehaviour,
 		const MapPtr& map, const network::ServerMessageSenderPtr& messageSender,
 		const core::TimeProviderPtr& timeProvider, const attrib::ContainerProviderPtr& containerProvider,
 		const cooldown::CooldownProviderPtr& cooldownProvider) :
 		Super(_nextNpcId++, map, messageSender, timeProvider, containerProvider),
 		_cooldowns(timeProvider, cooldownProvider) {
 	_entityType = type;
-	_ai = std::make_shared<AI>(behaviour);
+	_ai = std::make_shared<AI>(behaviour, compiledBehaviour);
 	_aiChr = core::make_shared<AICharacter>(_entityId, *this);
 	_ai->setCharacter(_aiChr);
 	_aiChr->setOrientation(randomf(glm::two_pi<float>()));
@@ -39,6 +46,7 @@ Npc::~Npc() {
 }
 
 void Npc::shutdown() {
+	cancelRoute();
 	Zone* zone = _ai->getZone();
 	if (zone != nullptr) {
 		zone->destroyAI(id());
@@ -120,19 +128,57 @@ void Npc::updateAIState() {
 	}
 }
 
-bool Npc::route(const glm::vec3& target) {
-#if 0
-	std::list<glm::ivec3> result;
+void Npc::cancelRoute() {
+	if (_routeId != 0u) {
+		_map->cancelRoute(_routeId);
+		_routeId = 0u;
+	}
+	_routeState = voxelutil::PathState::Unknown;
+	_route.clear();
+	_routeIndex = 0u;
+}
+
+bool Npc::followRoute() {
 	const glm::vec3& pos = _aiChr->getPosition();
-	const glm::ivec3 start(pos);
+	while (_routeIndex < _route.size()) {
+		const glm::ivec3& waypoint = _route[_routeIndex];
+		if (glm::distance2(glm::vec2(waypoint.x, waypoint.z), glm::vec2(pos.x, pos.z)) > WaypointDistanceSquare) {
+			setTargetPosition(glm::vec3(waypoint));
+			return false;
+		}
+		++_routeIndex;
+	}
+	return true;
+}
+
+voxelutil::PathState Npc::route(const glm::vec3& target) {
 	const glm::ivec3 end(target.x, target.y, target.z);
-	if (!_map->findPath(start, end, result)) {
-		return false;
+	if (_routeState == voxelutil::PathState::Unknown || _routeEnd != end) {
+		cancelRoute();
+		const glm::vec3& pos = _aiChr->getPosition();
+		_routeId = _map->requestRoute(glm::ivec3(pos.x, pos.y, pos.z), end);
+		_routeEnd = end;
+		_routeState = voxelutil::PathState::Queued;
 	}
-	// TODO: use the route
+	if (_routeId != 0u) {
+		const voxelutil::PathState state = _map->route(_routeId, _route);
+		if (state == voxelutil::PathState::Queued) {
+			return state;
+		}
+		_routeId = 0u;
+		if (state != voxelutil::PathState::Found) {
+			// the next call requests a new path
+			cancelRoute();
+			return state;
+		}
+		_routeState = state;
+	}
+	if (!followRoute()) {
+		return voxelutil::PathState::Queued;
+	}
+	cancelRoute();
 	setTargetPosition(target);
-#endif
-	return true;
+	return voxelutil::PathState::Found;
 }
 
 void Npc::moveToGround() {
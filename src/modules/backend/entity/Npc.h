@@ -12,6 +12,7 @@
 #include "backend/entity/EntityId.h"
 #include "backend/network/ServerMessageSender.h"
 #include "math/Random.h"
+#include "voxelutil/HierarchicalPathfinder.h"
 
 #include <atomic>
 
@@ -29,11 +30,25 @@ private:
 	glm::vec3 _targetPosition;
 	AIPtr _ai;
 	AICharacterPtr _aiChr;
+	/** the pending path request - @c 0 if there is none */
+	voxelutil::PathId _routeId = 0u;
+	/** @c voxelutil::PathState::Unknown if there is no route to @c _routeEnd in progress */
+	voxelutil::PathState _routeState = voxelutil::PathState::Unknown;
+	glm::ivec3 _routeEnd { 0 };
+	std::vector<glm::ivec3> _route;
+	/** the waypoint of @c _route the npc is heading to */
+	size_t _routeIndex = 0u;
 
 	// cooldowns
 	cooldown::CooldownMgr _cooldowns;
 
 	void moveToGround();
+	void cancelRoute();
+	/**
+	 * @brief Points the target position to the next waypoint of the route
+	 * @return @c true if the last waypoint was reached
+	 */
+	bool followRoute();
 
 	// transfer from ai to npc state
 	void updateFromAIState();
@@ -45,6 +60,7 @@ private:
 public:
 	Npc(network::EntityType type,
 			const TreeNodePtr& behaviour,
+			const CompiledTreePtr& compiledBehaviour,
 			const MapPtr& map,
 			const network::ServerMessageSenderPtr& messageSender,
 			const core::TimeProviderPtr& timeProvider,
@@ -59,7 +75,17 @@ public:
 	const glm::vec3& homePosition() const;
 	void setTargetPosition(const glm::vec3& pos);
 	const glm::vec3& targetPosition() const;
-	bool route(const glm::vec3& target);
+	/**
+	 * @brief Moves the npc along a path to the given target - call it again until it is no longer queued
+	 *
+	 * The path is computed by the pathfinder of the map over the next ticks. After that the target position
+	 * is set to one waypoint after another.
+	 *
+	 * @return @c voxelutil::PathState::Queued while the path is computed or followed,
+	 * @c voxelutil::PathState::Found once the npc reached the target.
+	 */
+	voxelutil::PathState route(const glm::vec3& target);
+	const std::vector<glm::ivec3>& currentRoute() const;
 	const AIPtr& ai();
 
 	cooldown::CooldownMgr& cooldownMgr();
@@ -104,4 +130,8 @@ inline cooldown::CooldownMgr& Npc::cooldownMgr() {
 
 typedef std::shared_ptr<Npc> NpcPtr;
 
+inline const std::vector<glm::ivec3>& Npc::currentRoute() const {
+	return _route;
+}
+
 }
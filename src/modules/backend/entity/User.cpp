@@ -7,6 +7,7 @@
 #include "backend/world/Map.h"
 #include "voxel/PagedVolume.h"
 #include "voxelworld/WorldMgr.h"
+#include "network/BuilderPool.h"
 
 namespace backend {
 
@@ -51,7 +52,8 @@ void User::sendVars() const {
 	core::Var::visitReplicate([&vars] (const core::VarPtr& var) {
 		vars.push_back(var);
 	});
-	flatbuffers::FlatBufferBuilder fbb;
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
 	auto fbbVars = fbb.CreateVector<flatbuffers::Offset<network::Var>>(vars.size(),
 		[&] (size_t i) {
 			const core::String& sname = vars[i]->name();
@@ -121,7 +123,8 @@ void User::userinfo(const char *key, const char* value) {
 }
 
 void User::broadcastUserinfo() {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
 	auto iter = _userinfo.begin();
 	auto fbbVars = fbb.CreateVector<flatbuffers::Offset<network::Var>>(_userinfo.size(),
 		[&] (size_t i, auto* iter) {
@@ -134,7 +137,8 @@ void User::broadcastUserinfo() {
 }
 
 void User::broadcastUserSpawn() const {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::PooledBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = *builder;
 	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
 	sendToVisible(fbb, network::ServerMsgType::UserSpawn, network::CreateUserSpawn(fbb, id(), fbb.CreateString(_name.c_str(), _name.size()), &pos).Union(), true);
 }
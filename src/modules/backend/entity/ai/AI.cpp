@@ -14,9 +14,21 @@ ai::CharacterId AI::getId() const {
 	return _character->getId();
 }
 
-TreeNodePtr AI::setBehaviour(const TreeNodePtr& newBehaviour) {
+TreeNodeState* AI::nodeState(int nodeId) {
+	if (!_compiledBehaviour) {
+		return nullptr;
+	}
+	const int slot = _compiledBehaviour->slot(nodeId);
+	if (slot < 0 || slot >= (int)_nodeStates.size()) {
+		return nullptr;
+	}
+	return &_nodeStates[slot];
+}
+
+TreeNodePtr AI::setBehaviour(const TreeNodePtr& newBehaviour, const CompiledTreePtr& compiledBehaviour) {
 	TreeNodePtr current = _behaviour;
 	_behaviour = newBehaviour;
+	_compiledBehaviour = compiledBehaviour;
 	_reset = true;
 	return current;
 }
@@ -33,10 +45,11 @@ void AI::update(int64_t dt, bool debuggingActive) {
 	if (_reset) {
 		// safe to do it like this, because update is not called from multiple threads
 		_reset = false;
-		_lastStatus.clear();
-		_lastExecMillis.clear();
+		_lastStatus.reset();
+		_lastExecMillis.reset();
 		_filteredEntities.clear();
-		_selectorStates.clear();
+		_selectorStates.reset();
+		_nodeStates.clear();
 	}
 
 	_debuggingActive = debuggingActive;
@@ -44,4 +57,12 @@ void AI::update(int64_t dt, bool debuggingActive) {
 	_aggroMgr.update(dt);
 }
 
+ai::TreeNodeStatus AI::execute(const AIPtr& ai, int64_t dt) {
+	const CompiledTreePtr compiled = ai->_compiledBehaviour;
+	if (compiled && compiled->isValid()) {
+		return compiled->execute(ai, dt);
+	}
+	return ai->_behaviour->execute(ai, dt);
+}
+
 }
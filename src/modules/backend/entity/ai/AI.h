@@ -7,6 +7,7 @@
 #include "group/GroupId.h"
 #include "aggro/AggroMgr.h"
 #include "ICharacter.h"
+#include "tree/CompiledTree.h"
 #include "core/Trace.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/Atomic.h"
@@ -41,6 +42,7 @@ class Zone;
  */
 class AI : public core::NonCopyable {
 	friend class TreeNode;
+	friend class CompiledTree;
 	friend class LUAAIRegistry;
 	friend class IFilter;
 	friend class Filter;
@@ -48,14 +50,16 @@ class AI : public core::NonCopyable {
 protected:
 	/**
 	 * This map is only filled if we are in debugging mode for this entity
+	 * @note The node state maps are allocated on first use - they are not needed for the
+	 * nodes of the compiled behaviour
 	 */
 	typedef core::Map<int, ai::TreeNodeStatus> NodeStates;
-	NodeStates _lastStatus;
+	std::unique_ptr<NodeStates> _lastStatus;
 	/**
 	 * This map is only filled if we are in debugging mode for this entity
 	 */
 	typedef core::Map<int, uint64_t> LastExecMap;
-	LastExecMap _lastExecMillis;
+	std::unique_ptr<LastExecMap> _lastExecMillis;
 
 	/**
 	 * @note The filtered entities are kept even over several ticks. The caller should decide
@@ -69,15 +73,23 @@ protected:
 	 * position in the behaviour tree. This map is doing exactly this.
 	 */
 	typedef core::Map<int, int> SelectorStates;
-	SelectorStates _selectorStates;
+	std::unique_ptr<SelectorStates> _selectorStates;
 
 	/**
 	 * This map stores the amount of execution for the @ai{Limit} node. The key is the node id
 	 */
 	typedef core::Map<int, int> LimitStates;
-	LimitStates _limitStates;
+	std::unique_ptr<LimitStates> _limitStates;
 
 	TreeNodePtr _behaviour;
+	/**
+	 * The flat version of the behaviour - the node states are stored in @c _nodeStates then
+	 */
+	CompiledTreePtr _compiledBehaviour;
+	/**
+	 * The state block for the @c CompiledTree - indexed by the slot of the node
+	 */
+	TreeNodeStates _nodeStates;
 	AggroMgr _aggroMgr;
 
 	ICharacterPtr _character;
@@ -90,12 +102,28 @@ protected:
 	Zone* _zone;
 
 	core::AtomicBool _reset;
+
+	/**
+	 * @return The state of the given node in the state block - or @c nullptr if the node isn't part of
+	 * the compiled behaviour
+	 */
+	TreeNodeState* nodeState(int nodeId);
+
+	template<class MAP>
+	static MAP& nodeStateMap(std::unique_ptr<MAP>& map) {
+		if (!map) {
+			map = std::make_unique<MAP>();
+		}
+		return *map;
+	}
 public:
 	/**
 	 * @param behaviour The behaviour tree node that is applied to this ai entity
+	 * @param compiledBehaviour The flat version of the given behaviour. If this is empty, the
+	 * behaviour is executed via @c TreeNode::execute()
 	 */
-	explicit AI(const TreeNodePtr& behaviour) :
-			_behaviour(behaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
+	explicit AI(const TreeNodePtr& behaviour, const CompiledTreePtr& compiledBehaviour = CompiledTreePtr()) :
+			_behaviour(behaviour), _compiledBehaviour(compiledBehaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
 	}
 	virtual ~AI() {
 	}
@@ -111,6 +139,12 @@ public:
 	 */
 	virtual void update(int64_t dt, bool debuggingActive);
 
+	/**
+	 * @brief Ticks the behaviour tree of the given entity - the compiled behaviour is used if there is a valid one
+	 * @note Call this after @c update()
+	 */
+	static ai::TreeNodeStatus execute(const AIPtr& ai, int64_t dt);
+
 	/**
 	 * @brief Set the new @ai{Zone} this entity is in
 	 */
@@ -148,9 +182,14 @@ public:
 	TreeNodePtr getBehaviour() const;
 	/**
 	 * @brief Set a new behaviour
+	 * @param compiledBehaviour The flat version of the new behaviour - might be empty
 	 * @return the old one if there was any
 	 */
-	TreeNodePtr setBehaviour(const TreeNodePtr& newBehaviour);
+	TreeNodePtr setBehaviour(const TreeNodePtr& newBehaviour, const CompiledTreePtr& compiledBehaviour = CompiledTreePtr());
+	/**
+	 * @return The flat version of the behaviour - might be empty
+	 */
+	const CompiledTreePtr& getCompiledBehaviour() const;
 	/**
 	 * @return The real world entity reference
 	 */
@@ -189,6 +228,10 @@ inline TreeNodePtr AI::getBehaviour() const {
 	return _behaviour;
 }
 
+inline const CompiledTreePtr& AI::getCompiledBehaviour() const {
+	return _compiledBehaviour;
+}
+
 inline void AI::setPause(bool pause) {
 	_pause = pause;
 }
@@ -16,6 +16,7 @@
 
 #include "io/Filesystem.h"
 #include "app/App.h"
+#include <unordered_set>
 
 namespace backend {
 
@@ -130,13 +131,25 @@ static int luaAI_nodetostring(lua_State* s) {
 static int luaAI_createnode(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUATreeNodeFactoryPtr& factory = std::make_shared<LuaNodeFactory>(s, type);
-	const bool inserted = r->registerNodeFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "tree node %s is already registered", type.c_str());
+	LuaNodeFactory* factory;
+	if (r->isMainState(s)) {
+		const int slot = r->addFunction("__meta_node_" + type, "execute");
+		const LUATreeNodeFactoryPtr& factoryPtr = std::make_shared<LuaNodeFactory>(r, type, slot);
+		const bool inserted = r->registerNodeFactory(type, *factoryPtr);
+		if (!inserted) {
+			return clua_error(s, "tree node %s is already registered", type.c_str());
+		}
+		r->addTreeNodeFactory(type, factoryPtr);
+		factory = factoryPtr.get();
+	} else {
+		// the scripts were already evaluated in the main state - reuse the factory
+		factory = r->getTreeNodeFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "tree node %s is not registered", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaNodeFactory*>(s, factory.get());
+	clua_newuserdata<LuaNodeFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"execute", luaAI_nodeemptyexecute},
 		{"__tostring", luaAI_nodetostring},
@@ -144,7 +157,6 @@ static int luaAI_createnode(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "node");
-	r->addTreeNodeFactory(type, factory);
 	return 1;
 }
 
@@ -171,13 +183,24 @@ static int luaAI_conditiontostring(lua_State* s) {
 static int luaAI_createcondition(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAConditionFactoryPtr& factory = std::make_shared<LuaConditionFactory>(s, type);
-	const bool inserted = r->registerConditionFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "condition %s is already registered", type.c_str());
+	LuaConditionFactory* factory;
+	if (r->isMainState(s)) {
+		const int slot = r->addFunction("__meta_condition_" + type, "evaluate");
+		const LUAConditionFactoryPtr& factoryPtr = std::make_shared<LuaConditionFactory>(r, type, slot);
+		const bool inserted = r->registerConditionFactory(type, *factoryPtr);
+		if (!inserted) {
+			return clua_error(s, "condition %s is already registered", type.c_str());
+		}
+		r->addConditionFactory(type, factoryPtr);
+		factory = factoryPtr.get();
+	} else {
+		factory = r->getConditionFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "condition %s is not registered", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaConditionFactory*>(s, factory.get());
+	clua_newuserdata<LuaConditionFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"evaluate", luaAI_conditionemptyevaluate},
 		{"__tostring", luaAI_conditiontostring},
@@ -185,7 +208,6 @@ static int luaAI_createcondition(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "condition");
-	r->addConditionFactory(type, factory);
 	return 1;
 }
 
@@ -208,13 +230,24 @@ static int luaAI_filtertostring(lua_State* s) {
 static int luaAI_createfilter(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAFilterFactoryPtr& factory = std::make_shared<LuaFilterFactory>(s, type);
-	const bool inserted = r->registerFilterFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "filter %s is already registered", type.c_str());
+	LuaFilterFactory* factory;
+	if (r->isMainState(s)) {
+		const int slot = r->addFunction("__meta_filter_" + type, "filter");
+		const LUAFilterFactoryPtr& factoryPtr = std::make_shared<LuaFilterFactory>(r, type, slot);
+		const bool inserted = r->registerFilterFactory(type, *factoryPtr);
+		if (!inserted) {
+			return clua_error(s, "filter %s is already registered", type.c_str());
+		}
+		r->addFilterFactory(type, factoryPtr);
+		factory = factoryPtr.get();
+	} else {
+		factory = r->getFilterFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "filter %s is not registered", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaFilterFactory*>(s, factory.get());
+	clua_newuserdata<LuaFilterFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"filter", luaAI_filteremptyfilter},
 		{"__tostring", luaAI_filtertostring},
@@ -222,7 +255,6 @@ static int luaAI_createfilter(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "filter");
-	r->addFilterFactory(type, factory);
 	return 1;
 }
 
@@ -240,13 +272,24 @@ static int luaAI_steeringtostring(lua_State* s) {
 static int luaAI_createsteering(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUASteeringFactoryPtr& factory = std::make_shared<LuaSteeringFactory>(s, type);
-	const bool inserted = r->registerSteeringFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "steering %s is already registered", type.c_str());
+	LuaSteeringFactory* factory;
+	if (r->isMainState(s)) {
+		const int slot = r->addFunction("__meta_steering_" + type, "execute");
+		const LUASteeringFactoryPtr& factoryPtr = std::make_shared<LuaSteeringFactory>(r, type, slot);
+		const bool inserted = r->registerSteeringFactory(type, *factoryPtr);
+		if (!inserted) {
+			return clua_error(s, "steering %s is already registered", type.c_str());
+		}
+		r->addSteeringFactory(type, factoryPtr);
+		factory = factoryPtr.get();
+	} else {
+		factory = r->getSteeringFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "steering %s is not registered", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaSteeringFactory*>(s, factory.get());
+	clua_newuserdata<LuaSteeringFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"filter", luaAI_steeringemptyexecute},
 		{"__tostring", luaAI_steeringtostring},
@@ -254,16 +297,64 @@ static int luaAI_createsteering(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "steering");
-	r->addSteeringFactory(type, factory);
 	return 1;
 }
 
-LUAAIRegistry::LUAAIRegistry() {
-	_s = _lua.state();
+static int luaAI_nextregistryid() {
+	static core::AtomicInt id(0);
+	return id.increment() + 1;
+}
+
+/**
+ * @brief The registries that are alive - the exiting threads only release their states in these
+ */
+static core::Lock& luaAI_registrieslock() {
+	static core_trace_mutex(core::Lock, lock, "LUAAIRegistries");
+	return lock;
+}
+
+static std::unordered_set<const LUAAIRegistry*>& luaAI_registries() {
+	static std::unordered_set<const LUAAIRegistry*> registries;
+	return registries;
+}
+
+struct LUAAIRegistry::ThreadBinding {
+	LUAAIRegistry* registry = nullptr;
+	/** the registry id is never reused - a registry at the same address gets another id */
+	int id = 0;
+	LUAAIState* state = nullptr;
+
+	void release() {
+		if (registry == nullptr) {
+			return;
+		}
+		core::ScopedLock scopedLock(luaAI_registrieslock());
+		if (luaAI_registries().find(registry) != luaAI_registries().end()) {
+			registry->releaseState(id);
+		}
+		registry = nullptr;
+		state = nullptr;
+	}
+
+	~ThreadBinding() {
+		release();
+	}
+};
+
+LUAAIRegistry::LUAAIRegistry() :
+		_mainThread(std::this_thread::get_id()), _id(luaAI_nextregistryid()) {
+	{
+		core::ScopedLock scopedLock(luaAI_registrieslock());
+		luaAI_registries().insert(this);
+	}
+	_s = _main.state();
 	// TODO: random module
 
 	lua_gc(_s, LUA_GCSTOP, 0);
+	setup(_s);
+}
 
+void LUAAIRegistry::setup(lua_State* s) {
 	static const luaL_Reg registryFuncs[] = {
 		{"createNode", luaAI_createnode},
 		{"createCondition", luaAI_createcondition},
@@ -271,10 +362,139 @@ LUAAIRegistry::LUAAIRegistry() {
 		{"createSteering", luaAI_createsteering},
 		{nullptr, nullptr}
 	};
-	clua_registerfuncsglobal(_s, registryFuncs, "META_REGISTRY", "REGISTRY");
+	clua_registerfuncsglobal(s, registryFuncs, "META_REGISTRY", "REGISTRY");
+
+	luaAI_globalpointer(s, this, luaAI_metaregistry());
+	luaAI_registerAll(s);
+}
+
+std::unique_ptr<LUAAIState> LUAAIRegistry::createState() {
+	core_trace_scoped(LUAAIRegistryCreateState);
+	// the garbage collector is running in these states - they are never collected manually
+	std::unique_ptr<LUAAIState> state = std::make_unique<LUAAIState>();
+	setup(state->state());
+	return state;
+}
+
+void LUAAIRegistry::sync(LUAAIState& state) {
+	std::vector<core::String> chunks;
+	{
+		core::ScopedLock scopedLock(_lock);
+		if (state._chunks >= (int)_chunks.size()) {
+			return;
+		}
+		chunks.assign(_chunks.begin() + state._chunks, _chunks.end());
+	}
+	core_trace_scoped(LUAAIRegistrySync);
+	// the scripts might have replaced functions
+	state.clearReferences();
+	lua_State* s = state.state();
+	for (const core::String& chunk : chunks) {
+		if (luaL_loadbufferx(s, chunk.c_str(), chunk.size(), "", nullptr) || lua_pcall(s, 0, 0, 0)) {
+			Log::error("%s", lua_tostring(s, -1));
+			lua_pop(s, 1);
+		}
+		++state._chunks;
+	}
+}
+
+LUAAIState* LUAAIRegistry::bindState() {
+	if (_s == nullptr) {
+		return nullptr;
+	}
+	const std::thread::id threadId = std::this_thread::get_id();
+	if (threadId == _mainThread) {
+		return &_main;
+	}
+	core::ScopedLock scopedLock(_lock);
+	auto i = _threadStates.find(threadId);
+	if (i != _threadStates.end()) {
+		return i->second.get();
+	}
+	std::unique_ptr<LUAAIState> state;
+	if (_idleStates.empty()) {
+		state = createState();
+	} else {
+		state = std::move(_idleStates.back());
+		_idleStates.pop_back();
+	}
+	LUAAIState* ptr = state.get();
+	_threadStates.emplace(threadId, std::move(state));
+	return ptr;
+}
+
+void LUAAIRegistry::releaseState(int id) {
+	if (_id != id) {
+		// shut down in the meantime - the states are already gone
+		return;
+	}
+	core::ScopedLock scopedLock(_lock);
+	_threadStates.erase(std::this_thread::get_id());
+}
+
+LUAAIState* LUAAIRegistry::threadState() {
+	// the last registry the thread was working with
+	static thread_local ThreadBinding binding;
+	const int id = _id;
+	if (binding.id != id) {
+		binding.release();
+		binding.state = bindState();
+		binding.registry = this;
+		binding.id = id;
+	}
+	LUAAIState* state = binding.state;
+	if (state != nullptr && state != &_main && state->_chunks != _chunkCount) {
+		sync(*state);
+	}
+	return state;
+}
 
-	luaAI_globalpointer(_s, this, luaAI_metaregistry());
-	luaAI_registerAll(_s);
+int LUAAIRegistry::addFunction(const core::String& meta, const char *method) {
+	core::ScopedLock scopedLock(_lock);
+	_functions.push_back({meta, method});
+	return (int)_functions.size() - 1;
+}
+
+lua_State* LUAAIRegistry::pushFunction(int slot) {
+	LUAAIState* state = threadState();
+	if (state == nullptr) {
+		Log::error("LUA state is not yet initialized");
+		return nullptr;
+	}
+	if (state->push(slot)) {
+		return state->state();
+	}
+	Function function;
+	{
+		core::ScopedLock scopedLock(_lock);
+		if (slot < 0 || slot >= (int)_functions.size()) {
+			Log::error("LUA: invalid function slot %i", slot);
+			return nullptr;
+		}
+		function = _functions[slot];
+	}
+	if (!state->resolve(slot, function.meta, function.method)) {
+		return nullptr;
+	}
+	return state->state();
+}
+
+void LUAAIRegistry::reserveStates(int amount) {
+	for (int i = 0; i < amount; ++i) {
+		std::unique_ptr<LUAAIState> state = createState();
+		sync(*state);
+		core::ScopedLock scopedLock(_lock);
+		_idleStates.push_back(std::move(state));
+	}
+}
+
+int LUAAIRegistry::threadStates() {
+	core::ScopedLock scopedLock(_lock);
+	return (int)_threadStates.size();
+}
+
+bool LUAAIRegistry::isMainState(lua_State* s) const {
+	return s == _main.state();
 }
 
 lua_State* LUAAIRegistry::getLuaState() {
@@ -295,9 +515,7 @@ bool LUAAIRegistry::init(const core::String& file) {
 	const char* script = ""
 		"UNKNOWN, CANNOTEXECUTE, RUNNING, FINISHED, FAILED, EXCEPTION = 0, 1, 2, 3, 4, 5\n";
 
-	if (luaL_loadbufferx(_s, script, SDL_strlen(script), "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-		Log::error("%s", lua_tostring(_s, -1));
-		lua_pop(_s, 1);
+	if (!evaluate(script, SDL_strlen(script))) {
 		return false;
 	}
 	const core::String& btScript = io::filesystem()->load(file);
@@ -316,11 +534,22 @@ void LUAAIRegistry::shutdown() {
 		_conditionFactories.clear();
 		_filterFactories.clear();
 		_steeringFactories.clear();
+		_functions.clear();
+		_chunks.clear();
+		_threadStates.clear();
+		_idleStates.clear();
 	}
+	_chunkCount = 0;
+	// the threads are rebinding their states
+	_id = luaAI_nextregistryid();
 	_s = nullptr;
 }
 
 LUAAIRegistry::~LUAAIRegistry() {
+	{
+		core::ScopedLock scopedLock(luaAI_registrieslock());
+		luaAI_registries().erase(this);
+	}
 	shutdown();
 }
 
@@ -334,6 +563,12 @@ bool LUAAIRegistry::evaluate(const char* luaBuffer, size_t size) {
 		lua_pop(_s, 1);
 		return false;
 	}
+	// the script might have replaced functions
+	_main.clearReferences();
+	core::ScopedLock scopedLock(_lock);
+	_chunks.emplace_back(luaBuffer, size);
+	_main._chunks = (int)_chunks.size();
+	_chunkCount = _main._chunks;
 	return true;
 }
 
@@ -357,4 +592,20 @@ void LUAAIRegistry::addSteeringFactory(const core::String& type, const LUASteeri
 	_steeringFactories.emplace(type, factory);
 }
 
+LuaNodeFactory* LUAAIRegistry::getTreeNodeFactory(const core::String& type) {
+	return getFactory(_treeNodeFactories, type);
+}
+
+LuaConditionFactory* LUAAIRegistry::getConditionFactory(const core::String& type) {
+	return getFactory(_conditionFactories, type);
+}
+
+LuaFilterFactory* LUAAIRegistry::getFilterFactory(const core::String& type) {
+	return getFactory(_filterFactories, type);
+}
+
+LuaSteeringFactory* LUAAIRegistry::getSteeringFactory(const core::String& type) {
+	return getFactory(_steeringFactories, type);
+}
+
 }
@@ -8,13 +8,18 @@
 #include "AIRegistry.h"
 #include "core/Trace.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "commonlua/LUA.h"
+#include "LUAAIState.h"
 #include "backend/entity/ai/tree/LUATreeNode.h"
 #include "backend/entity/ai/condition/LUACondition.h"
 #include "backend/entity/ai/filter/LUAFilter.h"
 #include "backend/entity/ai/movement/LUASteering.h"
 #include <map>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace backend {
 
@@ -86,17 +91,79 @@ typedef std::map<core::String, LUASteeringFactoryPtr> SteeringFactoryMap;
  * @par AI metatable
  * There is a metatable that you can modify by calling @ai{LUAAIRegistry::pushAIMetatable()}.
  * This metatable is applied to all @ai{AI} pointers that are forwarded to the lua functions.
+ *
+ * @par Threads
+ * The scripts are evaluated in the lua state of the thread that created the registry. Every other thread
+ * (e.g. the workers of the @ai{Zone}) gets its own @ai{LUAAIState} that replays the evaluated scripts - that
+ * means the lua nodes of different entities can be executed in parallel. The lua state of a thread must not
+ * be shared between threads, and modifications to the metatables that are not done by a script are only
+ * visible in the state of the creating thread. The state of a thread is released when the thread exits.
  */
 class LUAAIRegistry : public AIRegistry {
 protected:
-	lua::LUA _lua;
+	/**
+	 * @brief The state of the thread that created the registry - the scripts are evaluated here first
+	 */
+	LUAAIState _main;
 	lua_State* _s = nullptr;
+	const std::thread::id _mainThread;
+	/**
+	 * @brief Identifies the registry in the thread local state binding - changes on shutdown()
+	 */
+	core::AtomicInt _id;
+
+	/**
+	 * @brief A lua function that is called by the lua nodes, conditions, filters and steerings
+	 */
+	struct Function {
+		/** the registry key of the userdata */
+		core::String meta;
+		const char *method;
+	};
 
 	core_trace_mutex(core::Lock, _lock, "LUAAIRegistry");
 	TreeNodeFactoryMap _treeNodeFactories core_thread_guarded_by(_lock);
 	ConditionFactoryMap _conditionFactories core_thread_guarded_by(_lock);
 	FilterFactoryMap _filterFactories core_thread_guarded_by(_lock);
 	SteeringFactoryMap _steeringFactories core_thread_guarded_by(_lock);
+	std::vector<Function> _functions core_thread_guarded_by(_lock);
+	/** the successfully evaluated scripts - they are replayed in the states of the other threads */
+	std::vector<core::String> _chunks core_thread_guarded_by(_lock);
+	core::AtomicInt _chunkCount;
+	std::map<std::thread::id, std::unique_ptr<LUAAIState>> _threadStates core_thread_guarded_by(_lock);
+	/** states that were prepared by reserveStates() but are not yet bound to a thread */
+	std::vector<std::unique_ptr<LUAAIState>> _idleStates core_thread_guarded_by(_lock);
+
+	void setup(lua_State* s);
+	std::unique_ptr<LUAAIState> createState();
+	/**
+	 * @brief Evaluate the scripts that were not yet evaluated in the given state
+	 */
+	void sync(LUAAIState& state);
+	LUAAIState* bindState();
+	/**
+	 * @brief The thread local binding of a thread to its lua state - releases the state when the thread exits
+	 */
+	struct ThreadBinding;
+	/**
+	 * @brief Drops the lua state of the calling thread
+	 * @param id The registry id the state was bound with
+	 */
+	void releaseState(int id);
+	/**
+	 * @return The lua state for the calling thread or @c nullptr if the registry was shut down
+	 */
+	LUAAIState* threadState();
+
+	template<class MAP>
+	typename MAP::mapped_type::element_type* getFactory(const MAP& map, const core::String& type) {
+		core::ScopedLock scopedLock(_lock);
+		auto i = map.find(type);
+		if (i == map.end()) {
+			return nullptr;
+		}
+		return i->second.get();
+	}
 public:
 	LUAAIRegistry();
 
@@ -105,8 +172,44 @@ public:
 	void addFilterFactory(const core::String& type, const LUAFilterFactoryPtr& factory);
 	void addSteeringFactory(const core::String& type, const LUASteeringFactoryPtr& factory);
 
+	LuaNodeFactory* getTreeNodeFactory(const core::String& type);
+	LuaConditionFactory* getConditionFactory(const core::String& type);
+	LuaFilterFactory* getFilterFactory(const core::String& type);
+	LuaSteeringFactory* getSteeringFactory(const core::String& type);
+
+	/**
+	 * @brief Register a function that is called by the lua nodes, conditions, filters or steerings
+	 * @param meta The registry key of the userdata that holds the function in its metatable
+	 * @return The slot for pushFunction()
+	 */
+	int addFunction(const core::String& meta, const char *method);
+
+	/**
+	 * @brief Pushes the function of the given slot and the userdata it belongs to onto the stack of
+	 * the lua state of the calling thread.
+	 * @return The lua state of the calling thread or @c nullptr if the function couldn't get resolved
+	 * @sa addFunction()
+	 */
+	lua_State* pushFunction(int slot);
+
+	/**
+	 * @brief Prepare lua states for the given amount of threads - they are bound to the threads
+	 * on their first lua call. Without this the states are created on the first call.
+	 */
+	void reserveStates(int amount);
+
+	/**
+	 * @return The amount of lua states that are bound to threads other than the creating one
+	 */
+	int threadStates();
+
+	/**
+	 * @return @c true if the given lua state is the one of the thread that created the registry
+	 */
+	bool isMainState(lua_State* s) const;
+
 	/**
-	 * @brief Access to the lua state.
+	 * @brief Access to the lua state of the thread that created the registry.
 	 * @see pushAIMetatable()
 	 */
 	lua_State* getLuaState();
@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @ingroup LUA
+ */
+
+#include "LUAAIState.h"
+#include "core/Log.h"
+
+namespace backend {
+
+LUAAIState::LUAAIState() {
+}
+
+LUAAIState::~LUAAIState() {
+	clearReferences();
+}
+
+bool LUAAIState::resolve(int slot, const core::String& meta, const char* method) {
+	lua_State* s = _lua.state();
+	// get userdata of the node, condition, filter or steering
+	lua_getfield(s, LUA_REGISTRYINDEX, meta.c_str());
+	if (lua_isnil(s, -1)) {
+		Log::error("LUA: could not find lua userdata for %s", meta.c_str());
+		lua_pop(s, 1);
+		return false;
+	}
+	// get metatable
+	if (lua_getmetatable(s, -1) == 0) {
+		Log::error("LUA: userdata for %s doesn't have a metatable assigned", meta.c_str());
+		lua_pop(s, 1);
+		return false;
+	}
+	lua_getfield(s, -1, method);
+	if (!lua_isfunction(s, -1)) {
+		Log::error("LUA: metatable for %s doesn't have the %s() function assigned", meta.c_str(), method);
+		lua_pop(s, 3);
+		return false;
+	}
+	if (slot >= (int)_functionRefs.size()) {
+		_functionRefs.resize(slot + 1, LUA_NOREF);
+		_selfRefs.resize(slot + 1, LUA_NOREF);
+	}
+	// luaL_ref pops the value - but we leave a copy of the function and the userdata on the stack
+	lua_pushvalue(s, -1);
+	_functionRefs[slot] = luaL_ref(s, LUA_REGISTRYINDEX);
+	lua_remove(s, -2);
+	lua_pushvalue(s, -2);
+	_selfRefs[slot] = luaL_ref(s, LUA_REGISTRYINDEX);
+	// function, userdata
+	lua_insert(s, -2);
+	return true;
+}
+
+void LUAAIState::clearReferences() {
+	lua_State* s = _lua.state();
+	for (size_t i = 0; i < _functionRefs.size(); ++i) {
+		luaL_unref(s, LUA_REGISTRYINDEX, _functionRefs[i]);
+		luaL_unref(s, LUA_REGISTRYINDEX, _selfRefs[i]);
+	}
+	_functionRefs.clear();
+	_selfRefs.clear();
+}
+
+}
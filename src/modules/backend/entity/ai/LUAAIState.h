@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @ingroup LUA
+ */
+#pragma once
+
+#include "commonlua/LUA.h"
+#include "core/NonCopyable.h"
+#include <vector>
+
+namespace backend {
+
+/**
+ * @brief One lua state of the @ai{LUAAIRegistry} with the ai scripts loaded
+ *
+ * Every thread that executes lua nodes, conditions, filters or steerings gets its own instance. The
+ * functions that are called by the @c LUATreeNode, @c LUACondition, @c LUAFilter and @c LUASteering
+ * instances are resolved only once per state and kept as references in the lua registry.
+ */
+class LUAAIState : public core::NonCopyable {
+	friend class LUAAIRegistry;
+private:
+	lua::LUA _lua;
+	/**
+	 * The amount of script chunks of the registry that were evaluated in this state
+	 */
+	int _chunks = 0;
+	/**
+	 * The lua registry references to the function and the userdata (self) - indexed by the function slot
+	 */
+	std::vector<int> _functionRefs;
+	std::vector<int> _selfRefs;
+
+	/**
+	 * @brief Pushes the function and the userdata of the given slot onto the stack
+	 * @return @c false if the slot wasn't resolved yet
+	 */
+	bool push(int slot);
+	/**
+	 * @brief Resolves the function by name and puts the references into the given slot
+	 * @note Only the function and the userdata is left on the stack on success
+	 */
+	bool resolve(int slot, const core::String& meta, const char* method);
+	/**
+	 * @brief Release all function references - they are resolved again on the next call
+	 */
+	void clearReferences();
+public:
+	LUAAIState();
+	~LUAAIState();
+
+	lua_State* state() const;
+};
+
+inline lua_State* LUAAIState::state() const {
+	return _lua.state();
+}
+
+inline bool LUAAIState::push(int slot) {
+	if (slot >= (int)_functionRefs.size() || _functionRefs[slot] == LUA_NOREF) {
+		return false;
+	}
+	lua_State* s = _lua.state();
+	lua_rawgeti(s, LUA_REGISTRYINDEX, _functionRefs[slot]);
+	lua_rawgeti(s, LUA_REGISTRYINDEX, _selfRefs[slot]);
+	return true;
+}
+
+}
@@ -10,8 +10,13 @@ namespace backend {
 
 AI_TASK_IMPL(GoHome) {
 	Npc& npc = getNpc(entity);
-	if (npc.route(npc.homePosition())) {
+	switch (npc.route(npc.homePosition())) {
+	case voxelutil::PathState::Found:
 		return ai::TreeNodeStatus::FINISHED;
+	case voxelutil::PathState::Queued:
+		return ai::TreeNodeStatus::RUNNING;
+	default:
+		break;
 	}
 	return ai::TreeNodeStatus::FAILED;
 }
@@ -3,68 +3,133 @@
  */
 
 #include "AggroMgr.h"
-#include "core/Algorithm.h"
-#include <math.h>
 
 namespace backend {
 
-class CharacterIdPredicate {
-private:
-	const ai::CharacterId& _id;
-public:
-	explicit CharacterIdPredicate(const ai::CharacterId& id) :
-		_id(id) {
+/**
+ * @brief Below this the accumulated reduction is moved into the entries to not lose precision
+ */
+static constexpr double MinDecayScale = 1.0e-30;
+static constexpr double MaxDecayOffset = 1.0e6;
+/**
+ * @brief Entries with less aggro are removed
+ */
+static constexpr float MinAggro = 0.000001f;
+
+bool AggroMgr::above(HeapType heap, int a, int b) const {
+	const Entry& ea = _entries[a];
+	const Entry& eb = _entries[b];
+	// entries with the same aggro are ordered by their character id
+	if (ea._base != eb._base) {
+		return heap == Highest ? ea._base > eb._base : ea._base < eb._base;
 	}
+	return heap == Highest ? ea._id > eb._id : ea._id < eb._id;
+}
 
-	inline bool operator()(const Entry &n1) {
-		return n1.getCharacterId() == _id;
-	}
-};
+void AggroMgr::swapNodes(HeapType heap, int a, int b) const {
+	core::DynamicArray<int>& nodes = _heaps[heap];
+	const int tmp = nodes[a];
+	nodes[a] = nodes[b];
+	nodes[b] = tmp;
+	_entries[nodes[a]]._heapIndex[heap] = a;
+	_entries[nodes[b]]._heapIndex[heap] = b;
+}
 
-static bool EntrySorter(const Entry& a, const Entry& b) {
-	if (a.getAggro() > b.getAggro()) {
-		return false;
-	}
-	if (fabs(a.getAggro() - b.getAggro()) < 0.0000001f) {
-		return a.getCharacterId() < b.getCharacterId();
+void AggroMgr::siftUp(HeapType heap, int node) const {
+	const core::DynamicArray<int>& nodes = _heaps[heap];
+	while (node > 0) {
+		const int parent = (node - 1) / 2;
+		if (!above(heap, nodes[node], nodes[parent])) {
+			break;
+		}
+		swapNodes(heap, parent, node);
+		node = parent;
 	}
-	return true;
 }
 
-/**
- * @brief Remove the entries from the list that have no aggro left.
- * This list is ordered, so we will only remove the first X elements.
- */
-void AggroMgr::cleanupList() {
-	int remove = 0;
-	for (const Entry& e : _entries) {
-		const float aggroValue = e.getAggro();
-		if (aggroValue > 0.0f) {
+void AggroMgr::siftDown(HeapType heap, int node) const {
+	const core::DynamicArray<int>& nodes = _heaps[heap];
+	const int size = (int)nodes.size();
+	for (;;) {
+		const int left = node * 2 + 1;
+		if (left >= size) {
 			break;
 		}
+		int child = left;
+		const int right = left + 1;
+		if (right < size && above(heap, nodes[right], nodes[left])) {
+			child = right;
+		}
+		if (!above(heap, nodes[child], nodes[node])) {
+			break;
+		}
+		swapNodes(heap, node, child);
+		node = child;
+	}
+}
 
-		++remove;
+void AggroMgr::push(int index) const {
+	for (int h = 0; h < MaxHeaps; ++h) {
+		const HeapType heap = (HeapType)h;
+		const int node = (int)_heaps[heap].size();
+		_heaps[heap].push_back(index);
+		_entries[index]._heapIndex[heap] = node;
+		siftUp(heap, node);
 	}
+}
 
-	if (remove == 0) {
-		return;
+void AggroMgr::remove(int index) const {
+	for (int h = 0; h < MaxHeaps; ++h) {
+		const HeapType heap = (HeapType)h;
+		const int node = _entries[index]._heapIndex[heap];
+		const int last = (int)_heaps[heap].size() - 1;
+		if (node != last) {
+			swapNodes(heap, node, last);
+		}
+		_heaps[heap].pop();
+		if (node != last) {
+			const int moved = _heaps[heap][node];
+			siftUp(heap, node);
+			siftDown(heap, _entries[moved]._heapIndex[heap]);
+		}
+	}
+	_indices.erase(_entries[index]._id);
+	const int last = (int)_entries.size() - 1;
+	if (index != last) {
+		_entries[index] = _entries[last];
+		for (int h = 0; h < MaxHeaps; ++h) {
+			_heaps[h][_entries[index]._heapIndex[h]] = index;
+		}
+		_indices[_entries[index]._id] = index;
 	}
+	_entries.pop();
+}
 
-	const int size = static_cast<int>(_entries.size());
-	if (size == remove) {
-		_entries.clear();
-		return;
+void AggroMgr::removeExpired() const {
+	const float minAggro = _minAggro > MinAggro ? _minAggro : MinAggro;
+	while (!_entries.empty()) {
+		const int lowest = _heaps[Lowest][0];
+		if (_entries[lowest].getAggro() >= minAggro) {
+			break;
+		}
+		remove(lowest);
 	}
+}
 
-	_entries.erase(0, remove);
+void AggroMgr::clear() {
+	_entries.clear();
+	_heaps[Highest].clear();
+	_heaps[Lowest].clear();
+	_indices.clear();
+	_decay = AggroDecay();
 }
 
-void AggroMgr::sort() const {
-	if (!_dirty) {
-		return;
+void AggroMgr::normalize() {
+	// the order of the entries doesn't change - the heaps stay valid
+	for (Entry& e : _entries) {
+		e._base = e._base * _decay.scale - _decay.offset;
 	}
-	core::sort(_entries.begin(), _entries.end(), EntrySorter);
-	_dirty = false;
+	_decay = AggroDecay();
 }
 
 void AggroMgr::setReduceByRatio(float reduceRatioSecond, float minAggro) {
@@ -89,49 +154,70 @@ void AggroMgr::resetReduceValue() {
 }
 
 void AggroMgr::update(int64_t deltaMillis) {
-	for (Entry& e : _entries) {
-		_dirty |= e.reduceByTime(deltaMillis);
+	if (_entries.empty()) {
+		_decay = AggroDecay();
+		return;
 	}
-
-	if (_dirty) {
-		sort();
-		cleanupList();
+	const double seconds = (double)deltaMillis / 1000.0;
+	switch (_reduceType) {
+	case RATIO: {
+		const double factor = 1.0 - seconds * _reduceRatioSecond;
+		if (factor <= 0.0) {
+			clear();
+			return;
+		}
+		_decay.scale *= factor;
+		_decay.offset *= factor;
+		break;
+	}
+	case VALUE:
+		_decay.offset += seconds * _reduceValueSecond;
+		break;
+	case DISABLED:
+		return;
+	}
+	if (_decay.scale < MinDecayScale || _decay.offset > MaxDecayOffset) {
+		normalize();
 	}
 }
 
 EntryPtr AggroMgr::addAggro(ai::CharacterId id, float amount) {
-	const CharacterIdPredicate p(id);
-	auto i = core::find_if(_entries.begin(), _entries.end(), p);
-	if (i == _entries.end()) {
-		Entry newEntry(id, amount);
-		switch (_reduceType) {
-		case RATIO:
-			newEntry.setReduceByRatio(_reduceRatioSecond, _minAggro);
-			break;
-		case VALUE:
-			newEntry.setReduceByValue(_reduceValueSecond);
-			break;
-		default:
-			break;
-		}
-		_entries.push_back(newEntry);
-		_dirty = true;
-		return &_entries.back();
+	removeExpired();
+	auto i = _indices.find(id);
+	if (i == _indices.end()) {
+		const int index = (int)_entries.size();
+		_entries.push_back(Entry(id, amount, &_decay));
+		_indices[id] = index;
+		push(index);
+		return &_entries[index];
+	}
+
+	const int index = i->second;
+	_entries[index].addAggro(amount);
+	for (int h = 0; h < MaxHeaps; ++h) {
+		const HeapType heap = (HeapType)h;
+		siftUp(heap, _entries[index]._heapIndex[heap]);
+		siftDown(heap, _entries[index]._heapIndex[heap]);
 	}
+	return &_entries[index];
+}
+
+const AggroMgr::Entries& AggroMgr::getEntries() const {
+	removeExpired();
+	return _entries;
+}
 
-	i->addAggro(amount);
-	_dirty = true;
-	return &*i;
+size_t AggroMgr::count() const {
+	removeExpired();
+	return _entries.size();
 }
 
 EntryPtr AggroMgr::getHighestEntry() const {
+	removeExpired();
 	if (_entries.empty()) {
 		return nullptr;
 	}
-
-	sort();
-
-	return &_entries.back();
+	return &_entries[_heaps[Highest][0]];
 }
 
 }
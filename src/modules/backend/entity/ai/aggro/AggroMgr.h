@@ -9,22 +9,40 @@
 
 #include "backend/entity/ai/ICharacter.h"
 #include "core/collection/DynamicArray.h"
+#include "core/NonCopyable.h"
 #include "Entry.h"
 #include <stddef.h>
+#include <unordered_map>
 
 namespace backend {
 
 /**
  * @brief Manages the aggro values for one @c AI instance. There are several ways to degrade the aggro values.
+ *
+ * The reduction applies to all the entries in the same way. It is accumulated in an @c AggroDecay - so
+ * @c update() doesn't touch the entries. The entries are kept in a max heap for picking the highest entry
+ * and in a min heap to find the entries that ran out of aggro. The latter ones are removed lazily by the
+ * next call that reads or modifies the entries.
  */
-class AggroMgr {
+class AggroMgr : public core::NonCopyable {
 public:
 	typedef core::DynamicArray<Entry> Entries;
 	typedef Entries::iterator EntriesIter;
 protected:
+	enum HeapType {
+		Highest, Lowest, MaxHeaps
+	};
 	mutable Entries _entries;
+	/**
+	 * @brief Indices into @c _entries - the entry with the highest or the lowest aggro is at the top
+	 */
+	mutable core::DynamicArray<int> _heaps[MaxHeaps];
+	/**
+	 * @brief The index of the entry of a character in @c _entries
+	 */
+	mutable std::unordered_map<ai::CharacterId, int> _indices;
 
-	mutable bool _dirty;
+	AggroDecay _decay;
 
 	float _minAggro = 0.0f;
 	float _reduceRatioSecond = 0.0f;
@@ -32,32 +50,53 @@ protected:
 	ReductionType _reduceType = DISABLED;
 
 	/**
-	 * @brief Remove the entries from the list that have no aggro left.
-	 * This list is ordered, so we will only remove the first X elements.
+	 * @return @c true if the entry at index @c a must be above the entry at index @c b in the given heap
 	 */
-	void cleanupList();
-
-	inline void sort() const;
+	bool above(HeapType heap, int a, int b) const;
+	void swapNodes(HeapType heap, int a, int b) const;
+	void siftUp(HeapType heap, int node) const;
+	void siftDown(HeapType heap, int node) const;
+	void push(int index) const;
+	void remove(int index) const;
+	/**
+	 * @brief Removes the entries that ran out of aggro - they are found at the top of the min heap
+	 */
+	void removeExpired() const;
+	void clear();
+	/**
+	 * @brief Moves the accumulated reduction into the entries - only needed to keep the precision
+	 */
+	void normalize();
 public:
-	explicit AggroMgr(size_t expectedEntrySize = 0u) :
-		_dirty(false) {
+	explicit AggroMgr(size_t expectedEntrySize = 0u) {
 		if (expectedEntrySize > 0) {
 			_entries.reserve(expectedEntrySize);
+			_heaps[Highest].reserve(expectedEntrySize);
+			_heaps[Lowest].reserve(expectedEntrySize);
+			_indices.reserve(expectedEntrySize);
 		}
 	}
 
 	virtual ~AggroMgr() {
 	}
 
+	/**
+	 * @note Applies to all entries - also to the existing ones
+	 */
 	void setReduceByRatio(float reduceRatioSecond, float minAggro);
 
+	/**
+	 * @note Applies to all entries - also to the existing ones
+	 */
 	void setReduceByValue(float reduceValueSecond);
 
 	void resetReduceValue();
 
 	/**
-	 * @brief this will update the aggro list according to the reduction type of an entry.
-	 * @param[in] deltaMillis The current milliseconds to use to update the aggro value of the entries.
+	 * @brief Reduces the aggro of all entries according to the reduction type in O(1)
+	 *
+	 * Entries without aggro left are removed lazily.
+	 * @param[in] deltaMillis The milliseconds since the last update.
 	 */
 	void update(int64_t deltaMillis);
 
@@ -65,25 +104,22 @@ public:
 	 * @brief will increase the aggro
 	 * @param[in] id The entity id to increase the aggro against
 	 * @param[in] amount The amount to increase the aggro for
-	 * @return The aggro @c Entry that was added or updated. Useful for changing the reduce type or amount.
+	 * @return The aggro @c Entry that was added or updated.
+	 * @note The returned pointer is only valid until the next call that modifies the aggro manager
 	 */
 	EntryPtr addAggro(ai::CharacterId id, float amount);
 
 	/**
-	 * @return All the aggro entries
+	 * @return All the aggro entries - not sorted
 	 */
-	const Entries& getEntries() const {
-		return _entries;
-	}
+	const Entries& getEntries() const;
 
-	inline size_t count() const {
-		return _entries.size();
-	}
+	size_t count() const;
 
 	/**
 	 * @brief Get the entry with the highest aggro value.
 	 *
-	 * @note Might execute a sort on the list if its dirty
+	 * @note This is O(1) - plus O(log n) for every entry that ran out of aggro since the last call
 	 */
 	EntryPtr getHighestEntry() const;
 };
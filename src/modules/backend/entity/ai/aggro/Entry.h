@@ -11,116 +11,63 @@ enum ReductionType {
 	DISABLED, RATIO, VALUE
 };
 
+/**
+ * @brief The reduction of all the entries of an @c AggroMgr that was accumulated over time
+ *
+ * The aggro of an entry is @c base * @c scale - @c offset. Reducing the aggro of all entries only changes
+ * these two values - and as @c scale is always positive, the order of the entries is kept.
+ */
+struct AggroDecay {
+	double scale = 1.0;
+	double offset = 0.0;
+
+	inline float aggro(double base) const {
+		return (float)(base * scale - offset);
+	}
+
+	inline double base(float aggro) const {
+		return ((double)aggro + offset) / scale;
+	}
+};
+
 /**
  * @brief One entry for the @c AggroMgr
+ *
+ * The aggro value is only computed when it is read - see @c AggroDecay
  */
 class Entry {
+	friend class AggroMgr;
 protected:
-	float _aggro;
-	float _minAggro;
-	float _reduceRatioSecond;
-	float _reduceValueSecond;
-	ReductionType _reduceType;
+	double _base;
+	const AggroDecay* _decay;
 	ai::CharacterId _id;
-
-	void reduceByRatio(float ratio);
-	void reduceByValue(float value);
+	/** the position of the entry in the heaps of the @c AggroMgr */
+	int _heapIndex[2] = { 0, 0 };
 
 public:
-	Entry(const ai::CharacterId& id, float aggro = 0.0f) :
-			_aggro(aggro), _minAggro(0.0f), _reduceRatioSecond(0.0f), _reduceValueSecond(0.0f), _reduceType(DISABLED), _id(id) {
-	}
-
-	Entry(const Entry &other) :
-			_aggro(other._aggro), _minAggro(other._minAggro), _reduceRatioSecond(other._reduceRatioSecond), _reduceValueSecond(other._reduceValueSecond), _reduceType(
-					other._reduceType), _id(other._id) {
+	Entry(const ai::CharacterId& id, float aggro, const AggroDecay* decay) :
+			_base(decay->base(aggro)), _decay(decay), _id(id) {
 	}
 
 	float getAggro() const;
 	void addAggro(float aggro);
-	void setReduceByRatio(float reductionRatioPerSecond, float minimumAggro);
-	void setReduceByValue(float reductionValuePerSecond);
-	/**
-	 * @return @c true if any reduction was done
-	 */
-	bool reduceByTime(int64_t millis);
-	void resetAggro();
 
 	const ai::CharacterId& getCharacterId() const;
 	bool operator <(Entry& other) const;
-	Entry& operator=(const Entry& other);
 };
 
 typedef Entry* EntryPtr;
 
 inline void Entry::addAggro(float aggro) {
-	_aggro += aggro;
-}
-
-inline void Entry::setReduceByRatio(float reduceRatioSecond, float minAggro) {
-	_reduceType = RATIO;
-	_reduceRatioSecond = reduceRatioSecond;
-	_minAggro = minAggro;
-}
-
-inline void Entry::setReduceByValue(float reduceValueSecond) {
-	_reduceType = VALUE;
-	_reduceValueSecond = reduceValueSecond;
-}
-
-inline bool Entry::reduceByTime(int64_t millis) {
-	switch (_reduceType) {
-	case RATIO: {
-		const float f = static_cast<float>(millis) / 1000.0f;
-		reduceByRatio(f * _reduceRatioSecond);
-		return true;
-	}
-	case VALUE: {
-		const float f = static_cast<float>(millis) / 1000.0f;
-		reduceByValue(f * _reduceValueSecond);
-		return true;
-	}
-	case DISABLED:
-		break;
-	}
-	return false;
-}
-
-inline void Entry::reduceByRatio(float ratio) {
-	_aggro *= (1.0f - ratio);
-	if (_aggro < _minAggro) {
-		_aggro = 0.0f;
-	}
-}
-
-inline void Entry::reduceByValue(float value) {
-	_aggro -= value;
-
-	if (_aggro < 0.000001f) {
-		_aggro = 0.0f;
-	}
+	_base += (double)aggro / _decay->scale;
 }
 
 inline float Entry::getAggro() const {
-	return _aggro;
-}
-
-inline void Entry::resetAggro() {
-	_aggro = 0.0f;
+	return _decay->aggro(_base);
 }
 
 inline bool Entry::operator <(Entry& other) const {
-	return _aggro < other._aggro;
-}
-
-inline Entry& Entry::operator=(const Entry& other) {
-	_aggro = other._aggro;
-	_minAggro = other._minAggro;
-	_reduceRatioSecond = other._reduceRatioSecond;
-	_reduceValueSecond = other._reduceValueSecond;
-	_reduceType = other._reduceType;
-	_id = other._id;
-	return *this;
+	return _base < other._base;
 }
 
 inline const ai::CharacterId& Entry::getCharacterId() const {
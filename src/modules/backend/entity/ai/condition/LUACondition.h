@@ -10,23 +10,28 @@
 
 namespace backend {
 
+class LUAAIRegistry;
+
 /**
  * @see @ai{LUAAIRegistry}
  */
 class LUACondition : public ICondition {
 protected:
-	lua_State* _s;
+	LUAAIRegistry* _registry;
+	/** the slot of the evaluate() function in the registry */
+	int _slot;
 
 	bool evaluateLUA(const AIPtr& entity);
 
 public:
 	class LUAConditionFactory : public IConditionFactory {
 	private:
-		lua_State* _s;
+		LUAAIRegistry* _registry;
 		core::String _type;
+		int _slot;
 	public:
-		LUAConditionFactory(lua_State* s, const core::String& typeStr) :
-				_s(s), _type(typeStr) {
+		LUAConditionFactory(LUAAIRegistry* registry, const core::String& typeStr, int slot) :
+				_registry(registry), _type(typeStr), _slot(slot) {
 		}
 
 		inline const core::String& type() const {
@@ -34,12 +39,12 @@ public:
 		}
 
 		ConditionPtr create(const ConditionFactoryContext* ctx) const override {
-			return std::make_shared<LUACondition>(_type, ctx->parameters, _s);
+			return std::make_shared<LUACondition>(_type, ctx->parameters, _registry, _slot);
 		}
 	};
 
-	LUACondition(const core::String& name, const core::String& parameters, lua_State* s) :
-			ICondition(name, parameters), _s(s) {
+	LUACondition(const core::String& name, const core::String& parameters, LUAAIRegistry* registry, int slot) :
+			ICondition(name, parameters), _registry(registry), _slot(slot) {
 	}
 
 	~LUACondition() {
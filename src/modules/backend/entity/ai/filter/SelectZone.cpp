@@ -4,20 +4,33 @@
  
 #include "SelectZone.h"
 #include "backend/entity/ai/zone/Zone.h"
+#include "core/StringUtil.h"
 
 namespace backend {
 
 SelectZone::SelectZone(const core::String& parameters) :
 	IFilter("SelectZone", parameters) {
+	if (_parameters.empty()) {
+		_radius = -1.0f;
+	} else {
+		_radius = core::string::toFloat(_parameters);
+	}
 }
 
 void SelectZone::filter (const AIPtr& entity) {
 	FilteredEntities& entities = getFilteredEntities(entity);
-	auto func = [&] (const AIPtr& ai) {
-		entities.push_back(ai->getId());
-		return true;
-	};
-	entity->getZone()->execute(func);
+	const ZoneIndex& index = entity->getZone()->getIndex();
+	if (_radius < 0.0f) {
+		const ZoneIndex::Entries& all = index.entries();
+		entities.reserve(entities.size() + all.size());
+		for (const ZoneIndex::Entry& e : all) {
+			entities.push_back(e.id);
+		}
+		return;
+	}
+	index.visit(entity->getCharacter()->getPosition(), _radius, [&] (ai::CharacterId id) {
+		entities.push_back(id);
+	});
 }
 
 }
@@ -10,8 +10,14 @@ namespace backend {
 
 /**
  * @brief This filter will pick the entities from the zone of the given entity
+ *
+ * The optional parameter is a radius around the given entity to only pick the entities that are close
+ * enough. The entities are taken from the @c ZoneIndex of the zone - so the positions are the ones from
+ * the beginning of the current tick.
  */
 class SelectZone: public IFilter {
+protected:
+	float _radius;
 public:
 	FILTER_FACTORY(SelectZone)
 
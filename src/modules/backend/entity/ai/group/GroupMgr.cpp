@@ -3,150 +3,273 @@
  */
 
 #include "GroupMgr.h"
-#include <list>
+#include "core/Algorithm.h"
 
 namespace backend {
 
-struct AveragePositionFunctor {
-	glm::vec3 operator()(const glm::vec3& result, const AIPtr& ai) {
-		return ai->getCharacter()->getPosition() + result;
+namespace {
+
+template<class T, class KEY, class LESS>
+size_t lowerBound(const core::DynamicArray<T>& array, const KEY& key, LESS less) {
+	size_t first = 0u;
+	size_t count = array.size();
+	while (count > 0u) {
+		const size_t step = count / 2u;
+		const size_t i = first + step;
+		if (less(array[i], key)) {
+			first = i + 1u;
+			count -= step + 1u;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+inline size_t lowerBound(const core::DynamicArray<const AI*>& members, const AI* ai) {
+	return lowerBound(members, ai, [] (const AI* a, const AI* b) { return a < b; });
+}
+
+inline bool contains(const core::DynamicArray<const AI*>& members, const AI* ai) {
+	const size_t i = lowerBound(members, ai);
+	return i < members.size() && members[i] == ai;
+}
+
+void insertSorted(core::DynamicArray<const AI*>& members, const AI* ai) {
+	auto iter = members.begin();
+	iter += lowerBound(members, ai);
+	members.insert(iter, ai);
+}
+
+void eraseSorted(core::DynamicArray<const AI*>& members, const AI* ai) {
+	const size_t i = lowerBound(members, ai);
+	if (i < members.size() && members[i] == ai) {
+		members.erase(i);
+	}
+}
+
+}
+
+const GroupMgr::Group* GroupMgr::Snapshot::find(GroupId id) const {
+	const size_t i = lowerBound(groups, id, [] (const ConstGroupPtr& group, GroupId groupId) {
+		return group->id < groupId;
+	});
+	if (i < groups.size() && groups[i]->id == id) {
+		return groups[i].get();
+	}
+	return nullptr;
+}
+
+bool GroupMgr::Snapshot::isMember(const AI* ai, GroupId id) const {
+	const Group* group = find(id);
+	return group != nullptr && contains(group->sortedMembers, ai);
+}
+
+bool GroupMgr::Snapshot::isInAnyGroup(const AI* ai) const {
+	return contains(*members, ai);
+}
+
+GroupMgr::GroupMgr() :
+		_members(std::make_shared<SortedMembers>()), _snapshot(nullptr), _dirty(false) {
+	core::ScopedLock scopedLock(_lock);
+	publish();
+}
+
+GroupMgr::~GroupMgr() {
+	for (const Snapshot* s : _retired) {
+		delete s;
+	}
+	delete _snapshot.load();
+}
+
+void GroupMgr::publish() const {
+	Snapshot* snapshot = new Snapshot();
+	snapshot->groups.reserve(_groups.size());
+	for (const GroupPtr& group : _groups) {
+		snapshot->groups.push_back(group);
+	}
+	core::sort(snapshot->groups.begin(), snapshot->groups.end(), [] (const ConstGroupPtr& a, const ConstGroupPtr& b) {
+		return a->id < b->id;
+	});
+	snapshot->members = _members;
+	const Snapshot* replaced = _snapshot.exchange(snapshot, std::memory_order_acq_rel);
+	if (replaced != nullptr) {
+		_retired.push_back(replaced);
+	}
+	_dirty.store(false, std::memory_order_release);
+}
+
+const GroupMgr::Snapshot* GroupMgr::snapshot() const {
+	if (_dirty.load(std::memory_order_acquire)) {
+		core::ScopedLock scopedLock(_lock);
+		if (_dirty.load(std::memory_order_relaxed)) {
+			publish();
+		}
+	}
+	return _snapshot.load(std::memory_order_acquire);
+}
+
+GroupMgr::Group& GroupMgr::modify(int index) {
+	GroupPtr& group = _groups[index];
+	// the snapshots are only created and destroyed with the lock held - so the use count is exact
+	if (group.use_count() > 1) {
+		group = std::make_shared<Group>(*group);
 	}
-};
+	return *group;
+}
+
+GroupMgr::SortedMembers& GroupMgr::modifyMembers() {
+	if (_members.use_count() > 1) {
+		_members = std::make_shared<SortedMembers>(*_members);
+	}
+	return *_members;
+}
 
 void GroupMgr::update(int64_t) {
+	core_trace_scoped(GroupMgrUpdate);
 	core::ScopedLock scopedLock(_lock);
-	for (auto i = _groups.begin(); i != _groups.end(); ++i) {
-		Group& group = i->second;
-		core::ScopedLock lock(_groupLock);
-		glm::vec3 averagePosition = std::accumulate(group.members.begin(), group.members.end(), glm::vec3(0.0f), AveragePositionFunctor());
-		averagePosition *= 1.0f / (float) group.members.size();
-		group.position = averagePosition;
+	// there are no readers that could see the groups change - they are updated in place
+	for (GroupPtr& group : _groups) {
+		glm::vec3 averagePosition(0.0f);
+		for (const AIPtr& ai : group->members) {
+			averagePosition += ai->getCharacter()->getPosition();
+		}
+		averagePosition *= 1.0f / (float) group->members.size();
+		group->position = averagePosition;
+	}
+	// there are no readers left that could still use the replaced snapshots
+	for (const Snapshot* s : _retired) {
+		delete s;
 	}
+	_retired.clear();
+	publish();
 }
 
 bool GroupMgr::add(GroupId id, const AIPtr& ai) {
 	core::ScopedLock scopedLock(_lock);
-	GroupsIter i = _groups.find(id);
-	if (i == _groups.end()) {
-		Group group;
-		group.leader = ai;
-		i = _groups.insert(std::pair<GroupId, Group>(id, group)).first;
-	}
-
-	Group& group = i->second;
-	core::ScopedLock lock(_groupLock);
-	std::pair<GroupMembersSetIter, bool> ret = group.members.insert(ai);
-	if (ret.second) {
-		_groupMembers.insert(GroupMembers::value_type(ai, id));
-		return true;
+	auto i = _groupIndices.find(id);
+	if (i == _groupIndices.end()) {
+		GroupPtr group = std::make_shared<Group>();
+		group->id = id;
+		group->leader = ai;
+		_groups.push_back(group);
+		i = _groupIndices.insert(std::make_pair(id, (int)_groups.size() - 1)).first;
+	} else if (contains(_groups[i->second]->sortedMembers, ai.get())) {
+		return false;
 	}
-	return false;
+
+	Group& group = modify(i->second);
+	group.members.push_back(ai);
+	insertSorted(group.sortedMembers, ai.get());
+	core::DynamicArray<GroupId>& ids = _memberGroups[ai.get()];
+	if (ids.empty()) {
+		insertSorted(modifyMembers(), ai.get());
+	}
+	ids.push_back(id);
+	_dirty.store(true, std::memory_order_release);
+	return true;
 }
 
-bool GroupMgr::remove(GroupId id, const AIPtr& ai) {
-	core::ScopedLock scopedLock(_lock);
-	const GroupsIter& i = _groups.find(id);
-	if (i == _groups.end()) {
+bool GroupMgr::doRemove(GroupId id, const AIPtr& ai) {
+	const auto i = _groupIndices.find(id);
+	if (i == _groupIndices.end()) {
 		return false;
 	}
-	Group& group = i->second;
-	GroupMembersSetIter si;
-	{
-		core::ScopedLock lock(_groupLock);
-		si = group.members.find(ai);
-		if (si == group.members.end()) {
-			return false;
+	const int index = i->second;
+	if (!contains(_groups[index]->sortedMembers, ai.get())) {
+		return false;
+	}
+	if (_groups[index]->members.size() == 1u) {
+		// the last member - the group is dropped without copying it
+		_groupIndices.erase(i);
+		const int last = (int)_groups.size() - 1;
+		if (index != last) {
+			_groups[index] = core::move(_groups[last]);
+			_groupIndices[_groups[index]->id] = index;
 		}
-		group.members.erase(si);
-		if (group.members.empty()) {
-			_groups.erase(i);
-		} else if (group.leader == ai) {
-			group.leader = *group.members.begin();
+		_groups.erase(last);
+	} else {
+		Group& group = modify(index);
+		group.members.erase(core::find(group.members.begin(), group.members.end(), ai));
+		eraseSorted(group.sortedMembers, ai.get());
+		if (group.leader == ai) {
+			group.leader = group.members.front();
 		}
 	}
 
-	auto range = _groupMembers.equal_range(ai);
-	for (auto it = range.first; it != range.second; ++it) {
-		if (it->second == id) {
-			_groupMembers.erase(it);
-			break;
+	auto groups = _memberGroups.find(ai.get());
+	if (groups != _memberGroups.end()) {
+		core::DynamicArray<GroupId>& ids = groups->second;
+		auto it = core::find(ids.begin(), ids.end(), id);
+		if (it != ids.end()) {
+			ids.erase(it);
+		}
+		if (ids.empty()) {
+			_memberGroups.erase(groups);
+			eraseSorted(modifyMembers(), ai.get());
 		}
 	}
+	_dirty.store(true, std::memory_order_release);
 	return true;
 }
 
+bool GroupMgr::remove(GroupId id, const AIPtr& ai) {
+	core::ScopedLock scopedLock(_lock);
+	return doRemove(id, ai);
+}
+
 bool GroupMgr::removeFromAllGroups(const AIPtr& ai) {
-	std::list<GroupId> groups;
-	{
-		core::ScopedLock scopedLock(_lock);
-		auto range = _groupMembers.equal_range(ai);
-		for (auto it = range.first; it != range.second; ++it) {
-			groups.push_back(it->second);
-		}
+	core::ScopedLock scopedLock(_lock);
+	auto groups = _memberGroups.find(ai.get());
+	if (groups == _memberGroups.end()) {
+		return true;
 	}
-	for (GroupId groupId : groups) {
-		remove(groupId, ai);
+	const core::DynamicArray<GroupId> ids = groups->second;
+	for (GroupId groupId : ids) {
+		doRemove(groupId, ai);
 	}
 	return true;
 }
 
 AIPtr GroupMgr::getLeader(GroupId id) const {
-	core::ScopedLock scopedLock(_lock);
-	const GroupsConstIter& i = _groups.find(id);
-	if (i == _groups.end()) {
+	const Group* group = snapshot()->find(id);
+	if (group == nullptr) {
 		return AIPtr();
 	}
-
-	core::ScopedLock lock(_groupLock);
-	return i->second.leader;
+	return group->leader;
 }
 
 bool GroupMgr::getPosition(GroupId id, glm::vec3& position) const {
-	core::ScopedLock scopedLock(_lock);
-	const GroupsConstIter& i = _groups.find(id);
-	if (i == _groups.end()) {
+	const Group* group = snapshot()->find(id);
+	if (group == nullptr) {
 		return false;
 	}
-
-	core::ScopedLock lock(_groupLock);
-	position = i->second.position;
+	position = group->position;
 	return true;
 }
 
 bool GroupMgr::isGroupLeader(GroupId id, const AIPtr& ai) const {
-	core::ScopedLock scopedLock(_lock);
-	const GroupsConstIter& i = _groups.find(id);
-	if (i == _groups.end()) {
-		return 0;
+	const Group* group = snapshot()->find(id);
+	if (group == nullptr) {
+		return false;
 	}
-	core::ScopedLock lock(_groupLock);
-	return i->second.leader == ai;
+	return group->leader == ai;
 }
 
 int GroupMgr::getGroupSize(GroupId id) const {
-	core::ScopedLock scopedLock(_lock);
-	const GroupsConstIter& i = _groups.find(id);
-	if (i == _groups.end()) {
+	const Group* group = snapshot()->find(id);
+	if (group == nullptr) {
 		return 0;
 	}
-	core::ScopedLock lock(_groupLock);
-	return static_cast<int>(std::distance(i->second.members.begin(), i->second.members.end()));
+	return (int)group->members.size();
 }
 
 bool GroupMgr::isInAnyGroup(const AIPtr& ai) const {
-	core::ScopedLock scopedLock(_lock);
-	return _groupMembers.find(ai) != _groupMembers.end();
+	return snapshot()->isInAnyGroup(ai.get());
 }
 
 bool GroupMgr::isInGroup(GroupId id, const AIPtr& ai) const {
-	core::ScopedLock scopedLock(_lock);
-	auto range = _groupMembers.equal_range(ai);
-	for (auto it = range.first; it != range.second; ++it) {
-		if (it->second == id) {
-			return true;
-		}
-	}
-	return false;
+	return snapshot()->isMember(ai.get(), id);
 }
 
 }
@@ -9,10 +9,10 @@
 #include "backend/entity/ai/common/Math.h"
 #include "backend/entity/ai/ICharacter.h"
 #include "backend/entity/ai/AI.h"
+#include "core/collection/DynamicArray.h"
+#include <atomic>
 #include <memory>
-#include <numeric>
 #include <unordered_map>
-#include <unordered_set>
 
 namespace backend {
 
@@ -23,34 +23,84 @@ namespace backend {
  *
  * Every @ai{Zone} has its own @c GroupMgr instance. It is automatically updated with the zone.
  * The average group position is only updated once per @c update() call.
+ *
+ * The members of a group are stored in a dense array. The queries are answered from an immutable
+ * snapshot of all the groups without locking the group manager. The snapshot is rebuilt in
+ * @c update() - and by the first query after a member was added or removed.
+ *
+ * The snapshots share the groups with the group manager. A group that is referenced by a snapshot
+ * is copied before it is modified (copy-on-write) - so adding or removing a member only copies the
+ * affected group, the snapshot itself only holds pointers to the groups.
  */
 class GroupMgr {
 private:
-	typedef std::unordered_set<AIPtr> GroupMembersSet;
-	typedef GroupMembersSet::iterator GroupMembersSetIter;
-	typedef GroupMembersSet::const_iterator GroupMembersSetConstIter;
+	typedef core::DynamicArray<AIPtr> GroupMembers;
+	/** sorted by address */
+	typedef core::DynamicArray<const AI*> SortedMembers;
 
-	core_trace_mutex(core::Lock, _groupLock, "GroupLock");
 	struct Group {
+		GroupId id;
 		AIPtr leader;
-		GroupMembersSet members;
-		glm::vec3 position;
+		/** in the order they were added */
+		GroupMembers members;
+		/** for the membership queries */
+		SortedMembers sortedMembers;
+		glm::vec3 position {0.0f};
 	};
+	typedef std::shared_ptr<Group> GroupPtr;
+	typedef std::shared_ptr<const Group> ConstGroupPtr;
 
-	typedef std::unordered_multimap<AIPtr, GroupId> GroupMembers;
-	typedef std::unordered_map<GroupId, Group> Groups;
-	typedef Groups::const_iterator GroupsConstIter;
-	typedef Groups::iterator GroupsIter;
+	/**
+	 * @brief Immutable view of the groups for the readers
+	 */
+	struct Snapshot {
+		/** sorted by group id */
+		core::DynamicArray<ConstGroupPtr> groups;
+		/** all the @c AI instances that are part of at least one group */
+		std::shared_ptr<const SortedMembers> members;
+
+		const Group* find(GroupId id) const;
+		bool isMember(const AI* ai, GroupId id) const;
+		bool isInAnyGroup(const AI* ai) const;
+	};
 
 	core_trace_mutex(core::Lock, _lock, "GroupMgr");
-	Groups _groups core_thread_guarded_by(_lock);
-	GroupMembers _groupMembers core_thread_guarded_by(_lock);
+	core::DynamicArray<GroupPtr> _groups core_thread_guarded_by(_lock);
+	/** index into @c _groups */
+	std::unordered_map<GroupId, int> _groupIndices core_thread_guarded_by(_lock);
+	/** the groups of every member */
+	std::unordered_map<const AI*, core::DynamicArray<GroupId>> _memberGroups core_thread_guarded_by(_lock);
+	/** the keys of @c _memberGroups */
+	std::shared_ptr<SortedMembers> _members core_thread_guarded_by(_lock);
+
+	mutable std::atomic<const Snapshot*> _snapshot;
+	/** set if a member was added or removed since the snapshot was published */
+	mutable std::atomic_bool _dirty;
+	/**
+	 * @brief Snapshots that were replaced - readers might still use them until the next @c update() call
+	 */
+	mutable core::DynamicArray<const Snapshot*> _retired core_thread_guarded_by(_lock);
+
+	/**
+	 * @note The lock must be held
+	 */
+	void publish() const;
+	const Snapshot* snapshot() const;
+	bool doRemove(GroupId id, const AIPtr& ai);
+	/**
+	 * @brief Copies the group if a snapshot references it
+	 * @note The lock must be held
+	 */
+	Group& modify(int index);
+	/**
+	 * @brief Copies the members if a snapshot references them
+	 * @note The lock must be held
+	 */
+	SortedMembers& modifyMembers();
 
 public:
-	GroupMgr () {
-	}
-	virtual ~GroupMgr () {
-	}
+	GroupMgr ();
+	virtual ~GroupMgr ();
 
 	/**
 	 * @brief Adds a new group member to the given @ai{GroupId}. If the group does not yet
@@ -68,6 +118,10 @@ public:
 	 */
 	bool add(GroupId id, const AIPtr& ai);
 
+	/**
+	 * @brief Calculates the average group positions and publishes a new snapshot
+	 * @note No query may be running while this is called - the zone calls it after all @c AI instances were ticked
+	 */
 	void update(int64_t deltaTime);
 
 	/**
@@ -98,32 +152,24 @@ public:
 	 *
 	 * @note If the given group doesn't exist or some other error occurred, this method returns @c glm::vec3::VEC3_INFINITE
 	 * @note The position of a group is calculated once per @c update() call.
-	 *
-	 * @note This method performs a read lock on the group manager
 	 */
 	bool getPosition(GroupId id, glm::vec3& position) const;
 
 	/**
 	 * @return The @ai{ICharacter} object of the leader, or @c nullptr if no such group exists.
-	 *
-	 * @note This method performs a read lock on the group manager
 	 */
 	AIPtr getLeader(GroupId id) const;
 
 	/**
 	 * @brief Visit all the group members of the given group until the functor returns @c false
-	 *
-	 * @note This methods performs a read lock on the group manager
 	 */
 	template<typename Func>
 	void visit(GroupId id, Func& func) const {
-		core::ScopedLock scopedLock(_lock);
-		const GroupsConstIter& i = _groups.find(id);
-		if (i == _groups.end()) {
+		const Group* group = snapshot()->find(id);
+		if (group == nullptr) {
 			return;
 		}
-		for (GroupMembersSetConstIter it = i->second.members.begin(); it != i->second.members.end(); ++it) {
-			const AIPtr& chr = *it;
+		for (const AIPtr& chr : group->members) {
 			if (!func(chr))
 				break;
 		}
@@ -132,24 +178,13 @@ public:
 	/**
 	 * @return If the group doesn't exist, this method returns @c 0 - otherwise the amount of members
 	 * that must be bigger than @c 1
-	 *
-	 * @note This method performs a read lock on the group manager
 	 */
 	int getGroupSize(GroupId id) const;
 
-	/**
-	 * @note This method performs a read lock on the group manager
-	 */
 	bool isInAnyGroup(const AIPtr& ai) const;
 
-	/**
-	 * @note This method performs a read lock on the group manager
-	 */
 	bool isInGroup(GroupId id, const AIPtr& ai) const;
 
-	/**
-	 * @note This method performs a read lock on the group manager
-	 */
 	bool isGroupLeader(GroupId id, const AIPtr& ai) const;
 };
 
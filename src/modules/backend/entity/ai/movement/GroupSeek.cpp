@@ -26,5 +26,16 @@ MoveVector GroupSeek::execute (const AIPtr& ai, float speed) const {
 	return seek(ai->getCharacter()->getPosition(), target, speed);
 }
 
+void GroupSeek::executeBatch (const SteeringBatch& batch, SteeringResults& results) const {
+	if (batch.zone == nullptr) {
+		return;
+	}
+	glm::vec3 target;
+	if (!batch.zone->getGroupMgr().getPosition(_groupId, target)) {
+		return;
+	}
+	seekBatch(batch, target, false, results);
+}
+
 }
 }
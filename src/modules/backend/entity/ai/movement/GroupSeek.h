@@ -25,6 +25,10 @@ public:
 	}
 
 	virtual MoveVector execute (const AIPtr& ai, float speed) const override;
+	/**
+	 * @brief The group position is only looked up once for the whole batch
+	 */
+	void executeBatch (const SteeringBatch& batch, SteeringResults& results) const override;
 };
 
 }
@@ -8,6 +8,9 @@
 #include "commonlua/LUA.h"
 
 namespace backend {
+
+class LUAAIRegistry;
+
 namespace movement {
 
 /**
@@ -15,19 +18,22 @@ namespace movement {
  */
 class LUASteering : public ISteering {
 protected:
-	mutable lua_State* _s;
+	LUAAIRegistry* _registry;
 	core::String _type;
+	/** the slot of the execute() function in the registry */
+	int _slot;
 
 	MoveVector executeLUA(const AIPtr& entity, float speed) const;
 
 public:
 	class LUASteeringFactory : public ISteeringFactory {
 	private:
-		lua_State* _s;
+		LUAAIRegistry* _registry;
 		core::String _type;
+		int _slot;
 	public:
-		LUASteeringFactory(lua_State* s, const core::String& typeStr) :
-				_s(s), _type(typeStr) {
+		LUASteeringFactory(LUAAIRegistry* registry, const core::String& typeStr, int slot) :
+				_registry(registry), _type(typeStr), _slot(slot) {
 		}
 
 		inline const core::String& type() const {
@@ -35,11 +41,11 @@ public:
 		}
 
 		SteeringPtr create(const SteeringFactoryContext* ctx) const override {
-			return std::make_shared<LUASteering>(_s, _type);
+			return std::make_shared<LUASteering>(_registry, _type, _slot);
 		}
 	};
 
-	LUASteering(lua_State* s, const core::String& type);
+	LUASteering(LUAAIRegistry* registry, const core::String& type, int slot);
 
 	~LUASteering() {
 	}
@@ -10,6 +10,9 @@
 #include "common/MoveVector.h"
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+#include <glm/trigonometric.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
 
@@ -43,5 +46,61 @@ MoveVector ISteering::seek(const glm::vec3& pos, const glm::vec3& target, float
 	return MoveVector(v * speed, orientation);
 }
 
+void ISteering::executeBatch(const SteeringBatch& batch, SteeringResults& results) const {
+	const size_t size = batch.size();
+	for (size_t i = 0; i < size; ++i) {
+		results.set(i, execute(batch.ais[i], batch.speed[i]));
+	}
+}
+
+/**
+ * @brief Distance vector like in @c ISteering::seek() - without flipping the sign of zero values for @c flee()
+ */
+template<bool Away>
+static inline float delta(float target, float pos) {
+	return Away ? pos - target : target - pos;
+}
+
+template<bool Away>
+static void seekArrays(const SteeringBatch& batch, const glm::vec3& target, SteeringResults& results) {
+	const size_t size = batch.size();
+	const float* __restrict px = batch.x.data();
+	const float* __restrict py = batch.y.data();
+	const float* __restrict pz = batch.z.data();
+	const float* __restrict speed = batch.speed.data();
+	float* __restrict rx = results.x.data();
+	float* __restrict ry = results.y.data();
+	float* __restrict rz = results.z.data();
+	float* __restrict dots = results.rotation.data();
+	// branch free to allow vectorization - the squared distance is kept in the rotation array for the second pass
+	for (size_t i = 0; i < size; ++i) {
+		const float dx = delta<Away>(target.x, px[i]);
+		const float dy = delta<Away>(target.y, py[i]);
+		const float dz = delta<Away>(target.z, pz[i]);
+		const float dot = dx * dx + dy * dy + dz * dz;
+		const float scale = speed[i] / glm::sqrt(glm::max(dot, glm::epsilon<float>()));
+		rx[i] = dx * scale;
+		ry[i] = dy * scale;
+		rz[i] = dz * scale;
+		dots[i] = dot;
+	}
+	for (size_t i = 0; i < size; ++i) {
+		if (dots[i] <= glm::epsilon<float>()) {
+			results.set(i, MoveVector::TargetReached);
+			continue;
+		}
+		results.rotation[i] = glm::atan(delta<Away>(target.z, pz[i]), delta<Away>(target.x, px[i]));
+		results.state[i] = MoveVectorState::Valid;
+	}
+}
+
+void ISteering::seekBatch(const SteeringBatch& batch, const glm::vec3& target, bool away, SteeringResults& results) const {
+	if (away) {
+		seekArrays<true>(batch, target, results);
+	} else {
+		seekArrays<false>(batch, target, results);
+	}
+}
+
 }
 }
@@ -6,6 +6,7 @@
 
 #include "backend/entity/ai/common/MemoryAllocator.h"
 #include "backend/entity/ai/common/MoveVector.h"
+#include "SteeringBatch.h"
 #include "backend/entity/ai/AIFactories.h"
 
 namespace backend {
@@ -54,10 +55,25 @@ public:
 	 */
 	virtual MoveVector execute (const AIPtr& ai, float speed) const = 0;
 
+	/**
+	 * @brief Calculates the @c MoveVector values for all characters of the batch
+	 *
+	 * The default implementation calls @c execute() for every character. Steerings that only need the
+	 * position, orientation and speed of the characters should override this with a loop over the arrays.
+	 * @param[out] results Already reset to the size of the batch - so every character that is not touched
+	 * is @c MoveVectorState::Invalid
+	 */
+	virtual void executeBatch (const SteeringBatch& batch, SteeringResults& results) const;
+
 	MoveVector seek(const glm::vec3& pos, const glm::vec3& target, float speed) const;
 	inline MoveVector flee(const glm::vec3& pos, const glm::vec3& target, float speed) const {
 		return seek(target, pos, speed);
 	}
+
+	/**
+	 * @brief @c seek() (or @c flee() if @c away is @c true) for all characters of the batch
+	 */
+	void seekBatch(const SteeringBatch& batch, const glm::vec3& target, bool away, SteeringResults& results) const;
 };
 
 /**
@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "SteeringBatch.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+
+namespace backend {
+namespace movement {
+
+void SteeringBatch::clear() {
+	zone = nullptr;
+	ais.clear();
+	x.clear();
+	y.clear();
+	z.clear();
+	orientation.clear();
+	speed.clear();
+	deltaSeconds.clear();
+}
+
+void SteeringBatch::add(const AIPtr& ai, float chrSpeed, float chrDeltaSeconds) {
+	const ICharacterPtr& chr = ai->getCharacter();
+	const glm::vec3& pos = chr->getPosition();
+	ais.push_back(ai);
+	x.push_back(pos.x);
+	y.push_back(pos.y);
+	z.push_back(pos.z);
+	orientation.push_back(chr->getOrientation());
+	speed.push_back(chrSpeed);
+	deltaSeconds.push_back(chrDeltaSeconds);
+}
+
+void SteeringResults::reset(size_t size) {
+	x.resize(size);
+	y.resize(size);
+	z.resize(size);
+	rotation.resize(size);
+	weight.resize(size);
+	state.resize(size);
+	for (size_t i = 0; i < size; ++i) {
+		x[i] = y[i] = z[i] = rotation[i] = weight[i] = 0.0f;
+		state[i] = MoveVectorState::Invalid;
+	}
+}
+
+}
+}
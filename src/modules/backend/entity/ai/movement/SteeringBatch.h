@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "backend/entity/ai/common/MoveVector.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+#include <memory>
+
+namespace backend {
+
+class AI;
+typedef std::shared_ptr<AI> AIPtr;
+class Zone;
+
+namespace movement {
+
+/**
+ * @brief The characters of one zone that are moved by the same steering in one tick - as structure of arrays
+ *
+ * @sa SteeringQueue
+ */
+struct SteeringBatch {
+	/** the zone of all the characters in this batch */
+	Zone* zone = nullptr;
+	core::DynamicArray<AIPtr> ais;
+	core::DynamicArray<float> x;
+	core::DynamicArray<float> y;
+	core::DynamicArray<float> z;
+	core::DynamicArray<float> orientation;
+	core::DynamicArray<float> speed;
+	core::DynamicArray<float> deltaSeconds;
+
+	void clear();
+	/**
+	 * @brief Gathers the position and the orientation of the character of the given @c AI
+	 */
+	void add(const AIPtr& ai, float speed, float deltaSeconds);
+	size_t size() const;
+	glm::vec3 position(size_t index) const;
+};
+
+/**
+ * @brief The @c MoveVector values of a steering for every character of a @c SteeringBatch - as structure of arrays
+ */
+struct SteeringResults {
+	core::DynamicArray<float> x;
+	core::DynamicArray<float> y;
+	core::DynamicArray<float> z;
+	core::DynamicArray<float> rotation;
+	/** the accumulated weights while blending several steerings - see @c WeightedSteering::executeBatch() */
+	core::DynamicArray<float> weight;
+	core::DynamicArray<MoveVectorState> state;
+
+	/**
+	 * @brief Resizes the arrays and resets all values to zero and @c MoveVectorState::Invalid
+	 */
+	void reset(size_t size);
+	void set(size_t index, const MoveVector& mv);
+	size_t size() const;
+};
+
+inline size_t SteeringBatch::size() const {
+	return ais.size();
+}
+
+inline glm::vec3 SteeringBatch::position(size_t index) const {
+	return glm::vec3(x[index], y[index], z[index]);
+}
+
+inline size_t SteeringResults::size() const {
+	return state.size();
+}
+
+inline void SteeringResults::set(size_t index, const MoveVector& mv) {
+	const glm::vec3& v = mv.getVector();
+	x[index] = v.x;
+	y[index] = v.y;
+	z[index] = v.z;
+	rotation[index] = mv.getRotation();
+	state[index] = mv.state();
+}
+
+}
+}
@@ -0,0 +1,169 @@
+/**
+ * @file
+ */
+
+#include "SteeringQueue.h"
+#include "WeightedSteering.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "core/Algorithm.h"
+#include "core/Common.h"
+#include "core/GLM.h"
+#include "core/concurrent/ThreadPool.h"
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace backend {
+namespace movement {
+
+bool SteeringQueue::push(const AIPtr& ai, const WeightedSteering& steering, int nodeId, float speed, int64_t deltaMillis) {
+	// a failed node must not move the character - another node might move it instead
+	const bool probe = _invalid.find(key(ai->getId(), nodeId)) != _invalid.end();
+	const float deltaSeconds = static_cast<float>(deltaMillis) / 1000.0f;
+	core::ScopedLock lock(_lock);
+	_requests.push_back(Request{ai, &steering, nodeId, speed, deltaSeconds, probe});
+	return !probe;
+}
+
+void SteeringQueue::clear() {
+	core::ScopedLock lock(_lock);
+	_requests.clear();
+	_invalid.clear();
+}
+
+void SteeringQueue::execute(Worker& worker, const WeightedSteering& steering) const {
+	SteeringBatch& batch = worker.batch;
+	SteeringResults& results = worker.results;
+	steering.executeBatch(batch, results, worker.scratch);
+
+	const size_t size = batch.size();
+	float* __restrict x = batch.x.data();
+	float* __restrict y = batch.y.data();
+	float* __restrict z = batch.z.data();
+	float* __restrict orientation = batch.orientation.data();
+	const float* __restrict deltaSeconds = batch.deltaSeconds.data();
+	const float* __restrict vx = results.x.data();
+	const float* __restrict vy = results.y.data();
+	const float* __restrict vz = results.z.data();
+	const float* __restrict rotation = results.rotation.data();
+	const float pi = glm::pi<float>();
+	// the characters without a valid move vector are not written back
+	for (size_t i = 0; i < size; ++i) {
+		x[i] += vx[i] * deltaSeconds[i];
+		y[i] += vy[i] * deltaSeconds[i];
+		z[i] += vz[i] * deltaSeconds[i];
+		const float src = orientation[i] - pi;
+		const float dest = rotation[i] - pi;
+		orientation[i] = glm::mix(src, dest, deltaSeconds[i]) + pi;
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		const MoveVectorState state = results.state[i];
+		const AIPtr& ai = batch.ais[i];
+		if (state == MoveVectorState::Invalid) {
+			worker.invalid.push_back(key(ai->getId(), worker.nodeIds[i]));
+			continue;
+		}
+		if (state == MoveVectorState::TargetReached || worker.probes[i]) {
+			continue;
+		}
+		const ICharacterPtr& chr = ai->getCharacter();
+		const glm::vec3 pos = batch.position(i);
+		glm_assert_vec3(pos);
+		chr->setPosition(pos);
+		chr->setOrientation(orientation[i]);
+	}
+}
+
+void SteeringQueue::execute(Worker& worker, Zone* zone) const {
+	const core::DynamicArray<Request>& requests = _processing;
+	// all requests of the same steering node end up in one batch - in character id order to be deterministic
+	core::DynamicArray<int>& sorted = worker.sorted;
+	core::sort(sorted.begin(), sorted.end(), [&] (int a, int b) {
+		const Request& ra = requests[a];
+		const Request& rb = requests[b];
+		if (ra.steering != rb.steering) {
+			return ra.steering < rb.steering;
+		}
+		return ra.ai->getId() < rb.ai->getId();
+	});
+
+	size_t begin = 0u;
+	while (begin < sorted.size()) {
+		const WeightedSteering* steering = requests[sorted[begin]].steering;
+		worker.batch.clear();
+		worker.batch.zone = zone;
+		worker.nodeIds.clear();
+		worker.probes.clear();
+		size_t end = begin;
+		for (; end < sorted.size(); ++end) {
+			const Request& r = requests[sorted[end]];
+			if (r.steering != steering) {
+				break;
+			}
+			worker.batch.add(r.ai, r.speed, r.deltaSeconds);
+			worker.nodeIds.push_back(r.nodeId);
+			worker.probes.push_back(r.probe);
+		}
+		execute(worker, *steering);
+		begin = end;
+	}
+	worker.batch.clear();
+}
+
+void SteeringQueue::update(Zone* zone, core::ThreadPool& threadPool) {
+	core_trace_scoped(SteeringQueueUpdate);
+	_processing.clear();
+	{
+		// swap the buffers to keep their memory
+		core::ScopedLock lock(_lock);
+		core::DynamicArray<Request> tmp(core::move(_requests));
+		_requests = core::move(_processing);
+		_processing = core::move(tmp);
+	}
+	_invalid.clear();
+	const core::DynamicArray<Request>& requests = _processing;
+	if (requests.empty()) {
+		return;
+	}
+
+	const size_t maxWorkers = (requests.size() + MinRequestsPerWorker - 1u) / MinRequestsPerWorker;
+	const size_t workerCount = core_max((size_t)1u, core_min(threadPool.size(), maxWorkers));
+	if (_workers.size() < workerCount) {
+		_workers.resize(workerCount);
+	}
+	for (size_t w = 0u; w < workerCount; ++w) {
+		_workers[w].sorted.clear();
+		_workers[w].invalid.clear();
+	}
+	// all requests of a character are handled by the same worker - the steerings of one character are
+	// applied one after another
+	for (size_t i = 0; i < requests.size(); ++i) {
+		const size_t w = (size_t)(uint32_t)requests[i].ai->getId() % workerCount;
+		_workers[w].sorted.push_back((int)i);
+	}
+
+	if (workerCount == 1u) {
+		execute(_workers[0], zone);
+	} else {
+		std::vector<std::future<void> > results;
+		results.reserve(workerCount);
+		for (size_t w = 0u; w < workerCount; ++w) {
+			Worker* worker = &_workers[w];
+			results.emplace_back(threadPool.enqueue([this, worker, zone] () { execute(*worker, zone); }));
+		}
+		for (auto& result : results) {
+			result.wait();
+		}
+	}
+
+	for (size_t w = 0u; w < workerCount; ++w) {
+		for (uint64_t k : _workers[w].invalid) {
+			_invalid.insert(k);
+		}
+	}
+	_processing.clear();
+}
+
+}
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "SteeringBatch.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include "ai-shared/common/CharacterId.h"
+#include <unordered_set>
+#include <vector>
+#include <stdint.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace backend {
+namespace movement {
+
+class WeightedSteering;
+
+/**
+ * @brief Collects the steering requests of the @c Steer nodes of one @c Zone tick and evaluates them
+ * after all the behaviour trees of the zone were ticked
+ *
+ * The characters that are moved by the same steering are gathered into one @c SteeringBatch, the
+ * steerings are evaluated over the whole batch and the results are integrated and written back to
+ * the characters.
+ *
+ * The requests are split by character over the workers of the zone thread pool - all requests of one
+ * character are handled by the same worker in the same order as if there was only one worker.
+ */
+class SteeringQueue {
+private:
+	struct Request {
+		AIPtr ai;
+		const WeightedSteering* steering;
+		int nodeId;
+		float speed;
+		float deltaSeconds;
+		/**
+		 * the last evaluation was invalid - the steering is only evaluated to find out whether it is valid
+		 * again, the character isn't moved
+		 */
+		bool probe;
+	};
+	/**
+	 * @brief The state of one worker of the @c update() call
+	 */
+	struct Worker {
+		/** indices into @c _processing - sorted by steering */
+		core::DynamicArray<int> sorted;
+		/** the node ids of the requests in @c batch */
+		core::DynamicArray<int> nodeIds;
+		core::DynamicArray<bool> probes;
+		/** the keys of the requests with an invalid evaluation */
+		core::DynamicArray<uint64_t> invalid;
+		SteeringBatch batch;
+		SteeringResults results;
+		SteeringResults scratch;
+	};
+	/** don't hand out less requests to a worker than this */
+	static constexpr size_t MinRequestsPerWorker = 64u;
+
+	core_trace_mutex(core::Lock, _lock, "SteeringQueue");
+	core::DynamicArray<Request> _requests core_thread_guarded_by(_lock);
+	/**
+	 * @brief The character and node ids of the requests that were invalid in the last @c update() call
+	 * @note Only modified in @c update() - which is not called while the behaviour trees are ticked
+	 */
+	std::unordered_set<uint64_t> _invalid;
+
+	/** the requests of the current @c update() call */
+	core::DynamicArray<Request> _processing;
+	std::vector<Worker> _workers;
+
+	static uint64_t key(ai::CharacterId id, int nodeId);
+	void execute(Worker& worker, Zone* zone) const;
+	void execute(Worker& worker, const WeightedSteering& steering) const;
+public:
+	/**
+	 * @brief Schedules the movement of the character of the given @c AI for the next @c update() call
+	 * @return @c false if the last evaluation of this request was invalid - the character isn't moved, but
+	 * the steering is evaluated again to find out whether it is valid again. It stays invalid until then.
+	 * @note This is thread safe
+	 */
+	bool push(const AIPtr& ai, const WeightedSteering& steering, int nodeId, float speed, int64_t deltaMillis);
+
+	/**
+	 * @brief Evaluates all the scheduled steerings and moves the characters
+	 * @param[in] zone The zone of all the characters that were pushed
+	 * @param[in] threadPool The workers to evaluate the steerings with - the caller waits for them
+	 */
+	void update(Zone* zone, core::ThreadPool& threadPool);
+
+	/**
+	 * @brief Forget all the requests and the state of the last evaluation
+	 */
+	void clear();
+};
+
+inline uint64_t SteeringQueue::key(ai::CharacterId id, int nodeId) {
+	return ((uint64_t)(uint32_t)id << 32) | (uint64_t)(uint32_t)nodeId;
+}
+
+}
+}
@@ -26,5 +26,12 @@ MoveVector TargetFlee::execute (const AIPtr& ai, float speed) const {
 
 }
 
+void TargetFlee::executeBatch (const SteeringBatch& batch, SteeringResults& results) const {
+	if (!isValid()) {
+		return;
+	}
+	seekBatch(batch, _target, true, results);
+}
+
 }
 }
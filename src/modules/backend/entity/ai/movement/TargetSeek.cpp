@@ -26,5 +26,12 @@ MoveVector TargetSeek::execute (const AIPtr& ai, float speed) const {
 
 }
 
+void TargetSeek::executeBatch (const SteeringBatch& batch, SteeringResults& results) const {
+	if (!isValid()) {
+		return;
+	}
+	seekBatch(batch, _target, false, results);
+}
+
 }
 }
@@ -23,6 +23,7 @@ public:
 	inline bool isValid () const;
 
 	virtual MoveVector execute (const AIPtr& ai, float speed) const override;
+	void executeBatch (const SteeringBatch& batch, SteeringResults& results) const override;
 };
 
 }
@@ -26,5 +26,22 @@ MoveVector Wander::execute (const AIPtr& ai, float speed) const {
 	return MoveVector(v * speed, chr->random().randomBinomial() * _rotation);
 }
 
+void Wander::executeBatch (const SteeringBatch& batch, SteeringResults& results) const {
+	const size_t size = batch.size();
+	const float* __restrict orientation = batch.orientation.data();
+	const float* __restrict speed = batch.speed.data();
+	float* __restrict rx = results.x.data();
+	float* __restrict rz = results.z.data();
+	for (size_t i = 0; i < size; ++i) {
+		rx[i] = glm::cos(orientation[i]) * speed[i];
+		rz[i] = glm::sin(orientation[i]) * speed[i];
+	}
+	for (size_t i = 0; i < size; ++i) {
+		const backend::ICharacterPtr& chr = batch.ais[i]->getCharacter();
+		results.rotation[i] = chr->random().randomBinomial() * _rotation;
+		results.state[i] = MoveVectorState::Valid;
+	}
+}
+
 }
 }
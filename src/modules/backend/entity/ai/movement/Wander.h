@@ -23,6 +23,7 @@ public:
 	explicit Wander(const core::String& parameter);
 
 	MoveVector execute (const AIPtr& ai, float speed) const override;
+	void executeBatch (const SteeringBatch& batch, SteeringResults& results) const override;
 };
 
 }
@@ -52,5 +52,39 @@ MoveVector WeightedSteering::execute (const AIPtr& ai, float speed) const {
 	return MoveVector(vecBlended * scale, glm::mod(angularBlended * scale, glm::two_pi<float>()));
 }
 
+void WeightedSteering::executeBatch (const SteeringBatch& batch, SteeringResults& results, SteeringResults& scratch) const {
+	const size_t size = batch.size();
+	results.reset(size);
+	for (const WeightedData& wd : _steerings) {
+		const float weight = wd.weight;
+		scratch.reset(size);
+		wd.steering->executeBatch(batch, scratch);
+		for (size_t i = 0; i < size; ++i) {
+			// like in execute() the state of the last steering wins
+			results.state[i] = scratch.state[i];
+			if (scratch.state[i] != MoveVectorState::Valid) {
+				continue;
+			}
+			results.x[i] += scratch.x[i] * weight;
+			results.y[i] += scratch.y[i] * weight;
+			results.z[i] += scratch.z[i] * weight;
+			results.rotation[i] += scratch.rotation[i] * weight;
+			results.weight[i] += weight;
+		}
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		if (results.state[i] != MoveVectorState::Valid) {
+			results.set(i, results.state[i] == MoveVectorState::Invalid ? MoveVector::Invalid : MoveVector::TargetReached);
+			continue;
+		}
+		const float scale = 1.0f / results.weight[i];
+		results.x[i] *= scale;
+		results.y[i] *= scale;
+		results.z[i] *= scale;
+		results.rotation[i] = glm::mod(results.rotation[i] * scale, glm::two_pi<float>());
+	}
+}
+
 }
 }
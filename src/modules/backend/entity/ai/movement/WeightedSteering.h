@@ -31,6 +31,13 @@ public:
 	explicit WeightedSteering(const WeightedSteerings& steerings);
 
 	MoveVector execute (const AIPtr& ai, float speed) const;
+
+	/**
+	 * @brief Blends the batch results of all the steerings - see @c execute()
+	 * @param[out] results The blended values - resized to the batch size
+	 * @param[out] scratch Buffer for the results of the single steerings
+	 */
+	void executeBatch (const SteeringBatch& batch, SteeringResults& results, SteeringResults& scratch) const;
 };
 
 }
@@ -0,0 +1,17 @@
+/**
+ * @file
+ */
+
+#include "RequestStateHandler.h"
+#include "Server.h"
+
+namespace backend {
+
+RequestStateHandler::RequestStateHandler(Server& server) : _server(server) {
+}
+
+void RequestStateHandler::executeWithRaw(void* attachment, const ai::RequestState* message, const uint8_t* rawData, size_t rawDataSize) {
+	_server.requestState((ENetPeer*)attachment);
+}
+
+}
@@ -0,0 +1,25 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "network/IMsgProtocolHandler.h"
+#include "AIMessages_generated.h"
+
+namespace backend {
+
+class Server;
+
+/**
+ * @brief The debugger asks for a full snapshot of the debugged zone
+ */
+class RequestStateHandler: public network::IMsgProtocolHandler<ai::RequestState, void> {
+private:
+	Server& _server;
+public:
+	explicit RequestStateHandler(Server& server);
+
+	void executeWithRaw(void* attachment, const ai::RequestState* message, const uint8_t* rawData, size_t rawDataSize) override;
+};
+
+}
@@ -15,6 +15,7 @@
 #include "DeleteNodeHandler.h"
 #include "UpdateNodeHandler.h"
 #include "ExecuteCommandHandler.h"
+#include "RequestStateHandler.h"
 
 #include "attrib/ShadowAttributes.h"
 #include "backend/entity/ai/condition/ConditionParser.h"
@@ -22,6 +23,7 @@
 #include "backend/entity/ai/zone/Zone.h"
 #include "core/EventBus.h"
 #include "core/SharedPtr.h"
+#include "core/Algorithm.h"
 #include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
 #include "flatbuffers/flatbuffers.h"
@@ -52,6 +54,7 @@ Server::Server(AIRegistry& aiRegistry, const metric::MetricPtr& metric,
 	r->registerHandler(ai::MsgType::DeleteNode, std::make_shared<DeleteNodeHandler>(*this));
 	r->registerHandler(ai::MsgType::UpdateNode, std::make_shared<UpdateNodeHandler>(*this));
 	r->registerHandler(ai::MsgType::ExecuteCommand, std::make_shared<ExecuteCommandHandler>());
+	r->registerHandler(ai::MsgType::RequestState, std::make_shared<RequestStateHandler>(*this));
 
 	_eventBus = std::make_shared<core::EventBus>(2);
 	_eventBus->subscribe<network::NewConnectionEvent>(*this);
@@ -79,6 +82,11 @@ void Server::onEvent(const network::NewConnectionEvent& evt) {
 
 void Server::onEvent(const network::DisconnectEvent& event) {
 	Log::info("remote debugger disconnect");
+	Event disconnectEvent;
+	disconnectEvent.type = EV_DISCONNECT;
+	disconnectEvent.data.peer = event.peer();
+	enqueueEvent(disconnectEvent);
+
 	Zone* zone = _zone;
 	if (zone == nullptr) {
 		return;
@@ -105,43 +113,113 @@ bool Server::start() {
 	return _network->bind(_port, _hostname, 1, 1);
 }
 
-void Server::broadcastState(const Zone* zone) {
-	core_trace_scoped(AIServerBroadcastState);
-	_broadcastMask |= SV_BROADCAST_STATE;
-	core::DynamicArray<flatbuffers::Offset<ai::State>> offsets;
-	offsets.reserve(zone->size());
+Server::Client* Server::client(ENetPeer* peer) {
+	for (Client& c : _clients) {
+		if (c.peer == peer) {
+			return &c;
+		}
+	}
+	return nullptr;
+}
+
+void Server::updateStates(const Zone* zone) {
+	_currentAIs.clear();
+	_currentAIs.reserve(zone->size());
 	auto func = [&] (const AIPtr& ai) {
-		const ICharacterPtr& chr = ai->getCharacter();
-		const glm::vec3& chrPosition = chr->getPosition();
-		const backend::Npc& npc = getNpc(ai);
-		const glm::vec3& chrHomePosition = npc.homePosition();
-		const glm::vec3& chrTargetPosition = npc.targetPosition();
-		const ai::Vec3 position(chrPosition.x, chrPosition.y, chrPosition.z);
-		const ai::Vec3 targetPosition(chrTargetPosition.x, chrTargetPosition.y, chrTargetPosition.z);
-		const ai::Vec3 homePosition(chrHomePosition.x, chrHomePosition.y, chrHomePosition.z);
-		const ai::CharacterMetaAttributes& chrMetaAttributes = chr->getMetaAttributes();
-		auto metaAttributeIter = chrMetaAttributes.begin();
-		auto metaAttributes = _stateFBB.CreateVector<flatbuffers::Offset<ai::MapEntry>>(chrMetaAttributes.size(),
-			[&] (size_t i) {
-				const core::String& sname = metaAttributeIter->first;
-				const core::String& svalue = metaAttributeIter->second;
-				auto name = _stateFBB.CreateString(sname.c_str(), sname.size());
-				auto value = _stateFBB.CreateString(svalue.c_str(), svalue.size());
-				++metaAttributeIter;
-				return ai::CreateMapEntry(_stateFBB, name, value);
-			});
-		const attrib::ShadowAttributes& chrShadowAttributes = chr->shadowAttributes();
-		auto attributes = _stateFBB.CreateVector<flatbuffers::Offset<ai::AttribEntry>>((size_t)attrib::Type::MAX,
-			[&] (size_t i) {
-				attrib::Type attribType = (attrib::Type)i;
-				return ai::CreateAttribEntry(_stateFBB, (int)i, chrShadowAttributes.current(attribType), chrShadowAttributes.max(attribType));
-			});
-		offsets.push_back(ai::CreateState(_stateFBB, chr->getId(), &position, &homePosition, &targetPosition, chr->getOrientation(), metaAttributes, attributes));
+		_currentAIs.push_back(ai);
 	};
 	zone->execute(func);
+	core::sort(_currentAIs.begin(), _currentAIs.end(), [] (const AIPtr& a, const AIPtr& b) {
+		return a->getId() < b->getId();
+	});
+	_currentStates.resize(_currentAIs.size());
+	for (size_t i = 0u; i < _currentAIs.size(); ++i) {
+		const AIPtr& ai = _currentAIs[i];
+		_currentStates[i].update(*ai->getCharacter().get(), getNpc(ai));
+	}
+}
+
+flatbuffers::Offset<ai::State> Server::createState(const AIPtr& ai) {
+	const ICharacterPtr& chr = ai->getCharacter();
+	const glm::vec3& chrPosition = chr->getPosition();
+	const backend::Npc& npc = getNpc(ai);
+	const glm::vec3& chrHomePosition = npc.homePosition();
+	const glm::vec3& chrTargetPosition = npc.targetPosition();
+	const ai::Vec3 position(chrPosition.x, chrPosition.y, chrPosition.z);
+	const ai::Vec3 targetPosition(chrTargetPosition.x, chrTargetPosition.y, chrTargetPosition.z);
+	const ai::Vec3 homePosition(chrHomePosition.x, chrHomePosition.y, chrHomePosition.z);
+	const ai::CharacterMetaAttributes& chrMetaAttributes = chr->getMetaAttributes();
+	auto metaAttributeIter = chrMetaAttributes.begin();
+	auto metaAttributes = _stateFBB.CreateVector<flatbuffers::Offset<ai::MapEntry>>(chrMetaAttributes.size(),
+		[&] (size_t i) {
+			const core::String& sname = metaAttributeIter->first;
+			const core::String& svalue = metaAttributeIter->second;
+			auto name = _stateFBB.CreateString(sname.c_str(), sname.size());
+			auto value = _stateFBB.CreateString(svalue.c_str(), svalue.size());
+			++metaAttributeIter;
+			return ai::CreateMapEntry(_stateFBB, name, value);
+		});
+	const attrib::ShadowAttributes& chrShadowAttributes = chr->shadowAttributes();
+	auto attributes = _stateFBB.CreateVector<flatbuffers::Offset<ai::AttribEntry>>((size_t)attrib::Type::MAX,
+		[&] (size_t i) {
+			attrib::Type attribType = (attrib::Type)i;
+			return ai::CreateAttribEntry(_stateFBB, (int)i, chrShadowAttributes.current(attribType), chrShadowAttributes.max(attribType));
+		});
+	return ai::CreateState(_stateFBB, chr->getId(), &position, &homePosition, &targetPosition, chr->getOrientation(), metaAttributes, attributes);
+}
+
+void Server::sendState(Client& client) {
+	if (client.full) {
+		client.snapshot.clear();
+	}
+	client.snapshot.diff(_currentStates, _changedStates, _removedStates);
+	if (!client.full && _changedStates.empty() && _removedStates.empty()) {
+		return;
+	}
+	// at least one state is sent - the remaining ones are sent with the next message. The snapshot puts the
+	// characters that waited the longest in front, so a small budget doesn't starve the high character ids.
+	core::DynamicArray<flatbuffers::Offset<ai::State>> offsets;
+	offsets.reserve(_changedStates.size());
+	for (int idx : _changedStates) {
+		if (!offsets.empty() && _stateFBB.GetSize() >= _stateBroadcastBudget) {
+			break;
+		}
+		offsets.push_back(createState(_currentAIs[idx]));
+	}
 	auto states = _stateFBB.CreateVector(offsets.data(), offsets.size());
-	_messageSender->broadcastServerMessage(_stateFBB, ai::MsgType::StateWorld,
-		ai::CreateStateWorld(_stateFBB, states).Union());
+	auto removed = _stateFBB.CreateVector(_removedStates.data(), _removedStates.size());
+	_messageSender->sendServerMessage(client.peer, _stateFBB, ai::MsgType::StateWorld,
+		ai::CreateStateWorld(_stateFBB, states, client.full, removed).Union());
+	client.snapshot.apply(_currentStates, _changedStates.data(), offsets.size(), _removedStates);
+	client.full = false;
+}
+
+void Server::broadcastState(const Zone* zone, bool force) {
+	core_trace_scoped(AIServerBroadcastState);
+	_broadcastMask |= SV_BROADCAST_STATE;
+	if (!force && _time - _lastStateBroadcast < _stateBroadcastInterval) {
+		return;
+	}
+	_lastStateBroadcast = _time;
+	if (_clients.empty()) {
+		return;
+	}
+	updateStates(zone);
+	for (Client& c : _clients) {
+		sendState(c);
+	}
+}
+
+void Server::requestState(ENetPeer* peer) {
+	Event event;
+	event.type = EV_REQUESTSTATE;
+	event.data.peer = peer;
+	enqueueEvent(event);
+}
+
+void Server::setStateBroadcastLimits(int64_t intervalMillis, size_t byteBudget) {
+	_stateBroadcastInterval = intervalMillis;
+	_stateBroadcastBudget = byteBudget;
 }
 
 void Server::addChildren(const TreeNodePtr& node, core::DynamicArray<flatbuffers::Offset<ai::StateNodeStatic>>& offsets) const {
@@ -294,7 +372,7 @@ void Server::handleEvents(Zone* zone, bool pauseState) {
 					return;
 				ai->setPause(false);
 				ai->update(queuedStepMillis, true);
-				ai->getBehaviour()->execute(ai, queuedStepMillis);
+				AI::execute(ai, queuedStepMillis);
 				ai->setPause(true);
 			};
 			if (zone != nullptr) {
@@ -334,6 +412,11 @@ void Server::handleEvents(Zone* zone, bool pauseState) {
 			break;
 		}
 		case EV_NEWCONNECTION: {
+			if (client(event.data.peer) == nullptr) {
+				Client c;
+				c.peer = event.data.peer;
+				_clients.push_back(core::move(c));
+			}
 			_messageSender->broadcastServerMessage(_pauseFBB, ai::MsgType::Pause,
 				ai::CreatePause(_pauseFBB, pauseState).Union());
 
@@ -383,9 +466,35 @@ void Server::handleEvents(Zone* zone, bool pauseState) {
 					z->setDebug(debug);
 				}
 			}
+			// the known states belong to the previous zone
+			for (Client& c : _clients) {
+				c.full = true;
+			}
 
 			break;
 		}
+		case EV_DISCONNECT: {
+			for (size_t i = 0u; i < _clients.size(); ++i) {
+				if (_clients[i].peer == event.data.peer) {
+					_clients.erase(i);
+					break;
+				}
+			}
+			break;
+		}
+		case EV_REQUESTSTATE: {
+			Client* c = client(event.data.peer);
+			if (c == nullptr) {
+				break;
+			}
+			c->full = true;
+			// there is no periodic broadcast while paused - serve the request right away. Otherwise it's
+			// served by the next broadcast.
+			if (pauseState && zone != nullptr) {
+				broadcastState(zone, true);
+			}
+			break;
+		}
 		case EV_MAX:
 			break;
 		}
@@ -405,6 +514,14 @@ void Server::resetSelection() {
 	_selectedCharacterId = AI_NOTHING_SELECTED;
 }
 
+void Server::invalidateCompiledBehaviour(const AIPtr& ai) {
+	// the tree is shared - all the entities with the same behaviour fall back to the tree nodes
+	const CompiledTreePtr& compiled = ai->getCompiledBehaviour();
+	if (compiled) {
+		compiled->invalidate();
+	}
+}
+
 bool Server::updateNode(const ai::CharacterId& characterId, int32_t nodeId, const core::String& name, const core::String& type, const core::String& condition) {
 	Zone* zone = _zone;
 	if (zone == nullptr) {
@@ -442,6 +559,7 @@ bool Server::updateNode(const ai::CharacterId& characterId, int32_t nodeId, cons
 			return false;
 		}
 		parent->replaceChild(nodeId, newNode);
+		invalidateCompiledBehaviour(ai);
 	}
 
 	Event event;
@@ -480,6 +598,7 @@ bool Server::addNode(const ai::CharacterId& characterId, int32_t parentNodeId, c
 	if (!node->addChild(newNode)) {
 		return false;
 	}
+	invalidateCompiledBehaviour(ai);
 
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
@@ -506,6 +625,7 @@ bool Server::deleteNode(const ai::CharacterId& characterId, int32_t nodeId) {
 		return false;
 	}
 	parent->replaceChild(nodeId, TreeNodePtr());
+	invalidateCompiledBehaviour(ai);
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
 	event.data.zone = zone;
@@ -579,7 +699,7 @@ void Server::update(int64_t deltaTime) {
 	if (zone != nullptr) {
 		if (!pauseState) {
 			if ((_broadcastMask & SV_BROADCAST_STATE) == 0) {
-				broadcastState(zone);
+				broadcastState(zone, false);
 			}
 			if ((_broadcastMask & SV_BROADCAST_CHRDETAILS) == 0) {
 				broadcastCharacterDetails(zone);
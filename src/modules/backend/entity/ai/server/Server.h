@@ -8,6 +8,7 @@
 #include "backend/entity/ai/AIRegistry.h"
 #include "backend/entity/ai/tree/TreeNode.h"
 #include "backend/entity/ai/server/AIMessageSender.h"
+#include "backend/entity/ai/server/StateSnapshot.h"
 #include "core/EventBus.h"
 #include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
@@ -34,6 +35,11 @@ class Zone;
  * clients. If someone selected a particular @ai{AI} instance by sending @ai{AISelectMessage} to the server, it
  * will also broadcast an @ai{AICharacterDetailsMessage} to all connected clients.
  *
+ * The world state is sent incrementally: the server remembers the character states every client has received
+ * and only sends the added, changed and removed characters. The messages are rate limited and bounded by a byte
+ * budget (see @c setStateBroadcastLimits()) - characters that don't fit are sent with the next message. A full
+ * snapshot is only sent if the client connects, the debugged zone changes or the client requests it.
+ *
  * You can only debug one @ai{Zone} at the same time. The debugging session is shared between all connected clients.
  */
 class Server : public core::IEventBusHandler<network::NewConnectionEvent>,
@@ -60,6 +66,26 @@ protected:
 	core::AtomicPtr<Zone> _zone;
 	core::DynamicArray<core::String> _names;
 	uint32_t _broadcastMask = 0u;
+
+	/**
+	 * @brief A connected debugger and the character states it has received
+	 */
+	struct Client {
+		ENetPeer* peer = nullptr;
+		StateSnapshot snapshot;
+		/** the next state message tells the client to drop all the states it knows about */
+		bool full = true;
+	};
+	core::DynamicArray<Client> _clients;
+	/** the states of the characters of the debugged zone - sorted by character id */
+	CharacterStates _currentStates;
+	/** the ai instances of @c _currentStates */
+	core::DynamicArray<AIPtr> _currentAIs;
+	core::DynamicArray<int> _changedStates;
+	core::DynamicArray<ai::CharacterId> _removedStates;
+	int64_t _stateBroadcastInterval = 100;
+	size_t _stateBroadcastBudget = 64 * 1024;
+	int64_t _lastStateBroadcast = 0;
 	short _port;
 	core::String _hostname;
 
@@ -73,6 +99,8 @@ protected:
 		EV_PAUSE,
 		EV_RESET,
 		EV_SETDEBUG,
+		EV_DISCONNECT,
+		EV_REQUESTSTATE,
 
 		EV_MAX
 	};
@@ -92,12 +120,27 @@ protected:
 	core_trace_mutex(core::Lock, _lock, "AIServer");
 
 	void resetSelection();
+	/**
+	 * @brief The behaviour tree of the given entity was modified - the compiled version is outdated
+	 */
+	void invalidateCompiledBehaviour(const AIPtr& ai);
 
 	void addChildren(const TreeNodePtr& node, core::DynamicArray<flatbuffers::Offset<ai::StateNodeStatic>>& offsets) const;
 	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<ai::StateNode>>> addChildren(const TreeNodePtr& node, const AIPtr& ai) const;
 
+	/**
+	 * @brief Collect the current states of all characters of the zone
+	 */
+	void updateStates(const Zone* zone);
+	flatbuffers::Offset<ai::State> createState(const AIPtr& ai);
+	void sendState(Client& client);
+	Client* client(ENetPeer* peer);
+
 	// only call these from the Server::update method
-	void broadcastState(const Zone* zone);
+	/**
+	 * @param force Ignore the broadcast interval
+	 */
+	void broadcastState(const Zone* zone, bool force = true);
 	void broadcastCharacterDetails(const Zone* zone);
 	void broadcastStaticCharacterDetails(const Zone* zone);
 
@@ -184,6 +227,17 @@ public:
 	 */
 	void reset();
 
+	/**
+	 * @brief The given client will get a full snapshot of the zone with the next state message
+	 */
+	void requestState(ENetPeer* peer);
+
+	/**
+	 * @param intervalMillis The minimum amount of millis between two state messages
+	 * @param byteBudget The maximum size of a state message - at least one character is always sent
+	 */
+	void setStateBroadcastLimits(int64_t intervalMillis, size_t byteBudget);
+
 	/**
 	 * @brief Select a particular character (resp. @ai{AI} instance) and send detail
 	 * information to all the connected clients for this entity.
@@ -0,0 +1,133 @@
+/**
+ * @file
+ */
+
+#include "StateSnapshot.h"
+#include "backend/entity/Npc.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "attrib/ShadowAttributes.h"
+#include "core/Algorithm.h"
+
+namespace backend {
+
+namespace {
+
+// FNV-1a
+inline uint32_t hashBytes(uint32_t hash, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0u; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+}
+
+void CharacterState::update(const ICharacter& chr, const Npc& npc) {
+	id = chr.getId();
+	position = chr.getPosition();
+	homePosition = npc.homePosition();
+	targetPosition = npc.targetPosition();
+	orientation = chr.getOrientation();
+
+	uint32_t hash = 2166136261u;
+	const ai::CharacterMetaAttributes& metaAttributes = chr.getMetaAttributes();
+	for (auto i = metaAttributes.begin(); i != metaAttributes.end(); ++i) {
+		hash = hashBytes(hash, i->first.c_str(), i->first.size() + 1);
+		hash = hashBytes(hash, i->second.c_str(), i->second.size() + 1);
+	}
+	const attrib::ShadowAttributes& shadowAttributes = chr.shadowAttributes();
+	for (int i = 0; i < (int)attrib::Type::MAX; ++i) {
+		const double values[] = {shadowAttributes.current((attrib::Type)i), shadowAttributes.max((attrib::Type)i)};
+		hash = hashBytes(hash, values, sizeof(values));
+	}
+	attributesHash = hash;
+}
+
+bool CharacterState::operator==(const CharacterState& other) const {
+	return id == other.id && attributesHash == other.attributesHash && orientation == other.orientation
+		&& position == other.position && homePosition == other.homePosition && targetPosition == other.targetPosition;
+}
+
+void StateSnapshot::diff(const CharacterStates& current, core::DynamicArray<int>& changed, core::DynamicArray<ai::CharacterId>& removed) const {
+	changed.clear();
+	removed.clear();
+	// the message the state was last sent with - new characters are sorted in front of all the others
+	core::DynamicArray<uint32_t> sent;
+	sent.resize(current.size());
+	size_t i = 0u;
+	size_t j = 0u;
+	while (i < current.size() && j < _states.size()) {
+		const CharacterState& c = current[i];
+		const Entry& s = _states[j];
+		if (c.id < s.state.id) {
+			sent[i] = 0u;
+			changed.push_back((int)i++);
+		} else if (s.state.id < c.id) {
+			removed.push_back(s.state.id);
+			++j;
+		} else {
+			if (c != s.state) {
+				sent[i] = s.sent;
+				changed.push_back((int)i);
+			}
+			++i;
+			++j;
+		}
+	}
+	for (; i < current.size(); ++i) {
+		sent[i] = 0u;
+		changed.push_back((int)i);
+	}
+	for (; j < _states.size(); ++j) {
+		removed.push_back(_states[j].state.id);
+	}
+	core::sort(changed.begin(), changed.end(), [&] (int a, int b) {
+		if (sent[a] != sent[b]) {
+			return sent[a] < sent[b];
+		}
+		return a < b;
+	});
+}
+
+void StateSnapshot::apply(const CharacterStates& current, const int* sent, size_t sentAmount, const core::DynamicArray<ai::CharacterId>& removed) {
+	core::DynamicArray<int> sorted;
+	sorted.resize(sentAmount);
+	for (size_t i = 0u; i < sentAmount; ++i) {
+		sorted[i] = sent[i];
+	}
+	core::sort(sorted.begin(), sorted.end(), core::Less<int>());
+	const uint32_t message = ++_messages;
+
+	core::DynamicArray<Entry> states;
+	states.reserve(_states.size() + sentAmount);
+	size_t i = 0u;
+	size_t j = 0u;
+	size_t r = 0u;
+	while (i < sentAmount || j < _states.size()) {
+		if (j < _states.size() && r < removed.size() && _states[j].state.id == removed[r]) {
+			++j;
+			++r;
+			continue;
+		}
+		if (i >= sentAmount) {
+			states.push_back(_states[j++]);
+			continue;
+		}
+		const CharacterState& c = current[sorted[i]];
+		if (j >= _states.size() || c.id < _states[j].state.id) {
+			states.push_back(Entry{c, message});
+			++i;
+		} else if (_states[j].state.id < c.id) {
+			states.push_back(_states[j++]);
+		} else {
+			states.push_back(Entry{c, message});
+			++i;
+			++j;
+		}
+	}
+	_states = core::move(states);
+}
+
+}
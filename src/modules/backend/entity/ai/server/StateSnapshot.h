@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "ai-shared/common/CharacterId.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+
+namespace backend {
+
+class ICharacter;
+class Npc;
+
+/**
+ * @brief The parts of the @c ai::State message of one character that are compared to detect changes
+ */
+struct CharacterState {
+	ai::CharacterId id;
+	glm::vec3 position;
+	glm::vec3 homePosition;
+	glm::vec3 targetPosition;
+	float orientation;
+	/** hash over the meta attributes and the shadow attributes */
+	uint32_t attributesHash;
+
+	void update(const ICharacter& chr, const Npc& npc);
+
+	bool operator==(const CharacterState& other) const;
+	inline bool operator!=(const CharacterState& other) const {
+		return !(*this == other);
+	}
+};
+typedef core::DynamicArray<CharacterState> CharacterStates;
+
+/**
+ * @brief The character states that a debugger client has received
+ *
+ * Used by the @ai{Server} to only send the characters that were added, removed or changed since the last
+ * @c ai::StateWorld message. If not all changes fit into one message, the characters that were sent the
+ * longest time ago come first in the next one - so no character is starved by the byte budget.
+ */
+class StateSnapshot {
+private:
+	struct Entry {
+		CharacterState state;
+		/** the message the state was sent with */
+		uint32_t sent;
+	};
+	/** sorted by character id */
+	core::DynamicArray<Entry> _states;
+	/** the amount of messages that were recorded - @c 0 means not yet sent */
+	uint32_t _messages = 0u;
+public:
+	/**
+	 * @param[in] current The current states - sorted by character id
+	 * @param[out] changed The indices into @c current of the characters that are new or changed. The characters
+	 * the client doesn't know yet come first, followed by the changed ones that were sent the longest time ago.
+	 * @param[out] removed The ids of the characters that are no longer part of @c current
+	 */
+	void diff(const CharacterStates& current, core::DynamicArray<int>& changed, core::DynamicArray<ai::CharacterId>& removed) const;
+
+	/**
+	 * @brief Record what was sent to the client
+	 * @param[in] current The current states - sorted by character id
+	 * @param[in] sent The indices into @c current of the characters that were sent - in any order
+	 * @param[in] removed The ids of the characters that were sent as removed
+	 */
+	void apply(const CharacterStates& current, const int* sent, size_t sentAmount, const core::DynamicArray<ai::CharacterId>& removed);
+
+	void clear();
+	size_t size() const;
+};
+
+inline void StateSnapshot::clear() {
+	_states.clear();
+	_messages = 0u;
+}
+
+inline size_t StateSnapshot::size() const {
+	return _states.size();
+}
+
+}
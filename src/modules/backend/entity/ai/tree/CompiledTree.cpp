@@ -0,0 +1,291 @@
+/**
+ * @file
+ */
+
+#include "CompiledTree.h"
+#include "TreeNode.h"
+#include "ITimedNode.h"
+#include "Limit.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/common/Random.h"
+#include "backend/entity/ai/condition/ICondition.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+
+#define NOTSTARTED (-1)
+
+namespace backend {
+
+CompiledTree::CompiledTree(const TreeNodePtr& root) :
+		_root(root) {
+	add(root);
+}
+
+CompiledTreePtr CompiledTree::compile(const TreeNodePtr& root) {
+	if (!root) {
+		return CompiledTreePtr();
+	}
+	core_trace_scoped(CompileBehaviourTree);
+	return std::make_shared<CompiledTree>(root);
+}
+
+CompiledTree::Kind CompiledTree::kind(const TreeNodePtr& node) const {
+	const core::String& type = node->getType();
+	const int children = (int)node->getChildren().size();
+	if (type == "Sequence") {
+		return Kind::Sequence;
+	}
+	if (type == "PrioritySelector") {
+		return Kind::PrioritySelector;
+	}
+	if (type == "RandomSelector" && children <= MaxRandomChildren) {
+		return Kind::RandomSelector;
+	}
+	if (type == "Parallel") {
+		return Kind::Parallel;
+	}
+	// the decorators log an error and report an exception if they don't have exactly one child
+	if (children == 1) {
+		if (type == "Limit") {
+			return Kind::Limit;
+		}
+		if (type == "Invert") {
+			return Kind::Invert;
+		}
+		if (type == "Succeed") {
+			return Kind::Succeed;
+		}
+		if (type == "Fail") {
+			return Kind::Fail;
+		}
+	}
+	if (type == "Idle") {
+		return Kind::Timed;
+	}
+	return Kind::Node;
+}
+
+int CompiledTree::add(const TreeNodePtr& node) {
+	const int slot = (int)_nodes.size();
+	_slots.put(node->getId(), slot);
+
+	Node n;
+	n.node = node.get();
+	n.condition = node->getCondition().get();
+	n.alwaysTrue = n.condition != nullptr && n.condition->getName() == "True";
+	n.timed = nullptr;
+	n.kind = kind(node);
+	n.param = 0;
+	n.childOffset = (int32_t)_children.size();
+	n.childCount = 0;
+	if (n.kind == Kind::Limit) {
+		n.param = static_cast<const Limit*>(n.node)->_amount;
+	} else if (n.kind == Kind::Timed) {
+		n.timed = static_cast<ITimedNode*>(n.node);
+		n.param = n.timed->_millis;
+	}
+	_nodes.push_back(n);
+
+	if (n.kind != Kind::Node) {
+		const TreeNodes& children = node->getChildren();
+		const int32_t childCount = (int32_t)children.size();
+		const int32_t childOffset = (int32_t)_children.size();
+		// reserve the range first - the children of the children are appended behind it
+		_children.resize(_children.size() + childCount);
+		for (int32_t i = 0; i < childCount; ++i) {
+			_children[childOffset + i] = add(children[i]);
+		}
+		_nodes[slot].childOffset = childOffset;
+		_nodes[slot].childCount = childCount;
+	}
+	_nodes[slot].subtreeEnd = (int32_t)_nodes.size();
+	return slot;
+}
+
+int CompiledTree::slot(int nodeId) const {
+	int slot;
+	if (!_slots.get(nodeId, slot)) {
+		return -1;
+	}
+	return slot;
+}
+
+void CompiledTree::resetState(int slot, const AIPtr& entity, TreeNodeState* states) const {
+	const int end = _nodes[slot].subtreeEnd;
+	for (int i = slot; i < end; ++i) {
+		const Node& n = _nodes[i];
+		if (n.kind == Kind::Sequence) {
+			states[i].selector = AI_NOTHING_SELECTED;
+		} else if (n.kind == Kind::Node) {
+			n.node->resetState(entity);
+		}
+	}
+}
+
+ai::TreeNodeStatus CompiledTree::executeTimed(const Node& n, TreeNodeState& state, const AIPtr& entity, int64_t deltaMillis) const {
+	if (state.timerMillis == NOTSTARTED) {
+		state.timerMillis = n.param;
+		const ai::TreeNodeStatus status = n.timed->executeStart(entity, deltaMillis);
+		if (status == ai::TreeNodeStatus::FINISHED) {
+			state.timerMillis = NOTSTARTED;
+		}
+		return status;
+	}
+
+	if (state.timerMillis - deltaMillis > 0) {
+		state.timerMillis -= deltaMillis;
+		const ai::TreeNodeStatus status = n.timed->executeRunning(entity, deltaMillis);
+		if (status == ai::TreeNodeStatus::FINISHED) {
+			state.timerMillis = NOTSTARTED;
+		}
+		return status;
+	}
+
+	state.timerMillis = NOTSTARTED;
+	return n.timed->executeExpired(entity, deltaMillis);
+}
+
+ai::TreeNodeStatus CompiledTree::execute(int slot, const AIPtr& entity, TreeNodeState* states, int64_t deltaMillis, bool debug) const {
+	const Node& n = _nodes[slot];
+	if (n.kind == Kind::Node) {
+		return n.node->execute(entity, deltaMillis);
+	}
+
+	TreeNodeState& state = states[slot];
+	// same as TreeNode::execute() - the condition result is also needed by the debugger
+	if ((!n.alwaysTrue || debug) && !n.condition->evaluate(entity)) {
+		if (debug) {
+			state.lastStatus = ai::TreeNodeStatus::CANNOTEXECUTE;
+		}
+		return ai::TreeNodeStatus::CANNOTEXECUTE;
+	}
+	if (debug) {
+		state.lastExecMillis = entity->_time;
+	}
+
+	const int32_t* children = this->children(n);
+	ai::TreeNodeStatus result = ai::TreeNodeStatus::FINISHED;
+	switch (n.kind) {
+	case Kind::Sequence: {
+		for (int32_t i = core_max(0, state.selector); i < n.childCount; ++i) {
+			result = execute(children[i], entity, states, deltaMillis, debug);
+			if (result == ai::TreeNodeStatus::RUNNING) {
+				state.selector = i;
+				break;
+			} else if (result == ai::TreeNodeStatus::CANNOTEXECUTE || result == ai::TreeNodeStatus::FAILED) {
+				resetState(slot, entity, states);
+				break;
+			} else if (result == ai::TreeNodeStatus::EXCEPTION) {
+				break;
+			}
+		}
+		if (result != ai::TreeNodeStatus::RUNNING) {
+			resetState(slot, entity, states);
+		}
+		break;
+	}
+	case Kind::PrioritySelector: {
+		int32_t i = state.selector == AI_NOTHING_SELECTED ? 0 : state.selector;
+		for (int32_t j = 0; j < i; ++j) {
+			resetState(children[j], entity, states);
+		}
+		for (; i < n.childCount; ++i) {
+			result = execute(children[i], entity, states, deltaMillis, debug);
+			state.selector = result == ai::TreeNodeStatus::RUNNING ? i : AI_NOTHING_SELECTED;
+			resetState(children[i], entity, states);
+			if (result != ai::TreeNodeStatus::CANNOTEXECUTE && result != ai::TreeNodeStatus::FAILED) {
+				break;
+			}
+		}
+		for (++i; i < n.childCount; ++i) {
+			resetState(children[i], entity, states);
+		}
+		break;
+	}
+	case Kind::RandomSelector: {
+		int32_t shuffled[MaxRandomChildren];
+		core_memcpy(shuffled, children, n.childCount * sizeof(int32_t));
+		shuffle(shuffled, shuffled + n.childCount);
+		for (int32_t i = 0; i < n.childCount; ++i) {
+			const ai::TreeNodeStatus childResult = execute(shuffled[i], entity, states, deltaMillis, debug);
+			if (childResult == ai::TreeNodeStatus::RUNNING) {
+				continue;
+			}
+			if (childResult == ai::TreeNodeStatus::CANNOTEXECUTE || childResult == ai::TreeNodeStatus::FAILED) {
+				result = childResult;
+			}
+			resetState(shuffled[i], entity, states);
+		}
+		break;
+	}
+	case Kind::Parallel: {
+		bool running = false;
+		for (int32_t i = 0; i < n.childCount; ++i) {
+			const bool isActive = execute(children[i], entity, states, deltaMillis, debug) == ai::TreeNodeStatus::RUNNING;
+			if (!isActive) {
+				resetState(children[i], entity, states);
+			}
+			running |= isActive;
+		}
+		if (!running) {
+			resetState(slot, entity, states);
+		}
+		result = running ? ai::TreeNodeStatus::RUNNING : ai::TreeNodeStatus::FINISHED;
+		break;
+	}
+	case Kind::Limit: {
+		if (state.limit >= n.param) {
+			break;
+		}
+		const ai::TreeNodeStatus status = execute(children[0], entity, states, deltaMillis, debug);
+		++state.limit;
+		result = status == ai::TreeNodeStatus::RUNNING ? ai::TreeNodeStatus::RUNNING : ai::TreeNodeStatus::FAILED;
+		break;
+	}
+	case Kind::Invert: {
+		const ai::TreeNodeStatus status = execute(children[0], entity, states, deltaMillis, debug);
+		if (status == ai::TreeNodeStatus::FINISHED) {
+			result = ai::TreeNodeStatus::FAILED;
+		} else if (status == ai::TreeNodeStatus::FAILED || status == ai::TreeNodeStatus::CANNOTEXECUTE) {
+			result = ai::TreeNodeStatus::FINISHED;
+		} else if (status == ai::TreeNodeStatus::EXCEPTION) {
+			result = ai::TreeNodeStatus::EXCEPTION;
+		} else {
+			result = ai::TreeNodeStatus::RUNNING;
+		}
+		break;
+	}
+	case Kind::Succeed: {
+		const ai::TreeNodeStatus status = execute(children[0], entity, states, deltaMillis, debug);
+		result = status == ai::TreeNodeStatus::RUNNING ? ai::TreeNodeStatus::RUNNING : ai::TreeNodeStatus::FINISHED;
+		break;
+	}
+	case Kind::Fail: {
+		const ai::TreeNodeStatus status = execute(children[0], entity, states, deltaMillis, debug);
+		result = status == ai::TreeNodeStatus::RUNNING ? ai::TreeNodeStatus::RUNNING : ai::TreeNodeStatus::FAILED;
+		break;
+	}
+	case Kind::Timed:
+		result = executeTimed(n, state, entity, deltaMillis);
+		break;
+	case Kind::Node:
+		break;
+	}
+
+	if (debug) {
+		state.lastStatus = result;
+	}
+	return result;
+}
+
+ai::TreeNodeStatus CompiledTree::execute(const AIPtr& entity, int64_t deltaMillis) const {
+	TreeNodeStates& states = entity->_nodeStates;
+	if ((int)states.size() != size()) {
+		states.assign(size(), TreeNodeState());
+	}
+	return execute(0, entity, states.data(), deltaMillis, entity->_debuggingActive);
+}
+
+}
+
+#undef NOTSTARTED
@@ -0,0 +1,157 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIMessages_generated.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Atomic.h"
+#include <memory>
+#include <vector>
+
+#ifndef AI_NOTHING_SELECTED
+#define AI_NOTHING_SELECTED (-1)
+#endif
+
+namespace backend {
+
+class AI;
+typedef std::shared_ptr<AI> AIPtr;
+class TreeNode;
+typedef std::shared_ptr<TreeNode> TreeNodePtr;
+class ICondition;
+class ITimedNode;
+
+/**
+ * @brief The state of one node of a @c CompiledTree for one @c AI instance
+ *
+ * Every @c AI keeps one contiguous block of these - indexed by the slot of the node.
+ */
+struct TreeNodeState {
+	/** only updated if the debugging is active for the entity */
+	int64_t lastExecMillis = -1;
+	int64_t timerMillis = -1;
+	int32_t selector = AI_NOTHING_SELECTED;
+	int32_t limit = 0;
+	/** only updated if the debugging is active for the entity */
+	ai::TreeNodeStatus lastStatus = ai::TreeNodeStatus::UNKNOWN;
+};
+typedef std::vector<TreeNodeState> TreeNodeStates;
+
+class CompiledTree;
+typedef std::shared_ptr<CompiledTree> CompiledTreePtr;
+
+/**
+ * @brief A behaviour tree that was flattened into an array of nodes in pre-order
+ *
+ * The known composite and decorator nodes are interpreted directly on the state block of the @c AI
+ * instance instead of going through the virtual @c TreeNode::execute() calls and the per node maps.
+ * Leaves (and nodes that are not known to the compiler) are still executed via @c TreeNode::execute().
+ *
+ * @note The tree is shared between all the @c AI instances that are using the same behaviour. If the
+ * source tree is modified (e.g. by the debugger), the compiled tree must be invalidated.
+ * @sa TreeNodeState
+ */
+class CompiledTree {
+public:
+	enum class Kind : uint8_t {
+		/** executed via @c TreeNode::execute() - this includes all the descendants */
+		Node,
+		Sequence,
+		PrioritySelector,
+		RandomSelector,
+		Parallel,
+		Limit,
+		Invert,
+		Succeed,
+		Fail,
+		Timed
+	};
+
+	/** the @c RandomSelector shuffles its children on the stack */
+	static constexpr int MaxRandomChildren = 64;
+private:
+	struct Node {
+		TreeNode* node;
+		ICondition* condition;
+		ITimedNode* timed;
+		/** offset into @c _children */
+		int32_t childOffset;
+		int32_t childCount;
+		/** one past the last slot of the subtree */
+		int32_t subtreeEnd;
+		/** the amount of executions for @c Kind::Limit or the timer millis for @c Kind::Timed */
+		int64_t param;
+		Kind kind;
+		/** the condition is the @c True singleton and doesn't need to be evaluated */
+		bool alwaysTrue;
+	};
+	std::vector<Node> _nodes;
+	/** the slots of the children of all nodes - each node references a contiguous range */
+	std::vector<int32_t> _children;
+	/** node id to slot - only used to answer the state queries of the debugger */
+	core::Map<int, int> _slots;
+	/** keeps the source nodes alive, the @c Node entries are only holding the raw pointers */
+	TreeNodePtr _root;
+	core::AtomicBool _valid { true };
+
+	int add(const TreeNodePtr& node);
+	Kind kind(const TreeNodePtr& node) const;
+
+	ai::TreeNodeStatus execute(int slot, const AIPtr& entity, TreeNodeState* states, int64_t deltaMillis, bool debug) const;
+	ai::TreeNodeStatus executeTimed(const Node& n, TreeNodeState& state, const AIPtr& entity, int64_t deltaMillis) const;
+	void resetState(int slot, const AIPtr& entity, TreeNodeState* states) const;
+
+	inline const int32_t* children(const Node& n) const {
+		return &_children[n.childOffset];
+	}
+public:
+	explicit CompiledTree(const TreeNodePtr& root);
+
+	/**
+	 * @return @c nullptr if the given root is invalid
+	 */
+	static CompiledTreePtr compile(const TreeNodePtr& root);
+
+	/**
+	 * @brief Ticks the tree for the given entity
+	 * @note The state block of the entity is (re-)initialized if it doesn't match this tree
+	 */
+	ai::TreeNodeStatus execute(const AIPtr& entity, int64_t deltaMillis) const;
+
+	/**
+	 * @return The slot of the node with the given id - or @c -1 if the node is not part of the flat array
+	 */
+	int slot(int nodeId) const;
+
+	/**
+	 * @brief The amount of slots - this is the size of the state block of each @c AI
+	 */
+	int size() const;
+
+	const TreeNodePtr& root() const;
+
+	/**
+	 * @brief Mark the tree as outdated - the @c AI instances fall back to the @c TreeNode runtime
+	 */
+	void invalidate();
+	bool isValid() const;
+};
+
+inline int CompiledTree::size() const {
+	return (int)_nodes.size();
+}
+
+inline const TreeNodePtr& CompiledTree::root() const {
+	return _root;
+}
+
+inline void CompiledTree::invalidate() {
+	_valid = false;
+}
+
+inline bool CompiledTree::isValid() const {
+	return _valid;
+}
+
+}
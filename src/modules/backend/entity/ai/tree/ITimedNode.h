@@ -21,6 +21,7 @@ namespace backend {
  * @brief A timed node is a @c TreeNode that is executed until a given time (millis) is elapsed.
  */
 class ITimedNode : public TreeNode {
+	friend class CompiledTree;
 protected:
 	int64_t _timerMillis;
 	int64_t _millis;
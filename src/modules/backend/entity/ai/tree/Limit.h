@@ -15,6 +15,7 @@ namespace backend {
  * @c TreeNodeStatus::FINISHED
  */
 class Limit: public TreeNode {
+	friend class CompiledTree;
 private:
 	int _amount;
 public:
@@ -71,38 +71,66 @@ void TreeNode::setLastExecMillis(const AIPtr& entity) {
 	if (!entity->_debuggingActive) {
 		return;
 	}
-	entity->_lastExecMillis.put(getId(), entity->_time);
+	if (TreeNodeState* nodeState = entity->nodeState(getId())) {
+		nodeState->lastExecMillis = entity->_time;
+		return;
+	}
+	AI::nodeStateMap(entity->_lastExecMillis).put(getId(), entity->_time);
 }
 
 int TreeNode::getSelectorState(const AIPtr& entity) const {
-	auto i = entity->_selectorStates.find(getId());
-	if (i == entity->_selectorStates.end()) {
+	if (const TreeNodeState* nodeState = entity->nodeState(getId())) {
+		return nodeState->selector;
+	}
+	if (!entity->_selectorStates) {
+		return AI_NOTHING_SELECTED;
+	}
+	auto i = entity->_selectorStates->find(getId());
+	if (i == entity->_selectorStates->end()) {
 		return AI_NOTHING_SELECTED;
 	}
 	return i->second;
 }
 
 void TreeNode::setSelectorState(const AIPtr& entity, int selected) {
-	entity->_selectorStates.put(getId(), selected);
+	if (TreeNodeState* nodeState = entity->nodeState(getId())) {
+		nodeState->selector = selected;
+		return;
+	}
+	AI::nodeStateMap(entity->_selectorStates).put(getId(), selected);
 }
 
 int TreeNode::getLimitState(const AIPtr& entity) const {
-	auto i = entity->_limitStates.find(getId());
-	if (i == entity->_limitStates.end()) {
+	if (const TreeNodeState* nodeState = entity->nodeState(getId())) {
+		return nodeState->limit;
+	}
+	if (!entity->_limitStates) {
+		return 0;
+	}
+	auto i = entity->_limitStates->find(getId());
+	if (i == entity->_limitStates->end()) {
 		return 0;
 	}
 	return i->second;
 }
 
 void TreeNode::setLimitState(const AIPtr& entity, int amount) {
-	entity->_limitStates.put(getId(), amount);
+	if (TreeNodeState* nodeState = entity->nodeState(getId())) {
+		nodeState->limit = amount;
+		return;
+	}
+	AI::nodeStateMap(entity->_limitStates).put(getId(), amount);
 }
 
 ai::TreeNodeStatus TreeNode::state(const AIPtr& entity, ai::TreeNodeStatus treeNodeState) {
 	if (!entity->_debuggingActive) {
 		return treeNodeState;
 	}
-	entity->_lastStatus.put(getId(), treeNodeState);
+	if (TreeNodeState* nodeState = entity->nodeState(getId())) {
+		nodeState->lastStatus = treeNodeState;
+		return treeNodeState;
+	}
+	AI::nodeStateMap(entity->_lastStatus).put(getId(), treeNodeState);
 	return treeNodeState;
 }
 
@@ -110,8 +138,14 @@ int64_t TreeNode::getLastExecMillis(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return -1L;
 	}
-	auto i = entity->_lastExecMillis.find(getId());
-	if (i == entity->_lastExecMillis.end()) {
+	if (const TreeNodeState* nodeState = entity->nodeState(getId())) {
+		return nodeState->lastExecMillis;
+	}
+	if (!entity->_lastExecMillis) {
+		return -1L;
+	}
+	auto i = entity->_lastExecMillis->find(getId());
+	if (i == entity->_lastExecMillis->end()) {
 		return -1L;
 	}
 	return i->second;
@@ -121,8 +155,14 @@ ai::TreeNodeStatus TreeNode::getLastStatus(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return ai::TreeNodeStatus::UNKNOWN;
 	}
-	auto i = entity->_lastStatus.find(getId());
-	if (i == entity->_lastStatus.end()) {
+	if (const TreeNodeState* nodeState = entity->nodeState(getId())) {
+		return nodeState->lastStatus;
+	}
+	if (!entity->_lastStatus) {
+		return ai::TreeNodeStatus::UNKNOWN;
+	}
+	auto i = entity->_lastStatus->find(getId());
+	if (i == entity->_lastStatus->end()) {
 		return ai::TreeNodeStatus::UNKNOWN;
 	}
 	return i->second;
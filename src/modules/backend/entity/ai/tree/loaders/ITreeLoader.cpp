@@ -19,12 +19,21 @@ ITreeLoader::ITreeLoader(const IAIFactory& aiFactory) :
 ITreeLoader::~ITreeLoader() {
 	_error = "";
 	_treeMap.clear();
+	_compiledTreeMap.clear();
 }
 
 void ITreeLoader::shutdown() {
 	core::ScopedLock scopedLock(_lock);
 	_error = "";
 	_treeMap.clear();
+	_compiledTreeMap.clear();
+}
+
+void ITreeLoader::compileTrees() {
+	core::ScopedLock scopedLock(_lock);
+	for (auto i = _treeMap.begin(); i != _treeMap.end(); ++i) {
+		_compiledTreeMap.put(i->key, CompiledTree::compile(i->value));
+	}
 }
 
 bool ITreeLoader::addTree(const core::String& name, const TreeNodePtr& root) {
@@ -48,6 +57,21 @@ TreeNodePtr ITreeLoader::load(const core::String &name) {
 	return TreeNodePtr();
 }
 
+CompiledTreePtr ITreeLoader::loadCompiled(const core::String &name) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _compiledTreeMap.find(name);
+	if (i != _compiledTreeMap.end()) {
+		return i->second;
+	}
+	auto tree = _treeMap.find(name);
+	if (tree == _treeMap.end()) {
+		return CompiledTreePtr();
+	}
+	const CompiledTreePtr& compiled = CompiledTree::compile(tree->second);
+	_compiledTreeMap.put(name, compiled);
+	return compiled;
+}
+
 void ITreeLoader::setError(const char* msg, ...) {
 	va_list args;
 	va_start(args, msg);
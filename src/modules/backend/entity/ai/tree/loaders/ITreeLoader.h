@@ -9,6 +9,7 @@
 #include "core/String.h"
 #include "core/collection/StringMap.h"
 #include "core/Common.h"
+#include "backend/entity/ai/tree/CompiledTree.h"
 #include <memory>
 
 namespace backend {
@@ -26,9 +27,17 @@ protected:
 	const IAIFactory& _aiFactory;
 	typedef core::StringMap<TreeNodePtr> TreeMap;
 	TreeMap _treeMap core_thread_guarded_by(_lock);
+	typedef core::StringMap<CompiledTreePtr> CompiledTreeMap;
+	CompiledTreeMap _compiledTreeMap core_thread_guarded_by(_lock);
 	core_trace_mutex(core::Lock, _lock, "AITreeLoader");
 
 	void resetError();
+
+	/**
+	 * @brief Flattens all the registered trees - call this once the trees are completely built
+	 * @sa loadCompiled()
+	 */
+	void compileTrees();
 private:
 	core::String _error core_thread_guarded_by(_lock);		/**< make sure to set this member if your own implementation ran into an error. @sa ITreeLoader::getError */
 public:
@@ -59,6 +68,13 @@ public:
 	 */
 	TreeNodePtr load(const core::String &name);
 
+	/**
+	 * @brief The flat version of the behaviour tree that is registered with the given name
+	 * @note The tree is compiled on first access if that didn't already happen while loading the trees
+	 * @sa load()
+	 */
+	CompiledTreePtr loadCompiled(const core::String &name);
+
 	void setError(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(2);
 
 	/**
@@ -269,6 +269,7 @@ bool LUATreeLoader::init(const core::String& luaString) {
 		setError("No behaviour trees specified");
 		return false;
 	}
+	compileTrees();
 	return true;
 }
 
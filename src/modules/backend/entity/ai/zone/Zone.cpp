@@ -10,6 +10,7 @@ namespace backend {
 
 Zone::~Zone() {
 	_threadPool.shutdown();
+	_steeringQueue.clear();
 	for (const auto& e : _ais) {
 		e.second->setZone(nullptr);
 		_groupManager.removeFromAllGroups(e.second);
@@ -118,6 +119,12 @@ void Zone::update(int64_t dt) {
 			doDestroyAI(id);
 		}
 		scheduledDestroy.clear();
+
+		_index.clear();
+		for (const auto& e : _ais) {
+			_index.add(e.first, e.second->getCharacter()->getPosition());
+		}
+		_index.build();
 	}
 
 	auto func = [&] (const AIPtr& ai) {
@@ -125,9 +132,10 @@ void Zone::update(int64_t dt) {
 			return;
 		}
 		ai->update(dt, _debug);
-		ai->getBehaviour()->execute(ai, dt);
+		AI::execute(ai, dt);
 	};
 	executeParallel(func);
+	_steeringQueue.update(this, _threadPool);
 	_groupManager.update(dt);
 }
 
@@ -15,6 +15,8 @@
 
 #include "backend/entity/ai/ICharacter.h"
 #include "backend/entity/ai/group/GroupMgr.h"
+#include "ZoneIndex.h"
+#include "backend/entity/ai/movement/SteeringQueue.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Lock.h"
 #include "core/Trace.h"
@@ -56,6 +58,14 @@ protected:
 	mutable core_trace_mutex(core::Lock, _lock, "AIZone");
 	core_trace_mutex(core::Lock, _scheduleLock, "AIScheduleZone");
 	GroupMgr _groupManager;
+	/**
+	 * @brief Rebuilt in @c Zone::update before the @c AI instances are ticked
+	 */
+	ZoneIndex _index;
+	/**
+	 * @brief The movement of the @c Steer nodes - evaluated in @c Zone::update after the @c AI instances were ticked
+	 */
+	movement::SteeringQueue _steeringQueue;
 	mutable core::ThreadPool _threadPool;
 
 	/**
@@ -163,6 +173,14 @@ public:
 
 	const GroupMgr& getGroupMgr() const;
 
+	/**
+	 * @brief The positions of the @c AI instances of this zone at the beginning of the current tick
+	 * @note This is not locked - it's only modified in @c Zone::update before the @c AI instances are ticked
+	 */
+	const ZoneIndex& getIndex() const;
+
+	movement::SteeringQueue& getSteeringQueue();
+
 	/**
 	 * @brief Lookup for a particular @c AI in the zone.
 	 *
@@ -257,7 +275,8 @@ public:
 		_lock.unlock();
 		for (auto i = copy.begin(); i != copy.end(); ++i) {
 			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
+			// only reference the copy - the worker might release its task after the future is ready
+			results.emplace_back(_threadPool.enqueue([&func, &ai] () { func(ai); }));
 		}
 		for (auto & result: results) {
 			result.wait();
@@ -280,7 +299,8 @@ public:
 		_lock.unlock();
 		for (auto i = copy.begin(); i != copy.end(); ++i) {
 			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
+			// only reference the copy - the worker might release its task after the future is ready
+			results.emplace_back(_threadPool.enqueue([&func, &ai] () { func(ai); }));
 		}
 		for (auto & result: results) {
 			result.wait();
@@ -346,4 +366,12 @@ inline const GroupMgr& Zone::getGroupMgr() const {
 	return _groupManager;
 }
 
+inline const ZoneIndex& Zone::getIndex() const {
+	return _index;
+}
+
+inline movement::SteeringQueue& Zone::getSteeringQueue() {
+	return _steeringQueue;
+}
+
 }
@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "ZoneIndex.h"
+#include "core/Algorithm.h"
+#include "core/Assert.h"
+
+namespace backend {
+
+ZoneIndex::ZoneIndex(float cellSize) :
+		_cellSize(cellSize) {
+	core_assert(_cellSize > 0.0f);
+}
+
+void ZoneIndex::clear() {
+	_entries.clear();
+}
+
+void ZoneIndex::add(ai::CharacterId id, const glm::vec3& position) {
+	_entries.push_back(Entry{key(cell(position.x), cell(position.z)), id, position});
+}
+
+void ZoneIndex::build() {
+	core::sort(_entries.begin(), _entries.end(), [] (const Entry& a, const Entry& b) {
+		if (a.key != b.key) {
+			return a.key < b.key;
+		}
+		return a.id < b.id;
+	});
+}
+
+size_t ZoneIndex::lowerBound(int64_t k) const {
+	size_t first = 0u;
+	size_t count = _entries.size();
+	while (count > 0u) {
+		const size_t step = count / 2u;
+		const size_t i = first + step;
+		if (_entries[i].key < k) {
+			first = i + 1u;
+			count -= step + 1u;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+}
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @ingroup Zone
+ */
+#pragma once
+
+#include "ai-shared/common/CharacterId.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <stdint.h>
+
+namespace backend {
+
+/**
+ * @brief Uniform grid over the x and z positions of the @c AI instances of a @c Zone
+ *
+ * This is rebuilt once per @c Zone::update call before the @c AI instances are ticked. The filters can
+ * query it from the worker threads without locking, because it is not modified while the @c AI instances
+ * are ticked.
+ */
+class ZoneIndex {
+public:
+	struct Entry {
+		/** cell key - the entries are sorted by this */
+		int64_t key;
+		ai::CharacterId id;
+		glm::vec3 position;
+	};
+	typedef core::DynamicArray<Entry> Entries;
+private:
+	float _cellSize;
+	Entries _entries;
+
+	int cell(float v) const;
+	static int64_t key(int cellX, int cellZ);
+	/**
+	 * @return The index of the first entry with a key that is not less than the given key
+	 */
+	size_t lowerBound(int64_t key) const;
+public:
+	explicit ZoneIndex(float cellSize = 16.0f);
+
+	void clear();
+	/**
+	 * @brief Adds a character - call @c build() after all characters were added
+	 */
+	void add(ai::CharacterId id, const glm::vec3& position);
+	/**
+	 * @brief Sorts the entries into their cells
+	 */
+	void build();
+
+	/**
+	 * @brief Calls the given functor with the @c CharacterId of every character that is not
+	 * further away from the given position than the given radius
+	 */
+	template<class Func>
+	void visit(const glm::vec3& position, float radius, Func&& func) const;
+
+	/**
+	 * @return All characters of the zone - in cell order
+	 */
+	const Entries& entries() const;
+	size_t size() const;
+	float cellSize() const;
+};
+
+inline int ZoneIndex::cell(float v) const {
+	return (int)glm::floor(v / _cellSize);
+}
+
+inline int64_t ZoneIndex::key(int cellX, int cellZ) {
+	// flip the sign bit of the x cell to keep the cells of a row in ascending order
+	return (int64_t)((uint64_t)(int64_t)cellZ << 32) | (int64_t)((uint32_t)cellX ^ 0x80000000u);
+}
+
+template<class Func>
+void ZoneIndex::visit(const glm::vec3& position, float radius, Func&& func) const {
+	const int minX = cell(position.x - radius);
+	const int maxX = cell(position.x + radius);
+	const int minZ = cell(position.z - radius);
+	const int maxZ = cell(position.z + radius);
+	const float radiusSquare = radius * radius;
+	const size_t size = _entries.size();
+	for (int z = minZ; z <= maxZ; ++z) {
+		// the cells of one row are contiguous
+		const int64_t last = key(maxX, z);
+		for (size_t i = lowerBound(key(minX, z)); i < size && _entries[i].key <= last; ++i) {
+			const Entry& e = _entries[i];
+			const glm::vec3 delta = e.position - position;
+			if (glm::dot(delta, delta) <= radiusSquare) {
+				func(e.id);
+			}
+		}
+	}
+}
+
+inline const ZoneIndex::Entries& ZoneIndex::entries() const {
+	return _entries;
+}
+
+inline size_t ZoneIndex::size() const {
+	return _entries.size();
+}
+
+inline float ZoneIndex::cellSize() const {
+	return _cellSize;
+}
+
+}
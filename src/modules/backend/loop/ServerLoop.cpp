@@ -442,6 +442,8 @@ void ServerLoop::update() {
 	core_trace_scoped(ServerLoop);
 	// not everything is ticked in here directly, a lot is handled by libuv timers
 	uv_run(_loop, UV_RUN_NOWAIT);
+	// one packet per peer with all the messages of this tick
+	_messageSender->flush();
 	_network->update();
 	_httpServer->update();
 
@@ -475,6 +477,7 @@ void ServerLoop::onEvent(const network::DisconnectEvent& event) {
 	core_trace_scoped(OnDisconnectEvent);
 	ENetPeer* peer = event.peer();
 	Log::info("disconnect peer: %u", peer->connectID);
+	_messageSender->removePeer(peer);
 	User* user = reinterpret_cast<User*>(peer->data);
 	if (user == nullptr) {
 		return;
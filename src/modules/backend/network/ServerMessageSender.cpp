@@ -5,19 +5,68 @@
 #include "ServerMessageSender.h"
 #include "core/Log.h"
 #include "core/Common.h"
+#include "core/Enum.h"
 #include "core/Assert.h"
 #include "core/StringUtil.h"
 
 namespace network {
 
+ServerMessageSender::ServerMessageSender(const ServerNetworkPtr& network, const metric::MetricPtr& metric) :
+		_network(network), _metric(metric) {
+	_messageCount.fill(0);
+	_messageSize.fill(0);
+}
+
+size_t ServerMessageSender::maxBatchSize(const ENetPeer* peer) {
+	// this is the size at which enet starts to fragment the packet
+	size_t size = peer->mtu - sizeof(ENetProtocolHeader) - sizeof(ENetProtocolSendFragment);
+	if (peer->host->checksum != nullptr) {
+		size -= sizeof(enet_uint32);
+	}
+	return size;
+}
+
+void ServerMessageSender::countMessage(ServerMsgType type, size_t size) {
+	const int idx = core::enumVal(type);
+	++_messageCount[idx];
+	_messageSize[idx] += (int)size;
+}
+
+void ServerMessageSender::flushMetrics() {
+	for (int i = 0; i < (int)_messageCount.size(); ++i) {
+		if (_messageCount[i] == 0) {
+			continue;
+		}
+		const metric::TagMap& tags {{"direction", "out"}, {"type", EnumNameServerMsgType((ServerMsgType)i)}};
+		_metric->count("network_packet_count", _messageCount[i], tags);
+		_metric->count("network_packet_size", _messageSize[i], tags);
+		_messageCount[i] = 0;
+		_messageSize[i] = 0;
+	}
+	const metric::TagMap& tags {{"direction", "out"}};
+	if (_packetsSent > 0) {
+		_metric->count("network_sent", _packetsSent, tags);
+		_metric->count("network_batch_size", _packetSize, tags);
+	}
+	if (_packetsNotSent > 0) {
+		_metric->count("network_not_sent", _packetsNotSent, tags);
+	}
+	_packetsSent = 0;
+	_packetsNotSent = 0;
+	_packetSize = 0;
+}
+
+ENetPacket* ServerMessageSender::createPacket(const MessageBatch& batch, uint32_t flags) {
+	Log::trace(logid, "Create server package with %u messages - size %u", batch.count(), (unsigned int)batch.size());
+	return enet_packet_create(batch.data(), batch.size(), flags);
+}
+
 ENetPacket* ServerMessageSender::createServerPacket(ServerMsgType type, const void * data, size_t dataLength, uint32_t flags) {
-	ENetPacket* packet = enet_packet_create(data, dataLength, flags);
-	const char *msgType = EnumNameServerMsgType(type);
-	Log::trace(logid, "Create server package: %s - size %u", msgType, (unsigned int)dataLength);
-	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
-	_metric->count("network_packet_count", 1, tags);
-	_metric->count("network_packet_size", (int)dataLength, tags);
-	return packet;
+	core::ScopedLock scopedLock(_lock);
+	countMessage(type, dataLength);
+	_single.clear();
+	_single.add((const uint8_t*)data, dataLength);
+	return createPacket(_single, flags);
 }
 
 ENetPacket* ServerMessageSender::createServerPacket(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
@@ -26,8 +75,79 @@ ENetPacket* ServerMessageSender::createServerPacket(FlatBufferBuilder& fbb, Serv
 	return createServerPacket(type, fbb.GetBufferPointer(), fbb.GetSize(), flags);
 }
 
-ServerMessageSender::ServerMessageSender(const ServerNetworkPtr& network, const metric::MetricPtr& metric) :
-		_network(network), _metric(metric) {
+size_t ServerMessageSender::peerBatch(ENetPeer* peer) {
+	auto i = _peerBatchIndices.find(peer);
+	if (i != _peerBatchIndices.end()) {
+		return i->second;
+	}
+	const size_t idx = _peerBatches.size();
+	_peerBatchIndices.emplace(peer, idx);
+	_peerBatches.emplace_back();
+	_peerBatches[idx].peer = peer;
+	return idx;
+}
+
+void ServerMessageSender::removePeer(ENetPeer* peer) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _peerBatchIndices.find(peer);
+	if (i == _peerBatchIndices.end()) {
+		return;
+	}
+	const size_t idx = i->second;
+	_peerBatchIndices.erase(i);
+	_peerBatches.erase(idx);
+	for (auto& e : _peerBatchIndices) {
+		if (e.second > idx) {
+			--e.second;
+		}
+	}
+	for (size_t p = 0u; p < _pending.size();) {
+		if (_pending[p] == idx) {
+			_pending.erase(p);
+			continue;
+		}
+		if (_pending[p] > idx) {
+			--_pending[p];
+		}
+		++p;
+	}
+}
+
+bool ServerMessageSender::sendBatch(PeerBatch& peerBatch, int slot) {
+	MessageBatch& batch = peerBatch.batches[slot];
+	if (batch.empty()) {
+		return false;
+	}
+	ENetPacket* packet = createPacket(batch, peerBatch.flags[slot]);
+	if (_network->sendMessage(peerBatch.peer, packet)) {
+		++_packetsSent;
+		_packetSize += (int)batch.size();
+	} else {
+		++_packetsNotSent;
+		Log::trace(logid, "Could not send %u messages to peer %u", batch.count(), peerBatch.peer->connectID);
+	}
+	batch.clear();
+	return true;
+}
+
+bool ServerMessageSender::addMessage(ENetPeer* peer, const uint8_t* data, size_t size, uint32_t flags) {
+	if (peer->state != ENET_PEER_STATE_CONNECTED) {
+		return false;
+	}
+	const size_t idx = peerBatch(peer);
+	PeerBatch& pb = _peerBatches[idx];
+	const int slot = (flags & ENET_PACKET_FLAG_RELIABLE) ? 0 : 1;
+	MessageBatch& batch = pb.batches[slot];
+	if (!batch.empty() && (pb.flags[slot] != flags || batch.sizeWith(size) > maxBatchSize(peer))) {
+		sendBatch(pb, slot);
+	}
+	pb.flags[slot] = flags;
+	batch.add(data, size);
+	if (!pb.pending) {
+		pb.pending = true;
+		_pending.push_back(idx);
+	}
+	return true;
 }
 
 bool ServerMessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
@@ -36,46 +156,49 @@ bool ServerMessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& f
 }
 
 bool ServerMessageSender::sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
-	const char *msgType = network::EnumNameServerMsgType(type);
-	Log::debug(logid, "Send %s to %i peers", msgType, numPeers);
+	Log::debug(logid, "Send %s to %i peers", network::EnumNameServerMsgType(type), numPeers);
 	core_assert(numPeers > 0);
-	int sent = 0;
-	int notsent = 0;
-	auto packet = createServerPacket(fbb, type, data, flags);
-	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
+	auto msg = CreateServerMessage(fbb, type, data);
+	FinishServerMessageBuffer(fbb, msg);
+	const uint8_t* buf = fbb.GetBufferPointer();
+	const size_t size = fbb.GetSize();
+	int queued = 0;
 	{
-		// TODO: lock
+		core::ScopedLock scopedLock(_lock);
 		for (int i = 0; i < numPeers; ++i) {
-			if (!_network->sendMessage(peers[i], packet)) {
-				++notsent;
-				Log::trace(logid, "Could not send message of type %s to peer %i", msgType, i);
+			if (addMessage(peers[i], buf, size, flags)) {
+				++queued;
 			} else {
-				++sent;
+				++_packetsNotSent;
 			}
 		}
-		if (notsent > 0) {
-			_metric->count("network_not_sent", notsent, tags);
-		}
-		if (sent > 0) {
-			_metric->count("network_sent", sent, tags);
-		}
+		countMessage(type, size * queued);
 	}
 	fbb.Clear();
-	return sent == numPeers;
+	return queued == numPeers;
 }
 
 bool ServerMessageSender::broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel, uint32_t flags) {
-	const char *msgType = network::EnumNameServerMsgType(type);
-	Log::debug(logid, "Broadcast %s on channel %i", msgType, channel);
-	bool success = false;
-	{
-		// TODO: lock
-		success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
-		const metric::TagMap& tags {{"direction", "broadcast"}, {"type", msgType}};
-		_metric->count("network_sent", 1, tags);
-	}
+	Log::debug(logid, "Broadcast %s on channel %i", network::EnumNameServerMsgType(type), channel);
+	flush();
+	const bool success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
 	fbb.Clear();
 	return success;
 }
 
+int ServerMessageSender::flush() {
+	core_trace_scoped(ServerMessageSenderFlush);
+	core::ScopedLock scopedLock(_lock);
+	int packets = 0;
+	for (size_t idx : _pending) {
+		PeerBatch& pb = _peerBatches[idx];
+		packets += (int)sendBatch(pb, 0);
+		packets += (int)sendBatch(pb, 1);
+		pb.pending = false;
+	}
+	_pending.clear();
+	flushMetrics();
+	return packets;
+}
+
 }
@@ -7,8 +7,14 @@
 #include "ServerMessages_generated.h"
 #include "ServerNetwork.h"
 #include "metric/Metric.h"
+#include "network/MessageBatch.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "core/collection/Array.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Lock.h"
 #include <memory>
+#include <unordered_map>
 
 namespace network {
 
@@ -16,6 +22,11 @@ using namespace flatbuffers;
 
 /**
  * @brief Send messages from the server to the client(s)
+ *
+ * The messages that are sent to a peer are not put into their own packet, but coalesced per peer (and
+ * packet flags) into a @c MessageBatch. The batches are sent with @c flush() - once per tick - or as soon
+ * as the next message would not fit into the mtu of the peer anymore. Every packet that is sent to the
+ * client is a @c MessageBatch - also the broadcasts and the packets created by @c createServerPacket().
  */
 class ServerMessageSender {
 private:
@@ -23,15 +34,76 @@ private:
 	ServerNetworkPtr _network;
 	metric::MetricPtr _metric;
 
+	/**
+	 * @brief The pending messages of one peer - reliable and unreliable ones are batched separately
+	 */
+	struct PeerBatch {
+		ENetPeer* peer = nullptr;
+		bool pending = false;
+		MessageBatch batches[2];
+		uint32_t flags[2] {0u, 0u};
+	};
+	core::DynamicArray<PeerBatch> _peerBatches core_thread_guarded_by(_lock);
+	std::unordered_map<ENetPeer*, size_t> _peerBatchIndices core_thread_guarded_by(_lock);
+	/** indices into @c _peerBatches with pending messages */
+	core::DynamicArray<size_t> _pending core_thread_guarded_by(_lock);
+	MessageBatch _single core_thread_guarded_by(_lock);
+
+	/** the messages and bytes per type that were batched since the last flush */
+	core::Array<int, (int)ServerMsgType::MAX + 1> _messageCount;
+	core::Array<int, (int)ServerMsgType::MAX + 1> _messageSize;
+	int _packetsSent = 0;
+	int _packetsNotSent = 0;
+	int _packetSize = 0;
+	core_trace_mutex(core::Lock, _lock, "ServerMessageSender");
+
+	/**
+	 * @return The max size of a batch that still fits into one packet of the given peer without being fragmented
+	 */
+	static size_t maxBatchSize(const ENetPeer* peer);
+	/**
+	 * @return The index of the batches of the given peer in @c _peerBatches
+	 */
+	size_t peerBatch(ENetPeer* peer);
+	bool addMessage(ENetPeer* peer, const uint8_t* data, size_t size, uint32_t flags);
+	/**
+	 * @return @c true if a packet was created for the batch
+	 */
+	bool sendBatch(PeerBatch& peerBatch, int slot);
+	void countMessage(ServerMsgType type, size_t size);
+	void flushMetrics();
+	ENetPacket* createPacket(const MessageBatch& batch, uint32_t flags);
+
 public:
 	ENetPacket* createServerPacket(ServerMsgType type, const void * data, size_t dataLength, uint32_t flags);
 	ENetPacket* createServerPacket(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags);
 	ServerMessageSender(const ServerNetworkPtr& network, const metric::MetricPtr& metric);
 
+	/**
+	 * @brief Queue the message for the given peer(s)
+	 * @return @c false if one of the peers is not connected
+	 * @note The messages are sent with the next @c flush()
+	 */
 	bool sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	bool sendServerMessage(std::vector<ENetPeer*> peers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	bool sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	/**
+	 * @note The pending messages are flushed before the broadcast to keep the order of the messages
+	 */
 	bool broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel = 0, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+
+	/**
+	 * @brief Drops the pending messages of the given peer - call this if the peer disconnected
+	 * @note The peer slot might get reused by the next connection - the messages must not be sent to it
+	 */
+	void removePeer(ENetPeer* peer);
+
+	/**
+	 * @brief Sends one packet per peer with all the messages that were queued since the last call
+	 * @note Call this once per tick before the network is updated
+	 * @return The amount of packets that were sent
+	 */
+	int flush();
 };
 
 typedef std::shared_ptr<ServerMessageSender> ServerMessageSenderPtr;
@@ -16,10 +16,14 @@
 #include "backend/entity/Npc.h"
 #include "backend/world/Map.h"
 #include "attrib/ContainerProvider.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxel/Region.h"
+#include <glm/common.hpp>
 
 namespace backend {
 
-static const long spawnTime = 15000L;
+// the delay until the spawn of a type is tried again if it failed
+static const long spawnRetryDelay = 15000L;
 
 SpawnMgr::SpawnMgr(Map* map,
 		const io::FilesystemPtr& filesytem,
@@ -32,49 +36,124 @@ SpawnMgr::SpawnMgr(Map* map,
 		_map(map), _loader(loader), _entityStorage(entityStorage), _messageSender(messageSender), _timeProvider(timeProvider),
 		_containerProvider(containerProvider), _cooldownProvider(cooldownProvider),
 		_filesystem(filesytem) {
+	for (int i = 0; i < EntityTypes; ++i) {
+		_alive[i] = 0;
+		_delay[i] = 0L;
+	}
 }
 
 void SpawnMgr::shutdown() {
+	_types.clear();
+	core::ScopedLock lock(_spawnCellLock);
+	_spawnCells.clear();
 }
 
 bool SpawnMgr::init() {
+	_spawnBudget = core::Var::get(cfg::ServerSpawnBudget, "1");
+	_types.clear();
+	for (int i = 0; i < EntityTypes; ++i) {
+		const bool isAnimal = i > core::enumVal(network::EntityType::BEGIN_ANIMAL) && i < core::enumVal(network::EntityType::MAX_ANIMAL);
+		const bool isCharacter = i > core::enumVal(network::EntityType::BEGIN_CHARACTERS) && i < core::enumVal(network::EntityType::MAX_CHARACTERS);
+		if (isAnimal || isCharacter) {
+			_types.push_back((network::EntityType)i);
+		}
+	}
+	_nextType = 0;
 	return true;
 }
 
-void SpawnMgr::spawnCharacters() {
+int SpawnMgr::maxAmount(network::EntityType /*type*/) const {
 	// TODO: let this number come from the map lua script
-	spawnEntity(network::EntityType::BEGIN_CHARACTERS, network::EntityType::MAX_CHARACTERS, 1);
+	return 1;
 }
 
-void SpawnMgr::spawnAnimals() {
-	// TODO: let this number come from the map lua script
-	spawnEntity(network::EntityType::BEGIN_ANIMAL, network::EntityType::MAX_ANIMAL, 1);
-}
-
-void SpawnMgr::spawnEntity(network::EntityType start, network::EntityType end, int maxAmount) {
-	Zone& zone = *_map->zone();
-	const int offset = (int)start + 1;
-	const int size = (int)end - offset;
-	std::vector<int> count(size, 0);
-	zone.execute([&] (const AIPtr& ai) {
-		Npc& npc = getNpc(ai);
-		const network::EntityType type = npc.entityType();
-		if (type <= start || type >= end) {
-			return;
+/**
+ * @brief The cells whose center column is part of the region
+ * @return @c false if no cell is centered in the region
+ */
+static bool spawnCellRange(const voxel::Region& region, int& minX, int& maxX, int& minZ, int& maxZ) {
+	constexpr int cellSize = SpawnMgr::SpawnCellSize;
+	constexpr int halfCell = cellSize / 2;
+	minX = (int)glm::ceil((float)(region.getLowerX() - halfCell) / (float)cellSize);
+	maxX = (int)glm::floor((float)(region.getUpperX() - halfCell) / (float)cellSize);
+	minZ = (int)glm::ceil((float)(region.getLowerZ() - halfCell) / (float)cellSize);
+	maxZ = (int)glm::floor((float)(region.getUpperZ() - halfCell) / (float)cellSize);
+	return minX <= maxX && minZ <= maxZ;
+}
+
+void SpawnMgr::updateSpawnCells(const voxel::Region& region) {
+	core_trace_scoped(SpawnMgrUpdateSpawnCells);
+	const voxelworld::FloorIndex& floorIndex = _map->worldMgr()->floorIndex();
+	constexpr int halfCell = SpawnCellSize / 2;
+	int minX, maxX, minZ, maxZ;
+	if (!spawnCellRange(region, minX, maxX, minZ, maxZ)) {
+		return;
+	}
+	core::DynamicArray<glm::ivec3> floors;
+	floors.reserve((maxX - minX + 1) * (maxZ - minZ + 1));
+	for (int z = minZ; z <= maxZ; ++z) {
+		for (int x = minX; x <= maxX; ++x) {
+			const glm::ivec3 column(x * SpawnCellSize + halfCell, voxel::MAX_HEIGHT / 2, z * SpawnCellSize + halfCell);
+			voxelutil::FloorTraceResult trace;
+			if (!floorIndex.findWalkableFloor(column, voxel::MAX_HEIGHT, trace) || !trace.isValid()
+					|| voxel::isWater(trace.voxel.getMaterial())) {
+				floors.push_back(glm::ivec3(column.x, voxel::NO_FLOOR_FOUND, column.z));
+				continue;
+			}
+			floors.push_back(glm::ivec3(column.x, trace.heightLevel, column.z));
 		}
-		const int index = (int)type - offset;
-		++count[index];
-	});
+	}
+	core::ScopedLock lock(_spawnCellLock);
+	size_t i = 0u;
+	for (int z = minZ; z <= maxZ; ++z) {
+		for (int x = minX; x <= maxX; ++x, ++i) {
+			if (floors[i].y == voxel::NO_FLOOR_FOUND) {
+				_spawnCells.erase(glm::ivec2(x, z));
+			} else {
+				_spawnCells[glm::ivec2(x, z)] = floors[i];
+			}
+		}
+	}
+}
 
-	for (int i = 0; i < size; ++i) {
-		if (count[i] >= maxAmount) {
-			continue;
+void SpawnMgr::removeSpawnCells(const voxel::Region& region) {
+	int minX, maxX, minZ, maxZ;
+	if (!spawnCellRange(region, minX, maxX, minZ, maxZ)) {
+		return;
+	}
+	core::ScopedLock lock(_spawnCellLock);
+	for (int z = minZ; z <= maxZ; ++z) {
+		for (int x = minX; x <= maxX; ++x) {
+			_spawnCells.erase(glm::ivec2(x, z));
 		}
+	}
+}
+
+size_t SpawnMgr::spawnCells() const {
+	core::ScopedLock lock(_spawnCellLock);
+	return _spawnCells.size();
+}
 
-		const int needToSpawn = maxAmount - count[i];
-		network::EntityType type = static_cast<network::EntityType>(offset + i);
-		spawn(type, needToSpawn);
+bool SpawnMgr::spawnPos(const glm::vec3& center, glm::ivec3& pos) const {
+	const glm::ivec2 cell((int)glm::floor(center.x / (float)SpawnCellSize), (int)glm::floor(center.z / (float)SpawnCellSize));
+	core::ScopedLock lock(_spawnCellLock);
+	if (_spawnCells.empty()) {
+		return false;
 	}
+	// a few random cells around the center - they are not all known or valid
+	for (int i = 0; i < 8; ++i) {
+		const glm::ivec2 delta(_random.random(-SpawnMaxCells, SpawnMaxCells), _random.random(-SpawnMaxCells, SpawnMaxCells));
+		if (glm::abs(delta.x) < SpawnMinCells && glm::abs(delta.y) < SpawnMinCells) {
+			continue;
+		}
+		auto iter = _spawnCells.find(cell + delta);
+		if (iter == _spawnCells.end()) {
+			continue;
+		}
+		pos = iter->second;
+		return true;
+	}
+	return false;
 }
 
 bool SpawnMgr::onSpawn(const NpcPtr& npc, const glm::ivec3* pos) {
@@ -82,13 +161,14 @@ bool SpawnMgr::onSpawn(const NpcPtr& npc, const glm::ivec3* pos) {
 	// now let it tick
 	if (_map->addNpc(npc)) {
 		_entityStorage->addNpc(npc);
+		++_alive[core::enumVal(npc->entityType())];
 		return true;
 	}
 	return false;
 }
 
-NpcPtr SpawnMgr::createNpc(network::EntityType type, const TreeNodePtr& behaviour) {
-	return std::make_shared<Npc>(type, behaviour, _map->ptr(), _messageSender,
+NpcPtr SpawnMgr::createNpc(network::EntityType type, const TreeNodePtr& behaviour, const CompiledTreePtr& compiledBehaviour) {
+	return std::make_shared<Npc>(type, behaviour, compiledBehaviour, _map->ptr(), _messageSender,
 					_timeProvider, _containerProvider, _cooldownProvider);
 }
 
@@ -99,7 +179,7 @@ NpcPtr SpawnMgr::spawn(network::EntityType type, const glm::ivec3* pos) {
 		Log::error("could not load the behaviour tree %s", typeName);
 		return NpcPtr();
 	}
-	const NpcPtr& npc = createNpc(type, behaviour);
+	const NpcPtr& npc = createNpc(type, behaviour, _loader->loadCompiled(typeName));
 	if (!onSpawn(npc, pos)) {
 		return NpcPtr();
 	}
@@ -120,21 +200,57 @@ int SpawnMgr::spawn(network::EntityType type, int amount, const glm::ivec3* pos)
 		Log::error("could not load the behaviour tree %s", typeName);
 		return 0;
 	}
+	const CompiledTreePtr& compiledBehaviour = _loader->loadCompiled(typeName);
 	for (int x = 0; x < amount; ++x) {
-		const NpcPtr& npc = createNpc(type, behaviour);
+		const NpcPtr& npc = createNpc(type, behaviour, compiledBehaviour);
 		onSpawn(npc, pos);
 	}
 
 	return amount;
 }
 
+void SpawnMgr::onRemove(network::EntityType type) {
+	const int index = core::enumVal(type);
+	if (index < 0 || index >= EntityTypes) {
+		return;
+	}
+	--_alive[index];
+}
+
 void SpawnMgr::update(long dt) {
 	core_trace_scoped(SpawnMgrUpdate);
-	_time += dt;
-	if (_time >= spawnTime) {
-		_time -= spawnTime;
-		spawnAnimals();
-		spawnCharacters();
+	for (int i = 0; i < EntityTypes; ++i) {
+		if (_delay[i] > 0L) {
+			_delay[i] -= dt;
+		}
+	}
+	int budget = _spawnBudget->intVal();
+	if (budget <= 0 || _types.empty()) {
+		return;
+	}
+	core::DynamicArray<glm::vec3> users;
+	bool collectedUsers = false;
+	const int types = (int)_types.size();
+	for (int i = 0; i < types && budget > 0; ++i) {
+		const network::EntityType type = _types[_nextType];
+		_nextType = (_nextType + 1) % types;
+		const int index = core::enumVal(type);
+		if (_delay[index] > 0L || _alive[index] >= maxAmount(type)) {
+			continue;
+		}
+		if (!collectedUsers) {
+			_map->userPositions(users);
+			collectedUsers = true;
+		}
+		glm::ivec3 pos;
+		const glm::ivec3* spawnAt = nullptr;
+		if (!users.empty() && spawnPos(users[_random.random(0, (int)users.size() - 1)], pos)) {
+			spawnAt = &pos;
+		}
+		--budget;
+		if (!spawn(type, spawnAt)) {
+			_delay[index] = spawnRetryDelay;
+		}
 	}
 }
 
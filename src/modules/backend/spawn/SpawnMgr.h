@@ -7,12 +7,41 @@
 #include "ServerMessages_generated.h"
 #include "backend/ForwardDecl.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/DynamicArray.h"
+#include "math/Random.h"
 #include <glm/fwd.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <atomic>
+#include <unordered_map>
+
+namespace voxel {
+class Region;
+}
 
 namespace backend {
 
+/**
+ * @brief Keeps the npc population of a @c Map up
+ *
+ * The missing npcs are spawned continuously - but only @c cfg::ServerSpawnBudget per map tick. They are placed
+ * near the users of the map. The valid spawn positions are precomputed per spawn cell whenever a chunk is
+ * paged in, so placing an npc doesn't need to trace the voxels. The server doesn't modify the chunks after
+ * they were paged in.
+ */
 class SpawnMgr : public core::IComponent {
+public:
+	/** the side length of a spawn cell in voxels - each cell has at most one spawn position */
+	static constexpr int SpawnCellSize = 8;
+	/** the npcs are spawned within this distance (in spawn cells) around a user */
+	static constexpr int SpawnMaxCells = 8;
+	/** and at least this far (in spawn cells) away from the user */
+	static constexpr int SpawnMinCells = 2;
 private:
 	Map* _map;
 	AILoaderPtr _loader;
@@ -22,13 +51,25 @@ private:
 	attrib::ContainerProviderPtr _containerProvider;
 	cooldown::CooldownProviderPtr _cooldownProvider;
 	io::FilesystemPtr _filesystem;
-	long _time = 15000L;
+	core::VarPtr _spawnBudget;
+	math::Random _random;
+
+	static constexpr int EntityTypes = (int)network::EntityType::MAX + 1;
+	/** the amount of npcs per entity type that live on the map */
+	std::atomic_int _alive[EntityTypes];
+	/** the millis until the next spawn of a type is tried again after it failed */
+	long _delay[EntityTypes];
+	/** the types that are kept populated - they are served round robin */
+	core::DynamicArray<network::EntityType> _types;
+	int _nextType = 0;
 
-	void spawnEntity(network::EntityType start, network::EntityType end, int maxAmount);
-	void spawnAnimals();
-	void spawnCharacters();
+	std::unordered_map<glm::ivec2, glm::ivec3, std::hash<glm::ivec2> > _spawnCells core_thread_guarded_by(_spawnCellLock);
+	mutable core_trace_mutex(core::Lock, _spawnCellLock, "SpawnCells");
 
-	NpcPtr createNpc(network::EntityType type, const TreeNodePtr& behaviour);
+	int maxAmount(network::EntityType type) const;
+	bool spawnPos(const glm::vec3& center, glm::ivec3& pos) const;
+
+	NpcPtr createNpc(network::EntityType type, const TreeNodePtr& behaviour, const CompiledTreePtr& compiledBehaviour);
 	bool onSpawn(const NpcPtr& npc, const glm::ivec3* pos);
 
 public:
@@ -45,7 +86,26 @@ public:
 
 	NpcPtr spawn(network::EntityType type, const glm::ivec3* pos = nullptr);
 	int spawn(network::EntityType type, int amount, const glm::ivec3* pos = nullptr);
+	/**
+	 * @brief Must be called if an npc left the map
+	 */
+	void onRemove(network::EntityType type);
+	/**
+	 * @brief Spawns the missing npcs within the budget
+	 */
 	void update(long dt);
+
+	/**
+	 * @brief Computes the spawn positions of all spawn cells that are centered in the given region - called if
+	 * the chunk was paged in
+	 * @note Must be called after the floor index of the region was built
+	 */
+	void updateSpawnCells(const voxel::Region& region);
+	/**
+	 * @brief Forgets the spawn cells that are centered in the given region - called if the chunk was paged out
+	 */
+	void removeSpawnCells(const voxel::Region& region);
+	size_t spawnCells() const;
 };
 
 typedef std::shared_ptr<SpawnMgr> SpawnMgrPtr;
@@ -25,6 +25,7 @@
 #include "backend/entity/ai/action/TriggerCooldownOnSelection.h"
 #include "backend/entity/ai/filter/Union.h"
 #include "core/Tokenizer.h"
+#include <limits.h>
 
 namespace backend {
 
@@ -150,9 +151,53 @@ TEST_F(AITest, testActionGoHome) {
 	const NpcPtr& npc = create();
 	const backend::TreeNodeFactoryContext ctx("foo", "", backend::True::get());
 	const TreeNodePtr& action = GoHome::getFactory().create(&ctx);
+	const voxelutil::FloorTraceResult& floor = map->findFloor(glm::ivec3(0, voxel::MAX_TERRAIN_HEIGHT, 0));
+	ASSERT_TRUE(floor.isValid());
+	const glm::vec3 home(0.0f, (float)floor.heightLevel, 0.0f);
+	npc->setHomePosition(home);
+	npc->ai()->getCharacter()->setPosition(home);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, action->execute(npc->ai(), 0L));
+	while (map->pendingRoutes() > 0) {
+		map->updateRoutes(INT_MAX);
+	}
 	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, action->execute(npc->ai(), 0L));
 }
 
+TEST_F(AITest, testActionGoHomeFollowsRoute) {
+	const NpcPtr& npc = create();
+	const backend::TreeNodeFactoryContext ctx("foo", "", backend::True::get());
+	const TreeNodePtr& action = GoHome::getFactory().create(&ctx);
+	const voxelutil::FloorTraceResult& homeFloor = map->findFloor(glm::ivec3(0, voxel::MAX_TERRAIN_HEIGHT, 0));
+	ASSERT_TRUE(homeFloor.isValid());
+	const voxelutil::FloorTraceResult& startFloor = map->findFloor(glm::ivec3(10, voxel::MAX_TERRAIN_HEIGHT, 0));
+	ASSERT_TRUE(startFloor.isValid());
+	// the pathfinder only walks through the paged in chunks
+	for (int z = -1; z <= 0; ++z) {
+		for (int x = -1; x <= 0; ++x) {
+			map->findFloor(glm::ivec3(x, voxel::MAX_TERRAIN_HEIGHT, z));
+		}
+	}
+	const glm::vec3 home(0.0f, (float)homeFloor.heightLevel, 0.0f);
+	npc->setHomePosition(home);
+	const ICharacterPtr& chr = npc->ai()->getCharacter();
+	chr->setPosition(glm::vec3(10.0f, (float)startFloor.heightLevel, 0.0f));
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, action->execute(npc->ai(), 0L));
+	while (map->pendingRoutes() > 0) {
+		map->updateRoutes(INT_MAX);
+	}
+	// the npc is walking from waypoint to waypoint
+	int waypoints = 0;
+	while (action->execute(npc->ai(), 0L) == ai::TreeNodeStatus::RUNNING) {
+		ASSERT_LT(waypoints, (int)npc->currentRoute().size()) << "The npc doesn't reach its home";
+		ASSERT_NE(chr->getPosition(), npc->targetPosition());
+		chr->setPosition(npc->targetPosition());
+		++waypoints;
+	}
+	EXPECT_GT(waypoints, 0);
+	EXPECT_EQ(home, npc->targetPosition());
+	EXPECT_TRUE(npc->currentRoute().empty());
+}
+
 TEST_F(AITest, testActionDie) {
 	const NpcPtr& npc = create();
 	const backend::TreeNodeFactoryContext ctx("foo", "", backend::True::get());
@@ -11,13 +11,13 @@ class AggroTest: public TestSuite {
 public:
 	void doMassTest(int max) {
 		backend::AggroMgr mgr(max);
+		mgr.setReduceByValue((float)max);
 		for (int i = 1; i <= max; ++i) {
 			const ai::CharacterId id = i;
 			backend::ICharacterPtr e = core::make_shared<TestEntity>(id);
 			backend::AIPtr ai = std::make_shared<backend::AI>(backend::TreeNodePtr());
 			ai->setCharacter(e);
-			backend::Entry* entry = mgr.addAggro(id, i);
-			entry->setReduceByValue(i);
+			mgr.addAggro(id, i);
 		}
 		const backend::EntryPtr& entry = mgr.getHighestEntry();
 		ASSERT_TRUE(entry) << "Highest entry not set but aggro was added";
@@ -67,9 +67,9 @@ TEST_F(AggroTest, testAggroMgrDegradeValue) {
 	backend::ICharacterPtr entity = core::make_shared<TestEntity>(id);
 	backend::AIPtr ai = std::make_shared<backend::AI>(backend::TreeNodePtr());
 	ai->setCharacter(entity);
+	mgr.setReduceByValue(reduceBySecond);
 	mgr.addAggro(id, expectedAggro);
 	const backend::EntryPtr& entry = mgr.getHighestEntry();
-	entry->setReduceByValue(reduceBySecond);
 	ASSERT_TRUE(entry) << "Highest entry not set but aggro was added";
 	ASSERT_EQ(id, entry->getCharacterId())<< "Highest entry not what it should be";
 	const float aggro = entry->getAggro();
@@ -80,4 +80,56 @@ TEST_F(AggroTest, testAggroMgrDegradeValue) {
 	ASSERT_FLOAT_EQ(expected, newAggro);
 }
 
+TEST_F(AggroTest, testAggroMgrHighestAfterReduction) {
+	backend::AggroMgr mgr;
+	mgr.setReduceByValue(6.0f);
+	mgr.addAggro(1, 10.0f);
+	mgr.addAggro(2, 5.0f);
+	mgr.addAggro(3, 7.0f);
+	ASSERT_EQ(1, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+	mgr.update(1000);
+	ASSERT_EQ(2u, mgr.count()) << "The entry without aggro left should be removed " << printAggroList(mgr);
+	ASSERT_EQ(1, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+	ASSERT_FLOAT_EQ(4.0f, mgr.getHighestEntry()->getAggro());
+	mgr.addAggro(2, 10.0f);
+	ASSERT_EQ(2, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+	ASSERT_FLOAT_EQ(10.0f, mgr.getHighestEntry()->getAggro());
+	mgr.addAggro(3, 20.0f);
+	ASSERT_EQ(3, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+	ASSERT_FLOAT_EQ(21.0f, mgr.getHighestEntry()->getAggro());
+	mgr.addAggro(3, -15.0f);
+	ASSERT_EQ(2, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+
+	// 1 = 2, 2 = 5, 3 = 3 after the reduction
+	mgr.setReduceByRatio(0.5f, 2.5f);
+	mgr.update(1000);
+	ASSERT_EQ(2u, mgr.count()) << "The entry below the minimum aggro should be removed " << printAggroList(mgr);
+	ASSERT_EQ(2, mgr.getHighestEntry()->getCharacterId()) << printAggroList(mgr);
+	ASSERT_FLOAT_EQ(5.0f, mgr.getHighestEntry()->getAggro());
+	ASSERT_FLOAT_EQ(3.0f, mgr.addAggro(3, 0.0f)->getAggro());
+}
+
+TEST_F(AggroTest, testAggroMgrLongReduction) {
+	backend::AggroMgr mgr;
+	mgr.setReduceByRatio(0.01f, 0.0f);
+	mgr.addAggro(1, 1000.0f);
+	mgr.addAggro(2, 500.0f);
+	// the accumulated reduction is moved into the entries before the precision is lost
+	for (int i = 0; i < 10000; ++i) {
+		mgr.update(1000);
+	}
+	ASSERT_EQ(0u, mgr.count()) << printAggroList(mgr);
+
+	mgr.setReduceByValue(1.0f);
+	mgr.addAggro(1, 3000000.0f);
+	mgr.addAggro(2, 2000000.0f);
+	for (int i = 0; i < 1500; ++i) {
+		mgr.update(1000000);
+	}
+	ASSERT_EQ(2u, mgr.count()) << printAggroList(mgr);
+	ASSERT_EQ(1, mgr.getHighestEntry()->getCharacterId());
+	ASSERT_NEAR(1500000.0f, mgr.getHighestEntry()->getAggro(), 0.5f);
+	ASSERT_NEAR(500000.0f, mgr.addAggro(2, 0.0f)->getAggro(), 0.5f);
+}
+
 }
@@ -0,0 +1,166 @@
+/**
+ * @file
+ */
+
+#include "TestShared.h"
+#include "backend/entity/ai/tree/CompiledTree.h"
+#include "backend/entity/ai/tree/Fail.h"
+#include "backend/entity/ai/tree/Idle.h"
+#include "backend/entity/ai/tree/Invert.h"
+#include "backend/entity/ai/tree/Limit.h"
+#include "backend/entity/ai/tree/Parallel.h"
+#include "backend/entity/ai/tree/PrioritySelector.h"
+#include "backend/entity/ai/tree/Sequence.h"
+#include "backend/entity/ai/tree/Succeed.h"
+#include "backend/entity/ai/condition/False.h"
+#include "backend/entity/ai/condition/True.h"
+
+namespace backend {
+
+class CompiledTreeTest: public TestSuite {
+protected:
+	template<class NODE>
+	TreeNodePtr create(const char* name, const char* parameters = "", const ConditionPtr& condition = True::get()) const {
+		typename NODE::Factory f;
+		TreeNodeFactoryContext ctx(name, parameters, condition);
+		return f.create(&ctx);
+	}
+
+	/**
+	 * @brief Builds a tree that uses all the node types that are interpreted by the @c CompiledTree
+	 * @param[out] nodes All nodes of the tree in pre-order
+	 */
+	TreeNodePtr build(std::vector<TreeNodePtr>& nodes) const {
+		const TreeNodePtr& root = create<PrioritySelector>("root");
+		const TreeNodePtr& sequence = create<Sequence>("sequence");
+		const TreeNodePtr& idle1 = create<Idle>("idle1", "3");
+		const TreeNodePtr& limit = create<Limit>("limit", "2");
+		const TreeNodePtr& idle2 = create<Idle>("idle2", "2");
+		const TreeNodePtr& invert = create<Invert>("invert");
+		const TreeNodePtr& fail = create<Fail>("fail");
+		const TreeNodePtr& idle3 = create<Idle>("idle3", "1");
+		const TreeNodePtr& parallel = create<Parallel>("parallel");
+		const TreeNodePtr& idle4 = create<Idle>("idle4", "2", False::get());
+		const TreeNodePtr& succeed = create<Succeed>("succeed");
+		const TreeNodePtr& idle5 = create<Idle>("idle5", "4");
+		root->addChild(sequence);
+		sequence->addChild(idle1);
+		sequence->addChild(limit);
+		limit->addChild(idle2);
+		root->addChild(invert);
+		invert->addChild(fail);
+		fail->addChild(idle3);
+		root->addChild(parallel);
+		parallel->addChild(idle4);
+		parallel->addChild(succeed);
+		succeed->addChild(idle5);
+		nodes = {root, sequence, idle1, limit, idle2, invert, fail, idle3, parallel, idle4, succeed, idle5};
+		return root;
+	}
+
+	/**
+	 * @return The index of the active child of the given selector
+	 */
+	int selected(const TreeNodePtr& selector, const AIPtr& ai) const {
+		std::vector<bool> active;
+		selector->getRunningChildren(ai, active);
+		for (size_t i = 0; i < active.size(); ++i) {
+			if (active[i]) {
+				return (int)i;
+			}
+		}
+		return AI_NOTHING_SELECTED;
+	}
+
+	AIPtr createAI(const TreeNodePtr& root, const CompiledTreePtr& compiled, ai::CharacterId id) const {
+		AIPtr ai = std::make_shared<AI>(root, compiled);
+		ai->setCharacter(core::make_shared<ICharacter>(id));
+		return ai;
+	}
+};
+
+TEST_F(CompiledTreeTest, testSlots) {
+	std::vector<TreeNodePtr> nodes;
+	const TreeNodePtr& root = build(nodes);
+	const CompiledTreePtr& compiled = CompiledTree::compile(root);
+	ASSERT_TRUE(compiled);
+	ASSERT_EQ((int)nodes.size(), compiled->size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		EXPECT_EQ((int)i, compiled->slot(nodes[i]->getId())) << nodes[i]->getName().c_str();
+	}
+	EXPECT_EQ(-1, compiled->slot(-1));
+	EXPECT_FALSE(CompiledTree::compile(TreeNodePtr()));
+}
+
+TEST_F(CompiledTreeTest, testSameResultsAsTreeNodes) {
+	std::vector<TreeNodePtr> legacyNodes;
+	std::vector<TreeNodePtr> compiledNodes;
+	// the timers of the tree nodes are stored in the nodes - so every runtime needs its own tree
+	const AIPtr& legacy = createAI(build(legacyNodes), CompiledTreePtr(), 1);
+	const TreeNodePtr& root = build(compiledNodes);
+	const AIPtr& compiled = createAI(root, CompiledTree::compile(root), 2);
+	for (int tick = 0; tick < 30; ++tick) {
+		legacy->update(1, true);
+		compiled->update(1, true);
+		const ai::TreeNodeStatus expected = AI::execute(legacy, 1);
+		ASSERT_EQ(expected, AI::execute(compiled, 1)) << "tick " << tick;
+		for (size_t i = 0; i < legacyNodes.size(); ++i) {
+			ASSERT_EQ(legacyNodes[i]->getLastStatus(legacy), compiledNodes[i]->getLastStatus(compiled))
+				<< "tick " << tick << " node " << legacyNodes[i]->getName().c_str();
+			ASSERT_EQ(legacyNodes[i]->getLastExecMillis(legacy), compiledNodes[i]->getLastExecMillis(compiled))
+				<< "tick " << tick << " node " << legacyNodes[i]->getName().c_str();
+		}
+	}
+}
+
+TEST_F(CompiledTreeTest, testStatePerAI) {
+	const TreeNodePtr& root = create<Sequence>("root");
+	const TreeNodePtr& idle = create<Idle>("idle", "2");
+	root->addChild(idle);
+	const CompiledTreePtr& compiled = CompiledTree::compile(root);
+	const AIPtr& ai1 = createAI(root, compiled, 1);
+	const AIPtr& ai2 = createAI(root, compiled, 2);
+
+	ai1->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, AI::execute(ai1, 1));
+	EXPECT_EQ(0, selected(root, ai1));
+	EXPECT_EQ(AI_NOTHING_SELECTED, selected(root, ai2));
+
+	// the second entity starts its own timer
+	ai2->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, AI::execute(ai2, 1));
+	ai1->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, AI::execute(ai1, 1));
+	ai1->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, AI::execute(ai1, 1));
+	EXPECT_EQ(AI_NOTHING_SELECTED, selected(root, ai1));
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, idle->getLastStatus(ai2));
+}
+
+TEST_F(CompiledTreeTest, testInvalidate) {
+	const TreeNodePtr& root = create<Sequence>("root");
+	root->addChild(create<Idle>("idle", "2"));
+	const CompiledTreePtr& compiled = CompiledTree::compile(root);
+	const AIPtr& ai = createAI(root, compiled, 1);
+	ai->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, AI::execute(ai, 1));
+	EXPECT_EQ(0, selected(root, ai));
+
+	compiled->invalidate();
+	const TreeNodePtr& idle = create<Idle>("idle2", "1");
+	root->addChild(idle);
+	// the tree node runtime continues with the states of the compiled tree
+	for (int i = 0; i < 4; ++i) {
+		ai->update(1, true);
+		AI::execute(ai, 1);
+	}
+	EXPECT_NE(ai::TreeNodeStatus::UNKNOWN, idle->getLastStatus(ai));
+
+	ai->setBehaviour(root, CompiledTree::compile(root));
+	ai->update(1, true);
+	EXPECT_EQ(AI_NOTHING_SELECTED, selected(root, ai));
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, AI::execute(ai, 1));
+	EXPECT_EQ(3, ai->getCompiledBehaviour()->size());
+}
+
+}
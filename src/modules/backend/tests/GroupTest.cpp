@@ -196,4 +196,73 @@ TEST_F(GroupTest, testGroupRemove) {
 	ASSERT_EQ(0, groupMgr.getGroupSize(id));
 }
 
+TEST_F(GroupTest, testGroupRemoveFromAllGroups) {
+	GroupMgr groupMgr;
+	AIPtr entity1 = std::make_shared<AI>(TreeNodePtr());
+	entity1->setCharacter(core::make_shared<ICharacter>(1));
+	entity1->getCharacter()->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+	AIPtr entity2 = std::make_shared<AI>(TreeNodePtr());
+	entity2->setCharacter(core::make_shared<ICharacter>(2));
+	entity2->getCharacter()->setPosition(glm::vec3(4.0f, 0.0f, 0.0f));
+	ASSERT_TRUE(groupMgr.add(1, entity1));
+	ASSERT_TRUE(groupMgr.add(2, entity1));
+	ASSERT_TRUE(groupMgr.add(3, entity1));
+	ASSERT_TRUE(groupMgr.add(2, entity2));
+	ASSERT_FALSE(groupMgr.add(2, entity2));
+	groupMgr.update(0);
+	glm::vec3 avg(0.0f);
+	EXPECT_TRUE(groupMgr.getPosition(2, avg));
+	EXPECT_EQ(glm::vec3(3.0f, 0.0f, 0.0f), avg);
+	EXPECT_EQ(entity1, groupMgr.getLeader(2));
+	EXPECT_TRUE(groupMgr.isInGroup(3, entity1));
+	EXPECT_FALSE(groupMgr.isInGroup(3, entity2));
+
+	ASSERT_TRUE(groupMgr.removeFromAllGroups(entity1));
+	EXPECT_FALSE(groupMgr.isInAnyGroup(entity1));
+	EXPECT_TRUE(groupMgr.isInAnyGroup(entity2));
+	EXPECT_EQ(0, groupMgr.getGroupSize(1));
+	EXPECT_EQ(1, groupMgr.getGroupSize(2));
+	EXPECT_EQ(0, groupMgr.getGroupSize(3));
+	EXPECT_EQ(entity2, groupMgr.getLeader(2));
+	EXPECT_FALSE(groupMgr.getPosition(1, avg));
+	groupMgr.update(0);
+	EXPECT_TRUE(groupMgr.getPosition(2, avg));
+	EXPECT_EQ(glm::vec3(4.0f, 0.0f, 0.0f), avg);
+}
+
+TEST_F(GroupTest, testGroupChangeAfterQuery) {
+	GroupMgr groupMgr;
+	AIPtr entity1 = std::make_shared<AI>(TreeNodePtr());
+	entity1->setCharacter(core::make_shared<ICharacter>(1));
+	entity1->getCharacter()->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+	AIPtr entity2 = std::make_shared<AI>(TreeNodePtr());
+	entity2->setCharacter(core::make_shared<ICharacter>(2));
+	entity2->getCharacter()->setPosition(glm::vec3(4.0f, 0.0f, 0.0f));
+	ASSERT_TRUE(groupMgr.add(1, entity1));
+	ASSERT_TRUE(groupMgr.add(2, entity2));
+	groupMgr.update(0);
+	// the published groups are shared with the queries - the changes must not leak into the other groups
+	for (int i = 0; i < 3; ++i) {
+		ASSERT_TRUE(groupMgr.add(2, entity1));
+		EXPECT_EQ(1, groupMgr.getGroupSize(1));
+		EXPECT_EQ(2, groupMgr.getGroupSize(2));
+		EXPECT_TRUE(groupMgr.isInGroup(2, entity1));
+		EXPECT_EQ(entity2, groupMgr.getLeader(2));
+		ASSERT_TRUE(groupMgr.remove(2, entity1));
+		EXPECT_EQ(1, groupMgr.getGroupSize(2));
+		EXPECT_FALSE(groupMgr.isInGroup(2, entity1));
+		EXPECT_TRUE(groupMgr.isInGroup(1, entity1));
+		EXPECT_TRUE(groupMgr.isInAnyGroup(entity1));
+	}
+	glm::vec3 avg(0.0f);
+	EXPECT_TRUE(groupMgr.getPosition(2, avg));
+	EXPECT_EQ(glm::vec3(4.0f, 0.0f, 0.0f), avg);
+	ASSERT_TRUE(groupMgr.add(2, entity1));
+	groupMgr.update(0);
+	EXPECT_TRUE(groupMgr.getPosition(2, avg));
+	EXPECT_EQ(glm::vec3(3.0f, 0.0f, 0.0f), avg);
+	EXPECT_TRUE(groupMgr.getPosition(1, avg));
+	EXPECT_EQ(glm::vec3(2.0f, 0.0f, 0.0f), avg);
+}
+
 }
@@ -158,4 +158,46 @@ TEST_F(LUAAIRegistryTest, testSteeringEmpty) {
 	testSteering("LuaSteeringTest");
 }
 
+TEST_F(LUAAIRegistryTest, testZoneThreads) {
+	const TreeNodeFactoryContext ctx = TreeNodeFactoryContext("TreeNodeName", "", True::get());
+	const TreeNodePtr& node = _registry.createNode("LuaTest2", ctx);
+	ASSERT_TRUE((bool)node);
+	std::vector<AIPtr> ais;
+	{
+		// the zone workers are executing the node in their own lua states
+		Zone zone("TestThreads", 2);
+		zone.setDebug(true);
+		for (ai::CharacterId id = 1; id <= 16; ++id) {
+			const AIPtr& ai = std::make_shared<AI>(node);
+			ai->setCharacter(core::make_shared<TestEntity>(id));
+			ASSERT_TRUE(zone.addAI(ai));
+			ais.push_back(ai);
+		}
+		for (int i = 0; i < 3; ++i) {
+			zone.update(1l);
+		}
+		for (const AIPtr& ai : ais) {
+			EXPECT_EQ(ai::TreeNodeStatus::RUNNING, node->getLastStatus(ai)) << "AI " << ai->getId();
+		}
+	}
+	// the workers are gone with the zone - and so are their states
+	EXPECT_EQ(0, _registry.threadStates());
+
+	// the states of the other threads are bound by the next call and evaluate the new scripts first
+	ASSERT_TRUE(_registry.evaluate("local node = REGISTRY.createNode(\"LuaTest3\")\n"
+		"function node:execute(ai, deltaMillis)\n"
+		"  return FAILED\n"
+		"end\n"));
+	const TreeNodePtr& node3 = _registry.createNode("LuaTest3", ctx);
+	ASSERT_TRUE((bool)node3);
+	core::ThreadPool pool(1, "TestThreads");
+	pool.init();
+	const AIPtr& ai = ais.front();
+	EXPECT_EQ(ai::TreeNodeStatus::FAILED, pool.enqueue([&] () { return node3->execute(ai, 1L); }).get());
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, pool.enqueue([&] () { return node->execute(ai, 1L); }).get());
+	EXPECT_EQ(1, _registry.threadStates());
+	pool.shutdown(true);
+	EXPECT_EQ(0, _registry.threadStates());
+}
+
 }
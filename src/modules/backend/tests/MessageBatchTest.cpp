@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "network/BuilderPool.h"
+#include "network/MessageBatch.h"
+#include "core/collection/DynamicArray.h"
+
+namespace network {
+
+class MessageBatchTest: public app::AbstractTest {
+};
+
+TEST_F(MessageBatchTest, testRoundtrip) {
+	MessageBatch batch;
+	EXPECT_TRUE(batch.empty());
+	const uint8_t first[] = {1, 2, 3};
+	const uint8_t second[] = {4, 5, 6, 7, 8, 9, 10, 11, 12};
+	const size_t expectedSize = batch.sizeWith(sizeof(first));
+	batch.add(first, sizeof(first));
+	EXPECT_EQ(expectedSize, batch.size());
+	const size_t expectedSize2 = batch.sizeWith(sizeof(second));
+	batch.add(second, sizeof(second));
+	EXPECT_EQ(expectedSize2, batch.size());
+	ASSERT_EQ(2u, batch.count());
+
+	int messages = 0;
+	const bool valid = MessageBatch::unbatch(batch.data(), batch.size(), [&] (const uint8_t* data, size_t size) {
+		EXPECT_EQ(0u, (uintptr_t)(data - batch.data()) % 8u) << "The message data must be 8 byte aligned";
+		if (messages == 0) {
+			EXPECT_EQ(sizeof(first), size);
+			EXPECT_EQ(0, SDL_memcmp(first, data, size));
+		} else {
+			EXPECT_EQ(sizeof(second), size);
+			EXPECT_EQ(0, SDL_memcmp(second, data, size));
+		}
+		++messages;
+	});
+	EXPECT_TRUE(valid);
+	EXPECT_EQ(2, messages);
+
+	batch.clear();
+	EXPECT_TRUE(batch.empty());
+	EXPECT_EQ(0u, batch.size());
+}
+
+TEST_F(MessageBatchTest, testMalformed) {
+	MessageBatch batch;
+	const uint8_t message[] = {1, 2, 3, 4, 5};
+	batch.add(message, sizeof(message));
+	batch.add(message, sizeof(message));
+	int messages = 0;
+	const auto func = [&] (const uint8_t*, size_t) {
+		++messages;
+	};
+	EXPECT_FALSE(MessageBatch::unbatch(batch.data(), batch.size() - 1, func));
+	EXPECT_FALSE(MessageBatch::unbatch(batch.data(), 2, func));
+	EXPECT_EQ(0, messages) << "No message of a malformed payload may be handed out";
+	EXPECT_TRUE(MessageBatch::unbatch(batch.data(), batch.size(), func));
+	EXPECT_EQ(2, messages);
+
+	// a count that doesn't match the frames
+	core::DynamicArray<uint8_t> payload;
+	payload.append(batch.data(), batch.size());
+	const uint32_t count = 0xffffffffu;
+	SDL_memcpy(payload.data(), &count, sizeof(count));
+	EXPECT_FALSE(MessageBatch::unbatch(payload.data(), payload.size(), func));
+	EXPECT_EQ(2, messages);
+}
+
+TEST_F(MessageBatchTest, testRejectedMessage) {
+	MessageBatch batch;
+	const uint8_t valid[] = {1, 2, 3};
+	const uint8_t invalid[] = {0xff, 0xff};
+	batch.add(valid, sizeof(valid));
+	batch.add(invalid, sizeof(invalid));
+	batch.add(valid, sizeof(valid));
+	int handled = 0;
+	int rejected = 0;
+	const bool framingValid = MessageBatch::unbatch(batch.data(), batch.size(), [&] (const uint8_t* data, size_t) {
+		// the receiver drops the messages it can't handle
+		if (data[0] == 0xff) {
+			++rejected;
+			return;
+		}
+		++handled;
+	});
+	EXPECT_TRUE(framingValid) << "A rejected message is not a framing error";
+	EXPECT_EQ(1, rejected);
+	EXPECT_EQ(2, handled) << "The messages after the rejected one must still be handed out";
+}
+
+TEST_F(MessageBatchTest, testBuilderPool) {
+	const size_t pooled = BuilderPool::size();
+	flatbuffers::FlatBufferBuilder* fbbPtr;
+	{
+		PooledBuilder builder;
+		fbbPtr = &*builder;
+		builder->CreateString("foo");
+		EXPECT_NE(0u, builder->GetSize());
+	}
+	EXPECT_EQ(pooled + 1u, BuilderPool::size());
+	PooledBuilder builder;
+	EXPECT_EQ(fbbPtr, &*builder) << "The builder should get reused";
+	EXPECT_EQ(0u, builder->GetSize()) << "The builder should be cleared";
+}
+
+}
@@ -12,6 +12,10 @@
 #include "backend/entity/ai/movement/TargetSeek.h"
 #include "backend/entity/ai/movement/Wander.h"
 #include "backend/entity/ai/movement/WeightedSteering.h"
+#include "backend/entity/ai/movement/SteeringBatch.h"
+#include "backend/entity/ai/tree/PrioritySelector.h"
+#include "backend/entity/ai/tree/Steer.h"
+#include "backend/entity/ai/condition/True.h"
 #include "backend/entity/ai/zone/Zone.h"
 #include "backend/entity/ai/common/Random.h"
 #include <glm/gtc/constants.hpp>
@@ -21,6 +25,34 @@ namespace backend {
 class MovementTest: public TestSuite {
 protected:
 	const float _speed = 100.0f;
+
+	void fillBatch(movement::SteeringBatch& batch, int amount) {
+		for (int i = 0; i < amount; ++i) {
+			const AIPtr& ai = std::make_shared<AI>(TreeNodePtr());
+			const ICharacterPtr& entity = core::make_shared<ICharacter>(i + 1);
+			ai->setCharacter(entity);
+			entity->setPosition(glm::vec3((float)(i % 5) - 2.0f, 0.0f, (float)(i / 5) - 2.0f));
+			entity->setOrientation((float)i * 0.3f);
+			batch.add(ai, _speed, 0.1f);
+		}
+	}
+
+	void compareBatch(const movement::ISteering& steering, const movement::SteeringBatch& batch) {
+		movement::SteeringResults results;
+		results.reset(batch.size());
+		steering.executeBatch(batch, results);
+		for (size_t i = 0; i < batch.size(); ++i) {
+			const MoveVector& mv = steering.execute(batch.ais[i], batch.speed[i]);
+			ASSERT_EQ(mv.state(), results.state[i]) << "character " << i;
+			if (!mv.isValid()) {
+				continue;
+			}
+			EXPECT_NEAR(mv.getVector().x, results.x[i], 0.001f) << "character " << i;
+			EXPECT_NEAR(mv.getVector().y, results.y[i], 0.001f) << "character " << i;
+			EXPECT_NEAR(mv.getVector().z, results.z[i], 0.001f) << "character " << i;
+			EXPECT_NEAR(mv.getRotation(), results.rotation[i], 0.0001f) << "character " << i;
+		}
+	}
 };
 
 TEST_F(MovementTest, testFlee) {
@@ -120,4 +152,138 @@ TEST_F(MovementTest, testWeightedSteering) {
 	EXPECT_EQ(result, mv.getVector());
 }
 
+TEST_F(MovementTest, testBatch) {
+	movement::SteeringBatch batch;
+	fillBatch(batch, 25);
+	compareBatch(movement::TargetSeek("0:0:0"), batch);
+	compareBatch(movement::TargetFlee("0:0:0"), batch);
+	compareBatch(movement::TargetSeek("invalid"), batch);
+	compareBatch(movement::Wander("0"), batch);
+}
+
+TEST_F(MovementTest, testWeightedSteeringBatch) {
+	movement::SteeringBatch batch;
+	fillBatch(batch, 25);
+	const backend::SteeringPtr& flee = std::make_shared<backend::movement::TargetFlee>("1:0:0");
+	const backend::SteeringPtr& wander = std::make_shared<backend::movement::Wander>("0");
+	backend::movement::WeightedSteerings s;
+	s.push_back(backend::movement::WeightedData(flee, 0.8f));
+	s.push_back(backend::movement::WeightedData(wander, 0.2f));
+	backend::movement::WeightedSteering w(s);
+	movement::SteeringResults results;
+	movement::SteeringResults scratch;
+	w.executeBatch(batch, results, scratch);
+	ASSERT_EQ(batch.size(), results.size());
+	for (size_t i = 0; i < batch.size(); ++i) {
+		const MoveVector& mv = w.execute(batch.ais[i], batch.speed[i]);
+		ASSERT_EQ(mv.state(), results.state[i]) << "character " << i;
+		EXPECT_NEAR(mv.getVector().x, results.x[i], 0.001f) << "character " << i;
+		EXPECT_NEAR(mv.getVector().z, results.z[i], 0.001f) << "character " << i;
+		EXPECT_NEAR(mv.getRotation(), results.rotation[i], 0.0001f) << "character " << i;
+	}
+}
+
+TEST_F(MovementTest, testSteerInZone) {
+	const backend::SteeringPtr& seek = std::make_shared<backend::movement::TargetSeek>("10:0:0");
+	const backend::SteeringPtr& invalid = std::make_shared<backend::movement::TargetSeek>("invalid");
+	const SteerNodeFactoryContext ctx("steer", "", True::get(), {seek});
+	const TreeNodePtr& steer = Steer::getFactory().create(&ctx);
+	const SteerNodeFactoryContext invalidCtx("steerinvalid", "", True::get(), {invalid});
+	const TreeNodePtr& steerInvalid = Steer::getFactory().create(&invalidCtx);
+
+	Zone zone("movementTest");
+	zone.setDebug(true);
+	const AIPtr& ai = std::make_shared<AI>(steer);
+	const ICharacterPtr& entity = core::make_shared<ICharacter>(1);
+	entity->setCurrent(attrib::Type::SPEED, 1.0);
+	ai->setCharacter(entity);
+	zone.addAI(ai);
+	const AIPtr& aiInvalid = std::make_shared<AI>(steerInvalid);
+	const ICharacterPtr& entityInvalid = core::make_shared<ICharacter>(2);
+	entityInvalid->setCurrent(attrib::Type::SPEED, 1.0);
+	aiInvalid->setCharacter(entityInvalid);
+	zone.addAI(aiInvalid);
+
+	zone.update(1000);
+	EXPECT_NEAR(1.0f, entity->getPosition().x, 0.0001f);
+	EXPECT_EQ(glm::vec3(0.0f), entityInvalid->getPosition());
+	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, steer->getLastStatus(ai));
+	zone.update(1000);
+	EXPECT_NEAR(2.0f, entity->getPosition().x, 0.0001f);
+	// the result of the batched evaluation is reported in the next tick
+	EXPECT_EQ(ai::TreeNodeStatus::FAILED, steerInvalid->getLastStatus(aiInvalid));
+}
+
+TEST_F(MovementTest, testSteerInZoneFallback) {
+	const backend::SteeringPtr& groupSeek = std::make_shared<backend::movement::GroupSeek>("1");
+	const backend::SteeringPtr& seek = std::make_shared<backend::movement::TargetSeek>("10:0:0");
+	const SteerNodeFactoryContext groupCtx("steergroup", "", True::get(), {groupSeek});
+	const TreeNodePtr& steerGroup = Steer::getFactory().create(&groupCtx);
+	const SteerNodeFactoryContext ctx("steer", "", True::get(), {seek});
+	const TreeNodePtr& steer = Steer::getFactory().create(&ctx);
+	PrioritySelector::Factory f;
+	const TreeNodeFactoryContext selectorCtx("selector", "", True::get());
+	const TreeNodePtr& root = f.create(&selectorCtx);
+	root->addChild(steerGroup);
+	root->addChild(steer);
+
+	Zone zone("movementTest");
+	zone.setDebug(true);
+	const AIPtr& ai = std::make_shared<AI>(root);
+	const ICharacterPtr& entity = core::make_shared<ICharacter>(1);
+	entity->setCurrent(attrib::Type::SPEED, 1.0);
+	ai->setCharacter(entity);
+	zone.addAI(ai);
+
+	// group 1 doesn't exist - the group steering is marked as invalid at the end of the first tick
+	zone.update(1000);
+	EXPECT_EQ(glm::vec3(0.0f), entity->getPosition());
+	for (int tick = 1; tick <= 4; ++tick) {
+		zone.update(1000);
+		// the failed group steering must not move the character in addition to the fallback
+		EXPECT_EQ(ai::TreeNodeStatus::FAILED, steerGroup->getLastStatus(ai)) << "tick " << tick;
+		EXPECT_EQ(ai::TreeNodeStatus::FINISHED, steer->getLastStatus(ai)) << "tick " << tick;
+		EXPECT_NEAR((float)tick, entity->getPosition().x, 0.0001f) << "tick " << tick;
+		EXPECT_NEAR(0.0f, entity->getPosition().z, 0.0001f) << "tick " << tick;
+	}
+
+	// the group steering is valid again as soon as the group exists
+	const AIPtr& member = std::make_shared<AI>(TreeNodePtr());
+	const ICharacterPtr& memberEntity = core::make_shared<ICharacter>(2);
+	memberEntity->setPosition(glm::vec3(0.0f, 0.0f, 10.0f));
+	member->setCharacter(memberEntity);
+	ASSERT_TRUE(zone.getGroupMgr().add(1, member));
+	for (int tick = 0; tick < 4 && steerGroup->getLastStatus(ai) != ai::TreeNodeStatus::FINISHED; ++tick) {
+		zone.update(1000);
+	}
+	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, steerGroup->getLastStatus(ai));
+}
+
+TEST_F(MovementTest, testSteerInZoneWorkers) {
+	const backend::SteeringPtr& seek = std::make_shared<backend::movement::TargetSeek>("1000:0:0");
+	const SteerNodeFactoryContext ctx("steer", "", True::get(), {seek});
+	const TreeNodePtr& steer = Steer::getFactory().create(&ctx);
+
+	// enough characters to split the steering requests over all the workers
+	Zone zone("movementTest", 4);
+	const int amount = 300;
+	std::vector<ICharacterPtr> entities;
+	for (int i = 1; i <= amount; ++i) {
+		const AIPtr& ai = std::make_shared<AI>(steer);
+		const ICharacterPtr& entity = core::make_shared<ICharacter>(i);
+		entity->setCurrent(attrib::Type::SPEED, 1.0);
+		entity->setPosition(glm::vec3((float)i, 0.0f, 0.0f));
+		ai->setCharacter(entity);
+		ASSERT_TRUE(zone.addAI(ai));
+		entities.push_back(entity);
+	}
+
+	zone.update(1000);
+	for (int i = 1; i <= amount; ++i) {
+		const glm::vec3& pos = entities[i - 1]->getPosition();
+		EXPECT_NEAR((float)(i + 1), pos.x, 0.0001f) << "character " << i;
+		EXPECT_NEAR(0.0f, pos.z, 0.0001f) << "character " << i;
+	}
+}
+
 }
@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#include "NpcTest.h"
+#include "backend/spawn/SpawnMgr.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxel/Constants.h"
+
+namespace backend {
+
+class SpawnMgrTest: public NpcTest {
+};
+
+TEST_F(SpawnMgrTest, testUpdateBudget) {
+	core::Var::get(cfg::ServerSpawnBudget, "1")->setVal(2);
+	const int before = map->npcCount();
+	map->spawnMgr().update(0L);
+	EXPECT_EQ(before + 2, map->npcCount()) << "Only the budget should have been spawned";
+	for (int i = 0; i < 20; ++i) {
+		map->spawnMgr().update(0L);
+	}
+	const int populated = map->npcCount();
+	map->spawnMgr().update(0L);
+	EXPECT_EQ(populated, map->npcCount()) << "Nothing should get spawned if the population is complete";
+	core::Var::get(cfg::ServerSpawnBudget, "1")->setVal(1);
+}
+
+TEST_F(SpawnMgrTest, testRespawn) {
+	core::Var::get(cfg::ServerSpawnBudget, "1")->setVal(1000);
+	map->spawnMgr().update(0L);
+	const int populated = map->npcCount();
+	const NpcPtr& npc = create(network::EntityType::ANIMAL_WOLF);
+	ASSERT_TRUE(npc);
+	EXPECT_TRUE(map->removeNpc(npc->id()));
+	map->spawnMgr().update(0L);
+	EXPECT_EQ(populated, map->npcCount()) << "The removed npc should not have triggered a respawn";
+	core::Var::get(cfg::ServerSpawnBudget, "1")->setVal(1);
+}
+
+TEST_F(SpawnMgrTest, testSpawnCells) {
+	const voxelutil::FloorTraceResult& floor = map->findFloor(glm::ivec3(0, voxel::MAX_TERRAIN_HEIGHT, 0));
+	ASSERT_TRUE(floor.isValid());
+	EXPECT_GT(map->spawnMgr().spawnCells(), 0u) << "The paged in chunks should have valid spawn cells";
+	map->worldMgr()->volumeData()->flushAll();
+	EXPECT_EQ(0u, map->spawnMgr().spawnCells()) << "The spawn cells of the paged out chunks should be dropped";
+	EXPECT_EQ(0, map->worldMgr()->floorIndex().tiles()) << "The floor index of the paged out chunks should be dropped";
+}
+
+}
@@ -0,0 +1,164 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "backend/entity/ai/server/StateSnapshot.h"
+
+namespace backend {
+
+class StateSnapshotTest: public app::AbstractTest {
+protected:
+	CharacterState state(ai::CharacterId id, float x = 0.0f) const {
+		CharacterState s;
+		s.id = id;
+		s.position = glm::vec3(x, 0.0f, 0.0f);
+		s.homePosition = glm::vec3(0.0f);
+		s.targetPosition = glm::vec3(0.0f);
+		s.orientation = 0.0f;
+		s.attributesHash = 0u;
+		return s;
+	}
+
+	void sendAll(StateSnapshot& snapshot, const CharacterStates& current) const {
+		core::DynamicArray<int> changed;
+		core::DynamicArray<ai::CharacterId> removed;
+		snapshot.diff(current, changed, removed);
+		snapshot.apply(current, changed.data(), changed.size(), removed);
+	}
+};
+
+TEST_F(StateSnapshotTest, testAdded) {
+	StateSnapshot snapshot;
+	CharacterStates current;
+	current.push_back(state(1));
+	current.push_back(state(2));
+	core::DynamicArray<int> changed;
+	core::DynamicArray<ai::CharacterId> removed;
+	snapshot.diff(current, changed, removed);
+	ASSERT_EQ(2u, changed.size());
+	EXPECT_TRUE(removed.empty());
+	snapshot.apply(current, changed.data(), changed.size(), removed);
+	EXPECT_EQ(2u, snapshot.size());
+	snapshot.diff(current, changed, removed);
+	EXPECT_TRUE(changed.empty()) << "Unchanged states must not be sent again";
+	EXPECT_TRUE(removed.empty());
+}
+
+TEST_F(StateSnapshotTest, testChangedAndRemoved) {
+	StateSnapshot snapshot;
+	CharacterStates current;
+	current.push_back(state(1));
+	current.push_back(state(2));
+	current.push_back(state(3));
+	sendAll(snapshot, current);
+
+	CharacterStates next;
+	next.push_back(state(1));
+	next.push_back(state(3, 1.0f));
+	next.push_back(state(4));
+	core::DynamicArray<int> changed;
+	core::DynamicArray<ai::CharacterId> removed;
+	snapshot.diff(next, changed, removed);
+	ASSERT_EQ(2u, changed.size());
+	// the new character comes first
+	EXPECT_EQ(2, changed[0]);
+	EXPECT_EQ(1, changed[1]);
+	ASSERT_EQ(1u, removed.size());
+	EXPECT_EQ(2, removed[0]);
+	snapshot.apply(next, changed.data(), changed.size(), removed);
+	EXPECT_EQ(3u, snapshot.size());
+	snapshot.diff(next, changed, removed);
+	EXPECT_TRUE(changed.empty());
+	EXPECT_TRUE(removed.empty());
+}
+
+TEST_F(StateSnapshotTest, testPartial) {
+	StateSnapshot snapshot;
+	CharacterStates current;
+	for (int i = 1; i <= 10; ++i) {
+		current.push_back(state(i));
+	}
+	core::DynamicArray<int> changed;
+	core::DynamicArray<ai::CharacterId> removed;
+	snapshot.diff(current, changed, removed);
+	ASSERT_EQ(10u, changed.size());
+	// the byte budget only allowed to send the first four states
+	snapshot.apply(current, changed.data(), 4, removed);
+	EXPECT_EQ(4u, snapshot.size());
+	snapshot.diff(current, changed, removed);
+	ASSERT_EQ(6u, changed.size()) << "The states that didn't fit must be sent with the next message";
+	EXPECT_EQ(4, changed[0]);
+	snapshot.apply(current, changed.data(), changed.size(), removed);
+	snapshot.diff(current, changed, removed);
+	EXPECT_TRUE(changed.empty());
+}
+
+TEST_F(StateSnapshotTest, testPartialRotation) {
+	StateSnapshot snapshot;
+	constexpr int characters = 10;
+	constexpr size_t budget = 4u;
+	int lastSent[characters + 1];
+	for (int i = 0; i <= characters; ++i) {
+		lastSent[i] = -1;
+	}
+	core::DynamicArray<int> changed;
+	core::DynamicArray<ai::CharacterId> removed;
+	for (int message = 0; message < 12; ++message) {
+		// every character changes between two messages
+		CharacterStates current;
+		for (int i = 1; i <= characters; ++i) {
+			current.push_back(state(i, (float)message));
+		}
+		snapshot.diff(current, changed, removed);
+		ASSERT_EQ((size_t)characters, changed.size());
+		const size_t sent = core_min(budget, changed.size());
+		for (size_t i = 0u; i < sent; ++i) {
+			lastSent[current[changed[i]].id] = message;
+		}
+		snapshot.apply(current, changed.data(), sent, removed);
+		if (message < 2) {
+			continue;
+		}
+		// 10 characters with 4 per message - every character must be part of the last three messages
+		for (int i = 1; i <= characters; ++i) {
+			EXPECT_GE(lastSent[i], message - 2) << "character " << i << " was starved in message " << message;
+		}
+	}
+	EXPECT_EQ((size_t)characters, snapshot.size());
+}
+
+TEST_F(StateSnapshotTest, testPartialNewFirst) {
+	StateSnapshot snapshot;
+	CharacterStates current;
+	current.push_back(state(1));
+	current.push_back(state(2));
+	sendAll(snapshot, current);
+
+	CharacterStates next;
+	next.push_back(state(1, 1.0f));
+	next.push_back(state(2, 1.0f));
+	next.push_back(state(3));
+	core::DynamicArray<int> changed;
+	core::DynamicArray<ai::CharacterId> removed;
+	snapshot.diff(next, changed, removed);
+	ASSERT_EQ(3u, changed.size());
+	EXPECT_EQ(2, changed[0]) << "The characters the client doesn't know yet must be sent first";
+	EXPECT_EQ(0, changed[1]);
+	EXPECT_EQ(1, changed[2]);
+	// only the new character and the first changed one fit
+	snapshot.apply(next, changed.data(), 2, removed);
+	EXPECT_EQ(3u, snapshot.size());
+
+	CharacterStates last;
+	last.push_back(state(1, 2.0f));
+	last.push_back(state(2, 1.0f));
+	last.push_back(state(3, 2.0f));
+	snapshot.diff(last, changed, removed);
+	ASSERT_EQ(3u, changed.size());
+	EXPECT_EQ(1, changed[0]) << "The state that was sent the longest time ago must come first";
+	EXPECT_EQ(0, changed[1]);
+	EXPECT_EQ(2, changed[2]);
+}
+
+}
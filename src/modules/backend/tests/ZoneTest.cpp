@@ -6,6 +6,7 @@
 #include "backend/entity/ai/tree/PrioritySelector.h"
 #include "backend/entity/ai/zone/Zone.h"
 #include "backend/entity/ai/condition/True.h"
+#include "backend/entity/ai/filter/SelectZone.h"
 
 namespace backend {
 
@@ -52,4 +53,62 @@ TEST_F(ZoneTest, testAdd100) {
 	ASSERT_EQ(n, (int)zone.size());
 }
 
+TEST_F(ZoneTest, testIndexVisit) {
+	ZoneIndex index(10.0f);
+	index.add(1, glm::vec3(0.0f, 0.0f, 0.0f));
+	index.add(2, glm::vec3(-5.0f, 0.0f, -5.0f));
+	index.add(3, glm::vec3(15.0f, 0.0f, 0.0f));
+	index.add(4, glm::vec3(-25.0f, 0.0f, 3.0f));
+	index.add(5, glm::vec3(0.0f, 0.0f, 100.0f));
+	index.build();
+	ASSERT_EQ(5u, index.size());
+
+	core::DynamicArray<ai::CharacterId> ids;
+	auto collect = [&] (ai::CharacterId id) {
+		ids.push_back(id);
+	};
+	index.visit(glm::vec3(0.0f), 10.0f, collect);
+	core::sort(ids.begin(), ids.end(), core::Less<ai::CharacterId>());
+	ASSERT_EQ(2u, ids.size());
+	EXPECT_EQ(1, ids[0]);
+	EXPECT_EQ(2, ids[1]);
+
+	ids.clear();
+	index.visit(glm::vec3(-10.0f, 0.0f, 0.0f), 16.0f, collect);
+	core::sort(ids.begin(), ids.end(), core::Less<ai::CharacterId>());
+	ASSERT_EQ(3u, ids.size());
+	EXPECT_EQ(1, ids[0]);
+	EXPECT_EQ(2, ids[1]);
+	EXPECT_EQ(4, ids[2]);
+}
+
+TEST_F(ZoneTest, testFilterSelectZoneRadius) {
+	Zone zone("test1");
+	TreeNodePtr root = std::make_shared<PrioritySelector>("test", "", True::get());
+	const int n = 10;
+	AIPtr first;
+	for (int i = 0; i < n; ++i) {
+		ICharacterPtr character = core::make_shared<TestEntity>(i);
+		character->setPosition(glm::vec3((float)i * 10.0f, 0.0f, 0.0f));
+		AIPtr ai = std::make_shared<AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+		if (i == 0) {
+			first = ai;
+		}
+	}
+	zone.update(0l);
+	ASSERT_EQ((size_t)n, zone.getIndex().size());
+
+	const FilterFactoryContext ctx("25");
+	const FilterPtr& filter = SelectZone::getFactory().create(&ctx);
+	filter->filter(first);
+	EXPECT_EQ(3u, first->getFilteredEntities().size());
+
+	const FilterFactoryContext allCtx("");
+	const FilterPtr& all = SelectZone::getFactory().create(&allCtx);
+	all->filter(first);
+	EXPECT_EQ(3u + n, first->getFilteredEntities().size());
+}
+
 }
@@ -19,6 +19,7 @@
 #include "backend/spawn/SpawnMgr.h"
 #include "persistence/PersistenceMgr.h"
 #include "attrib/ContainerProvider.h"
+#include <algorithm>
 
 namespace backend {
 
@@ -46,7 +47,8 @@ Map::Map(MapId mapId,
 		_eventBus(eventBus), _filesystem(filesystem), _persistenceMgr(persistenceMgr),
 		_volumeCache(volumeCache), _attackMgr(this), _poiProvider(timeProvider), _spawnMgr(this, filesystem, entityStorage, messageSender,
 			timeProvider, loader, containerProvider, cooldownProvider),
-		_quadTree(math::RectFloat::getMaxRect(), 100.0f), _chunkPersister(chunkPersister) {
+		_quadTree(math::RectFloat::getMaxRect(), 100.0f), _chunkPersister(chunkPersister),
+		_pathfinder([this] (int x, int y, int z) { return isWalkable(x, y, z); }, 32, 1, voxel::MAX_HEIGHT) {
 }
 
 Map::~Map() {
@@ -82,8 +84,10 @@ void Map::update(long dt) {
 	core_trace_scoped(MapUpdate);
 	Log::trace("tick map %i", (int)_mapId);
 	_spawnMgr.update(dt);
+	_poiProvider.update(dt);
 	_zone->update(dt);
 	_attackMgr.update(dt);
+	updateRoutes(_pathfinderBudget->intVal());
 
 	for (auto i = _users.begin(); i != _users.end();) {
 		UserPtr user = i->second;
@@ -106,6 +110,7 @@ void Map::update(long dt) {
 		_quadTree.remove(QuadTreeNode { npc });
 		i = _npcs.erase(i);
 		_zone->removeAI(npc->id());
+		_spawnMgr.onRemove(npc->entityType());
 		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
 	}
 }
@@ -127,6 +132,19 @@ bool Map::init() {
 		Log::error("Failed to init map with id %i", _mapId);
 		return false;
 	}
+	_pager->setChunkListener([this] (const voxel::PagedVolume::Chunk& chunk, const voxel::Region& region) {
+		_voxelWorldMgr->floorIndex().build(chunk, region);
+		_spawnMgr.updateSpawnCells(region);
+		// the clusters that were sampled before the chunk was indexed are built again
+		core::ScopedLock lock(_changedRegionsLock);
+		_changedRegions.push_back(region);
+	});
+	_pager->setPageOutListener([this] (const voxel::Region& region) {
+		_spawnMgr.removeSpawnCells(region);
+		_voxelWorldMgr->floorIndex().remove(region);
+		core::ScopedLock lock(_changedRegionsLock);
+		_changedRegions.push_back(region);
+	});
 
 	const core::VarPtr& seed = core::Var::getSafe(cfg::ServerSeed);
 	const core::String& worldParamData = _filesystem->load("worldparams.lua");
@@ -136,6 +154,7 @@ bool Map::init() {
 	_pager->setNoiseOffset(glm::vec2(0.0f));
 
 	_voxelWorldMgr->setSeed(seed->uintVal());
+	_pathfinderBudget = core::Var::get(cfg::ServerPathfinderBudget, "20000");
 	_zone = new Zone(core::string::format("Zone %i", _mapId));
 
 	if (!_spawnMgr.init()) {
@@ -148,6 +167,14 @@ bool Map::init() {
 void Map::shutdown() {
 	_attackMgr.shutdown();
 	_spawnMgr.shutdown();
+	{
+		core::ScopedLock lock(_pathfinderLock);
+		_pathfinder.clear();
+	}
+	{
+		core::ScopedLock lock(_changedRegionsLock);
+		_changedRegions.clear();
+	}
 	if (_pager != nullptr) {
 		_pager->shutdown();
 		_pager = voxelworld::WorldPagerPtr();
@@ -197,6 +224,14 @@ bool Map::removeUser(EntityId id) {
 	return true;
 }
 
+void Map::userPositions(core::DynamicArray<glm::vec3>& positions) const {
+	positions.clear();
+	positions.reserve(_users.size());
+	for (const auto& e : _users) {
+		positions.push_back(e.second->pos());
+	}
+}
+
 UserPtr Map::user(EntityId id) {
 	UsersIter i = _users.find(id);
 	if (i == _users.end()) {
@@ -211,7 +246,8 @@ bool Map::addNpc(const NpcPtr& npc) {
 	if (!i.second) {
 		return false;
 	}
-	const glm::vec3& pos = findStartPosition(npc);
+	// the spawn manager already placed the npc
+	const glm::vec3 pos = npc->ai()->getCharacter()->getPosition();
 	npc->setMap(ptr(), pos);
 	_zone->addAI(npc->ai());
 	_quadTree.insert(QuadTreeNode { npc });
@@ -229,6 +265,7 @@ bool Map::removeNpc(EntityId id) {
 	_quadTree.remove(QuadTreeNode { npc });
 	_npcs.erase(i);
 	_zone->removeAI(npc->id());
+	_spawnMgr.onRemove(npc->entityType());
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(npc));
 	return true;
 }
@@ -242,6 +279,61 @@ NpcPtr Map::npc(EntityId id) {
 	return i->second;
 }
 
+bool Map::isWalkable(int x, int y, int z) {
+	const glm::ivec2 column(x, z);
+	if (!_walkableColumnValid || _walkableColumn != column) {
+		_walkableColumnIndexed = _voxelWorldMgr->floorIndex().floorHeights(x, z, _walkableFloors);
+		_walkableColumn = column;
+		_walkableColumnValid = true;
+	}
+	if (!_walkableColumnIndexed) {
+		return false;
+	}
+	return std::find(_walkableFloors.begin(), _walkableFloors.end(), y) != _walkableFloors.end();
+}
+
+voxelutil::PathId Map::requestRoute(const glm::ivec3& start, const glm::ivec3& end) {
+	core::ScopedLock lock(_pathfinderLock);
+	return _pathfinder.request(start, end);
+}
+
+void Map::cancelRoute(voxelutil::PathId id) {
+	core::ScopedLock lock(_pathfinderLock);
+	_pathfinder.cancel(id);
+}
+
+voxelutil::PathState Map::route(voxelutil::PathId id, std::vector<glm::ivec3>& route) {
+	core::ScopedLock lock(_pathfinderLock);
+	const voxelutil::PathState state = _pathfinder.state(id);
+	if (state != voxelutil::PathState::Queued) {
+		// hands out the path and forgets about the request
+		route.clear();
+		_pathfinder.result(id, route);
+	}
+	return state;
+}
+
+int Map::updateRoutes(int nodeBudget) {
+	core_trace_scoped(MapUpdateRoutes);
+	std::vector<voxel::Region> changed;
+	{
+		core::ScopedLock lock(_changedRegionsLock);
+		changed.swap(_changedRegions);
+	}
+	core::ScopedLock lock(_pathfinderLock);
+	for (const voxel::Region& region : changed) {
+		_pathfinder.remove(region);
+	}
+	// the column might have been indexed since the last update
+	_walkableColumnValid = false;
+	return _pathfinder.update(nodeBudget);
+}
+
+int Map::pendingRoutes() const {
+	core::ScopedLock lock(_pathfinderLock);
+	return _pathfinder.pending();
+}
+
 voxelutil::FloorTraceResult Map::findFloor(const glm::ivec3& pos, int maxDistanceY) const {
 	return _voxelWorldMgr->findWalkableFloor(pos, maxDistanceY);
 }
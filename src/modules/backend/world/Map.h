@@ -11,7 +11,12 @@
 #include "core/FourCC.h"
 #include "ai-shared/common/CharacterId.h"
 #include "voxelutil/FloorTraceResult.h"
+#include "voxelutil/HierarchicalPathfinder.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
 #include "backend/attack/AttackMgr.h"
 #include "persistence/ISavable.h"
 #include "persistence/ForwardDecl.h"
@@ -22,7 +27,9 @@
 #include "MapId.h"
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include <glm/fwd.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 namespace backend {
@@ -66,6 +73,27 @@ private:
 
 	math::QuadTree<QuadTreeNode, float> _quadTree;
 	DBChunkPersisterPtr _chunkPersister;
+	/** the npcs request their routes from the zone worker threads */
+	voxelutil::HierarchicalPathfinder _pathfinder core_thread_guarded_by(_pathfinderLock);
+	mutable core_trace_mutex(core::Lock, _pathfinderLock, "Pathfinder");
+	/**
+	 * The regions of the paged in and paged out chunks - they are removed from the pathfinder in @c updateRoutes().
+	 * The pager listeners are called with the volume lock held - so they must not take the pathfinder lock.
+	 */
+	std::vector<voxel::Region> _changedRegions core_thread_guarded_by(_changedRegionsLock);
+	core_trace_mutex(core::Lock, _changedRegionsLock, "ChangedRegions");
+	core::VarPtr _pathfinderBudget;
+	/** the floors of the column the pathfinder samples - the validator is called for each voxel of a column in a row */
+	glm::ivec2 _walkableColumn core_thread_guarded_by(_pathfinderLock) = glm::ivec2(0);
+	std::vector<int> _walkableFloors core_thread_guarded_by(_pathfinderLock);
+	bool _walkableColumnIndexed core_thread_guarded_by(_pathfinderLock) = false;
+	bool _walkableColumnValid core_thread_guarded_by(_pathfinderLock) = false;
+
+	/**
+	 * @brief The validator of the pathfinder - only the columns of the paged in chunks are walkable
+	 * @note Answered by the @c voxelworld::FloorIndex - the chunks are never paged in or generated here
+	 */
+	bool isWalkable(int x, int y, int z);
 	/**
 	 * @return @c false if the entity should be removed from the server.
 	 */
@@ -113,6 +141,10 @@ public:
 	 */
 	bool removeUser(EntityId id);
 	UserPtr user(EntityId id);
+	/**
+	 * @brief The positions of all users on this map
+	 */
+	void userPositions(core::DynamicArray<glm::vec3>& positions) const;
 
 	bool addNpc(const NpcPtr& npc);
 	/**
@@ -131,9 +163,32 @@ public:
 	int npcCount() const;
 	int userCount() const;
 
+	/**
+	 * @note Answered by the floor index of the world for all paged in chunks
+	 */
 	voxelutil::FloorTraceResult findFloor(const glm::ivec3& pos, int maxDistanceY = voxel::MAX_HEIGHT) const;
 	glm::ivec3 randomPos() const;
 
+	/**
+	 * @brief Queues a path request of an npc - the paths are computed with a limited budget per map tick
+	 * @note Thread safe - this is called from the zone worker threads
+	 * @sa voxelutil::HierarchicalPathfinder::request()
+	 */
+	voxelutil::PathId requestRoute(const glm::ivec3& start, const glm::ivec3& end);
+	void cancelRoute(voxelutil::PathId id);
+	/**
+	 * @brief Hands out the route of a finished request
+	 * @return The state of the request - the route is only filled for @c voxelutil::PathState::Found
+	 * @note Thread safe - this is called from the zone worker threads
+	 */
+	voxelutil::PathState route(voxelutil::PathId id, std::vector<glm::ivec3>& route);
+	/**
+	 * @brief Processes the queued path requests - this is done in @c update() with the configured budget
+	 * @return The work that was done
+	 */
+	int updateRoutes(int nodeBudget);
+	int pendingRoutes() const;
+
 	const DBChunkPersisterPtr& chunkPersister();
 
 	const AttackMgr& attackMgr() const;
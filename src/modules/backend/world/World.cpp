@@ -99,6 +99,11 @@ bool World::init() {
 	const core::VarPtr& aiDebugServerInterface = core::Var::get("aidbg_host", "127.0.0.1");
 	aiDebugServerInterface->setHelp("There is not auth on the debug server.");
 	_aiServer = new Server(*_registry, _metric, (short)aiDebugServerPort->intVal(), aiDebugServerInterface->strVal());
+	const core::VarPtr& aiDebugStateInterval = core::Var::get("aidbg_stateinterval", 100);
+	aiDebugStateInterval->setHelp("The minimum millis between two world state messages of the ai debug server.");
+	const core::VarPtr& aiDebugStateBudget = core::Var::get("aidbg_statebudget", 65536);
+	aiDebugStateBudget->setHelp("The maximum size in bytes of a world state message of the ai debug server.");
+	_aiServer->setStateBroadcastLimits(aiDebugStateInterval->intVal(), (size_t)aiDebugStateBudget->intVal());
 	if (_aiServer->start()) {
 		Log::info("Start the ai debug server on %s:%i", aiDebugServerInterface->strVal().c_str(), aiDebugServerPort->intVal());
 	} else {
@@ -114,6 +119,8 @@ bool World::init() {
 		const MapPtr& map = e->value;
 		_aiServer->addZone(map->zone());
 	}
+	// every zone is ticked by its own worker thread - prepare the lua states for them
+	_registry->reserveStates((int)_maps.size());
 
 	return true;
 }
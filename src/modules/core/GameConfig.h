@@ -37,6 +37,12 @@ constexpr const char *AudioMusicVolume = "snd_musicvolume";
 constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
 constexpr const char *ClientWater = "cl_water";
+// Hide the terrain chunks that are occluded by nearer terrain
+constexpr const char *ClientOcclusionCulling = "cl_occlusionculling";
+// The max size of the extracted terrain meshes that are cached on disk in megabytes - 0 disables the cache
+constexpr const char *ClientMeshCacheSize = "cl_meshcachesize";
+// The distance up to which the low resolution terrain impostors are rendered beyond the extracted meshes - 0 disables them
+constexpr const char *ClientImpostorDistance = "cl_impostordistance";
 constexpr const char *ClientFog = "cl_fog";
 constexpr const char *ClientCameraMaxTargetDistance = "cl_cameramaxtargetdistance";
 constexpr const char *ClientCameraZoomSpeed = "cl_camzoomspeed";
@@ -56,6 +62,10 @@ constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
 // the download urls for the chunks
 constexpr const char *ServerChunkBaseUrl = "sv_httpchunkurl";
+// the amount of pathfinding nodes that are expanded per map tick
+constexpr const char *ServerPathfinderBudget = "sv_pathfinderbudget";
+// the amount of npcs that are spawned per map tick
+constexpr const char *ServerSpawnBudget = "sv_spawnbudget";
 
 constexpr const char *ConsoleCurses = "con_curses";
 
@@ -66,6 +76,10 @@ constexpr const char *CorePath = "core_path";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// The distance at which the meshes are extracted with a reduced level of detail - 0 disables it
+constexpr const char *VoxelLODDistance = "voxel_loddistance";
+// The time in milliseconds that is spent each frame to upload the extracted meshes
+constexpr const char *VoxelUploadBudget = "voxel_uploadbudget";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
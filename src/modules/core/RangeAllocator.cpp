@@ -0,0 +1,170 @@
+/**
+ * @file
+ */
+
+#include "RangeAllocator.h"
+#include "core/Assert.h"
+#include <algorithm>
+
+namespace core {
+
+RangeAllocator::RangeAllocator(uint32_t capacity) {
+	grow(capacity);
+}
+
+void RangeAllocator::addFreeRange(uint32_t offset, uint32_t size) {
+	if (size == 0u) {
+		return;
+	}
+	_freeByOffset.insert(std::make_pair(offset, size));
+	_freeBySize.insert(std::make_pair(size, offset));
+}
+
+void RangeAllocator::removeFreeRange(uint32_t offset, uint32_t size) {
+	_freeByOffset.erase(offset);
+	_freeBySize.erase(std::make_pair(size, offset));
+}
+
+RangeAllocator::Handle RangeAllocator::allocate(uint32_t size) {
+	core_assert_msg(size > 0u, "Zero sized allocations are not allowed");
+	if (size == 0u) {
+		return InvalidHandle;
+	}
+	auto i = _freeBySize.lower_bound(std::make_pair(size, 0u));
+	if (i == _freeBySize.end()) {
+		return InvalidHandle;
+	}
+	const uint32_t freeSize = i->first;
+	const uint32_t freeOffset = i->second;
+	removeFreeRange(freeOffset, freeSize);
+	addFreeRange(freeOffset + size, freeSize - size);
+
+	const Handle handle = _nextHandle++;
+	if (_nextHandle == InvalidHandle) {
+		++_nextHandle;
+	}
+	_allocations.insert(std::make_pair(handle, Range{freeOffset, size}));
+	_used += size;
+	return handle;
+}
+
+bool RangeAllocator::free(Handle handle) {
+	auto i = _allocations.find(handle);
+	if (i == _allocations.end()) {
+		return false;
+	}
+	uint32_t offset = i->second.offset;
+	uint32_t size = i->second.size;
+	_used -= size;
+	_allocations.erase(i);
+
+	// coalesce with the following free range
+	auto next = _freeByOffset.find(offset + size);
+	if (next != _freeByOffset.end()) {
+		const uint32_t nextSize = next->second;
+		removeFreeRange(next->first, nextSize);
+		size += nextSize;
+	}
+	// coalesce with the preceding free range
+	auto prev = _freeByOffset.lower_bound(offset);
+	if (prev != _freeByOffset.begin()) {
+		--prev;
+		if (prev->first + prev->second == offset) {
+			const uint32_t prevOffset = prev->first;
+			const uint32_t prevSize = prev->second;
+			removeFreeRange(prevOffset, prevSize);
+			offset = prevOffset;
+			size += prevSize;
+		}
+	}
+	addFreeRange(offset, size);
+	return true;
+}
+
+uint32_t RangeAllocator::offset(Handle handle) const {
+	auto i = _allocations.find(handle);
+	core_assert_msg(i != _allocations.end(), "Invalid handle %u", handle);
+	if (i == _allocations.end()) {
+		return 0u;
+	}
+	return i->second.offset;
+}
+
+uint32_t RangeAllocator::size(Handle handle) const {
+	auto i = _allocations.find(handle);
+	if (i == _allocations.end()) {
+		return 0u;
+	}
+	return i->second.size;
+}
+
+void RangeAllocator::grow(uint32_t capacity) {
+	if (capacity <= _capacity) {
+		return;
+	}
+	uint32_t offset = _capacity;
+	uint32_t size = capacity - _capacity;
+	// extend the free range at the end of the address space
+	if (!_freeByOffset.empty()) {
+		auto last = std::prev(_freeByOffset.end());
+		if (last->first + last->second == _capacity) {
+			offset = last->first;
+			size += last->second;
+			removeFreeRange(last->first, last->second);
+		}
+	}
+	addFreeRange(offset, size);
+	_capacity = capacity;
+}
+
+std::vector<RangeAllocator::Move> RangeAllocator::defragment() {
+	std::vector<Move> moves;
+	if (_freeByOffset.empty()) {
+		return moves;
+	}
+	std::vector<std::pair<uint32_t, Handle> > sorted;
+	sorted.reserve(_allocations.size());
+	for (const auto& e : _allocations) {
+		sorted.push_back(std::make_pair(e.second.offset, e.first));
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	uint32_t offset = 0u;
+	for (const auto& e : sorted) {
+		Range& range = _allocations[e.second];
+		if (range.offset != offset) {
+			moves.push_back(Move{e.second, range.offset, offset, range.size});
+			range.offset = offset;
+		}
+		offset += range.size;
+	}
+	_freeByOffset.clear();
+	_freeBySize.clear();
+	addFreeRange(offset, _capacity - offset);
+	return moves;
+}
+
+void RangeAllocator::clear() {
+	_allocations.clear();
+	_freeByOffset.clear();
+	_freeBySize.clear();
+	_used = 0u;
+	addFreeRange(0u, _capacity);
+}
+
+uint32_t RangeAllocator::largestFreeRange() const {
+	if (_freeBySize.empty()) {
+		return 0u;
+	}
+	return _freeBySize.rbegin()->first;
+}
+
+float RangeAllocator::fragmentation() const {
+	const uint32_t freeSpace = available();
+	if (freeSpace == 0u) {
+		return 0.0f;
+	}
+	return 1.0f - (float)largestFreeRange() / (float)freeSpace;
+}
+
+}
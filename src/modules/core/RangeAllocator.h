@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Manages the ranges of a linear address space - e.g. the vertices or indices inside of one large
+ * gpu buffer. The allocator itself doesn't own any memory, it only hands out offsets.
+ *
+ * The free ranges are kept in an ordered best-fit list and are coalesced with their neighbours when an
+ * allocation is freed. Allocations are referenced by handles, because their offsets might change if the
+ * address space is defragmented.
+ *
+ * @sa defragment()
+ */
+class RangeAllocator : public core::NonCopyable {
+public:
+	typedef uint32_t Handle;
+	static constexpr Handle InvalidHandle = 0u;
+
+	/**
+	 * @brief Describes how an allocation was moved by @c defragment()
+	 */
+	struct Move {
+		Handle handle;
+		uint32_t from;
+		uint32_t to;
+		uint32_t size;
+	};
+
+private:
+	struct Range {
+		uint32_t offset;
+		uint32_t size;
+	};
+	uint32_t _capacity = 0u;
+	uint32_t _used = 0u;
+	Handle _nextHandle = InvalidHandle + 1u;
+	std::unordered_map<Handle, Range> _allocations;
+	// free ranges by offset - used to coalesce the neighbours
+	std::map<uint32_t, uint32_t> _freeByOffset;
+	// free ranges by size and offset - used for the best-fit lookup
+	std::set<std::pair<uint32_t, uint32_t> > _freeBySize;
+
+	void addFreeRange(uint32_t offset, uint32_t size);
+	void removeFreeRange(uint32_t offset, uint32_t size);
+public:
+	RangeAllocator(uint32_t capacity = 0u);
+
+	/**
+	 * @brief Searches the smallest free range that is big enough for the given size
+	 * @return @c InvalidHandle if there is no free range that is big enough - you can try to @c defragment()
+	 * or @c grow() the address space in this case.
+	 */
+	Handle allocate(uint32_t size);
+	/**
+	 * @return @c false if the given handle is unknown
+	 */
+	bool free(Handle handle);
+
+	/**
+	 * @return The current offset of the allocation - this might change after @c defragment() was called
+	 */
+	uint32_t offset(Handle handle) const;
+	uint32_t size(Handle handle) const;
+	bool valid(Handle handle) const;
+
+	/**
+	 * @brief Extends the address space at the end
+	 * @note Shrinking is not supported
+	 */
+	void grow(uint32_t capacity);
+
+	/**
+	 * @brief Moves all allocations to the front of the address space - leaving one free range at the end
+	 * @return The moves that must be applied to the memory behind the address space. They are sorted by
+	 * their source offset - if applied in this order with @c memmove(), no data is overwritten before it
+	 * was moved.
+	 */
+	std::vector<Move> defragment();
+
+	/**
+	 * @brief Frees all allocations - the capacity is kept
+	 */
+	void clear();
+
+	uint32_t capacity() const;
+	uint32_t used() const;
+	uint32_t available() const;
+	/**
+	 * @return The size of the biggest allocation that would currently succeed
+	 */
+	uint32_t largestFreeRange() const;
+	/**
+	 * @return The amount of allocations
+	 */
+	size_t allocations() const;
+	/**
+	 * @return @c 0.0 if all free space is in one range, near @c 1.0 if the free space is split into many small ranges
+	 */
+	float fragmentation() const;
+};
+
+inline uint32_t RangeAllocator::capacity() const {
+	return _capacity;
+}
+
+inline uint32_t RangeAllocator::used() const {
+	return _used;
+}
+
+inline uint32_t RangeAllocator::available() const {
+	return _capacity - _used;
+}
+
+inline size_t RangeAllocator::allocations() const {
+	return _allocations.size();
+}
+
+inline bool RangeAllocator::valid(Handle handle) const {
+	return _allocations.find(handle) != _allocations.end();
+}
+
+}
@@ -0,0 +1,271 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace core {
+
+/**
+ * @brief Thread safe cache for assets that are expensive to load (volumes, meshes, ...)
+ *
+ * Every key is only loaded once (single-flight): if several threads ask for the same key
+ * while it is still loading, they all wait on the same future instead of loading it again.
+ * Failed loads are cached as @c nullptr values, too.
+ *
+ * The cache keeps track of the memory the loaded values are using (given by the size function)
+ * and evicts the least recently used entries that are no longer referenced by anybody else
+ * once the memory budget is exceeded. Entries are referenced as long as a caller holds a copy
+ * of the returned @c std::shared_ptr.
+ *
+ * @note The loader must not request its own key from the cache - this would deadlock.
+ * @note If you use @c loadAsync() the cache must outlive the pending tasks of the given thread pool.
+ */
+template<class T>
+class AsyncCache {
+public:
+	using ValuePtr = std::shared_ptr<T>;
+	using Future = std::shared_future<ValuePtr>;
+	/**
+	 * @brief Creates the value for the given key - ownership is transferred to the cache.
+	 * Return @c nullptr on failure.
+	 */
+	using Loader = std::function<T*(const core::String& key)>;
+	/**
+	 * @brief Returns the amount of memory in bytes that the given value is using
+	 */
+	using SizeFunc = std::function<size_t(const T& value)>;
+
+private:
+	using Promise = std::promise<ValuePtr>;
+	using PromisePtr = std::shared_ptr<Promise>;
+
+	struct Entry {
+		Future future;
+		size_t bytes = 0u;
+		uint64_t lastAccess = 0u;
+		/** the promise that is fulfilled by the thread that loads the value */
+		const Promise *owner = nullptr;
+		bool loaded = false;
+	};
+	core::StringMap<Entry, 64> _entries core_thread_guarded_by(_mutex);
+	core_trace_mutex(core::Lock, _mutex, "AsyncCache");
+	Loader _loader;
+	SizeFunc _sizeFunc;
+	size_t _memoryBudget core_thread_guarded_by(_mutex);
+	size_t _memoryUsage core_thread_guarded_by(_mutex) = 0u;
+	uint64_t _accessCounter core_thread_guarded_by(_mutex) = 0u;
+
+	/**
+	 * @brief Returns the future for the given key. If the key is not yet known, a new entry is created
+	 * and the returned promise must be fulfilled by the caller with @c load()
+	 */
+	Future acquire(const core::String& key, PromisePtr& promise);
+	void load(const core::String& key, const PromisePtr& promise);
+	void evict() core_thread_requires(_mutex);
+
+public:
+	/**
+	 * @param[in] memoryBudget The max amount of bytes the cached values should use. @c 0 means no limit.
+	 */
+	AsyncCache(const Loader& loader, const SizeFunc& sizeFunc = SizeFunc(), size_t memoryBudget = 0u);
+
+	/**
+	 * @brief Returns the cached value or loads it on the calling thread. If the value is currently loaded
+	 * by another thread, this call blocks until the value is available.
+	 * @return @c nullptr if the value could not get loaded
+	 */
+	ValuePtr get(const core::String& key);
+
+	/**
+	 * @brief Schedules the loading of the given key on the thread pool and returns immediately.
+	 * Use this to preload assets that are needed later on.
+	 */
+	Future loadAsync(const core::String& key, core::ThreadPool& threadPool);
+
+	/**
+	 * @return @c true if the value for the given key is loaded (successfully or not)
+	 */
+	bool isLoaded(const core::String& key) const;
+
+	/**
+	 * @brief Removes the entry from the cache. Callers that still hold a reference can
+	 * still use the value.
+	 */
+	bool remove(const core::String& key);
+	void clear();
+
+	void setMemoryBudget(size_t memoryBudget);
+	size_t memoryUsage() const;
+	size_t size() const;
+
+	/**
+	 * @brief Calls the given functor with the key of every entry
+	 */
+	template<class FUNC>
+	void visitKeys(FUNC&& func) const {
+		core::ScopedLock lock(_mutex);
+		for (const auto& e : _entries) {
+			func(e->key);
+		}
+	}
+};
+
+template<class T>
+AsyncCache<T>::AsyncCache(const Loader& loader, const SizeFunc& sizeFunc, size_t memoryBudget) :
+		_loader(loader), _sizeFunc(sizeFunc), _memoryBudget(memoryBudget) {
+}
+
+template<class T>
+typename AsyncCache<T>::Future AsyncCache<T>::acquire(const core::String& key, PromisePtr& promise) {
+	core::ScopedLock lock(_mutex);
+	auto i = _entries.find(key);
+	if (i != _entries.end()) {
+		i->value.lastAccess = ++_accessCounter;
+		return i->value.future;
+	}
+	promise = std::make_shared<Promise>();
+	Entry entry;
+	entry.future = promise->get_future().share();
+	entry.lastAccess = ++_accessCounter;
+	entry.owner = promise.get();
+	_entries.put(key, entry);
+	return entry.future;
+}
+
+template<class T>
+void AsyncCache<T>::load(const core::String& key, const PromisePtr& promise) {
+	core_trace_scoped(AsyncCacheLoad);
+	const ValuePtr value(_loader(key));
+	const size_t bytes = (value && _sizeFunc) ? _sizeFunc(*value) : 0u;
+	// wake up the waiting threads before marking the entry as loaded - evict() may only
+	// access the futures of loaded entries
+	promise->set_value(value);
+	core::ScopedLock lock(_mutex);
+	auto i = _entries.find(key);
+	// the entry might have been removed (and maybe even re-added) while we were loading it
+	if (i != _entries.end() && i->value.owner == promise.get()) {
+		i->value.loaded = true;
+		i->value.bytes = bytes;
+		_memoryUsage += bytes;
+	}
+	evict();
+}
+
+template<class T>
+void AsyncCache<T>::evict() {
+	if (_memoryBudget == 0u) {
+		return;
+	}
+	while (_memoryUsage > _memoryBudget) {
+		// linear scan - the amount of assets is small compared to the costs of loading them
+		const core::String *lruKey = nullptr;
+		uint64_t lruAccess = UINT64_MAX;
+		for (const auto& e : _entries) {
+			const Entry& entry = e->value;
+			if (!entry.loaded || entry.bytes == 0u || entry.lastAccess >= lruAccess) {
+				continue;
+			}
+			// the only reference is the one in the future - nobody is using this value anymore
+			if (entry.future.get().use_count() > 1) {
+				continue;
+			}
+			lruAccess = entry.lastAccess;
+			lruKey = &e->key;
+		}
+		if (lruKey == nullptr) {
+			return;
+		}
+		auto i = _entries.find(*lruKey);
+		_memoryUsage -= i->value.bytes;
+		_entries.erase(i);
+	}
+}
+
+template<class T>
+typename AsyncCache<T>::ValuePtr AsyncCache<T>::get(const core::String& key) {
+	PromisePtr promise;
+	Future future = acquire(key, promise);
+	if (promise) {
+		load(key, promise);
+	}
+	return future.get();
+}
+
+template<class T>
+typename AsyncCache<T>::Future AsyncCache<T>::loadAsync(const core::String& key, core::ThreadPool& threadPool) {
+	PromisePtr promise;
+	Future future = acquire(key, promise);
+	if (!promise) {
+		return future;
+	}
+	auto task = threadPool.enqueue([this, key, promise] () {
+		load(key, promise);
+	});
+	if (!task.valid()) {
+		// the thread pool is already shut down - there would be nobody to fulfill the promise
+		load(key, promise);
+	}
+	return future;
+}
+
+template<class T>
+bool AsyncCache<T>::isLoaded(const core::String& key) const {
+	core::ScopedLock lock(_mutex);
+	auto i = _entries.find(key);
+	if (i == _entries.end()) {
+		return false;
+	}
+	return i->value.loaded;
+}
+
+template<class T>
+bool AsyncCache<T>::remove(const core::String& key) {
+	core::ScopedLock lock(_mutex);
+	auto i = _entries.find(key);
+	if (i == _entries.end()) {
+		return false;
+	}
+	if (i->value.loaded) {
+		_memoryUsage -= i->value.bytes;
+	}
+	_entries.erase(i);
+	return true;
+}
+
+template<class T>
+void AsyncCache<T>::clear() {
+	core::ScopedLock lock(_mutex);
+	_entries.clear();
+	_memoryUsage = 0u;
+}
+
+template<class T>
+void AsyncCache<T>::setMemoryBudget(size_t memoryBudget) {
+	core::ScopedLock lock(_mutex);
+	_memoryBudget = memoryBudget;
+	evict();
+}
+
+template<class T>
+size_t AsyncCache<T>::memoryUsage() const {
+	core::ScopedLock lock(_mutex);
+	return _memoryUsage;
+}
+
+template<class T>
+size_t AsyncCache<T>::size() const {
+	core::ScopedLock lock(_mutex);
+	return _entries.size();
+}
+
+}
@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include <memory>
+#include <thread>
+
+namespace core {
+
+/**
+ * @brief Splits the range [@c start, @c end) into chunks of @c chunkSize and executes the given functor
+ * for every chunk on the given thread pool.
+ *
+ * The calling thread is working on the chunks, too - so this is safe to use from within a task of the same
+ * thread pool and still makes progress if all workers are busy. The function returns after all chunks were
+ * processed.
+ *
+ * @param[in] func Called as @c func(chunkStart, chunkEnd) - the calls for the different chunks happen
+ * concurrently, @c chunkEnd is exclusive.
+ * @param[in] chunkSize The amount of elements per chunk. @c 0 picks a chunk size that gives every thread a
+ * few chunks to balance uneven workloads.
+ */
+template<class FUNC>
+void parallelFor(core::ThreadPool& threadPool, int start, int end, FUNC&& func, int chunkSize = 0) {
+	if (end <= start) {
+		return;
+	}
+	const int n = end - start;
+	const int threads = (int)threadPool.size() + 1;
+	if (chunkSize <= 0) {
+		chunkSize = core_max(1, n / (threads * 4));
+	}
+	const int chunks = (n + chunkSize - 1) / chunkSize;
+	if (chunks <= 1 || threads <= 1) {
+		func(start, end);
+		return;
+	}
+
+	struct State {
+		core::AtomicInt next { 0 };
+		core::AtomicInt done { 0 };
+	};
+	// shared with the tasks - a task that starts after all chunks were processed must still
+	// be able to check that there is nothing left to do.
+	const std::shared_ptr<State> state = std::make_shared<State>();
+	auto work = [state, start, end, chunkSize, chunks, &func] () {
+		for (;;) {
+			const int chunk = state->next.increment(1);
+			if (chunk >= chunks) {
+				// func might already be gone - don't touch it anymore
+				return;
+			}
+			const int chunkStart = start + chunk * chunkSize;
+			func(chunkStart, core_min(chunkStart + chunkSize, end));
+			state->done.increment(1);
+		}
+	};
+
+	const int helpers = core_min(threads - 1, chunks - 1);
+	for (int i = 0; i < helpers; ++i) {
+		threadPool.enqueue(work);
+	}
+	work();
+	// wait for the chunks that are still processed by the workers
+	while (state->done < chunks) {
+		std::this_thread::yield();
+	}
+}
+
+}
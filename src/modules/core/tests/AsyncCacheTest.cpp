@@ -0,0 +1,121 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/concurrent/AsyncCache.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/StringUtil.h"
+#include <SDL_timer.h>
+
+namespace core {
+
+class AsyncCacheTest: public testing::Test {
+public:
+	core::AtomicInt _loads;
+
+	void SetUp() override {
+		_loads = 0;
+	}
+
+	AsyncCache<int>::Loader loader(uint32_t delayMillis = 0u) {
+		return [this, delayMillis] (const core::String& key) -> int* {
+			++_loads;
+			if (delayMillis > 0u) {
+				SDL_Delay(delayMillis);
+			}
+			if (key == "invalid") {
+				return nullptr;
+			}
+			return new int(core::string::toInt(key));
+		};
+	}
+
+	static size_t intSize(const int& v) {
+		return 100u;
+	}
+};
+
+TEST_F(AsyncCacheTest, testGet) {
+	AsyncCache<int> cache(loader());
+	auto v1 = cache.get("1");
+	ASSERT_NE(nullptr, v1);
+	EXPECT_EQ(1, *v1);
+	auto v2 = cache.get("1");
+	EXPECT_EQ(v1.get(), v2.get());
+	EXPECT_EQ(1, _loads);
+	EXPECT_EQ(1u, cache.size());
+}
+
+TEST_F(AsyncCacheTest, testFailedLoadIsCached) {
+	AsyncCache<int> cache(loader());
+	EXPECT_EQ(nullptr, cache.get("invalid"));
+	EXPECT_EQ(nullptr, cache.get("invalid"));
+	EXPECT_EQ(1, _loads);
+	EXPECT_TRUE(cache.isLoaded("invalid"));
+}
+
+TEST_F(AsyncCacheTest, testSingleFlight) {
+	AsyncCache<int> cache(loader(50u));
+	core::ThreadPool pool(4);
+	pool.init();
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 16; ++i) {
+		results.emplace_back(pool.enqueue([&cache] () {
+			return *cache.get("42");
+		}));
+	}
+	for (auto& f : results) {
+		EXPECT_EQ(42, f.get());
+	}
+	pool.shutdown(true);
+	EXPECT_EQ(1, _loads);
+}
+
+TEST_F(AsyncCacheTest, testLoadAsync) {
+	AsyncCache<int> cache(loader(10u));
+	core::ThreadPool pool(2);
+	pool.init();
+	auto future = cache.loadAsync("3", pool);
+	auto future2 = cache.loadAsync("3", pool);
+	EXPECT_EQ(3, *future.get());
+	EXPECT_EQ(future.get().get(), future2.get().get());
+	EXPECT_EQ(3, *cache.get("3"));
+	EXPECT_EQ(1, _loads);
+	pool.shutdown(true);
+}
+
+TEST_F(AsyncCacheTest, testEvictUnreferenced) {
+	// budget for two entries
+	AsyncCache<int> cache(loader(), intSize, 200u);
+	auto v1 = cache.get("1");
+	cache.get("2");
+	EXPECT_EQ(200u, cache.memoryUsage());
+	// this exceeds the budget - "2" is the least recently used unreferenced entry
+	cache.get("3");
+	EXPECT_EQ(200u, cache.memoryUsage());
+	EXPECT_TRUE(cache.isLoaded("1"));
+	EXPECT_FALSE(cache.isLoaded("2"));
+	EXPECT_TRUE(cache.isLoaded("3"));
+	EXPECT_EQ(3, _loads);
+	// "1" is still referenced and must survive
+	v1.reset();
+	cache.get("4");
+	EXPECT_FALSE(cache.isLoaded("1"));
+	EXPECT_TRUE(cache.isLoaded("4"));
+}
+
+TEST_F(AsyncCacheTest, testRemove) {
+	AsyncCache<int> cache(loader(), intSize);
+	auto v1 = cache.get("1");
+	EXPECT_TRUE(cache.remove("1"));
+	EXPECT_FALSE(cache.remove("1"));
+	EXPECT_EQ(0u, cache.memoryUsage());
+	// the reference is still valid
+	EXPECT_EQ(1, *v1);
+	cache.get("1");
+	EXPECT_EQ(2, _loads);
+}
+
+}
@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/RangeAllocator.h"
+#include <string.h>
+
+namespace core {
+
+TEST(RangeAllocatorTest, testAllocateFree) {
+	RangeAllocator allocator(100u);
+	const RangeAllocator::Handle a = allocator.allocate(10u);
+	const RangeAllocator::Handle b = allocator.allocate(20u);
+	ASSERT_NE(RangeAllocator::InvalidHandle, a);
+	ASSERT_NE(RangeAllocator::InvalidHandle, b);
+	EXPECT_EQ(0u, allocator.offset(a));
+	EXPECT_EQ(10u, allocator.offset(b));
+	EXPECT_EQ(20u, allocator.size(b));
+	EXPECT_EQ(30u, allocator.used());
+	EXPECT_EQ(70u, allocator.available());
+	EXPECT_EQ(2u, allocator.allocations());
+
+	EXPECT_TRUE(allocator.free(a));
+	EXPECT_FALSE(allocator.free(a));
+	EXPECT_FALSE(allocator.valid(a));
+	EXPECT_EQ(20u, allocator.used());
+	EXPECT_TRUE(allocator.free(b));
+	EXPECT_EQ(0u, allocator.used());
+	// everything is coalesced again
+	EXPECT_EQ(100u, allocator.largestFreeRange());
+	EXPECT_FLOAT_EQ(0.0f, allocator.fragmentation());
+}
+
+TEST(RangeAllocatorTest, testOutOfSpace) {
+	RangeAllocator allocator(16u);
+	EXPECT_NE(RangeAllocator::InvalidHandle, allocator.allocate(16u));
+	EXPECT_EQ(RangeAllocator::InvalidHandle, allocator.allocate(1u));
+	EXPECT_EQ(0u, allocator.largestFreeRange());
+}
+
+TEST(RangeAllocatorTest, testBestFit) {
+	RangeAllocator allocator(100u);
+	const RangeAllocator::Handle a = allocator.allocate(30u);
+	const RangeAllocator::Handle b = allocator.allocate(10u);
+	const RangeAllocator::Handle c = allocator.allocate(10u);
+	const RangeAllocator::Handle d = allocator.allocate(10u);
+	ASSERT_NE(RangeAllocator::InvalidHandle, d);
+	// free ranges: [0,30) and [40,50) and [60,100)
+	allocator.free(a);
+	allocator.free(c);
+	const RangeAllocator::Handle e = allocator.allocate(8u);
+	EXPECT_EQ(40u, allocator.offset(e)) << "The smallest matching range should be used";
+	const RangeAllocator::Handle f = allocator.allocate(25u);
+	EXPECT_EQ(0u, allocator.offset(f));
+	const RangeAllocator::Handle g = allocator.allocate(35u);
+	EXPECT_EQ(60u, allocator.offset(g));
+	EXPECT_TRUE(allocator.valid(b));
+}
+
+TEST(RangeAllocatorTest, testCoalesce) {
+	RangeAllocator allocator(30u);
+	const RangeAllocator::Handle a = allocator.allocate(10u);
+	const RangeAllocator::Handle b = allocator.allocate(10u);
+	const RangeAllocator::Handle c = allocator.allocate(10u);
+	allocator.free(a);
+	allocator.free(c);
+	EXPECT_EQ(10u, allocator.largestFreeRange());
+	EXPECT_FLOAT_EQ(0.5f, allocator.fragmentation());
+	// merges with both neighbours
+	allocator.free(b);
+	EXPECT_EQ(30u, allocator.largestFreeRange());
+	const RangeAllocator::Handle d = allocator.allocate(30u);
+	EXPECT_EQ(0u, allocator.offset(d));
+}
+
+TEST(RangeAllocatorTest, testGrow) {
+	RangeAllocator allocator(10u);
+	const RangeAllocator::Handle a = allocator.allocate(5u);
+	allocator.grow(20u);
+	EXPECT_EQ(20u, allocator.capacity());
+	EXPECT_EQ(15u, allocator.largestFreeRange()) << "The free range at the end should be extended";
+	const RangeAllocator::Handle b = allocator.allocate(15u);
+	EXPECT_EQ(5u, allocator.offset(b));
+	allocator.grow(25u);
+	EXPECT_EQ(5u, allocator.largestFreeRange());
+	EXPECT_EQ(0u, allocator.offset(a));
+}
+
+TEST(RangeAllocatorTest, testDefragment) {
+	RangeAllocator allocator(64u);
+	uint8_t memory[64];
+	memset(memory, 0, sizeof(memory));
+	RangeAllocator::Handle handles[8];
+	for (int i = 0; i < 8; ++i) {
+		handles[i] = allocator.allocate(8u);
+		memset(memory + allocator.offset(handles[i]), i + 1, 8u);
+	}
+	for (int i = 0; i < 8; i += 2) {
+		allocator.free(handles[i]);
+	}
+	EXPECT_EQ(8u, allocator.largestFreeRange());
+	EXPECT_EQ(RangeAllocator::InvalidHandle, allocator.allocate(9u));
+
+	const std::vector<RangeAllocator::Move>& moves = allocator.defragment();
+	ASSERT_EQ(4u, moves.size());
+	for (const RangeAllocator::Move& move : moves) {
+		EXPECT_LT(move.to, move.from);
+		memmove(memory + move.to, memory + move.from, move.size);
+	}
+	EXPECT_EQ(32u, allocator.largestFreeRange());
+	EXPECT_FLOAT_EQ(0.0f, allocator.fragmentation());
+	for (int i = 1; i < 8; i += 2) {
+		const uint32_t offset = allocator.offset(handles[i]);
+		EXPECT_EQ((uint32_t)(i / 2) * 8u, offset);
+		for (uint32_t n = 0u; n < 8u; ++n) {
+			ASSERT_EQ(i + 1, memory[offset + n]) << "handle " << i;
+		}
+	}
+	const RangeAllocator::Handle big = allocator.allocate(32u);
+	EXPECT_EQ(32u, allocator.offset(big));
+	EXPECT_TRUE(allocator.defragment().empty());
+}
+
+TEST(RangeAllocatorTest, testClear) {
+	RangeAllocator allocator(64u);
+	const RangeAllocator::Handle a = allocator.allocate(8u);
+	allocator.allocate(8u);
+	allocator.clear();
+	EXPECT_FALSE(allocator.valid(a));
+	EXPECT_EQ(0u, allocator.used());
+	EXPECT_EQ(64u, allocator.largestFreeRange());
+	EXPECT_EQ(0u, allocator.allocations());
+}
+
+}
@@ -5,6 +5,8 @@
 #include <gtest/gtest.h>
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
+#include <vector>
 
 namespace core {
 
@@ -42,4 +44,34 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testParallelFor) {
+	core::ThreadPool pool(3);
+	pool.init();
+	const int n = 1000;
+	std::vector<int> values(n, 0);
+	core::parallelFor(pool, 0, n, [&] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			++values[i];
+			++_count;
+		}
+	}, 7);
+	ASSERT_EQ(n, _count) << "Not all elements were processed";
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(1, values[i]) << "Element " << i << " was processed more than once";
+	}
+}
+
+TEST_F(ThreadPoolTest, testParallelForNested) {
+	core::ThreadPool pool(1);
+	pool.init();
+	// the only worker is blocked by this task - the calling thread must do the work itself
+	auto future = pool.enqueue([&] () {
+		core::parallelFor(pool, 0, 100, [this] (int start, int end) {
+			_count.increment(end - start);
+		}, 1);
+	});
+	future.get();
+	ASSERT_EQ(100, _count);
+}
+
 }
@@ -0,0 +1,182 @@
+/**
+ * @file
+ */
+
+#include "BufferedFileWriter.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <SDL_endian.h>
+#include <SDL_stdinc.h>
+#include <math.h>
+
+namespace io {
+
+static const char DigitPairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const uint64_t PowersOfTen[] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull
+};
+
+/**
+ * @brief Writes the digits of the given value right aligned into a buffer of the given length.
+ * Missing leading digits are filled with zeros.
+ */
+static void writeDigits(char *buf, int length, uint64_t value) {
+	char *p = buf + length;
+	while (value >= 100u && p - 2 >= buf) {
+		const int idx = (int)(value % 100u) * 2;
+		value /= 100u;
+		p -= 2;
+		p[0] = DigitPairs[idx];
+		p[1] = DigitPairs[idx + 1];
+	}
+	while (p > buf) {
+		*--p = (char)('0' + (value % 10u));
+		value /= 10u;
+	}
+}
+
+static int countDigits(uint64_t value) {
+	int digits = 1;
+	for (;;) {
+		if (value < 10u) {
+			return digits;
+		}
+		if (value < 100u) {
+			return digits + 1;
+		}
+		if (value < 1000u) {
+			return digits + 2;
+		}
+		if (value < 10000u) {
+			return digits + 3;
+		}
+		value /= 10000u;
+		digits += 4;
+	}
+}
+
+int BufferedFileWriter::formatInt(char *buf, int64_t value) {
+	int length = 0;
+	uint64_t absValue = (uint64_t)value;
+	if (value < 0) {
+		buf[length++] = '-';
+		absValue = 0u - absValue;
+	}
+	const int digits = countDigits(absValue);
+	writeDigits(buf + length, digits, absValue);
+	return length + digits;
+}
+
+int BufferedFileWriter::formatFloat(char *buf, float value, int decimals) {
+	decimals = core_max(0, core_min(decimals, 9));
+	const double scaled = (double)value * (double)PowersOfTen[decimals];
+	// nan, inf and values that don't fit into the fixed point representation are
+	// handled by the (slow) libc functions
+	if (!(fabs(scaled) < 9.0e18)) {
+		const int length = SDL_snprintf(buf, MaxNumberLength, "%.*g", decimals, value);
+		return core_min(length, (int)MaxNumberLength - 1);
+	}
+	// llrint rounds ties to even - just like printf does
+	const int64_t fixedPoint = (int64_t)llrint(scaled);
+	int length = 0;
+	uint64_t absValue = (uint64_t)fixedPoint;
+	if (fixedPoint < 0) {
+		buf[length++] = '-';
+		absValue = 0u - absValue;
+	} else if (signbit(value) && fixedPoint == 0) {
+		// keep the printf behaviour of -0.000000
+		buf[length++] = '-';
+	}
+	const uint64_t integral = absValue / PowersOfTen[decimals];
+	const uint64_t fraction = absValue % PowersOfTen[decimals];
+	const int digits = countDigits(integral);
+	writeDigits(buf + length, digits, integral);
+	length += digits;
+	if (decimals > 0) {
+		buf[length++] = '.';
+		writeDigits(buf + length, decimals, fraction);
+		length += decimals;
+	}
+	return length;
+}
+
+BufferedFileWriter::BufferedFileWriter(FileStream& stream, size_t bufferSize) :
+		_stream(stream), _capacity(core_max(bufferSize, MaxNumberLength)) {
+	_buf = (uint8_t*)core_malloc(_capacity);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+	flush();
+	core_free(_buf);
+}
+
+bool BufferedFileWriter::flush() {
+	if (_error) {
+		return false;
+	}
+	if (_size == 0u) {
+		return true;
+	}
+	if (!_stream.append(_buf, _size)) {
+		_error = true;
+	}
+	_size = 0u;
+	return !_error;
+}
+
+bool BufferedFileWriter::addString(const char *str) {
+	return addString(str, SDL_strlen(str));
+}
+
+bool BufferedFileWriter::addString(const char *str, size_t length) {
+	if (length > _capacity) {
+		if (!flush()) {
+			return false;
+		}
+		if (!_stream.append((const uint8_t*)str, length)) {
+			_error = true;
+			return false;
+		}
+		return true;
+	}
+	if (!ensure(length)) {
+		return false;
+	}
+	SDL_memcpy(_buf + _size, str, length);
+	_size += length;
+	return true;
+}
+
+bool BufferedFileWriter::addBinaryInt(uint32_t value) {
+	if (!ensure(sizeof(value))) {
+		return false;
+	}
+	const uint32_t swapped = SDL_SwapLE32(value);
+	SDL_memcpy(_buf + _size, &swapped, sizeof(swapped));
+	_size += sizeof(swapped);
+	return true;
+}
+
+bool BufferedFileWriter::addBinaryFloat(float value) {
+	if (!ensure(sizeof(value))) {
+		return false;
+	}
+	const float swapped = SDL_SwapFloatLE(value);
+	SDL_memcpy(_buf + _size, &swapped, sizeof(swapped));
+	_size += sizeof(swapped);
+	return true;
+}
+
+}
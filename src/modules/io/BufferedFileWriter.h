@@ -0,0 +1,131 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "io/FileStream.h"
+#include "core/NonCopyable.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace io {
+
+/**
+ * @brief Collects text and binary data in a large memory buffer and writes it to the wrapped
+ * @c FileStream in big blocks.
+ *
+ * Numbers are converted to text without going through the printf machinery - this is
+ * a lot faster than @c FileStream::addStringFormat() when writing millions of values
+ * like it's done for mesh exports.
+ *
+ * @note The buffer is flushed on destruction - but you should call @c flush() yourself
+ * to be able to check for errors.
+ */
+class BufferedFileWriter : public core::NonCopyable {
+private:
+	FileStream& _stream;
+	uint8_t *_buf;
+	size_t _capacity;
+	size_t _size = 0u;
+	bool _error = false;
+
+	inline bool ensure(size_t bytes) {
+		if (_size + bytes > _capacity) {
+			return flush();
+		}
+		return !_error;
+	}
+public:
+	static constexpr size_t DefaultBufferSize = 1024 * 1024;
+	/**
+	 * @brief The max amount of bytes that a single number takes in the text representation
+	 */
+	static constexpr size_t MaxNumberLength = 32;
+
+	BufferedFileWriter(FileStream& stream, size_t bufferSize = DefaultBufferSize);
+	~BufferedFileWriter();
+
+	/**
+	 * @brief Writes the buffered data to the stream
+	 * @return @c false if any write to the underlying stream failed - the error is sticky
+	 */
+	bool flush();
+
+	bool addString(const char *str);
+	bool addString(const char *str, size_t length);
+	bool addChar(char c);
+	/**
+	 * @brief Writes the given integer as decimal text
+	 */
+	bool addInt(int64_t value);
+	/**
+	 * @brief Writes the given float as decimal text with a fixed amount of fraction digits
+	 * @param[in] decimals The amount of fraction digits - values > 9 are clamped
+	 */
+	bool addFloat(float value, int decimals = 6);
+
+	bool addByte(uint8_t value);
+	/**
+	 * @brief Little endian binary 32 bit int
+	 */
+	bool addBinaryInt(uint32_t value);
+	/**
+	 * @brief Little endian binary 32 bit float
+	 */
+	bool addBinaryFloat(float value);
+
+	/**
+	 * @brief Converts the integer into decimal text without writing a terminating @c \0
+	 * @param[out] buf Must be at least @c MaxNumberLength bytes big
+	 * @return The amount of characters written
+	 */
+	static int formatInt(char *buf, int64_t value);
+	/**
+	 * @brief Converts the float into decimal text with @c decimals fraction digits without
+	 * writing a terminating @c \0. The last digit is rounded like printf would do it.
+	 * @param[out] buf Must be at least @c MaxNumberLength bytes big
+	 * @return The amount of characters written
+	 */
+	static int formatFloat(char *buf, float value, int decimals);
+
+	bool error() const;
+};
+
+inline bool BufferedFileWriter::error() const {
+	return _error;
+}
+
+inline bool BufferedFileWriter::addChar(char c) {
+	if (!ensure(1)) {
+		return false;
+	}
+	_buf[_size++] = (uint8_t)c;
+	return true;
+}
+
+inline bool BufferedFileWriter::addByte(uint8_t value) {
+	if (!ensure(1)) {
+		return false;
+	}
+	_buf[_size++] = value;
+	return true;
+}
+
+inline bool BufferedFileWriter::addInt(int64_t value) {
+	if (!ensure(MaxNumberLength)) {
+		return false;
+	}
+	_size += formatInt((char*)_buf + _size, value);
+	return true;
+}
+
+inline bool BufferedFileWriter::addFloat(float value, int decimals) {
+	if (!ensure(MaxNumberLength)) {
+		return false;
+	}
+	_size += formatFloat((char*)_buf + _size, value, decimals);
+	return true;
+}
+
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "io/BufferedFileWriter.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include <SDL_stdinc.h>
+
+namespace io {
+
+class BufferedFileWriterTest : public testing::Test {
+protected:
+	core::String formatInt(int64_t value) {
+		char buf[BufferedFileWriter::MaxNumberLength];
+		const int length = BufferedFileWriter::formatInt(buf, value);
+		return core::String(buf, length);
+	}
+
+	core::String formatFloat(float value, int decimals) {
+		char buf[BufferedFileWriter::MaxNumberLength];
+		const int length = BufferedFileWriter::formatFloat(buf, value, decimals);
+		return core::String(buf, length);
+	}
+
+	core::String printfFloat(float value, int decimals) {
+		char buf[64];
+		SDL_snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+		return core::String(buf);
+	}
+};
+
+TEST_F(BufferedFileWriterTest, testFormatInt) {
+	EXPECT_EQ("0", formatInt(0));
+	EXPECT_EQ("7", formatInt(7));
+	EXPECT_EQ("-7", formatInt(-7));
+	EXPECT_EQ("10", formatInt(10));
+	EXPECT_EQ("100", formatInt(100));
+	EXPECT_EQ("12345", formatInt(12345));
+	EXPECT_EQ("-1000000", formatInt(-1000000));
+	EXPECT_EQ("4294967295", formatInt(4294967295ll));
+	EXPECT_EQ("-9223372036854775808", formatInt(INT64_MIN));
+}
+
+TEST_F(BufferedFileWriterTest, testFormatFloat) {
+	const float values[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 0.125f, -12.75f, 1234.5678f, 0.0001f, 31.0f, -255.5f, 1.0e6f};
+	for (float v : values) {
+		for (int decimals = 0; decimals <= 6; ++decimals) {
+			EXPECT_EQ(printfFloat(v, decimals), formatFloat(v, decimals)) << "value " << v << " with " << decimals << " decimals";
+		}
+	}
+}
+
+TEST_F(BufferedFileWriterTest, testWrite) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	const FilePtr& file = fs.open("bufferedfilewriter-writetest", io::FileMode::SysWrite);
+	ASSERT_TRUE(file->validHandle());
+	{
+		FileStream stream(file.get());
+		// use a tiny buffer to also test the flushing
+		BufferedFileWriter writer(stream, 8);
+		EXPECT_TRUE(writer.addString("v "));
+		EXPECT_TRUE(writer.addFloat(1.5f, 2));
+		EXPECT_TRUE(writer.addChar(' '));
+		EXPECT_TRUE(writer.addInt(-42));
+		EXPECT_TRUE(writer.addString(" a string that is longer than the buffer\n"));
+		EXPECT_TRUE(writer.addBinaryInt(0x12345678u));
+		EXPECT_TRUE(writer.flush());
+		EXPECT_FALSE(writer.error());
+	}
+	file->close();
+	file->open(io::FileMode::Read);
+	const core::String expected = "v 1.50 -42 a string that is longer than the buffer\n\x78\x56\x34\x12";
+	EXPECT_EQ(expected, file->load());
+}
+
+}
@@ -9,9 +9,41 @@
 #include "math/AABB.h"
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_AVX 1
+#else
+#define FRUSTUM_AVX 0
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_SSE 1
+#else
+#define FRUSTUM_SSE 0
+#endif
 
 namespace math {
 
+namespace {
+
+/**
+ * @brief The boxes are tested in blocks of 4 or 8 - so the bits of a block never cross the entries of the mask
+ */
+inline int setVisibleBits(uint32_t* visible, int index, uint32_t bits) {
+	visible[index >> 5] |= bits << (index & 31);
+	int count = 0;
+	while (bits != 0u) {
+		bits &= bits - 1u;
+		++count;
+	}
+	return count;
+}
+
+/** the amount of packed boxes that are converted into structure of arrays at once */
+constexpr int PackedBlockSize = 64;
+
+}
+
 static const glm::vec4 cornerVecs[FRUSTUM_VERTICES_MAX] = {
 	glm::vec4(-1.0f,  1.0f,  1.0f, 1.0f), glm::vec4(-1.0f, -1.0f,  1.0f, 1.0f),
 	glm::vec4( 1.0f,  1.0f,  1.0f, 1.0f), glm::vec4( 1.0f, -1.0f,  1.0f, 1.0f),
@@ -187,6 +219,174 @@ bool Frustum::isVisible(const glm::vec3& pos) const {
 	return true;
 }
 
+int Frustum::isVisible(const float* minsX, const float* minsY, const float* minsZ,
+		const float* maxsX, const float* maxsY, const float* maxsZ,
+		int amount, uint32_t* visible, float margin) const {
+	core_trace_scoped(FrustumIsVisibleBatch);
+	for (int i = 0; i < (amount + 31) / 32; ++i) {
+		visible[i] = 0u;
+	}
+	// the corner that is the farthest along the plane normal only depends on the plane
+	const float* xs[FRUSTUM_PLANES_MAX];
+	const float* ys[FRUSTUM_PLANES_MAX];
+	const float* zs[FRUSTUM_PLANES_MAX];
+	for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+		const glm::vec3& normal = _planes[p].norm();
+		xs[p] = normal.x > 0.0f ? maxsX : minsX;
+		ys[p] = normal.y > 0.0f ? maxsY : minsY;
+		zs[p] = normal.z > 0.0f ? maxsZ : minsZ;
+	}
+	const float limit = -margin;
+	int count = 0;
+	int i = 0;
+#if FRUSTUM_AVX
+	{
+		__m256 nx[FRUSTUM_PLANES_MAX], ny[FRUSTUM_PLANES_MAX], nz[FRUSTUM_PLANES_MAX], nd[FRUSTUM_PLANES_MAX];
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			nx[p] = _mm256_set1_ps(_planes[p].norm().x);
+			ny[p] = _mm256_set1_ps(_planes[p].norm().y);
+			nz[p] = _mm256_set1_ps(_planes[p].norm().z);
+			nd[p] = _mm256_set1_ps(_planes[p].dist());
+		}
+		const __m256 limits = _mm256_set1_ps(limit);
+		for (; i + 8 <= amount; i += 8) {
+			__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+				const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(xs[p] + i), nx[p]),
+						_mm256_mul_ps(_mm256_loadu_ps(ys[p] + i), ny[p])), _mm256_mul_ps(_mm256_loadu_ps(zs[p] + i), nz[p]));
+				mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(dot, nd[p]), limits, _CMP_GE_OQ));
+			}
+			count += setVisibleBits(visible, i, (uint32_t)_mm256_movemask_ps(mask));
+		}
+	}
+#endif
+#if FRUSTUM_SSE
+	{
+		__m128 nx[FRUSTUM_PLANES_MAX], ny[FRUSTUM_PLANES_MAX], nz[FRUSTUM_PLANES_MAX], nd[FRUSTUM_PLANES_MAX];
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			nx[p] = _mm_set1_ps(_planes[p].norm().x);
+			ny[p] = _mm_set1_ps(_planes[p].norm().y);
+			nz[p] = _mm_set1_ps(_planes[p].norm().z);
+			nd[p] = _mm_set1_ps(_planes[p].dist());
+		}
+		const __m128 limits = _mm_set1_ps(limit);
+		for (; i + 4 <= amount; i += 4) {
+			__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+				const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs[p] + i), nx[p]),
+						_mm_mul_ps(_mm_loadu_ps(ys[p] + i), ny[p])), _mm_mul_ps(_mm_loadu_ps(zs[p] + i), nz[p]));
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(dot, nd[p]), limits));
+			}
+			count += setVisibleBits(visible, i, (uint32_t)_mm_movemask_ps(mask));
+		}
+	}
+#endif
+	for (; i < amount; ++i) {
+		bool inside = true;
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			const glm::vec3 pos(xs[p][i], ys[p][i], zs[p][i]);
+			if (_planes[p].distanceToPlane(pos) < limit) {
+				inside = false;
+				break;
+			}
+		}
+		if (inside) {
+			count += setVisibleBits(visible, i, 1u);
+		}
+	}
+	return count;
+}
+
+int Frustum::isVisible(const AABB<float>* aabbs, int amount, uint32_t* visible, float margin) const {
+	core_trace_scoped(FrustumIsVisibleBatchAABB);
+	float minsX[PackedBlockSize], minsY[PackedBlockSize], minsZ[PackedBlockSize];
+	float maxsX[PackedBlockSize], maxsY[PackedBlockSize], maxsZ[PackedBlockSize];
+	int count = 0;
+	for (int offset = 0; offset < amount; offset += PackedBlockSize) {
+		const int n = glm::min(PackedBlockSize, amount - offset);
+		for (int i = 0; i < n; ++i) {
+			const AABB<float>& aabb = aabbs[offset + i];
+			const glm::vec3& mins = aabb.getLowerCorner();
+			const glm::vec3& maxs = aabb.getUpperCorner();
+			minsX[i] = mins.x;
+			minsY[i] = mins.y;
+			minsZ[i] = mins.z;
+			maxsX[i] = maxs.x;
+			maxsY[i] = maxs.y;
+			maxsZ[i] = maxs.z;
+		}
+		// the block size is a multiple of 32 - so each block starts at a new mask entry
+		count += isVisible(minsX, minsY, minsZ, maxsX, maxsY, maxsZ, n, visible + offset / 32, margin);
+	}
+	return count;
+}
+
+int Frustum::isVisible(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+		int amount, uint32_t* visible) const {
+	core_trace_scoped(FrustumIsVisibleBatchSphere);
+	for (int i = 0; i < (amount + 31) / 32; ++i) {
+		visible[i] = 0u;
+	}
+	int count = 0;
+	int i = 0;
+#if FRUSTUM_AVX
+	{
+		__m256 nx[FRUSTUM_PLANES_MAX], ny[FRUSTUM_PLANES_MAX], nz[FRUSTUM_PLANES_MAX], nd[FRUSTUM_PLANES_MAX];
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			nx[p] = _mm256_set1_ps(_planes[p].norm().x);
+			ny[p] = _mm256_set1_ps(_planes[p].norm().y);
+			nz[p] = _mm256_set1_ps(_planes[p].norm().z);
+			nd[p] = _mm256_set1_ps(_planes[p].dist());
+		}
+		const __m256 zero = _mm256_setzero_ps();
+		for (; i + 8 <= amount; i += 8) {
+			const __m256 x = _mm256_loadu_ps(centerX + i);
+			const __m256 y = _mm256_loadu_ps(centerY + i);
+			const __m256 z = _mm256_loadu_ps(centerZ + i);
+			const __m256 r = _mm256_loadu_ps(radius + i);
+			__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+				const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, nx[p]), _mm256_mul_ps(y, ny[p])), _mm256_mul_ps(z, nz[p]));
+				const __m256 dist = _mm256_sub_ps(zero, _mm256_add_ps(dot, nd[p]));
+				mask = _mm256_andnot_ps(_mm256_cmp_ps(dist, r, _CMP_GT_OQ), mask);
+			}
+			count += setVisibleBits(visible, i, (uint32_t)_mm256_movemask_ps(mask));
+		}
+	}
+#endif
+#if FRUSTUM_SSE
+	{
+		__m128 nx[FRUSTUM_PLANES_MAX], ny[FRUSTUM_PLANES_MAX], nz[FRUSTUM_PLANES_MAX], nd[FRUSTUM_PLANES_MAX];
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			nx[p] = _mm_set1_ps(_planes[p].norm().x);
+			ny[p] = _mm_set1_ps(_planes[p].norm().y);
+			nz[p] = _mm_set1_ps(_planes[p].norm().z);
+			nd[p] = _mm_set1_ps(_planes[p].dist());
+		}
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= amount; i += 4) {
+			const __m128 x = _mm_loadu_ps(centerX + i);
+			const __m128 y = _mm_loadu_ps(centerY + i);
+			const __m128 z = _mm_loadu_ps(centerZ + i);
+			const __m128 r = _mm_loadu_ps(radius + i);
+			__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+				const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, nx[p]), _mm_mul_ps(y, ny[p])), _mm_mul_ps(z, nz[p]));
+				const __m128 dist = _mm_sub_ps(zero, _mm_add_ps(dot, nd[p]));
+				mask = _mm_andnot_ps(_mm_cmpgt_ps(dist, r), mask);
+			}
+			count += setVisibleBits(visible, i, (uint32_t)_mm_movemask_ps(mask));
+		}
+	}
+#endif
+	for (; i < amount; ++i) {
+		if (isVisible(glm::vec3(centerX[i], centerY[i], centerZ[i]), radius[i])) {
+			count += setVisibleBits(visible, i, 1u);
+		}
+	}
+	return count;
+}
+
 FrustumResult Frustum::test(const glm::vec3& mins, const glm::vec3& maxs) const {
 	core_trace_scoped(FrustumTest);
 	FrustumResult result = FrustumResult::Inside;
@@ -58,6 +58,33 @@ public:
 
 	bool isVisible(const glm::vec3& center, float radius) const;
 
+	/**
+	 * @brief Tests a batch of boxes that are given as structure of arrays against the frustum planes
+	 * @param[out] visible Bitmask with one bit per box - needs @c (amount + 31) / 32 entries. Bit @c i%32 of
+	 * entry @c i/32 is set if the box @c i is visible.
+	 * @param margin Boxes that are at most this far outside of the frustum are still visible
+	 * @return The amount of visible boxes
+	 * @note Gives the same results as @c isVisible(mins, maxs) for each box - but tests several boxes at once
+	 * with SSE or AVX if available.
+	 */
+	int isVisible(const float* minsX, const float* minsY, const float* minsZ,
+			const float* maxsX, const float* maxsY, const float* maxsZ,
+			int amount, uint32_t* visible, float margin = 0.0f) const;
+
+	/**
+	 * @brief Tests a batch of boxes against the frustum planes
+	 * @sa isVisible(const float*, const float*, const float*, const float*, const float*, const float*, int, uint32_t*, float)
+	 */
+	int isVisible(const AABB<float>* aabbs, int amount, uint32_t* visible, float margin = 0.0f) const;
+
+	/**
+	 * @brief Tests a batch of spheres that are given as structure of arrays against the frustum planes
+	 * @note Gives the same results as @c isVisible(center, radius) for each sphere
+	 * @sa isVisible(const float*, const float*, const float*, const float*, const float*, const float*, int, uint32_t*, float)
+	 */
+	int isVisible(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+			int amount, uint32_t* visible) const;
+
 	void split(const glm::mat4& transform, glm::vec3 out[FRUSTUM_VERTICES_MAX]) const;
 
 	void updateVertices(const glm::mat4& view, const glm::mat4& projection);
@@ -0,0 +1,448 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include "Frustum.h"
+#include "Morton.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+namespace math {
+
+/**
+ * @brief Octree that keeps its items in one array that is sorted by the morton code of the item centers
+ *
+ * The nodes are stored in depth first order in another flat array. Each node knows the range of items of its
+ * subtree and the index of the node that follows its subtree - the traversal doesn't need a stack and doesn't
+ * allocate memory.
+ *
+ * Items that are inserted after a rebuild are kept in a pending list that is checked linearly, removed items are
+ * only marked. If there are too many of them, the tree is rebuilt on the next insert or remove.
+ *
+ * The frustum queries test the nodes of one level and the items of the leaves in batches with the
+ * SIMD version of @c Frustum::isVisible() - the bounds of the items are kept as structure of arrays for this.
+ *
+ * @note Given NODE type must implement @c aabb() and return math::AABB<TYPE> and must be comparable with @c ==
+ * @sa Octree
+ */
+template<class NODE, typename TYPE = int>
+class LinearOctree {
+public:
+	typedef typename std::vector<NODE> Contents;
+
+	static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type* item) {
+		return item->aabb();
+	}
+
+	static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type& item) {
+		return item.aabb();
+	}
+
+private:
+	struct Entry {
+		NODE item;
+		glm::vec3 mins;
+		glm::vec3 maxs;
+		uint64_t code = 0u;
+		bool removed = false;
+
+		Entry(const NODE& _item, const AABB<TYPE>& area) :
+				item(_item), mins(area.mins()), maxs(area.maxs()) {
+		}
+	};
+
+	struct Node {
+		/** the bounds of all items in the subtree - not the cell of the morton code */
+		glm::vec3 mins;
+		glm::vec3 maxs;
+		uint32_t first;
+		uint32_t count;
+		/** the index of the node that follows the subtree of this node */
+		uint32_t skip;
+	};
+
+	/** the amount of nodes that are tested against a frustum at once */
+	static constexpr uint32_t FrustumBatchSize = 32u;
+
+	const AABB<TYPE> _aabb;
+	const uint32_t _leafSize;
+	std::vector<Entry> _entries;
+	/** the bounds of the entries as structure of arrays - mins x, y, z and maxs x, y, z */
+	std::vector<float> _bounds[6];
+	std::vector<Entry> _pending;
+	std::vector<Node> _nodes;
+	uint32_t _removed = 0u;
+	// dirty flag can be used for query caches
+	bool _dirty = false;
+
+	static inline bool intersects(const glm::vec3& amins, const glm::vec3& amaxs, const glm::vec3& bmins, const glm::vec3& bmaxs) {
+		return amaxs.x >= bmins.x && amins.x <= bmaxs.x && amaxs.y >= bmins.y && amins.y <= bmaxs.y
+				&& amaxs.z >= bmins.z && amins.z <= bmaxs.z;
+	}
+
+	static inline bool contains(const glm::vec3& outerMins, const glm::vec3& outerMaxs, const glm::vec3& mins, const glm::vec3& maxs) {
+		return glm::all(glm::lessThanEqual(outerMins, mins)) && glm::all(glm::lessThanEqual(maxs, outerMaxs));
+	}
+
+	static inline uint64_t interleave(uint32_t x, uint32_t y, uint32_t z) {
+		return (uint64_t)(morton256_x[x & 0xFF] | morton256_y[y & 0xFF] | morton256_z[z & 0xFF]);
+	}
+
+	/**
+	 * @return The 48 bit morton code of the item center - 16 bits per axis relative to the octree bounds
+	 */
+	uint64_t mortonCode(const Entry& entry) const {
+		const glm::vec3 rootMins(_aabb.mins());
+		const glm::vec3 rootSize(glm::max(glm::vec3(_aabb.getWidth()), glm::vec3(1.0f)));
+		const glm::vec3 center = (entry.mins + entry.maxs) * 0.5f;
+		const glm::vec3 normalized = glm::clamp((center - rootMins) / rootSize, 0.0f, 1.0f);
+		const glm::uvec3 cell(normalized * 65535.0f);
+		return (interleave(cell.x >> 8, cell.y >> 8, cell.z >> 8) << 24) | interleave(cell.x, cell.y, cell.z);
+	}
+
+	uint32_t build(uint32_t first, uint32_t last) {
+		const uint32_t index = (uint32_t)_nodes.size();
+		_nodes.push_back(Node());
+		const uint32_t count = last - first;
+		glm::vec3 mins;
+		glm::vec3 maxs;
+		if (count <= _leafSize) {
+			mins = _entries[first].mins;
+			maxs = _entries[first].maxs;
+			for (uint32_t i = first + 1; i < last; ++i) {
+				mins = glm::min(mins, _entries[i].mins);
+				maxs = glm::max(maxs, _entries[i].maxs);
+			}
+		} else {
+			// split at the highest bit that differs in the range - or in the middle if all codes are equal
+			const uint64_t firstCode = _entries[first].code;
+			const uint64_t diff = firstCode ^ _entries[last - 1].code;
+			uint32_t split = first + count / 2;
+			if (diff != 0u) {
+				uint64_t bit = 1u;
+				while ((diff >> 1) >= bit) {
+					bit <<= 1;
+				}
+				const uint64_t prefix = firstCode & ~(bit - 1u);
+				const auto iter = std::lower_bound(_entries.begin() + first, _entries.begin() + last, prefix | bit,
+						[] (const Entry& entry, uint64_t code) { return entry.code < code; });
+				split = (uint32_t)(iter - _entries.begin());
+			}
+			const uint32_t left = build(first, split);
+			const uint32_t right = build(split, last);
+			mins = glm::min(_nodes[left].mins, _nodes[right].mins);
+			maxs = glm::max(_nodes[left].maxs, _nodes[right].maxs);
+		}
+		Node& node = _nodes[index];
+		node.mins = mins;
+		node.maxs = maxs;
+		node.first = first;
+		node.count = count;
+		node.skip = (uint32_t)_nodes.size();
+		return index;
+	}
+
+	void rebuildIfNeeded() {
+		const uint32_t changes = (uint32_t)_pending.size() + _removed;
+		if (changes > (std::max)(64u, (uint32_t)_entries.size() / 4u)) {
+			rebuild();
+		}
+	}
+
+	bool removeFromTree(const NODE& item, const glm::vec3& mins, const glm::vec3& maxs) {
+		const uint32_t nodes = (uint32_t)_nodes.size();
+		uint32_t i = 0u;
+		while (i < nodes) {
+			const Node& node = _nodes[i];
+			if (!contains(node.mins, node.maxs, mins, maxs)) {
+				i = node.skip;
+				continue;
+			}
+			if (node.skip != i + 1) {
+				++i;
+				continue;
+			}
+			for (uint32_t e = node.first; e < node.first + node.count; ++e) {
+				Entry& entry = _entries[e];
+				if (!entry.removed && entry.item == item) {
+					entry.removed = true;
+					++_removed;
+					return true;
+				}
+			}
+			i = node.skip;
+		}
+		return false;
+	}
+
+	template<class VISITOR>
+	inline void visitRange(uint32_t first, uint32_t count, VISITOR& visitor) const {
+		for (uint32_t e = first; e < first + count; ++e) {
+			const Entry& entry = _entries[e];
+			if (!entry.removed) {
+				visitor(entry.item);
+			}
+		}
+	}
+
+	/**
+	 * @brief Tests the entries of a leaf in batches of 32 against the frustum
+	 */
+	template<class VISITOR>
+	void visitEntries(const Frustum& area, uint32_t first, uint32_t count, float margin, VISITOR& visitor) const {
+		for (uint32_t offset = first; offset < first + count; offset += 32u) {
+			const int n = (int)(std::min)(32u, first + count - offset);
+			uint32_t visible;
+			if (area.isVisible(_bounds[0].data() + offset, _bounds[1].data() + offset, _bounds[2].data() + offset,
+					_bounds[3].data() + offset, _bounds[4].data() + offset, _bounds[5].data() + offset, n, &visible, margin) == 0) {
+				continue;
+			}
+			for (int i = 0; i < n; ++i) {
+				const Entry& entry = _entries[offset + i];
+				if ((visible & (1u << i)) && !entry.removed) {
+					visitor(entry.item);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Tests the given nodes in one batch against the frustum - the children of the visible inner nodes are
+	 * collected and tested in the next batch
+	 */
+	template<class VISITOR>
+	void visitNodes(const Frustum& area, const uint32_t* nodes, uint32_t amount, float margin, VISITOR& visitor) const {
+		float bounds[6][FrustumBatchSize];
+		for (uint32_t i = 0u; i < amount; ++i) {
+			const Node& node = _nodes[nodes[i]];
+			for (int axis = 0; axis < 3; ++axis) {
+				bounds[axis][i] = node.mins[axis];
+				bounds[axis + 3][i] = node.maxs[axis];
+			}
+		}
+		uint32_t visible;
+		if (area.isVisible(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5], (int)amount, &visible, margin) == 0) {
+			return;
+		}
+		uint32_t children[FrustumBatchSize];
+		uint32_t childCount = 0u;
+		for (uint32_t i = 0u; i < amount; ++i) {
+			if (!(visible & (1u << i))) {
+				continue;
+			}
+			const uint32_t index = nodes[i];
+			const Node& node = _nodes[index];
+			if (node.skip == index + 1) {
+				visitEntries(area, node.first, node.count, margin, visitor);
+				continue;
+			}
+			if (childCount + 2u > FrustumBatchSize) {
+				visitNodes(area, children, childCount, margin, visitor);
+				childCount = 0u;
+			}
+			// the left child follows its parent, the right child follows the subtree of the left child
+			children[childCount++] = index + 1;
+			children[childCount++] = _nodes[index + 1].skip;
+		}
+		if (childCount > 0u) {
+			visitNodes(area, children, childCount, margin, visitor);
+		}
+	}
+
+public:
+	/**
+	 * @param leafSize The max amount of items in a leaf node
+	 */
+	LinearOctree(const AABB<TYPE>& aabb, int leafSize = 8) :
+			_aabb(aabb), _leafSize((uint32_t)(std::max)(1, leafSize)) {
+	}
+
+	inline int count() const {
+		return (int)(_entries.size() + _pending.size() - _removed);
+	}
+
+	inline const AABB<TYPE>& aabb() const {
+		return _aabb;
+	}
+
+	inline bool insert(const NODE& item) {
+		core_trace_scoped(LinearOctreeInsert);
+		const AABB<TYPE>& area = aabb(item);
+		if (!_aabb.containsAABB(area)) {
+			return false;
+		}
+		_pending.emplace_back(item, area);
+		_dirty = true;
+		rebuildIfNeeded();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts all the given items and rebuilds the tree once
+	 * @return The amount of items that were inserted - items that are not inside the octree bounds are skipped
+	 */
+	template<class ITER>
+	int insert(ITER begin, ITER end) {
+		core_trace_scoped(LinearOctreeInsertBulk);
+		int inserted = 0;
+		for (ITER i = begin; i != end; ++i) {
+			const AABB<TYPE>& area = aabb(*i);
+			if (!_aabb.containsAABB(area)) {
+				continue;
+			}
+			_pending.emplace_back(*i, area);
+			++inserted;
+		}
+		if (inserted > 0) {
+			_dirty = true;
+			rebuild();
+		}
+		return inserted;
+	}
+
+	bool remove(const NODE& item) {
+		core_trace_scoped(LinearOctreeRemove);
+		const AABB<TYPE>& area = aabb(item);
+		const glm::vec3 mins(area.mins());
+		const glm::vec3 maxs(area.maxs());
+		if (removeFromTree(item, mins, maxs)) {
+			_dirty = true;
+			rebuildIfNeeded();
+			return true;
+		}
+		for (auto i = _pending.begin(); i != _pending.end(); ++i) {
+			if (i->item == item) {
+				*i = _pending.back();
+				_pending.pop_back();
+				_dirty = true;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Sorts all items by their morton code and creates the nodes
+	 */
+	void rebuild() {
+		core_trace_scoped(LinearOctreeRebuild);
+		if (_removed > 0u) {
+			_entries.erase(std::remove_if(_entries.begin(), _entries.end(), [] (const Entry& entry) { return entry.removed; }), _entries.end());
+			_removed = 0u;
+		}
+		_entries.insert(_entries.end(), _pending.begin(), _pending.end());
+		_pending.clear();
+		for (Entry& entry : _entries) {
+			entry.code = mortonCode(entry);
+		}
+		std::sort(_entries.begin(), _entries.end(), [] (const Entry& a, const Entry& b) { return a.code < b.code; });
+		for (int b = 0; b < 6; ++b) {
+			_bounds[b].resize(_entries.size());
+		}
+		for (size_t i = 0; i < _entries.size(); ++i) {
+			const Entry& entry = _entries[i];
+			for (int axis = 0; axis < 3; ++axis) {
+				_bounds[axis][i] = entry.mins[axis];
+				_bounds[axis + 3][i] = entry.maxs[axis];
+			}
+		}
+		_nodes.clear();
+		if (!_entries.empty()) {
+			_nodes.reserve(2 * _entries.size() / _leafSize + 1);
+			build(0u, (uint32_t)_entries.size());
+		}
+	}
+
+	void clear() {
+		_entries.clear();
+		for (int b = 0; b < 6; ++b) {
+			_bounds[b].clear();
+		}
+		_pending.clear();
+		_nodes.clear();
+		_removed = 0u;
+		_dirty = true;
+	}
+
+	/**
+	 * @brief Calls the visitor with each item that intersects the given area
+	 */
+	template<class VISITOR>
+	void visit(const AABB<TYPE>& area, VISITOR&& visitor) const {
+		core_trace_scoped(LinearOctreeVisitAABB);
+		const glm::vec3 mins(area.mins());
+		const glm::vec3 maxs(area.maxs());
+		const uint32_t nodes = (uint32_t)_nodes.size();
+		uint32_t i = 0u;
+		while (i < nodes) {
+			const Node& node = _nodes[i];
+			if (!intersects(node.mins, node.maxs, mins, maxs)) {
+				i = node.skip;
+			} else if (contains(mins, maxs, node.mins, node.maxs)) {
+				// the whole subtree is part of the query
+				visitRange(node.first, node.count, visitor);
+				i = node.skip;
+			} else if (node.skip == i + 1) {
+				for (uint32_t e = node.first; e < node.first + node.count; ++e) {
+					const Entry& entry = _entries[e];
+					if (!entry.removed && intersects(entry.mins, entry.maxs, mins, maxs)) {
+						visitor(entry.item);
+					}
+				}
+				i = node.skip;
+			} else {
+				++i;
+			}
+		}
+		for (const Entry& entry : _pending) {
+			if (intersects(entry.mins, entry.maxs, mins, maxs)) {
+				visitor(entry.item);
+			}
+		}
+	}
+
+	/**
+	 * @brief Calls the visitor with each item that is visible in the given frustum
+	 * @param margin Items that are at most this far outside of the frustum are still visible
+	 */
+	template<class VISITOR>
+	void visit(const Frustum& area, VISITOR&& visitor, float margin = 0.0f) const {
+		core_trace_scoped(LinearOctreeVisitFrustum);
+		if (!_nodes.empty()) {
+			const uint32_t root = 0u;
+			visitNodes(area, &root, 1u, margin, visitor);
+		}
+		uint32_t visible;
+		for (const Entry& entry : _pending) {
+			if (area.isVisible(&entry.mins.x, &entry.mins.y, &entry.mins.z, &entry.maxs.x, &entry.maxs.y, &entry.maxs.z, 1, &visible, margin) > 0) {
+				visitor(entry.item);
+			}
+		}
+	}
+
+	inline void query(const AABB<TYPE>& area, Contents& results) const {
+		visit(area, [&results] (const NODE& item) { results.push_back(item); });
+	}
+
+	inline void query(const Frustum& area, Contents& results) const {
+		visit(area, [&results] (const NODE& item) { results.push_back(item); });
+	}
+
+	inline void markAsClean() {
+		_dirty = false;
+	}
+
+	inline bool isDirty() const {
+		return _dirty;
+	}
+};
+
+}
@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/AABB.h"
+#include "math/Frustum.h"
+#include "math/Random.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+class FrustumBenchmark : public app::AbstractBenchmark {
+protected:
+	math::Frustum _frustum;
+	std::vector<math::AABB<float>> _aabbs;
+	/** mins x, y, z and maxs x, y, z */
+	std::vector<float> _bounds[6];
+	std::vector<float> _radius;
+	std::vector<uint32_t> _mask;
+
+public:
+	void SetUp(::benchmark::State& state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int amount = (int)state.range(0);
+		const glm::mat4& view = glm::lookAt(glm::vec3(0.0f, 50.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4& projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		_frustum.update(view, projection);
+
+		// about a third of the boxes is visible
+		math::Random random(1);
+		_aabbs.clear();
+		_radius.clear();
+		for (int b = 0; b < 6; ++b) {
+			_bounds[b].clear();
+		}
+		for (int i = 0; i < amount; ++i) {
+			const glm::vec3 mins(random.random(-1000, 1000), random.random(0, 100), random.random(-1000, 1000));
+			const glm::vec3 maxs = mins + glm::vec3(random.random(1, 32));
+			_aabbs.emplace_back(mins, maxs);
+			for (int axis = 0; axis < 3; ++axis) {
+				_bounds[axis].push_back(mins[axis]);
+				_bounds[axis + 3].push_back(maxs[axis]);
+			}
+			_radius.push_back((maxs.x - mins.x) * 0.5f);
+		}
+		_mask.resize((amount + 31) / 32);
+	}
+};
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, AABBScalar)(benchmark::State& state) {
+	for (auto _ : state) {
+		int visible = 0;
+		for (const math::AABB<float>& aabb : _aabbs) {
+			if (_frustum.isVisible(aabb.getLowerCorner(), aabb.getUpperCorner())) {
+				++visible;
+			}
+		}
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, AABBBatch)(benchmark::State& state) {
+	for (auto _ : state) {
+		const int visible = _frustum.isVisible(_bounds[0].data(), _bounds[1].data(), _bounds[2].data(), _bounds[3].data(),
+				_bounds[4].data(), _bounds[5].data(), (int)_aabbs.size(), _mask.data());
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, AABBBatchPacked)(benchmark::State& state) {
+	for (auto _ : state) {
+		const int visible = _frustum.isVisible(_aabbs.data(), (int)_aabbs.size(), _mask.data());
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, SphereScalar)(benchmark::State& state) {
+	for (auto _ : state) {
+		int visible = 0;
+		for (size_t i = 0; i < _radius.size(); ++i) {
+			if (_frustum.isVisible(glm::vec3(_bounds[0][i], _bounds[1][i], _bounds[2][i]), _radius[i])) {
+				++visible;
+			}
+		}
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, SphereBatch)(benchmark::State& state) {
+	for (auto _ : state) {
+		const int visible = _frustum.isVisible(_bounds[0].data(), _bounds[1].data(), _bounds[2].data(), _radius.data(),
+				(int)_radius.size(), _mask.data());
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(FrustumBenchmark, AABBScalar)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_REGISTER_F(FrustumBenchmark, AABBBatch)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_REGISTER_F(FrustumBenchmark, AABBBatchPacked)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_REGISTER_F(FrustumBenchmark, SphereScalar)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_REGISTER_F(FrustumBenchmark, SphereBatch)->Arg(1000)->Arg(10000)->Arg(100000);
@@ -0,0 +1,151 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/LinearOctree.h"
+#include "math/Octree.h"
+#include "math/Random.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/trigonometric.hpp>
+#include <vector>
+
+namespace {
+
+constexpr int WorldSize = 4096;
+constexpr int WorldHeight = 256;
+constexpr int ChunkSize = 32;
+constexpr int Items = 20000;
+constexpr int Poses = 64;
+
+class Item {
+private:
+	math::AABB<int> _bounds;
+	int _id;
+public:
+	Item(const math::AABB<int>& bounds, int id) :
+			_bounds(bounds), _id(id) {
+	}
+
+	const math::AABB<int>& aabb() const {
+		return _bounds;
+	}
+
+	bool operator==(const Item& rhs) const {
+		return rhs._id == _id;
+	}
+};
+
+}
+
+class OctreeBenchmark : public app::AbstractBenchmark {
+protected:
+	const math::AABB<int> _bounds { 0, 0, 0, WorldSize, WorldHeight, WorldSize };
+	std::vector<Item> _items;
+	std::vector<math::AABB<int>> _areas;
+	std::vector<math::Frustum> _frustums;
+
+public:
+	void SetUp(::benchmark::State& state) override {
+		app::AbstractBenchmark::SetUp(state);
+		// chunk sized items like the world renderer is using them
+		math::Random random(1);
+		_items.clear();
+		_items.reserve(Items);
+		for (int i = 0; i < Items; ++i) {
+			const glm::ivec3 mins(random.random(0, WorldSize / ChunkSize - 1) * ChunkSize,
+					random.random(0, WorldHeight / ChunkSize - 1) * ChunkSize,
+					random.random(0, WorldSize / ChunkSize - 1) * ChunkSize);
+			_items.emplace_back(math::AABB<int>(mins, mins + ChunkSize), i);
+		}
+
+		_areas.clear();
+		_frustums.clear();
+		const glm::mat4& projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		const float center = WorldSize * 0.5f;
+		for (int i = 0; i < Poses; ++i) {
+			const float angle = glm::two_pi<float>() * (float)i / (float)Poses;
+			const glm::vec3 eye(center + glm::cos(angle) * center * 0.6f, 100.0f, center + glm::sin(angle) * center * 0.6f);
+			const glm::ivec3 mins(eye.x - 256, 0, eye.z - 256);
+			_areas.emplace_back(mins, mins + glm::ivec3(512, WorldHeight, 512));
+			math::Frustum frustum;
+			frustum.update(glm::lookAt(eye, eye + glm::vec3(-glm::sin(angle), -0.1f, glm::cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f)), projection);
+			_frustums.push_back(frustum);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, OctreeInsert)(benchmark::State& state) {
+	for (auto _ : state) {
+		math::Octree<Item> octree(_bounds);
+		for (const Item& item : _items) {
+			octree.insert(item);
+		}
+		benchmark::DoNotOptimize(octree.count());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, LinearOctreeInsert)(benchmark::State& state) {
+	for (auto _ : state) {
+		math::LinearOctree<Item> octree(_bounds);
+		octree.insert(_items.begin(), _items.end());
+		benchmark::DoNotOptimize(octree.count());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, OctreeQueryAABB)(benchmark::State& state) {
+	math::Octree<Item> octree(_bounds);
+	for (const Item& item : _items) {
+		octree.insert(item);
+	}
+	size_t n = 0;
+	for (auto _ : state) {
+		math::Octree<Item>::Contents contents;
+		octree.query(_areas[n++ % _areas.size()], contents);
+		benchmark::DoNotOptimize(contents.size());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, LinearOctreeQueryAABB)(benchmark::State& state) {
+	math::LinearOctree<Item> octree(_bounds);
+	octree.insert(_items.begin(), _items.end());
+	size_t n = 0;
+	for (auto _ : state) {
+		int found = 0;
+		octree.visit(_areas[n++ % _areas.size()], [&found] (const Item&) { ++found; });
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, OctreeQueryFrustum)(benchmark::State& state) {
+	math::Octree<Item> octree(_bounds);
+	for (const Item& item : _items) {
+		octree.insert(item);
+	}
+	size_t n = 0;
+	for (auto _ : state) {
+		math::Octree<Item>::Contents contents;
+		octree.query(_frustums[n++ % _frustums.size()], contents);
+		benchmark::DoNotOptimize(contents.size());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, LinearOctreeQueryFrustum)(benchmark::State& state) {
+	math::LinearOctree<Item> octree(_bounds);
+	octree.insert(_items.begin(), _items.end());
+	size_t n = 0;
+	for (auto _ : state) {
+		int found = 0;
+		octree.visit(_frustums[n++ % _frustums.size()], [&found] (const Item&) { ++found; });
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+BENCHMARK_REGISTER_F(OctreeBenchmark, OctreeInsert);
+BENCHMARK_REGISTER_F(OctreeBenchmark, LinearOctreeInsert);
+BENCHMARK_REGISTER_F(OctreeBenchmark, OctreeQueryAABB);
+BENCHMARK_REGISTER_F(OctreeBenchmark, LinearOctreeQueryAABB);
+BENCHMARK_REGISTER_F(OctreeBenchmark, OctreeQueryFrustum);
+BENCHMARK_REGISTER_F(OctreeBenchmark, LinearOctreeQueryFrustum);
+
+BENCHMARK_MAIN();
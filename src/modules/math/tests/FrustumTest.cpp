@@ -7,6 +7,8 @@
 #include "core/GLM.h"
 #include "core/StringUtil.h"
 #include "math/AABB.h"
+#include "math/Random.h"
+#include <vector>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace math {
@@ -46,6 +48,25 @@ public:
 		_frustum.update(_view, projection);
 		_aabb = _frustum.aabb();
 	}
+
+	static bool isBitSet(const std::vector<uint32_t>& mask, int i) {
+		return (mask[i >> 5] & (1u << (i & 31))) != 0u;
+	}
+
+	/**
+	 * @brief Random boxes and spheres around the frustum - the amount is no multiple of the simd width
+	 */
+	void fillRandom(int amount, std::vector<float> (&bounds)[6]) const {
+		math::Random random(1337);
+		for (int i = 0; i < amount; ++i) {
+			const glm::vec3 mins(random.random(-100, 600), random.random(-300, 300), random.random(-300, 300));
+			const glm::vec3 size(random.random(0, 40), random.random(0, 40), random.random(0, 40));
+			for (int axis = 0; axis < 3; ++axis) {
+				bounds[axis].push_back(mins[axis]);
+				bounds[axis + 3].push_back(mins[axis] + size[axis]);
+			}
+		}
+	}
 };
 
 TEST_F(FrustumTest, testAABBOrtho) {
@@ -160,4 +181,69 @@ TEST_F(FrustumTest, testOrthoFrustum) {
 	EXPECT_FALSE(frustum.isVisible(glm::ivec3(-66, -32, 64), glm::ivec3(-65, 0, 96)));
 }
 
+TEST_F(FrustumTest, testBatchAABB) {
+	const int amount = 1003;
+	std::vector<float> bounds[6];
+	fillRandom(amount, bounds);
+	std::vector<uint32_t> mask((amount + 31) / 32, 0xFFFFFFFFu);
+	const int visible = _frustum.isVisible(bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(),
+			bounds[4].data(), bounds[5].data(), amount, mask.data());
+	int expectedVisible = 0;
+	std::vector<AABB<float>> aabbs;
+	for (int i = 0; i < amount; ++i) {
+		const glm::vec3 mins(bounds[0][i], bounds[1][i], bounds[2][i]);
+		const glm::vec3 maxs(bounds[3][i], bounds[4][i], bounds[5][i]);
+		aabbs.emplace_back(mins, maxs);
+		const bool expected = _frustum.isVisible(mins, maxs);
+		ASSERT_EQ(expected, isBitSet(mask, i)) << "box " << i;
+		if (expected) {
+			++expectedVisible;
+		}
+	}
+	EXPECT_EQ(expectedVisible, visible);
+	EXPECT_GT(visible, 0);
+	EXPECT_LT(visible, amount);
+
+	std::vector<uint32_t> packedMask((amount + 31) / 32);
+	EXPECT_EQ(visible, _frustum.isVisible(aabbs.data(), amount, packedMask.data()));
+	EXPECT_EQ(mask, packedMask);
+}
+
+TEST_F(FrustumTest, testBatchAABBMargin) {
+	// right behind the eye - only visible with a margin
+	const float minsX[] = {-3.0f};
+	const float minsY[] = {-1.0f};
+	const float minsZ[] = {-1.0f};
+	const float maxsX[] = {-2.0f};
+	const float maxsY[] = {1.0f};
+	const float maxsZ[] = {1.0f};
+	uint32_t mask = 0u;
+	EXPECT_EQ(0, _frustum.isVisible(minsX, minsY, minsZ, maxsX, maxsY, maxsZ, 1, &mask));
+	EXPECT_EQ(0u, mask);
+	EXPECT_EQ(1, _frustum.isVisible(minsX, minsY, minsZ, maxsX, maxsY, maxsZ, 1, &mask, 5.0f));
+	EXPECT_EQ(1u, mask);
+}
+
+TEST_F(FrustumTest, testBatchSphere) {
+	const int amount = 517;
+	std::vector<float> bounds[6];
+	fillRandom(amount, bounds);
+	std::vector<float> radius;
+	for (int i = 0; i < amount; ++i) {
+		radius.push_back(bounds[3][i] - bounds[0][i]);
+	}
+	std::vector<uint32_t> mask((amount + 31) / 32);
+	const int visible = _frustum.isVisible(bounds[0].data(), bounds[1].data(), bounds[2].data(), radius.data(), amount, mask.data());
+	int expectedVisible = 0;
+	for (int i = 0; i < amount; ++i) {
+		const bool expected = _frustum.isVisible(glm::vec3(bounds[0][i], bounds[1][i], bounds[2][i]), radius[i]);
+		ASSERT_EQ(expected, isBitSet(mask, i)) << "sphere " << i;
+		if (expected) {
+			++expectedVisible;
+		}
+	}
+	EXPECT_EQ(expectedVisible, visible);
+	EXPECT_GT(visible, 0);
+}
+
 }
@@ -0,0 +1,219 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "math/LinearOctree.h"
+#include "math/Octree.h"
+#include "math/Random.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+
+namespace math {
+
+namespace loc {
+class Item {
+private:
+	AABB<int> _bounds;
+	int _id;
+public:
+	Item(const AABB<int>& bounds, int id) :
+			_bounds(bounds), _id(id) {
+	}
+
+	const AABB<int>& aabb() const {
+		return _bounds;
+	}
+
+	int id() const {
+		return _id;
+	}
+
+	bool operator==(const Item& rhs) const {
+		return rhs._id == _id;
+	}
+};
+}
+
+class LinearOctreeTest : public app::AbstractTest {
+protected:
+	std::vector<loc::Item> createItems(int amount) const {
+		math::Random random(42);
+		std::vector<loc::Item> items;
+		items.reserve(amount);
+		for (int i = 0; i < amount; ++i) {
+			const glm::ivec3 mins(random.random(0, 1000), random.random(0, 200), random.random(0, 1000));
+			const glm::ivec3 size(random.random(1, 20), random.random(1, 20), random.random(1, 20));
+			items.emplace_back(AABB<int>(mins, mins + size), i);
+		}
+		return items;
+	}
+
+	template<class CONTENTS>
+	std::vector<int> ids(const CONTENTS& contents) const {
+		std::vector<int> result;
+		for (const loc::Item& item : contents) {
+			result.push_back(item.id());
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+};
+
+TEST_F(LinearOctreeTest, testAddRemove) {
+	LinearOctree<loc::Item> octree({0, 0, 0, 100, 100, 100});
+	EXPECT_EQ(0, octree.count());
+	EXPECT_TRUE(octree.insert({{51, 51, 51, 53, 53, 53}, 1}));
+	EXPECT_TRUE(octree.insert({{15, 15, 15, 18, 18, 18}, 2}));
+	EXPECT_FALSE(octree.insert({{-100, -100, -100, 200, 200, 200}, 3}));
+	EXPECT_EQ(2, octree.count());
+	EXPECT_TRUE(octree.isDirty());
+	octree.markAsClean();
+
+	// remove from the pending list
+	EXPECT_TRUE(octree.remove({{51, 51, 51, 53, 53, 53}, 1}));
+	EXPECT_FALSE(octree.remove({{51, 51, 51, 53, 53, 53}, 1}));
+	EXPECT_EQ(1, octree.count());
+	EXPECT_TRUE(octree.isDirty());
+
+	// remove from the tree
+	octree.rebuild();
+	EXPECT_TRUE(octree.remove({{15, 15, 15, 18, 18, 18}, 2}));
+	EXPECT_EQ(0, octree.count());
+	LinearOctree<loc::Item>::Contents contents;
+	octree.query(octree.aabb(), contents);
+	EXPECT_TRUE(contents.empty());
+}
+
+TEST_F(LinearOctreeTest, testQuery) {
+	LinearOctree<loc::Item> octree({0, 0, 0, 100, 100, 100});
+	loc::Item item1({51, 51, 51, 53, 53, 53}, 1);
+	EXPECT_TRUE(octree.insert(item1));
+	{
+		LinearOctree<loc::Item>::Contents contents;
+		octree.query(item1.aabb(), contents);
+		EXPECT_EQ(1u, contents.size());
+	}
+	octree.rebuild();
+	{
+		LinearOctree<loc::Item>::Contents contents;
+		octree.query({52, 52, 52, 54, 54, 54}, contents);
+		EXPECT_EQ(1u, contents.size()) << "Expected to find one entry for the overlapping aabb";
+	}
+	{
+		LinearOctree<loc::Item>::Contents contents;
+		octree.query({50, 50, 50, 52, 52, 52}, contents);
+		EXPECT_EQ(1u, contents.size()) << "Expected to find one entry for the overlapping aabb";
+	}
+	{
+		LinearOctree<loc::Item>::Contents contents;
+		octree.query({10, 10, 10, 20, 20, 20}, contents);
+		EXPECT_EQ(0u, contents.size());
+	}
+}
+
+TEST_F(LinearOctreeTest, testQueryMatchesOctree) {
+	const AABB<int> bounds(0, 0, 0, 1024, 256, 1024);
+	const std::vector<loc::Item>& items = createItems(5000);
+	Octree<loc::Item> octree(bounds);
+	LinearOctree<loc::Item> linear(bounds);
+	for (const loc::Item& item : items) {
+		ASSERT_TRUE(octree.insert(item));
+	}
+	ASSERT_EQ((int)items.size(), linear.insert(items.begin(), items.end()));
+	ASSERT_EQ(octree.count(), linear.count());
+
+	const AABB<int> areas[] = {
+		{0, 0, 0, 1024, 256, 1024},
+		{100, 0, 100, 300, 100, 200},
+		{500, 50, 500, 510, 60, 510},
+		{0, 0, 0, 1, 1, 1}
+	};
+	for (const AABB<int>& area : areas) {
+		Octree<loc::Item>::Contents expected;
+		octree.query(area, expected);
+		LinearOctree<loc::Item>::Contents actual;
+		linear.query(area, actual);
+		EXPECT_EQ(ids(expected), ids(actual));
+	}
+
+	const glm::mat4 view = glm::lookAt(glm::vec3(100.0f, 80.0f, 100.0f), glm::vec3(500.0f, 0.0f, 600.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 500.0f);
+	Frustum frustum;
+	frustum.update(view, projection);
+	Octree<loc::Item>::Contents expected;
+	octree.query(frustum, expected);
+	LinearOctree<loc::Item>::Contents actual;
+	linear.query(frustum, actual);
+	EXPECT_FALSE(actual.empty());
+	EXPECT_EQ(ids(expected), ids(actual));
+}
+
+TEST_F(LinearOctreeTest, testIncrementalUpdates) {
+	const AABB<int> bounds(0, 0, 0, 1024, 256, 1024);
+	const std::vector<loc::Item>& items = createItems(2000);
+	LinearOctree<loc::Item> linear(bounds);
+	linear.insert(items.begin(), items.begin() + 1000);
+	// these are pending and trigger rebuilds
+	for (size_t i = 1000; i < items.size(); ++i) {
+		ASSERT_TRUE(linear.insert(items[i]));
+	}
+	ASSERT_EQ((int)items.size(), linear.count());
+	for (size_t i = 0; i < items.size(); i += 2) {
+		ASSERT_TRUE(linear.remove(items[i])) << "item " << i;
+	}
+	ASSERT_EQ((int)items.size() / 2, linear.count());
+
+	std::vector<int> expected;
+	for (size_t i = 1; i < items.size(); i += 2) {
+		expected.push_back(items[i].id());
+	}
+	LinearOctree<loc::Item>::Contents actual;
+	linear.query(bounds, actual);
+	EXPECT_EQ(expected, ids(actual));
+
+	int visited = 0;
+	linear.visit(AABB<int>(0, 0, 0, 512, 256, 512), [&] (const loc::Item& item) {
+		EXPECT_EQ(1, item.id() % 2);
+		++visited;
+	});
+	EXPECT_GT(visited, 0);
+}
+
+TEST_F(LinearOctreeTest, testQueryFrustumMargin) {
+	const AABB<int> bounds(0, 0, 0, 1024, 256, 1024);
+	const std::vector<loc::Item>& items = createItems(3000);
+	LinearOctree<loc::Item> linear(bounds);
+	linear.insert(items.begin(), items.begin() + 2500);
+	// pending and removed entries are part of the query, too
+	for (size_t i = 2500; i < items.size(); ++i) {
+		ASSERT_TRUE(linear.insert(items[i]));
+	}
+	for (size_t i = 0; i < items.size(); i += 7) {
+		ASSERT_TRUE(linear.remove(items[i]));
+	}
+
+	const glm::mat4 view = glm::lookAt(glm::vec3(100.0f, 80.0f, 100.0f), glm::vec3(500.0f, 0.0f, 600.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 500.0f);
+	Frustum frustum;
+	frustum.update(view, projection);
+	const float margin = 10.0f;
+	std::vector<int> expected;
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (i % 7 == 0) {
+			continue;
+		}
+		const glm::vec3 mins(items[i].aabb().mins());
+		const glm::vec3 maxs(items[i].aabb().maxs());
+		uint32_t visible;
+		if (frustum.isVisible(&mins.x, &mins.y, &mins.z, &maxs.x, &maxs.y, &maxs.z, 1, &visible, margin) > 0) {
+			expected.push_back(items[i].id());
+		}
+	}
+	std::vector<loc::Item> actual;
+	linear.visit(frustum, [&] (const loc::Item& item) { actual.push_back(item); }, margin);
+	EXPECT_FALSE(actual.empty());
+	EXPECT_EQ(expected, ids(actual));
+}
+
+}
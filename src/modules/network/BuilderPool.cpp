@@ -0,0 +1,44 @@
+/**
+ * @file
+ */
+
+#include "BuilderPool.h"
+#include "core/collection/DynamicArray.h"
+
+namespace network {
+
+namespace {
+
+struct Pool {
+	core::DynamicArray<flatbuffers::FlatBufferBuilder*> builders;
+
+	~Pool() {
+		for (flatbuffers::FlatBufferBuilder* fbb : builders) {
+			delete fbb;
+		}
+	}
+};
+
+thread_local Pool pool;
+
+}
+
+flatbuffers::FlatBufferBuilder* BuilderPool::acquire() {
+	if (pool.builders.empty()) {
+		return new flatbuffers::FlatBufferBuilder();
+	}
+	flatbuffers::FlatBufferBuilder* fbb = pool.builders.back();
+	pool.builders.pop();
+	return fbb;
+}
+
+void BuilderPool::release(flatbuffers::FlatBufferBuilder* fbb) {
+	fbb->Clear();
+	pool.builders.push_back(fbb);
+}
+
+size_t BuilderPool::size() {
+	return pool.builders.size();
+}
+
+}
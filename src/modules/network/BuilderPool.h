@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "flatbuffers/flatbuffers.h"
+
+namespace network {
+
+/**
+ * @brief Thread local pool of @c flatbuffers::FlatBufferBuilder instances
+ *
+ * The builders keep their memory after they were released to the pool - building a message doesn't need
+ * to allocate once the builders have grown to the size of the messages.
+ *
+ * @sa PooledBuilder
+ */
+class BuilderPool {
+public:
+	/**
+	 * @return A cleared builder - must be given back with @c release() on the same thread
+	 */
+	static flatbuffers::FlatBufferBuilder* acquire();
+	static void release(flatbuffers::FlatBufferBuilder* fbb);
+	/**
+	 * @return The amount of idle builders in the pool of the calling thread
+	 */
+	static size_t size();
+};
+
+/**
+ * @brief Scoped access to a builder of the @c BuilderPool
+ */
+class PooledBuilder : public core::NonCopyable {
+private:
+	flatbuffers::FlatBufferBuilder* _fbb;
+public:
+	PooledBuilder() : _fbb(BuilderPool::acquire()) {
+	}
+
+	~PooledBuilder() {
+		BuilderPool::release(_fbb);
+	}
+
+	inline flatbuffers::FlatBufferBuilder& operator*() const {
+		return *_fbb;
+	}
+
+	inline flatbuffers::FlatBufferBuilder* operator->() const {
+		return _fbb;
+	}
+};
+
+}
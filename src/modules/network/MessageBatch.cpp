@@ -0,0 +1,30 @@
+/**
+ * @file
+ */
+
+#include "MessageBatch.h"
+#include "core/Assert.h"
+
+namespace network {
+
+void MessageBatch::add(const uint8_t* data, size_t size) {
+	static const uint8_t padding[8] {};
+	if (_buffer.empty()) {
+		_buffer.append(padding, HeaderSize);
+	}
+	const size_t frameStart = align(_buffer.size() + FrameHeaderSize) - FrameHeaderSize;
+	_buffer.append(padding, frameStart - _buffer.size());
+	const uint32_t messageSize = (uint32_t)size;
+	_buffer.append((const uint8_t*)&messageSize, sizeof(messageSize));
+	core_assert((_buffer.size() & 7u) == 0u);
+	_buffer.append(data, size);
+	++_count;
+	core_memcpy(_buffer.data(), &_count, sizeof(_count));
+}
+
+void MessageBatch::clear() {
+	_buffer.clear();
+	_count = 0u;
+}
+
+}
@@ -0,0 +1,129 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/Buffer.h"
+#include "core/StandardLib.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace network {
+
+/**
+ * @brief Coalesces several serialized messages into the payload of one packet
+ *
+ * The payload starts with the amount of messages (@c uint32_t). Every message is prefixed with its size
+ * (@c uint32_t) and padded, so that the message data of every frame starts 8 byte aligned - the flatbuffers
+ * can be read from the packet without copying them.
+ *
+ * The buffer is kept between the batches to not allocate memory for every packet.
+ *
+ * @sa unbatch()
+ */
+class MessageBatch {
+private:
+	core::Buffer<uint8_t, 1024u> _buffer;
+	uint32_t _count = 0u;
+
+	static constexpr size_t align(size_t size) {
+		return (size + 7u) & ~(size_t)7u;
+	}
+public:
+	static constexpr size_t HeaderSize = sizeof(uint32_t);
+	static constexpr size_t FrameHeaderSize = sizeof(uint32_t);
+
+	/**
+	 * @return The size in bytes that the batch would have after adding a message of the given size
+	 */
+	size_t sizeWith(size_t messageSize) const;
+
+	void add(const uint8_t* data, size_t size);
+	void clear();
+
+	/**
+	 * @return The amount of messages in the batch
+	 */
+	uint32_t count() const;
+	bool empty() const;
+
+	/**
+	 * @note Only valid if the batch is not empty
+	 */
+	const uint8_t* data() const;
+	size_t size() const;
+
+	/**
+	 * @brief Calls the given functor for every message of the batched payload
+	 *
+	 * The framing of the whole payload is validated before the first message is handed out. The messages
+	 * themselves are not validated - a message that the functor can't handle doesn't affect the other ones.
+	 *
+	 * @return @c false if the framing is malformed (count, size or alignment out of bounds) - no message is
+	 * handed out then
+	 */
+	template<class FUNC>
+	static bool unbatch(const uint8_t* data, size_t size, FUNC&& func);
+};
+
+inline size_t MessageBatch::sizeWith(size_t messageSize) const {
+	const size_t current = _buffer.empty() ? HeaderSize : _buffer.size();
+	// the frame header ends on a 8 byte boundary
+	return align(current + FrameHeaderSize) + messageSize;
+}
+
+inline uint32_t MessageBatch::count() const {
+	return _count;
+}
+
+inline bool MessageBatch::empty() const {
+	return _count == 0u;
+}
+
+inline const uint8_t* MessageBatch::data() const {
+	return _buffer.data();
+}
+
+inline size_t MessageBatch::size() const {
+	return _buffer.size();
+}
+
+template<class FUNC>
+bool MessageBatch::unbatch(const uint8_t* data, size_t size, FUNC&& func) {
+	if (size < HeaderSize) {
+		return false;
+	}
+	uint32_t count;
+	core_memcpy(&count, data, sizeof(count));
+	// every frame needs at least its header - don't trust the count of a malformed payload
+	if (count > (size - HeaderSize) / FrameHeaderSize) {
+		return false;
+	}
+	// validate the framing first, the frames are only walked a second time to hand out the messages
+	for (int pass = 0; pass < 2; ++pass) {
+		size_t offset = HeaderSize;
+		for (uint32_t i = 0u; i < count; ++i) {
+			offset = align(offset + FrameHeaderSize) - FrameHeaderSize;
+			if (offset + FrameHeaderSize > size) {
+				return false;
+			}
+			uint32_t messageSize;
+			core_memcpy(&messageSize, data + offset, sizeof(messageSize));
+			offset += FrameHeaderSize;
+			if (messageSize > size - offset) {
+				return false;
+			}
+			if (pass == 1) {
+				func(data + offset, (size_t)messageSize);
+			}
+			offset += messageSize;
+		}
+		if (offset != size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
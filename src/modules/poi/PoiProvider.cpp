@@ -7,7 +7,9 @@
 #include "math/Random.h"
 #include "core/Var.h"
 #include "core/GLM.h"
+#include "core/Assert.h"
 #include <glm/gtc/constants.hpp>
+#include <glm/geometric.hpp>
 
 namespace poi {
 
@@ -24,44 +26,175 @@ PoiProvider::PoiProvider(const core::TimeProviderPtr& timeProvider) :
 		_timeProvider(timeProvider), _lock("PoiProvider") {
 }
 
+void PoiProvider::remove(Grid& grid, const Ref& ref) {
+	auto i = grid.cells.find(ref.key);
+	core_assert(i != grid.cells.end());
+	if (i == grid.cells.end()) {
+		return;
+	}
+	Cell& cell = i->second;
+	for (size_t p = 0u; p < cell.pois.size(); ++p) {
+		if (cell.pois[p].id != ref.id) {
+			continue;
+		}
+		cell.pois[p] = cell.pois.back();
+		cell.pois.pop();
+		--grid.count;
+		--_count;
+		break;
+	}
+	if (!cell.pois.empty()) {
+		return;
+	}
+	const uint32_t keyIndex = cell.keyIndex;
+	const int64_t lastKey = grid.keys.back();
+	grid.keys[keyIndex] = lastKey;
+	grid.keys.pop();
+	if (lastKey != ref.key) {
+		grid.cells.find(lastKey)->second.keyIndex = keyIndex;
+	}
+	grid.cells.erase(i);
+}
+
 void PoiProvider::update(long /*dt*/) {
 	const uint64_t currentMillis = _timeProvider->tickNow();
 	core::ScopedWriteLock scoped(_lock);
-	// even if this is timed out - if we only have one, keep it.
-	while (_pois.size() > 1) {
-		Poi& poi = _pois.front();
-		const uint64_t runtime = (uint64_t)PoiSeconds[(int)poi.type] * (uint64_t)1000;
-		if (poi.time + runtime > currentMillis) {
-			break;
+	for (int i = 0; i < Types; ++i) {
+		std::deque<Bucket>& buckets = _buckets[i];
+		Grid& grid = _grids[i];
+		const uint64_t runtime = (uint64_t)PoiSeconds[i] * (uint64_t)1000;
+		while (!buckets.empty()) {
+			Bucket& bucket = buckets.front();
+			if (bucket.start + BucketMillis + runtime > currentMillis) {
+				break;
+			}
+			size_t expired = bucket.refs.size();
+			// even if this is timed out - if we only have one, keep it.
+			if (expired >= _count) {
+				expired = _count - 1u;
+			}
+			for (size_t r = 0u; r < expired; ++r) {
+				remove(grid, bucket.refs[r]);
+			}
+			if (expired < bucket.refs.size()) {
+				bucket.refs.erase(0, expired);
+				break;
+			}
+			buckets.pop_front();
 		}
-		_pois.pop_front();
 	}
 }
 
 void PoiProvider::add(const glm::vec3& pos, Type type) {
+	const uint64_t currentMillis = _timeProvider->tickNow();
+	const int64_t k = key(cell(pos.x), cell(pos.z));
 	core::ScopedWriteLock scoped(_lock);
-	_pois.emplace_back(Poi{pos, type, _timeProvider->tickNow()});
+	Grid& grid = _grids[(int)type];
+	auto i = grid.cells.find(k);
+	if (i == grid.cells.end()) {
+		i = grid.cells.emplace(k, Cell()).first;
+		i->second.keyIndex = (uint32_t)grid.keys.size();
+		grid.keys.push_back(k);
+	}
+	const uint32_t id = _nextId++;
+	i->second.pois.push_back(Poi{pos, currentMillis, id});
+	++grid.count;
+	++_count;
+
+	std::deque<Bucket>& buckets = _buckets[(int)type];
+	if (buckets.empty() || currentMillis >= buckets.back().start + BucketMillis) {
+		buckets.emplace_back();
+		buckets.back().start = currentMillis;
+	}
+	buckets.back().refs.push_back(Ref{k, id});
 }
 
 size_t PoiProvider::count() const {
 	core::ScopedReadLock scoped(_lock);
-	return _pois.size();
+	return _count;
+}
+
+bool PoiProvider::random(const Grid& grid, PoiResult& result) const {
+	if (grid.keys.empty()) {
+		return false;
+	}
+	const int64_t k = grid.keys[_random.random(0, (int)grid.keys.size() - 1)];
+	const Cell& cell = grid.cells.find(k)->second;
+	const Poi& poi = cell.pois[_random.random(0, (int)cell.pois.size() - 1)];
+	result = PoiResult{poi.pos, true};
+	return true;
+}
+
+void PoiProvider::nearest(const Grid& grid, const glm::vec3& pos, float radius, float& distanceSquare, PoiResult& result) const {
+	if (grid.keys.empty()) {
+		return;
+	}
+	auto visit = [&] (const Cell& c) {
+		for (const Poi& poi : c.pois) {
+			const glm::vec3 delta = poi.pos - pos;
+			const float d = glm::dot(delta, delta);
+			if (d <= distanceSquare) {
+				distanceSquare = d;
+				result = PoiResult{poi.pos, true};
+			}
+		}
+	};
+	// don't look up more cells than there are
+	const float span = radius * 2.0f / CellSize + 2.0f;
+	if (span * span > (float)grid.keys.size()) {
+		for (const auto& e : grid.cells) {
+			visit(e.second);
+		}
+		return;
+	}
+	const int minX = cell(pos.x - radius);
+	const int maxX = cell(pos.x + radius);
+	const int minZ = cell(pos.z - radius);
+	const int maxZ = cell(pos.z + radius);
+	for (int z = minZ; z <= maxZ; ++z) {
+		for (int x = minX; x <= maxX; ++x) {
+			auto i = grid.cells.find(key(x, z));
+			if (i != grid.cells.end()) {
+				visit(i->second);
+			}
+		}
+	}
 }
 
 PoiResult PoiProvider::query(Type type) const {
-	static PoiResult empty{glm::zero<glm::vec3>(), false};
+	PoiResult result{glm::zero<glm::vec3>(), false};
 	core::ScopedReadLock scoped(_lock);
-	if (_pois.empty()) {
-		return empty;
+	if (_count == 0u) {
+		return result;
 	}
-	if (type == Type::NONE) {
-		return PoiResult{_random.randomElement(_pois.begin(), _pois.end())->pos, true};
+	if (type != Type::NONE) {
+		random(_grids[(int)type], result);
+		return result;
+	}
+	// pick the type by the amount of its POIs
+	size_t n = (size_t)_random.random(0, (int)_count - 1);
+	for (int i = 0; i < Types; ++i) {
+		if (n < _grids[i].count) {
+			random(_grids[i], result);
+			break;
+		}
+		n -= _grids[i].count;
+	}
+	return result;
+}
+
+PoiResult PoiProvider::query(Type type, const glm::vec3& pos, float radius) const {
+	PoiResult result{glm::zero<glm::vec3>(), false};
+	float distanceSquare = radius * radius;
+	core::ScopedReadLock scoped(_lock);
+	if (type != Type::NONE) {
+		nearest(_grids[(int)type], pos, radius, distanceSquare, result);
+		return result;
 	}
-	auto i = std::find_if(_pois.begin(), _pois.end(), [=] (const Poi& poi) {return poi.type == type;});
-	if (i != _pois.end()) {
-		return PoiResult{i->pos, true};
+	for (int i = 0; i < Types; ++i) {
+		nearest(_grids[i], pos, radius, distanceSquare, result);
 	}
-	return empty;
+	return result;
 }
 
 }
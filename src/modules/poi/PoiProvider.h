@@ -5,12 +5,15 @@
 #pragma once
 
 #include "backend/ForwardDecl.h"
+#include "core/collection/DynamicArray.h"
 #include "core/concurrent/ReadWriteLock.h"
 #include "math/Random.h"
 #include "Type.h"
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
+#include <glm/common.hpp>
 #include <deque>
+#include <unordered_map>
 
 namespace poi {
 
@@ -25,23 +28,65 @@ struct PoiResult {
 /**
  * @brief Maintains a list of points of interest that are only valid for a particular time.
  *
- * @note One can add new POIs by calling @c PoiProvider::addPointOfInterest() and get a random,
- * not yet expired POI by calling @c PoiProvider::getPointOfInterest().
+ * The POIs of each type are kept in a uniform grid over the x and z coordinates. They are also
+ * put into time buckets - all POIs of a type that were added within @c BucketMillis expire together.
+ * This means that a POI might live up to @c BucketMillis longer than the runtime of its type.
+ *
+ * @note One can add new POIs by calling @c PoiProvider::add() and get a random or the nearest,
+ * not yet expired POI by calling @c PoiProvider::query().
  */
 class PoiProvider {
+public:
+	static constexpr float CellSize = 32.0f;
+	static constexpr uint64_t BucketMillis = 5000u;
 private:
 	struct Poi {
 		glm::vec3 pos;
-		Type type;
 		uint64_t time;
+		uint32_t id;
+	};
+	struct Cell {
+		core::DynamicArray<Poi> pois;
+		/** index into @c Grid::keys */
+		uint32_t keyIndex;
+	};
+	/**
+	 * @brief The POIs of one type
+	 */
+	struct Grid {
+		std::unordered_map<int64_t, Cell> cells;
+		/** the keys of all non empty cells - for picking a random cell */
+		core::DynamicArray<int64_t> keys;
+		size_t count = 0u;
+	};
+	struct Ref {
+		int64_t key;
+		uint32_t id;
+	};
+	/**
+	 * @brief The POIs of one type that were added between @c start and @c start + @c BucketMillis
+	 */
+	struct Bucket {
+		uint64_t start;
+		/** in the order the POIs were added */
+		core::DynamicArray<Ref> refs;
 	};
 
-	typedef std::deque<Poi> PoiQueue;
-	PoiQueue _pois core_thread_guarded_by(_lock);
+	static constexpr int Types = (int)Type::MAX + 1;
+	Grid _grids[Types] core_thread_guarded_by(_lock);
+	std::deque<Bucket> _buckets[Types] core_thread_guarded_by(_lock);
+	size_t _count core_thread_guarded_by(_lock) = 0u;
+	uint32_t _nextId core_thread_guarded_by(_lock) = 0u;
 
 	core::TimeProviderPtr _timeProvider;
 	core::ReadWriteLock _lock;
 	math::Random _random;
+
+	static int cell(float v);
+	static int64_t key(int cellX, int cellZ);
+	void remove(Grid& grid, const Ref& ref);
+	bool random(const Grid& grid, PoiResult& result) const;
+	void nearest(const Grid& grid, const glm::vec3& pos, float radius, float& distanceSquare, PoiResult& result) const;
 public:
 	PoiProvider(const core::TimeProviderPtr& timeProvider);
 
@@ -61,8 +106,23 @@ public:
 	/**
 	 * @brief Get a POI either randomly or by specifying a type.
 	 * @param[in] type If @c Type::NONE is given here we are just looking for any type of POI
+	 * @note A random cell of the grid is picked - so the POIs of crowded areas don't dominate the result
 	 */
 	PoiResult query(Type type = Type::NONE) const;
+	/**
+	 * @brief Get the POI that is nearest to the given position
+	 * @param[in] type If @c Type::NONE is given here we are just looking for any type of POI
+	 * @param[in] radius Only the POIs that are not further away than this are taken into account
+	 */
+	PoiResult query(Type type, const glm::vec3& pos, float radius) const;
 };
 
+inline int PoiProvider::cell(float v) {
+	return (int)glm::floor(v / CellSize);
+}
+
+inline int64_t PoiProvider::key(int cellX, int cellZ) {
+	return (int64_t)((uint64_t)(int64_t)cellZ << 32) | (int64_t)((uint32_t)cellX ^ 0x80000000u);
+}
+
 }
@@ -78,4 +78,59 @@ TEST_F(PoiProviderTest, testNoExpire) {
 	EXPECT_EQ(3u, poiProvider.count()) << "We should still have all three left";
 }
 
+TEST_F(PoiProviderTest, testExpirePerType) {
+	PoiProvider poiProvider(_timeProvider);
+	poiProvider.add(glm::vec3(1.0), Type::GENERIC);
+	poiProvider.add(glm::vec3(2.0), Type::FIGHT);
+	poiProvider.add(glm::vec3(3.0), Type::FIGHT);
+	EXPECT_EQ(3u, poiProvider.count());
+	_timeProvider->setTickTime(120 * 1000UL + PoiProvider::BucketMillis);
+	poiProvider.update(0UL);
+	EXPECT_EQ(1u, poiProvider.count()) << "The fight pois should be expired";
+	EXPECT_FALSE(poiProvider.query(Type::FIGHT).valid);
+	const PoiResult& result = poiProvider.query(Type::GENERIC);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ(glm::vec3(1.0), result.pos);
+}
+
+TEST_F(PoiProviderTest, testQueryNearest) {
+	PoiProvider poiProvider(_timeProvider);
+	poiProvider.add(glm::vec3(0.0f, 0.0f, 0.0f), Type::GENERIC);
+	poiProvider.add(glm::vec3(40.0f, 0.0f, 0.0f), Type::GENERIC);
+	poiProvider.add(glm::vec3(70.0f, 0.0f, 10.0f), Type::QUEST);
+	poiProvider.add(glm::vec3(-100.0f, 0.0f, -100.0f), Type::GENERIC);
+
+	PoiResult result = poiProvider.query(Type::GENERIC, glm::vec3(60.0f, 0.0f, 0.0f), 100.0f);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ(glm::vec3(40.0f, 0.0f, 0.0f), result.pos);
+
+	result = poiProvider.query(Type::NONE, glm::vec3(60.0f, 0.0f, 0.0f), 100.0f);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ(glm::vec3(70.0f, 0.0f, 10.0f), result.pos);
+
+	result = poiProvider.query(Type::GENERIC, glm::vec3(-60.0f, 0.0f, -60.0f), 10.0f);
+	EXPECT_FALSE(result.valid) << "There is no poi within the radius";
+
+	result = poiProvider.query(Type::GENERIC, glm::vec3(-60.0f, 0.0f, -60.0f), 10000.0f);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ(glm::vec3(-100.0f, 0.0f, -100.0f), result.pos);
+}
+
+TEST_F(PoiProviderTest, testQueryAfterExpire) {
+	PoiProvider poiProvider(_timeProvider);
+	for (int i = 0; i < 10; ++i) {
+		poiProvider.add(glm::vec3((float)i * PoiProvider::CellSize), Type::FIGHT);
+	}
+	_timeProvider->setTickTime(30 * 1000UL);
+	poiProvider.add(glm::vec3(5.0f * PoiProvider::CellSize), Type::FIGHT);
+	_timeProvider->setTickTime(120 * 1000UL + PoiProvider::BucketMillis);
+	poiProvider.update(0UL);
+	EXPECT_EQ(1u, poiProvider.count());
+	for (int i = 0; i < 10; ++i) {
+		const PoiResult& result = poiProvider.query(Type::FIGHT);
+		EXPECT_TRUE(result.valid);
+		EXPECT_EQ(glm::vec3(5.0f * PoiProvider::CellSize), result.pos);
+	}
+}
+
 }
@@ -70,6 +70,11 @@ public:
 	void unmapData(int32_t idx) const;
 
 	bool update(int32_t idx, const void* data, size_t size);
+	/**
+	 * @brief Updates a part of the buffer without changing its size
+	 * @note The range must be inside the size of the last @c update() call
+	 */
+	bool update(int32_t idx, size_t offset, const void* data, size_t size);
 
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
@@ -2,6 +2,8 @@
  * @file
  */
 
+#pragma once
+
 #include "Renderer.h"
 
 namespace video {
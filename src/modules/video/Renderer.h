@@ -321,9 +321,9 @@ extern void drawElements(Primitive mode, size_t numIndices, DataType type, void*
 extern void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, size_t amount);
 extern void drawElementsBaseVertex(Primitive mode, size_t numIndices, DataType type, size_t indexSize, int baseIndex, int baseVertex);
 extern void drawElementsIndirect(Primitive mode, DataType type, void* offset);
-inline void drawMultiElementsIndirect(Primitive mode, DataType type, void* offset, size_t commandSize, size_t stride = 0u);
+extern void drawMultiElementsIndirect(Primitive mode, DataType type, void* offset, size_t commandSize, size_t stride = 0u);
 extern void drawArraysIndirect(Primitive mode, void* offset);
-inline void drawMultiArraysIndirect(Primitive mode, void* offset, size_t commandSize, size_t stride = 0u);
+extern void drawMultiArraysIndirect(Primitive mode, void* offset, size_t commandSize, size_t stride = 0u);
 extern void drawArrays(Primitive mode, size_t count);
 extern void drawInstancedArrays(Primitive mode, size_t count, size_t amount);
 extern void disableDebug();
@@ -365,7 +365,7 @@ inline void drawElementsIndirect(Primitive mode, void* offset) {
 
 template<class IndexType>
 inline void drawMultiElementsIndirect(Primitive mode, void* offset, size_t commandSize) {
-	drawMultiElementsIndirect(mode, mapType<IndexType>(), offset, commandSize);
+	drawMultiElementsIndirect(mode, mapType<IndexType>(), offset, commandSize, sizeof(DrawElementsIndirectCommand));
 }
 
 template<class IndexType>
@@ -0,0 +1,214 @@
+/**
+ * @file
+ */
+
+#include "CompactMesh.h"
+#include "core/ArrayLength.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <limits>
+#include <vector>
+
+namespace voxel {
+
+namespace {
+
+/**
+ * The sub meshes are limited by the amount of triangles - each triangle adds at most three vertices, so the
+ * 16 bit indices are always enough.
+ */
+constexpr uint32_t MaxSubMeshIndices = (std::numeric_limits<CompactIndexType>::max)() / 3u * 3u;
+
+template<class T>
+inline void writeRaw(std::vector<uint8_t>& out, const T* data, size_t amount) {
+	const uint8_t* p = (const uint8_t*)data;
+	out.insert(out.end(), p, p + amount * sizeof(T));
+}
+
+template<class T>
+inline bool readRaw(const uint8_t*& buf, const uint8_t* end, T* data, size_t amount) {
+	const size_t bytes = amount * sizeof(T);
+	if ((size_t)(end - buf) < bytes) {
+		return false;
+	}
+	if (bytes > 0u) {
+		core_memcpy((void*)data, buf, bytes);
+	}
+	buf += bytes;
+	return true;
+}
+
+inline bool fits(const glm::ivec3& mins, const glm::ivec3& maxs) {
+	const glm::ivec3 extent = maxs - mins;
+	return extent.x <= CompactMesh::MaxExtentX && extent.y <= CompactMesh::MaxExtentY && extent.z <= CompactMesh::MaxExtentZ;
+}
+
+}
+
+void CompactMesh::clear() {
+	_vertices.clear();
+	_indices.clear();
+	_subMeshes.clear();
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = IndexRange();
+	}
+	_hasFaceRanges = false;
+	_offset = glm::ivec3(0);
+}
+
+size_t CompactMesh::size() const {
+	return _vertices.bytes() + _indices.bytes();
+}
+
+bool CompactMesh::encode(const Mesh& mesh) {
+	core_trace_scoped(CompactMeshEncode);
+	clear();
+	const uint32_t numIndices = (uint32_t)mesh.getNoOfIndices();
+	const uint32_t numVertices = (uint32_t)mesh.getNoOfVertices();
+	const IndexType* indices = mesh.getRawIndexData();
+	const VoxelVertex* vertices = mesh.getRawVertexData();
+
+	// the face of each triangle
+	std::vector<uint8_t> triangleFaces(numIndices / 3u, (uint8_t)FaceNames::PositiveX);
+	const bool hasFaceRanges = mesh.hasFaceIndexRanges();
+	for (int face = 0; hasFaceRanges && face < FaceCount; ++face) {
+		const IndexRange& range = mesh.faceIndexRange((FaceNames)face);
+		for (uint32_t i = range.offset; i < range.offset + range.count; i += 3u) {
+			triangleFaces[i / 3u] = (uint8_t)face;
+		}
+	}
+
+	// split the triangles into sub meshes - the order of the triangles is kept
+	CompactSubMesh current;
+	glm::ivec3 mins((std::numeric_limits<int>::max)());
+	glm::ivec3 maxs((std::numeric_limits<int>::min)());
+	for (uint32_t i = 0u; i < numIndices; i += 3u) {
+		glm::ivec3 triMins(vertices[indices[i]].position);
+		glm::ivec3 triMaxs(triMins);
+		for (uint32_t n = 1u; n < 3u; ++n) {
+			const glm::ivec3 pos(vertices[indices[i + n]].position);
+			triMins = glm::min(triMins, pos);
+			triMaxs = glm::max(triMaxs, pos);
+		}
+		if (!fits(triMins, triMaxs)) {
+			clear();
+			return false;
+		}
+		const glm::ivec3 newMins = glm::min(mins, triMins);
+		const glm::ivec3 newMaxs = glm::max(maxs, triMaxs);
+		if (current.indexCount > 0u && (current.indexCount + 3u > MaxSubMeshIndices || !fits(newMins, newMaxs))) {
+			current.origin = mins;
+			_subMeshes.push_back(current);
+			current = CompactSubMesh();
+			current.firstIndex = i;
+			mins = triMins;
+			maxs = triMaxs;
+		} else {
+			mins = newMins;
+			maxs = newMaxs;
+		}
+		current.indexCount += 3u;
+	}
+	if (current.indexCount > 0u) {
+		current.origin = mins;
+		_subMeshes.push_back(current);
+	}
+
+	// the vertices are duplicated for each face they are used by - the stamp marks the entries of the current
+	// sub mesh in the lookup table
+	std::vector<uint32_t> stamps(numVertices * FaceCount, 0u);
+	std::vector<CompactIndexType> lookup(numVertices * FaceCount);
+	_indices.reserve(numIndices);
+	for (size_t s = 0u; s < _subMeshes.size(); ++s) {
+		CompactSubMesh& subMesh = _subMeshes[s];
+		subMesh.baseVertex = (uint32_t)_vertices.size();
+		const uint32_t stamp = (uint32_t)s + 1u;
+		for (uint32_t i = subMesh.firstIndex; i < subMesh.firstIndex + subMesh.indexCount; ++i) {
+			const IndexType index = indices[i];
+			const uint8_t face = triangleFaces[i / 3u];
+			const size_t key = (size_t)index * FaceCount + face;
+			if (stamps[key] != stamp) {
+				const VoxelVertex& v = vertices[index];
+				stamps[key] = stamp;
+				lookup[key] = (CompactIndexType)(_vertices.size() - subMesh.baseVertex);
+				_vertices.emplace_back(glm::ivec3(v.position) - subMesh.origin, v.ambientOcclusion, (FaceNames)face, v.colorIndex);
+			}
+			_indices.push_back(lookup[key]);
+		}
+	}
+
+	for (int i = 0; hasFaceRanges && i < FaceCount; ++i) {
+		_faceRanges[i] = mesh.faceIndexRange((FaceNames)i);
+	}
+	_hasFaceRanges = hasFaceRanges;
+	_offset = mesh.getOffset();
+	return true;
+}
+
+void CompactMesh::decode(Mesh& mesh) const {
+	core_trace_scoped(CompactMeshDecode);
+	mesh.clear();
+	VertexArray& vertices = mesh.getVertexVector();
+	IndexArray& indices = mesh.getIndexVector();
+	vertices.reserve(_vertices.size());
+	indices.reserve(_indices.size());
+	for (size_t s = 0u; s < _subMeshes.size(); ++s) {
+		const CompactSubMesh& subMesh = _subMeshes[s];
+		const uint32_t vertexEnd = s + 1u < _subMeshes.size() ? _subMeshes[s + 1u].baseVertex : (uint32_t)_vertices.size();
+		for (uint32_t v = subMesh.baseVertex; v < vertexEnd; ++v) {
+			const CompactVertex& compact = _vertices[v];
+			VoxelVertex vertex;
+			vertex.position = compact.position() + subMesh.origin;
+			vertex.ambientOcclusion = compact.ambientOcclusion();
+			vertex.colorIndex = compact.colorIndex();
+			vertices.push_back(vertex);
+		}
+		for (uint32_t i = subMesh.firstIndex; i < subMesh.firstIndex + subMesh.indexCount; ++i) {
+			indices.push_back((IndexType)_indices[i] + subMesh.baseVertex);
+		}
+	}
+	for (int i = 0; i < FaceCount; ++i) {
+		mesh.setFaceIndexRange((FaceNames)i, _faceRanges[i].offset, _faceRanges[i].count);
+	}
+	mesh.setOffset(_offset);
+}
+
+void CompactMesh::write(std::vector<uint8_t>& out) const {
+	const uint32_t counts[] = { (uint32_t)_vertices.size(), (uint32_t)_indices.size(), (uint32_t)_subMeshes.size() };
+	writeRaw(out, counts, lengthof(counts));
+	writeRaw(out, _vertices.data(), _vertices.size());
+	writeRaw(out, _indices.data(), _indices.size());
+	writeRaw(out, _subMeshes.data(), _subMeshes.size());
+	writeRaw(out, _faceRanges, FaceCount);
+	const uint8_t hasFaceRanges = _hasFaceRanges ? 1u : 0u;
+	writeRaw(out, &hasFaceRanges, 1);
+	writeRaw(out, &_offset, 1);
+}
+
+bool CompactMesh::read(const uint8_t*& buf, const uint8_t* end) {
+	clear();
+	uint32_t counts[3];
+	if (!readRaw(buf, end, counts, lengthof(counts))) {
+		return false;
+	}
+	const size_t bytes = counts[0] * sizeof(CompactVertex) + counts[1] * sizeof(CompactIndexType)
+			+ counts[2] * sizeof(CompactSubMesh);
+	if ((size_t)(end - buf) < bytes) {
+		return false;
+	}
+	_vertices.resize(counts[0]);
+	_indices.resize(counts[1]);
+	_subMeshes.resize(counts[2]);
+	uint8_t hasFaceRanges = 0u;
+	if (!readRaw(buf, end, _vertices.data(), _vertices.size()) || !readRaw(buf, end, _indices.data(), _indices.size())
+			|| !readRaw(buf, end, _subMeshes.data(), _subMeshes.size()) || !readRaw(buf, end, _faceRanges, FaceCount)
+			|| !readRaw(buf, end, &hasFaceRanges, 1) || !readRaw(buf, end, &_offset, 1)) {
+		clear();
+		return false;
+	}
+	_hasFaceRanges = hasFaceRanges != 0u;
+	return true;
+}
+
+}
@@ -0,0 +1,177 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Mesh.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace voxel {
+
+/**
+ * @brief A vertex that is packed into 32 bits
+ *
+ * The position is relative to the origin of the @c CompactSubMesh the vertex belongs to. The face direction is
+ * stored, too - vertices that are shared between quads of different face directions are duplicated. It is
+ * always @c FaceNames::PositiveX if the source mesh didn't have face index ranges.
+ *
+ * @note The layout must match the decoding in the world shaders (@c _terrain.vert)
+ *
+ * | bits  | content                  |
+ * |-------|--------------------------|
+ * | 0-5   | x                        |
+ * | 6-12  | y                        |
+ * | 13-18 | z                        |
+ * | 19-20 | ambient occlusion        |
+ * | 21-23 | face (@c FaceNames)      |
+ * | 24-31 | color index              |
+ */
+struct CompactVertex {
+	uint32_t data = 0u;
+
+	static constexpr int BitsX = 6;
+	static constexpr int BitsY = 7;
+	static constexpr int BitsZ = 6;
+	static constexpr int ShiftY = BitsX;
+	static constexpr int ShiftZ = ShiftY + BitsY;
+	static constexpr int ShiftAO = ShiftZ + BitsZ;
+	static constexpr int ShiftFace = ShiftAO + 2;
+	static constexpr int ShiftColor = ShiftFace + 3;
+
+	inline CompactVertex() {
+	}
+
+	inline CompactVertex(const glm::ivec3& pos, uint8_t ambientOcclusion, FaceNames face, uint8_t colorIndex) {
+		data = (uint32_t)pos.x | ((uint32_t)pos.y << ShiftY) | ((uint32_t)pos.z << ShiftZ)
+				| ((uint32_t)(ambientOcclusion & 3u) << ShiftAO) | ((uint32_t)face << ShiftFace)
+				| ((uint32_t)colorIndex << ShiftColor);
+	}
+
+	inline glm::ivec3 position() const {
+		return glm::ivec3(data & ((1u << BitsX) - 1u), (data >> ShiftY) & ((1u << BitsY) - 1u), (data >> ShiftZ) & ((1u << BitsZ) - 1u));
+	}
+
+	inline uint8_t ambientOcclusion() const {
+		return (uint8_t)((data >> ShiftAO) & 3u);
+	}
+
+	inline FaceNames face() const {
+		return (FaceNames)((data >> ShiftFace) & 7u);
+	}
+
+	inline uint8_t colorIndex() const {
+		return (uint8_t)(data >> ShiftColor);
+	}
+};
+static_assert(sizeof(CompactVertex) == 4, "Unexpected size of the compact vertex struct");
+
+using CompactIndexType = uint16_t;
+
+/**
+ * @brief A part of a @c CompactMesh that can be rendered with one draw call by using the base vertex
+ */
+struct CompactSubMesh {
+	/** the position that is added to the vertex positions */
+	glm::ivec3 origin { 0 };
+	uint32_t baseVertex = 0u;
+	uint32_t firstIndex = 0u;
+	uint32_t indexCount = 0u;
+};
+
+/**
+ * @brief Half the size of a @c Mesh: 4 byte vertices and 16 bit indices
+ *
+ * The triangles of the mesh are split into sub meshes. The vertices of each sub mesh are within
+ * @c MaxExtent of its origin and the indices are relative to its base vertex.
+ *
+ * @note The triangles keep their order - the face index ranges of the source mesh are still valid.
+ */
+class CompactMesh {
+public:
+	/** the max distance of a vertex to the origin of its sub mesh */
+	static constexpr int MaxExtentX = (1 << CompactVertex::BitsX) - 1;
+	static constexpr int MaxExtentY = (1 << CompactVertex::BitsY) - 1;
+	static constexpr int MaxExtentZ = (1 << CompactVertex::BitsZ) - 1;
+private:
+	core::DynamicArray<CompactVertex> _vertices;
+	core::DynamicArray<CompactIndexType> _indices;
+	core::DynamicArray<CompactSubMesh> _subMeshes;
+	IndexRange _faceRanges[FaceCount];
+	bool _hasFaceRanges = false;
+	glm::ivec3 _offset { 0 };
+public:
+	/**
+	 * @brief Converts the given mesh
+	 * @return @c false if a triangle is too big for a sub mesh. The compact mesh is empty in this case and the
+	 * original mesh should be used.
+	 */
+	bool encode(const Mesh& mesh);
+	/**
+	 * @brief Converts the compact mesh back into a mesh - the shared vertices of the source mesh are not
+	 * restored.
+	 */
+	void decode(Mesh& mesh) const;
+
+	/**
+	 * @brief Appends the raw data of the mesh to the given buffer
+	 * @note The data is meant to be read by @c read() on the same platform
+	 */
+	void write(std::vector<uint8_t>& out) const;
+	/**
+	 * @brief Reads a mesh that was written by @c write() and advances the buffer behind it
+	 * @return @c false if the buffer is too small - the mesh is empty in this case
+	 */
+	bool read(const uint8_t*& buf, const uint8_t* end);
+
+	void clear();
+	bool isEmpty() const;
+
+	/**
+	 * @brief The amount of bytes the vertices and indices are using
+	 */
+	size_t size() const;
+
+	const core::DynamicArray<CompactVertex>& vertices() const;
+	const core::DynamicArray<CompactIndexType>& indices() const;
+	const core::DynamicArray<CompactSubMesh>& subMeshes() const;
+	const IndexRange& faceIndexRange(FaceNames face) const;
+	/**
+	 * @sa Mesh::hasFaceIndexRanges()
+	 */
+	bool hasFaceIndexRanges() const;
+	const glm::ivec3& getOffset() const;
+};
+
+inline bool CompactMesh::isEmpty() const {
+	return _indices.empty();
+}
+
+inline const core::DynamicArray<CompactVertex>& CompactMesh::vertices() const {
+	return _vertices;
+}
+
+inline const core::DynamicArray<CompactIndexType>& CompactMesh::indices() const {
+	return _indices;
+}
+
+inline const core::DynamicArray<CompactSubMesh>& CompactMesh::subMeshes() const {
+	return _subMeshes;
+}
+
+inline const IndexRange& CompactMesh::faceIndexRange(FaceNames face) const {
+	return _faceRanges[(int)face];
+}
+
+inline bool CompactMesh::hasFaceIndexRanges() const {
+	return _hasFaceRanges;
+}
+
+inline const glm::ivec3& CompactMesh::getOffset() const {
+	return _offset;
+}
+
+}
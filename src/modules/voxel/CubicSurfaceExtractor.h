@@ -407,8 +407,11 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 
 	{
 		core_trace_scoped(GenerateMesh);
-		for (QuadListVector& vecListQuads : vecQuads) {
-			meshify(result, mergeQuads, ambientOcclusion, vecListQuads);
+		// the triangles of each face direction end up in their own range of the index list
+		for (int face = 0; face < FaceCount; ++face) {
+			const uint32_t start = (uint32_t)result->getNoOfIndices();
+			meshify(result, mergeQuads, ambientOcclusion, vecQuads[face]);
+			result->setFaceIndexRange((FaceNames)face, start, (uint32_t)result->getNoOfIndices() - start);
 		}
 	}
 
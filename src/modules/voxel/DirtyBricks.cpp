@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#include "DirtyBricks.h"
+#include "core/Assert.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+
+namespace voxel {
+
+DirtyBricks::DirtyBricks(const Region& region, int brickSizeShift) :
+		_region(region), _brickSizeShift(brickSizeShift) {
+	core_assert_msg(brickSizeShift >= 0 && brickSizeShift < 16, "Invalid brick size shift: %i", brickSizeShift);
+	if (!_region.isValid()) {
+		return;
+	}
+	const int brickSize = 1 << _brickSizeShift;
+	_bricks = (_region.getDimensionsInVoxels() + brickSize - 1) >> _brickSizeShift;
+	const int n = _bricks.x * _bricks.y * _bricks.z;
+	_bits.resize((n + 63) / 64, 0u);
+}
+
+void DirtyBricks::markRegion(const Region& region) {
+	if (!region.isValid() || !_region.isValid()) {
+		return;
+	}
+	Region cropped = region;
+	cropped.cropTo(_region);
+	if (!cropped.isValid()) {
+		return;
+	}
+	const glm::ivec3& mins = (cropped.getLowerCorner() - _region.getLowerCorner()) >> _brickSizeShift;
+	const glm::ivec3& maxs = (cropped.getUpperCorner() - _region.getLowerCorner()) >> _brickSizeShift;
+	glm::ivec3 brick;
+	for (brick.z = mins.z; brick.z <= maxs.z; ++brick.z) {
+		for (brick.y = mins.y; brick.y <= maxs.y; ++brick.y) {
+			for (brick.x = mins.x; brick.x <= maxs.x; ++brick.x) {
+				markBrick(brick);
+			}
+		}
+	}
+}
+
+void DirtyBricks::translate(const glm::ivec3& t) {
+	_region.shift(t);
+}
+
+void DirtyBricks::clear() {
+	for (uint64_t& word : _bits) {
+		word = 0u;
+	}
+	_dirtyBricks = 0;
+}
+
+bool DirtyBricks::isDirty(const glm::ivec3& brick) const {
+	if (glm::any(glm::lessThan(brick, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(brick, _bricks))) {
+		return false;
+	}
+	const int idx = index(brick);
+	return (_bits[idx >> 6] & ((uint64_t)1 << (idx & 63))) != 0u;
+}
+
+Region DirtyBricks::brickRegion(const glm::ivec3& brick) const {
+	const glm::ivec3& mins = _region.getLowerCorner() + (brick << _brickSizeShift);
+	const glm::ivec3& maxs = glm::min(mins + brickSize() - 1, _region.getUpperCorner());
+	return Region(mins, maxs);
+}
+
+}
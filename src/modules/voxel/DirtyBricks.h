@@ -0,0 +1,126 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/Region.h"
+#include <glm/vec3.hpp>
+#include <vector>
+#include <stdint.h>
+
+namespace voxel {
+
+/**
+ * @brief Compact set of modified bricks of a volume
+ *
+ * The region is split into bricks of @c brickSize voxels per axis (starting at the lower corner of the
+ * region) and every brick is represented by one bit. Unlike a single accumulated dirty region, scattered
+ * modifications only mark the bricks they touched instead of the whole bounding box.
+ *
+ * @sa RawVolumeWrapper
+ */
+class DirtyBricks {
+public:
+	static constexpr int DefaultBrickSizeShift = 4;
+private:
+	Region _region;
+	glm::ivec3 _bricks { 0 };
+	int _brickSizeShift;
+	int _dirtyBricks = 0;
+	std::vector<uint64_t> _bits;
+
+	inline int index(const glm::ivec3& brick) const {
+		return (brick.z * _bricks.y + brick.y) * _bricks.x + brick.x;
+	}
+
+	inline void markBrick(const glm::ivec3& brick) {
+		const int idx = index(brick);
+		uint64_t& word = _bits[idx >> 6];
+		const uint64_t bit = (uint64_t)1 << (idx & 63);
+		if ((word & bit) == 0u) {
+			word |= bit;
+			++_dirtyBricks;
+		}
+	}
+
+public:
+	/**
+	 * @param[in] region The region of the volume that should be tracked
+	 * @param[in] brickSizeShift The bricks have a size of @c 1<<brickSizeShift voxels per axis
+	 */
+	DirtyBricks(const Region& region, int brickSizeShift = DefaultBrickSizeShift);
+
+	/**
+	 * @brief Marks the brick that contains the given voxel position. Positions outside the region are ignored.
+	 */
+	inline void markVoxel(const glm::ivec3& pos) {
+		if (!_region.containsPoint(pos)) {
+			return;
+		}
+		markBrick((pos - _region.getLowerCorner()) >> _brickSizeShift);
+	}
+
+	/**
+	 * @brief Marks all bricks that intersect the given region.
+	 */
+	void markRegion(const Region& region);
+
+	/**
+	 * @brief Moves the tracked region without losing the dirty state
+	 */
+	void translate(const glm::ivec3& t);
+
+	void clear();
+
+	/**
+	 * @param[in] brick The brick coordinates - not the voxel coordinates
+	 */
+	bool isDirty(const glm::ivec3& brick) const;
+
+	/**
+	 * @return The voxel region of the given brick - cropped to the tracked region
+	 */
+	Region brickRegion(const glm::ivec3& brick) const;
+
+	/**
+	 * @brief Calls the given functor with the voxel region of every dirty brick
+	 */
+	template<class FUNC>
+	void visit(FUNC&& func) const {
+		if (_dirtyBricks == 0) {
+			return;
+		}
+		glm::ivec3 brick;
+		for (brick.z = 0; brick.z < _bricks.z; ++brick.z) {
+			for (brick.y = 0; brick.y < _bricks.y; ++brick.y) {
+				for (brick.x = 0; brick.x < _bricks.x; ++brick.x) {
+					if (isDirty(brick)) {
+						func(brickRegion(brick));
+					}
+				}
+			}
+		}
+	}
+
+	inline bool empty() const {
+		return _dirtyBricks == 0;
+	}
+
+	/**
+	 * @return The amount of dirty bricks
+	 */
+	inline int size() const {
+		return _dirtyBricks;
+	}
+
+	inline int brickSize() const {
+		return 1 << _brickSizeShift;
+	}
+
+	inline const Region& region() const {
+		return _region;
+	}
+};
+
+}
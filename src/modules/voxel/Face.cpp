@@ -11,6 +11,29 @@
 
 namespace voxel {
 
+uint8_t visibleFaces(const glm::vec3& eye, const glm::vec3& mins, const glm::vec3& maxs) {
+	uint8_t mask = 0u;
+	if (eye.x > mins.x) {
+		mask |= faceBit(FaceNames::PositiveX);
+	}
+	if (eye.x < maxs.x) {
+		mask |= faceBit(FaceNames::NegativeX);
+	}
+	if (eye.y > mins.y) {
+		mask |= faceBit(FaceNames::PositiveY);
+	}
+	if (eye.y < maxs.y) {
+		mask |= faceBit(FaceNames::NegativeY);
+	}
+	if (eye.z > mins.z) {
+		mask |= faceBit(FaceNames::PositiveZ);
+	}
+	if (eye.z < maxs.z) {
+		mask |= faceBit(FaceNames::NegativeZ);
+	}
+	return mask;
+}
+
 FaceNames raycastFaceDetection(const glm::vec3& rayOrigin, const glm::vec3& hitPos, float offsetMins, float offsetMaxs) {
 	const glm::vec3& rayDirection = glm::normalize(hitPos - rayOrigin);
 	return raycastFaceDetection(rayOrigin, rayDirection, hitPos, offsetMins, offsetMaxs);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <glm/fwd.hpp>
+#include <stdint.h>
 
 namespace voxel {
 
@@ -20,6 +21,25 @@ inline bool isVerticalFace(FaceNames face) {
 	 return face == FaceNames::PositiveY || face == FaceNames::NegativeY;
 }
 
+/**
+ * @brief Bit for the given face in the masks returned by @c visibleFaces()
+ */
+inline uint8_t faceBit(FaceNames face) {
+	return (uint8_t)(1u << (uint8_t)face);
+}
+
+/**
+ * @brief Checks which faces of the quads inside of the given box might point towards the given position
+ *
+ * A quad that faces into the positive x direction can only be seen from a position with a greater x
+ * coordinate than the plane the quad is lying in - the box is the range of these planes.
+ *
+ * @param[in] mins The lower corner of the box the quads are in
+ * @param[in] maxs The upper corner of the box the quads are in
+ * @return A bitmask of @c faceBit() values
+ */
+extern uint8_t visibleFaces(const glm::vec3& eye, const glm::vec3& mins, const glm::vec3& maxs);
+
 extern FaceNames raycastFaceDetection(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& hitPos, float offsetMins = -0.5f, float offsetMaxs = 0.5f);
 extern FaceNames raycastFaceDetection(const glm::vec3& rayOrigin, const glm::vec3& hitPos, float offsetMins = -0.5f, float offsetMaxs = 0.5f);
 
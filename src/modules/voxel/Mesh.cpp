@@ -29,6 +29,9 @@ Mesh::Mesh(Mesh&& other) noexcept {
 	other._compressedIndices = nullptr;
 	_compressedIndexSize = other._compressedIndexSize;
 	other._compressedIndexSize = 0u;
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = other._faceRanges[i];
+	}
 	_offset = other._offset;
 	_mayGetResized = other._mayGetResized;
 }
@@ -43,6 +46,9 @@ Mesh::Mesh(const Mesh& other) {
 	} else {
 		_compressedIndices = nullptr;
 	}
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = other._faceRanges[i];
+	}
 	_offset = other._offset;
 	_mayGetResized = other._mayGetResized;
 }
@@ -61,6 +67,9 @@ Mesh& Mesh::operator=(const Mesh& other) {
 	} else {
 		_compressedIndices = nullptr;
 	}
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = other._faceRanges[i];
+	}
 	_offset = other._offset;
 	_mayGetResized = other._mayGetResized;
 	return *this;
@@ -74,6 +83,9 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept {
 	other._compressedIndices = nullptr;
 	_compressedIndexSize = other._compressedIndexSize;
 	other._compressedIndexSize = 4u;
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = other._faceRanges[i];
+	}
 	_offset = other._offset;
 	_mayGetResized = other._mayGetResized;
 	return *this;
@@ -134,9 +146,30 @@ void Mesh::setOffset(const glm::ivec3& offset) {
 void Mesh::clear() {
 	_vecVertices.clear();
 	_vecIndices.clear();
+	for (int i = 0; i < FaceCount; ++i) {
+		_faceRanges[i] = IndexRange();
+	}
 	_offset = glm::ivec3(0);
 }
 
+void Mesh::setFaceIndexRange(FaceNames face, uint32_t offset, uint32_t count) {
+	core_assert_msg(offset + count <= _vecIndices.size(), "Face index range exceeds the indices (%u + %u vs %i)", offset, count, (int)_vecIndices.size());
+	IndexRange& range = _faceRanges[(int)face];
+	range.offset = offset;
+	range.count = count;
+}
+
+bool Mesh::hasFaceIndexRanges() const {
+	if (_vecIndices.empty()) {
+		return false;
+	}
+	size_t count = 0u;
+	for (int i = 0; i < FaceCount; ++i) {
+		count += _faceRanges[i].count;
+	}
+	return count == _vecIndices.size();
+}
+
 bool Mesh::isEmpty() const {
 	return getNoOfVertices() == 0 || getNoOfIndices() == 0;
 }
@@ -218,6 +251,22 @@ void Mesh::compressIndices() {
 	util::indexCompress(&_vecIndices.front(), maxSize, _compressedIndexSize, _compressedIndices, maxSize);
 }
 
+int mergeFaceIndexRanges(const IndexRange* faceRanges, uint8_t faceMask, IndexRange* out) {
+	int n = 0;
+	for (int i = 0; i < FaceCount; ++i) {
+		const IndexRange& range = faceRanges[i];
+		if (range.count == 0u || (faceMask & faceBit((FaceNames)i)) == 0u) {
+			continue;
+		}
+		if (n > 0 && out[n - 1].offset + out[n - 1].count == range.offset) {
+			out[n - 1].count += range.count;
+			continue;
+		}
+		out[n++] = range;
+	}
+	return n;
+}
+
 bool Mesh::operator<(const Mesh& rhs) const {
 	return glm::all(glm::lessThan(getOffset(), rhs.getOffset()));
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "Face.h"
 #include "VoxelVertex.h"
 #include "core/collection/DynamicArray.h"
 
@@ -12,6 +13,26 @@ namespace voxel {
 using VertexArray = core::DynamicArray<voxel::VoxelVertex>;
 using IndexArray = core::DynamicArray<voxel::IndexType>;
 
+/**
+ * @brief A range in the index list of a mesh - both values are given in indices, not in bytes
+ */
+struct IndexRange {
+	uint32_t offset = 0u;
+	uint32_t count = 0u;
+};
+
+static constexpr int FaceCount = (int)FaceNames::Max;
+
+/**
+ * @brief Collects the index ranges of the faces in the given mask - ranges that follow each other in the index
+ * list are merged into one range.
+ * @param[in] faceRanges The index ranges of the faces in the order of @c FaceNames
+ * @param[in] faceMask A bitmask of @c faceBit() values - see @c visibleFaces()
+ * @param[out] out Must have room for @c FaceCount entries
+ * @return The amount of ranges that were written to @c out
+ */
+extern int mergeFaceIndexRanges(const IndexRange* faceRanges, uint8_t faceMask, IndexRange* out);
+
 /**
  * @brief A simple and general-purpose mesh class to represent the data returned by the surface extraction functions.
  */
@@ -55,6 +76,22 @@ public:
 	void removeUnusedVertices();
 	void compressIndices();
 
+	/**
+	 * @brief The surface extractor puts the triangles of each face direction into one consecutive range of the
+	 * index list. This allows to skip the faces that are pointing away from the viewer.
+	 * @note The ranges are also valid for the compressed indices - multiply them with @c compressedIndexSize()
+	 * to get the byte offsets.
+	 * @sa hasFaceIndexRanges()
+	 */
+	const IndexRange& faceIndexRange(FaceNames face) const;
+	const IndexRange* faceIndexRanges() const;
+	void setFaceIndexRange(FaceNames face, uint32_t offset, uint32_t count);
+	/**
+	 * @return @c true if the face ranges cover all indices of the mesh. This is not the case for meshes that
+	 * were not created by the surface extractor.
+	 */
+	bool hasFaceIndexRanges() const;
+
 	const uint8_t* compressedIndices() const;
 	size_t compressedIndexSize() const;
 
@@ -64,6 +101,7 @@ private:
 	alignas(16) VertexArray _vecVertices;
 	uint8_t *_compressedIndices = nullptr;
 	size_t _compressedIndexSize = 0u;
+	IndexRange _faceRanges[FaceCount];
 	glm::ivec3 _offset { 0 };
 	bool _mayGetResized;
 };
@@ -76,4 +114,12 @@ inline size_t Mesh::compressedIndexSize() const {
 	return _compressedIndexSize;
 }
 
+inline const IndexRange& Mesh::faceIndexRange(FaceNames face) const {
+	return _faceRanges[(int)face];
+}
+
+inline const IndexRange* Mesh::faceIndexRanges() const {
+	return _faceRanges;
+}
+
 }
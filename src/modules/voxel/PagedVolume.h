@@ -106,6 +106,9 @@ public:
 		 * @return @c true if the chunk was modified (created), @c false if it was just loaded
 		 */
 		virtual bool pageIn(PagerContext& ctx) = 0;
+		/**
+		 * @brief Called for every chunk that is removed from memory - whether it was modified or not
+		 */
 		virtual void pageOut(Chunk* chunk) = 0;
 	};
 
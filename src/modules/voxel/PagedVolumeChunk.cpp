@@ -26,7 +26,7 @@ PagedVolume::Chunk::Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pag
 }
 
 PagedVolume::Chunk::~Chunk() {
-	if (_dataModified && _pager) {
+	if (_pager) {
 		_pager->pageOut(this);
 	}
 
@@ -162,6 +162,17 @@ void RawVolume::initialise(const Region& regValidRegion) {
 	clear();
 }
 
+void RawVolume::accumulateBounds(const glm::ivec3& mins, const glm::ivec3& maxs) {
+	if (_boundsValid) {
+		_mins = (glm::min)(_mins, mins);
+		_maxs = (glm::max)(_maxs, maxs);
+	} else {
+		_mins = mins;
+		_maxs = maxs;
+	}
+	_boundsValid = true;
+}
+
 void RawVolume::clear() {
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
 	core_memset(_data, 0, size);
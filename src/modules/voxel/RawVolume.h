@@ -140,6 +140,21 @@ public:
 
 	void clear();
 
+	/**
+	 * @brief Direct access to the voxels of the row at the given y and z position - starting at the
+	 * lower x corner of the region. The row contains @c width() voxels.
+	 * @note Voxels that are modified via this pointer are not taken into account for @c mins() and
+	 * @c maxs() - call @c accumulateBounds() after writing them.
+	 */
+	inline Voxel* row(int32_t y, int32_t z);
+	inline const Voxel* row(int32_t y, int32_t z) const;
+
+	/**
+	 * @brief Extends the aabb of the set voxels - needed if voxels were written with @c row()
+	 * @sa mins(), maxs()
+	 */
+	void accumulateBounds(const glm::ivec3& mins, const glm::ivec3& maxs);
+
 	inline const uint8_t* data() const {
 		return (const uint8_t*)_data;
 	}
@@ -224,6 +239,18 @@ inline glm::ivec3 RawVolume::maxs() const {
 	return _maxs;
 }
 
+inline Voxel* RawVolume::row(int32_t y, int32_t z) {
+	const int32_t localY = y - _region.getLowerY();
+	const int32_t localZ = z - _region.getLowerZ();
+	return _data + (localY + localZ * height()) * width();
+}
+
+inline const Voxel* RawVolume::row(int32_t y, int32_t z) const {
+	const int32_t localY = y - _region.getLowerY();
+	const int32_t localZ = z - _region.getLowerZ();
+	return _data + (localY + localZ * height()) * width();
+}
+
 /**
  * @brief This version of the function is provided so that the wrap mode does not need
  * to be specified as a template parameter, as it may be confusing to some users.
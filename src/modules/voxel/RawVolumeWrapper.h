@@ -5,17 +5,31 @@
 #pragma once
 
 #include "voxel/RawVolume.h"
+#include "voxel/DirtyBricks.h"
 
 namespace voxel {
 
 /**
  * @brief A wrapper for a RawVolume that performs a sanity check for the setVoxel call.
+ *
+ * The wrapper keeps track of the modified voxels - see @c dirtyRegion() for the bounding box of all
+ * modifications and @c dirtyBricks() for the set of modified bricks.
  */
 class RawVolumeWrapper {
 private:
 	RawVolume* _volume;
 	Region _region;
 	Region _dirtyRegion = Region::InvalidRegion;
+	DirtyBricks _dirtyBricks;
+
+	inline void markDirty(const glm::ivec3& pos) {
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(pos);
+		} else {
+			_dirtyRegion = Region(pos, pos);
+		}
+		_dirtyBricks.markVoxel(pos);
+	}
 
 public:
 	class Sampler : public RawVolume::Sampler {
@@ -37,11 +51,7 @@ public:
 				if (!_volume) {
 					return true;
 				}
-				if (_volume->_dirtyRegion.isValid()) {
-					_volume->_dirtyRegion.accumulate(position());
-				} else {
-					_volume->_dirtyRegion = Region(position(), position());
-				}
+				_volume->markDirty(position());
 				return true;
 			}
 			return false;
@@ -49,7 +59,7 @@ public:
 	};
 
 	RawVolumeWrapper(voxel::RawVolume* volume) :
-			_volume(volume), _region(volume->region()) {
+			_volume(volume), _region(volume->region()), _dirtyBricks(volume->region()) {
 	}
 
 	inline operator RawVolume& () const {
@@ -92,10 +102,21 @@ public:
 		return setVoxel(pos.x, pos.y, pos.z, voxel);
 	}
 
+	/**
+	 * @return The bounding box of all modified voxels
+	 */
 	inline const Region& dirtyRegion() const {
 		return _dirtyRegion;
 	}
 
+	/**
+	 * @return The bricks that contain modified voxels. Scattered modifications lead to a huge
+	 * @c dirtyRegion() - but only mark the bricks that were really touched.
+	 */
+	inline const DirtyBricks& dirtyBricks() const {
+		return _dirtyBricks;
+	}
+
 	/**
 	 * @return @c false if the voxel was not placed because the given position is outside of the valid region, @c
 	 * true if the voxel was placed in the region.
@@ -107,11 +128,7 @@ public:
 			return false;
 		}
 		if (_volume->setVoxel(p, voxel)) {
-			if (_dirtyRegion.isValid()) {
-				_dirtyRegion.accumulate(p);
-			} else {
-				_dirtyRegion = Region(p, p);
-			}
+			markDirty(p);
 		}
 		return true;
 	}
@@ -119,6 +136,7 @@ public:
 	void translate(const glm::ivec3& t) {
 		_volume->translate(t);
 		_dirtyRegion.shift(t.x, t.y, t.z);
+		_dirtyBricks.translate(t);
 	}
 
 	inline bool setVoxels(int x, int z, const Voxel* voxels, int amount) {
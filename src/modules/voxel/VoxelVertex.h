@@ -21,7 +21,7 @@ struct VoxelVertex {
 };
 static_assert(sizeof(VoxelVertex) == 8, "Unexpected size of the vertex struct");
 
-// TODO: maybe reduce to uint16_t and use glDrawElementsBaseVertex
+// @sa CompactMesh for 16 bit indices that are used with a base vertex
 typedef uint32_t IndexType;
 
 }
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include <glm/trigonometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <vector>
+
+static constexpr int ChunkSize = 32;
+static constexpr int ChunksPerSide = 8;
+
+/**
+ * @brief Compares the amount of triangles that are submitted for a grid of terrain chunks with and without
+ * skipping the faces that are pointing away from the camera.
+ */
+class FaceCullingBenchmark : public app::AbstractBenchmark {
+protected:
+	std::vector<voxel::Mesh> _meshes;
+	std::vector<glm::vec3> _eyes;
+
+	static int terrainHeight(int x, int z) {
+		return 8 + (int)(6.0f * glm::sin(x * 0.1f) * glm::cos(z * 0.13f) + 4.0f * glm::sin(z * 0.31f));
+	}
+
+public:
+	void onCleanupApp() override {
+	}
+
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+
+	void SetUp(::benchmark::State& state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_meshes.clear();
+		for (int cz = 0; cz < ChunksPerSide; ++cz) {
+			for (int cx = 0; cx < ChunksPerSide; ++cx) {
+				const glm::ivec3 mins(cx * ChunkSize, 0, cz * ChunkSize);
+				voxel::RawVolume volume(voxel::Region(mins, mins + ChunkSize - 1));
+				for (int z = 0; z < ChunkSize; ++z) {
+					for (int x = 0; x < ChunkSize; ++x) {
+						const int height = terrainHeight(mins.x + x, mins.z + z);
+						for (int y = 0; y < height; ++y) {
+							volume.setVoxel(mins.x + x, y, mins.z + z, voxel::createVoxel(voxel::VoxelType::Generic, (x + y) % 4));
+						}
+					}
+				}
+				voxel::Region region = volume.region();
+				region.shiftUpperCorner(1, 1, 1);
+				voxel::Mesh mesh(1024, 1024, true);
+				voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+				_meshes.emplace_back(core::move(mesh));
+			}
+		}
+		// a camera that circles over the terrain
+		_eyes.clear();
+		const float center = ChunksPerSide * ChunkSize * 0.5f;
+		for (int i = 0; i < 64; ++i) {
+			const float angle = glm::two_pi<float>() * (float)i / 64.0f;
+			_eyes.emplace_back(center + glm::cos(angle) * center * 0.8f, 24.0f, center + glm::sin(angle) * center * 0.8f);
+		}
+	}
+
+	void submit(::benchmark::State& state, bool faceCulling) {
+		size_t frames = 0u;
+		size_t triangles = 0u;
+		size_t allTriangles = 0u;
+		for (auto _ : state) {
+			const glm::vec3& eye = _eyes[frames % _eyes.size()];
+			for (const voxel::Mesh& mesh : _meshes) {
+				allTriangles += mesh.getNoOfIndices() / 3;
+				if (!faceCulling) {
+					triangles += mesh.getNoOfIndices() / 3;
+					continue;
+				}
+				const glm::vec3 mins(mesh.getOffset());
+				const uint8_t faceMask = voxel::visibleFaces(eye, mins, mins + (float)ChunkSize);
+				voxel::IndexRange ranges[voxel::FaceCount];
+				const int n = voxel::mergeFaceIndexRanges(mesh.faceIndexRanges(), faceMask, ranges);
+				for (int r = 0; r < n; ++r) {
+					triangles += ranges[r].count / 3;
+				}
+			}
+			++frames;
+		}
+		state.counters["triangles"] = ::benchmark::Counter((double)triangles / (double)frames);
+		state.counters["ratio"] = ::benchmark::Counter((double)triangles / (double)allTriangles);
+	}
+};
+
+BENCHMARK_DEFINE_F(FaceCullingBenchmark, AllFaces)(benchmark::State &state) {
+	submit(state, false);
+}
+
+BENCHMARK_DEFINE_F(FaceCullingBenchmark, VisibleFaces)(benchmark::State &state) {
+	submit(state, true);
+}
+
+BENCHMARK_REGISTER_F(FaceCullingBenchmark, AllFaces);
+BENCHMARK_REGISTER_F(FaceCullingBenchmark, VisibleFaces);
@@ -0,0 +1,181 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/CompactMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class CompactMeshTest: public app::AbstractTest {
+protected:
+	void extract(RawVolume& volume, Mesh& mesh) const {
+		Region region = volume.region();
+		region.shiftUpperCorner(1, 1, 1);
+		extractCubicMesh(&volume, region, &mesh, IsQuadNeeded(), region.getLowerCorner());
+	}
+
+	/**
+	 * @brief Each triangle of the decoded mesh must have the same vertices as the source mesh
+	 */
+	void checkRoundTrip(const Mesh& mesh, const CompactMesh& compact) const {
+		Mesh decoded;
+		compact.decode(decoded);
+		ASSERT_EQ(mesh.getNoOfIndices(), decoded.getNoOfIndices());
+		EXPECT_EQ(mesh.getOffset(), decoded.getOffset());
+		for (size_t i = 0u; i < mesh.getNoOfIndices(); ++i) {
+			const VoxelVertex& expected = mesh.getVertex(mesh.getIndex(i));
+			const VoxelVertex& actual = decoded.getVertex(decoded.getIndex(i));
+			ASSERT_EQ(expected.position, actual.position) << "index " << i;
+			ASSERT_EQ(expected.ambientOcclusion, actual.ambientOcclusion) << "index " << i;
+			ASSERT_EQ(expected.colorIndex, actual.colorIndex) << "index " << i;
+		}
+		ASSERT_EQ(mesh.hasFaceIndexRanges(), decoded.hasFaceIndexRanges());
+		ASSERT_EQ(mesh.hasFaceIndexRanges(), compact.hasFaceIndexRanges());
+		for (int face = 0; face < FaceCount; ++face) {
+			const IndexRange& range = decoded.faceIndexRange((FaceNames)face);
+			EXPECT_EQ(mesh.faceIndexRange((FaceNames)face).offset, range.offset);
+			EXPECT_EQ(mesh.faceIndexRange((FaceNames)face).count, range.count);
+		}
+	}
+};
+
+TEST_F(CompactMeshTest, testVertexPacking) {
+	const CompactVertex v(glm::ivec3(63, 127, 17), 2, FaceNames::NegativeZ, 255);
+	EXPECT_EQ(glm::ivec3(63, 127, 17), v.position());
+	EXPECT_EQ(2, v.ambientOcclusion());
+	EXPECT_EQ(FaceNames::NegativeZ, v.face());
+	EXPECT_EQ(255, v.colorIndex());
+
+	const CompactVertex v2(glm::ivec3(0), 3, FaceNames::PositiveX, 0);
+	EXPECT_EQ(glm::ivec3(0), v2.position());
+	EXPECT_EQ(3, v2.ambientOcclusion());
+	EXPECT_EQ(FaceNames::PositiveX, v2.face());
+	EXPECT_EQ(0, v2.colorIndex());
+}
+
+TEST_F(CompactMeshTest, testRoundTripSingleVoxel) {
+	RawVolume volume(Region(-4, 4));
+	volume.setVoxel(-1, 2, 3, createVoxel(VoxelType::Generic, 42));
+	Mesh mesh(128, 128, true);
+	extract(volume, mesh);
+	CompactMesh compact;
+	ASSERT_TRUE(compact.encode(mesh));
+	ASSERT_EQ(1u, compact.subMeshes().size());
+	EXPECT_EQ(glm::ivec3(-1, 2, 3), compact.subMeshes()[0].origin);
+	// each of the six faces has its own four vertices
+	EXPECT_EQ(24u, compact.vertices().size());
+	EXPECT_EQ(36u, compact.indices().size());
+	for (const CompactVertex& v : compact.vertices()) {
+		EXPECT_EQ(42, v.colorIndex());
+	}
+	checkRoundTrip(mesh, compact);
+}
+
+TEST_F(CompactMeshTest, testRoundTripTerrain) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(31, 126, 31)));
+	for (int x = 0; x < 32; ++x) {
+		for (int z = 0; z < 32; ++z) {
+			const int height = 40 + (x + z) / 4 + (x * 7 + z * 3) % 5;
+			for (int y = 0; y < height; ++y) {
+				volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, y / 8));
+			}
+		}
+	}
+	Mesh mesh(1024, 1024, true);
+	extract(volume, mesh);
+	CompactMesh compact;
+	ASSERT_TRUE(compact.encode(mesh));
+	// a chunk of the world renderer fits into one sub mesh
+	EXPECT_EQ(1u, compact.subMeshes().size());
+	const size_t meshSize = mesh.getNoOfVertices() * sizeof(VoxelVertex) + mesh.getNoOfIndices() * sizeof(IndexType);
+	EXPECT_LT(compact.size(), meshSize);
+	checkRoundTrip(mesh, compact);
+}
+
+TEST_F(CompactMeshTest, testWriteRead) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15, 15, 15)));
+	for (int x = 0; x < 16; ++x) {
+		for (int z = 0; z < 16; ++z) {
+			for (int y = 0; y < 4 + (x + z) % 3; ++y) {
+				volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, x % 4));
+			}
+		}
+	}
+	Mesh mesh(1024, 1024, true);
+	extract(volume, mesh);
+	mesh.setOffset(glm::ivec3(32, 0, -64));
+	CompactMesh compact;
+	ASSERT_TRUE(compact.encode(mesh));
+	std::vector<uint8_t> buf;
+	compact.write(buf);
+
+	CompactMesh loaded;
+	const uint8_t* p = buf.data();
+	ASSERT_TRUE(loaded.read(p, buf.data() + buf.size()));
+	EXPECT_EQ(buf.data() + buf.size(), p);
+	EXPECT_EQ(compact.size(), loaded.size());
+	EXPECT_EQ(compact.getOffset(), loaded.getOffset());
+	checkRoundTrip(mesh, loaded);
+
+	// truncated data is rejected
+	p = buf.data();
+	EXPECT_FALSE(loaded.read(p, buf.data() + buf.size() - 1));
+	EXPECT_TRUE(loaded.isEmpty());
+}
+
+TEST_F(CompactMeshTest, testSubMeshes) {
+	// wider than the max extent of a sub mesh
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(199, 3, 3)));
+	for (int x = 0; x < 200; x += 2) {
+		volume.setVoxel(x, 1, 1, createVoxel(VoxelType::Generic, x % 255));
+	}
+	Mesh mesh(1024, 1024, true);
+	extract(volume, mesh);
+	CompactMesh compact;
+	ASSERT_TRUE(compact.encode(mesh));
+	ASSERT_GT(compact.subMeshes().size(), 1u);
+	uint32_t indices = 0u;
+	for (const CompactSubMesh& subMesh : compact.subMeshes()) {
+		EXPECT_EQ(indices, subMesh.firstIndex);
+		indices += subMesh.indexCount;
+	}
+	EXPECT_EQ(compact.indices().size(), indices);
+	checkRoundTrip(mesh, compact);
+}
+
+TEST_F(CompactMeshTest, testTooBig) {
+	// the merged quads of this wall are too big for the packed positions
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(99, 2, 2)));
+	for (int x = 0; x < 100; ++x) {
+		volume.setVoxel(x, 1, 1, createVoxel(VoxelType::Generic, 1));
+	}
+	Mesh mesh(1024, 1024, true);
+	extract(volume, mesh);
+	CompactMesh compact;
+	EXPECT_FALSE(compact.encode(mesh));
+	EXPECT_TRUE(compact.isEmpty());
+}
+
+TEST_F(CompactMeshTest, testWithoutFaceRanges) {
+	Mesh mesh(16, 16, true);
+	VoxelVertex vertex;
+	vertex.colorIndex = 7;
+	for (int i = 0; i < 4; ++i) {
+		vertex.position = glm::i16vec3(100 + (i & 1) * 8, 20, 100 + (i >> 1) * 8);
+		mesh.addVertex(vertex);
+	}
+	mesh.addTriangle(0, 1, 2);
+	mesh.addTriangle(1, 3, 2);
+	ASSERT_FALSE(mesh.hasFaceIndexRanges());
+	CompactMesh compact;
+	ASSERT_TRUE(compact.encode(mesh));
+	// the vertices are shared between the triangles
+	EXPECT_EQ(4u, compact.vertices().size());
+	checkRoundTrip(mesh, compact);
+}
+
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/DirtyBricks.h"
+#include "voxel/RawVolumeWrapper.h"
+
+namespace voxel {
+
+class DirtyBricksTest: public app::AbstractTest {
+};
+
+TEST_F(DirtyBricksTest, testMarkVoxel) {
+	DirtyBricks bricks(Region(0, 63), 4);
+	EXPECT_TRUE(bricks.empty());
+	bricks.markVoxel(glm::ivec3(0, 0, 0));
+	bricks.markVoxel(glm::ivec3(15, 15, 15));
+	EXPECT_EQ(1, bricks.size());
+	EXPECT_TRUE(bricks.isDirty(glm::ivec3(0, 0, 0)));
+	bricks.markVoxel(glm::ivec3(63, 16, 0));
+	EXPECT_EQ(2, bricks.size());
+	EXPECT_TRUE(bricks.isDirty(glm::ivec3(3, 1, 0)));
+	EXPECT_FALSE(bricks.isDirty(glm::ivec3(1, 1, 0)));
+	// outside of the region
+	bricks.markVoxel(glm::ivec3(64, 0, 0));
+	EXPECT_EQ(2, bricks.size());
+	bricks.clear();
+	EXPECT_TRUE(bricks.empty());
+	EXPECT_FALSE(bricks.isDirty(glm::ivec3(0, 0, 0)));
+}
+
+TEST_F(DirtyBricksTest, testMarkRegion) {
+	DirtyBricks bricks(Region(-10, 40), 4);
+	bricks.markRegion(Region(-20, -9));
+	EXPECT_EQ(1, bricks.size());
+	bricks.markRegion(Region(glm::ivec3(-10, -10, -10), glm::ivec3(6, -10, -10)));
+	EXPECT_EQ(2, bricks.size());
+	EXPECT_TRUE(bricks.isDirty(glm::ivec3(1, 0, 0)));
+	int visited = 0;
+	bricks.visit([&] (const Region& region) {
+		EXPECT_EQ(-10, region.getLowerCorner().y);
+		++visited;
+	});
+	EXPECT_EQ(2, visited);
+}
+
+TEST_F(DirtyBricksTest, testBrickRegion) {
+	DirtyBricks bricks(Region(0, 19), 4);
+	EXPECT_EQ(Region(0, 15), bricks.brickRegion(glm::ivec3(0)));
+	// cropped to the tracked region
+	EXPECT_EQ(Region(16, 19), bricks.brickRegion(glm::ivec3(1)));
+}
+
+TEST_F(DirtyBricksTest, testWrapper) {
+	RawVolume v(Region(0, 63));
+	RawVolumeWrapper wrapper(&v);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	wrapper.setVoxel(0, 0, 0, voxel);
+	wrapper.setVoxel(63, 63, 63, voxel);
+	// the bounding box covers the whole volume - but only two bricks were touched
+	EXPECT_EQ(v.region(), wrapper.dirtyRegion());
+	EXPECT_EQ(2, wrapper.dirtyBricks().size());
+
+	// setting the same voxel again doesn't modify anything
+	RawVolumeWrapper wrapper2(&v);
+	wrapper2.setVoxel(0, 0, 0, voxel);
+	EXPECT_TRUE(wrapper2.dirtyBricks().empty());
+}
+
+}
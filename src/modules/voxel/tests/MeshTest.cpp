@@ -0,0 +1,152 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class MeshTest: public app::AbstractTest {
+protected:
+	/**
+	 * @brief Checks that every vertex of the given face range lies in a plane that is perpendicular to the face
+	 * direction
+	 */
+	void checkFacePlane(const Mesh& mesh, FaceNames face) const {
+		const IndexRange& range = mesh.faceIndexRange(face);
+		if (range.count == 0u) {
+			return;
+		}
+		const int axis = (face == FaceNames::PositiveX || face == FaceNames::NegativeX) ? 0 : (face == FaceNames::PositiveY || face == FaceNames::NegativeY) ? 1 : 2;
+		for (uint32_t i = range.offset; i < range.offset + range.count; i += 3u) {
+			const VoxelVertex& v0 = mesh.getVertex(mesh.getIndex(i + 0));
+			const VoxelVertex& v1 = mesh.getVertex(mesh.getIndex(i + 1));
+			const VoxelVertex& v2 = mesh.getVertex(mesh.getIndex(i + 2));
+			EXPECT_EQ(v0.position[axis], v1.position[axis]) << "face " << (int)face << " triangle " << i / 3;
+			EXPECT_EQ(v0.position[axis], v2.position[axis]) << "face " << (int)face << " triangle " << i / 3;
+		}
+	}
+};
+
+TEST_F(MeshTest, testFaceIndexRangesSingleVoxel) {
+	RawVolume volume(Region(0, 2));
+	volume.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	Region region = volume.region();
+	region.shiftUpperCorner(1, 1, 1);
+	Mesh mesh(128, 128, true);
+	extractCubicMesh(&volume, region, &mesh, IsQuadNeeded(), region.getLowerCorner());
+	ASSERT_EQ(36u, mesh.getNoOfIndices());
+	ASSERT_TRUE(mesh.hasFaceIndexRanges());
+	uint32_t offset = 0u;
+	for (int i = 0; i < FaceCount; ++i) {
+		const IndexRange& range = mesh.faceIndexRange((FaceNames)i);
+		EXPECT_EQ(offset, range.offset) << "face " << i;
+		EXPECT_EQ(6u, range.count) << "face " << i;
+		offset += range.count;
+		checkFacePlane(mesh, (FaceNames)i);
+	}
+	// the +x quad is on the upper side of the voxel, the -x quad on the lower side
+	EXPECT_EQ(2, mesh.getVertex(mesh.getIndex(mesh.faceIndexRange(FaceNames::PositiveX).offset)).position.x);
+	EXPECT_EQ(1, mesh.getVertex(mesh.getIndex(mesh.faceIndexRange(FaceNames::NegativeX).offset)).position.x);
+}
+
+TEST_F(MeshTest, testFaceIndexRangesCoverMesh) {
+	RawVolume volume(Region(0, 15));
+	for (int x = 0; x < 16; ++x) {
+		for (int z = 0; z < 16; ++z) {
+			const int height = 1 + (x * 7 + z * 3) % 9;
+			for (int y = 0; y < height; ++y) {
+				volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, (x + z) % 4));
+			}
+		}
+	}
+	Region region = volume.region();
+	region.shiftUpperCorner(1, 1, 1);
+	Mesh mesh(1024, 1024, true);
+	extractCubicMesh(&volume, region, &mesh, IsQuadNeeded(), region.getLowerCorner());
+	ASSERT_TRUE(mesh.hasFaceIndexRanges());
+	for (int i = 0; i < FaceCount; ++i) {
+		EXPECT_GT(mesh.faceIndexRange((FaceNames)i).count, 0u) << "face " << i;
+		checkFacePlane(mesh, (FaceNames)i);
+	}
+
+	// the compressed indices keep the order - so the ranges are valid for them, too
+	ASSERT_NE(nullptr, mesh.compressedIndices());
+	const size_t bytesPerIndex = mesh.compressedIndexSize();
+	ASSERT_LT(bytesPerIndex, sizeof(IndexType));
+	const IndexRange& range = mesh.faceIndexRange(FaceNames::NegativeZ);
+	const uint8_t* compressed = mesh.compressedIndices() + range.offset * bytesPerIndex;
+	for (uint32_t i = 0u; i < range.count; ++i) {
+		IndexType index = 0u;
+		core_memcpy(&index, compressed + i * bytesPerIndex, bytesPerIndex);
+		EXPECT_EQ(mesh.getIndex(range.offset + i), index);
+	}
+}
+
+TEST_F(MeshTest, testFaceIndexRangesClear) {
+	RawVolume volume(Region(0, 2));
+	volume.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	Mesh mesh(128, 128, true);
+	extractCubicMesh(&volume, volume.region(), &mesh, IsQuadNeeded(), volume.region().getLowerCorner());
+	ASSERT_TRUE(mesh.hasFaceIndexRanges());
+	Mesh copy(mesh);
+	EXPECT_TRUE(copy.hasFaceIndexRanges());
+	mesh.clear();
+	EXPECT_FALSE(mesh.hasFaceIndexRanges());
+	for (int i = 0; i < FaceCount; ++i) {
+		EXPECT_EQ(0u, mesh.faceIndexRange((FaceNames)i).count);
+	}
+}
+
+TEST_F(MeshTest, testVisibleFaces) {
+	const glm::vec3 mins(0.0f);
+	const glm::vec3 maxs(16.0f);
+	// in front of the +x side
+	const uint8_t mask = visibleFaces(glm::vec3(20.0f, 8.0f, 8.0f), mins, maxs);
+	EXPECT_EQ(faceBit(FaceNames::PositiveX), mask & (faceBit(FaceNames::PositiveX) | faceBit(FaceNames::NegativeX)));
+	// inside of the box in y and z - quads of both directions might be visible
+	EXPECT_NE(0u, mask & faceBit(FaceNames::PositiveY));
+	EXPECT_NE(0u, mask & faceBit(FaceNames::NegativeY));
+	EXPECT_NE(0u, mask & faceBit(FaceNames::PositiveZ));
+	EXPECT_NE(0u, mask & faceBit(FaceNames::NegativeZ));
+
+	const uint8_t outside = visibleFaces(glm::vec3(-1.0f, 20.0f, 30.0f), mins, maxs);
+	EXPECT_EQ(faceBit(FaceNames::NegativeX) | faceBit(FaceNames::PositiveY) | faceBit(FaceNames::PositiveZ), outside);
+}
+
+TEST_F(MeshTest, testMergeFaceIndexRanges) {
+	IndexRange faces[FaceCount];
+	uint32_t offset = 0u;
+	for (int i = 0; i < FaceCount; ++i) {
+		faces[i].offset = offset;
+		faces[i].count = 6u * (i + 1);
+		offset += faces[i].count;
+	}
+	IndexRange out[FaceCount];
+	// all faces are one consecutive range
+	ASSERT_EQ(1, mergeFaceIndexRanges(faces, 0xff, out));
+	EXPECT_EQ(0u, out[0].offset);
+	EXPECT_EQ(offset, out[0].count);
+
+	// +x, +y and -x: +x and +y follow each other
+	const uint8_t mask = faceBit(FaceNames::PositiveX) | faceBit(FaceNames::PositiveY) | faceBit(FaceNames::NegativeX);
+	ASSERT_EQ(2, mergeFaceIndexRanges(faces, mask, out));
+	EXPECT_EQ(0u, out[0].offset);
+	EXPECT_EQ(faces[0].count + faces[1].count, out[0].count);
+	EXPECT_EQ(faces[3].offset, out[1].offset);
+	EXPECT_EQ(faces[3].count, out[1].count);
+
+	// empty faces don't split the ranges
+	faces[1].count = 0u;
+	faces[2].offset = faces[1].offset;
+	const uint8_t mask2 = faceBit(FaceNames::PositiveX) | faceBit(FaceNames::PositiveZ);
+	ASSERT_EQ(1, mergeFaceIndexRanges(faces, mask2, out));
+	EXPECT_EQ(faces[0].count + faces[2].count, out[0].count);
+
+	EXPECT_EQ(0, mergeFaceIndexRanges(faces, 0u, out));
+}
+
+}
@@ -10,88 +10,80 @@
 #include "io/Filesystem.h"
 #include "app/App.h"
 #include "core/Log.h"
+#include "core/Var.h"
 #include "core/Assert.h"
 #include "voxel/CubicSurfaceExtractor.h"
 
 namespace voxelformat {
 
+static size_t meshSize(const voxel::Mesh& mesh) {
+	return mesh.getNoOfVertices() * sizeof(voxel::VoxelVertex) + mesh.getNoOfIndices() * sizeof(voxel::IndexType);
+}
+
+MeshCache::MeshCache() :
+		_meshes(loadMesh, meshSize) {
+}
+
 MeshCache::~MeshCache() {
 	core_assert_msg(_initCalls == 0, "MeshCache wasn't shut down properly: %i", _initCalls);
 }
 
-voxel::Mesh& MeshCache::cacheEntry(const char *fullPath) {
-	auto i = _meshes.find(fullPath);
-	if (i == _meshes.end()) {
-		voxel::Mesh* mesh = new voxel::Mesh();
-		_meshes.put(fullPath, mesh);
-		Log::debug("New mesh cache entry for path %s", fullPath);
-		return *mesh;
-	}
-	return *i->second;
+bool MeshCache::removeMesh(const char *fullPath) {
+	return _meshes.remove(fullPath);
 }
 
-bool MeshCache::removeMesh(const char *fullPath) {
-	auto i = _meshes.find(fullPath);
-	if (i != _meshes.end()) {
-		delete i->second;
-		_meshes.erase(i);
-		return true;
-	}
-	return false;
+MeshCache::MeshPtr MeshCache::getMesh(const char *fullPath) {
+	return _meshes.get(fullPath);
 }
 
-const voxel::Mesh* MeshCache::getMesh(const char *fullPath) {
-	voxel::Mesh &cachedMesh = cacheEntry(fullPath);
-	if (cachedMesh.getNoOfVertices() > 0) {
-		return &cachedMesh;
-	}
-	if (loadMesh(fullPath, cachedMesh)) {
-		return &cachedMesh;
-	}
-	return nullptr;
+MeshCache::MeshFuture MeshCache::loadAsync(const char *fullPath, core::ThreadPool& threadPool) {
+	return _meshes.loadAsync(fullPath, threadPool);
 }
 
-bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
-	Log::debug("Loading volume from %s", fullPath);
+voxel::Mesh* MeshCache::loadMesh(const core::String& fullPath) {
+	Log::debug("Loading volume from %s", fullPath.c_str());
 	const io::FilesystemPtr& fs = io::filesystem();
 	io::FilePtr file;
 
 	for (const char **ext = SUPPORTED_VOXEL_FORMATS_LOAD_LIST; *ext; ++ext) {
-		file = fs->open(core::string::format("%s.%s", fullPath, *ext));
+		file = fs->open(core::string::format("%s.%s", fullPath.c_str(), *ext));
 		if (file->exists()) {
 			break;
 		}
 	}
 	if (!file->exists()) {
-		Log::error("Failed to load %s for any of the supported format extensions", fullPath);
-		return false;
+		Log::error("Failed to load %s for any of the supported format extensions", fullPath.c_str());
+		return nullptr;
 	}
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(file, volumes)) {
 		Log::error("Failed to load %s", file->name().c_str());
 		voxelformat::clearVolumes(volumes);
-		return false;
+		return nullptr;
 	}
 	if ((int)volumes.size() != 1) {
 		Log::error("More than one volume/layer found in %s", file->name().c_str());
 		voxelformat::clearVolumes(volumes);
-		return false;
+		return nullptr;
 	}
 
 	voxel::RawVolume* volume = volumes[0].volume;
 	voxel::Region region = volume->region();
 	region.shiftUpperCorner(1, 1, 1);
-	voxel::extractCubicMesh(volume, region, &mesh, [] (const voxel::VoxelType& back, const voxel::VoxelType& front, voxel::FaceNames face) {
+	voxel::Mesh* mesh = new voxel::Mesh();
+	voxel::extractCubicMesh(volume, region, mesh, [] (const voxel::VoxelType& back, const voxel::VoxelType& front, voxel::FaceNames face) {
 		return isBlocked(back) && !isBlocked(front);
 	}, region.getLowerCorner());
 	delete volume;
 
-	Log::info("Generated mesh for %s", fullPath);
-	return true;
+	Log::info("Generated mesh for %s", fullPath.c_str());
+	return mesh;
 }
 
 bool MeshCache::init() {
 	++_initCalls;
+	const int budgetMB = core::Var::get("voxformat_meshcachesize", "64", core::CV_NOPERSIST)->intVal();
+	_meshes.setMemoryBudget((size_t)core_max(0, budgetMB) * 1024u * 1024u);
 	return true;
 }
 
@@ -103,9 +95,6 @@ void MeshCache::shutdown() {
 	if (_initCalls > 0) {
 		return;
 	}
-	for (const auto & e : _meshes) {
-		delete e->value;
-	}
 	_meshes.clear();
 }
 
@@ -7,26 +7,41 @@
 #include "voxel/Mesh.h"
 #include "core/IComponent.h"
 #include "core/StringUtil.h"
-#include "core/collection/StringMap.h"
+#include "core/concurrent/AsyncCache.h"
 #include <memory>
 
 namespace voxelformat {
 
 /**
  * @brief Cache @c voxel::Mesh instances by their name
- * @note The cache is @b not threadsafe
- * @sa MeshCache
+ * @note The cache is threadsafe - every mesh is only extracted once, even if several threads
+ * ask for it at the same time.
+ * @note The meshes that are no longer referenced are evicted (least recently used first)
+ * once the memory budget that is configured by the cvar @c voxformat_meshcachesize is exceeded.
+ * @sa VolumeCache
+ * @sa core::AsyncCache
  */
 class MeshCache : public core::IComponent {
+public:
+	using MeshPtr = std::shared_ptr<voxel::Mesh>;
+	using MeshFuture = core::AsyncCache<voxel::Mesh>::Future;
 protected:
-	core::StringMap<voxel::Mesh*> _meshes;
+	core::AsyncCache<voxel::Mesh> _meshes;
 	int _initCalls = 0;
 
-	voxel::Mesh& cacheEntry(const char *fullPath);
-	bool loadMesh(const char* fullPath, voxel::Mesh& mesh);
+	static voxel::Mesh* loadMesh(const core::String& fullPath);
 public:
+	MeshCache();
 	~MeshCache();
-	const voxel::Mesh* getMesh(const char *fullPath);
+	/**
+	 * The returned mesh is shared with the cache - keep the reference as long as you are using it.
+	 * @return @c nullptr if the mesh could not get loaded
+	 */
+	MeshPtr getMesh(const char *fullPath);
+	/**
+	 * @brief Load and extract the mesh on the given thread pool. Use this to preload meshes that are needed later.
+	 */
+	MeshFuture loadAsync(const char *fullPath, core::ThreadPool& threadPool);
 	bool removeMesh(const char *fullPath);
 	bool init() override;
 	void shutdown() override;
@@ -7,6 +7,7 @@
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "io/BufferedFileWriter.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
@@ -37,8 +38,9 @@ void OBJFormat::writeMtlFile(const core::String& mtlName) const {
 	stream.addStringFormat(false, "map_Kd palette-%s.png\n", voxel::getDefaultPaletteName());
 }
 
-bool OBJFormat::saveMeshes(const Meshes& meshes, const io::FilePtr &file, float scale, bool quad, bool withColor, bool withTexCoords) {
+bool OBJFormat::saveMeshes(const VoxelVolumes& volumes, const io::FilePtr &file, const MeshSettings& settings) {
 	io::FileStream stream(file);
+	io::BufferedFileWriter writer(stream);
 
 	const MaterialColorArray& colors = getMaterialColors();
 
@@ -46,20 +48,20 @@ bool OBJFormat::saveMeshes(const Meshes& meshes, const io::FilePtr &file, float
 	const float texcoord = 1.0f / (float)colors.size();
 	// it is only 1 pixel high - sample the middle
 	const float v1 = 0.5f;
+	const float scale = settings.scale;
 
-	stream.addStringFormat(false, "# version " PROJECT_VERSION " github.com/mgerhardy/engine\n");
-	stream.addStringFormat(false, "\n");
-	stream.addStringFormat(false, "g Model\n");
+	writer.addString("# version " PROJECT_VERSION " github.com/mgerhardy/engine\n");
+	writer.addString("\n");
+	writer.addString("g Model\n");
 
-	Log::debug("Exporting %i layers", (int)meshes.size());
+	Log::debug("Exporting %i layers", (int)volumes.size());
 
 	int idxOffset = 0;
 	int texcoordOffset = 0;
-	for (const auto& meshExt : meshes) {
+	const bool state = visitMeshes(volumes, settings, [&] (const MeshExt& meshExt) {
 		const voxel::Mesh* mesh = meshExt.mesh;
-		Log::debug("Exporting layer %s", meshExt.name.c_str());
-		const int nv = mesh->getNoOfVertices();
-		const int ni = mesh->getNoOfIndices();
+		const int nv = (int)mesh->getNoOfVertices();
+		const int ni = (int)mesh->getNoOfIndices();
 		if (ni % 3 != 0) {
 			Log::error("Unexpected indices amount");
 			return false;
@@ -67,77 +69,80 @@ bool OBJFormat::saveMeshes(const Meshes& meshes, const io::FilePtr &file, float
 		const glm::vec3 offset(mesh->getOffset());
 		const voxel::VoxelVertex* vertices = mesh->getRawVertexData();
 		const voxel::IndexType* indices = mesh->getRawIndexData();
-		const char *objectName = meshExt.name.c_str();
-		if (objectName[0] == '\0') {
-			objectName = "Noname";
+		if (meshExt.firstTile) {
+			Log::debug("Exporting layer %s", meshExt.name.c_str());
+			const char *objectName = meshExt.name.c_str();
+			if (objectName[0] == '\0') {
+				objectName = "Noname";
+			}
+			writer.addString("o ");
+			writer.addString(objectName);
+			writer.addString("\nmtllib palette.mtl\nusemtl palette\n");
 		}
-		stream.addStringFormat(false, "o %s\n", objectName);
-		stream.addStringFormat(false, "mtllib palette.mtl\n");
-		stream.addStringFormat(false, "usemtl palette\n");
 
 		for (int i = 0; i < nv; ++i) {
 			const voxel::VoxelVertex& v = vertices[i];
-			stream.addStringFormat(false, "v %.04f %.04f %.04f",
-					(offset.x + (float)v.position.x) * scale, (offset.y + (float)v.position.y) * scale, (offset.z + (float)v.position.z) * scale);
-			if (withColor) {
+			writer.addString("v ", 2);
+			writer.addFloat((offset.x + (float)v.position.x) * scale, 4);
+			writer.addChar(' ');
+			writer.addFloat((offset.y + (float)v.position.y) * scale, 4);
+			writer.addChar(' ');
+			writer.addFloat((offset.z + (float)v.position.z) * scale, 4);
+			if (settings.withColor) {
 				const glm::vec4& color = colors[v.colorIndex];
-				stream.addStringFormat(false, " %.03f %.03f %.03f", color.r, color.g, color.b);
+				writer.addChar(' ');
+				writer.addFloat(color.r, 3);
+				writer.addChar(' ');
+				writer.addFloat(color.g, 3);
+				writer.addChar(' ');
+				writer.addFloat(color.b, 3);
 			}
-			stream.addStringFormat(false, "\n");
+			writer.addChar('\n');
 		}
 
-		if (quad) {
-			if (withTexCoords) {
-				for (int i = 0; i < ni; i += 6) {
-					const voxel::VoxelVertex& v = vertices[indices[i]];
-					const float u = ((float)(v.colorIndex) + 0.5f) * texcoord;
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-				}
-			}
-
-			int uvi = texcoordOffset;
-			for (int i = 0; i < ni; i += 6, uvi += 4) {
-				const uint32_t one   = idxOffset + indices[i + 0] + 1;
-				const uint32_t two   = idxOffset + indices[i + 1] + 1;
-				const uint32_t three = idxOffset + indices[i + 2] + 1;
-				const uint32_t four  = idxOffset + indices[i + 5] + 1;
-				if (withTexCoords) {
-					stream.addStringFormat(false, "f %i/%i %i/%i %i/%i %i/%i\n",
-						(int)one, uvi + 1, (int)two, uvi + 2, (int)three, uvi + 3, (int)four, uvi + 4);
-				} else {
-					stream.addStringFormat(false, "f %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
-				}
-			}
-			texcoordOffset += ni / 6 * 4;
-		} else {
-			if (withTexCoords) {
-				for (int i = 0; i < ni; i += 3) {
-					const voxel::VoxelVertex& v = vertices[indices[i]];
-					const float u = ((float)(v.colorIndex) + 0.5f) * texcoord;
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
-					stream.addStringFormat(false, "vt %f %f\n", u, v1);
+		// quads are made of two triangles - we export the first three and the last vertex of the quad
+		const int indicesPerFace = settings.quads ? 6 : 3;
+		const int verticesPerFace = settings.quads ? 4 : 3;
+		if (settings.withTexCoords) {
+			for (int i = 0; i < ni; i += indicesPerFace) {
+				const voxel::VoxelVertex& v = vertices[indices[i]];
+				const float u = ((float)(v.colorIndex) + 0.5f) * texcoord;
+				for (int j = 0; j < verticesPerFace; ++j) {
+					writer.addString("vt ", 3);
+					writer.addFloat(u);
+					writer.addChar(' ');
+					writer.addFloat(v1);
+					writer.addChar('\n');
 				}
 			}
+		}
 
-			for (int i = 0; i < ni; i += 3) {
-				const uint32_t one   = idxOffset + indices[i + 0] + 1;
-				const uint32_t two   = idxOffset + indices[i + 1] + 1;
-				const uint32_t three = idxOffset + indices[i + 2] + 1;
-				if (withTexCoords) {
-					stream.addStringFormat(false, "f %i/%i %i/%i %i/%i\n", (int)one,
-							texcoordOffset + i + 1, (int)two, texcoordOffset + i + 2, (int)three, texcoordOffset + i + 3);
-				} else {
-					stream.addStringFormat(false, "f %i %i %i\n", (int)one, (int)two, (int)three);
+		int uvi = texcoordOffset;
+		for (int i = 0; i < ni; i += indicesPerFace, uvi += verticesPerFace) {
+			const uint32_t faceIndices[] = {
+				idxOffset + indices[i + 0] + 1,
+				idxOffset + indices[i + 1] + 1,
+				idxOffset + indices[i + 2] + 1,
+				idxOffset + indices[i + indicesPerFace - 1] + 1
+			};
+			writer.addChar('f');
+			for (int j = 0; j < verticesPerFace; ++j) {
+				writer.addChar(' ');
+				writer.addInt(faceIndices[j]);
+				if (settings.withTexCoords) {
+					writer.addChar('/');
+					writer.addInt(uvi + j + 1);
 				}
 			}
-			texcoordOffset += ni;
-
+			writer.addChar('\n');
 		}
+		texcoordOffset += ni / indicesPerFace * verticesPerFace;
 		idxOffset += nv;
+		return !writer.error();
+	});
+	if (!state || !writer.flush()) {
+		Log::error("Failed to write obj file %s", file->name().c_str());
+		return false;
 	}
 
 	core::String name = file->name();
@@ -16,6 +16,6 @@ class OBJFormat : public MeshExporter {
 private:
 	void writeMtlFile(const core::String& mtlName) const;
 public:
-	bool saveMeshes(const Meshes& meshes, const io::FilePtr& file, float scale, bool quad, bool withColor, bool withTexCoords) override;
+	bool saveMeshes(const VoxelVolumes& volumes, const io::FilePtr& file, const MeshSettings& settings) override;
 };
 }
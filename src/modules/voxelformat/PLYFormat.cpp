@@ -5,6 +5,7 @@
 #include "PLYFormat.h"
 #include "core/Log.h"
 #include "core/Var.h"
+#include "io/BufferedFileWriter.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "voxel/MaterialColor.h"
@@ -12,106 +13,183 @@
 #include "voxel/Mesh.h"
 #include "voxelformat/VoxelVolumes.h"
 #include "engine-config.h"
+#include <SDL_stdinc.h>
 
 namespace voxel {
 
-bool PLYFormat::saveMeshes(const Meshes& meshes, const io::FilePtr &file, float scale, bool quad, bool withColor, bool withTexCoords) {
+bool PLYFormat::saveMeshes(const VoxelVolumes& volumes, const io::FilePtr &file, const MeshSettings& settings) {
 	io::FileStream stream(file);
+	io::BufferedFileWriter writer(stream);
 
-	stream.addStringFormat(false, "ply\nformat ascii 1.0\n");
-	stream.addStringFormat(false, "comment version " PROJECT_VERSION " github.com/mgerhardy/engine\n");
-	stream.addStringFormat(false, "comment TextureFile palette-%s.png\n", voxel::getDefaultPaletteName());
-
-	int elements = 0;
-	int indices = 0;
-	for (const auto& meshExt : meshes) {
-		const voxel::Mesh& mesh = *meshExt.mesh;
-		elements += mesh.getNoOfVertices();
-		indices += mesh.getNoOfIndices();
+	writer.addString("ply\n");
+	if (settings.binary) {
+		writer.addString("format binary_little_endian 1.0\n");
+	} else {
+		writer.addString("format ascii 1.0\n");
 	}
+	writer.addString("comment version " PROJECT_VERSION " github.com/mgerhardy/engine\n");
+	writer.addString("comment TextureFile palette-");
+	writer.addString(voxel::getDefaultPaletteName());
+	writer.addString(".png\n");
 
-	stream.addStringFormat(false, "element vertex %i\n", elements);
-	stream.addStringFormat(false, "property float x\n");
-	stream.addStringFormat(false, "property float z\n");
-	stream.addStringFormat(false, "property float y\n");
-	if (withTexCoords) {
-		stream.addStringFormat(false, "property float s\n");
-		stream.addStringFormat(false, "property float t\n");
-	}
-	if (withColor) {
-		stream.addStringFormat(false, "property uchar red\n");
-		stream.addStringFormat(false, "property uchar green\n");
-		stream.addStringFormat(false, "property uchar blue\n");
-	}
+	// the amount of vertices and faces is only known after all tiles were extracted - we
+	// reserve space for the numbers here and patch the header once we are done
+	const int elementCountWidth = 10;
+	char countPlaceholder[elementCountWidth + 1];
+	SDL_memset(countPlaceholder, ' ', elementCountWidth);
+	countPlaceholder[elementCountWidth] = '\0';
 
-	int faces;
-	if (quad) {
-		faces = indices / 6;
-	} else {
-		faces = indices / 3;
+	writer.addString("element vertex ");
+	writer.flush();
+	const int64_t vertexCountPos = stream.pos();
+	writer.addString(countPlaceholder);
+	writer.addString("\nproperty float x\n");
+	writer.addString("property float z\n");
+	writer.addString("property float y\n");
+	if (settings.withTexCoords) {
+		writer.addString("property float s\n");
+		writer.addString("property float t\n");
+	}
+	if (settings.withColor) {
+		writer.addString("property uchar red\n");
+		writer.addString("property uchar green\n");
+		writer.addString("property uchar blue\n");
 	}
 
-	stream.addStringFormat(false, "element face %i\n", faces);
-	stream.addStringFormat(false, "property list uchar uint vertex_indices\n");
-	stream.addStringFormat(false, "end_header\n");
+	writer.addString("element face ");
+	writer.flush();
+	const int64_t faceCountPos = stream.pos();
+	writer.addString(countPlaceholder);
+	writer.addString("\nproperty list uchar uint vertex_indices\n");
+	writer.addString("end_header\n");
 
 	const MaterialColorArray& colors = getMaterialColors();
 	// 1 x 256 is the texture format that we are using for our palette
 	const float texcoord = 1.0f / (float)colors.size();
 	// it is only 1 pixel high - sample the middle
 	const float v1 = 0.5f;
+	const float scale = settings.scale;
+	const bool binary = settings.binary;
 
-	for (const auto& meshExt : meshes) {
+	// ply wants all vertices before the faces - to keep the memory bounded we don't keep
+	// the meshes around, but extract them a second time for writing the faces
+	int64_t vertexCount = 0;
+	int64_t faceCount = 0;
+	bool state = visitMeshes(volumes, settings, [&] (const MeshExt& meshExt) {
 		const voxel::Mesh& mesh = *meshExt.mesh;
 		const glm::vec3 offset(mesh.getOffset());
-		const int nv = mesh.getNoOfVertices();
+		const int nv = (int)mesh.getNoOfVertices();
+		const int ni = (int)mesh.getNoOfIndices();
+		if (ni % 3 != 0) {
+			Log::error("Unexpected indices amount");
+			return false;
+		}
 		const voxel::VoxelVertex* vertices = mesh.getRawVertexData();
 
 		for (int i = 0; i < nv; ++i) {
 			const voxel::VoxelVertex& v = vertices[i];
+			const float x = (offset.x + (float)v.position.x) * scale;
+			const float y = (offset.y + (float)v.position.y) * scale;
+			const float z = -(offset.z + (float)v.position.z) * scale;
+			const float u = ((float)(v.colorIndex) + 0.5f) * texcoord;
 			const glm::vec4& color = colors[v.colorIndex];
-			stream.addStringFormat(false, "%f %f %f",
-				(offset.x + (float)v.position.x) * scale, (offset.y + (float)v.position.y) * scale, -(offset.z + (float)v.position.z) * scale);
-			if (withTexCoords) {
-				const float u = ((float)(v.colorIndex) + 0.5f) * texcoord;
-				stream.addStringFormat(false, " %f %f", u, v1);
+			const uint8_t r = (uint8_t)(color.r * 255.0f);
+			const uint8_t g = (uint8_t)(color.g * 255.0f);
+			const uint8_t b = (uint8_t)(color.b * 255.0f);
+			if (binary) {
+				writer.addBinaryFloat(x);
+				writer.addBinaryFloat(y);
+				writer.addBinaryFloat(z);
+				if (settings.withTexCoords) {
+					writer.addBinaryFloat(u);
+					writer.addBinaryFloat(v1);
+				}
+				if (settings.withColor) {
+					writer.addByte(r);
+					writer.addByte(g);
+					writer.addByte(b);
+				}
+				continue;
 			}
-			if (withColor) {
-				stream.addStringFormat(false, " %u %u %u",
-					(uint8_t)(color.r * 255.0f), (uint8_t)(color.g * 255.0f), (uint8_t)(color.b * 255.0f));
+			writer.addFloat(x);
+			writer.addChar(' ');
+			writer.addFloat(y);
+			writer.addChar(' ');
+			writer.addFloat(z);
+			if (settings.withTexCoords) {
+				writer.addChar(' ');
+				writer.addFloat(u);
+				writer.addChar(' ');
+				writer.addFloat(v1);
 			}
-			stream.addStringFormat(false, "\n");
+			if (settings.withColor) {
+				writer.addChar(' ');
+				writer.addInt(r);
+				writer.addChar(' ');
+				writer.addInt(g);
+				writer.addChar(' ');
+				writer.addInt(b);
+			}
+			writer.addChar('\n');
 		}
+		vertexCount += nv;
+		faceCount += settings.quads ? ni / 6 : ni / 3;
+		return !writer.error();
+	});
+
+	int64_t idxOffset = 0;
+	if (state) {
+		state = visitMeshes(volumes, settings, [&] (const MeshExt& meshExt) {
+			const voxel::Mesh& mesh = *meshExt.mesh;
+			const int ni = (int)mesh.getNoOfIndices();
+			const voxel::IndexType* indices = mesh.getRawIndexData();
+			// quads are made of two triangles - we export the first three and the last vertex of the quad
+			const int indicesPerFace = settings.quads ? 6 : 3;
+			const uint8_t verticesPerFace = settings.quads ? 4 : 3;
+			for (int i = 0; i < ni; i += indicesPerFace) {
+				const uint32_t faceIndices[] = {
+					(uint32_t)(idxOffset + indices[i + 0]),
+					(uint32_t)(idxOffset + indices[i + 1]),
+					(uint32_t)(idxOffset + indices[i + 2]),
+					(uint32_t)(idxOffset + indices[i + indicesPerFace - 1])
+				};
+				if (binary) {
+					writer.addByte(verticesPerFace);
+					for (uint8_t j = 0; j < verticesPerFace; ++j) {
+						writer.addBinaryInt(faceIndices[j]);
+					}
+					continue;
+				}
+				writer.addInt(verticesPerFace);
+				for (uint8_t j = 0; j < verticesPerFace; ++j) {
+					writer.addChar(' ');
+					writer.addInt(faceIndices[j]);
+				}
+				writer.addChar('\n');
+			}
+			idxOffset += (int64_t)mesh.getNoOfVertices();
+			return !writer.error();
+		});
 	}
 
-	int idxOffset = 0;
-	for (const auto& meshExt : meshes) {
-		const voxel::Mesh& mesh = *meshExt.mesh;
-		const int ni = mesh.getNoOfIndices();
-		const int nv = mesh.getNoOfVertices();
-		if (ni % 3 != 0) {
-			Log::error("Unexpected indices amount");
+	if (!state || !writer.flush()) {
+		Log::error("Failed to write ply file %s", file->name().c_str());
+		return false;
+	}
+
+	const int64_t endPos = stream.pos();
+	char buf[io::BufferedFileWriter::MaxNumberLength];
+	const int64_t counts[] = { vertexCount, faceCount };
+	const int64_t countPositions[] = { vertexCountPos, faceCountPos };
+	for (int i = 0; i < 2; ++i) {
+		// the number is left aligned - parsers skip the trailing whitespaces
+		const int length = io::BufferedFileWriter::formatInt(buf, counts[i]);
+		if (length > elementCountWidth || stream.seek(countPositions[i]) != 0 || !stream.append((const uint8_t*)buf, length)) {
+			Log::error("Failed to write ply header for %s", file->name().c_str());
 			return false;
 		}
-		const voxel::IndexType* indices = mesh.getRawIndexData();
-		if (quad) {
-			for (int i = 0; i < ni; i += 6) {
-				const uint32_t one   = idxOffset + indices[i + 0];
-				const uint32_t two   = idxOffset + indices[i + 1];
-				const uint32_t three = idxOffset + indices[i + 2];
-				const uint32_t four  = idxOffset + indices[i + 5];
-				stream.addStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
-			}
-		} else {
-			for (int i = 0; i < ni; i += 3) {
-				const uint32_t one   = idxOffset + indices[i + 0];
-				const uint32_t two   = idxOffset + indices[i + 1];
-				const uint32_t three = idxOffset + indices[i + 2];
-				stream.addStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
-			}
-		}
-		idxOffset += nv;
 	}
+	stream.seek(endPos);
 	return true;
 }
 
@@ -9,89 +9,76 @@
 #include "app/App.h"
 #include "command/Command.h"
 #include "core/Log.h"
+#include "core/Var.h"
 
 namespace voxelformat {
 
+static size_t volumeSize(const voxel::RawVolume& volume) {
+	return (size_t)volume.region().voxels() * sizeof(voxel::Voxel);
+}
+
+VolumeCache::VolumeCache() :
+		_volumes(load, volumeSize) {
+}
+
 VolumeCache::~VolumeCache() {
-	core_assert_msg(_volumes.empty(), "VolumeCache wasn't shut down properly");
+	core_assert_msg(_volumes.size() == 0u, "VolumeCache wasn't shut down properly");
 }
 
-voxel::RawVolume* VolumeCache::loadVolume(const char* fullPath) {
-	const core::String filename = fullPath;
-	{
-		core::ScopedLock lock(_mutex);
-		auto i = _volumes.find(filename);
-		if (i != _volumes.end()) {
-			return i->second;
-		}
-	}
-	Log::info("Loading volume from %s", fullPath);
+voxel::RawVolume* VolumeCache::load(const core::String& fullPath) {
+	Log::info("Loading volume from %s", fullPath.c_str());
 	const io::FilesystemPtr& fs = io::filesystem();
 
 	io::FilePtr file;
 	for (const char **ext = SUPPORTED_VOXEL_FORMATS_LOAD_LIST; *ext; ++ext) {
-		file = fs->open(core::string::format("%s.%s", fullPath, *ext));
+		file = fs->open(core::string::format("%s.%s", fullPath.c_str(), *ext));
 		if (file->exists()) {
 			break;
 		}
 	}
 	if (!file->exists()) {
-		Log::error("Failed to load %s for any of the supported format extensions", fullPath);
+		Log::error("Failed to load %s for any of the supported format extensions", fullPath.c_str());
 		return nullptr;
 	}
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(file, volumes)) {
 		Log::error("Failed to load %s", file->name().c_str());
 		voxelformat::clearVolumes(volumes);
-		core::ScopedLock lock(_mutex);
-		_volumes.put(filename, nullptr);
 		return nullptr;
 	}
 	voxel::RawVolume* v = volumes.merge();
 	voxelformat::clearVolumes(volumes);
-
-	core::ScopedLock lock(_mutex);
-	_volumes.put(filename, v);
 	return v;
 }
 
+VolumeCache::VolumePtr VolumeCache::loadVolume(const char* fullPath) {
+	return _volumes.get(fullPath);
+}
+
 bool VolumeCache::removeVolume(const char* fullPath) {
-	const core::String filename = fullPath;
-	core::ScopedLock lock(_mutex);
-	auto i = _volumes.find(filename);
-	if (i != _volumes.end()) {
-		_volumes.erase(i);
-		return true;
-	}
-	return false;
+	return _volumes.remove(fullPath);
 }
 
 void VolumeCache::construct() {
+	core::Var::get("voxformat_volumecachesize", "256", core::CV_NOPERSIST)->setHelp("The memory budget in MB for cached volumes that are not in use");
 	command::Command::registerCommand("volumecachelist", [&] (const command::CmdArgs& argv) {
-		Log::info("Cache content");
-		core::ScopedLock lock(_mutex);
-		for (const auto& e : _volumes) {
-			Log::info(" * %s", e->key.c_str());
-		}
+		Log::info("Cache content (%i KB)", (int)(_volumes.memoryUsage() / 1024u));
+		_volumes.visitKeys([] (const core::String& key) {
+			Log::info(" * %s", key.c_str());
+		});
 	});
 	command::Command::registerCommand("volumecacheclear", [&] (const command::CmdArgs& argv) {
-		core::ScopedLock lock(_mutex);
-		for (const auto & e : _volumes) {
-			delete e->value;
-		}
 		_volumes.clear();
 	});
 }
 
 bool VolumeCache::init() {
+	const int budgetMB = core::Var::get("voxformat_volumecachesize", "256", core::CV_NOPERSIST)->intVal();
+	_volumes.setMemoryBudget((size_t)core_max(0, budgetMB) * 1024u * 1024u);
 	return true;
 }
 
 void VolumeCache::shutdown() {
-	core::ScopedLock lock(_mutex);
-	for (const auto & e : _volumes) {
-		delete e->value;
-	}
 	_volumes.clear();
 }
 
@@ -6,28 +6,35 @@
 
 #include "core/IComponent.h"
 #include "voxel/RawVolume.h"
-#include "core/collection/StringMap.h"
+#include "core/concurrent/AsyncCache.h"
 #include <memory>
-#include "core/concurrent/Lock.h"
-#include "core/Trace.h"
 
 namespace voxelformat {
 
 /**
  * @brief Caches @c voxel::RawVolume instances by their name
- * @note The cache is threadsafe
+ * @note The cache is threadsafe - every volume is only loaded once, even if several threads
+ * ask for it at the same time.
+ * @note The volumes that are no longer referenced are evicted (least recently used first)
+ * once the memory budget that is configured by the cvar @c voxformat_volumecachesize is exceeded.
  * @sa MeshCache
+ * @sa core::AsyncCache
  */
 class VolumeCache : public core::IComponent {
+public:
+	using VolumePtr = std::shared_ptr<voxel::RawVolume>;
 private:
-	core::StringMap<voxel::RawVolume*> _volumes core_thread_guarded_by(_mutex);
-	core_trace_mutex(core::Lock, _mutex, "VolumeCache");
+	core::AsyncCache<voxel::RawVolume> _volumes;
+
+	static voxel::RawVolume* load(const core::String& fullPath);
 public:
+	VolumeCache();
 	~VolumeCache();
 	/**
-	 * The returned volume is not owned by the caller. The cache will delete the memory.
+	 * The returned volume is shared with the cache - keep the reference as long as you are using it.
+	 * @return @c nullptr if the volume could not get loaded
 	 */
-	voxel::RawVolume* loadVolume(const char* fullPath);
+	VolumePtr loadVolume(const char* fullPath);
 	bool removeVolume(const char* fullPath);
 
 	bool init() override;
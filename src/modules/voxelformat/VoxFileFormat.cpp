@@ -14,6 +14,7 @@
 #include "core/Color.h"
 #include "voxel/Mesh.h"
 #include "voxelformat/VoxelVolumes.h"
+#include <glm/common.hpp>
 #include <limits>
 
 namespace voxel {
@@ -66,33 +67,62 @@ bool VoxFileFormat::save(const RawVolume* volume, const io::FilePtr& file) {
 	return saveGroups(volumes, file);
 }
 
-MeshExporter::MeshExt::MeshExt(voxel::Mesh *_mesh, const core::String &_name) :
-		mesh(_mesh), name(_name) {
+MeshExporter::MeshExt::MeshExt(const voxel::Mesh *_mesh, const core::String &_name, int _layer, bool _firstTile) :
+		mesh(_mesh), name(_name), layer(_layer), firstTile(_firstTile) {
 }
 
-bool MeshExporter::saveGroups(const VoxelVolumes& volumes, const io::FilePtr& file) {
-	const bool mergeQuads = core::Var::get("voxformat_mergequads", "true", core::CV_NOPERSIST)->boolVal();
-	const bool reuseVertices = core::Var::get("voxformat_reusevertices", "true", core::CV_NOPERSIST)->boolVal();
-	const bool ambientOcclusion = core::Var::get("voxformat_ambientocclusion", "false", core::CV_NOPERSIST)->boolVal();
-	const float scale = core::Var::get("voxformat_scale", "1.0", core::CV_NOPERSIST)->floatVal();
-	const bool quads = core::Var::get("voxformat_quads", "true", core::CV_NOPERSIST)->boolVal();
-	const bool withColor = core::Var::get("voxformat_withcolor", "true", core::CV_NOPERSIST)->boolVal();
-	const bool withTexCoords = core::Var::get("voxformat_withtexcoords", "true", core::CV_NOPERSIST)->boolVal();
-
-	Meshes meshes;
+bool MeshExporter::visitMeshes(const VoxelVolumes& volumes, const MeshSettings& settings, const MeshVisitor& visitor) const {
+	// this mesh is reused for every tile - the memory is only allocated once for the biggest tile
+	voxel::Mesh mesh(128, 128, true);
+	int layer = 0;
 	for (const VoxelVolume& v : volumes) {
-		voxel::Mesh *mesh = new voxel::Mesh();
-		voxel::Region region = v.volume->region();
-		region.shiftUpperCorner(1, 1, 1);
-		voxel::extractCubicMesh(v.volume, region, mesh, voxel::IsQuadNeeded(), glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
-		meshes.emplace_back(mesh, v.name);
+		const voxel::Region& region = v.volume->region();
+		const glm::ivec3& mins = region.getLowerCorner();
+		const glm::ivec3& maxs = region.getUpperCorner();
+		bool firstTile = true;
+		for (int z = mins.z; z <= maxs.z; z += MeshTileSize) {
+			for (int y = mins.y; y <= maxs.y; y += MeshTileSize) {
+				for (int x = mins.x; x <= maxs.x; x += MeshTileSize) {
+					// the extractor generates the faces between a voxel and its negative neighbours - so
+					// only the last tile on each axis must extend beyond the volume to close the mesh.
+					const glm::ivec3 tileMins(x, y, z);
+					glm::ivec3 tileMaxs = glm::min(tileMins + (MeshTileSize - 1), maxs);
+					for (int i = 0; i < 3; ++i) {
+						if (tileMaxs[i] == maxs[i]) {
+							++tileMaxs[i];
+						}
+					}
+					const voxel::Region tileRegion(tileMins, tileMaxs);
+					voxel::extractCubicMesh(v.volume, tileRegion, &mesh, voxel::IsQuadNeeded(), glm::ivec3(0),
+							settings.mergeQuads, settings.reuseVertices, settings.ambientOcclusion);
+					if (!firstTile && mesh.isEmpty()) {
+						continue;
+					}
+					if (!visitor(MeshExt(&mesh, v.name, layer, firstTile))) {
+						return false;
+					}
+					firstTile = false;
+				}
+			}
+		}
+		++layer;
 	}
+	return true;
+}
+
+bool MeshExporter::saveGroups(const VoxelVolumes& volumes, const io::FilePtr& file) {
+	MeshSettings settings;
+	settings.mergeQuads = core::Var::get("voxformat_mergequads", "true", core::CV_NOPERSIST)->boolVal();
+	settings.reuseVertices = core::Var::get("voxformat_reusevertices", "true", core::CV_NOPERSIST)->boolVal();
+	settings.ambientOcclusion = core::Var::get("voxformat_ambientocclusion", "false", core::CV_NOPERSIST)->boolVal();
+	settings.scale = core::Var::get("voxformat_scale", "1.0", core::CV_NOPERSIST)->floatVal();
+	settings.quads = core::Var::get("voxformat_quads", "true", core::CV_NOPERSIST)->boolVal();
+	settings.withColor = core::Var::get("voxformat_withcolor", "true", core::CV_NOPERSIST)->boolVal();
+	settings.withTexCoords = core::Var::get("voxformat_withtexcoords", "true", core::CV_NOPERSIST)->boolVal();
+	settings.binary = core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST)->boolVal();
+
 	Log::debug("Save meshes");
-	const bool state = saveMeshes(meshes, file, scale, quads, withColor, withTexCoords);
-	for (MeshExt& meshext : meshes) {
-		delete meshext.mesh;
-	}
-	return state;
+	return saveMeshes(volumes, file, settings);
 }
 
 }
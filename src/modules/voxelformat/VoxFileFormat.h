@@ -10,6 +10,7 @@
 #include "io/File.h"
 #include "VoxelVolumes.h"
 #include <glm/fwd.hpp>
+#include <functional>
 
 namespace voxel {
 
@@ -37,15 +38,52 @@ public:
 	virtual bool save(const RawVolume* volume, const io::FilePtr& file);
 };
 
+/**
+ * @brief Base class for formats that export a mesh instead of voxels
+ *
+ * The meshes are not extracted up front. Every volume is split into tiles of
+ * @c MeshTileSize voxels and only the mesh of the tile that is currently written
+ * is kept in memory. This keeps the memory usage bounded regardless of the scene size.
+ */
 class MeshExporter : public VoxFileFormat {
 protected:
+	static constexpr int MeshTileSize = 128;
+
 	struct MeshExt {
-		MeshExt(voxel::Mesh* mesh, const core::String& name);
-		voxel::Mesh* mesh = nullptr;
+		MeshExt(const voxel::Mesh* mesh, const core::String& name, int layer, bool firstTile);
+		const voxel::Mesh* mesh = nullptr;
 		core::String name;
+		/** the index of the volume this mesh tile belongs to */
+		int layer;
+		/** @c true if this is the first tile of the given layer */
+		bool firstTile;
 	};
-	using Meshes = core::DynamicArray<MeshExt>;
-	virtual bool saveMeshes(const Meshes& meshes, const io::FilePtr& file, float scale = 1.0f, bool quad = false, bool withColor = true, bool withTexCoords = true) = 0;
+
+	struct MeshSettings {
+		bool mergeQuads = true;
+		bool reuseVertices = true;
+		bool ambientOcclusion = false;
+		float scale = 1.0f;
+		bool quads = true;
+		bool withColor = true;
+		bool withTexCoords = true;
+		bool binary = false;
+	};
+
+	/**
+	 * @return @c false if the export should be aborted
+	 */
+	using MeshVisitor = std::function<bool(const MeshExt& meshExt)>;
+
+	/**
+	 * @brief Extracts the mesh of every volume tile by tile and hands it over to the given visitor.
+	 * The mesh is only valid during the visitor call.
+	 * @note Empty tiles are skipped - but the first tile of a layer is always visited.
+	 * @return @c false if the visitor aborted the export
+	 */
+	bool visitMeshes(const VoxelVolumes& volumes, const MeshSettings& settings, const MeshVisitor& visitor) const;
+
+	virtual bool saveMeshes(const VoxelVolumes& volumes, const io::FilePtr& file, const MeshSettings& settings) = 0;
 public:
 	bool loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) override {
 		return false;
@@ -53,7 +53,7 @@ VoxelVolume& VoxelVolumes::operator[](size_t idx) {
 	return volumes[idx];
 }
 
-voxel::RawVolume *VoxelVolumes::merge() const {
+voxel::RawVolume *VoxelVolumes::merge(core::ThreadPool *threadPool) const {
 	if (volumes.empty()) {
 		return nullptr;
 	}
@@ -74,6 +74,9 @@ voxel::RawVolume *VoxelVolumes::merge() const {
 	if (rawVolumes.empty()) {
 		return nullptr;
 	}
+	if (threadPool != nullptr) {
+		return ::voxel::merge(*threadPool, rawVolumes);
+	}
 	return ::voxel::merge(rawVolumes);
 }
 
@@ -8,6 +8,10 @@
 #include "core/collection/DynamicArray.h"
 #include <glm/vec3.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 
 class RawVolume;
@@ -33,7 +37,10 @@ struct VoxelVolumes {
 	void reserve(size_t size);
 	bool empty() const;
 	size_t size() const;
-	voxel::RawVolume* merge() const;
+	/**
+	 * @param[in] threadPool If given, the volumes are merged in parallel on this thread pool
+	 */
+	voxel::RawVolume* merge(core::ThreadPool* threadPool = nullptr) const;
 
 	const VoxelVolume &operator[](size_t idx) const;
 	VoxelVolume& operator[](size_t idx);
@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxFormatTest.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "voxelformat/PLYFormat.h"
+
+namespace voxel {
+
+class PLYFormatTest: public AbstractVoxFormatTest {
+protected:
+	int headerValue(const core::String& content, const char *key) {
+		const size_t pos = content.find(key);
+		if (pos == core::String::npos) {
+			return -1;
+		}
+		return core::string::toInt(content.substr(pos + SDL_strlen(key)));
+	}
+};
+
+TEST_F(PLYFormatTest, testSaveAscii) {
+	PLYFormat f;
+	core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST)->setVal(false);
+	core::Var::get("voxformat_quads", "true", core::CV_NOPERSIST)->setVal(true);
+	Region region(glm::ivec3(0), glm::ivec3(0));
+	RawVolume original(region);
+	original.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 1));
+	ASSERT_TRUE(f.save(&original, open("ply-asciisavetest.ply", io::FileMode::Write)));
+	const core::String content = open("ply-asciisavetest.ply")->load();
+	ASSERT_EQ(0u, content.find("ply\nformat ascii 1.0\n"));
+	EXPECT_EQ(8, headerValue(content, "element vertex "));
+	EXPECT_EQ(6, headerValue(content, "element face "));
+	const size_t endHeader = content.find("end_header\n");
+	ASSERT_NE(core::String::npos, endHeader);
+	int lines = 0;
+	for (size_t i = endHeader + 11; i < content.size(); ++i) {
+		if (content[i] == '\n') {
+			++lines;
+		}
+	}
+	EXPECT_EQ(8 + 6, lines);
+}
+
+TEST_F(PLYFormatTest, testSaveBinaryTiled) {
+	PLYFormat f;
+	core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST)->setVal(true);
+	core::Var::get("voxformat_quads", "true", core::CV_NOPERSIST)->setVal(true);
+	core::Var::get("voxformat_withcolor", "true", core::CV_NOPERSIST)->setVal(true);
+	core::Var::get("voxformat_withtexcoords", "true", core::CV_NOPERSIST)->setVal(true);
+	// exceeds the mesh tile size - the volume is exported in two tiles
+	Region region(glm::ivec3(0), glm::ivec3(129, 0, 0));
+	RawVolume original(region);
+	for (int x = 0; x <= 129; ++x) {
+		original.setVoxel(x, 0, 0, createVoxel(VoxelType::Generic, 1));
+	}
+	ASSERT_TRUE(f.save(&original, open("ply-binarysavetest.ply", io::FileMode::Write)));
+	const core::String content = open("ply-binarysavetest.ply")->load();
+	core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST)->setVal(false);
+	ASSERT_EQ(0u, content.find("ply\nformat binary_little_endian 1.0\n"));
+	const int vertices = headerValue(content, "element vertex ");
+	const int faces = headerValue(content, "element face ");
+	// the merged quads of the sides are split at the tile border
+	EXPECT_EQ(4 + 4 + 2, faces);
+	const size_t endHeader = content.find("end_header\n");
+	ASSERT_NE(core::String::npos, endHeader);
+	// xyz, st and rgb per vertex - a count byte and four indices per quad
+	const size_t vertexSize = 3 * sizeof(float) + 2 * sizeof(float) + 3;
+	const size_t faceSize = 1 + 4 * sizeof(uint32_t);
+	EXPECT_EQ(endHeader + 11 + vertices * vertexSize + faces * faceSize, content.size());
+}
+
+}
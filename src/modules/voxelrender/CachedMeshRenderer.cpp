@@ -18,20 +18,29 @@ bool CachedMeshRenderer::init() {
 }
 
 void CachedMeshRenderer::shutdown() {
+	_meshes.clear();
 	_meshCache->shutdown();
 	_meshRenderer.shutdown();
 }
 
 bool CachedMeshRenderer::removeMesh(int index) {
-	return _meshRenderer.setMesh(index, nullptr);
+	if (!_meshRenderer.setMesh(index, nullptr)) {
+		return false;
+	}
+	_meshes.remove(index);
+	return true;
 }
 
 int CachedMeshRenderer::addMesh(const char *fullpath, const glm::mat4& model) {
-	const voxel::Mesh* mesh = _meshCache->getMesh(fullpath);
-	if (mesh == nullptr) {
+	const voxelformat::MeshCache::MeshPtr& mesh = _meshCache->getMesh(fullpath);
+	if (!mesh) {
 		return -1;
 	}
-	return _meshRenderer.addMesh(mesh, model);
+	const int idx = _meshRenderer.addMesh(mesh.get(), model);
+	if (idx >= 0) {
+		_meshes.put(idx, mesh);
+	}
+	return idx;
 }
 
 bool CachedMeshRenderer::setModelMatrix(int idx, const glm::mat4& model) {
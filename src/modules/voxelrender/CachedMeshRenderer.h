@@ -9,6 +9,7 @@
 #include "core/IComponent.h"
 #include <glm/mat4x4.hpp>
 #include "core/SharedPtr.h"
+#include "core/collection/Map.h"
 
 namespace voxelrender {
 
@@ -16,6 +17,11 @@ class CachedMeshRenderer : public core::IComponent {
 private:
 	voxelformat::MeshCachePtr _meshCache;
 	voxelrender::MeshRenderer _meshRenderer;
+	/**
+	 * @brief Keeps the meshes that are used by the renderer alive - otherwise the
+	 * cache would be allowed to evict them
+	 */
+	core::Map<int, voxelformat::MeshCache::MeshPtr, 64> _meshes;
 public:
 	CachedMeshRenderer(const voxelformat::MeshCachePtr& meshCache);
 
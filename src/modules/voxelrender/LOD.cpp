@@ -0,0 +1,92 @@
+/**
+ * @file
+ */
+
+#include "LOD.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+
+namespace voxelrender {
+
+LODSelector::LODSelector(float distance, float hysteresis) :
+		_hysteresis(hysteresis) {
+	if (distance <= 0.0f) {
+		return;
+	}
+	for (int level = 1; level < MaxLODLevels; ++level) {
+		_distances[level] = distance;
+		distance *= 2.0f;
+	}
+}
+
+int LODSelector::select(float distance, int currentLevel) const {
+	if (!enabled()) {
+		return 0;
+	}
+	int level = 0;
+	for (int l = 1; l < MaxLODLevels; ++l) {
+		if (distance >= _distances[l]) {
+			level = l;
+		}
+	}
+	if (currentLevel < 0 || currentLevel >= MaxLODLevels || level == currentLevel) {
+		return level;
+	}
+	int l = currentLevel;
+	if (level > currentLevel) {
+		// only switch to a coarser level if the distance is clearly beyond the threshold
+		while (l < level && distance >= _distances[l + 1] * (1.0f + _hysteresis)) {
+			++l;
+		}
+		return l;
+	}
+	while (l > level && distance < _distances[l] * (1.0f - _hysteresis)) {
+		--l;
+	}
+	return l;
+}
+
+int balanceLODLevels(LODLevels& levels) {
+	static const glm::ivec3 neighbours[] = {
+		glm::ivec3(-1, 0, 0), glm::ivec3(1, 0, 0),
+		glm::ivec3(0, -1, 0), glm::ivec3(0, 1, 0),
+		glm::ivec3(0, 0, -1), glm::ivec3(0, 0, 1)
+	};
+	int changed = 0;
+	bool dirty = true;
+	// a refined cell might force its neighbours to be refined, too
+	while (dirty) {
+		dirty = false;
+		for (auto& e : levels) {
+			for (const glm::ivec3& n : neighbours) {
+				auto i = levels.find(e.first + n);
+				if (i == levels.end()) {
+					continue;
+				}
+				if (e.second > i->second + 1) {
+					e.second = i->second + 1;
+					dirty = true;
+					++changed;
+				}
+			}
+		}
+	}
+	return changed;
+}
+
+void scaleLODMesh(voxel::Mesh* mesh, int level, const glm::ivec3& translate) {
+	const int scale = 1 << level;
+	for (voxel::VoxelVertex& v : mesh->getVertexVector()) {
+		v.position = glm::ivec3(v.position) * scale + translate;
+	}
+	mesh->setOffset(translate);
+}
+
+void clampLODMesh(voxel::Mesh* mesh, const voxel::Region& region) {
+	const glm::ivec3 maxs = region.getUpperCorner() + 1;
+	for (voxel::VoxelVertex& v : mesh->getVertexVector()) {
+		v.position = glm::min(glm::ivec3(v.position), maxs);
+	}
+}
+
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/Mesh.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxelutil/VolumeRescaler.h"
+#include <unordered_map>
+#include <glm/vec3.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace voxelrender {
+
+/**
+ * @brief Level 0 is the full resolution - every further level halves the resolution (2x, 4x, 8x)
+ */
+static constexpr int MaxLODLevels = 4;
+
+/**
+ * @brief Selects the level of detail for a mesh cell by its distance to the camera
+ *
+ * The first reduced level starts at the configured distance, every further level at twice the distance
+ * of the previous one. A band around each threshold keeps the current level to prevent cells from
+ * flickering between two levels if the camera moves along a threshold.
+ */
+class LODSelector {
+private:
+	float _distances[MaxLODLevels] {};
+	float _hysteresis;
+public:
+	/**
+	 * @param[in] distance The distance at which the first reduced level starts. @c 0 disables the level of detail.
+	 * @param[in] hysteresis The relative size of the band around the thresholds
+	 */
+	LODSelector(float distance = 0.0f, float hysteresis = 0.1f);
+
+	/**
+	 * @param[in] currentLevel The level the cell is currently rendered with or @c -1 if there is none yet
+	 * @return The level of detail in the range [0, MaxLODLevels)
+	 */
+	int select(float distance, int currentLevel = -1) const;
+
+	/**
+	 * @return The distance at which the given level starts
+	 */
+	float distance(int level) const;
+
+	bool enabled() const;
+};
+
+inline float LODSelector::distance(int level) const {
+	core_assert(level >= 0 && level < MaxLODLevels);
+	return _distances[level];
+}
+
+inline bool LODSelector::enabled() const {
+	return _distances[1] > 0.0f;
+}
+
+/**
+ * @brief Maps the cell coordinates to their level of detail
+ */
+typedef std::unordered_map<glm::ivec3, int> LODLevels;
+
+/**
+ * @brief Makes sure that the levels of neighbouring cells don't differ by more than one - the coarser cell
+ * is refined in this case. This keeps the seams between the levels small.
+ * @return The amount of cells whose level was changed
+ */
+extern int balanceLODLevels(LODLevels& levels);
+
+/**
+ * @brief Scales the vertices of a mesh that was extracted from a downsampled volume back into the
+ * coordinates of the full resolution volume
+ */
+extern void scaleLODMesh(voxel::Mesh* mesh, int level, const glm::ivec3& translate);
+
+/**
+ * @brief The dimensions of the downsampled volume are rounded up - this moves the vertices that ended up
+ * beyond the upper corner of the given region back onto its upper faces
+ */
+extern void clampLODMesh(voxel::Mesh* mesh, const voxel::Region& region);
+
+/**
+ * @brief Builds the pyramid of downsampled volumes for the given region up to the given level
+ * @return A new volume with the region (0, (dimensions of the given region / 2^level) - 1). It's the caller's
+ * responsibility to free this memory.
+ * @sa voxel::downsampleVolume()
+ */
+template<class Volume>
+voxel::RawVolume* createLODVolume(const Volume* volume, const voxel::Region& region, int level) {
+	core_trace_scoped(CreateLODVolume);
+	core_assert(level > 0 && level < MaxLODLevels);
+	voxel::RawVolume* lodVolume = nullptr;
+	for (int l = 1; l <= level; ++l) {
+		const voxel::Region& srcRegion = lodVolume == nullptr ? region : lodVolume->region();
+		const glm::ivec3 dim = (srcRegion.getDimensionsInVoxels() + 1) / 2;
+		voxel::RawVolume* dest = new voxel::RawVolume(voxel::Region(glm::ivec3(0), dim - 1));
+		if (lodVolume == nullptr) {
+			voxel::downsampleVolume(*volume, srcRegion, *dest, dest->region());
+		} else {
+			voxel::downsampleVolume(*lodVolume, srcRegion, *dest, dest->region());
+			delete lodVolume;
+		}
+		lodVolume = dest;
+	}
+	return lodVolume;
+}
+
+/**
+ * @brief Extracts the mesh of the given region with a reduced level of detail
+ *
+ * The cell is extracted on its own - the faces at the borders of the cell are not culled against the
+ * neighbours. They are closing the gaps to the neighbouring cells that are extracted with another level.
+ *
+ * @note The vertices are in the coordinates of the full resolution volume, the offset of the mesh is the
+ * lower corner of the given region. The mesh doesn't exceed the given region - even if its dimensions are
+ * not a multiple of the cell size of the level.
+ */
+template<class Volume, class IsQuadNeeded>
+void extractLODMesh(const Volume* volume, const voxel::Region& region, int level, voxel::Mesh* mesh, IsQuadNeeded isQuadNeeded) {
+	core_trace_scoped(ExtractLODMesh);
+	voxel::RawVolume* lodVolume = createLODVolume(volume, region, level);
+	voxel::Region reg = lodVolume->region();
+	reg.shiftUpperCorner(1, 1, 1);
+	voxel::extractCubicMesh(lodVolume, reg, mesh, isQuadNeeded, glm::ivec3(0));
+	delete lodVolume;
+	scaleLODMesh(mesh, level, region.getLowerCorner());
+	clampLODMesh(mesh, region);
+}
+
+}
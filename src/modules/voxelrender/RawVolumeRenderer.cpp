@@ -27,7 +27,11 @@
 #include "VoxelShaderConstants.h"
 #include <SDL.h>
 #include <unordered_set>
+#include <memory>
 #include <algorithm>
+#include <limits>
+#include <glm/common.hpp>
+#include <glm/matrix.hpp>
 
 namespace voxelrender {
 
@@ -56,6 +60,7 @@ RawVolumeRenderer::RawVolumeRenderer() :
 
 void RawVolumeRenderer::construct() {
 	core::Var::get(cfg::VoxelMeshSize, "64", core::CV_READONLY);
+	core::Var::get(cfg::VoxelLODDistance, "0");
 }
 
 bool RawVolumeRenderer::init() {
@@ -123,6 +128,9 @@ bool RawVolumeRenderer::init() {
 	_materialBlock.create(materialBlock);
 
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_lodDistance = core::Var::getSafe(cfg::VoxelLODDistance);
+	_lodSelector = LODSelector(_lodDistance->floatVal());
+	_lodDistance->markClean();
 
 	return true;
 }
@@ -154,6 +162,7 @@ bool RawVolumeRenderer::update(int idx) {
 
 	size_t vertCount = 0u;
 	size_t indCount = 0u;
+	bool faceRanges = true;
 	for (auto& i : _meshes) {
 		const Meshes& meshes = i.second;
 		const voxel::Mesh* mesh = meshes[idx];
@@ -164,8 +173,10 @@ bool RawVolumeRenderer::update(int idx) {
 		const voxel::IndexArray& indexVector = mesh->getIndexVector();
 		vertCount += vertexVector.size();
 		indCount += indexVector.size();
+		faceRanges &= mesh->hasFaceIndexRanges();
 	}
 
+	_hasFaceRanges[idx] = false;
 	if (indCount == 0u || vertCount == 0u) {
 		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
 		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
@@ -181,6 +192,8 @@ bool RawVolumeRenderer::update(int idx) {
 	voxel::IndexType* indicesPos = indicesBuf;
 
 	voxel::IndexType offset = (voxel::IndexType)0;
+	glm::vec3 mins((std::numeric_limits<float>::max)());
+	glm::vec3 maxs(-(std::numeric_limits<float>::max)());
 	for (auto& i : _meshes) {
 		const Meshes& meshes = i.second;
 		const voxel::Mesh* mesh = meshes[idx];
@@ -190,16 +203,48 @@ bool RawVolumeRenderer::update(int idx) {
 		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
 		const voxel::IndexArray& indexVector = mesh->getIndexVector();
 		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
+		for (const voxel::VoxelVertex& v : vertexVector) {
+			mins = glm::min(mins, glm::vec3(v.position));
+			maxs = glm::max(maxs, glm::vec3(v.position));
+		}
 
-		for (size_t i = 0; i < indexVector.size(); ++i) {
-			*indicesPos++ += offset;
+		if (!faceRanges) {
+			core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
+			for (size_t i = 0; i < indexVector.size(); ++i) {
+				*indicesPos++ += offset;
+			}
 		}
 
 		verticesPos += vertexVector.size();
 		offset += vertexVector.size();
 	}
 
+	if (faceRanges) {
+		// put the faces of the same direction of all meshes next to each other
+		for (int face = 0; face < voxel::FaceCount; ++face) {
+			voxel::IndexRange& faceRange = _faceRanges[idx][face];
+			faceRange.offset = (uint32_t)(indicesPos - indicesBuf);
+			voxel::IndexType baseVertex = (voxel::IndexType)0;
+			for (auto& i : _meshes) {
+				const Meshes& meshes = i.second;
+				const voxel::Mesh* mesh = meshes[idx];
+				if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+					continue;
+				}
+				const voxel::IndexRange& range = mesh->faceIndexRange((voxel::FaceNames)face);
+				const voxel::IndexType* indices = mesh->getRawIndexData() + range.offset;
+				for (uint32_t n = 0u; n < range.count; ++n) {
+					*indicesPos++ = indices[n] + baseVertex;
+				}
+				baseVertex += mesh->getNoOfVertices();
+			}
+			faceRange.count = (uint32_t)(indicesPos - indicesBuf) - faceRange.offset;
+		}
+		_meshMins[idx] = mins;
+		_meshMaxs[idx] = maxs;
+		_hasFaceRanges[idx] = true;
+	}
+
 	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], verticesBuf, verticesBufSize)) {
 		Log::error("Failed to update the vertex buffer");
 		core_free(indicesBuf);
@@ -223,6 +268,7 @@ bool RawVolumeRenderer::update(int idx, const voxel::VertexArray& vertices, cons
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
 
+	_hasFaceRanges[idx] = false;
 	if (indices.empty() || vertices.empty()) {
 		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
 		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
@@ -269,6 +315,9 @@ bool RawVolumeRenderer::swap(int idx1, int idx2) {
 	core::exchange(_hidden[idx1], _hidden[idx2]);
 	core::exchange(_model[idx1], _model[idx2]);
 	core::exchange(_rawVolume[idx1], _rawVolume[idx2]);
+	_dirtyCells[idx1].swap(_dirtyCells[idx2]);
+	_lodLevels[idx1].swap(_lodLevels[idx2]);
+	_lodDirty = true;
 	update(idx1);
 	update(idx2);
 
@@ -332,6 +381,7 @@ bool RawVolumeRenderer::translate(int idx, const glm::ivec3& m) {
 		return false;
 	}
 	volume->translate(m);
+	_lodDirty = true;
 	for (auto& i : _meshes) {
 		Meshes& meshes = i.second;
 		if (meshes[idx] == nullptr) {
@@ -349,57 +399,195 @@ voxel::Region RawVolumeRenderer::calculateExtractRegion(int x, int y, int z, con
 	return voxel::Region{mins, maxs};
 }
 
+static inline int floorDiv(int value, int divisor) {
+	const int q = value / divisor;
+	return (value % divisor != 0 && value < 0) ? q - 1 : q;
+}
+
+bool RawVolumeRenderer::markDirty(int idx, const voxel::Region& region) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	if (!region.isValid()) {
+		return true;
+	}
+
+	const int s = _meshSize->intVal();
+	// the extraction of a mesh cell samples one voxel below and two voxels above the cell - the
+	// faces are generated against the negative neighbours up to the shifted upper corner and the
+	// ambient occlusion looks at the neighbours of those voxels. A modification at the border of a
+	// cell is thus also affecting the adjacent cells.
+	const glm::ivec3& lower = region.getLowerCorner() - 2;
+	const glm::ivec3& upper = region.getUpperCorner() + 1;
+	const glm::ivec3 l(floorDiv(lower.x, s), floorDiv(lower.y, s), floorDiv(lower.z, s));
+	const glm::ivec3 u(floorDiv(upper.x, s), floorDiv(upper.y, s), floorDiv(upper.z, s));
+
+	std::unordered_set<glm::ivec3>& cells = _dirtyCells[idx];
+	for (int x = l.x; x <= u.x; ++x) {
+		for (int y = l.y; y <= u.y; ++y) {
+			for (int z = l.z; z <= u.z; ++z) {
+				cells.insert(glm::ivec3(x, y, z));
+			}
+		}
+	}
+	return true;
+}
+
+bool RawVolumeRenderer::markDirty(int idx, const voxel::DirtyBricks& bricks) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	bricks.visit([this, idx] (const voxel::Region& region) {
+		markDirty(idx, region);
+	});
+	return true;
+}
+
 bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
-	core_trace_scoped(RawVolumeRendererExtract);
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return false;
 	}
-	voxel::RawVolume* volume = _rawVolume[idx];
-	if (volume == nullptr) {
+	if (_rawVolume[idx] == nullptr) {
 		return false;
 	}
+	markDirty(idx, region);
+	scheduleExtractions(idx);
+	return true;
+}
 
+int RawVolumeRenderer::scheduleExtractions() {
+	int cnt = 0;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		cnt += scheduleExtractions(idx);
+	}
+	return cnt;
+}
+
+int RawVolumeRenderer::updateLOD(const glm::vec3& cameraPos) {
+	core_trace_scoped(RawVolumeRendererUpdateLOD);
+	if (_lodDistance->isDirty()) {
+		_lodSelector = LODSelector(_lodDistance->floatVal());
+		_lodDistance->markClean();
+		_lodDirty = true;
+	}
 	const int s = _meshSize->intVal();
 	const glm::ivec3 meshSize(s);
-	const glm::ivec3 meshSizeMinusOne(s - 1);
-	const voxel::Region& completeRegion = volume->region();
+	const glm::ivec3 cameraCell(glm::floor(cameraPos / (float)s));
+	if (!_lodDirty && cameraCell == _lodCameraCell) {
+		return 0;
+	}
+	_lodCameraCell = cameraCell;
+	_lodDirty = false;
+	int cnt = 0;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const voxel::RawVolume* volume = _rawVolume[idx];
+		if (volume == nullptr) {
+			continue;
+		}
+		LODLevels& current = _lodLevels[idx];
+		if (!_lodSelector.enabled() && current.empty()) {
+			continue;
+		}
+		const voxel::Region& region = volume->region();
+		const glm::ivec3& lower = region.getLowerCorner();
+		const glm::ivec3& upper = region.getUpperCorner();
+		const glm::ivec3 l(floorDiv(lower.x, s), floorDiv(lower.y, s), floorDiv(lower.z, s));
+		const glm::ivec3 u(floorDiv(upper.x, s), floorDiv(upper.y, s), floorDiv(upper.z, s));
+
+		LODLevels& levels = _lodScratch;
+		levels.clear();
+		for (int x = l.x; x <= u.x; ++x) {
+			for (int y = l.y; y <= u.y; ++y) {
+				for (int z = l.z; z <= u.z; ++z) {
+					const glm::ivec3 cell(x, y, z);
+					const voxel::Region& cellRegion = calculateExtractRegion(x, y, z, meshSize);
+					const glm::vec3 center(_model[idx] * glm::vec4(cellRegion.getCenterf(), 1.0f));
+					auto i = current.find(cell);
+					const int currentLevel = i == current.end() ? 0 : i->second;
+					levels[cell] = _lodSelector.select(glm::distance(center, cameraPos), currentLevel);
+				}
+			}
+		}
+		balanceLODLevels(levels);
 
-	// convert to step coordinates that are needed to extract
-	// the given region mesh size ranges
-	const glm::ivec3& l = (region.getLowerCorner() - meshSizeMinusOne) / meshSize;
-	const glm::ivec3& u = region.getUpperCorner() / meshSize;
+		for (const auto& e : levels) {
+			auto i = current.find(e.first);
+			const int currentLevel = i == current.end() ? 0 : i->second;
+			if (currentLevel == e.second) {
+				continue;
+			}
+			_dirtyCells[idx].insert(e.first);
+			++cnt;
+		}
+		// only the cells with a reduced level of detail are stored
+		current.clear();
+		for (const auto& e : levels) {
+			if (e.second > 0) {
+				current.insert(e);
+			}
+		}
+	}
+	return cnt;
+}
 
-	for (int x = l.x; x <= u.x; ++x) {
-		for (int y = l.y; y <= u.y; ++y) {
-			for (int z = l.z; z <= u.z; ++z) {
-				const voxel::Region& finalRegion = calculateExtractRegion(x, y, z, meshSize);
-				const glm::ivec3& mins = finalRegion.getLowerCorner();
-
-				if (!voxel::intersects(completeRegion, finalRegion)) {
-					auto i = _meshes.find(mins);
-					if (i != _meshes.end()) {
-						Meshes& meshes = i->second;
-						delete meshes[idx];
-						meshes[idx] = nullptr;
-					}
-					continue;
-				}
+int RawVolumeRenderer::scheduleExtractions(int idx) {
+	std::unordered_set<glm::ivec3>& cells = _dirtyCells[idx];
+	if (cells.empty()) {
+		return 0;
+	}
+	core_trace_scoped(RawVolumeRendererExtract);
+	voxel::RawVolume* volume = _rawVolume[idx];
+	if (volume == nullptr) {
+		cells.clear();
+		return 0;
+	}
 
-				voxel::RawVolume copy(volume);
-				_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
-					++_runningExtractorTasks;
-					voxel::Region reg = finalRegion;
-					reg.shiftUpperCorner(1, 1, 1);
-					voxel::Mesh mesh(65536, 65536, true);
-					voxel::extractCubicMesh(&movedCopy, reg, &mesh, raw::CustomIsQuadNeeded(), reg.getLowerCorner());
-					_pendingQueue.emplace(mins, idx, core::move(mesh));
-					Log::debug("Enqueue mesh for idx: %i", idx);
-					--_runningExtractorTasks;
-				});
+	const int s = _meshSize->intVal();
+	const glm::ivec3 meshSize(s);
+	const voxel::Region& completeRegion = volume->region();
+	// all extraction tasks of this volume share the same copy
+	std::shared_ptr<const voxel::RawVolume> copy;
+	int cnt = 0;
+
+	const LODLevels& lodLevels = _lodLevels[idx];
+	for (const glm::ivec3& cell : cells) {
+		const voxel::Region& finalRegion = calculateExtractRegion(cell.x, cell.y, cell.z, meshSize);
+		const glm::ivec3& mins = finalRegion.getLowerCorner();
+
+		if (!voxel::intersects(completeRegion, finalRegion)) {
+			auto i = _meshes.find(mins);
+			if (i != _meshes.end()) {
+				Meshes& meshes = i->second;
+				delete meshes[idx];
+				meshes[idx] = nullptr;
 			}
+			continue;
 		}
+
+		if (!copy) {
+			copy = std::make_shared<const voxel::RawVolume>(volume);
+		}
+		auto lodIter = lodLevels.find(cell);
+		const int lod = lodIter == lodLevels.end() ? 0 : lodIter->second;
+		_threadPool.enqueue([copy, mins, idx, finalRegion, lod, this] () {
+			++_runningExtractorTasks;
+			voxel::Mesh mesh(65536, 65536, true);
+			if (lod > 0) {
+				extractLODMesh(copy.get(), finalRegion, lod, &mesh, raw::CustomIsQuadNeeded());
+			} else {
+				voxel::Region reg = finalRegion;
+				reg.shiftUpperCorner(1, 1, 1);
+				voxel::extractCubicMesh(copy.get(), reg, &mesh, raw::CustomIsQuadNeeded(), reg.getLowerCorner());
+			}
+			_pendingQueue.emplace(mins, idx, core::move(mesh));
+			Log::debug("Enqueue mesh for idx: %i", idx);
+			--_runningExtractorTasks;
+		});
+		++cnt;
 	}
-	return true;
+	cells.clear();
+	Log::debug("Scheduled %i mesh extractions for idx: %i", cnt, idx);
+	return cnt;
 }
 
 void RawVolumeRenderer::waitForPendingExtractions() {
@@ -415,6 +603,9 @@ void RawVolumeRenderer::clearPendingExtractions() {
 		SDL_Delay(1);
 	}
 	_pendingQueue.clear();
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		_dirtyCells[idx].clear();
+	}
 }
 
 void RawVolumeRenderer::extractVolumeRegionToMesh(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const {
@@ -526,6 +717,18 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		video::ScopedPolygonMode polygonMode(camera.polygonMode(), offset);
 		video::ScopedBuffer scopedBuf(_vertexBuffer[idx]);
 		_voxelShader.setModel(_model[idx]);
+		// the visible faces only depend on the camera position for perspective projections
+		if (_hasFaceRanges[idx] && camera.mode() == video::CameraMode::Perspective) {
+			const glm::vec3 eye(glm::inverse(_model[idx]) * glm::vec4(camera.position(), 1.0f));
+			const uint8_t faceMask = voxel::visibleFaces(eye, _meshMins[idx], _meshMaxs[idx]);
+			voxel::IndexRange ranges[voxel::FaceCount];
+			const int n = voxel::mergeFaceIndexRanges(_faceRanges[idx], faceMask, ranges);
+			for (int r = 0; r < n; ++r) {
+				void* indexOffset = (void*)(intptr_t)(ranges[r].offset * sizeof(voxel::IndexType));
+				video::drawElements<voxel::IndexType>(video::Primitive::Triangles, ranges[r].count, indexOffset);
+			}
+			continue;
+		}
 		void* bufferOffset = (void*)(intptr_t)(idx * sizeof(_drawCommands[0]));
 		video::drawElementsIndirect<voxel::IndexType>(video::Primitive::Triangles, bufferOffset);
 	}
@@ -537,7 +740,10 @@ bool RawVolumeRenderer::setModelMatrix(int idx, const glm::mat4& model) {
 		return false;
 	}
 
-	_model[idx] = model;
+	if (_model[idx] != model) {
+		_model[idx] = model;
+		_lodDirty = true;
+	}
 
 	return true;
 }
@@ -568,6 +774,7 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 
 	voxel::RawVolume* old = _rawVolume[idx];
 	_rawVolume[idx] = volume;
+	_lodDirty = true;
 	if (deleteMesh) {
 		for (auto& i : _meshes) {
 			Meshes& meshes = i.second;
@@ -596,6 +803,8 @@ core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 	_meshes.clear();
 	core::DynamicArray<voxel::RawVolume*> old(MAX_VOLUMES);
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		_dirtyCells[idx].clear();
+		_lodLevels[idx].clear();
 		_vertexBuffer[idx].shutdown();
 		_vertexBufferIndex[idx] = -1;
 		_indexBufferIndex[idx] = -1;
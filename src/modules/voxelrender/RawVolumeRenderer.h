@@ -5,11 +5,13 @@
 #pragma once
 
 #include "RenderShaders.h"
+#include "LOD.h"
 #include "core/collection/ConcurrentPriorityQueue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Concurrency.h"
 #include "core/concurrent/ThreadPool.h"
 #include "voxel/RawVolume.h"
+#include "voxel/DirtyBricks.h"
 #include "voxel/Region.h"
 #include "video/Buffer.h"
 #include "VoxelrenderShaders.h"
@@ -23,6 +25,7 @@
 #include "core/collection/Array.h"
 #include "frontend/Colors.h"
 #include <unordered_map>
+#include <unordered_set>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -52,9 +55,38 @@ protected:
 	typedef core::Array<voxel::Mesh*, MAX_VOLUMES> Meshes;
 	typedef std::unordered_map<glm::ivec3, Meshes> MeshesMap;
 	MeshesMap _meshes;
+	/**
+	 * @brief The mesh cells (in cell coordinates) that are waiting for their extraction
+	 * @sa scheduleExtractions()
+	 */
+	std::unordered_set<glm::ivec3> _dirtyCells[MAX_VOLUMES];
+	/**
+	 * @brief The mesh cells (in cell coordinates) that are extracted with a reduced level of detail
+	 * @sa updateLOD()
+	 */
+	LODLevels _lodLevels[MAX_VOLUMES];
+	/** reused by updateLOD() to not allocate the levels of all cells again */
+	LODLevels _lodScratch;
+	LODSelector _lodSelector;
+	/**
+	 * @brief The mesh cell the camera was in when the levels were selected the last time - the levels are
+	 * only selected again if the camera enters another cell or the volumes changed.
+	 */
+	glm::ivec3 _lodCameraCell {0};
+	bool _lodDirty = true;
 
 	video::IndirectDrawBuffer _indirectDrawBuffer;
 	video::DrawElementsIndirectCommand _drawCommands[MAX_VOLUMES];
+	/**
+	 * @brief The indices of all meshes of a volume are sorted by their face direction - the faces that are
+	 * pointing away from the camera are skipped.
+	 * @sa voxel::Mesh::faceIndexRanges()
+	 */
+	voxel::IndexRange _faceRanges[MAX_VOLUMES][voxel::FaceCount];
+	bool _hasFaceRanges[MAX_VOLUMES] {};
+	/** the bounds of the vertices of a volume - used to find the visible faces */
+	glm::vec3 _meshMins[MAX_VOLUMES] {};
+	glm::vec3 _meshMaxs[MAX_VOLUMES] {};
 
 	video::Buffer _vertexBuffer[MAX_VOLUMES];
 	shader::VoxelData _materialBlock;
@@ -63,6 +95,7 @@ protected:
 	render::Shadow _shadow;
 
 	core::VarPtr _meshSize;
+	core::VarPtr _lodDistance;
 	core::VarPtr _shadowMap;
 
 	glm::vec3 _diffuseColor = frontend::diffuseColor;
@@ -86,6 +119,7 @@ protected:
 	core::ConcurrentPriorityQueue<ExtractionCtx> _pendingQueue;
 	void extractVolumeRegionToMesh(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const;
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const;
+	int scheduleExtractions(int idx);
 
 public:
 	RawVolumeRenderer();
@@ -108,8 +142,41 @@ public:
 
 	bool update(int idx, const voxel::VertexArray& vertices, const voxel::IndexArray& indices);
 
+	/**
+	 * @brief Marks the mesh cells that are affected by the modification of the given region and
+	 * starts their extraction immediately.
+	 * @sa markDirty()
+	 */
 	bool extractRegion(int idx, const voxel::Region& region);
 
+	/**
+	 * @brief Marks the mesh cells that are affected by the modification of the given region for
+	 * the extraction. Nothing is extracted until @c scheduleExtractions() is called - this allows
+	 * to collect all modifications of a frame and to extract each mesh cell only once.
+	 */
+	bool markDirty(int idx, const voxel::Region& region);
+	/**
+	 * @brief Only marks the mesh cells that are affected by the given dirty bricks - scattered
+	 * modifications don't lead to the extraction of their whole bounding box.
+	 */
+	bool markDirty(int idx, const voxel::DirtyBricks& bricks);
+	/**
+	 * @brief Starts the extraction of all mesh cells that were marked dirty
+	 * @return The amount of mesh cells that are extracted
+	 */
+	int scheduleExtractions();
+
+	/**
+	 * @brief Selects the level of detail of the mesh cells by their distance to the given position and
+	 * marks the cells whose level changed for the extraction.
+	 * @note The level of detail is disabled if @c cfg::VoxelLODDistance is @c 0
+	 * @note Call this once per frame with one reference camera - the levels are shared by all viewports.
+	 * Nothing is done as long as the camera stays in the same mesh cell and the volumes didn't change.
+	 * @return The amount of mesh cells whose level changed
+	 * @sa scheduleExtractions()
+	 */
+	int updateLOD(const glm::vec3& cameraPos);
+
 	bool translate(int idx, const glm::ivec3& m);
 
 	bool toMesh(voxel::Mesh* mesh);
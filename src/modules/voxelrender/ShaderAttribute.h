@@ -8,6 +8,7 @@
 #include "video/Types.h"
 #include "video/Renderer.h"
 #include "voxel/VoxelVertex.h"
+#include "voxel/CompactMesh.h"
 #include "voxel/Constants.h"
 #include "core/GLM.h"
 
@@ -43,6 +44,21 @@ inline video::Attribute getInfoVertexAttribute(uint32_t bufferIndex, uint32_t at
 	return attrib;
 }
 
+/**
+ * @brief The whole packed @c voxel::CompactVertex as one unsigned integer
+ */
+inline video::Attribute getCompactVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation) {
+	video::Attribute attrib;
+	attrib.bufferIndex = bufferIndex;
+	attrib.location = attributeLocation;
+	attrib.stride = sizeof(voxel::CompactVertex);
+	attrib.size = 1;
+	attrib.type = video::mapType<decltype(voxel::CompactVertex::data)>();
+	attrib.typeIsInt = true;
+	attrib.offset = offsetof(voxel::CompactVertex, data);
+	return attrib;
+}
+
 inline video::Attribute getOffsetVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
 	video::Attribute voxelAttributeOffsets;
 	voxelAttributeOffsets.bufferIndex = bufferIndex;
@@ -0,0 +1,178 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelrender/LOD.h"
+#include "voxel/CompactMesh.h"
+#include "voxel/Constants.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include <glm/common.hpp>
+#include <memory>
+
+namespace voxelrender {
+
+class LODTest: public app::AbstractTest {
+protected:
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		ASSERT_TRUE(voxel::initDefaultMaterialColors());
+	}
+
+	void fillSphere(voxel::RawVolume& volume, const glm::ivec3& center, int radius) {
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		const voxel::Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const glm::ivec3 d = glm::ivec3(x, y, z) - center;
+					if (d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius) {
+						volume.setVoxel(x, y, z, voxel);
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(LODTest, testSelectorDisabled) {
+	const LODSelector selector;
+	EXPECT_FALSE(selector.enabled());
+	EXPECT_EQ(0, selector.select(0.0f));
+	EXPECT_EQ(0, selector.select(100000.0f));
+}
+
+TEST_F(LODTest, testSelectorThresholds) {
+	const LODSelector selector(100.0f, 0.0f);
+	ASSERT_TRUE(selector.enabled());
+	EXPECT_FLOAT_EQ(100.0f, selector.distance(1));
+	EXPECT_FLOAT_EQ(200.0f, selector.distance(2));
+	EXPECT_FLOAT_EQ(400.0f, selector.distance(3));
+	EXPECT_EQ(0, selector.select(99.0f));
+	EXPECT_EQ(1, selector.select(100.0f));
+	EXPECT_EQ(2, selector.select(250.0f));
+	EXPECT_EQ(3, selector.select(10000.0f));
+}
+
+TEST_F(LODTest, testSelectorHysteresis) {
+	const LODSelector selector(100.0f, 0.1f);
+	// without a current level the thresholds are used as they are
+	EXPECT_EQ(1, selector.select(105.0f));
+	// stay at the current level inside the band around the threshold
+	EXPECT_EQ(0, selector.select(105.0f, 0));
+	EXPECT_EQ(1, selector.select(95.0f, 1));
+	// leave the band
+	EXPECT_EQ(1, selector.select(111.0f, 0));
+	EXPECT_EQ(0, selector.select(89.0f, 1));
+	// several levels at once
+	EXPECT_EQ(3, selector.select(1000.0f, 0));
+	EXPECT_EQ(0, selector.select(10.0f, 3));
+}
+
+TEST_F(LODTest, testBalanceLODLevels) {
+	LODLevels levels;
+	levels[glm::ivec3(0, 0, 0)] = 0;
+	levels[glm::ivec3(1, 0, 0)] = 3;
+	levels[glm::ivec3(2, 0, 0)] = 3;
+	levels[glm::ivec3(5, 0, 0)] = 3;
+	EXPECT_EQ(2, balanceLODLevels(levels));
+	EXPECT_EQ(0, levels[glm::ivec3(0, 0, 0)]);
+	EXPECT_EQ(1, levels[glm::ivec3(1, 0, 0)]);
+	EXPECT_EQ(2, levels[glm::ivec3(2, 0, 0)]);
+	// no neighbours
+	EXPECT_EQ(3, levels[glm::ivec3(5, 0, 0)]);
+	EXPECT_EQ(0, balanceLODLevels(levels));
+}
+
+TEST_F(LODTest, testDownsampleMajority) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	const voxel::Voxel voxel1 = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel voxel2 = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	// first child cell: 3 solid voxels out of 8 - stays empty
+	volume.setVoxel(0, 0, 0, voxel1);
+	volume.setVoxel(1, 0, 0, voxel1);
+	volume.setVoxel(0, 1, 0, voxel1);
+	// second child cell: 4 solid voxels out of 8 - the most frequent one wins
+	volume.setVoxel(2, 0, 0, voxel1);
+	volume.setVoxel(3, 0, 0, voxel2);
+	volume.setVoxel(2, 1, 0, voxel2);
+	volume.setVoxel(3, 1, 0, voxel2);
+
+	voxel::RawVolume dest(voxel::Region(0, 1));
+	voxel::downsampleVolume(volume, volume.region(), dest, dest.region());
+	EXPECT_TRUE(voxel::isAir(dest.voxel(0, 0, 0).getMaterial()));
+	EXPECT_TRUE(dest.voxel(1, 0, 0).isSame(voxel2));
+	EXPECT_TRUE(voxel::isAir(dest.voxel(1, 1, 1).getMaterial()));
+}
+
+TEST_F(LODTest, testCreateLODVolume) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-8, 0, 16), glm::ivec3(23, 15, 34)));
+	for (int level = 1; level < MaxLODLevels; ++level) {
+		std::unique_ptr<voxel::RawVolume> lodVolume(createLODVolume(&volume, volume.region(), level));
+		ASSERT_NE(nullptr, lodVolume.get());
+		const int scale = 1 << level;
+		const glm::ivec3 expected = (volume.region().getDimensionsInVoxels() + scale - 1) / scale;
+		EXPECT_EQ(glm::ivec3(0), lodVolume->region().getLowerCorner());
+		EXPECT_EQ(expected, lodVolume->region().getDimensionsInVoxels()) << "level " << level;
+	}
+}
+
+TEST_F(LODTest, testExtractLODMesh) {
+	const voxel::Region region(glm::ivec3(64, 0, 128), glm::ivec3(127, 63, 191));
+	voxel::RawVolume volume(region);
+	fillSphere(volume, region.getCenter(), 24);
+
+	size_t lastVertices = 0u;
+	for (int level = 0; level < MaxLODLevels; ++level) {
+		voxel::Mesh mesh(128, 128, true);
+		if (level == 0) {
+			voxel::Region reg = region;
+			reg.shiftUpperCorner(1, 1, 1);
+			voxel::extractCubicMesh(&volume, reg, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+		} else {
+			extractLODMesh(&volume, region, level, &mesh, voxel::IsQuadNeeded());
+			EXPECT_EQ(region.getLowerCorner(), mesh.getOffset());
+		}
+		const size_t vertices = mesh.getNoOfVertices();
+		ASSERT_GT(vertices, 0u) << "level " << level;
+		if (level > 0) {
+			EXPECT_LT(vertices, lastVertices) << "level " << level;
+		}
+		lastVertices = vertices;
+		for (const voxel::VoxelVertex& v : mesh.getVertexVector()) {
+			const glm::ivec3 pos(v.position);
+			ASSERT_TRUE(glm::all(glm::greaterThanEqual(pos, region.getLowerCorner()))) << "level " << level;
+			ASSERT_TRUE(glm::all(glm::lessThanEqual(pos, region.getUpperCorner() + 1))) << "level " << level;
+		}
+	}
+}
+
+TEST_F(LODTest, testEncodeFullHeightLODMesh) {
+	// the region of a chunk of the world renderer - the height is not a multiple of the cell sizes
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(31, voxel::MAX_MESH_CHUNK_HEIGHT - 2, 31));
+	voxel::RawVolume volume(region);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int z = 0; z < 32; ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = 0; x < 32; ++x) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	for (int level = 1; level < MaxLODLevels; ++level) {
+		voxel::Mesh mesh(128, 128, true);
+		extractLODMesh(&volume, region, level, &mesh, voxel::IsQuadNeeded());
+		ASSERT_GT(mesh.getNoOfIndices(), 0u) << "level " << level;
+		int maxY = 0;
+		for (const voxel::VoxelVertex& v : mesh.getVertexVector()) {
+			maxY = glm::max(maxY, (int)v.position.y);
+		}
+		EXPECT_EQ(region.getUpperY() + 1, maxY) << "level " << level;
+		voxel::CompactMesh compact;
+		EXPECT_TRUE(compact.encode(mesh)) << "level " << level;
+	}
+}
+
+}
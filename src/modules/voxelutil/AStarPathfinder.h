@@ -8,6 +8,7 @@
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/GLM.h"
+#include <glm/gtc/constants.hpp>
 
 #include <functional>
 #include <list>
@@ -431,12 +432,6 @@ float AStarPathfinder<VolumeType>::computeH(const glm::ivec3& a, const glm::ivec
 		core_assert_msg(false, "Connectivity parameter has an unrecognized value.");
 	}
 
-	//Sanity checks in debug mode. These can come out eventually, but I
-	//want to make sure that the heuristics I've come up with make sense.
-	core_assert_msg((a - b).length() > TwentySixConnectedCost(a, b), "A* heuristic error.");
-	core_assert_msg(TwentySixConnectedCost(a, b) > EighteenConnectedCost(a, b), "A* heuristic error.");
-	core_assert_msg(EighteenConnectedCost(a, b) > SixConnectedCost(a, b), "A* heuristic error.");
-
 	//Apply the bias to the computed h value;
 	hVal *= _params.hBias;
 
@@ -0,0 +1,798 @@
+/**
+ * @file
+ */
+
+#include "HierarchicalPathfinder.h"
+#include "core/Assert.h"
+#include "core/Hash.h"
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <unordered_set>
+
+namespace voxelutil {
+
+namespace {
+
+/** the amount of neighbours of a voxel */
+constexpr int NeighbourCount = 26;
+/** the parent of the nodes that are directly connected to the start position */
+constexpr int StartNode = -1;
+/** the heap entries for the end position */
+constexpr int GoalNode = -2;
+
+struct Move {
+	glm::ivec3 offset;
+	float cost;
+};
+
+struct Moves {
+	Move moves[NeighbourCount];
+
+	Moves() {
+		int n = 0;
+		for (int y = -1; y <= 1; ++y) {
+			for (int z = -1; z <= 1; ++z) {
+				for (int x = -1; x <= 1; ++x) {
+					const int axes = glm::abs(x) + glm::abs(y) + glm::abs(z);
+					if (axes == 0) {
+						continue;
+					}
+					moves[n].offset = glm::ivec3(x, y, z);
+					moves[n].cost = axes == 1 ? 1.0f : (axes == 2 ? glm::root_two<float>() : glm::root_three<float>());
+					++n;
+				}
+			}
+		}
+	}
+};
+
+const Moves neighbours;
+
+/**
+ * @brief The exact cost of the shortest path without obstacles for 26-connected moves
+ */
+inline float octileDistance(const glm::ivec3& a, const glm::ivec3& b) {
+	int d[3] = { glm::abs(a.x - b.x), glm::abs(a.y - b.y), glm::abs(a.z - b.z) };
+	std::sort(d, d + 3);
+	return (glm::root_three<float>() - glm::root_two<float>()) * (float)d[0]
+			+ (glm::root_two<float>() - 1.0f) * (float)d[1] + (float)d[2];
+}
+
+inline int floorDiv(int value, int size) {
+	return (value >= 0 ? value : value - size + 1) / size;
+}
+
+inline void pushHeap(std::vector<std::pair<float, int> >& heap, float f, int node) {
+	heap.emplace_back(f, node);
+	std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<float, int> >());
+}
+
+inline std::pair<float, int> popHeap(std::vector<std::pair<float, int> >& heap) {
+	std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<float, int> >());
+	const std::pair<float, int> entry = heap.back();
+	heap.pop_back();
+	return entry;
+}
+
+}
+
+size_t HierarchicalPathfinder::BorderKeyHash::operator()(const BorderKey& key) const {
+	return (size_t)core::hash(&key, (int)sizeof(key));
+}
+
+size_t HierarchicalPathfinder::PathKeyHash::operator()(const PathKey& key) const {
+	return (size_t)core::hash(&key, (int)sizeof(key));
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(const PathValidatorFunc& validator, int clusterSize, int minY, int maxY,
+		int maxCachedPaths, int maxAbstractNodes) :
+		_validator(validator), _clusterSize(glm::max(2, clusterSize)), _minY(minY), _maxY(glm::max(minY, maxY)),
+		_height(_maxY - _minY + 1), _maxCachedPaths(maxCachedPaths), _maxAbstractNodes(maxAbstractNodes) {
+}
+
+glm::ivec2 HierarchicalPathfinder::clusterPos(int x, int z) const {
+	return glm::ivec2(floorDiv(x, _clusterSize), floorDiv(z, _clusterSize));
+}
+
+int HierarchicalPathfinder::localIndex(const Cluster& cluster, const glm::ivec3& pos) const {
+	const int x = pos.x - cluster.pos.x * _clusterSize;
+	const int z = pos.z - cluster.pos.y * _clusterSize;
+	const int y = pos.y - _minY;
+	return (y * _clusterSize + z) * _clusterSize + x;
+}
+
+glm::ivec3 HierarchicalPathfinder::worldPos(const Cluster& cluster, int index) const {
+	const int x = index % _clusterSize;
+	const int z = (index / _clusterSize) % _clusterSize;
+	const int y = index / (_clusterSize * _clusterSize);
+	return glm::ivec3(cluster.pos.x * _clusterSize + x, y + _minY, cluster.pos.y * _clusterSize + z);
+}
+
+bool HierarchicalPathfinder::isValid(const Cluster& cluster, int index) const {
+	return (cluster.valid[index >> 5] & (1u << (index & 31))) != 0u;
+}
+
+HierarchicalPathfinder::Cluster& HierarchicalPathfinder::cluster(const glm::ivec2& pos) {
+	auto i = _clusters.find(pos);
+	if (i != _clusters.end()) {
+		return i->second;
+	}
+	Cluster& c = _clusters[pos];
+	c.pos = pos;
+	return c;
+}
+
+int HierarchicalPathfinder::sample(Cluster& cluster) {
+	core_trace_scoped(PathfinderSampleCluster);
+	const int sliceSize = _clusterSize * _clusterSize;
+	if (cluster.sampledRows == 0) {
+		cluster.valid.assign((sliceSize * _height + 31) / 32, 0u);
+	}
+	// one row of columns per call - the columns are walked from the bottom to the top
+	const int z = cluster.sampledRows;
+	const int baseX = cluster.pos.x * _clusterSize;
+	const int baseZ = cluster.pos.y * _clusterSize;
+	for (int x = 0; x < _clusterSize; ++x) {
+		int index = z * _clusterSize + x;
+		for (int y = _minY; y <= _maxY; ++y, index += sliceSize) {
+			if (_validator(baseX + x, y, baseZ + z)) {
+				cluster.valid[index >> 5] |= 1u << (index & 31);
+			}
+		}
+	}
+	if (++cluster.sampledRows == _clusterSize) {
+		cluster.sampled = true;
+	}
+	return _clusterSize * _height;
+}
+
+int HierarchicalPathfinder::addPortal(const glm::ivec3& pos, const glm::ivec2& clusterPos) {
+	int id;
+	if (_freePortals.empty()) {
+		id = (int)_portals.size();
+		_portals.emplace_back();
+	} else {
+		id = _freePortals.back();
+		_freePortals.pop_back();
+	}
+	Portal& portal = _portals[id];
+	portal.pos = pos;
+	portal.cluster = clusterPos;
+	portal.partner = -1;
+	portal.partnerCost = 0.0f;
+	portal.edges.clear();
+	portal.used = true;
+	Cluster& c = cluster(clusterPos);
+	c.portals.push_back(id);
+	c.connected = 0u;
+	c.complete = false;
+	return id;
+}
+
+int HierarchicalPathfinder::buildBorder(Cluster& c, const glm::ivec2& neighbourPos) {
+	BorderKey key { c.pos, neighbourPos };
+	if (neighbourPos.x < c.pos.x || (neighbourPos.x == c.pos.x && neighbourPos.y < c.pos.y)) {
+		key = BorderKey { neighbourPos, c.pos };
+	}
+	if (_borders.find(key) != _borders.end()) {
+		return 0;
+	}
+	int work = 0;
+	const Cluster& n = cluster(neighbourPos);
+	core_assert_msg(n.sampled, "The neighbour must be sampled before the border is built");
+
+	// collect the moves from this cluster into the neighbour
+	const glm::ivec2 d = neighbourPos - c.pos;
+	const int minX = d.x == 1 ? _clusterSize - 1 : 0;
+	const int maxX = d.x == -1 ? 0 : _clusterSize - 1;
+	const int minZ = d.y == 1 ? _clusterSize - 1 : 0;
+	const int maxZ = d.y == -1 ? 0 : _clusterSize - 1;
+	std::vector<std::pair<glm::ivec3, glm::ivec3> > transitions;
+	int checked = 0;
+	for (int y = _minY; y <= _maxY; ++y) {
+		for (int z = minZ; z <= maxZ; ++z) {
+			for (int x = minX; x <= maxX; ++x) {
+				const glm::ivec3 a(c.pos.x * _clusterSize + x, y, c.pos.y * _clusterSize + z);
+				if (!isValid(c, localIndex(c, a))) {
+					continue;
+				}
+				for (const Move& move : neighbours.moves) {
+					const glm::ivec3 b = a + move.offset;
+					if (b.y < _minY || b.y > _maxY || clusterPos(b.x, b.z) != neighbourPos) {
+						continue;
+					}
+					++checked;
+					if (isValid(n, localIndex(n, b))) {
+						transitions.emplace_back(a, b);
+					}
+				}
+			}
+		}
+	}
+
+	// the connected transitions form an entrance - the one in the middle is used as portal
+	std::vector<int>& portals = _borders[key];
+	std::vector<uint8_t> assigned(transitions.size(), 0u);
+	std::vector<int> entrance;
+	for (size_t i = 0; i < transitions.size(); ++i) {
+		if (assigned[i]) {
+			continue;
+		}
+		entrance.clear();
+		entrance.push_back((int)i);
+		assigned[i] = 1u;
+		for (size_t e = 0; e < entrance.size(); ++e) {
+			const glm::ivec3& a = transitions[entrance[e]].first;
+			for (size_t j = i + 1; j < transitions.size(); ++j) {
+				if (assigned[j]) {
+					continue;
+				}
+				const glm::ivec3 delta = glm::abs(transitions[j].first - a);
+				if (delta.x <= 1 && delta.y <= 1 && delta.z <= 1) {
+					assigned[j] = 1u;
+					entrance.push_back((int)j);
+				}
+			}
+		}
+		work += (int)entrance.size();
+		std::sort(entrance.begin(), entrance.end());
+		const std::pair<glm::ivec3, glm::ivec3>& transition = transitions[entrance[entrance.size() / 2]];
+		const int pa = addPortal(transition.first, c.pos);
+		const int pb = addPortal(transition.second, neighbourPos);
+		const float cost = octileDistance(transition.first, transition.second);
+		_portals[pa].partner = pb;
+		_portals[pa].partnerCost = cost;
+		_portals[pb].partner = pa;
+		_portals[pb].partnerCost = cost;
+		portals.push_back(pa);
+		portals.push_back(pb);
+	}
+	return work + checked / NeighbourCount;
+}
+
+void HierarchicalPathfinder::removeBorder(const glm::ivec2& a, const glm::ivec2& b) {
+	BorderKey key { a, b };
+	if (b.x < a.x || (b.x == a.x && b.y < a.y)) {
+		key = BorderKey { b, a };
+	}
+	auto i = _borders.find(key);
+	if (i == _borders.end()) {
+		return;
+	}
+	for (int id : i->second) {
+		Portal& portal = _portals[id];
+		Cluster& c = cluster(portal.cluster);
+		c.portals.erase(std::find(c.portals.begin(), c.portals.end(), id));
+		c.connected = 0u;
+		c.complete = false;
+		portal.used = false;
+		portal.partner = -1;
+		portal.edges.clear();
+		_freePortals.push_back(id);
+	}
+	_borders.erase(i);
+}
+
+int HierarchicalPathfinder::complete(Cluster& c) {
+	core_trace_scoped(PathfinderCompleteCluster);
+	// one call samples one row of columns or connects one portal - the work is spread over several steps
+	if (!c.sampled) {
+		return sample(c);
+	}
+	for (int z = -1; z <= 1; ++z) {
+		for (int x = -1; x <= 1; ++x) {
+			Cluster& n = cluster(c.pos + glm::ivec2(x, z));
+			if (!n.sampled) {
+				return sample(n);
+			}
+		}
+	}
+	int work = 0;
+	if (c.connected == 0u) {
+		for (int z = -1; z <= 1; ++z) {
+			for (int x = -1; x <= 1; ++x) {
+				if (x != 0 || z != 0) {
+					work += buildBorder(c, c.pos + glm::ivec2(x, z));
+				}
+			}
+		}
+		for (int id : c.portals) {
+			_portals[id].edges.clear();
+		}
+	}
+	// the costs are symmetric - one search per portal is enough for both directions
+	if (c.connected < c.portals.size()) {
+		const int from = c.portals[c.connected];
+		work += searchLocal(c, localIndex(c, _portals[from].pos), -1);
+		for (size_t j = c.connected + 1u; j < c.portals.size(); ++j) {
+			const int to = c.portals[j];
+			const float cost = localCost(localIndex(c, _portals[to].pos));
+			if (cost == Unreachable) {
+				continue;
+			}
+			_portals[from].edges.push_back(Edge { to, cost });
+			_portals[to].edges.push_back(Edge { from, cost });
+		}
+		if (++c.connected < c.portals.size()) {
+			return work;
+		}
+	}
+	c.complete = true;
+	return work;
+}
+
+int HierarchicalPathfinder::searchLocal(const Cluster& c, int start, int goal) {
+	const int size = _clusterSize * _clusterSize * _height;
+	LocalSearch& s = _local;
+	if ((int)s.g.size() < size) {
+		s.g.resize(size);
+		s.parent.resize(size);
+		s.stamp.resize(size, 0u);
+		s.closed.resize(size);
+	}
+	if (++s.generation == 0u) {
+		std::fill(s.stamp.begin(), s.stamp.end(), 0u);
+		s.generation = 1u;
+	}
+	const uint32_t gen = s.generation;
+	const glm::ivec3 goalPos = goal >= 0 ? worldPos(c, goal) : glm::ivec3(0);
+	const int layer = _clusterSize * _clusterSize;
+
+	s.heap.clear();
+	s.stamp[start] = gen;
+	s.closed[start] = 0u;
+	s.g[start] = 0.0f;
+	s.parent[start] = -1;
+	pushHeap(s.heap, 0.0f, start);
+
+	int expanded = 0;
+	while (!s.heap.empty()) {
+		const int node = popHeap(s.heap).second;
+		if (s.closed[node]) {
+			continue;
+		}
+		s.closed[node] = 1u;
+		++expanded;
+		if (node == goal) {
+			break;
+		}
+		const int x = node % _clusterSize;
+		const int z = (node / _clusterSize) % _clusterSize;
+		const int y = node / layer;
+		const float g = s.g[node];
+		for (const Move& move : neighbours.moves) {
+			const int nx = x + move.offset.x;
+			const int ny = y + move.offset.y;
+			const int nz = z + move.offset.z;
+			if (nx < 0 || nz < 0 || ny < 0 || nx >= _clusterSize || nz >= _clusterSize || ny >= _height) {
+				continue;
+			}
+			const int n = (ny * _clusterSize + nz) * _clusterSize + nx;
+			if (!isValid(c, n)) {
+				continue;
+			}
+			const float ng = g + move.cost;
+			if (s.stamp[n] != gen) {
+				s.stamp[n] = gen;
+				s.closed[n] = 0u;
+			} else if (s.closed[n] || ng >= s.g[n]) {
+				continue;
+			}
+			s.g[n] = ng;
+			s.parent[n] = node;
+			float f = ng;
+			if (goal >= 0) {
+				f += octileDistance(glm::ivec3(nx, ny + _minY, nz) + glm::ivec3(c.pos.x * _clusterSize, 0, c.pos.y * _clusterSize), goalPos);
+			}
+			pushHeap(s.heap, f, n);
+		}
+	}
+	return expanded;
+}
+
+float HierarchicalPathfinder::localCost(int index) const {
+	if (_local.stamp[index] != _local.generation || !_local.closed[index]) {
+		return Unreachable;
+	}
+	return _local.g[index];
+}
+
+bool HierarchicalPathfinder::findCached(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& path) {
+	auto i = _cacheIndex.find(PathKey { start, end });
+	if (i == _cacheIndex.end()) {
+		return false;
+	}
+	// mark as recently used
+	_cache.splice(_cache.begin(), _cache, i->second);
+	path = i->second->path;
+	return true;
+}
+
+void HierarchicalPathfinder::cachePath(const glm::ivec3& start, const glm::ivec3& end, const std::vector<glm::ivec3>& path) {
+	if (_maxCachedPaths <= 0) {
+		return;
+	}
+	const PathKey key { start, end };
+	auto i = _cacheIndex.find(key);
+	if (i != _cacheIndex.end()) {
+		_cache.erase(i->second);
+		_cacheIndex.erase(i);
+	}
+	CachedPath cached;
+	cached.key = key;
+	cached.path = path;
+	for (const glm::ivec3& pos : path) {
+		const glm::ivec2 c = clusterPos(pos.x, pos.z);
+		if (std::find(cached.clusters.begin(), cached.clusters.end(), c) == cached.clusters.end()) {
+			cached.clusters.push_back(c);
+		}
+	}
+	_cache.push_front(std::move(cached));
+	_cacheIndex.emplace(key, _cache.begin());
+	while ((int)_cache.size() > _maxCachedPaths) {
+		_cacheIndex.erase(_cache.back().key);
+		_cache.pop_back();
+	}
+}
+
+void HierarchicalPathfinder::restart() {
+	_abstract.phase = AbstractSearch::Phase::Prepare;
+}
+
+void HierarchicalPathfinder::pushAbstract(int node, float g, int parent, const glm::ivec3& end) {
+	AbstractSearch& s = _abstract;
+	if ((int)s.g.size() <= node) {
+		const size_t size = _portals.size();
+		s.g.resize(size);
+		s.parent.resize(size);
+		s.stamp.resize(size, 0u);
+		s.closed.resize(size);
+	}
+	if (s.stamp[node] != s.generation) {
+		s.stamp[node] = s.generation;
+		s.closed[node] = 0u;
+	} else if (s.closed[node] || g >= s.g[node]) {
+		return;
+	}
+	s.g[node] = g;
+	s.parent[node] = parent;
+	pushHeap(s.heap, g + octileDistance(_portals[node].pos, end), node);
+}
+
+int HierarchicalPathfinder::prepare(const Request& request, PathState& state) {
+	AbstractSearch& s = _abstract;
+	s.version = _version;
+	if (request.start.y < _minY || request.start.y > _maxY || request.end.y < _minY || request.end.y > _maxY) {
+		state = PathState::Failed;
+		return 1;
+	}
+	// every step only completes one cluster
+	Cluster& startCluster = cluster(clusterPos(request.start.x, request.start.z));
+	if (!startCluster.complete) {
+		return complete(startCluster);
+	}
+	Cluster& endCluster = cluster(clusterPos(request.end.x, request.end.z));
+	if (!endCluster.complete) {
+		return complete(endCluster);
+	}
+	const int startIndex = localIndex(startCluster, request.start);
+	const int endIndex = localIndex(endCluster, request.end);
+	if (!isValid(startCluster, startIndex) || !isValid(endCluster, endIndex)) {
+		state = PathState::Failed;
+		return 1;
+	}
+	s.path.clear();
+	if (request.start == request.end) {
+		s.path.push_back(request.start);
+		state = PathState::Found;
+		return 1;
+	}
+
+	if (++s.generation == 0u) {
+		std::fill(s.stamp.begin(), s.stamp.end(), 0u);
+		s.generation = 1u;
+	}
+	s.heap.clear();
+	s.startEdges.clear();
+	s.goalEdges.clear();
+	s.goalCost = Unreachable;
+	s.goalParent = StartNode;
+	s.expanded = 0;
+
+	int work = searchLocal(startCluster, startIndex, -1);
+	for (int id : startCluster.portals) {
+		const float cost = localCost(localIndex(startCluster, _portals[id].pos));
+		if (cost != Unreachable) {
+			s.startEdges.push_back(Edge { id, cost });
+		}
+	}
+	if (&startCluster == &endCluster) {
+		s.goalCost = localCost(endIndex);
+	}
+	work += searchLocal(endCluster, endIndex, -1);
+	for (int id : endCluster.portals) {
+		const float cost = localCost(localIndex(endCluster, _portals[id].pos));
+		if (cost != Unreachable) {
+			s.goalEdges.emplace(id, cost);
+		}
+	}
+
+	if (s.goalCost != Unreachable) {
+		pushHeap(s.heap, s.goalCost, GoalNode);
+	}
+	for (const Edge& edge : s.startEdges) {
+		pushAbstract(edge.node, edge.cost, StartNode, request.end);
+	}
+	s.phase = AbstractSearch::Phase::Search;
+	return work;
+}
+
+int HierarchicalPathfinder::search(const Request& request, PathState& state) {
+	AbstractSearch& s = _abstract;
+	for (;;) {
+		if (s.heap.empty()) {
+			state = PathState::Failed;
+			return 1;
+		}
+		const std::pair<float, int> entry = popHeap(s.heap);
+		const int node = entry.second;
+		if (node == GoalNode) {
+			s.waypoints.clear();
+			s.waypoints.push_back(request.end);
+			for (int n = s.goalParent; n != StartNode; n = s.parent[n]) {
+				s.waypoints.push_back(_portals[n].pos);
+			}
+			s.waypoints.push_back(request.start);
+			std::reverse(s.waypoints.begin(), s.waypoints.end());
+			s.refined = 0u;
+			s.path.clear();
+			s.path.push_back(request.start);
+			s.phase = AbstractSearch::Phase::Refine;
+			return 1;
+		}
+		if (s.closed[node]) {
+			continue;
+		}
+		Cluster& c = cluster(_portals[node].cluster);
+		if (!c.complete) {
+			// the node is expanded once the edges of its cluster are known
+			pushHeap(s.heap, entry.first, node);
+			return 1 + complete(c);
+		}
+		s.closed[node] = 1u;
+		if (++s.expanded > _maxAbstractNodes) {
+			state = PathState::Failed;
+			return 1;
+		}
+		const float g = s.g[node];
+		const int work = 1;
+		const Portal& portal = _portals[node];
+		pushAbstract(portal.partner, g + portal.partnerCost, node, request.end);
+		for (const Edge& edge : portal.edges) {
+			pushAbstract(edge.node, g + edge.cost, node, request.end);
+		}
+		auto i = s.goalEdges.find(node);
+		if (i != s.goalEdges.end()) {
+			const float cost = g + i->second;
+			if (s.goalCost == Unreachable || cost < s.goalCost) {
+				s.goalCost = cost;
+				s.goalParent = node;
+				pushHeap(s.heap, cost, GoalNode);
+			}
+		}
+		return work;
+	}
+}
+
+int HierarchicalPathfinder::refine(const Request& request, PathState& state) {
+	AbstractSearch& s = _abstract;
+	const glm::ivec3& from = s.waypoints[s.refined];
+	const glm::ivec3& to = s.waypoints[s.refined + 1];
+	int work = 1;
+	const glm::ivec2 fromCluster = clusterPos(from.x, from.z);
+	if (from == to) {
+		// portals of different entrances might share a position
+	} else if (fromCluster != clusterPos(to.x, to.z)) {
+		// the move through an entrance
+		s.path.push_back(to);
+	} else {
+		const Cluster& c = cluster(fromCluster);
+		const int start = localIndex(c, from);
+		const int goal = localIndex(c, to);
+		work = searchLocal(c, start, goal);
+		if (localCost(goal) == Unreachable) {
+			state = PathState::Failed;
+			return work;
+		}
+		const size_t offset = s.path.size();
+		for (int n = goal; n != start; n = _local.parent[n]) {
+			s.path.push_back(worldPos(c, n));
+		}
+		std::reverse(s.path.begin() + offset, s.path.end());
+	}
+	if (++s.refined + 1 >= s.waypoints.size()) {
+		state = PathState::Found;
+	}
+	return work;
+}
+
+int HierarchicalPathfinder::step(const Request& request, PathState& state) {
+	if (_abstract.phase != AbstractSearch::Phase::Prepare && _abstract.version != _version) {
+		// the world changed while the request was processed
+		restart();
+	}
+	switch (_abstract.phase) {
+	case AbstractSearch::Phase::Prepare:
+		return prepare(request, state);
+	case AbstractSearch::Phase::Search:
+		return search(request, state);
+	case AbstractSearch::Phase::Refine:
+		return refine(request, state);
+	}
+	return 1;
+}
+
+void HierarchicalPathfinder::finish(const Request& request, PathState state) {
+	Result& result = _results[request.id];
+	result.state = state;
+	if (state == PathState::Found) {
+		result.path = std::move(_abstract.path);
+		cachePath(request.start, request.end, result.path);
+	}
+	_abstract.path.clear();
+	restart();
+}
+
+PathId HierarchicalPathfinder::request(const glm::ivec3& start, const glm::ivec3& end) {
+	const PathId id = _nextId++;
+	Result& result = _results[id];
+	if (_maxCachedPaths > 0 && findCached(start, end, result.path)) {
+		result.state = PathState::Found;
+		return id;
+	}
+	result.state = PathState::Queued;
+	_queue.push_back(Request { id, start, end });
+	return id;
+}
+
+void HierarchicalPathfinder::cancel(PathId id) {
+	_results.erase(id);
+	for (auto i = _queue.begin(); i != _queue.end(); ++i) {
+		if (i->id != id) {
+			continue;
+		}
+		if (i == _queue.begin()) {
+			restart();
+		}
+		_queue.erase(i);
+		return;
+	}
+}
+
+PathState HierarchicalPathfinder::state(PathId id) const {
+	auto i = _results.find(id);
+	if (i == _results.end()) {
+		return PathState::Unknown;
+	}
+	return i->second.state;
+}
+
+bool HierarchicalPathfinder::result(PathId id, std::vector<glm::ivec3>& path) {
+	auto i = _results.find(id);
+	if (i == _results.end() || i->second.state == PathState::Queued) {
+		return false;
+	}
+	const bool found = i->second.state == PathState::Found;
+	if (found) {
+		path = std::move(i->second.path);
+	}
+	_results.erase(i);
+	return found;
+}
+
+int HierarchicalPathfinder::update(int nodeBudget) {
+	core_trace_scoped(HierarchicalPathfinderUpdate);
+	int work = 0;
+	_updating = true;
+	while (!_queue.empty()) {
+		const Request& request = _queue.front();
+		PathState state = PathState::Queued;
+		work += step(request, state);
+		if (state != PathState::Queued) {
+			finish(request, state);
+			_queue.pop_front();
+		}
+		if (work >= nodeBudget) {
+			break;
+		}
+	}
+	_updating = false;
+	std::vector<voxel::Region> removals;
+	removals.swap(_removals);
+	for (const voxel::Region& region : removals) {
+		remove(region);
+	}
+	core_trace_plot("PathfinderQueueDepth", (int64_t)_queue.size());
+	return work;
+}
+
+void HierarchicalPathfinder::remove(const voxel::Region& region) {
+	if (_updating) {
+		// called by the validator - the clusters are still in use
+		_removals.push_back(region);
+		return;
+	}
+	const glm::ivec2 mins = clusterPos(region.getLowerX(), region.getLowerZ());
+	const glm::ivec2 maxs = clusterPos(region.getUpperX(), region.getUpperZ());
+	std::unordered_set<glm::ivec2, std::hash<glm::ivec2> > removed;
+	for (int z = mins.y; z <= maxs.y; ++z) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			const glm::ivec2 pos(x, z);
+			auto i = _clusters.find(pos);
+			if (i == _clusters.end()) {
+				continue;
+			}
+			// the borders have to go first - removing them looks up the clusters of the portals
+			for (int nz = -1; nz <= 1; ++nz) {
+				for (int nx = -1; nx <= 1; ++nx) {
+					if (nx == 0 && nz == 0) {
+						continue;
+					}
+					const glm::ivec2 neighbourPos = pos + glm::ivec2(nx, nz);
+					removeBorder(pos, neighbourPos);
+					auto n = _clusters.find(neighbourPos);
+					if (n != _clusters.end()) {
+						n->second.connected = 0u;
+						n->second.complete = false;
+					}
+				}
+			}
+			core_assert(i->second.portals.empty());
+			_clusters.erase(i);
+			removed.insert(pos);
+		}
+	}
+	if (removed.empty()) {
+		return;
+	}
+	++_version;
+	const auto touches = [&] (const glm::ivec2& c) {
+		return removed.find(c) != removed.end();
+	};
+	for (auto i = _cache.begin(); i != _cache.end();) {
+		if (std::any_of(i->clusters.begin(), i->clusters.end(), touches)) {
+			_cacheIndex.erase(i->key);
+			i = _cache.erase(i);
+		} else {
+			++i;
+		}
+	}
+	for (auto i = _queue.begin(); i != _queue.end();) {
+		if (!touches(clusterPos(i->start.x, i->start.z)) && !touches(clusterPos(i->end.x, i->end.z))) {
+			++i;
+			continue;
+		}
+		if (i == _queue.begin()) {
+			restart();
+		}
+		_results.erase(i->id);
+		i = _queue.erase(i);
+	}
+}
+
+void HierarchicalPathfinder::clear() {
+	_clusters.clear();
+	_borders.clear();
+	_portals.clear();
+	_freePortals.clear();
+	_queue.clear();
+	_results.clear();
+	_cache.clear();
+	_cacheIndex.clear();
+	_abstract = AbstractSearch();
+	_removals.clear();
+	++_version;
+}
+
+}
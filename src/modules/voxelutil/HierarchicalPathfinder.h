@@ -0,0 +1,323 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/Region.h"
+#include "core/Trace.h"
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace voxelutil {
+
+/**
+ * @brief Checks whether the given position can be part of a path - e.g. an empty voxel above a solid one
+ * @note Must be symmetric for the moves - the pathfinder treats every move between two valid positions as
+ * walkable in both directions
+ */
+using PathValidatorFunc = std::function<bool(int x, int y, int z)>;
+
+using PathId = uint32_t;
+
+enum class PathState {
+	/** the id is unknown or the result was already fetched */
+	Unknown,
+	Queued,
+	Found,
+	Failed
+};
+
+/**
+ * @brief Hierarchical (HPA*) pathfinder that spreads the queued requests over several ticks
+ *
+ * The world is split into clusters of @c clusterSize x @c clusterSize columns. The transitions between two
+ * neighbouring clusters are grouped into entrances, each one gets a pair of portal nodes. The portals of a
+ * cluster are connected by their path costs inside of the cluster. A request is first solved on this abstract
+ * graph, the portal path is then refined into voxel positions - one cluster at a time.
+ *
+ * The validator is only called once per voxel when a cluster is sampled, the searches run on the sampled
+ * bits. A cluster is sampled one row of columns per step - so the validator calls are spread over several ticks. The clusters and their portals are built lazily when a search reaches them and are kept until
+ * @c remove() is called for them. The low level search uses a binary heap and node arrays that are reused
+ * between the searches.
+ *
+ * The found paths are cached. Removing a cluster drops all cached paths that lead through it.
+ *
+ * The moves are 26-connected - the same costs as the @c voxel::AStarPathfinder with
+ * @c voxel::TwentySixConnected.
+ *
+ * @note Not thread safe - meant to be ticked by the owner of the world.
+ */
+class HierarchicalPathfinder {
+public:
+	/** a portal that was not reached by the search */
+	static constexpr float Unreachable = -1.0f;
+
+private:
+	struct Edge {
+		int node;
+		float cost;
+	};
+
+	struct Portal {
+		glm::ivec3 pos { 0 };
+		glm::ivec2 cluster { 0 };
+		/** the portal on the other side of the entrance */
+		int partner = -1;
+		float partnerCost = 0.0f;
+		/** the costs to the other portals of the same cluster */
+		std::vector<Edge> edges;
+		bool used = false;
+	};
+
+	struct Cluster {
+		glm::ivec2 pos { 0 };
+		/** one bit per voxel - set if the validator allows the voxel */
+		std::vector<uint32_t> valid;
+		std::vector<int> portals;
+		/** the rows of columns along the x axis that were already sampled */
+		int sampledRows = 0;
+		bool sampled = false;
+		/** the amount of portals whose edges are up to date */
+		size_t connected = 0u;
+		/** all borders are built and the portal edges are up to date */
+		bool complete = false;
+	};
+
+	struct BorderKey {
+		glm::ivec2 a;
+		glm::ivec2 b;
+		bool operator==(const BorderKey& other) const {
+			return a == other.a && b == other.b;
+		}
+	};
+	struct BorderKeyHash {
+		size_t operator()(const BorderKey& key) const;
+	};
+
+	struct PathKey {
+		glm::ivec3 start;
+		glm::ivec3 end;
+		bool operator==(const PathKey& other) const {
+			return start == other.start && end == other.end;
+		}
+	};
+	struct PathKeyHash {
+		size_t operator()(const PathKey& key) const;
+	};
+
+	struct CachedPath {
+		PathKey key;
+		std::vector<glm::ivec3> path;
+		/** the clusters the path leads through */
+		std::vector<glm::ivec2> clusters;
+	};
+
+	struct Request {
+		PathId id;
+		glm::ivec3 start;
+		glm::ivec3 end;
+	};
+
+	struct Result {
+		PathState state = PathState::Queued;
+		std::vector<glm::ivec3> path;
+	};
+
+	/** the low level search inside of one cluster */
+	struct LocalSearch {
+		std::vector<float> g;
+		std::vector<int> parent;
+		std::vector<uint32_t> stamp;
+		std::vector<uint8_t> closed;
+		/** entries are (f, node) - outdated entries are skipped when they are popped */
+		std::vector<std::pair<float, int> > heap;
+		uint32_t generation = 0u;
+	};
+
+	/** the abstract search of the active request */
+	struct AbstractSearch {
+		enum class Phase {
+			Prepare, Search, Refine
+		};
+		Phase phase = Phase::Prepare;
+		std::vector<float> g;
+		std::vector<int> parent;
+		std::vector<uint32_t> stamp;
+		std::vector<uint8_t> closed;
+		std::vector<std::pair<float, int> > heap;
+		uint32_t generation = 0u;
+		std::vector<Edge> startEdges;
+		std::unordered_map<int, float> goalEdges;
+		float goalCost = Unreachable;
+		int goalParent = -1;
+		int expanded = 0;
+		/** the abstract path - the nodes from start to end */
+		std::vector<glm::ivec3> waypoints;
+		size_t refined = 0u;
+		std::vector<glm::ivec3> path;
+		/** the world version the search was started in */
+		uint32_t version = 0u;
+	};
+
+	PathValidatorFunc _validator;
+	int _clusterSize;
+	int _minY;
+	int _maxY;
+	int _height;
+	int _maxCachedPaths;
+	int _maxAbstractNodes;
+
+	std::unordered_map<glm::ivec2, Cluster, std::hash<glm::ivec2> > _clusters;
+	std::unordered_map<BorderKey, std::vector<int>, BorderKeyHash> _borders;
+	std::vector<Portal> _portals;
+	std::vector<int> _freePortals;
+
+	std::list<Request> _queue;
+	std::unordered_map<PathId, Result> _results;
+	PathId _nextId = 1u;
+	/** increased whenever clusters are removed - the active request is restarted if it changes */
+	uint32_t _version = 0u;
+	/** set while @c update() runs - the validator might page out chunks and thus trigger a @c remove() */
+	bool _updating = false;
+	/** the regions that were removed while the clusters were in use - applied after the update */
+	std::vector<voxel::Region> _removals;
+
+	std::list<CachedPath> _cache;
+	std::unordered_map<PathKey, std::list<CachedPath>::iterator, PathKeyHash> _cacheIndex;
+
+	LocalSearch _local;
+	AbstractSearch _abstract;
+
+	glm::ivec2 clusterPos(int x, int z) const;
+	int localIndex(const Cluster& cluster, const glm::ivec3& pos) const;
+	glm::ivec3 worldPos(const Cluster& cluster, int index) const;
+	bool isValid(const Cluster& cluster, int index) const;
+
+	Cluster& cluster(const glm::ivec2& pos);
+	/**
+	 * @brief Samples the next row of columns of the cluster
+	 * @return The amount of validator calls
+	 */
+	int sample(Cluster& cluster);
+	int buildBorder(Cluster& cluster, const glm::ivec2& neighbour);
+	void removeBorder(const glm::ivec2& a, const glm::ivec2& b);
+	int addPortal(const glm::ivec3& pos, const glm::ivec2& cluster);
+	/**
+	 * @brief Samples the cluster and its neighbours, builds the missing borders and connects the portals
+	 *
+	 * Only one row of columns is sampled or one portal is connected per call - call it until the cluster is complete.
+	 * @return The work that was done
+	 */
+	int complete(Cluster& cluster);
+
+	/**
+	 * @brief Runs the low level search inside of the given cluster
+	 * @param[in] goal The local index of the goal, @c -1 to visit all reachable nodes
+	 * @return The amount of expanded nodes
+	 */
+	int searchLocal(const Cluster& cluster, int start, int goal);
+	float localCost(int index) const;
+
+	bool findCached(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& path);
+	void cachePath(const glm::ivec3& start, const glm::ivec3& end, const std::vector<glm::ivec3>& path);
+
+	void restart();
+	void pushAbstract(int node, float g, int parent, const glm::ivec3& end);
+	/**
+	 * @brief Does one step for the active request
+	 * @return The work that was done
+	 */
+	int step(const Request& request, PathState& state);
+	int prepare(const Request& request, PathState& state);
+	int search(const Request& request, PathState& state);
+	int refine(const Request& request, PathState& state);
+	void finish(const Request& request, PathState state);
+
+public:
+	/**
+	 * @param validator Called for each voxel of a cluster when the cluster is sampled
+	 * @param clusterSize The size of a cluster on the x and z axis
+	 * @param minY,maxY The vertical range the paths can lead through
+	 * @param maxCachedPaths The amount of paths that are kept - @c 0 disables the cache
+	 * @param maxAbstractNodes The max amount of portals a request may expand before giving up
+	 */
+	HierarchicalPathfinder(const PathValidatorFunc& validator, int clusterSize = 32, int minY = 0, int maxY = 255,
+			int maxCachedPaths = 1024, int maxAbstractNodes = 10000);
+
+	/**
+	 * @brief Queues a path request. If the path is cached, the request is already finished.
+	 * @sa update()
+	 * @sa result()
+	 */
+	PathId request(const glm::ivec3& start, const glm::ivec3& end);
+	/**
+	 * @brief Drops the request - or its result if the request was already processed
+	 */
+	void cancel(PathId id);
+	PathState state(PathId id) const;
+	/**
+	 * @brief Hands out the path of a finished request and forgets about the request
+	 * @return @c false if the request is not finished or no path was found
+	 */
+	bool result(PathId id, std::vector<glm::ivec3>& path);
+
+	/**
+	 * @brief Processes the queued requests until the given budget is used up
+	 *
+	 * The work is measured in expanded search nodes, sampling counts every validator call. A step samples at most
+	 * one row of columns of a cluster or connects one portal to the other portals of its cluster.
+	 * The steps are not split - so the budget can get exceeded by one step. At least one step is done per call.
+	 *
+	 * @return The work that was done
+	 */
+	int update(int nodeBudget);
+
+	/**
+	 * @brief Forgets about the clusters in the given region - e.g. because the chunk was paged out
+	 *
+	 * The clusters are built again if a later search reaches them. The cached paths that lead through them are
+	 * dropped and the queued requests that start or end in them are cancelled.
+	 * @note If called from within the validator, the clusters are removed at the end of @c update()
+	 */
+	void remove(const voxel::Region& region);
+	/**
+	 * @brief Drops all clusters, requests and cached paths
+	 */
+	void clear();
+
+	int pending() const;
+	int clusters() const;
+	int portals() const;
+	int cachedPaths() const;
+	int clusterSize() const;
+};
+
+inline int HierarchicalPathfinder::pending() const {
+	return (int)_queue.size();
+}
+
+inline int HierarchicalPathfinder::clusters() const {
+	return (int)_clusters.size();
+}
+
+inline int HierarchicalPathfinder::portals() const {
+	return (int)(_portals.size() - _freePortals.size());
+}
+
+inline int HierarchicalPathfinder::cachedPaths() const {
+	return (int)_cache.size();
+}
+
+inline int HierarchicalPathfinder::clusterSize() const {
+	return _clusterSize;
+}
+
+}
@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/RawVolume.h"
+#include <glm/common.hpp>
+#include <limits>
+
+namespace voxel {
+
+/**
+ * @brief Collects the bounds of the voxels that were written directly into the rows of a @c RawVolume
+ *
+ * Every slab of a parallel volume operation collects its own bounds - they are merged and applied to
+ * the volume once all slabs are done.
+ *
+ * @sa RawVolume::row()
+ * @sa RawVolume::accumulateBounds()
+ */
+struct VolumeBounds {
+	glm::ivec3 mins { (std::numeric_limits<int32_t>::max)() };
+	glm::ivec3 maxs { (std::numeric_limits<int32_t>::min)() };
+	bool valid = false;
+
+	inline void add(const glm::ivec3& pos) {
+		mins = (glm::min)(mins, pos);
+		maxs = (glm::max)(maxs, pos);
+		valid = true;
+	}
+
+	inline void add(const VolumeBounds& other) {
+		if (!other.valid) {
+			return;
+		}
+		mins = (glm::min)(mins, other.mins);
+		maxs = (glm::max)(maxs, other.maxs);
+		valid = true;
+	}
+
+	inline void apply(RawVolume& volume) const {
+		if (valid) {
+			volume.accumulateBounds(mins, maxs);
+		}
+	}
+};
+
+}
@@ -10,7 +10,7 @@
 
 namespace voxel {
 
-RawVolume* merge(const core::DynamicArray<const RawVolume*>& volumes) {
+static RawVolume* merge(core::ThreadPool* threadPool, const core::DynamicArray<const RawVolume*>& volumes) {
 	glm::ivec3 mins((std::numeric_limits<int32_t>::max)() / 2);
 	glm::ivec3 maxs((std::numeric_limits<int32_t>::min)() / 2);
 	for (const voxel::RawVolume* v : volumes) {
@@ -34,9 +34,21 @@ RawVolume* merge(const core::DynamicArray<const RawVolume*>& volumes) {
 				sr.getUpperX(), sr.getUpperY(), sr.getUpperZ(),
 				dr.getLowerX(), dr.getLowerY(), dr.getLowerZ(),
 				dr.getUpperX(), dr.getUpperY(), dr.getUpperZ());
-		voxel::mergeVolumes(merged, v, dr, sr);
+		if (threadPool != nullptr) {
+			voxel::mergeVolumesParallel(*threadPool, merged, v, dr, sr);
+		} else {
+			voxel::mergeVolumes(merged, v, dr, sr);
+		}
 	}
 	return merged;
 }
 
+RawVolume* merge(const core::DynamicArray<const RawVolume*>& volumes) {
+	return merge(nullptr, volumes);
+}
+
+RawVolume* merge(core::ThreadPool& threadPool, const core::DynamicArray<const RawVolume*>& volumes) {
+	return merge(&threadPool, volumes);
+}
+
 }
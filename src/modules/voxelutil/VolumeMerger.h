@@ -6,8 +6,13 @@
 
 #include "core/collection/DynamicArray.h"
 #include "voxel/RawVolume.h"
+#include "VolumeBounds.h"
 #include "core/Trace.h"
 #include "core/Assert.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/Parallel.h"
+#include <type_traits>
 
 namespace voxel {
 
@@ -20,6 +25,55 @@ struct MergeSkipEmpty {
 	}
 };
 
+/**
+ * @brief Merges the z slices [@c zStart, @c zEnd) of the source region row by row
+ * @note The bounds of the destination volume are not updated - the touched area is accumulated
+ * into @c bounds instead.
+ * @return The amount of modified voxels
+ */
+template<typename MergeCondition>
+int mergeRawVolumesSlab(RawVolume* destination, const RawVolume* source, const Region& destReg, const Region& sourceReg,
+		int32_t zStart, int32_t zEnd, MergeCondition& mergeCondition, VolumeBounds& bounds) {
+	// the source x range that ends up in the destination region (and the destination volume)
+	const glm::ivec3 offset = destReg.getLowerCorner() - sourceReg.getLowerCorner();
+	const Region& srcVolumeReg = source->region();
+	const Region& destVolumeReg = destination->region();
+	const int32_t destLowerX = core_max(destReg.getLowerX(), destVolumeReg.getLowerX());
+	const int32_t destUpperX = core_min(destReg.getUpperX(), destVolumeReg.getUpperX());
+	const int32_t xStart = core_max(core_max(sourceReg.getLowerX(), srcVolumeReg.getLowerX()), destLowerX - offset.x);
+	const int32_t xEnd = core_min(core_min(sourceReg.getUpperX(), srcVolumeReg.getUpperX()), destUpperX - offset.x);
+	if (xStart > xEnd) {
+		return 0;
+	}
+	int cnt = 0;
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		const int32_t destZ = z + offset.z;
+		if (!srcVolumeReg.containsPointInZ(z) || !destReg.containsPointInZ(destZ) || !destVolumeReg.containsPointInZ(destZ)) {
+			continue;
+		}
+		for (int32_t y = sourceReg.getLowerY(); y <= sourceReg.getUpperY(); ++y) {
+			const int32_t destY = y + offset.y;
+			if (!srcVolumeReg.containsPointInY(y) || !destReg.containsPointInY(destY) || !destVolumeReg.containsPointInY(destY)) {
+				continue;
+			}
+			const Voxel* srcRow = source->row(y, z) + (xStart - srcVolumeReg.getLowerX());
+			Voxel* destRow = destination->row(destY, destZ) + (xStart + offset.x - destVolumeReg.getLowerX());
+			for (int32_t x = xStart; x <= xEnd; ++x, ++srcRow, ++destRow) {
+				if (!mergeCondition(*srcRow)) {
+					continue;
+				}
+				if (destRow->isSame(*srcRow)) {
+					continue;
+				}
+				*destRow = *srcRow;
+				bounds.add(glm::ivec3(x + offset.x, destY, destZ));
+				++cnt;
+			}
+		}
+	}
+	return cnt;
+}
+
 /**
  * @note This version can deal with source volumes that are smaller or equal sized to the destination volume
  * @note The given merge condition function must return false for voxels that should be skipped.
@@ -28,6 +82,12 @@ struct MergeSkipEmpty {
 template<typename MergeCondition = MergeSkipEmpty, class Volume1, class Volume2>
 int mergeVolumes(Volume1* destination, const Volume2* source, const Region& destReg, const Region& sourceReg, MergeCondition mergeCondition = MergeCondition()) {
 	core_trace_scoped(MergeRawVolumes);
+	if constexpr (std::is_same<Volume1, RawVolume>::value && std::is_same<Volume2, RawVolume>::value) {
+		VolumeBounds bounds;
+		const int cnt = mergeRawVolumesSlab(destination, source, destReg, sourceReg, sourceReg.getLowerZ(), sourceReg.getUpperZ() + 1, mergeCondition, bounds);
+		bounds.apply(*destination);
+		return cnt;
+	}
 	int cnt = 0;
 	for (int32_t z = sourceReg.getLowerZ(); z <= sourceReg.getUpperZ(); ++z) {
 		const int destZ = destReg.getLowerZ() + z - sourceReg.getLowerZ();
@@ -51,6 +111,32 @@ int mergeVolumes(Volume1* destination, const Volume2* source, const Region& dest
 	return cnt;
 }
 
+/**
+ * @brief Parallel version of @c mergeVolumes() for @c RawVolume instances. The source region is split into slabs
+ * along the z axis that are merged on the given thread pool.
+ * @note The merge condition is copied for every slab and called concurrently.
+ */
+template<typename MergeCondition = MergeSkipEmpty>
+int mergeVolumesParallel(core::ThreadPool& threadPool, RawVolume* destination, const RawVolume* source, const Region& destReg, const Region& sourceReg, MergeCondition mergeCondition = MergeCondition()) {
+	core_trace_scoped(MergeRawVolumesParallel);
+	core::AtomicInt cnt { 0 };
+	core::Lock lock;
+	VolumeBounds bounds;
+	core::parallelFor(threadPool, sourceReg.getLowerZ(), sourceReg.getUpperZ() + 1, [&] (int zStart, int zEnd) {
+		MergeCondition sliceCondition = mergeCondition;
+		VolumeBounds sliceBounds;
+		const int sliceCnt = mergeRawVolumesSlab(destination, source, destReg, sourceReg, zStart, zEnd, sliceCondition, sliceBounds);
+		if (sliceCnt <= 0) {
+			return;
+		}
+		cnt.increment(sliceCnt);
+		core::ScopedLock scopedLock(lock);
+		bounds.add(sliceBounds);
+	});
+	bounds.apply(*destination);
+	return cnt;
+}
+
 /**
  * The given merge condition function must return false for voxels that should be skipped.
  * @sa MergeSkipEmpty
@@ -62,5 +148,9 @@ inline int mergeRawVolumesSameDimension(RawVolume* destination, const RawVolume*
 }
 
 extern RawVolume* merge(const core::DynamicArray<const RawVolume*>& volumes);
+/**
+ * @brief Merges the volumes with @c mergeVolumesParallel()
+ */
+extern RawVolume* merge(core::ThreadPool& threadPool, const core::DynamicArray<const RawVolume*>& volumes);
 
 }
@@ -0,0 +1,272 @@
+/**
+ * @file
+ */
+
+#include "VolumeRescaler.h"
+#include "VolumeBounds.h"
+#include "voxel/RawVolume.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/Parallel.h"
+#include "core/concurrent/ThreadPool.h"
+#include <string.h>
+#include <vector>
+
+namespace voxel {
+
+namespace {
+
+/**
+ * @brief Caches the results of @c core::Color::getClosestMatch() - the lookup compares the color against the
+ * whole palette and is by far the most expensive part of the rescaling. Neighbouring voxels usually produce
+ * the same average colors.
+ */
+class ClosestMatchCache {
+private:
+	static constexpr uint32_t Size = 1024u;
+	struct Entry {
+		glm::vec4 color;
+		int index = -1;
+	};
+	std::vector<Entry> _entries;
+	const MaterialColorArray& _colors;
+
+public:
+	ClosestMatchCache(const MaterialColorArray& colors) : _entries(Size), _colors(colors) {
+	}
+
+	int get(const glm::vec4& color) {
+		uint32_t bits[3];
+		memcpy(&bits[0], &color.r, sizeof(uint32_t));
+		memcpy(&bits[1], &color.g, sizeof(uint32_t));
+		memcpy(&bits[2], &color.b, sizeof(uint32_t));
+		const uint32_t hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		Entry& entry = _entries[(hash ^ (hash >> 16)) & (Size - 1u)];
+		if (entry.index != -1 && entry.color == color) {
+			return entry.index;
+		}
+		entry.color = color;
+		entry.index = core::Color::getClosestMatch(color, _colors);
+		return entry.index;
+	}
+};
+
+/**
+ * @brief Computes the destination voxels of the z slices [@c zStart, @c zEnd) (relative to the destination region)
+ * as the average of the eight corresponding voxels in the source volume.
+ */
+void downsampleSlab(const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion,
+		int32_t zStart, int32_t zEnd, VolumeBounds& bounds) {
+	const MaterialColorArray& colors = getMaterialColors();
+	ClosestMatchCache cache(colors);
+	const Region& srcVolumeRegion = sourceVolume.region();
+	const Region& destVolumeRegion = destVolume.region();
+	const int32_t width = destRegion.getWidthInVoxels();
+	const int32_t height = destRegion.getHeightInVoxels();
+	const glm::ivec3& srcLower = sourceRegion.getLowerCorner();
+	const glm::ivec3& dstLower = destRegion.getLowerCorner();
+
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = 0; y < height; ++y) {
+			// the source rows of the 2x2 children in y and z - in the same order as the
+			// generic version sums them up (z, y, x)
+			const Voxel* rows[4];
+			int numRows = 0;
+			for (int32_t childZ = 0; childZ < 2; ++childZ) {
+				const int32_t srcZ = srcLower.z + z * 2 + childZ;
+				if (!srcVolumeRegion.containsPointInZ(srcZ)) {
+					continue;
+				}
+				for (int32_t childY = 0; childY < 2; ++childY) {
+					const int32_t srcY = srcLower.y + y * 2 + childY;
+					if (!srcVolumeRegion.containsPointInY(srcY)) {
+						continue;
+					}
+					rows[numRows++] = sourceVolume.row(srcY, srcZ);
+				}
+			}
+			const glm::ivec3 dstRowPos(dstLower.x, dstLower.y + y, dstLower.z + z);
+			Voxel* destRow = destVolume.row(dstRowPos.y, dstRowPos.z) + (dstRowPos.x - destVolumeRegion.getLowerX());
+			for (int32_t x = 0; x < width; ++x) {
+				const int32_t srcX = srcLower.x + x * 2;
+				int solidVoxels = 0;
+				glm::vec4 sum(0.0f);
+				for (int r = 0; r < numRows; ++r) {
+					for (int32_t childX = 0; childX < 2; ++childX) {
+						if (!srcVolumeRegion.containsPointInX(srcX + childX)) {
+							continue;
+						}
+						const Voxel& child = rows[r][srcX + childX - srcVolumeRegion.getLowerX()];
+						if (isBlocked(child.getMaterial())) {
+							++solidVoxels;
+							sum += colors[child.getColor()];
+						}
+					}
+				}
+
+				// We only make a voxel solid if the eight corresponding voxels are also all solid. This
+				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
+				Voxel voxel;
+				if (solidVoxels >= 7) {
+					const float n = (float)solidVoxels;
+					const glm::vec4 avgColor(sum.r / n, sum.g / n, sum.b / n, 1.0f);
+					voxel = createVoxel(VoxelType::Generic, cache.get(avgColor));
+				}
+				if (!destRow[x].isSame(voxel)) {
+					destRow[x] = voxel;
+					bounds.add(glm::ivec3(dstRowPos.x + x, dstRowPos.y, dstRowPos.z));
+				}
+			}
+		}
+	}
+}
+
+struct DestVoxel {
+	glm::ivec3 pos;
+	Voxel voxel;
+};
+
+/**
+ * @brief Recomputes the colors of the voxels on a material-air boundary with a larger neighbourhood
+ * @note The new voxels are only collected - the neighbours of the voxels in the adjacent slabs are read while
+ * other threads are working on them.
+ */
+void recolorBoundarySlab(const RawVolume& sourceVolume, const Region& sourceRegion, const RawVolume& destVolume, const Region& destRegion,
+		int32_t zStart, int32_t zEnd, std::vector<DestVoxel>& result) {
+	const MaterialColorArray& colors = getMaterialColors();
+	ClosestMatchCache cache(colors);
+	RawVolume::Sampler srcSampler(sourceVolume);
+	RawVolume::Sampler dstSampler(destVolume);
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = 0; y < destRegion.getHeightInVoxels(); ++y) {
+			for (int32_t x = 0; x < destRegion.getWidthInVoxels(); ++x) {
+				const glm::ivec3 curPos(x, y, z);
+				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
+
+				dstSampler.setPosition(dstPos);
+
+				// Skip empty voxels
+				if (dstSampler.voxel().getMaterial() == VoxelType::Air) {
+					continue;
+				}
+				// Only process voxels on a material-air boundary.
+				if (dstSampler.peekVoxel0px0py1nz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel0px0py1pz().getMaterial() != VoxelType::Air
+						&& dstSampler.peekVoxel0px1ny0pz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel0px1py0pz().getMaterial() != VoxelType::Air
+						&& dstSampler.peekVoxel1nx0py0pz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel1px0py0pz().getMaterial() != VoxelType::Air) {
+					continue;
+				}
+				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
+
+				glm::vec4 total(0.0f);
+				float totalExposedFaces = 0.0f;
+
+				// Look at the 64 (4x4x4) children
+				for (int32_t childZ = -1; childZ < 3; childZ++) {
+					for (int32_t childY = -1; childY < 3; childY++) {
+						for (int32_t childX = -1; childX < 3; childX++) {
+							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
+
+							const Voxel& child = srcSampler.voxel();
+							if (child.getMaterial() == VoxelType::Air) {
+								continue;
+							}
+
+							// For each small voxel, count the exposed faces and use this
+							// to determine the importance of the color contribution.
+							float exposedFaces = 0.0f;
+							if (srcSampler.peekVoxel0px0py1nz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+							if (srcSampler.peekVoxel0px0py1pz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+							if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+							if (srcSampler.peekVoxel0px1py0pz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+							if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+							if (srcSampler.peekVoxel1px0py0pz().getMaterial() == VoxelType::Air) {
+								++exposedFaces;
+							}
+
+							total += colors[child.getColor()] * exposedFaces;
+							totalExposedFaces += exposedFaces;
+						}
+					}
+				}
+
+				// Avoid divide by zero if there were no exposed faces.
+				if (totalExposedFaces <= 0.01f) {
+					++totalExposedFaces;
+				}
+
+				const glm::vec4 avgColor(total.r / totalExposedFaces, total.g / totalExposedFaces, total.b / totalExposedFaces, 1.0f);
+				result.push_back({dstPos, createVoxel(VoxelType::Generic, cache.get(avgColor))});
+			}
+		}
+	}
+}
+
+void rescale(core::ThreadPool* threadPool, const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion) {
+	core_trace_scoped(RescaleVolume);
+	const int32_t depth = destRegion.getDepthInVoxels();
+
+	VolumeBounds bounds;
+	core::Lock lock;
+	auto downsample = [&] (int zStart, int zEnd) {
+		VolumeBounds sliceBounds;
+		downsampleSlab(sourceVolume, sourceRegion, destVolume, destRegion, zStart, zEnd, sliceBounds);
+		core::ScopedLock scopedLock(lock);
+		bounds.add(sliceBounds);
+	};
+	if (threadPool == nullptr) {
+		downsample(0, depth);
+	} else {
+		core::parallelFor(*threadPool, 0, depth, downsample);
+	}
+	bounds.apply(destVolume);
+
+	// At this point the results are usable, but we have a problem with thin structures disappearing.
+	// For example, if we have a solid blue sphere with a one voxel thick layer of red voxels on it,
+	// then we don't care that the shape changes then the red voxels are lost but we do care that the
+	// color changes, as this is very noticable. Our solution is to process again only those voxels
+	// which lie on a material-air boundary, and to recompute their color using a larger naighbourhood
+	// while also accounting for how visible the child voxels are.
+	std::vector<std::vector<DestVoxel>> boundaryVoxels(depth);
+	auto recolor = [&] (int zStart, int zEnd) {
+		recolorBoundarySlab(sourceVolume, sourceRegion, destVolume, destRegion, zStart, zEnd, boundaryVoxels[zStart]);
+	};
+	if (threadPool == nullptr) {
+		recolor(0, depth);
+	} else {
+		core::parallelFor(*threadPool, 0, depth, recolor);
+	}
+	for (const std::vector<DestVoxel>& slab : boundaryVoxels) {
+		for (const DestVoxel& v : slab) {
+			destVolume.setVoxel(v.pos, v.voxel);
+		}
+	}
+}
+
+}
+
+void rescaleVolume(const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion) {
+	rescale(nullptr, sourceVolume, sourceRegion, destVolume, destRegion);
+}
+
+void rescaleVolume(const RawVolume& sourceVolume, RawVolume& destVolume) {
+	rescale(nullptr, sourceVolume, sourceVolume.region(), destVolume, destVolume.region());
+}
+
+void rescaleVolume(core::ThreadPool& threadPool, const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion) {
+	rescale(&threadPool, sourceVolume, sourceRegion, destVolume, destRegion);
+}
+
+void rescaleVolume(core::ThreadPool& threadPool, const RawVolume& sourceVolume, RawVolume& destVolume) {
+	rescale(&threadPool, sourceVolume, sourceVolume.region(), destVolume, destVolume.region());
+}
+
+}
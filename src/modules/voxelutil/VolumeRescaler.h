@@ -5,12 +5,31 @@
 
 #include "core/Common.h"
 #include "core/Color.h"
+#include "core/Trace.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Voxel.h"
 #include "voxel/Region.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 
+class RawVolume;
+
+/**
+ * @brief Rescales a @c RawVolume - same algorithm as the generic version, but the voxels are accessed row by
+ * row and the palette lookups are cached.
+ */
+void rescaleVolume(const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion);
+void rescaleVolume(const RawVolume& sourceVolume, RawVolume& destVolume);
+/**
+ * @brief Splits the destination region into slabs along the z axis that are rescaled on the given thread pool
+ */
+void rescaleVolume(core::ThreadPool& threadPool, const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion);
+void rescaleVolume(core::ThreadPool& threadPool, const RawVolume& sourceVolume, RawVolume& destVolume);
+
 /**
  * @brief Rescales a volume by sampling two voxels to produce one output voxel.
  * @param[in] sourceVolume The source volume to resample
@@ -166,6 +185,85 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 	}
 }
 
+/**
+ * @brief Halves the resolution of a volume by picking the most common voxel of the (up to) eight corresponding
+ * source voxels. A destination voxel becomes solid if at least half of the source voxels that are inside the
+ * source region are solid.
+ *
+ * Other than @c rescaleVolume() no new colors are computed - this keeps the material of the voxels and is meant
+ * to build the levels of detail. Thin structures survive a little longer than with @c rescaleVolume(), as the
+ * coarser levels don't shrink away.
+ *
+ * @param[in] sourceRegion The region of the source volume - children outside of this region are ignored
+ * @param[in] destRegion The destination voxel @c destRegion.getLowerCorner() + p is computed from the source voxels
+ * @c sourceRegion.getLowerCorner() + p * 2 + [0,1]
+ */
+template<typename SourceVolume, typename DestVolume>
+void downsampleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion, DestVolume& destVolume, const Region& destRegion) {
+	core_trace_scoped(DownsampleVolume);
+	typename SourceVolume::Sampler srcSampler(sourceVolume);
+
+	const int32_t depth = destRegion.getDepthInVoxels();
+	const int32_t height = destRegion.getHeightInVoxels();
+	const int32_t width = destRegion.getWidthInVoxels();
+	for (int32_t z = 0; z < depth; ++z) {
+		for (int32_t y = 0; y < height; ++y) {
+			for (int32_t x = 0; x < width; ++x) {
+				const glm::ivec3 curPos(x, y, z);
+				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
+
+				Voxel solid[8];
+				int counts[8];
+				int numSolid = 0;
+				int numChildren = 0;
+				int numDifferent = 0;
+				for (int32_t childZ = 0; childZ < 2; ++childZ) {
+					for (int32_t childY = 0; childY < 2; ++childY) {
+						for (int32_t childX = 0; childX < 2; ++childX) {
+							const glm::ivec3 childPos = srcPos + glm::ivec3(childX, childY, childZ);
+							if (!sourceRegion.containsPoint(childPos)) {
+								continue;
+							}
+							++numChildren;
+							srcSampler.setPosition(childPos);
+							const Voxel& child = srcSampler.voxel();
+							if (!isBlocked(child.getMaterial())) {
+								continue;
+							}
+							++numSolid;
+							int i = 0;
+							for (; i < numDifferent; ++i) {
+								if (solid[i].isSame(child)) {
+									++counts[i];
+									break;
+								}
+							}
+							if (i == numDifferent) {
+								solid[numDifferent] = child;
+								counts[numDifferent] = 1;
+								++numDifferent;
+							}
+						}
+					}
+				}
+
+				Voxel voxel;
+				if (numSolid > 0 && numSolid * 2 >= numChildren) {
+					// ties are resolved in favour of the first voxel in z, y, x order
+					int best = 0;
+					for (int i = 1; i < numDifferent; ++i) {
+						if (counts[i] > counts[best]) {
+							best = i;
+						}
+					}
+					voxel = solid[best];
+				}
+				destVolume.setVoxel(destRegion.getLowerCorner() + curPos, voxel);
+			}
+		}
+	}
+}
+
 template<typename SourceVolume, typename DestVolume>
 void rescaleVolume(const SourceVolume& sourceVolume, DestVolume& destVolume) {
 	rescaleVolume(sourceVolume, sourceVolume.region(), destVolume, destVolume.region());
@@ -3,25 +3,72 @@
  */
 
 #include "VolumeRotator.h"
+#include "VolumeBounds.h"
 #include "voxel/RawVolume.h"
 #include "math/AABB.h"
 #include "core/GLM.h"
 #include "core/Assert.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/Parallel.h"
+#include "core/concurrent/ThreadPool.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/euler_angles.hpp>
+#include <vector>
 
 namespace voxel {
 
+namespace {
+
 /**
- * @param[in] source The RawVolume to rotate
- * @param[in] angles The angles for the x, y and z axis given in degrees
- * @param[in] increaseSize If you rotate e.g. by 45 degree, the rotated volume
- * would have a bigger size as the source volume. You can define that you would
- * like to cut it to the source volume size with this flag.
- * @return A new RawVolume. It's the caller's responsibility to free this
- * memory.
+ * @brief Executes the given functor for the z slices [@c start, @c end) - either in the calling thread or
+ * split into slabs on the given thread pool.
  */
-RawVolume* rotateVolume(const RawVolume* source, const glm::vec3& angles, const Voxel& empty, const glm::vec3& pivot, bool increaseSize) {
+template<class FUNC>
+void forEachSlab(core::ThreadPool* threadPool, int32_t start, int32_t end, FUNC&& func) {
+	if (threadPool == nullptr) {
+		func(start, end);
+	} else {
+		core::parallelFor(*threadPool, start, end, func);
+	}
+}
+
+/**
+ * @brief Rotates the non-empty voxels of the source z slices [@c zStart, @c zEnd) and hands the ones that
+ * end up in the destination region over to the given functor.
+ */
+template<class FUNC>
+void rotateSlab(const RawVolume* source, const glm::mat4& rot, const Voxel& empty, const glm::vec3& pivot, const Region& destRegion,
+		int32_t zStart, int32_t zEnd, FUNC&& func) {
+	const voxel::Region& srcRegion = source->region();
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+			const Voxel* row = source->row(y, z);
+			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x, ++row) {
+				const Voxel& v = *row;
+				if (v == empty) {
+					continue;
+				}
+				const glm::vec3 pos(x - pivot.x, y - pivot.y, z - pivot.z);
+				const glm::vec3 rotatedPos = glm::rotate(rot, pos);
+				const glm::vec3 newPos = rotatedPos + pivot;
+				const glm::ivec3 volumePos(newPos);
+				if (!destRegion.containsPoint(volumePos)) {
+					continue;
+				}
+				func(volumePos, v);
+			}
+		}
+	}
+}
+
+struct RotatedVoxel {
+	glm::ivec3 pos;
+	Voxel voxel;
+};
+
+RawVolume* rotate(core::ThreadPool* threadPool, const RawVolume* source, const glm::vec3& angles, const Voxel& empty, const glm::vec3& pivot, bool increaseSize) {
+	core_trace_scoped(RotateVolume);
 	const float pitch = glm::radians(angles.x);
 	const float yaw = glm::radians(angles.y);
 	const float roll = glm::radians(angles.z);
@@ -48,36 +95,82 @@ RawVolume* rotateVolume(const RawVolume* source, const glm::vec3& angles, const
 		destRegion = srcRegion;
 	}
 	voxel::RawVolume* destination = new RawVolume(destRegion);
-	voxel::RawVolume::Sampler destSampler(destination);
-	voxel::RawVolume::Sampler srcSampler(source);
+	// several source voxels might end up at the same position - the first one wins
+	auto setVoxel = [&] (const glm::ivec3& pos, const Voxel& v) {
+		if (destination->voxel(pos) == empty) {
+			destination->setVoxel(pos, v);
+		}
+	};
 
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-				srcSampler.setPosition(x, y, z);
-				const Voxel& v = srcSampler.voxel();
-				if (v == empty) {
-					continue;
-				}
-				const glm::vec3 pos(x - pivot.x, y - pivot.y, z - pivot.z);
-				const glm::vec3 rotatedPos = glm::rotate(rot, pos);
-				const glm::vec3 newPos = rotatedPos + pivot;
-				const glm::ivec3 volumePos(newPos);
-				if (!destRegion.containsPoint(volumePos)) {
-					continue;
-				}
+	const int32_t lowerZ = srcRegion.getLowerZ();
+	if (threadPool == nullptr) {
+		rotateSlab(source, rot, empty, pivot, destRegion, lowerZ, srcRegion.getUpperZ() + 1, setVoxel);
+		return destination;
+	}
 
-				destSampler.setPosition(volumePos);
-				if (destSampler.voxel() == empty) {
-					destSampler.setVoxel(v);
+	// the rotation is done in parallel - the voxels are placed in the order of the source slices
+	// afterwards to get the same result as the serial version
+	std::vector<std::vector<RotatedVoxel>> slabs(srcRegion.getDepthInVoxels());
+	core::parallelFor(*threadPool, lowerZ, srcRegion.getUpperZ() + 1, [&] (int zStart, int zEnd) {
+		std::vector<RotatedVoxel>& voxels = slabs[zStart - lowerZ];
+		rotateSlab(source, rot, empty, pivot, destRegion, zStart, zEnd, [&] (const glm::ivec3& pos, const Voxel& v) {
+			voxels.push_back({pos, v});
+		});
+	});
+	for (const std::vector<RotatedVoxel>& voxels : slabs) {
+		for (const RotatedVoxel& v : voxels) {
+			setVoxel(v.pos, v.voxel);
+		}
+	}
+	return destination;
+}
+
+/**
+ * @brief Swapping the two axes is its own inverse - this maps source to destination positions and vice versa
+ */
+inline glm::ivec3 swapAxis(const glm::ivec3& pos, math::Axis axis) {
+	if (axis == math::Axis::X) {
+		return glm::ivec3(pos.x, pos.z, pos.y);
+	}
+	if (axis == math::Axis::Y) {
+		return glm::ivec3(pos.z, pos.y, pos.x);
+	}
+	return glm::ivec3(pos.y, pos.x, pos.z);
+}
+
+/**
+ * @brief Fills the destination z slices [@c zStart, @c zEnd) by reading the swapped source positions
+ */
+void rotateAxisSlab(const RawVolume* source, RawVolume* destination, math::Axis axis, int32_t zStart, int32_t zEnd, VolumeBounds& bounds) {
+	const voxel::Region& srcRegion = source->region();
+	const voxel::Region& destRegion = destination->region();
+	// the distance in the source volume between two voxels that are neighbours on the x axis of the destination
+	int32_t stride;
+	if (axis == math::Axis::X) {
+		stride = 1;
+	} else if (axis == math::Axis::Y) {
+		stride = srcRegion.getWidthInVoxels() * srcRegion.getHeightInVoxels();
+	} else {
+		stride = srcRegion.getWidthInVoxels();
+	}
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = destRegion.getLowerY(); y <= destRegion.getUpperY(); ++y) {
+			const glm::ivec3& srcPos = swapAxis(glm::ivec3(destRegion.getLowerX(), y, z), axis);
+			const Voxel* src = source->row(srcPos.y, srcPos.z) + (srcPos.x - srcRegion.getLowerX());
+			Voxel* dest = destination->row(y, z);
+			for (int32_t x = destRegion.getLowerX(); x <= destRegion.getUpperX(); ++x, ++dest, src += stride) {
+				if (dest->isSame(*src)) {
+					continue;
 				}
+				*dest = *src;
+				bounds.add(glm::ivec3(x, y, z));
 			}
 		}
 	}
-	return destination;
 }
 
-RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
+RawVolume* rotateAxis(core::ThreadPool* threadPool, const RawVolume* source, math::Axis axis) {
+	core_trace_scoped(RotateAxis);
 	const voxel::Region& srcRegion = source->region();
 	voxel::Region destRegion = srcRegion;
 	if (axis == math::Axis::Y) {
@@ -87,7 +180,7 @@ RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
 		destRegion.setUpperZ(srcRegion.getUpperX());
 	} else if (axis == math::Axis::X) {
 		destRegion.setLowerY(srcRegion.getLowerZ());
-		destRegion.setLowerZ(srcRegion.getLowerX());
+		destRegion.setLowerZ(srcRegion.getLowerY());
 		destRegion.setUpperY(srcRegion.getUpperZ());
 		destRegion.setUpperZ(srcRegion.getUpperY());
 	} else {
@@ -98,83 +191,101 @@ RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
 	}
 	core_assert(destRegion.isValid());
 	RawVolume* destination = new RawVolume(destRegion);
-	RawVolume::Sampler destSampler(destination);
-	RawVolume::Sampler srcSampler(source);
+	VolumeBounds bounds;
+	core::Lock lock;
+	forEachSlab(threadPool, destRegion.getLowerZ(), destRegion.getUpperZ() + 1, [&] (int zStart, int zEnd) {
+		VolumeBounds sliceBounds;
+		rotateAxisSlab(source, destination, axis, zStart, zEnd, sliceBounds);
+		core::ScopedLock scopedLock(lock);
+		bounds.add(sliceBounds);
+	});
+	bounds.apply(*destination);
+	return destination;
+}
 
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-				srcSampler.setPosition(x, y, z);
-				const Voxel& v = srcSampler.voxel();
-				glm::ivec3 pos(x, y, z);
-				if (axis == math::Axis::X) {
-					const int tmp = pos.y;
-					pos.y = pos.z;
-					pos.z = tmp;
-				} else if (axis == math::Axis::Y) {
-					const int tmp = pos.x;
-					pos.x = pos.z;
-					pos.z = tmp;
-				} else {
-					const int tmp = pos.x;
-					pos.x = pos.y;
-					pos.y = tmp;
+/**
+ * @brief Fills the destination z slices [@c zStart, @c zEnd) with the mirrored source voxels
+ */
+void mirrorAxisSlab(const RawVolume* source, RawVolume* destination, math::Axis axis, int32_t zStart, int32_t zEnd, VolumeBounds& bounds) {
+	const voxel::Region& region = source->region();
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			const Voxel* src;
+			int32_t stride = 1;
+			if (axis == math::Axis::X) {
+				src = source->row(y, z) + (maxs.x - mins.x);
+				stride = -1;
+			} else if (axis == math::Axis::Y) {
+				src = source->row(maxs.y - (y - mins.y), z);
+			} else {
+				src = source->row(y, maxs.z - (z - mins.z));
+			}
+			Voxel* dest = destination->row(y, z);
+			for (int32_t x = mins.x; x <= maxs.x; ++x, ++dest, src += stride) {
+				if (dest->isSame(*src)) {
+					continue;
 				}
-				core_assert_always(destSampler.setPosition(pos));
-				core_assert_always(destSampler.setVoxel(v));
+				*dest = *src;
+				bounds.add(glm::ivec3(x, y, z));
 			}
 		}
 	}
-	return destination;
 }
 
-RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis) {
-	const voxel::Region& srcRegion = source->region();
+RawVolume* mirrorAxis(core::ThreadPool* threadPool, const RawVolume* source, math::Axis axis) {
+	core_trace_scoped(MirrorAxis);
 	RawVolume* destination = new RawVolume(source);
-	RawVolume::Sampler destSampler(destination);
-	RawVolume::Sampler srcSampler(source);
-
-	const glm::ivec3& mins = srcRegion.getLowerCorner();
-	const glm::ivec3& maxs = srcRegion.getUpperCorner();
-
-	if (axis == math::Axis::X) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				srcSampler.setPosition(mins.x, y, z);
-				destSampler.setPosition(maxs.x, y, z);
-				for (int32_t x = mins.x; x <= maxs.x; ++x) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveX();
-					destSampler.moveNegativeX();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Y) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, mins.y, z);
-				destSampler.setPosition(x, maxs.y, z);
-				for (int32_t y = mins.y; y <= maxs.y; ++y) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveY();
-					destSampler.moveNegativeY();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, y, mins.z);
-				destSampler.setPosition(x, y, maxs.z);
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveZ();
-					destSampler.moveNegativeZ();
-				}
-			}
-		}
+	if (axis != math::Axis::X && axis != math::Axis::Y && axis != math::Axis::Z) {
+		return destination;
 	}
+	const voxel::Region& region = source->region();
+	VolumeBounds bounds;
+	core::Lock lock;
+	forEachSlab(threadPool, region.getLowerZ(), region.getUpperZ() + 1, [&] (int zStart, int zEnd) {
+		VolumeBounds sliceBounds;
+		mirrorAxisSlab(source, destination, axis, zStart, zEnd, sliceBounds);
+		core::ScopedLock scopedLock(lock);
+		bounds.add(sliceBounds);
+	});
+	bounds.apply(*destination);
 	return destination;
 }
 
 }
+
+/**
+ * @param[in] source The RawVolume to rotate
+ * @param[in] angles The angles for the x, y and z axis given in degrees
+ * @param[in] increaseSize If you rotate e.g. by 45 degree, the rotated volume
+ * would have a bigger size as the source volume. You can define that you would
+ * like to cut it to the source volume size with this flag.
+ * @return A new RawVolume. It's the caller's responsibility to free this
+ * memory.
+ */
+RawVolume* rotateVolume(const RawVolume* source, const glm::vec3& angles, const Voxel& empty, const glm::vec3& pivot, bool increaseSize) {
+	return rotate(nullptr, source, angles, empty, pivot, increaseSize);
+}
+
+RawVolume* rotateVolume(core::ThreadPool& threadPool, const RawVolume* source, const glm::vec3& angles, const Voxel& empty, const glm::vec3& pivot, bool increaseSize) {
+	return rotate(&threadPool, source, angles, empty, pivot, increaseSize);
+}
+
+RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
+	return rotateAxis(nullptr, source, axis);
+}
+
+RawVolume* rotateAxis(core::ThreadPool& threadPool, const RawVolume* source, math::Axis axis) {
+	return rotateAxis(&threadPool, source, axis);
+}
+
+RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis) {
+	return mirrorAxis(nullptr, source, axis);
+}
+
+RawVolume* mirrorAxis(core::ThreadPool& threadPool, const RawVolume* source, math::Axis axis) {
+	return mirrorAxis(&threadPool, source, axis);
+}
+
+}
@@ -8,6 +8,10 @@
 #include <glm/vec3.hpp>
 #include "math/Axis.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 
 class RawVolume;
@@ -27,4 +31,12 @@ extern RawVolume* rotateAxis(const RawVolume* source, math::Axis axis);
  */
 extern RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis);
 
+/**
+ * @brief Parallel versions of the functions above - the volume is split into slabs along the z axis
+ * that are processed on the given thread pool. The results are the same as for the serial versions.
+ */
+extern RawVolume* rotateVolume(core::ThreadPool& threadPool, const RawVolume* source, const glm::vec3& angles, const Voxel& empty, const glm::vec3& pivot, bool increaseSize = true);
+extern RawVolume* rotateAxis(core::ThreadPool& threadPool, const RawVolume* source, math::Axis axis);
+extern RawVolume* mirrorAxis(core::ThreadPool& threadPool, const RawVolume* source, math::Axis axis);
+
 }
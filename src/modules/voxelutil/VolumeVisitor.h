@@ -7,6 +7,9 @@
 #include "voxel/RawVolume.h"
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Parallel.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -19,24 +22,62 @@ struct SkipEmpty {
 	}
 };
 
-template<class Volume, class Visitor, typename Condition = SkipEmpty>
-int visitVolume(const Volume& volume, Visitor&& visitor, Condition condition = Condition()) {
-	core_trace_scoped(VisitVolume);
-	const voxel::Region& region = volume.region();
+/**
+ * @brief Visits the z slices [@c zStart, @c zEnd) of the given region
+ * @note @c voxel::RawVolume instances are accessed row by row - other volumes are asked for every single voxel
+ */
+template<class Volume, class Visitor, typename Condition>
+int visitVolumeSlab(const Volume& volume, const voxel::Region& region, int32_t zStart, int32_t zEnd, Visitor&& visitor, Condition& condition) {
 	int cnt = 0;
-	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+	for (int32_t z = zStart; z < zEnd; ++z) {
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
-			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
-				const voxel::Voxel& voxel = volume.voxel(x, y, z);
-				if (!condition(voxel)) {
-					continue;
+			if constexpr (std::is_same<Volume, voxel::RawVolume>::value) {
+				const voxel::Voxel* row = volume.row(y, z) + (region.getLowerX() - volume.region().getLowerX());
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x, ++row) {
+					if (!condition(*row)) {
+						continue;
+					}
+					visitor(x, y, z, *row);
+					++cnt;
+				}
+			} else {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const voxel::Voxel& voxel = volume.voxel(x, y, z);
+					if (!condition(voxel)) {
+						continue;
+					}
+					visitor(x, y, z, voxel);
+					++cnt;
 				}
-				visitor(x, y, z, voxel);
-				++cnt;
 			}
 		}
 	}
 	return cnt;
 }
 
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolume(const Volume& volume, Visitor&& visitor, Condition condition = Condition()) {
+	core_trace_scoped(VisitVolume);
+	const voxel::Region& region = volume.region();
+	return visitVolumeSlab(volume, region, region.getLowerZ(), region.getUpperZ() + 1, visitor, condition);
+}
+
+/**
+ * @brief Splits the volume into slabs along the z axis and visits them on the given thread pool
+ * @note The visitor and the condition are called concurrently from several threads. The order of
+ * the visited voxels is undefined.
+ * @note Don't modify the visited volume in the visitor if this might affect other slabs
+ */
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(core::ThreadPool& threadPool, const Volume& volume, Visitor&& visitor, Condition condition = Condition()) {
+	core_trace_scoped(VisitVolumeParallel);
+	const voxel::Region& region = volume.region();
+	core::AtomicInt cnt { 0 };
+	core::parallelFor(threadPool, region.getLowerZ(), region.getUpperZ() + 1, [&] (int zStart, int zEnd) {
+		Condition sliceCondition = condition;
+		cnt.increment(visitVolumeSlab(volume, region, zStart, zEnd, visitor, sliceCondition));
+	});
+	return cnt;
+}
+
 }
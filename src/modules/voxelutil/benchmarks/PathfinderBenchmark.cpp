@@ -0,0 +1,145 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/AStarPathfinder.h"
+#include "voxelutil/HierarchicalPathfinder.h"
+#include <glm/trigonometric.hpp>
+#include <limits.h>
+#include <memory>
+
+static constexpr int PATHFINDER_WORLD_HEIGHT = 32;
+static constexpr int PATHFINDER_CLUSTER_SIZE = 16;
+
+/**
+ * @brief Rolling hills with rows of pillars - the paths lead from one corner of the world to the others
+ */
+class PathfinderBenchmark : public app::AbstractBenchmark {
+protected:
+	std::unique_ptr<voxel::RawVolume> _volume;
+	std::vector<std::pair<glm::ivec3, glm::ivec3> > _paths;
+
+	int terrainHeight(int x, int z) const {
+		return 8 + (int)(4.0f * glm::sin(x / 16.0f) + 4.0f * glm::cos(z / 20.0f));
+	}
+
+	glm::ivec3 surface(int x, int z) const {
+		return glm::ivec3(x, terrainHeight(x, z) + 1, z);
+	}
+
+	void generate(int size) {
+		if (_volume && _volume->region().getWidthInVoxels() == size) {
+			return;
+		}
+		_volume = std::make_unique<voxel::RawVolume>(voxel::Region(0, 0, 0, size - 1, PATHFINDER_WORLD_HEIGHT - 1, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const int h = terrainHeight(x, z);
+				for (int y = 0; y <= h; ++y) {
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Grass, 0));
+				}
+				if (x % 17 == 8 && z % 23 < 16) {
+					for (int y = h + 1; y <= h + 4; ++y) {
+						_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+					}
+				}
+			}
+		}
+		const int lo = 2;
+		const int hi = size - 3;
+		_paths.clear();
+		_paths.emplace_back(surface(lo, lo), surface(hi, hi));
+		_paths.emplace_back(surface(hi, lo), surface(lo, hi));
+		_paths.emplace_back(surface(lo, size / 2), surface(hi, size / 2));
+		_paths.emplace_back(surface(size / 2, lo), surface(size / 2, hi));
+	}
+
+	bool walkable(int x, int y, int z) const {
+		if (!_volume->region().containsPoint(x, y, z) || y == 0) {
+			return false;
+		}
+		return voxel::isAir(_volume->voxel(x, y, z).getMaterial()) && !voxel::isAir(_volume->voxel(x, y - 1, z).getMaterial());
+	}
+
+	std::unique_ptr<voxelutil::HierarchicalPathfinder> createPathfinder(int maxCachedPaths) const {
+		return std::make_unique<voxelutil::HierarchicalPathfinder>([this] (int x, int y, int z) { return walkable(x, y, z); },
+				PATHFINDER_CLUSTER_SIZE, 0, PATHFINDER_WORLD_HEIGHT - 1, maxCachedPaths);
+	}
+
+	int solve(voxelutil::HierarchicalPathfinder& pathfinder) const {
+		std::vector<voxelutil::PathId> ids;
+		for (const auto& p : _paths) {
+			ids.push_back(pathfinder.request(p.first, p.second));
+		}
+		while (pathfinder.pending() > 0) {
+			pathfinder.update(INT_MAX);
+		}
+		int found = 0;
+		std::vector<glm::ivec3> path;
+		for (voxelutil::PathId id : ids) {
+			if (pathfinder.result(id, path)) {
+				++found;
+			}
+		}
+		return found;
+	}
+};
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, AStar)(benchmark::State &state) {
+	generate((int)state.range(0));
+	const auto validator = [this] (const voxel::RawVolume*, const glm::ivec3& pos) {
+		return walkable(pos.x, pos.y, pos.z);
+	};
+	for (auto _ : state) {
+		int found = 0;
+		for (const auto& p : _paths) {
+			std::list<glm::ivec3> result;
+			voxel::AStarPathfinderParams<voxel::RawVolume> params(_volume.get(), p.first, p.second, &result, 1.0f, 1000000,
+					voxel::TwentySixConnected, validator);
+			voxel::AStarPathfinder<voxel::RawVolume> pathfinder(params);
+			if (pathfinder.execute()) {
+				++found;
+			}
+		}
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+/**
+ * @brief Includes sampling the clusters and building the abstract graph
+ */
+BENCHMARK_DEFINE_F(PathfinderBenchmark, HierarchicalCold)(benchmark::State &state) {
+	generate((int)state.range(0));
+	for (auto _ : state) {
+		std::unique_ptr<voxelutil::HierarchicalPathfinder> pathfinder = createPathfinder(0);
+		benchmark::DoNotOptimize(solve(*pathfinder));
+	}
+}
+
+/**
+ * @brief The abstract graph is already built - the path cache is disabled
+ */
+BENCHMARK_DEFINE_F(PathfinderBenchmark, Hierarchical)(benchmark::State &state) {
+	generate((int)state.range(0));
+	std::unique_ptr<voxelutil::HierarchicalPathfinder> pathfinder = createPathfinder(0);
+	solve(*pathfinder);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(solve(*pathfinder));
+	}
+}
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, HierarchicalCached)(benchmark::State &state) {
+	generate((int)state.range(0));
+	std::unique_ptr<voxelutil::HierarchicalPathfinder> pathfinder = createPathfinder(1024);
+	solve(*pathfinder);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(solve(*pathfinder));
+	}
+}
+
+BENCHMARK_REGISTER_F(PathfinderBenchmark, AStar)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, HierarchicalCold)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, Hierarchical)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, HierarchicalCached)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
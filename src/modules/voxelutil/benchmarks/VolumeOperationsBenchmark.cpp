@@ -0,0 +1,179 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeMerger.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VolumeRotator.h"
+#include "voxelutil/VolumeVisitor.h"
+#include <memory>
+
+static constexpr int MAX_BENCHMARK_VOLUME_SIZE = 256;
+
+class VolumeOperationsBenchmark : public app::AbstractBenchmark {
+protected:
+	std::unique_ptr<core::ThreadPool> _threadPool;
+
+public:
+	void fill(voxel::RawVolume& volume) const {
+		const voxel::Region& region = volume.region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x + y + z) % 3 == 0) {
+						volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + z) % 255));
+					}
+				}
+			}
+		}
+	}
+
+	void onCleanupApp() override {
+		_threadPool->shutdown();
+		_threadPool.reset();
+	}
+
+	bool onInitApp() override {
+		if (!voxel::initDefaultMaterialColors()) {
+			return false;
+		}
+		_threadPool = std::make_unique<core::ThreadPool>(core::cpus(), "Benchmark");
+		_threadPool->init();
+		return true;
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, Visit)(benchmark::State &state) {
+	voxel::RawVolume volume(voxel::Region(0, (int)state.range(0) - 1));
+	fill(volume);
+	for (auto _ : state) {
+		int cnt = voxelutil::visitVolume(volume, [] (int, int, int, const voxel::Voxel&) {});
+		benchmark::DoNotOptimize(cnt);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, VisitParallel)(benchmark::State &state) {
+	voxel::RawVolume volume(voxel::Region(0, (int)state.range(0) - 1));
+	fill(volume);
+	for (auto _ : state) {
+		int cnt = voxelutil::visitVolumeParallel(*_threadPool, volume, [] (int, int, int, const voxel::Voxel&) {});
+		benchmark::DoNotOptimize(cnt);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, Merge)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		voxel::RawVolume dest(source.region());
+		voxel::mergeVolumes(&dest, &source, dest.region(), source.region());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, MergeParallel)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		voxel::RawVolume dest(source.region());
+		voxel::mergeVolumesParallel(*_threadPool, &dest, &source, dest.region(), source.region());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RotateAxis)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::rotateAxis(&source, math::Axis::Y);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RotateAxisParallel)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::rotateAxis(*_threadPool, &source, math::Axis::Y);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RotateVolume)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::rotateVolume(&source, glm::vec3(0.0f, 45.0f, 0.0f), voxel::Voxel(), source.region().getCenterf());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RotateVolumeParallel)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::rotateVolume(*_threadPool, &source, glm::vec3(0.0f, 45.0f, 0.0f), voxel::Voxel(), source.region().getCenterf());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, MirrorAxis)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::mirrorAxis(&source, math::Axis::X);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, MirrorAxisParallel)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	for (auto _ : state) {
+		delete voxel::mirrorAxis(*_threadPool, &source, math::Axis::X);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RescaleGeneric)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	const voxel::Region destRegion(0, (int)state.range(0) / 2 - 1);
+	for (auto _ : state) {
+		voxel::RawVolume dest(destRegion);
+		voxel::rescaleVolume<voxel::RawVolume, voxel::RawVolume>(source, source.region(), dest, destRegion);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, Rescale)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	const voxel::Region destRegion(0, (int)state.range(0) / 2 - 1);
+	for (auto _ : state) {
+		voxel::RawVolume dest(destRegion);
+		voxel::rescaleVolume(source, dest);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeOperationsBenchmark, RescaleParallel)(benchmark::State &state) {
+	voxel::RawVolume source(voxel::Region(0, (int)state.range(0) - 1));
+	fill(source);
+	const voxel::Region destRegion(0, (int)state.range(0) / 2 - 1);
+	for (auto _ : state) {
+		voxel::RawVolume dest(destRegion);
+		voxel::rescaleVolume(*_threadPool, source, dest);
+	}
+}
+
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, Visit)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, VisitParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, Merge)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, MergeParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RotateAxis)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RotateAxisParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RotateVolume)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RotateVolumeParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, MirrorAxis)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, MirrorAxisParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RescaleGeneric)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, Rescale)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(VolumeOperationsBenchmark, RescaleParallel)->RangeMultiplier(2)->Range(32, MAX_BENCHMARK_VOLUME_SIZE);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,237 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/HierarchicalPathfinder.h"
+#include <limits.h>
+
+namespace voxelutil {
+
+class HierarchicalPathfinderTest: public app::AbstractTest {
+protected:
+	static constexpr int ClusterSize = 8;
+	const voxel::Region _region { 0, 0, 0, 47, 7, 47 };
+	voxel::RawVolume _volume { _region };
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+				_volume.setVoxel(x, 0, z, voxel::createVoxel(voxel::VoxelType::Grass, 0));
+			}
+		}
+	}
+
+	/**
+	 * @brief A wall along the z axis with a gap at the given z coordinate
+	 */
+	void wall(int x, int gapZ) {
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			if (z == gapZ) {
+				continue;
+			}
+			for (int y = 1; y <= _region.getUpperY(); ++y) {
+				_volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+			}
+		}
+	}
+
+	bool walkable(int x, int y, int z) const {
+		if (!_region.containsPoint(x, y, z) || y == 0) {
+			return false;
+		}
+		return voxel::isAir(_volume.voxel(x, y, z).getMaterial()) && !voxel::isAir(_volume.voxel(x, y - 1, z).getMaterial());
+	}
+
+	HierarchicalPathfinder pathfinder(int maxCachedPaths = 16) const {
+		return HierarchicalPathfinder([this] (int x, int y, int z) { return walkable(x, y, z); }, ClusterSize,
+				_region.getLowerY(), _region.getUpperY(), maxCachedPaths);
+	}
+
+	void validatePath(const std::vector<glm::ivec3>& path, const glm::ivec3& start, const glm::ivec3& end) const {
+		ASSERT_FALSE(path.empty());
+		EXPECT_EQ(start, path.front());
+		EXPECT_EQ(end, path.back());
+		for (size_t i = 0; i < path.size(); ++i) {
+			EXPECT_TRUE(walkable(path[i].x, path[i].y, path[i].z)) << "invalid position at " << i;
+			if (i == 0) {
+				continue;
+			}
+			const glm::ivec3 d = glm::abs(path[i] - path[i - 1]);
+			EXPECT_TRUE(d.x <= 1 && d.y <= 1 && d.z <= 1 && d != glm::ivec3(0)) << "gap in the path at " << i;
+		}
+	}
+
+	std::vector<glm::ivec3> find(HierarchicalPathfinder& finder, const glm::ivec3& start, const glm::ivec3& end, PathState expected = PathState::Found) {
+		const PathId id = finder.request(start, end);
+		for (int i = 0; i < 10000 && finder.state(id) == PathState::Queued; ++i) {
+			finder.update(INT_MAX);
+		}
+		EXPECT_EQ(expected, finder.state(id));
+		std::vector<glm::ivec3> path;
+		finder.result(id, path);
+		return path;
+	}
+};
+
+TEST_F(HierarchicalPathfinderTest, testStraightPath) {
+	HierarchicalPathfinder finder = pathfinder();
+	const glm::ivec3 start(1, 1, 1);
+	const glm::ivec3 end(46, 1, 1);
+	const std::vector<glm::ivec3>& path = find(finder, start, end);
+	validatePath(path, start, end);
+	EXPECT_EQ(46u, path.size());
+	EXPECT_GT(finder.portals(), 0);
+}
+
+TEST_F(HierarchicalPathfinderTest, testSameCluster) {
+	HierarchicalPathfinder finder = pathfinder();
+	const glm::ivec3 start(1, 1, 1);
+	const glm::ivec3 end(5, 1, 6);
+	const std::vector<glm::ivec3>& path = find(finder, start, end);
+	validatePath(path, start, end);
+	EXPECT_EQ(6u, path.size());
+}
+
+TEST_F(HierarchicalPathfinderTest, testDetour) {
+	wall(20, 40);
+	HierarchicalPathfinder finder = pathfinder();
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	const std::vector<glm::ivec3>& path = find(finder, start, end);
+	validatePath(path, start, end);
+	EXPECT_NE(path.end(), std::find(path.begin(), path.end(), glm::ivec3(20, 1, 40)));
+}
+
+TEST_F(HierarchicalPathfinderTest, testUnreachable) {
+	wall(20, -1);
+	HierarchicalPathfinder finder = pathfinder();
+	find(finder, glm::ivec3(2, 1, 2), glm::ivec3(40, 1, 2), PathState::Failed);
+	find(finder, glm::ivec3(2, 3, 2), glm::ivec3(4, 1, 2), PathState::Failed);
+}
+
+TEST_F(HierarchicalPathfinderTest, testTimeSliced) {
+	wall(20, 40);
+	HierarchicalPathfinder finder = pathfinder();
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	const PathId id = finder.request(start, end);
+	int ticks = 0;
+	for (; ticks < 10000 && finder.state(id) == PathState::Queued; ++ticks) {
+		finder.update(1);
+	}
+	EXPECT_GT(ticks, 10);
+	ASSERT_EQ(PathState::Found, finder.state(id));
+	std::vector<glm::ivec3> path;
+	ASSERT_TRUE(finder.result(id, path));
+	validatePath(path, start, end);
+	EXPECT_EQ(PathState::Unknown, finder.state(id));
+}
+
+TEST_F(HierarchicalPathfinderTest, testSamplingTimeSliced) {
+	int samples = 0;
+	HierarchicalPathfinder finder([&] (int x, int y, int z) { ++samples; return walkable(x, y, z); }, ClusterSize,
+			_region.getLowerY(), _region.getUpperY());
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	const PathId id = finder.request(start, end);
+	const int rowVoxels = ClusterSize * _region.getHeightInVoxels();
+	for (int ticks = 0; ticks < 10000 && finder.state(id) == PathState::Queued; ++ticks) {
+		samples = 0;
+		const int work = finder.update(1);
+		// a cluster is sampled one row of columns per step - and every validator call is billed
+		ASSERT_LE(samples, rowVoxels) << "tick " << ticks;
+		ASSERT_GE(work, samples) << "tick " << ticks;
+	}
+	std::vector<glm::ivec3> path;
+	ASSERT_TRUE(finder.result(id, path));
+	validatePath(path, start, end);
+}
+
+TEST_F(HierarchicalPathfinderTest, testCacheAndRemove) {
+	HierarchicalPathfinder finder = pathfinder();
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	const std::vector<glm::ivec3>& path = find(finder, start, end);
+	validatePath(path, start, end);
+	EXPECT_EQ(1, finder.cachedPaths());
+
+	// the cached path doesn't need an update
+	const PathId id = finder.request(start, end);
+	EXPECT_EQ(PathState::Found, finder.state(id));
+	finder.cancel(id);
+
+	// the chunk is paged in again with a wall
+	const int clusters = finder.clusters();
+	wall(20, 40);
+	finder.remove(voxel::Region(20, 0, 0, 20, 7, 47));
+	EXPECT_EQ(0, finder.cachedPaths());
+	EXPECT_LT(finder.clusters(), clusters);
+	const std::vector<glm::ivec3>& detour = find(finder, start, end);
+	validatePath(detour, start, end);
+	EXPECT_GT(detour.size(), path.size());
+}
+
+TEST_F(HierarchicalPathfinderTest, testRemoveWhileSearching) {
+	HierarchicalPathfinder finder = pathfinder(0);
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	const PathId id = finder.request(start, end);
+	finder.update(1);
+	finder.update(1);
+	wall(20, 40);
+	finder.remove(voxel::Region(20, 0, 0, 20, 7, 47));
+	for (int i = 0; i < 10000 && finder.state(id) == PathState::Queued; ++i) {
+		finder.update(INT_MAX);
+	}
+	std::vector<glm::ivec3> path;
+	ASSERT_TRUE(finder.result(id, path));
+	validatePath(path, start, end);
+	EXPECT_EQ(0, finder.cachedPaths());
+}
+
+TEST_F(HierarchicalPathfinderTest, testRemoveCancelsRequests) {
+	HierarchicalPathfinder finder = pathfinder(0);
+	find(finder, glm::ivec3(2, 1, 2), glm::ivec3(40, 1, 2));
+	const PathId removed = finder.request(glm::ivec3(2, 1, 2), glm::ivec3(40, 1, 2));
+	const PathId kept = finder.request(glm::ivec3(2, 1, 2), glm::ivec3(10, 1, 2));
+	finder.remove(voxel::Region(40, 0, 0, 47, 7, 7));
+	EXPECT_EQ(PathState::Unknown, finder.state(removed));
+	EXPECT_EQ(PathState::Queued, finder.state(kept));
+	EXPECT_EQ(1, finder.pending());
+
+	// removing the whole world - and the neighbour clusters of its borders - drops every cluster and portal
+	finder.remove(voxel::Region(-ClusterSize, 0, -ClusterSize, 55, 7, 55));
+	EXPECT_EQ(0, finder.clusters());
+	EXPECT_EQ(0, finder.portals());
+	EXPECT_EQ(0, finder.pending());
+}
+
+TEST_F(HierarchicalPathfinderTest, testRemoveFromValidator) {
+	HierarchicalPathfinder* self = nullptr;
+	bool pageOut = false;
+	// the voxel lookup of the validator pages out a chunk while the clusters are sampled
+	HierarchicalPathfinder finder([&] (int x, int y, int z) {
+		if (pageOut) {
+			pageOut = false;
+			self->remove(voxel::Region(40, 0, 0, 47, 7, 7));
+		}
+		return walkable(x, y, z);
+	}, ClusterSize, _region.getLowerY(), _region.getUpperY(), 16);
+	self = &finder;
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(40, 1, 2);
+	find(finder, start, end);
+	finder.remove(voxel::Region(20, 0, 0, 20, 7, 47));
+
+	pageOut = true;
+	const PathId id = finder.request(start, end);
+	finder.update(INT_MAX);
+	EXPECT_FALSE(pageOut);
+	EXPECT_NE(PathState::Queued, finder.state(id));
+	EXPECT_EQ(0, finder.cachedPaths());
+}
+
+}
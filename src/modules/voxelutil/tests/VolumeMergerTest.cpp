@@ -4,6 +4,7 @@
 
 #include "voxel/tests/AbstractVoxelTest.h"
 #include "voxelutil/VolumeMerger.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace voxel {
 
@@ -57,4 +58,30 @@ TEST_F(VolumeMergerTest, testOffsets) {
 	ASSERT_EQ(smallVolume.voxel(regionSmall.getUpperCorner()), createVoxel(voxel::VoxelType::Grass, 0)) << smallVolume << ", " << bigVolume;
 }
 
+TEST_F(VolumeMergerTest, testMergeParallel) {
+	voxel::RawVolume source(voxel::Region(0, 31));
+	for (int32_t z = 0; z < 32; ++z) {
+		for (int32_t y = 0; y < 32; ++y) {
+			for (int32_t x = 0; x < 32; ++x) {
+				if (_random.random(0, 2) == 0) {
+					source.setVoxel(x, y, z, createRandomColorVoxel(VoxelType::Generic, _random));
+				}
+			}
+		}
+	}
+	// the destination region is partially outside of the destination volume
+	const voxel::Region destRegion(glm::ivec3(-10, 4, 20), glm::ivec3(21, 35, 51));
+	voxel::RawVolume expected(voxel::Region(0, 40));
+	const int expectedCnt = voxel::mergeVolumes(&expected, &source, destRegion, source.region());
+	EXPECT_GT(expectedCnt, 0);
+
+	core::ThreadPool threadPool(3);
+	threadPool.init();
+	voxel::RawVolume merged(voxel::Region(0, 40));
+	EXPECT_EQ(expectedCnt, voxel::mergeVolumesParallel(threadPool, &merged, &source, destRegion, source.region()));
+	EXPECT_EQ(expected, merged);
+	EXPECT_EQ(expected.mins(), merged.mins());
+	EXPECT_EQ(expected.maxs(), merged.maxs());
+}
+
 }
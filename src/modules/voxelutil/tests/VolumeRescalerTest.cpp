@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace voxel {
+
+class VolumeRescalerTest: public AbstractVoxelTest {
+protected:
+	void fill(RawVolume& volume) {
+		const Region& region = volume.region();
+		const glm::vec3 center = region.getCenterf();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (glm::distance(glm::vec3(x, y, z), center) > 12.0f) {
+						continue;
+					}
+					volume.setVoxel(x, y, z, createRandomColorVoxel(VoxelType::Generic, _random));
+				}
+			}
+		}
+	}
+};
+
+TEST_F(VolumeRescalerTest, testRawVolumeMatchesGeneric) {
+	RawVolume source(Region(-16, 15));
+	fill(source);
+	const Region destRegion(-8, 7);
+	RawVolume expected(destRegion);
+	rescaleVolume<RawVolume, RawVolume>(source, source.region(), expected, destRegion);
+	RawVolume rescaled(destRegion);
+	rescaleVolume(source, rescaled);
+	EXPECT_EQ(expected, rescaled);
+	EXPECT_EQ(expected.mins(), rescaled.mins());
+	EXPECT_EQ(expected.maxs(), rescaled.maxs());
+}
+
+TEST_F(VolumeRescalerTest, testParallel) {
+	RawVolume source(Region(0, 31));
+	fill(source);
+	const Region destRegion(0, 15);
+	RawVolume expected(destRegion);
+	rescaleVolume(source, expected);
+
+	core::ThreadPool threadPool(3);
+	threadPool.init();
+	RawVolume rescaled(destRegion);
+	rescaleVolume(threadPool, source, rescaled);
+	EXPECT_EQ(expected, rescaled);
+	EXPECT_EQ(expected.mins(), rescaled.mins());
+	EXPECT_EQ(expected.maxs(), rescaled.maxs());
+}
+
+}
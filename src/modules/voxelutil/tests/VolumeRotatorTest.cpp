@@ -4,6 +4,8 @@
 
 #include "voxel/tests/AbstractVoxelTest.h"
 #include "voxelutil/VolumeRotator.h"
+#include "core/concurrent/ThreadPool.h"
+#include "math/Random.h"
 
 namespace voxel {
 
@@ -12,6 +14,36 @@ protected:
 	inline core::String str(const voxel::Region& region) const {
 		return region.toString();
 	}
+
+	void fill(voxel::RawVolume& volume) const {
+		math::Random random(1);
+		const voxel::Region& region = volume.region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (random.random(0, 3) == 0) {
+						volume.setVoxel(x, y, z, createVoxel(voxel::VoxelType::Generic, random.random(1, 255)));
+					}
+				}
+			}
+		}
+	}
+
+	void expectSame(const voxel::RawVolume* expected, const voxel::RawVolume* volume) const {
+		ASSERT_NE(nullptr, expected);
+		ASSERT_NE(nullptr, volume);
+		ASSERT_EQ(expected->region(), volume->region());
+		EXPECT_EQ(expected->mins(), volume->mins());
+		EXPECT_EQ(expected->maxs(), volume->maxs());
+		const voxel::Region& region = expected->region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected->voxel(x, y, z).isSame(volume->voxel(x, y, z))) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
 };
 
 TEST_F(VolumeRotatorTest, testRotateAxisY) {
@@ -28,6 +60,44 @@ TEST_F(VolumeRotatorTest, testRotateAxisY) {
 	delete rotated;
 }
 
+TEST_F(VolumeRotatorTest, testRotateAxisXNonCubic) {
+	const voxel::Region region(glm::ivec3(-2, 1, 4), glm::ivec3(3, 5, 6));
+	voxel::RawVolume volume(region);
+	EXPECT_TRUE(volume.setVoxel(-2, 2, 5, createVoxel(voxel::VoxelType::Rock, 1)));
+	voxel::RawVolume* rotated = voxel::rotateAxis(&volume, math::Axis::X);
+	ASSERT_NE(nullptr, rotated);
+	EXPECT_EQ(voxel::Region(glm::ivec3(-2, 4, 1), glm::ivec3(3, 6, 5)), rotated->region());
+	EXPECT_EQ(voxel::VoxelType::Rock, rotated->voxel(-2, 5, 2).getMaterial());
+	delete rotated;
+}
+
+TEST_F(VolumeRotatorTest, testParallel) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-5, 0, 3), glm::ivec3(20, 12, 40)));
+	fill(volume);
+	core::ThreadPool threadPool(3);
+	threadPool.init();
+	const math::Axis axes[] = {math::Axis::X, math::Axis::Y, math::Axis::Z};
+	for (math::Axis axis : axes) {
+		voxel::RawVolume* expected = voxel::rotateAxis(&volume, axis);
+		voxel::RawVolume* rotated = voxel::rotateAxis(threadPool, &volume, axis);
+		expectSame(expected, rotated);
+		delete expected;
+		delete rotated;
+
+		expected = voxel::mirrorAxis(&volume, axis);
+		rotated = voxel::mirrorAxis(threadPool, &volume, axis);
+		expectSame(expected, rotated);
+		delete expected;
+		delete rotated;
+	}
+	const glm::vec3 pivot = volume.region().getCenterf();
+	voxel::RawVolume* expected = voxel::rotateVolume(&volume, glm::vec3(30.0f, 45.0f, 10.0f), voxel::Voxel(), pivot);
+	voxel::RawVolume* rotated = voxel::rotateVolume(threadPool, &volume, glm::vec3(30.0f, 45.0f, 10.0f), voxel::Voxel(), pivot);
+	expectSame(expected, rotated);
+	delete expected;
+	delete rotated;
+}
+
 TEST_F(VolumeRotatorTest, testRotate45Y) {
 	const voxel::Region region(0, 10);
 	voxel::RawVolume smallVolume(region);
@@ -11,7 +11,10 @@ voxelutil::FloorTraceResult CachedFloorResolver::findWalkableFloor(const glm::iv
 	if (_lastPos == position && _lastMaxDistanceY == maxDistanceY) {
 		return _last;
 	}
-	voxelutil::FloorTraceResult trace = voxelutil::findWalkableFloor(_sampler, position, maxDistanceY);
+	voxelutil::FloorTraceResult trace;
+	if (!_worldMgr->floorIndex().findWalkableFloor(position, maxDistanceY, trace)) {
+		trace = voxelutil::findWalkableFloor(_sampler, position, maxDistanceY);
+	}
 	_lastPos = position;
 	_lastMaxDistanceY = maxDistanceY;
 	_last = trace;
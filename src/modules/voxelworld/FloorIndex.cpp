@@ -0,0 +1,177 @@
+/**
+ * @file
+ */
+
+#include "FloorIndex.h"
+#include "voxel/Constants.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+
+namespace voxelworld {
+
+template<class VoxelFunc>
+void FloorIndex::scanColumn(VoxelFunc&& voxelAt, std::vector<Run>& runs) {
+	bool open = false;
+	voxel::Voxel previous;
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		const voxel::Voxel& v = voxelAt(y);
+		const bool enterable = voxel::isEnterable(v.getMaterial());
+		if (enterable && !open) {
+			runs.push_back(Run { (int16_t)y, (int16_t)(voxel::MAX_HEIGHT + 1), y == 0 ? voxel::Voxel() : previous, v });
+			open = true;
+		} else if (!enterable && open) {
+			runs.back().end = (int16_t)y;
+			open = false;
+		}
+		previous = v;
+	}
+}
+
+void FloorIndex::init(int tileSize) {
+	core::ScopedLock lock(_lock);
+	_tileSize = tileSize;
+	_tiles.clear();
+}
+
+void FloorIndex::shutdown() {
+	clear();
+}
+
+glm::ivec2 FloorIndex::tilePos(int x, int z) const {
+	const float size = (float)_tileSize;
+	return glm::ivec2((int)glm::floor(x / size), (int)glm::floor(z / size));
+}
+
+const FloorIndex::Tile* FloorIndex::tile(int x, int z) const {
+	auto i = _tiles.find(tilePos(x, z));
+	if (i == _tiles.end()) {
+		return nullptr;
+	}
+	return &i->second;
+}
+
+void FloorIndex::build(const voxel::PagedVolume::Chunk& chunk, const voxel::Region& region) {
+	if (_tileSize <= 0 || region.getLowerY() != 0 || region.getUpperY() < voxel::MAX_HEIGHT
+			|| region.getWidthInVoxels() != _tileSize || region.getDepthInVoxels() != _tileSize) {
+		return;
+	}
+	core_trace_scoped(FloorIndexBuild);
+	Tile tile;
+	tile.columns.resize(_tileSize * _tileSize);
+	// most columns only have one floor
+	tile.runs.reserve(tile.columns.size() + tile.columns.size() / 4);
+	for (int z = 0; z < _tileSize; ++z) {
+		for (int x = 0; x < _tileSize; ++x) {
+			Column& column = tile.columns[z * _tileSize + x];
+			column.offset = (uint32_t)tile.runs.size();
+			scanColumn([&] (int y) -> const voxel::Voxel& { return chunk.voxel(x, y, z); }, tile.runs);
+			column.count = (uint16_t)(tile.runs.size() - column.offset);
+		}
+	}
+	tile.runs.shrink_to_fit();
+	const glm::ivec2 pos = tilePos(region.getLowerX(), region.getLowerZ());
+	core::ScopedLock lock(_lock);
+	_tiles[pos] = std::move(tile);
+}
+
+void FloorIndex::remove(const voxel::Region& region) {
+	// the tiles are built from the chunks that start at the ground
+	if (_tileSize <= 0 || region.getLowerY() > 0 || region.getUpperY() < 0) {
+		return;
+	}
+	const glm::ivec2 mins = tilePos(region.getLowerX() + _tileSize - 1, region.getLowerZ() + _tileSize - 1);
+	const glm::ivec2 maxs = tilePos(region.getUpperX() + 1, region.getUpperZ() + 1) - 1;
+	core::ScopedLock lock(_lock);
+	for (int z = mins.y; z <= maxs.y; ++z) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			_tiles.erase(glm::ivec2(x, z));
+		}
+	}
+}
+
+bool FloorIndex::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result) const {
+	if (position.y < 0 || position.y > voxel::MAX_HEIGHT) {
+		return false;
+	}
+	core::ScopedLock lock(_lock);
+	const Tile* t = tile(position.x, position.z);
+	if (t == nullptr) {
+		return false;
+	}
+	const glm::ivec2 local = glm::ivec2(position.x, position.z) - tilePos(position.x, position.z) * _tileSize;
+	const Column& column = t->columns[local.y * _tileSize + local.x];
+	const Run* runs = &t->runs[column.offset];
+	for (uint16_t i = 0u; i < column.count; ++i) {
+		const Run& run = runs[i];
+		if (position.y >= run.end) {
+			continue;
+		}
+		if (position.y >= run.start) {
+			// inside of an enterable run - the floor is at the bottom of it
+			if (run.start == 0) {
+				// there is no floor below - the voxel at the position is needed
+				return false;
+			}
+			result = voxelutil::FloorTraceResult(run.start, run.below);
+			return true;
+		}
+		// the position is blocked - the next run above is the floor
+		const int maxDistance = core_min(maxDistanceUpwards, voxel::MAX_HEIGHT - position.y);
+		if (run.start - position.y <= maxDistance) {
+			result = voxelutil::FloorTraceResult(run.start, run.floor);
+		} else {
+			result = voxelutil::FloorTraceResult();
+		}
+		return true;
+	}
+	// blocked and nothing enterable above
+	result = voxelutil::FloorTraceResult();
+	return true;
+}
+
+int FloorIndex::floors(int x, int z) const {
+	core::ScopedLock lock(_lock);
+	const Tile* t = tile(x, z);
+	if (t == nullptr) {
+		return -1;
+	}
+	const glm::ivec2 local = glm::ivec2(x, z) - tilePos(x, z) * _tileSize;
+	const Column& column = t->columns[local.y * _tileSize + local.x];
+	int n = 0;
+	for (uint16_t i = 0u; i < column.count; ++i) {
+		if (t->runs[column.offset + i].start > 0) {
+			++n;
+		}
+	}
+	return n;
+}
+
+bool FloorIndex::floorHeights(int x, int z, std::vector<int>& heights) const {
+	heights.clear();
+	core::ScopedLock lock(_lock);
+	const Tile* t = tile(x, z);
+	if (t == nullptr) {
+		return false;
+	}
+	const glm::ivec2 local = glm::ivec2(x, z) - tilePos(x, z) * _tileSize;
+	const Column& column = t->columns[local.y * _tileSize + local.x];
+	for (uint16_t i = 0u; i < column.count; ++i) {
+		const Run& run = t->runs[column.offset + i];
+		if (run.start > 0) {
+			heights.push_back(run.start);
+		}
+	}
+	return true;
+}
+
+void FloorIndex::clear() {
+	core::ScopedLock lock(_lock);
+	_tiles.clear();
+}
+
+int FloorIndex::tiles() const {
+	core::ScopedLock lock(_lock);
+	return (int)_tiles.size();
+}
+
+}
@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "voxel/Voxel.h"
+#include "voxelutil/FloorTraceResult.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <glm/vec2.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace voxelworld {
+
+/**
+ * @brief The walkable floors of every column of the paged in chunks
+ *
+ * Each column is stored as the list of its enterable runs - a column with bridges or caves has several floors.
+ * The runs are kept per chunk column in one compact array. Lookups are answered without touching the voxels, the
+ * columns that are not indexed are reported as such and the caller has to walk the voxels.
+ *
+ * Only chunks that cover the full world height are indexed.
+ *
+ * @note All methods are thread safe
+ */
+class FloorIndex {
+private:
+	/** a run of enterable voxels - @c start is the floor height if the run doesn't start at the bottom */
+	struct Run {
+		int16_t start;
+		/** the first voxel that is not enterable - or @c MAX_HEIGHT + 1 */
+		int16_t end;
+		/** the voxel below the floor */
+		voxel::Voxel below;
+		/** the voxel at the floor height */
+		voxel::Voxel floor;
+	};
+	struct Column {
+		uint32_t offset = 0u;
+		uint16_t count = 0u;
+	};
+	struct Tile {
+		std::vector<Column> columns;
+		std::vector<Run> runs;
+	};
+
+	int _tileSize = 0;
+	std::unordered_map<glm::ivec2, Tile, std::hash<glm::ivec2> > _tiles;
+	mutable core_trace_mutex(core::Lock, _lock, "FloorIndex");
+
+	glm::ivec2 tilePos(int x, int z) const;
+	const Tile* tile(int x, int z) const;
+
+	template<class VoxelFunc>
+	static void scanColumn(VoxelFunc&& voxelAt, std::vector<Run>& runs);
+
+public:
+	/**
+	 * @param tileSize The side length of the chunks
+	 */
+	void init(int tileSize);
+	void shutdown();
+
+	/**
+	 * @brief Indexes all columns of the given chunk - called if a chunk was generated or loaded
+	 * @param region The region of the chunk in world coordinates
+	 */
+	void build(const voxel::PagedVolume::Chunk& chunk, const voxel::Region& region);
+
+	/**
+	 * @brief Drops the tiles that are completely covered by the given region - called if a chunk was paged out
+	 */
+	void remove(const voxel::Region& region);
+
+	/**
+	 * @brief The same lookup as @c voxelutil::findWalkableFloor()
+	 * @return @c false if the column is not indexed - the result is not touched in that case
+	 */
+	bool findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result) const;
+
+	/**
+	 * @return The amount of floors in the given column - or @c -1 if the column is not indexed
+	 */
+	int floors(int x, int z) const;
+	/**
+	 * @brief The heights of the walkable floors of the given column - the voxel below each floor is not enterable
+	 * @return @c false if the column is not indexed
+	 */
+	bool floorHeights(int x, int z, std::vector<int>& heights) const;
+
+	void clear();
+	int tiles() const;
+};
+
+}
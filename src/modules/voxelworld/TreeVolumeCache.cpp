@@ -52,19 +52,26 @@ void TreeVolumeCache::shutdown() {
 	_treeTypeCount.clear();
 }
 
-voxel::RawVolume* TreeVolumeCache::loadTree(const glm::ivec3& treePos, const char *treeType) {
+bool TreeVolumeCache::treeFilename(char *buf, size_t bufSize, const char *treeType, int treeIndex) const {
+	if (!core::string::formatBuf(buf, bufSize, "models/trees/%s/%i", treeType, treeIndex)) {
+		Log::error("Failed to assemble tree path");
+		return false;
+	}
+	return true;
+}
+
+voxelformat::VolumeCache::VolumePtr TreeVolumeCache::loadTree(const glm::ivec3& treePos, const char *treeType) {
 	int treeCount = 1;
 	if (!_treeTypeCount.get(treeType, treeCount)) {
 		Log::warn("Could not get tree type count for %s - assuming 1", treeType);
 	}
 	if (treeCount <= 0) {
-		return nullptr;
+		return voxelformat::VolumeCache::VolumePtr();
 	}
 	const int treeIndex = 1 + (glm::abs(treePos.x + treePos.z) % treeCount);
 	char filename[64];
-	if (!core::string::formatBuf(filename, sizeof(filename), "models/trees/%s/%i", treeType, treeIndex)) {
-		Log::error("Failed to assemble tree path");
-		return nullptr;
+	if (!treeFilename(filename, sizeof(filename), treeType, treeIndex)) {
+		return voxelformat::VolumeCache::VolumePtr();
 	}
 	return _volumeCache->loadVolume(filename);
 }
@@ -13,8 +13,9 @@ namespace voxelworld {
 class TreeVolumeCache {
 private:
 	core::StringMap<int> _treeTypeCount;
-
 	voxelformat::VolumeCachePtr _volumeCache;
+
+	bool treeFilename(char *buf, size_t bufSize, const char *treeType, int treeIndex) const;
 public:
 	TreeVolumeCache(const voxelformat::VolumeCachePtr& volumeCache);
 
@@ -29,7 +30,7 @@ public:
 	 * the registered biome tree types
 	 * @return voxel::RawVolume or @c nullptr if no tree volume was found for the given tree type.
 	 */
-	voxel::RawVolume* loadTree(const glm::ivec3& treePos, const char *treeType);
+	voxelformat::VolumeCache::VolumePtr loadTree(const glm::ivec3& treePos, const char *treeType);
 };
 
 }
\ No newline at end of file
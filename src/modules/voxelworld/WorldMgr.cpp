@@ -38,6 +38,7 @@ glm::ivec3 WorldMgr::randomPos() const {
 
 void WorldMgr::reset() {
 	_volumeData->flushAll();
+	_floorIndex.clear();
 }
 
 void WorldMgr::setSeed(unsigned int seed) {
@@ -53,16 +54,22 @@ voxel::PagedVolume::Sampler WorldMgr::sampler() {
 
 bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
 	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
+	_floorIndex.init(chunkSideLength);
 	return true;
 }
 
 void WorldMgr::shutdown() {
 	delete _volumeData;
 	_volumeData = nullptr;
+	_floorIndex.shutdown();
 }
 
 voxelutil::FloorTraceResult WorldMgr::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards) const {
 	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
+	voxelutil::FloorTraceResult result;
+	if (_floorIndex.findWalkableFloor(position, maxDistanceUpwards, result)) {
+		return result;
+	}
 	voxel::PagedVolume::Sampler sampler(_volumeData);
 	return voxelutil::findWalkableFloor(&sampler, position, maxDistanceUpwards);
 }
@@ -10,6 +10,7 @@
 #include "voxel/PagedVolume.h"
 #include "voxelutil/Raycast.h"
 #include "voxelutil/FloorTraceResult.h"
+#include "FloorIndex.h"
 #include "voxelformat/VolumeCache.h"
 #include "voxel/Constants.h"
 #include "core/GLM.h"
@@ -44,6 +45,7 @@ public:
 	/**
 	 * @sa voxelutil::FloorTraceResult
 	 * @return The y component for the given x and z coordinates that is walkable - or @c NO_FLOOR_FOUND.
+	 * @note The floor index is used if the column is indexed - the voxels are only walked for the other columns
 	 */
 	voxelutil::FloorTraceResult findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards = voxel::MAX_HEIGHT) const;
 
@@ -64,6 +66,11 @@ public:
 
 	voxel::PagedVolume::Sampler sampler();
 	voxel::PagedVolume *volumeData();
+	/**
+	 * @brief The walkable floors of the chunks that were handed to it
+	 * @sa WorldPager::setChunkListener()
+	 */
+	FloorIndex& floorIndex();
 
 private:
 	friend class WorldMgrTest;
@@ -75,6 +82,7 @@ private:
 
 	voxel::PagedVolume::PagerPtr _pager;
 	voxel::PagedVolume *_volumeData = nullptr;
+	FloorIndex _floorIndex;
 	mutable std::mt19937 _engine;
 	long _seed = 0l;
 
@@ -85,6 +93,10 @@ inline voxel::PagedVolume *WorldMgr::volumeData() {
 	return _volumeData;
 }
 
+inline FloorIndex& WorldMgr::floorIndex() {
+	return _floorIndex;
+}
+
 inline glm::ivec3 WorldMgr::chunkPos(const glm::ivec3& pos) const {
 	const float size = _volumeData->chunkSideLength();
 	const int x = glm::floor(pos.x / size);
@@ -27,6 +27,9 @@ bool WorldPager::pageIn(voxel::PagedVolume::PagerContext& pctx) {
 		return false;
 	}
 	if (_chunkPersister->load(pctx.chunk, _seed)) {
+		if (_chunkListener) {
+			_chunkListener(*pctx.chunk.get(), pctx.region);
+		}
 		return false;
 	}
 	voxel::PagedVolumeWrapper wrapper(_volumeData, pctx.chunk, pctx.region);
@@ -37,11 +40,19 @@ bool WorldPager::pageIn(voxel::PagedVolume::PagerContext& pctx) {
 	placeTrees(pctx);
 	_chunkPersister->save(pctx.chunk, _seed);
 	//}
+	if (_chunkListener) {
+		_chunkListener(*pctx.chunk.get(), pctx.region);
+	}
 	return true;
 }
 
 void WorldPager::pageOut(voxel::PagedVolume::Chunk* chunk) {
 	// currently chunks are not modifiable and are saved directly after creating the chunk
+	if (_pageOutListener) {
+		const int sideLength = chunk->sideLength();
+		const glm::ivec3 mins = chunk->chunkPos() * sideLength;
+		_pageOutListener(voxel::Region(mins, mins + sideLength - 1));
+	}
 }
 
 void WorldPager::setSeed(unsigned int seed) {
@@ -52,6 +63,14 @@ void WorldPager::setNoiseOffset(const glm::vec2& noiseOffset) {
 	_noiseSeedOffset = noiseOffset;
 }
 
+void WorldPager::setChunkListener(const ChunkListener& listener) {
+	_chunkListener = listener;
+}
+
+void WorldPager::setPageOutListener(const PageOutListener& listener) {
+	_pageOutListener = listener;
+}
+
 bool WorldPager::init(voxel::PagedVolume *volumeData, const core::String& worldParamsLua, const core::String& biomesLua) {
 	if (!_biomeManager.init(biomesLua)) {
 		Log::error("Failed to init biome mgr");
@@ -159,6 +178,18 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	return ni;
 }
 
+int WorldPager::surface(int x, int z, voxel::Voxel& surface) const {
+	core_trace_scoped(TerrainSurface);
+	const float n = getNoiseValue(x, z);
+	const int ni = terrainHeight(x, 0, z, n);
+	if (ni <= voxel::MAX_WATER_HEIGHT) {
+		surface = createColorVoxel(voxel::VoxelType::Water, _seed);
+		return voxel::MAX_WATER_HEIGHT;
+	}
+	surface = _biomeManager.getVoxel(glm::ivec3(x, ni - 1, z), false);
+	return ni;
+}
+
 int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const {
 	core_trace_scoped(FillVoxels);
 	const float n = getNoiseValue(x, z);
@@ -254,11 +285,11 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 			}
 			const char *treeType = treeTypes[treeTypeIndex++];
 			treeTypeIndex %= treeTypeSize;
-			const voxel::RawVolume* v = _volumeCache.loadTree(treePos, treeType);
-			if (v == nullptr) {
+			const voxelformat::VolumeCache::VolumePtr& v = _volumeCache.loadTree(treePos, treeType);
+			if (!v) {
 				continue;
 			}
-			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v, axes[positionIndex % axesSize]);
+			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v.get(), axes[positionIndex % axesSize]);
 			addVolumeToPosition(chunkWrapper, rotateWrapper, treePos);
 		}
 	}
@@ -15,6 +15,7 @@
 #include "ChunkPersister.h"
 #include "TreeVolumeCache.h"
 #include "voxelutil/RawVolumeRotateWrapper.h"
+#include <functional>
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -30,6 +31,15 @@ namespace voxelworld {
  * The pager is the streaming interface for the voxel::PagedVolume.
  */
 class WorldPager: public voxel::PagedVolume::Pager {
+public:
+	/**
+	 * @brief Called for every chunk that was generated or loaded
+	 */
+	using ChunkListener = std::function<void(const voxel::PagedVolume::Chunk& chunk, const voxel::Region& region)>;
+	/**
+	 * @brief Called for every chunk that was removed from memory
+	 */
+	using PageOutListener = std::function<void(const voxel::Region& region)>;
 private:
 	unsigned int _seed = 0l;
 	glm::vec2 _noiseSeedOffset;
@@ -40,6 +50,8 @@ private:
 	noise::Noise _noise;
 	TreeVolumeCache _volumeCache;
 	ChunkPersisterPtr _chunkPersister;
+	ChunkListener _chunkListener;
+	PageOutListener _pageOutListener;
 
 	void createWorld(voxel::PagedVolumeWrapper& volume) const;
 	void placeTrees(voxel::PagedVolume::PagerContext& pagerCtx);
@@ -80,6 +92,23 @@ public:
 
 	void setNoiseOffset(const glm::vec2& noiseOffset);
 
+	/**
+	 * @note The listener is called from the thread that pages in the chunk
+	 */
+	void setChunkListener(const ChunkListener& listener);
+	/**
+	 * @note The listener is called from the thread that releases the last reference to the chunk
+	 */
+	void setPageOutListener(const PageOutListener& listener);
+
+	/**
+	 * @brief Samples the generated terrain without paging in any chunk - caves below the surface,
+	 * trees and persisted modifications are not taken into account
+	 * @param[out] surface The voxel on top of the terrain column - water if the terrain is below the water level
+	 * @return The height of the first voxel above the terrain surface or the water
+	 */
+	int surface(int x, int z, voxel::Voxel& surface) const;
+
 	void erase(const voxel::Region& region);
 	/**
 	 * @return @c true if the chunk was modified (created), @c false if it was just loaded
@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/FloorIndex.h"
+#include "voxelutil/FloorTrace.h"
+#include "voxel/Constants.h"
+#include <algorithm>
+
+namespace voxelworld {
+
+class FloorIndexTest: public app::AbstractTest {
+protected:
+	static constexpr int ChunkSize = voxel::MAX_HEIGHT + 1;
+
+	class Pager: public voxel::PagedVolume::Pager {
+		FloorIndexTest* _test;
+	public:
+		Pager(FloorIndexTest* test) :
+				_test(test) {
+		}
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			_test->generate(ctx.region, *ctx.chunk.get());
+			_test->_index.build(*ctx.chunk.get(), ctx.region);
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+			const int sideLength = chunk->sideLength();
+			const glm::ivec3 mins = chunk->chunkPos() * sideLength;
+			_test->_index.remove(voxel::Region(mins, mins + sideLength - 1));
+		}
+	};
+
+	/**
+	 * @brief Hills with a bridge and a cave - some columns have several floors
+	 */
+	void generate(const voxel::Region& region, voxel::PagedVolume::Chunk& chunk) const {
+		const voxel::Voxel grass = voxel::createVoxel(voxel::VoxelType::Grass, 0);
+		const voxel::Voxel wood = voxel::createVoxel(voxel::VoxelType::Wood, 0);
+		voxel::Voxel column[ChunkSize];
+		for (int z = 0; z < ChunkSize; ++z) {
+			for (int x = 0; x < ChunkSize; ++x) {
+				const int wx = region.getLowerX() + x;
+				const int wz = region.getLowerZ() + z;
+				const int height = 10 + (wx + wz) % 7;
+				for (int y = 0; y < ChunkSize; ++y) {
+					column[y] = y < height ? grass : voxel::Voxel();
+				}
+				if (wx >= 10 && wx <= 20) {
+					column[30] = column[31] = wood;
+				}
+				if (wz >= 40 && wz <= 50) {
+					column[3] = column[4] = column[5] = voxel::Voxel();
+				}
+				chunk.setVoxels(x, z, column, ChunkSize);
+			}
+		}
+	}
+
+	Pager _pager;
+	voxel::PagedVolume _volume;
+	FloorIndex _index;
+
+	FloorIndexTest() :
+			_pager(this), _volume(&_pager, 128 * 1024 * 1024, ChunkSize) {
+	}
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_index.init(ChunkSize);
+		// page in the chunk
+		_volume.voxel(0, 0, 0);
+	}
+
+	void compare(const voxel::Region& region) {
+		const int heights[] = { 0, 3, 4, 8, 12, 20, 30, 31, 32, 50, voxel::MAX_HEIGHT };
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				for (int y : heights) {
+					for (int maxDistance : { 2, voxel::MAX_HEIGHT }) {
+						const glm::ivec3 pos(x, y, z);
+						voxelutil::FloorTraceResult indexed;
+						if (!_index.findWalkableFloor(pos, maxDistance, indexed)) {
+							continue;
+						}
+						const voxelutil::FloorTraceResult& traced = voxelutil::findWalkableFloor(&_volume, pos, maxDistance);
+						ASSERT_EQ(traced.heightLevel, indexed.heightLevel) << "at " << x << ":" << y << ":" << z << " (" << maxDistance << ")";
+						ASSERT_EQ(traced.voxel.getMaterial(), indexed.voxel.getMaterial()) << "at " << x << ":" << y << ":" << z;
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(FloorIndexTest, testBuild) {
+	EXPECT_EQ(1, _index.tiles());
+	EXPECT_EQ(1, _index.floors(0, 0));
+	EXPECT_EQ(2, _index.floors(15, 0));
+	EXPECT_EQ(2, _index.floors(0, 45));
+	EXPECT_EQ(3, _index.floors(15, 45));
+	EXPECT_EQ(-1, _index.floors(-1, 0));
+	compare(voxel::Region(0, 0, 0, 63, 0, 63));
+}
+
+TEST_F(FloorIndexTest, testFloorHeights) {
+	std::vector<int> heights;
+	ASSERT_TRUE(_index.floorHeights(15, 45, heights));
+	ASSERT_EQ(3u, heights.size());
+	for (int y = 1; y <= voxel::MAX_HEIGHT; ++y) {
+		const bool walkable = voxel::isEnterable(_volume.voxel(15, y, 45).getMaterial())
+				&& !voxel::isEnterable(_volume.voxel(15, y - 1, 45).getMaterial());
+		EXPECT_EQ(walkable, std::find(heights.begin(), heights.end(), y) != heights.end()) << "at " << y;
+	}
+	EXPECT_FALSE(_index.floorHeights(-1, 0, heights));
+	EXPECT_TRUE(heights.empty());
+}
+
+TEST_F(FloorIndexTest, testRemove) {
+	// only a part of the tile
+	_index.remove(voxel::Region(0, 0, 0, ChunkSize - 2, ChunkSize - 1, ChunkSize - 1));
+	EXPECT_EQ(1, _index.tiles());
+	// above the tile
+	_index.remove(voxel::Region(0, ChunkSize, 0, ChunkSize - 1, 2 * ChunkSize - 1, ChunkSize - 1));
+	EXPECT_EQ(1, _index.tiles());
+	// the chunk is paged out
+	_volume.flushAll();
+	EXPECT_EQ(0, _index.tiles());
+	EXPECT_EQ(-1, _index.floors(0, 0));
+}
+
+TEST_F(FloorIndexTest, testNotIndexed) {
+	voxelutil::FloorTraceResult result;
+	EXPECT_FALSE(_index.findWalkableFloor(glm::ivec3(-10, 20, 0), voxel::MAX_HEIGHT, result));
+	EXPECT_FALSE(_index.findWalkableFloor(glm::ivec3(0, -1, 0), voxel::MAX_HEIGHT, result));
+}
+
+}
@@ -35,15 +35,15 @@ void AssetVolumeCache::shutdown() {
 	_volumeCache = voxelformat::VolumeCachePtr();
 }
 
-voxel::RawVolume* AssetVolumeCache::loadPlant(const glm::ivec3& pos) {
+voxelformat::VolumeCache::VolumePtr AssetVolumeCache::loadPlant(const glm::ivec3& pos) {
 	if (_plantCount <= 0) {
-		return nullptr;
+		return voxelformat::VolumeCache::VolumePtr();
 	}
 	const int index = 1 + (glm::abs(pos.x + pos.z) % _plantCount);
 	char filename[64];
 	if (!core::string::formatBuf(filename, sizeof(filename), "models/plants/%i", index)) {
 		Log::error("Failed to assemble plant path");
-		return nullptr;
+		return voxelformat::VolumeCache::VolumePtr();
 	}
 	return _volumeCache->loadVolume(filename);
 }
@@ -34,7 +34,7 @@ public:
 	 * @return voxel::RawVolume or @c nullptr if no suitable plant was found.
 	 * @note Plants are stored by index in @c models/plants/
 	 */
-	voxel::RawVolume* loadPlant(const glm::ivec3& pos);
+	voxelformat::VolumeCache::VolumePtr loadPlant(const glm::ivec3& pos);
 };
 
 typedef core::SharedPtr<AssetVolumeCache> AssetVolumeCachePtr;
@@ -103,7 +103,7 @@ void PlayerCamera::update(const glm::vec3& entityPosition, double nowSeconds, do
 	}
 
 	_camera.setTargetDistance(_targetDistance);
-	_camera.setFarPlane(_worldRenderer.getViewDistance());
+	_camera.setFarPlane(_worldRenderer.getRenderDistance());
 	_camera.update(deltaFrameSeconds);
 }
 
@@ -44,8 +44,7 @@ alignas(16) static constexpr glm::vec2 waterPlaneVecs[] = {
 };
 
 WorldRenderer::WorldRenderer(const AssetVolumeCachePtr& assetVolumeCache) :
-		_threadPool(1, "WorldRenderer"), _worldChunkMgr(_threadPool), _assetVolumeCache(assetVolumeCache),
-		_shadowMapShader(shader::ShadowmapShader::getInstance()) {
+		_threadPool(2, "WorldRenderer"), _worldChunkMgr(_threadPool), _assetVolumeCache(assetVolumeCache) {
 	setViewDistance(800.0f);
 }
 
@@ -60,6 +59,7 @@ void WorldRenderer::reset() {
 void WorldRenderer::shutdown() {
 	_cancelThreads = true;
 	_worldShader.shutdown();
+	_worldShadowMapShader.shutdown();
 	_waterShader.shutdown();
 	_materialBlock.shutdown();
 	_entityRenderer.shutdown();
@@ -75,7 +75,6 @@ void WorldRenderer::shutdown() {
 	_waterBuffer.shutdown();
 	_shadow.shutdown();
 	_skybox.shutdown();
-	_shadowMapShader.shutdown();
 	shutdownFrameBuffers();
 	_postProcessBuf.shutdown();
 	_postProcessBufId = -1;
@@ -150,14 +149,17 @@ int WorldRenderer::renderClippingPlanes(const video::Camera& camera) {
 	// render above water
 	_reflectionBuffer.bind(true);
 	const glm::mat4& vpmatRefl = reflectionMatrix(camera);
-	drawCallsWorld += renderTerrain(vpmatRefl, waterAbovePlane);
+	// the reflection camera is mirrored at the water plane
+	const glm::vec3& eye = camera.position();
+	const glm::vec3 eyeRefl(eye.x, 2.0f * waterHeight - eye.y, eye.z);
+	drawCallsWorld += renderTerrain(vpmatRefl, waterAbovePlane, eyeRefl);
 	drawCallsWorld += renderEntities(vpmatRefl, waterAbovePlane);
 	_reflectionBuffer.unbind();
 
 	// render below water
 	const glm::mat4& vpmat = camera.viewProjectionMatrix();
 	_refractionBuffer.bind(true);
-	drawCallsWorld += renderTerrain(vpmat, waterBelowPlane);
+	drawCallsWorld += renderTerrain(vpmat, waterBelowPlane, eye);
 	drawCallsWorld += renderEntities(vpmat, waterBelowPlane);
 	_refractionBuffer.unbind();
 
@@ -174,14 +176,14 @@ int WorldRenderer::renderToShadowMap(const video::Camera& camera) {
 	_entityRenderer.renderShadows(_entityMgr.visibleEntities(), _shadow);
 
 	// render the terrain
-	_shadowMapShader.activate();
-	_shadowMapShader.setModel(glm::mat4(1.0f));
+	_worldShadowMapShader.activate();
+	_worldShadowMapShader.setModel(glm::mat4(1.0f));
 	_shadow.render([this] (int i, const glm::mat4& lightViewProjection) {
-		_shadowMapShader.setLightviewprojection(lightViewProjection);
+		_worldShadowMapShader.setLightviewprojection(lightViewProjection);
 		_worldChunkMgr.renderTerrain();
 		return true;
 	}, false);
-	_shadowMapShader.deactivate();
+	_worldShadowMapShader.deactivate();
 	return (int)_entityMgr.visibleEntities().size() + 1;
 }
 
@@ -222,7 +224,7 @@ int WorldRenderer::renderToFrameBuffer(const video::Camera& camera) {
 	return drawCallsWorld;
 }
 
-int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane) {
+int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane, const glm::vec3& eye) {
 	int drawCallsWorld = 0;
 	video_trace_scoped(WorldRendererRenderOpaque);
 	video::ScopedShader scoped(_worldShader);
@@ -250,7 +252,7 @@ int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const gl
 		_worldShader.setCascades(_shadow.cascades());
 		_worldShader.setDistances(_shadow.distances());
 	}
-	drawCallsWorld += _worldChunkMgr.renderTerrain();
+	drawCallsWorld += _worldChunkMgr.renderTerrain(&eye);
 	return drawCallsWorld;
 }
 
@@ -313,7 +315,7 @@ int WorldRenderer::renderAll(const video::Camera& camera) {
 	// due to driver bugs the clip plane might still be taken into account
 	constexpr glm::vec4 ignoreClipPlane(glm::up, 0.0f);
 	const glm::mat4& vpmat = camera.viewProjectionMatrix();
-	drawCallsWorld += renderTerrain(vpmat, ignoreClipPlane);
+	drawCallsWorld += renderTerrain(vpmat, ignoreClipPlane, camera.position());
 	drawCallsWorld += renderEntities(vpmat, ignoreClipPlane);
 	drawCallsWorld += renderPlants(vpmat, ignoreClipPlane);
 	drawCallsWorld += renderEntityDetails(camera);
@@ -343,6 +345,11 @@ int WorldRenderer::renderEntityDetails(const video::Camera& camera) {
 void WorldRenderer::construct() {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_water = core::Var::getSafe(cfg::ClientWater);
+	core::Var::get(cfg::VoxelLODDistance, "0");
+	core::Var::get(cfg::VoxelUploadBudget, "2");
+	core::Var::get(cfg::ClientOcclusionCulling, "true");
+	core::Var::get(cfg::ClientMeshCacheSize, "0");
+	_impostorDistance = core::Var::get(cfg::ClientImpostorDistance, "2000");
 	_entityRenderer.construct();
 }
 
@@ -385,8 +392,8 @@ bool WorldRenderer::init(voxel::PagedVolume* volume, const glm::ivec2& position,
 		Log::error("Failed to initialize the sky");
 		return false;
 	}
-	if (!_shadowMapShader.setup()) {
-		Log::error("Failed to init shadowmap shader");
+	if (!_worldShadowMapShader.setup()) {
+		Log::error("Failed to init world shadowmap shader");
 		return false;
 	}
 	const int shaderMaterialColorsArraySize = lengthof(shader::WorldData::MaterialblockData::materialcolor);
@@ -424,6 +431,10 @@ bool WorldRenderer::init(voxel::PagedVolume* volume, const glm::ivec2& position,
 
 	_worldChunkMgr.init(&_worldShader, volume);
 	_worldChunkMgr.updateViewDistance(_viewDistance);
+	if (_terrainSurface && !_worldChunkMgr.initImpostors(_terrainSurface)) {
+		Log::warn("Failed to initialize the terrain impostors");
+	}
+	updateRenderDistance();
 	_threadPool.enqueue([this] () {while (!_cancelThreads) { _worldChunkMgr.extractScheduledMesh(); } });
 
 	if (!initFrameBuffers(dimension)) {
@@ -502,8 +513,26 @@ void WorldRenderer::shutdownFrameBuffers() {
 	_reflectionBuffer.shutdown();
 }
 
+float WorldRenderer::getRenderDistance() const {
+	if (!_terrainSurface || !_impostorDistance) {
+		return _viewDistance;
+	}
+	return glm::max(_viewDistance, _impostorDistance->floatVal());
+}
+
+void WorldRenderer::updateRenderDistance() {
+	const float renderDistance = getRenderDistance();
+	_fogRange = renderDistance * 0.80f;
+	_entityRenderer.setViewDistance(_viewDistance, _fogRange);
+	_worldChunkMgr.updateImpostorDistance(renderDistance > _viewDistance ? renderDistance : 0.0f);
+}
+
 void WorldRenderer::update(const video::Camera& camera, double deltaFrameSeconds) {
 	core_trace_scoped(WorldRendererOnRunning);
+	if (_impostorDistance->isDirty()) {
+		updateRenderDistance();
+		_impostorDistance->markClean();
+	}
 	_focusPos = camera.target();
 	_deltaFrameSeconds = deltaFrameSeconds;
 	_focusPos.y = 0.0f;//TODO: _world->findFloor(_focusPos.x, _focusPos.z, voxel::isFloor);
@@ -64,15 +64,20 @@ protected:
 
 	core::VarPtr _shadowMap;
 	core::VarPtr _water;
+	core::VarPtr _impostorDistance;
+	SurfaceFunc _terrainSurface;
 
 	// this ub is currently shared between the world, world instanced and water shader
 	shader::WorldData _materialBlock;
 	// dedicated shaders
 	shader::WorldShader _worldShader;
+	shader::WorldShadowmapShader _worldShadowMapShader;
 	shader::WaterShader _waterShader;
-	// shared shaders
-	shader::ShadowmapShader& _shadowMapShader;
 
+	/**
+	 * @brief Updates the fog and the impostor range after the view or the impostor distance changed
+	 */
+	void updateRenderDistance();
 	bool initFrameBuffers(const glm::ivec2 &dimensions);
 	void shutdownFrameBuffers();
 
@@ -92,7 +97,10 @@ protected:
 	int renderEntitiesToDepthMap(const video::Camera& camera);
 
 	int renderAll(const video::Camera& camera);
-	int renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane);
+	/**
+	 * @param[in] eye The position the terrain is seen from - used to skip the faces that are pointing away
+	 */
+	int renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane, const glm::vec3& eye);
 	int renderEntities(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane);
 	int renderPlants(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane);
 	int renderEntityDetails(const video::Camera& camera);
@@ -127,12 +135,26 @@ public:
 	const frontend::EntityMgr &entityMgr() const;
 
 	void setSeconds(double seconds);
+	void setSeed(uint32_t seed);
+	/**
+	 * @brief Enables the low resolution terrain impostors for the area beyond the view distance
+	 * @note Must be called before @c init()
+	 * @sa cfg::ClientImpostorDistance
+	 */
+	void setTerrainSurface(const SurfaceFunc& surface);
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
 
+	/**
+	 * @return The distance up to which meshes are extracted
+	 */
 	float getViewDistance() const;
 	void setViewDistance(float viewDistance);
+	/**
+	 * @return The distance up to which the terrain is rendered - this includes the impostors
+	 */
+	float getRenderDistance() const;
 
 	int renderWorld(const video::Camera &camera);
 };
@@ -149,14 +171,21 @@ inline void WorldRenderer::setSeconds(double seconds) {
 	_seconds = seconds;
 }
 
+inline void WorldRenderer::setSeed(uint32_t seed) {
+	_worldChunkMgr.setSeed(seed);
+}
+
 inline float WorldRenderer::getViewDistance() const {
 	return _viewDistance;
 }
 
 inline void WorldRenderer::setViewDistance(float viewDistance) {
 	_viewDistance = viewDistance;
-	_fogRange = _viewDistance * 0.80f;
-	_entityRenderer.setViewDistance(_viewDistance, _fogRange);
+	updateRenderDistance();
+}
+
+inline void WorldRenderer::setTerrainSurface(const SurfaceFunc& surface) {
+	_terrainSurface = surface;
 }
 
 inline render::Shadow &WorldRenderer::shadow() {
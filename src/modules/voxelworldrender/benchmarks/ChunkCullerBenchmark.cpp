@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxelworldrender/worldrenderer/ChunkCuller.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/trigonometric.hpp>
+#include <vector>
+
+namespace {
+
+constexpr int ChunkSize = 32;
+constexpr int ChunkHeight = 128;
+constexpr int ChunksPerSide = 64;
+constexpr int CirclePathLength = 256;
+
+struct CameraPose {
+	glm::mat4 view;
+	glm::vec3 eye;
+};
+
+}
+
+class ChunkCullerBenchmark : public app::AbstractBenchmark {
+protected:
+	voxelworldrender::CullInput _input;
+	std::vector<CameraPose> _circlePath;
+	glm::mat4 _projection { 1.0f };
+
+	static float terrainHeight(float x, float z) {
+		return 40.0f + 30.0f * glm::sin(x * 0.01f) * glm::cos(z * 0.013f) + 10.0f * glm::sin(z * 0.031f);
+	}
+
+public:
+	void SetUp(::benchmark::State& state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+		// rolling hills - the solid part of each chunk is the lowest terrain height inside of it
+		_input.chunks.clear();
+		for (int cz = 0; cz < ChunksPerSide; ++cz) {
+			for (int cx = 0; cx < ChunksPerSide; ++cx) {
+				voxelworldrender::CullChunk chunk;
+				chunk.mins = glm::vec3(cx * ChunkSize, 0.0f, cz * ChunkSize);
+				chunk.maxs = chunk.mins + glm::vec3(ChunkSize, ChunkHeight, ChunkSize);
+				float minHeight = (float)ChunkHeight;
+				for (int z = 0; z <= ChunkSize; z += 4) {
+					for (int x = 0; x <= ChunkSize; x += 4) {
+						minHeight = glm::min(minHeight, terrainHeight(chunk.mins.x + x, chunk.mins.z + z));
+					}
+				}
+				chunk.solidHeight = glm::floor(minHeight);
+				chunk.slot = (int)_input.chunks.size();
+				_input.chunks.push_back(chunk);
+			}
+		}
+
+		// a generated camera path close to the ground that circles the center of the terrain
+		_circlePath.clear();
+		const float center = ChunksPerSide * ChunkSize * 0.5f;
+		for (int i = 0; i < CirclePathLength; ++i) {
+			const float angle = glm::two_pi<float>() * (float)i / (float)CirclePathLength;
+			const float radius = center * 0.6f;
+			const glm::vec2 pos(center + glm::cos(angle) * radius, center + glm::sin(angle) * radius);
+			CameraPose pose;
+			pose.eye = glm::vec3(pos.x, terrainHeight(pos.x, pos.y) + 8.0f, pos.y);
+			// looking along the path
+			const glm::vec3 dir(-glm::sin(angle), -0.05f, glm::cos(angle));
+			pose.view = glm::lookAt(pose.eye, pose.eye + dir, glm::vec3(0.0f, 1.0f, 0.0f));
+			_circlePath.push_back(pose);
+		}
+	}
+
+	void cull(::benchmark::State& state, bool occlusion) {
+		voxelworldrender::ChunkCuller culler;
+		std::vector<int> visible;
+		size_t frame = 0;
+		size_t visibleChunks = 0;
+		for (auto _ : state) {
+			const CameraPose& pose = _circlePath[frame % _circlePath.size()];
+			_input.frustum.update(pose.view, _projection);
+			_input.viewProjection = _projection * pose.view;
+			_input.eye = pose.eye;
+			_input.occlusion = occlusion;
+			culler.cull(_input, visible);
+			visibleChunks += visible.size();
+			++frame;
+		}
+		state.counters["visible"] = ::benchmark::Counter((double)visibleChunks / (double)frame);
+	}
+};
+
+BENCHMARK_DEFINE_F(ChunkCullerBenchmark, Frustum)(benchmark::State& state) {
+	cull(state, false);
+}
+
+BENCHMARK_DEFINE_F(ChunkCullerBenchmark, FrustumOcclusion)(benchmark::State& state) {
+	cull(state, true);
+}
+
+BENCHMARK_REGISTER_F(ChunkCullerBenchmark, Frustum);
+BENCHMARK_REGISTER_F(ChunkCullerBenchmark, FrustumOcclusion);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,112 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxelworldrender/worldrenderer/WorldMeshExtractor.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+#include "voxel/Constants.h"
+#include "voxel/PagedVolume.h"
+#include <glm/trigonometric.hpp>
+
+namespace {
+
+constexpr int MeshSize = 32;
+constexpr int MeshesPerSide = 4;
+
+/**
+ * @brief Rolling hills with caves - the same terrain for every run
+ */
+class HillsPager : public voxel::PagedVolume::Pager {
+public:
+	bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+		const voxel::Region& region = ctx.region;
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const int height = 40 + (int)(20.0f * glm::sin(x * 0.05f) * glm::cos(z * 0.07f));
+				const int maxY = glm::min(height, region.getUpperY());
+				for (int y = region.getLowerY(); y <= maxY; ++y) {
+					if (y > 10 && y < 20 && (x + z) % 5 == 0) {
+						continue;
+					}
+					const voxel::VoxelType type = y == height ? voxel::VoxelType::Grass : voxel::VoxelType::Rock;
+					ctx.chunk->setVoxel(x - region.getLowerX(), y - region.getLowerY(), z - region.getLowerZ(),
+							voxel::createVoxel(type, 0));
+				}
+			}
+		}
+		return true;
+	}
+
+	void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+	}
+};
+
+}
+
+class MeshCacheBenchmark : public app::AbstractBenchmark {
+protected:
+	HillsPager _pager;
+	voxel::PagedVolume* _volume = nullptr;
+	voxelworldrender::WorldMeshExtractor _extractor;
+
+	void extract(int index) {
+		const int i = index % (MeshesPerSide * MeshesPerSide);
+		const glm::ivec3 pos((i % MeshesPerSide) * MeshSize, 0, (i / MeshesPerSide) * MeshSize);
+		_extractor.scheduleMeshExtraction(pos);
+		_extractor.extractScheduledMesh();
+		voxelworldrender::ExtractedMesh extracted;
+		_extractor.pop(extracted);
+		_extractor.allowReExtraction(pos);
+	}
+
+	void init(int cacheSizeMB) {
+		core::Var::get(cfg::VoxelMeshSize, "32", core::CV_READONLY);
+		core::Var::get(cfg::ClientMeshCacheSize, "0")->setVal(cacheSizeMB);
+		_volume = new voxel::PagedVolume(&_pager, 256 * 1024 * 1024, 256);
+		_extractor.init(_volume);
+		// page in the chunks - only the extraction should be measured
+		for (int i = 0; i < MeshesPerSide * MeshesPerSide; ++i) {
+			extract(i);
+		}
+	}
+
+public:
+	void TearDown(::benchmark::State& state) override {
+		_extractor.shutdown();
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(MeshCacheBenchmark, Extract)(benchmark::State& state) {
+	init(0);
+	int i = 0;
+	for (auto _ : state) {
+		extract(i++);
+	}
+}
+
+BENCHMARK_DEFINE_F(MeshCacheBenchmark, Miss)(benchmark::State& state) {
+	init(64);
+	int i = 0;
+	for (auto _ : state) {
+		// the seed is part of the key - every lookup misses and the mesh is put into the cache
+		_extractor.setSeed((uint32_t)i);
+		extract(i++);
+	}
+}
+
+BENCHMARK_DEFINE_F(MeshCacheBenchmark, Hit)(benchmark::State& state) {
+	init(64);
+	int i = 0;
+	for (auto _ : state) {
+		extract(i++);
+	}
+}
+
+BENCHMARK_REGISTER_F(MeshCacheBenchmark, Extract);
+BENCHMARK_REGISTER_F(MeshCacheBenchmark, Miss);
+BENCHMARK_REGISTER_F(MeshCacheBenchmark, Hit);
@@ -0,0 +1,16 @@
+/**
+ * @brief Decodes the packed terrain vertices
+ * @sa voxel::CompactVertex
+ */
+
+vec3 terrainPosition(uint data, vec3 origin) {
+	return origin + vec3(float(data & 63u), float((data >> 6) & 127u), float((data >> 13) & 63u));
+}
+
+uint terrainAmbientOcclusion(uint data) {
+	return (data >> 19) & 3u;
+}
+
+uint terrainColorIndex(uint data) {
+	return data >> 24;
+}
@@ -1,6 +1,6 @@
 // attributes from the VAOs
-$in vec3 a_pos;
-$in uvec2 a_info;
+$in uint a_data;
+$in vec3 a_origin;
 
 uniform mat4 u_model;
 uniform vec4 u_clipplane;
@@ -16,11 +16,12 @@ $out float v_ambientocclusion;
 #include "_fog.vert"
 #include "_shadowmap.vert"
 #include "_ambientocclusion.vert"
+#include "_terrain.vert"
 
 void main(void) {
-	uint a_ao = a_info[0];
-	uint a_colorindex = a_info[1];
-	vec4 pos = u_model * vec4(a_pos, 1.0);
+	uint a_ao = terrainAmbientOcclusion(a_data);
+	uint a_colorindex = terrainColorIndex(a_data);
+	vec4 pos = u_model * vec4(terrainPosition(a_data, a_origin), 1.0);
 	v_pos = pos.xyz;
 	v_clipspace = u_viewprojection * pos;
 
@@ -0,0 +1,18 @@
+/**
+ * @brief Shader to fill the bound shadowmap with the depth values of the compact terrain meshes
+ */
+
+// attributes from the VAOs - same order as in world.vert
+$in uint a_data;
+$in vec3 a_origin;
+
+uniform mat4 u_lightviewprojection;
+uniform mat4 u_model;
+
+#include "_terrain.vert"
+
+void main()
+{
+	vec4 worldpos = u_model * vec4(terrainPosition(a_data, a_origin), 1.0f);
+	gl_Position = u_lightviewprojection * worldpos;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/ChunkCuller.h"
+#include "voxelworldrender/worldrenderer/OcclusionBuffer.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace voxelworldrender {
+
+class ChunkCullerTest : public app::AbstractTest {
+protected:
+	const glm::vec3 _eye { 0.0f, 10.0f, 0.0f };
+	glm::mat4 _view { 1.0f };
+	glm::mat4 _projection { 1.0f };
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		// looking along the negative z axis
+		_view = glm::lookAt(_eye, _eye + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		_projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 500.0f);
+	}
+
+	glm::mat4 viewProjection() const {
+		return _projection * _view;
+	}
+
+	CullInput input() const {
+		CullInput in;
+		in.frustum.update(_view, _projection);
+		in.viewProjection = viewProjection();
+		in.eye = _eye;
+		in.frustumMargin = 0.0f;
+		return in;
+	}
+
+	CullChunk chunk(const glm::vec3& mins, const glm::vec3& maxs, float solidHeight = 0.0f) const {
+		CullChunk c;
+		c.mins = mins;
+		c.maxs = maxs;
+		c.solidHeight = solidHeight;
+		return c;
+	}
+};
+
+TEST_F(ChunkCullerTest, testEmptyBuffer) {
+	OcclusionBuffer buffer(64, 32);
+	buffer.clear(viewProjection());
+	buffer.update();
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(-2.0f, 5.0f, -50.0f), glm::vec3(2.0f, 9.0f, -46.0f)));
+}
+
+TEST_F(ChunkCullerTest, testOccludedByWall) {
+	OcclusionBuffer buffer(64, 32);
+	buffer.clear(viewProjection());
+	ASSERT_TRUE(buffer.addOccluder(glm::vec3(-5.0f, 0.0f, -12.0f), glm::vec3(5.0f, 30.0f, -10.0f)));
+	buffer.update();
+	// behind the wall
+	EXPECT_TRUE(buffer.isOccluded(glm::vec3(-2.0f, 5.0f, -50.0f), glm::vec3(2.0f, 9.0f, -46.0f)));
+	// in front of the wall
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(-2.0f, 5.0f, -8.0f), glm::vec3(2.0f, 9.0f, -6.0f)));
+	// behind the wall, but next to it
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(30.0f, 5.0f, -50.0f), glm::vec3(34.0f, 9.0f, -46.0f)));
+	// behind the wall, but bigger than the wall
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(-100.0f, 5.0f, -50.0f), glm::vec3(100.0f, 9.0f, -46.0f)));
+	// crossing the near plane
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(-1.0f, 9.0f, -1.0f), glm::vec3(1.0f, 11.0f, 1.0f)));
+}
+
+TEST_F(ChunkCullerTest, testOccluderConservative) {
+	OcclusionBuffer buffer(64, 32);
+	buffer.clear(viewProjection());
+	// crossing the near plane - can't be rendered
+	EXPECT_FALSE(buffer.addOccluder(glm::vec3(-5.0f, 0.0f, -10.0f), glm::vec3(5.0f, 30.0f, 10.0f)));
+	ASSERT_TRUE(buffer.addOccluder(glm::vec3(-5.0f, 0.0f, -12.0f), glm::vec3(5.0f, 30.0f, -10.0f)));
+	buffer.update();
+	// the wall must not write a depth that is nearer than the wall itself
+	glm::vec4 clip = viewProjection() * glm::vec4(0.0f, 10.0f, -10.0f, 1.0f);
+	const float nearestWallDepth = clip.z / clip.w;
+	for (int y = 0; y < buffer.height(); ++y) {
+		for (int x = 0; x < buffer.width(); ++x) {
+			ASSERT_GE(buffer.depth(x, y), nearestWallDepth) << x << ":" << y;
+		}
+	}
+	// a box that touches the back of the wall is not occluded - some parts of it are nearer than the far
+	// corners of the wall
+	EXPECT_FALSE(buffer.isOccluded(glm::vec3(-2.0f, 5.0f, -12.5f), glm::vec3(2.0f, 9.0f, -11.0f)));
+}
+
+TEST_F(ChunkCullerTest, testDepthPyramid) {
+	OcclusionBuffer buffer(64, 30);
+	buffer.clear(viewProjection());
+	ASSERT_TRUE(buffer.addOccluder(glm::vec3(-5.0f, 0.0f, -12.0f), glm::vec3(5.0f, 30.0f, -10.0f)));
+	ASSERT_TRUE(buffer.addOccluder(glm::vec3(8.0f, 0.0f, -22.0f), glm::vec3(12.0f, 10.0f, -18.0f)));
+	buffer.update();
+	const int top = buffer.levels() - 1;
+	ASSERT_EQ(1, buffer.levelWidth(top));
+	ASSERT_EQ(1, buffer.levelHeight(top));
+	// every texel is the farthest depth of the pixels it covers
+	for (int level = 1; level < buffer.levels(); ++level) {
+		for (int y = 0; y < buffer.levelHeight(level); ++y) {
+			for (int x = 0; x < buffer.levelWidth(level); ++x) {
+				float maxDepth = 0.0f;
+				for (int py = y << level; py < glm::min(buffer.height(), (y + 1) << level); ++py) {
+					for (int px = x << level; px < glm::min(buffer.width(), (x + 1) << level); ++px) {
+						maxDepth = glm::max(maxDepth, buffer.depth(px, py));
+					}
+				}
+				ASSERT_FLOAT_EQ(maxDepth, buffer.depth(level, x, y)) << level << ": " << x << ":" << y;
+			}
+		}
+	}
+}
+
+TEST_F(ChunkCullerTest, testFrustum) {
+	CullInput in = input();
+	in.occlusion = false;
+	// in front of the camera
+	in.chunks.push_back(chunk(glm::vec3(-2.0f, 5.0f, -50.0f), glm::vec3(2.0f, 9.0f, -46.0f)));
+	// behind the camera
+	in.chunks.push_back(chunk(glm::vec3(-2.0f, 5.0f, 10.0f), glm::vec3(2.0f, 9.0f, 14.0f)));
+	// left of the frustum - close enough to be kept with a margin
+	in.chunks.push_back(chunk(glm::vec3(-65.0f, 5.0f, -50.0f), glm::vec3(-60.0f, 9.0f, -46.0f)));
+
+	ChunkCuller culler(128, 64);
+	std::vector<int> visible;
+	culler.cull(in, visible);
+	EXPECT_EQ(std::vector<int>({0}), visible);
+	in.frustumMargin = 10.0f;
+	culler.cull(in, visible);
+	EXPECT_EQ(std::vector<int>({0, 2}), visible);
+}
+
+TEST_F(ChunkCullerTest, testFrustumBatches) {
+	CullInput in = input();
+	in.occlusion = false;
+	// more chunks than fit into one word of the visibility mask - every third one is behind the camera
+	std::vector<int> expected;
+	for (int i = 0; i < 100; ++i) {
+		const float z = i % 3 == 0 ? 10.0f : -50.0f;
+		const float x = (float)(i % 10) * 2.0f - 10.0f;
+		in.chunks.push_back(chunk(glm::vec3(x, 5.0f, z), glm::vec3(x + 1.0f, 9.0f, z + 4.0f)));
+		if (i % 3 != 0) {
+			expected.push_back(i);
+		}
+	}
+	ChunkCuller culler(128, 64);
+	std::vector<int> visible;
+	culler.cull(in, visible);
+	EXPECT_EQ(expected, visible);
+}
+
+TEST_F(ChunkCullerTest, testCull) {
+	CullInput in = input();
+	// a hill right in front of the camera
+	in.chunks.push_back(chunk(glm::vec3(-8.0f, 0.0f, -40.0f), glm::vec3(8.0f, 40.0f, -24.0f), 30.0f));
+	// behind the hill
+	in.chunks.push_back(chunk(glm::vec3(-4.0f, 0.0f, -96.0f), glm::vec3(4.0f, 12.0f, -64.0f)));
+	// behind the camera
+	in.chunks.push_back(chunk(glm::vec3(-16.0f, 0.0f, 8.0f), glm::vec3(16.0f, 20.0f, 32.0f)));
+	// next to the hill
+	in.chunks.push_back(chunk(glm::vec3(60.0f, 0.0f, -96.0f), glm::vec3(76.0f, 12.0f, -64.0f)));
+
+	ChunkCuller culler(128, 64);
+	std::vector<int> visible;
+	culler.cull(in, visible);
+	ASSERT_EQ(2u, visible.size());
+	EXPECT_EQ(0, visible[0]);
+	EXPECT_EQ(3, visible[1]);
+
+	in.occlusion = false;
+	culler.cull(in, visible);
+	ASSERT_EQ(3u, visible.size());
+	EXPECT_EQ(0, visible[0]);
+	EXPECT_EQ(1, visible[1]);
+	EXPECT_EQ(3, visible[2]);
+}
+
+}
@@ -0,0 +1,131 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/ExtractionScheduler.h"
+
+namespace voxelworldrender {
+
+class ExtractionSchedulerTest : public app::AbstractTest {
+};
+
+TEST_F(ExtractionSchedulerTest, testClosestFirst) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 10);
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(64, 0, 0), 0));
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(0, 0, 16), 0));
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(-32, 0, 0), 0));
+	EXPECT_EQ(3, scheduler.size());
+
+	ExtractionRequest request;
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(0, 0, 16), request.pos);
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(-32, 0, 0), request.pos);
+	// a closer request is handed out before the remaining ones
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(0, 0, 0), 0));
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(0, 0, 0), request.pos);
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(64, 0, 0), request.pos);
+	EXPECT_FALSE(scheduler.pop(request));
+	EXPECT_EQ(4, scheduler.inFlight());
+}
+
+TEST_F(ExtractionSchedulerTest, testReplaceLOD) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 10);
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(16, 0, 0), 0));
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(16, 0, 0), 2));
+	EXPECT_EQ(1, scheduler.size());
+	ExtractionRequest request;
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(2, request.lod);
+}
+
+TEST_F(ExtractionSchedulerTest, testCancel) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 10);
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(scheduler.schedule(glm::ivec3(i * 16, 0, 0), 0));
+	}
+	EXPECT_TRUE(scheduler.cancel(glm::ivec3(0, 0, 0)));
+	EXPECT_TRUE(scheduler.cancel(glm::ivec3(32, 0, 0)));
+	EXPECT_FALSE(scheduler.cancel(glm::ivec3(32, 0, 0)));
+	EXPECT_EQ(2, scheduler.size());
+	ExtractionRequest request;
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(16, 0, 0), request.pos);
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(48, 0, 0), request.pos);
+	EXPECT_FALSE(scheduler.pop(request));
+}
+
+TEST_F(ExtractionSchedulerTest, testUpdateFocus) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 10);
+	for (int i = 0; i < 8; ++i) {
+		EXPECT_TRUE(scheduler.schedule(glm::ivec3(i * 16, 0, 0), 0));
+	}
+	// still the same tile
+	EXPECT_FALSE(scheduler.updateFocus(glm::ivec3(8, 0, 8), -1));
+
+	std::vector<glm::ivec3> canceled;
+	EXPECT_TRUE(scheduler.updateFocus(glm::ivec3(112, 0, 0), 48 * 48, &canceled));
+	EXPECT_EQ(5u, canceled.size());
+	EXPECT_EQ(3, scheduler.size());
+	EXPECT_FALSE(scheduler.schedule(glm::ivec3(0, 0, 0), 0)) << "Outside of the max distance";
+
+	ExtractionRequest request;
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(112, 0, 0), request.pos);
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(96, 0, 0), request.pos);
+	ASSERT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(glm::ivec3(80, 0, 0), request.pos);
+	EXPECT_FALSE(scheduler.pop(request));
+}
+
+TEST_F(ExtractionSchedulerTest, testInFlightLimit) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 2);
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(scheduler.schedule(glm::ivec3(i * 16, 0, 0), 0));
+	}
+	ExtractionRequest request;
+	EXPECT_TRUE(scheduler.pop(request));
+	EXPECT_TRUE(scheduler.pop(request));
+	EXPECT_FALSE(scheduler.pop(request));
+	EXPECT_EQ(2, scheduler.inFlight());
+	scheduler.finish();
+	EXPECT_TRUE(scheduler.waitAndPop(request));
+	EXPECT_EQ(glm::ivec3(32, 0, 0), request.pos);
+
+	scheduler.abortWait();
+	EXPECT_FALSE(scheduler.waitAndPop(request));
+	EXPECT_GE(scheduler.latencyMillis(), 0.0);
+}
+
+TEST_F(ExtractionSchedulerTest, testClearKeepsInFlight) {
+	ExtractionScheduler scheduler;
+	scheduler.init(16, 2);
+	for (int i = 0; i < 2; ++i) {
+		EXPECT_TRUE(scheduler.schedule(glm::ivec3(i * 16, 0, 0), 0));
+	}
+	ExtractionRequest request;
+	EXPECT_TRUE(scheduler.pop(request));
+	EXPECT_TRUE(scheduler.pop(request));
+	// the workers are still busy with the handed out requests
+	scheduler.clear();
+	EXPECT_EQ(2, scheduler.inFlight());
+	EXPECT_TRUE(scheduler.schedule(glm::ivec3(0, 0, 0), 0));
+	EXPECT_FALSE(scheduler.pop(request));
+	scheduler.finish();
+	scheduler.finish();
+	EXPECT_EQ(0, scheduler.inFlight());
+	EXPECT_TRUE(scheduler.pop(request));
+	EXPECT_EQ(1, scheduler.inFlight());
+}
+
+}
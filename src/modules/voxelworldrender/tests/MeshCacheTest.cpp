@@ -0,0 +1,147 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/MeshCache.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelworldrender {
+
+class MeshCacheTest : public app::AbstractTest {
+protected:
+	void extract(int height, voxel::CompactMesh& compact) const {
+		voxel::RawVolume volume(voxel::Region(0, 15));
+		for (int x = 0; x < 16; ++x) {
+			for (int z = 0; z < 16; ++z) {
+				for (int y = 0; y < height + (x * 3 + z) % 4; ++y) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + y) % 8));
+				}
+			}
+		}
+		voxel::Region region = volume.region();
+		region.shiftUpperCorner(1, 1, 1);
+		voxel::Mesh mesh(1024, 1024, true);
+		voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+		ASSERT_TRUE(compact.encode(mesh));
+	}
+
+	MeshCacheKey key(int x, uint32_t contentHash = 1u) const {
+		MeshCacheKey k;
+		k.seed = 42u;
+		k.pos = glm::ivec3(x, 0, 0);
+		k.contentHash = contentHash;
+		return k;
+	}
+
+	void checkEqual(const voxel::CompactMesh& expected, const voxel::CompactMesh& actual) const {
+		ASSERT_EQ(expected.vertices().size(), actual.vertices().size());
+		ASSERT_EQ(expected.indices().size(), actual.indices().size());
+		ASSERT_EQ(expected.subMeshes().size(), actual.subMeshes().size());
+		for (size_t i = 0u; i < expected.indices().size(); ++i) {
+			ASSERT_EQ(expected.indices()[i], actual.indices()[i]);
+		}
+		for (size_t i = 0u; i < expected.vertices().size(); ++i) {
+			ASSERT_EQ(expected.vertices()[i].data, actual.vertices()[i].data);
+		}
+		for (size_t i = 0u; i < expected.subMeshes().size(); ++i) {
+			EXPECT_EQ(expected.subMeshes()[i].origin, actual.subMeshes()[i].origin);
+			EXPECT_EQ(expected.subMeshes()[i].baseVertex, actual.subMeshes()[i].baseVertex);
+			EXPECT_EQ(expected.subMeshes()[i].firstIndex, actual.subMeshes()[i].firstIndex);
+			EXPECT_EQ(expected.subMeshes()[i].indexCount, actual.subMeshes()[i].indexCount);
+		}
+		EXPECT_EQ(expected.hasFaceIndexRanges(), actual.hasFaceIndexRanges());
+		for (int face = 0; face < voxel::FaceCount; ++face) {
+			EXPECT_EQ(expected.faceIndexRange((voxel::FaceNames)face).count, actual.faceIndexRange((voxel::FaceNames)face).count);
+		}
+		EXPECT_EQ(expected.getOffset(), actual.getOffset());
+	}
+};
+
+TEST_F(MeshCacheTest, testPutGet) {
+	MeshCache cache;
+	ASSERT_TRUE(cache.init("", 1024u * 1024u));
+	voxel::CompactMesh mesh;
+	extract(4, mesh);
+	cache.put(key(0), mesh, 3);
+	EXPECT_EQ(1, cache.entries());
+	EXPECT_GE(cache.size(), mesh.size());
+
+	voxel::CompactMesh cached;
+	int solidHeight = 0;
+	ASSERT_TRUE(cache.get(key(0), cached, solidHeight));
+	EXPECT_EQ(3, solidHeight);
+	checkEqual(mesh, cached);
+
+	// the voxels have changed
+	EXPECT_FALSE(cache.get(key(0, 2u), cached, solidHeight));
+	EXPECT_FALSE(cache.get(key(16), cached, solidHeight));
+}
+
+TEST_F(MeshCacheTest, testEmptyMesh) {
+	MeshCache cache;
+	ASSERT_TRUE(cache.init("", 1024u));
+	const voxel::CompactMesh empty;
+	cache.put(key(0), empty, 0);
+	voxel::CompactMesh cached;
+	int solidHeight = -1;
+	ASSERT_TRUE(cache.get(key(0), cached, solidHeight));
+	EXPECT_TRUE(cached.isEmpty());
+	EXPECT_EQ(0, solidHeight);
+}
+
+TEST_F(MeshCacheTest, testEviction) {
+	voxel::CompactMesh mesh;
+	extract(4, mesh);
+	MeshCache measure;
+	ASSERT_TRUE(measure.init("", 1024u * 1024u));
+	measure.put(key(0), mesh, 0);
+	const size_t entrySize = measure.size();
+
+	// room for two meshes
+	MeshCache cache;
+	ASSERT_TRUE(cache.init("", entrySize * 2u));
+	cache.put(key(0), mesh, 0);
+	cache.put(key(1), mesh, 0);
+	voxel::CompactMesh cached;
+	int solidHeight;
+	// the first mesh is now the most recently used one
+	ASSERT_TRUE(cache.get(key(0), cached, solidHeight));
+	cache.put(key(2), mesh, 0);
+	EXPECT_EQ(2, cache.entries());
+	EXPECT_TRUE(cache.get(key(0), cached, solidHeight));
+	EXPECT_FALSE(cache.get(key(1), cached, solidHeight));
+	EXPECT_TRUE(cache.get(key(2), cached, solidHeight));
+}
+
+TEST_F(MeshCacheTest, testSaveLoad) {
+	voxel::CompactMesh mesh1;
+	extract(4, mesh1);
+	voxel::CompactMesh mesh2;
+	extract(9, mesh2);
+	MeshCache cache;
+	ASSERT_TRUE(cache.init("", 1024u * 1024u));
+	cache.put(key(0), mesh1, 1);
+	cache.put(key(1), mesh2, 2);
+	std::vector<uint8_t> buf;
+	ASSERT_TRUE(cache.save(buf));
+
+	MeshCache loaded;
+	ASSERT_TRUE(loaded.init("", 1024u * 1024u));
+	ASSERT_TRUE(loaded.load(buf.data(), buf.size()));
+	EXPECT_EQ(2, loaded.entries());
+	EXPECT_EQ(cache.size(), loaded.size());
+	voxel::CompactMesh cached;
+	int solidHeight = 0;
+	ASSERT_TRUE(loaded.get(key(1), cached, solidHeight));
+	EXPECT_EQ(2, solidHeight);
+	checkEqual(mesh2, cached);
+
+	// broken data is rejected
+	EXPECT_FALSE(loaded.load(buf.data(), buf.size() / 2));
+	EXPECT_FALSE(loaded.load(buf.data() + 4, buf.size() - 4));
+}
+
+}
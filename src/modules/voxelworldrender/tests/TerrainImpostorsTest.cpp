@@ -0,0 +1,204 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/TerrainImpostors.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+#include <glm/geometric.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace voxelworldrender {
+
+class TerrainImpostorsTest : public app::AbstractTest {
+protected:
+	static int flat(int x, int z, voxel::Voxel& surface) {
+		surface = voxel::createVoxel(voxel::VoxelType::Grass, 1);
+		return 20;
+	}
+
+	/**
+	 * @brief Two plateaus - the one with the higher x values is 10 voxels higher
+	 */
+	static int step(int x, int z, voxel::Voxel& surface) {
+		surface = voxel::createVoxel(voxel::VoxelType::Grass, x < 64 ? 1 : 2);
+		return x < 64 ? 20 : 30;
+	}
+
+	/**
+	 * @brief Polls the finished impostor meshes - they are generated on the impostor thread
+	 */
+	static bool waitForImpostor(TerrainImpostors& impostors, ImpostorMesh& impostor) {
+		for (int i = 0; i < 1000; ++i) {
+			if (impostors.pop(impostor)) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return false;
+	}
+
+	static glm::vec3 normal(const voxel::Mesh& mesh, size_t triangle) {
+		const glm::vec3 v0(mesh.getVertex(mesh.getIndex(triangle * 3 + 0)).position);
+		const glm::vec3 v1(mesh.getVertex(mesh.getIndex(triangle * 3 + 1)).position);
+		const glm::vec3 v2(mesh.getVertex(mesh.getIndex(triangle * 3 + 2)).position);
+		return glm::cross(v1 - v0, v2 - v0);
+	}
+
+	/**
+	 * @return The sign of the normal y component of the top faces of the surface extractor
+	 */
+	float topFaceOrientation() const {
+		voxel::RawVolume volume(voxel::Region(0, 2));
+		volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Grass, 1));
+		voxel::Mesh mesh;
+		voxel::extractCubicMesh(&volume, volume.region(), &mesh, voxel::IsQuadNeeded(), volume.region().getLowerCorner());
+		for (size_t i = 0; i < mesh.getNoOfIndices() / 3; ++i) {
+			const glm::vec3& n = normal(mesh, i);
+			if (glm::abs(n.y) > 0.0f && mesh.getVertex(mesh.getIndex(i * 3)).position.y == 2) {
+				return glm::sign(n.y);
+			}
+		}
+		return 0.0f;
+	}
+};
+
+TEST_F(TerrainImpostorsTest, testHeightmap) {
+	ImpostorHeightmap heightmap;
+	generateImpostorHeightmap(step, glm::ivec2(0, 0), 128, 8, heightmap);
+	EXPECT_EQ(16, heightmap.cells);
+	ASSERT_EQ(18u * 18u, heightmap.heights.size());
+	EXPECT_EQ(20, heightmap.height(-1, -1));
+	EXPECT_EQ(20, heightmap.height(7, 0));
+	EXPECT_EQ(30, heightmap.height(8, 0));
+	EXPECT_EQ(30, heightmap.height(16, 16));
+	EXPECT_EQ(1, heightmap.color(0, 0));
+	EXPECT_EQ(2, heightmap.color(15, 15));
+}
+
+TEST_F(TerrainImpostorsTest, testFlatMesh) {
+	ImpostorHeightmap heightmap;
+	generateImpostorHeightmap(flat, glm::ivec2(-128, 256), 128, 8, heightmap);
+	ImpostorMesh impostor;
+	buildImpostorMesh(heightmap, 32, impostor);
+	EXPECT_EQ(4, impostor.tiles);
+	EXPECT_EQ(20, impostor.maxHeight);
+	// only the top faces
+	EXPECT_EQ(16u * 16u * 4u, impostor.mesh.getNoOfVertices());
+	EXPECT_EQ(16u * 16u * 6u, impostor.mesh.getNoOfIndices());
+	const float orientation = topFaceOrientation();
+	ASSERT_NE(0.0f, orientation);
+	for (size_t i = 0; i < impostor.mesh.getNoOfIndices() / 3; ++i) {
+		EXPECT_EQ(orientation, glm::sign(normal(impostor.mesh, i).y));
+	}
+	for (size_t i = 0; i < impostor.mesh.getNoOfVertices(); ++i) {
+		const glm::ivec3 pos(impostor.mesh.getVertex(i).position);
+		EXPECT_GE(pos.x, -128);
+		EXPECT_LE(pos.x, 0);
+		EXPECT_GE(pos.z, 256);
+		EXPECT_LE(pos.z, 384);
+	}
+}
+
+TEST_F(TerrainImpostorsTest, testTileRanges) {
+	ImpostorHeightmap heightmap;
+	generateImpostorHeightmap(step, glm::ivec2(0, 0), 128, 8, heightmap);
+	ImpostorMesh impostor;
+	buildImpostorMesh(heightmap, 32, impostor);
+	ASSERT_EQ(16u, impostor.tileRanges.size());
+	uint32_t offset = 0u;
+	for (const voxel::IndexRange& range : impostor.tileRanges) {
+		EXPECT_EQ(offset, range.offset);
+		EXPECT_GT(range.count, 0u);
+		offset += range.count;
+	}
+	EXPECT_EQ(impostor.mesh.getNoOfIndices(), offset);
+
+	// the step is between the second and the third tile column - the side belongs to the higher cells
+	const voxel::IndexRange& lower = impostor.tileRanges[1];
+	const voxel::IndexRange& higher = impostor.tileRanges[2];
+	EXPECT_EQ(16u * 6u, lower.count);
+	EXPECT_EQ(16u * 6u + 4u * 6u, higher.count);
+	for (uint32_t i = higher.offset / 3; i < (higher.offset + higher.count) / 3; ++i) {
+		const glm::vec3& n = normal(impostor.mesh, i);
+		if (n.y == 0.0f) {
+			EXPECT_LT(n.x * topFaceOrientation(), 0.0f) << "The side must face the lower plateau";
+		}
+	}
+}
+
+TEST_F(TerrainImpostorsTest, testCompact) {
+	ImpostorHeightmap heightmap;
+	generateImpostorHeightmap([] (int x, int z, voxel::Voxel& surface) {
+		surface = voxel::createVoxel(voxel::VoxelType::Rock, 1);
+		return x < 64 ? 10 : 200;
+	}, glm::ivec2(0, 0), 128, 8, heightmap);
+	ImpostorMesh impostor;
+	buildImpostorMesh(heightmap, 32, impostor);
+	// the cliff is split into parts that fit into a compact sub mesh
+	voxel::CompactMesh compact;
+	ASSERT_TRUE(compact.encode(impostor.mesh));
+	EXPECT_EQ(impostor.mesh.getNoOfIndices(), compact.indices().size());
+}
+
+TEST_F(TerrainImpostorsTest, testCache) {
+	int samples = 0;
+	TerrainImpostors impostors;
+	ASSERT_TRUE(impostors.init([&samples] (int x, int z, voxel::Voxel& surface) {
+		++samples;
+		return flat(x, z, surface);
+	}, 32, 128, 8));
+	EXPECT_EQ(glm::ivec2(-128, 128), impostors.regionPos(-1, 200));
+
+	ImpostorMesh impostor;
+	impostors.generate(glm::ivec2(0), impostor);
+	EXPECT_EQ(18 * 18, samples);
+	EXPECT_EQ(1, impostors.cached());
+	impostors.generate(glm::ivec2(0), impostor);
+	EXPECT_EQ(18 * 18, samples) << "The heightmap should come from the cache";
+
+	ASSERT_TRUE(impostors.schedule(glm::ivec2(128, 0)));
+	EXPECT_FALSE(impostors.schedule(glm::ivec2(128, 0)));
+	ASSERT_TRUE(waitForImpostor(impostors, impostor));
+	EXPECT_EQ(glm::ivec2(128, 0), impostor.mins);
+	EXPECT_EQ(0, impostors.pending());
+	EXPECT_EQ(2, impostors.cached());
+
+	impostors.prune(glm::ivec2(0), 100);
+	EXPECT_EQ(1, impostors.cached());
+	impostors.shutdown();
+}
+
+TEST_F(TerrainImpostorsTest, testClearDropsScheduled) {
+	std::atomic_bool started(false);
+	std::atomic_bool release(false);
+	TerrainImpostors impostors;
+	ASSERT_TRUE(impostors.init([&] (int x, int z, voxel::Voxel& surface) {
+		started = true;
+		while (x < 128 && !release) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return flat(x, z, surface);
+	}, 32, 128, 8));
+
+	ASSERT_TRUE(impostors.schedule(glm::ivec2(0)));
+	while (!started) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	impostors.clear();
+	release = true;
+	// there is only one impostor thread - the dropped region is done before this one is delivered
+	ASSERT_TRUE(impostors.schedule(glm::ivec2(256, 0)));
+	ImpostorMesh impostor;
+	ASSERT_TRUE(waitForImpostor(impostors, impostor));
+	EXPECT_EQ(glm::ivec2(256, 0), impostor.mins);
+	EXPECT_FALSE(impostors.pop(impostor));
+	EXPECT_EQ(1, impostors.cached());
+	impostors.shutdown();
+}
+
+}
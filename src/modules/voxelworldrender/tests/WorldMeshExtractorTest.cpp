@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/WorldMeshExtractor.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+#include "voxel/PagedVolume.h"
+
+namespace voxelworldrender {
+
+class WorldMeshExtractorTest : public app::AbstractTest {
+protected:
+	class EmptyPager : public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+		core::Var::get(cfg::ClientMeshCacheSize, "0")->setVal(0);
+	}
+
+	void fill(voxel::PagedVolume& volume, const voxel::Voxel& voxel) const {
+		for (int x = 2; x < 6; ++x) {
+			for (int y = 0; y < 4; ++y) {
+				for (int z = 2; z < 6; ++z) {
+					volume.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+
+	bool extract(WorldMeshExtractor& extractor, int lod, ExtractedMesh& extracted) const {
+		if (!extractor.scheduleMeshExtraction(glm::ivec3(0), lod)) {
+			return false;
+		}
+		extractor.extractScheduledMesh();
+		return extractor.pop(extracted);
+	}
+};
+
+TEST_F(WorldMeshExtractorTest, testReExtractEmpty) {
+	EmptyPager pager;
+	voxel::PagedVolume volume(&pager);
+	fill(volume, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	WorldMeshExtractor extractor;
+	ASSERT_TRUE(extractor.init(&volume));
+
+	ExtractedMesh extracted;
+	ASSERT_TRUE(extract(extractor, 0, extracted));
+	EXPECT_FALSE(extracted.mesh.isEmpty());
+	EXPECT_EQ(0, extracted.lod);
+
+	// the empty mesh of the new level of detail must replace the old mesh
+	fill(volume, voxel::Voxel());
+	ASSERT_TRUE(extract(extractor, 1, extracted));
+	EXPECT_TRUE(extracted.mesh.isEmpty());
+	EXPECT_EQ(1, extracted.lod);
+	EXPECT_EQ(glm::ivec3(0), extracted.mesh.getOffset());
+	EXPECT_EQ(1, extractor.lod(glm::ivec3(0)));
+	extractor.shutdown();
+}
+
+}
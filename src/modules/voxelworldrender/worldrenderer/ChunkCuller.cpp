@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#include "ChunkCuller.h"
+#include "core/Trace.h"
+#include <glm/geometric.hpp>
+#include <algorithm>
+
+namespace voxelworldrender {
+
+ChunkCuller::ChunkCuller(int width, int height) :
+		_occlusionBuffer(width, height) {
+}
+
+void ChunkCuller::cull(const CullInput& input, std::vector<int>& visible) {
+	core_trace_scoped(ChunkCuller);
+	visible.clear();
+	_candidates.clear();
+	{
+		core_trace_scoped(ChunkCullerFrustum);
+		const int n = (int)input.chunks.size();
+		for (int b = 0; b < 6; ++b) {
+			_bounds[b].resize(n);
+		}
+		for (int i = 0; i < n; ++i) {
+			const CullChunk& chunk = input.chunks[i];
+			for (int axis = 0; axis < 3; ++axis) {
+				_bounds[axis][i] = chunk.mins[axis];
+				_bounds[axis + 3][i] = chunk.maxs[axis];
+			}
+		}
+		_visibleMask.resize((n + 31) / 32);
+		input.frustum.isVisible(_bounds[0].data(), _bounds[1].data(), _bounds[2].data(), _bounds[3].data(),
+				_bounds[4].data(), _bounds[5].data(), n, _visibleMask.data(), input.frustumMargin);
+		for (int i = 0; i < n; ++i) {
+			if (_visibleMask[i >> 5] & (1u << (i & 31))) {
+				_candidates.push_back(i);
+			}
+		}
+	}
+	if (!input.occlusion || _candidates.empty()) {
+		visible.swap(_candidates);
+		return;
+	}
+
+	core_trace_scoped(ChunkCullerOcclusion);
+	// front to back - the nearest chunks are the best occluders
+	_distances.resize(input.chunks.size());
+	for (int idx : _candidates) {
+		const CullChunk& chunk = input.chunks[idx];
+		const glm::vec3 center = (chunk.mins + chunk.maxs) * 0.5f;
+		const glm::vec3 d = center - input.eye;
+		_distances[idx] = glm::dot(d, d);
+	}
+	std::sort(_candidates.begin(), _candidates.end(), [this] (int a, int b) {
+		return _distances[a] < _distances[b];
+	});
+
+	_occlusionBuffer.clear(input.viewProjection);
+	int occluders = 0;
+	for (int idx : _candidates) {
+		if (occluders >= input.maxOccluders) {
+			break;
+		}
+		const CullChunk& chunk = input.chunks[idx];
+		if (chunk.solidHeight <= 0.0f) {
+			continue;
+		}
+		const glm::vec3 maxs(chunk.maxs.x, chunk.mins.y + chunk.solidHeight, chunk.maxs.z);
+		if (_occlusionBuffer.addOccluder(chunk.mins, maxs)) {
+			++occluders;
+		}
+	}
+	_occlusionBuffer.update();
+
+	for (int idx : _candidates) {
+		const CullChunk& chunk = input.chunks[idx];
+		if (!_occlusionBuffer.isOccluded(chunk.mins, chunk.maxs)) {
+			visible.push_back(idx);
+		}
+	}
+}
+
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "OcclusionBuffer.h"
+#include "math/Frustum.h"
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace voxelworldrender {
+
+/**
+ * @brief The data of a terrain chunk that is needed to cull it
+ */
+struct CullChunk {
+	glm::vec3 mins;
+	glm::vec3 maxs;
+	/**
+	 * The height above @c mins.y up to which the chunk is completely solid. @c 0 if the chunk can't be used as
+	 * occluder.
+	 */
+	float solidHeight = 0.0f;
+	/** the slot of the chunk in the chunk manager */
+	int slot = -1;
+	/** detects slots that were reused while the culling was running */
+	uint32_t generation = 0u;
+};
+
+/**
+ * @brief A snapshot of everything that is needed to cull the chunks - this allows to run the culling in the
+ * background while the chunk manager is modified
+ */
+struct CullInput {
+	math::Frustum frustum;
+	glm::mat4 viewProjection { 1.0f };
+	glm::vec3 eye { 0.0f };
+	/**
+	 * Chunks are kept even if they are a bit outside of the frustum - they might cast shadows into the
+	 * visible area.
+	 */
+	float frustumMargin = 10.0f;
+	bool occlusion = true;
+	/** the amount of nearest chunks that are rendered as occluders */
+	int maxOccluders = 64;
+	std::vector<CullChunk> chunks;
+};
+
+/**
+ * @brief Frustum and occlusion culling for the terrain chunks
+ *
+ * The chunk boxes are tested in batches against the frustum planes. If occlusion culling is enabled, the solid parts
+ * of the nearest chunks are rendered into an @c OcclusionBuffer, and every remaining chunk is tested
+ * against it.
+ */
+class ChunkCuller {
+private:
+	OcclusionBuffer _occlusionBuffer;
+	std::vector<int> _candidates;
+	std::vector<float> _distances;
+	/** the chunk boxes as structure of arrays for the batched frustum test: mins x, y, z and maxs x, y, z */
+	std::vector<float> _bounds[6];
+	std::vector<uint32_t> _visibleMask;
+public:
+	ChunkCuller(int width = 256, int height = 128);
+
+	/**
+	 * @param[out] visible The indices of the visible chunks in @c CullInput::chunks
+	 */
+	void cull(const CullInput& input, std::vector<int>& visible);
+
+	const OcclusionBuffer& occlusionBuffer() const;
+};
+
+inline const OcclusionBuffer& ChunkCuller::occlusionBuffer() const {
+	return _occlusionBuffer;
+}
+
+}
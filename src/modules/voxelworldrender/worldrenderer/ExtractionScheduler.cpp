@@ -0,0 +1,234 @@
+/**
+ * @file
+ */
+
+#include "ExtractionScheduler.h"
+#include "core/TimeProvider.h"
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+
+namespace voxelworldrender {
+
+namespace {
+/** smoothing factor of the latency average */
+constexpr double LatencyAlpha = 0.05;
+}
+
+void ExtractionScheduler::init(int tileSize, int maxInFlight) {
+	core::ScopedLock lock(_lock);
+	_tileSize = glm::max(1, tileSize);
+	_maxInFlight = glm::max(1, maxInFlight);
+	_abort = false;
+}
+
+int ExtractionScheduler::distance2(const glm::ivec3& pos) const {
+	// we are only taking the x and z axis into account here
+	const int dx = pos.x - _focus.x;
+	const int dz = pos.z - _focus.z;
+	return dx * dx + dz * dz;
+}
+
+int ExtractionScheduler::ring(const glm::ivec3& pos) const {
+	return (int)glm::sqrt((float)distance2(pos)) / _tileSize;
+}
+
+void ExtractionScheduler::link(int node) {
+	Node& n = _nodes[node];
+	if (n.ring >= (int)_rings.size()) {
+		_rings.resize(n.ring + 1);
+	}
+	Ring& r = _rings[n.ring];
+	n.prev = r.tail;
+	n.next = -1;
+	if (r.tail != -1) {
+		_nodes[r.tail].next = node;
+	} else {
+		r.head = node;
+	}
+	r.tail = node;
+	_firstRing = glm::min(_firstRing, n.ring);
+}
+
+void ExtractionScheduler::unlink(int node) {
+	Node& n = _nodes[node];
+	Ring& r = _rings[n.ring];
+	if (n.prev != -1) {
+		_nodes[n.prev].next = n.next;
+	} else {
+		r.head = n.next;
+	}
+	if (n.next != -1) {
+		_nodes[n.next].prev = n.prev;
+	} else {
+		r.tail = n.prev;
+	}
+	n.prev = n.next = -1;
+}
+
+void ExtractionScheduler::release(int node) {
+	Node& n = _nodes[node];
+	_index.erase(n.request.pos);
+	n.ring = -1;
+	_freeNodes.push_back(node);
+}
+
+bool ExtractionScheduler::schedule(const glm::ivec3& pos, int lod) {
+	core::ScopedLock lock(_lock);
+	if (_maxDistance >= 0 && distance2(pos) >= _maxDistance) {
+		return false;
+	}
+	auto i = _index.find(pos);
+	if (i != _index.end()) {
+		_nodes[i->second].request.lod = lod;
+		return true;
+	}
+	int node;
+	if (_freeNodes.empty()) {
+		node = (int)_nodes.size();
+		_nodes.emplace_back();
+	} else {
+		node = _freeNodes.back();
+		_freeNodes.pop_back();
+	}
+	Node& n = _nodes[node];
+	n.request.pos = pos;
+	n.request.lod = lod;
+	n.request.scheduledMillis = core::TimeProvider::systemMillis();
+	n.ring = ring(pos);
+	link(node);
+	_index.emplace(pos, node);
+	_condition.notify_one();
+	return true;
+}
+
+bool ExtractionScheduler::cancel(const glm::ivec3& pos) {
+	core::ScopedLock lock(_lock);
+	auto i = _index.find(pos);
+	if (i == _index.end()) {
+		return false;
+	}
+	const int node = i->second;
+	unlink(node);
+	release(node);
+	return true;
+}
+
+bool ExtractionScheduler::updateFocus(const glm::ivec3& focus, int maxDistance2, std::vector<glm::ivec3>* canceled) {
+	core::ScopedLock lock(_lock);
+	core_trace_value_scoped(ExtractionSchedulerUpdateFocus, _index.size());
+	const glm::ivec3 focusTile = glm::ivec3(glm::floor(glm::vec3(focus) / (float)_tileSize)) * _tileSize;
+	const glm::ivec3 currentTile = glm::ivec3(glm::floor(glm::vec3(_focus) / (float)_tileSize)) * _tileSize;
+	if (focusTile.x == currentTile.x && focusTile.z == currentTile.z && maxDistance2 == _maxDistance) {
+		return false;
+	}
+	_focus = focus;
+	_maxDistance = maxDistance2;
+	for (Ring& r : _rings) {
+		r.head = r.tail = -1;
+	}
+	_firstRing = (int)_rings.size();
+	for (int node = 0; node < (int)_nodes.size(); ++node) {
+		Node& n = _nodes[node];
+		if (n.ring == -1) {
+			continue;
+		}
+		if (_maxDistance >= 0 && distance2(n.request.pos) >= _maxDistance) {
+			if (canceled != nullptr) {
+				canceled->push_back(n.request.pos);
+			}
+			release(node);
+			continue;
+		}
+		n.ring = ring(n.request.pos);
+		link(node);
+	}
+	return true;
+}
+
+bool ExtractionScheduler::popUnlocked(ExtractionRequest& request) {
+	if (_index.empty() || _inFlight >= _maxInFlight) {
+		return false;
+	}
+	for (; _firstRing < (int)_rings.size(); ++_firstRing) {
+		const int node = _rings[_firstRing].head;
+		if (node == -1) {
+			continue;
+		}
+		request = _nodes[node].request;
+		unlink(node);
+		release(node);
+		++_inFlight;
+		const uint64_t now = core::TimeProvider::systemMillis();
+		const double latency = (double)(now - request.scheduledMillis);
+		_latencyMillis += (latency - _latencyMillis) * LatencyAlpha;
+		return true;
+	}
+	return false;
+}
+
+bool ExtractionScheduler::pop(ExtractionRequest& request) {
+	core::ScopedLock lock(_lock);
+	return popUnlocked(request);
+}
+
+bool ExtractionScheduler::waitAndPop(ExtractionRequest& request) {
+	core::ScopedLock lock(_lock);
+	while (!_abort && (_index.empty() || _inFlight >= _maxInFlight)) {
+		if (!_condition.wait(_lock)) {
+			return false;
+		}
+	}
+	if (_abort) {
+		return false;
+	}
+	return popUnlocked(request);
+}
+
+void ExtractionScheduler::finish() {
+	core::ScopedLock lock(_lock);
+	if (_inFlight > 0) {
+		--_inFlight;
+	}
+	_condition.notify_one();
+}
+
+void ExtractionScheduler::abortWait() {
+	core::ScopedLock lock(_lock);
+	_abort = true;
+	_condition.notify_all();
+}
+
+void ExtractionScheduler::clear() {
+	core::ScopedLock lock(_lock);
+	_nodes.clear();
+	_freeNodes.clear();
+	_rings.clear();
+	_index.clear();
+	_firstRing = 0;
+	// the handed out requests are still extracted - their finish() calls release the slots
+	_condition.notify_all();
+}
+
+void ExtractionScheduler::trace() const {
+	core::ScopedLock lock(_lock);
+	core_trace_plot("MeshExtractionQueueDepth", (int64_t)_index.size());
+	core_trace_plot("MeshExtractionInFlight", (int64_t)_inFlight);
+	core_trace_plot("MeshExtractionLatency", _latencyMillis);
+}
+
+int ExtractionScheduler::size() const {
+	core::ScopedLock lock(_lock);
+	return (int)_index.size();
+}
+
+int ExtractionScheduler::inFlight() const {
+	core::ScopedLock lock(_lock);
+	return _inFlight;
+}
+
+double ExtractionScheduler::latencyMillis() const {
+	core::ScopedLock lock(_lock);
+	return _latencyMillis;
+}
+
+}
@@ -0,0 +1,137 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace voxelworldrender {
+
+/**
+ * @brief A mesh tile that should get extracted with the given level of detail
+ */
+struct ExtractionRequest {
+	glm::ivec3 pos { 0 };
+	int lod = 0;
+	/** the time in millis the request was scheduled at */
+	uint64_t scheduledMillis = 0u;
+};
+
+/**
+ * @brief Hands out the scheduled mesh extractions closest to the focus position first
+ *
+ * The requests are bucketed in rings around the focus position - the ring width is one mesh tile. Moving the
+ * focus only needs one pass over the pending requests if another mesh tile is entered. Requests that are
+ * outside of the max distance are canceled during that pass. Cancelling a single request is O(1).
+ *
+ * The amount of requests that were handed out and not yet finished is bounded to not let the workers extract
+ * more meshes than the main thread is able to upload.
+ *
+ * @note All methods are thread safe
+ */
+class ExtractionScheduler {
+private:
+	struct Node {
+		ExtractionRequest request;
+		int ring = -1;
+		int prev = -1;
+		int next = -1;
+	};
+	struct Ring {
+		int head = -1;
+		int tail = -1;
+	};
+
+	std::vector<Node> _nodes;
+	std::vector<int> _freeNodes;
+	std::vector<Ring> _rings;
+	std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > _index;
+	glm::ivec3 _focus { 0 };
+	int _tileSize = 1;
+	/** squared distance on the x and z axis - @c -1 means unlimited */
+	int _maxDistance = -1;
+	/** there are no requests in rings below this one */
+	int _firstRing = 0;
+	int _inFlight = 0;
+	int _maxInFlight = 1;
+	bool _abort = false;
+	/** exponential moving average of the time between scheduling a request and handing it out */
+	double _latencyMillis = 0.0;
+	mutable core_trace_mutex(core::Lock, _lock, "ExtractionScheduler");
+	core::ConditionVariable _condition;
+
+	int distance2(const glm::ivec3& pos) const;
+	int ring(const glm::ivec3& pos) const;
+	void link(int node);
+	void unlink(int node);
+	void release(int node);
+	bool popUnlocked(ExtractionRequest& request);
+
+public:
+	/**
+	 * @param tileSize The width of a distance ring - the size of the mesh tiles
+	 * @param maxInFlight The max amount of requests that were handed out but not yet finished
+	 */
+	void init(int tileSize, int maxInFlight);
+
+	/**
+	 * @brief Schedules a request or replaces the level of detail of the pending request for this position
+	 * @return @c false if the position is outside of the max distance
+	 */
+	bool schedule(const glm::ivec3& pos, int lod);
+	/**
+	 * @return @c true if there was a pending request for the given position
+	 */
+	bool cancel(const glm::ivec3& pos);
+
+	/**
+	 * @brief Re-buckets the pending requests if the focus entered another mesh tile and cancels all requests
+	 * that are further away than the given distance
+	 * @param[in] maxDistance2 The squared max distance on the x and z axis, @c -1 for unlimited
+	 * @param[out] canceled The positions of the canceled requests are appended here if not @c nullptr
+	 * @return @c true if the requests were re-bucketed
+	 */
+	bool updateFocus(const glm::ivec3& focus, int maxDistance2, std::vector<glm::ivec3>* canceled = nullptr);
+
+	/**
+	 * @brief Hands out the closest request if the in-flight limit allows it
+	 * @note Each handed out request must be finished by calling @c finish()
+	 */
+	bool pop(ExtractionRequest& request);
+	/**
+	 * @brief Blocks until there is a request that can be handed out or @c abortWait() was called
+	 * @note The abort is sticky until the next @c init() call
+	 */
+	bool waitAndPop(ExtractionRequest& request);
+	/**
+	 * @brief The work for a handed out request is done - this frees an in-flight slot
+	 */
+	void finish();
+
+	void abortWait();
+	/**
+	 * @brief Drops all pending requests
+	 * @note The requests that were already handed out still have to be finished
+	 */
+	void clear();
+
+	/**
+	 * @brief Plots the queue depth, the in-flight requests and the latency
+	 */
+	void trace() const;
+
+	int size() const;
+	int inFlight() const;
+	double latencyMillis() const;
+};
+
+}
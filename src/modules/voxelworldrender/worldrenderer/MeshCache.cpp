@@ -0,0 +1,204 @@
+/**
+ * @file
+ */
+
+#include "MeshCache.h"
+#include "core/Common.h"
+#include "core/FourCC.h"
+#include "core/Hash.h"
+#include "core/Log.h"
+#include "app/App.h"
+#include "io/Filesystem.h"
+
+namespace voxelworldrender {
+
+namespace {
+
+constexpr uint32_t MeshCacheMagic = FourCC('M', 'C', 'A', 'C');
+constexpr uint32_t MeshCacheVersion = 2u;
+
+inline size_t meshBytes(const voxel::CompactMesh& mesh) {
+	return mesh.size() + mesh.subMeshes().bytes();
+}
+
+template<class T>
+inline void write(std::vector<uint8_t>& out, const T& value) {
+	const uint8_t* p = (const uint8_t*)&value;
+	out.insert(out.end(), p, p + sizeof(T));
+}
+
+template<class T>
+inline bool read(const uint8_t*& buf, const uint8_t* end, T& value) {
+	if ((size_t)(end - buf) < sizeof(T)) {
+		return false;
+	}
+	core_memcpy(&value, buf, sizeof(T));
+	buf += sizeof(T);
+	return true;
+}
+
+}
+
+size_t MeshCacheKeyHash::operator()(const MeshCacheKey& key) const {
+	return (size_t)core::hash(&key, (int)sizeof(key));
+}
+
+bool MeshCache::init(const core::String& filename, size_t maxSize) {
+	clear();
+	_filename = filename;
+	_maxSize = maxSize;
+	if (!enabled() || _filename.empty()) {
+		return true;
+	}
+	const io::FilePtr& f = io::filesystem()->open(_filename);
+	if (!f->exists()) {
+		return true;
+	}
+	uint8_t *fileBuf = nullptr;
+	const int fileLen = f->read((void **) &fileBuf);
+	if (fileLen > 0 && !load(fileBuf, fileLen)) {
+		Log::warn("Failed to load the mesh cache %s", _filename.c_str());
+		clear();
+	}
+	delete[] fileBuf;
+	Log::debug("Loaded %i meshes (%i bytes) from %s", entries(), (int)size(), _filename.c_str());
+	return true;
+}
+
+void MeshCache::shutdown() {
+	if (enabled() && !_filename.empty()) {
+		std::vector<uint8_t> buf;
+		if (save(buf) && !io::filesystem()->write(_filename, buf.data(), buf.size())) {
+			Log::warn("Failed to write the mesh cache %s", _filename.c_str());
+		}
+	}
+	clear();
+	_maxSize = 0u;
+}
+
+bool MeshCache::load(const uint8_t* buf, size_t size) {
+	core_trace_scoped(MeshCacheLoad);
+	const uint8_t* end = buf + size;
+	uint32_t magic = 0u;
+	uint32_t version = 0u;
+	uint32_t count = 0u;
+	if (!read(buf, end, magic) || magic != MeshCacheMagic) {
+		return false;
+	}
+	if (!read(buf, end, version) || version != MeshCacheVersion) {
+		Log::debug("Outdated mesh cache version %u", version);
+		return false;
+	}
+	if (!read(buf, end, count)) {
+		return false;
+	}
+	core::ScopedLock lock(_lock);
+	// the entries are stored from the most to the least recently used
+	for (uint32_t i = 0u; i < count; ++i) {
+		Entry entry;
+		if (!read(buf, end, entry.key) || !read(buf, end, entry.solidHeight) || !entry.mesh.read(buf, end)) {
+			return false;
+		}
+		if (_index.find(entry.key) != _index.end()) {
+			continue;
+		}
+		entry.bytes = meshBytes(entry.mesh);
+		_size += entry.bytes;
+		_entries.push_back(std::move(entry));
+		_index.emplace(_entries.back().key, std::prev(_entries.end()));
+	}
+	evict();
+	return true;
+}
+
+bool MeshCache::save(std::vector<uint8_t>& out) const {
+	core_trace_scoped(MeshCacheSave);
+	core::ScopedLock lock(_lock);
+	out.clear();
+	out.reserve(_size + _entries.size() * sizeof(Entry) + 3 * sizeof(uint32_t));
+	write(out, MeshCacheMagic);
+	write(out, MeshCacheVersion);
+	write(out, (uint32_t)_entries.size());
+	for (const Entry& entry : _entries) {
+		write(out, entry.key);
+		write(out, entry.solidHeight);
+		entry.mesh.write(out);
+	}
+	return true;
+}
+
+void MeshCache::evict() {
+	while (_size > _maxSize && !_entries.empty()) {
+		const Entry& last = _entries.back();
+		_size -= last.bytes;
+		_index.erase(last.key);
+		_entries.pop_back();
+	}
+}
+
+void MeshCache::add(Entry&& entry) {
+	core::ScopedLock lock(_lock);
+	auto i = _index.find(entry.key);
+	if (i != _index.end()) {
+		_size -= i->second->bytes;
+		_entries.erase(i->second);
+		_index.erase(i);
+	}
+	_size += entry.bytes;
+	_entries.push_front(std::move(entry));
+	_index.emplace(_entries.front().key, _entries.begin());
+	evict();
+}
+
+bool MeshCache::get(const MeshCacheKey& key, voxel::CompactMesh& mesh, int& solidHeight) {
+	if (!enabled()) {
+		return false;
+	}
+	core_trace_scoped(MeshCacheGet);
+	core::ScopedLock lock(_lock);
+	auto i = _index.find(key);
+	if (i == _index.end()) {
+		return false;
+	}
+	// mark as recently used
+	_entries.splice(_entries.begin(), _entries, i->second);
+	const Entry& entry = *i->second;
+	solidHeight = entry.solidHeight;
+	mesh = entry.mesh;
+	return true;
+}
+
+void MeshCache::put(const MeshCacheKey& key, const voxel::CompactMesh& mesh, int solidHeight) {
+	if (!enabled()) {
+		return;
+	}
+	core_trace_scoped(MeshCachePut);
+	Entry entry;
+	entry.key = key;
+	entry.solidHeight = solidHeight;
+	entry.bytes = meshBytes(mesh);
+	if (entry.bytes > _maxSize) {
+		return;
+	}
+	entry.mesh = mesh;
+	add(std::move(entry));
+}
+
+void MeshCache::clear() {
+	core::ScopedLock lock(_lock);
+	_entries.clear();
+	_index.clear();
+	_size = 0u;
+}
+
+size_t MeshCache::size() const {
+	core::ScopedLock lock(_lock);
+	return _size;
+}
+
+int MeshCache::entries() const {
+	core::ScopedLock lock(_lock);
+	return (int)_entries.size();
+}
+
+}
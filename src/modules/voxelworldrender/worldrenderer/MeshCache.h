@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/CompactMesh.h"
+#include "core/String.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace voxelworldrender {
+
+/**
+ * @brief Identifies an extracted mesh - the content hash covers all voxels the extraction has read
+ */
+struct MeshCacheKey {
+	uint32_t seed = 0u;
+	glm::ivec3 pos { 0 };
+	int32_t lod = 0;
+	uint32_t contentHash = 0u;
+
+	inline bool operator==(const MeshCacheKey& rhs) const {
+		return seed == rhs.seed && pos == rhs.pos && lod == rhs.lod && contentHash == rhs.contentHash;
+	}
+};
+
+struct MeshCacheKeyHash {
+	size_t operator()(const MeshCacheKey& key) const;
+};
+
+/**
+ * @brief Keeps the encoded meshes as they are uploaded to the gpu
+ *
+ * Coming back to an area that was already visited doesn't need another surface extraction. The least recently
+ * used meshes are dropped if the cache gets bigger than the configured size. The cache is loaded from a file on
+ * @c init() and written back on @c shutdown() - so it survives restarts.
+ *
+ * @note Every lookup needs the content hash of the voxels - this is the cost of a cache miss on top of the
+ * extraction.
+ *
+ * @note All methods are thread safe - the meshes are extracted by several threads.
+ */
+class MeshCache {
+private:
+	struct Entry {
+		MeshCacheKey key;
+		int32_t solidHeight = 0;
+		voxel::CompactMesh mesh;
+		size_t bytes = 0u;
+	};
+	using EntryList = std::list<Entry>;
+
+	/** most recently used entries are at the front */
+	EntryList _entries;
+	std::unordered_map<MeshCacheKey, EntryList::iterator, MeshCacheKeyHash> _index;
+	size_t _size = 0u;
+	size_t _maxSize = 0u;
+	core::String _filename;
+	mutable core_trace_mutex(core::Lock, _lock, "MeshCache");
+
+	void evict();
+	void add(Entry&& entry);
+
+public:
+	/**
+	 * @param filename The file to load the cache from - empty if it should only be kept in memory
+	 * @param maxSize The max amount of bytes of the cached meshes - @c 0 disables the cache
+	 */
+	bool init(const core::String& filename, size_t maxSize);
+	/**
+	 * @brief Writes the cache to the file it was loaded from
+	 */
+	void shutdown();
+
+	bool load(const uint8_t* buf, size_t size);
+	bool save(std::vector<uint8_t>& out) const;
+
+	/**
+	 * @param[out] mesh The cached mesh - untouched if there is no entry for the given key
+	 * @return @c false if there is no entry for the given key
+	 */
+	bool get(const MeshCacheKey& key, voxel::CompactMesh& mesh, int& solidHeight);
+	void put(const MeshCacheKey& key, const voxel::CompactMesh& mesh, int solidHeight);
+
+	void clear();
+
+	bool enabled() const;
+	/**
+	 * @return The amount of bytes of the cached meshes
+	 */
+	size_t size() const;
+	int entries() const;
+};
+
+inline bool MeshCache::enabled() const {
+	return _maxSize > 0u;
+}
+
+}
@@ -0,0 +1,274 @@
+/**
+ * @file
+ */
+
+#include "OcclusionBuffer.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#else
+#define OCCLUSION_SSE 0
+#endif
+
+namespace voxelworldrender {
+
+namespace {
+
+inline float cross(const glm::vec2& o, const glm::vec2& a, const glm::vec2& b) {
+	return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/**
+ * @brief Andrew's monotone chain - the result is in counter clockwise order
+ * @return The amount of vertices in the hull
+ */
+int convexHull(glm::vec2 (&points)[8], glm::vec2 (&hull)[16]) {
+	std::sort(std::begin(points), std::end(points), [] (const glm::vec2& a, const glm::vec2& b) {
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	});
+	int k = 0;
+	for (int i = 0; i < 8; ++i) {
+		while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0f) {
+			--k;
+		}
+		hull[k++] = points[i];
+	}
+	for (int i = 6, t = k + 1; i >= 0; --i) {
+		while (k >= t && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0f) {
+			--k;
+		}
+		hull[k++] = points[i];
+	}
+	// the last point is the same as the first one
+	return k - 1;
+}
+
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) :
+		_width(width), _height(height), _stride((width + 3) & ~3) {
+	core_assert(width > 0 && height > 0);
+	_depth.resize(_stride * _height);
+	int w = width;
+	int h = height;
+	while (w > 1 || h > 1) {
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+		Level level;
+		level.width = w;
+		level.height = h;
+		level.depth.resize(w * h);
+		_levels.push_back(level);
+	}
+	clear(glm::mat4(1.0f));
+}
+
+void OcclusionBuffer::clear(const glm::mat4& viewProjection) {
+	_viewProjection = viewProjection;
+	std::fill(_depth.begin(), _depth.end(), 1.0f);
+	for (Level& level : _levels) {
+		std::fill(level.depth.begin(), level.depth.end(), 1.0f);
+	}
+}
+
+bool OcclusionBuffer::project(const glm::vec3& mins, const glm::vec3& maxs, glm::vec3 (&screen)[8]) const {
+	for (int i = 0; i < 8; ++i) {
+		const glm::vec4 corner((i & 1) ? maxs.x : mins.x, (i & 2) ? maxs.y : mins.y, (i & 4) ? maxs.z : mins.z, 1.0f);
+		const glm::vec4& clip = _viewProjection * corner;
+		if (clip.w <= 0.0001f) {
+			return false;
+		}
+		const float invW = 1.0f / clip.w;
+		screen[i].x = (clip.x * invW * 0.5f + 0.5f) * (float)_width;
+		screen[i].y = (clip.y * invW * 0.5f + 0.5f) * (float)_height;
+		screen[i].z = clip.z * invW;
+	}
+	return true;
+}
+
+bool OcclusionBuffer::addOccluder(const glm::vec3& mins, const glm::vec3& maxs) {
+	glm::vec3 screen[8];
+	if (!project(mins, maxs, screen)) {
+		return false;
+	}
+	glm::vec2 points[8];
+	float depth = screen[0].z;
+	for (int i = 0; i < 8; ++i) {
+		points[i] = glm::vec2(screen[i]);
+		depth = core_max(depth, screen[i].z);
+	}
+	if (depth >= 1.0f) {
+		return false;
+	}
+	glm::vec2 hull[16];
+	const int n = convexHull(points, hull);
+	if (n < 3) {
+		return false;
+	}
+	rasterizeConvexPolygon(hull, n, depth);
+	return true;
+}
+
+void OcclusionBuffer::rasterizeConvexPolygon(const glm::vec2* vertices, int n, float depth) {
+	glm::vec2 mins = vertices[0];
+	glm::vec2 maxs = vertices[0];
+	for (int i = 1; i < n; ++i) {
+		mins = glm::min(mins, vertices[i]);
+		maxs = glm::max(maxs, vertices[i]);
+	}
+	const int x0 = core_max(0, (int)glm::floor(mins.x)) & ~3;
+	const int x1 = core_min(_width - 1, (int)glm::floor(maxs.x));
+	const int y0 = core_max(0, (int)glm::floor(mins.y));
+	const int y1 = core_min(_height - 1, (int)glm::floor(maxs.y));
+	if (x0 > x1 || y0 > y1) {
+		return;
+	}
+
+	// edge functions - a pixel is only covered if the whole pixel square is inside of each edge
+	float edgeX[16];
+	float edgeY[16];
+	float edgeC[16];
+	for (int i = 0; i < n; ++i) {
+		const glm::vec2& a = vertices[i];
+		const glm::vec2& b = vertices[(i + 1) % n];
+		const float dx = b.x - a.x;
+		const float dy = b.y - a.y;
+		edgeX[i] = -dy;
+		edgeY[i] = dx;
+		edgeC[i] = dy * a.x - dx * a.y - 0.5f * (glm::abs(dx) + glm::abs(dy));
+	}
+
+	for (int y = y0; y <= y1; ++y) {
+		const float cy = (float)y + 0.5f;
+		float* row = &_depth[y * _stride];
+#if OCCLUSION_SSE
+		__m128 edges[16];
+		__m128 steps[16];
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 cx = _mm_add_ps(_mm_set1_ps((float)x0), offsets);
+		for (int i = 0; i < n; ++i) {
+			edges[i] = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(edgeX[i])), _mm_set1_ps(edgeY[i] * cy + edgeC[i]));
+			steps[i] = _mm_set1_ps(edgeX[i] * 4.0f);
+		}
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 depthValue = _mm_set1_ps(depth);
+		const __m128i width = _mm_set1_epi32(_width);
+		__m128i xs = _mm_setr_epi32(x0, x0 + 1, x0 + 2, x0 + 3);
+		const __m128i xstep = _mm_set1_epi32(4);
+		for (int x = x0; x <= x1; x += 4) {
+			__m128 mask = _mm_castsi128_ps(_mm_cmplt_epi32(xs, width));
+			for (int i = 0; i < n; ++i) {
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(edges[i], zero));
+				edges[i] = _mm_add_ps(edges[i], steps[i]);
+			}
+			xs = _mm_add_epi32(xs, xstep);
+			if (_mm_movemask_ps(mask) == 0) {
+				continue;
+			}
+			const __m128 current = _mm_loadu_ps(row + x);
+			const __m128 nearer = _mm_min_ps(current, depthValue);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, nearer), _mm_andnot_ps(mask, current)));
+		}
+#else
+		for (int x = x0; x <= x1; ++x) {
+			const float cx = (float)x + 0.5f;
+			bool inside = true;
+			for (int i = 0; i < n; ++i) {
+				if (edgeX[i] * cx + edgeY[i] * cy + edgeC[i] < 0.0f) {
+					inside = false;
+					break;
+				}
+			}
+			if (inside && depth < row[x]) {
+				row[x] = depth;
+			}
+		}
+#endif
+	}
+}
+
+void OcclusionBuffer::update() {
+	core_trace_scoped(OcclusionBufferUpdate);
+	for (int l = 1; l < levels(); ++l) {
+		Level& level = _levels[l - 1];
+		const int belowWidth = levelWidth(l - 1);
+		const int belowHeight = levelHeight(l - 1);
+		for (int y = 0; y < level.height; ++y) {
+			const int by0 = y * 2;
+			const int by1 = core_min(belowHeight - 1, by0 + 1);
+			for (int x = 0; x < level.width; ++x) {
+				const int bx0 = x * 2;
+				const int bx1 = core_min(belowWidth - 1, bx0 + 1);
+				const float maxDepth = core_max(core_max(depth(l - 1, bx0, by0), depth(l - 1, bx1, by0)),
+						core_max(depth(l - 1, bx0, by1), depth(l - 1, bx1, by1)));
+				level.depth[y * level.width + x] = maxDepth;
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isHidden(int level, int tx, int ty, int x0, int y0, int x1, int y1, float nearestDepth) const {
+	if (depth(level, tx, ty) < nearestDepth) {
+		return true;
+	}
+	if (level == 0) {
+		return false;
+	}
+	const int below = level - 1;
+	const int cx0 = core_max(tx * 2, x0 >> below);
+	const int cx1 = core_min(tx * 2 + 1, x1 >> below);
+	const int cy0 = core_max(ty * 2, y0 >> below);
+	const int cy1 = core_min(ty * 2 + 1, y1 >> below);
+	for (int cy = cy0; cy <= cy1; ++cy) {
+		for (int cx = cx0; cx <= cx1; ++cx) {
+			if (!isHidden(below, cx, cy, x0, y0, x1, y1, nearestDepth)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool OcclusionBuffer::isOccluded(const glm::vec3& mins, const glm::vec3& maxs) const {
+	glm::vec3 screen[8];
+	if (!project(mins, maxs, screen)) {
+		return false;
+	}
+	glm::vec3 smins = screen[0];
+	glm::vec3 smaxs = screen[0];
+	for (int i = 1; i < 8; ++i) {
+		smins = glm::min(smins, screen[i]);
+		smaxs = glm::max(smaxs, screen[i]);
+	}
+	const int x0 = core_max(0, (int)glm::floor(smins.x));
+	const int x1 = core_min(_width - 1, (int)glm::floor(smaxs.x));
+	const int y0 = core_max(0, (int)glm::floor(smins.y));
+	const int y1 = core_min(_height - 1, (int)glm::floor(smaxs.y));
+	if (x0 > x1 || y0 > y1) {
+		// not on the screen - this is up to the frustum culling
+		return false;
+	}
+	const float nearestDepth = smins.z;
+	// the level where the rectangle covers at most 2x2 texels
+	int level = 0;
+	while (level + 1 < levels() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+		++level;
+	}
+	for (int ty = y0 >> level; ty <= y1 >> level; ++ty) {
+		for (int tx = x0 >> level; tx <= x1 >> level; ++tx) {
+			if (!isHidden(level, tx, ty, x0, y0, x1, y1, nearestDepth)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
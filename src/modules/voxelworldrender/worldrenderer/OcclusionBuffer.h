@@ -0,0 +1,128 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace voxelworldrender {
+
+/**
+ * @brief Low resolution cpu depth buffer for occlusion culling
+ *
+ * Occluders are boxes that are completely solid. Each box is rasterized as its projected outline with the
+ * depth of its farthest corner. Only the pixels that are fully covered by the outline are written. Both
+ * keep the occluders conservative - an object is never reported as occluded if a part of it might be
+ * visible.
+ *
+ * The occlusion queries use a hierarchical depth buffer: a mip pyramid where each texel stores the farthest
+ * depth of the 2x2 texels of the level below. A query starts at the level where the screen rectangle of the
+ * box covers at most 2x2 texels and only descends into the texels that are not already nearer than the box.
+ */
+class OcclusionBuffer {
+private:
+	struct Level {
+		int width;
+		int height;
+		std::vector<float> depth;
+	};
+	int _width;
+	int _height;
+	// the rows are padded to a multiple of four pixels
+	int _stride;
+	std::vector<float> _depth;
+	/** the levels above the full resolution depth buffer - down to one texel */
+	std::vector<Level> _levels;
+	glm::mat4 _viewProjection { 1.0f };
+
+	/**
+	 * @brief Projects the corners of the box into screen space
+	 * @return @c false if the box is crossing the near plane
+	 */
+	bool project(const glm::vec3& mins, const glm::vec3& maxs, glm::vec3 (&screen)[8]) const;
+	void rasterizeConvexPolygon(const glm::vec2* vertices, int n, float depth);
+	/**
+	 * @return @c true if all pixels of the given texel that are inside of the rectangle are nearer than the given depth
+	 * @note The rectangle is given in pixels of the full resolution level
+	 */
+	bool isHidden(int level, int tx, int ty, int x0, int y0, int x1, int y1, float nearestDepth) const;
+public:
+	OcclusionBuffer(int width = 256, int height = 128);
+
+	/**
+	 * @brief Resets the depth values to the far plane
+	 * @param[in] viewProjection The matrix that is used to project the occluders and the queries
+	 */
+	void clear(const glm::mat4& viewProjection);
+
+	/**
+	 * @brief Renders a solid box into the depth buffer
+	 * @return @c false if the box was not rendered - e.g. because it crosses the near plane
+	 * @note Call @c update() after all occluders were added
+	 */
+	bool addOccluder(const glm::vec3& mins, const glm::vec3& maxs);
+
+	/**
+	 * @brief Builds the depth pyramid
+	 */
+	void update();
+
+	/**
+	 * @return @c true if the given box is completely hidden behind the occluders
+	 */
+	bool isOccluded(const glm::vec3& mins, const glm::vec3& maxs) const;
+
+	/**
+	 * @return The depth value of the given pixel - @c 1.0 is the far plane
+	 */
+	float depth(int x, int y) const;
+	/**
+	 * @return The farthest depth value of the given texel of a level of the pyramid - level @c 0 is the full resolution
+	 */
+	float depth(int level, int x, int y) const;
+	/**
+	 * @return The amount of levels of the pyramid including the full resolution level
+	 */
+	int levels() const;
+	int levelWidth(int level) const;
+	int levelHeight(int level) const;
+	int width() const;
+	int height() const;
+};
+
+inline float OcclusionBuffer::depth(int x, int y) const {
+	return _depth[y * _stride + x];
+}
+
+inline float OcclusionBuffer::depth(int level, int x, int y) const {
+	if (level == 0) {
+		return depth(x, y);
+	}
+	const Level& l = _levels[level - 1];
+	return l.depth[y * l.width + x];
+}
+
+inline int OcclusionBuffer::levels() const {
+	return (int)_levels.size() + 1;
+}
+
+inline int OcclusionBuffer::levelWidth(int level) const {
+	return level == 0 ? _width : _levels[level - 1].width;
+}
+
+inline int OcclusionBuffer::levelHeight(int level) const {
+	return level == 0 ? _height : _levels[level - 1].height;
+}
+
+inline int OcclusionBuffer::width() const {
+	return _width;
+}
+
+inline int OcclusionBuffer::height() const {
+	return _height;
+}
+
+}
@@ -0,0 +1,195 @@
+/**
+ * @file
+ */
+
+#include "TerrainBuffer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "voxelrender/ShaderAttribute.h"
+#include "WorldShader.h"
+#include <string.h>
+
+namespace voxelworldrender {
+
+bool TerrainBuffer::init(shader::WorldShader* worldShader, uint32_t vertices, uint32_t indices, uint32_t subMeshes) {
+	_vertexAllocator.grow(vertices);
+	_indexAllocator.grow(indices);
+	_subMeshAllocator.grow(subMeshes);
+	_vertices.resize(_vertexAllocator.capacity());
+	_indices.resize(_indexAllocator.capacity());
+	_subMeshes.resize(1u + _subMeshAllocator.capacity());
+
+	_vbo = _buffer.create(_vertices.data(), _vertices.size() * sizeof(voxel::CompactVertex));
+	if (_vbo == -1) {
+		Log::error("Failed to create terrain vertex buffer");
+		return false;
+	}
+	_buffer.setMode(_vbo, video::BufferMode::Dynamic);
+	_ibo = _buffer.create(_indices.data(), _indices.size() * sizeof(voxel::CompactIndexType), video::BufferType::IndexBuffer);
+	if (_ibo == -1) {
+		Log::error("Failed to create terrain index buffer");
+		return false;
+	}
+	_buffer.setMode(_ibo, video::BufferMode::Dynamic);
+	_sbo = _buffer.create(_subMeshes.data(), _subMeshes.size() * sizeof(SubMesh));
+	if (_sbo == -1) {
+		Log::error("Failed to create terrain sub mesh buffer");
+		return false;
+	}
+	_buffer.setMode(_sbo, video::BufferMode::Dynamic);
+
+	const int locationData = worldShader->getLocationData();
+	const video::Attribute& dataAttrib = voxelrender::getCompactVertexAttribute(_vbo, locationData);
+	if (!_buffer.addAttribute(dataAttrib)) {
+		Log::error("Failed to add vertex data attribute");
+		return false;
+	}
+	const int locationOrigin = worldShader->getLocationOrigin();
+	video::Attribute originAttrib = voxelrender::getOffsetVertexAttribute(_sbo, locationOrigin, worldShader->getAttributeComponents(locationOrigin));
+	originAttrib.stride = sizeof(SubMesh);
+	originAttrib.offset = offsetof(SubMesh, origin);
+	if (!_buffer.addAttribute(originAttrib)) {
+		Log::error("Failed to add origin attribute");
+		return false;
+	}
+	return true;
+}
+
+void TerrainBuffer::shutdown() {
+	_buffer.shutdown();
+	_vbo = -1;
+	_ibo = -1;
+	_sbo = -1;
+	_vertexAllocator.clear();
+	_indexAllocator.clear();
+	_subMeshAllocator.clear();
+	_vertices.clear();
+	_indices.clear();
+	_subMeshes.clear();
+}
+
+template<class T>
+bool TerrainBuffer::reserve(core::RangeAllocator& allocator, std::vector<T>& data, uint32_t size, uint32_t first) {
+	if (allocator.largestFreeRange() >= size) {
+		return false;
+	}
+	if (allocator.available() >= size) {
+		core_trace_scoped(TerrainBufferDefragment);
+		for (const core::RangeAllocator::Move& move : allocator.defragment()) {
+			memmove(&data[first + move.to], &data[first + move.from], move.size * sizeof(T));
+		}
+		Log::debug("Defragmented terrain buffer (%u/%u used)", allocator.used(), allocator.capacity());
+		return true;
+	}
+	const uint32_t capacity = core_max(allocator.capacity() * 2u, allocator.capacity() + size);
+	allocator.grow(capacity);
+	data.resize(first + capacity);
+	Log::debug("Increased terrain buffer size to %u", capacity);
+	return true;
+}
+
+void TerrainBuffer::upload(int32_t idx, const void* data, size_t offset, size_t size, bool full, size_t fullSize) {
+	if (full) {
+		_buffer.update(idx, data, fullSize);
+	} else {
+		_buffer.update(idx, offset, (const uint8_t*)data + offset, size);
+	}
+}
+
+TerrainBuffer::Allocation TerrainBuffer::add(const voxel::CompactMesh& mesh) {
+	core_trace_scoped(TerrainBufferAdd);
+	Allocation allocation;
+	if (mesh.isEmpty()) {
+		return allocation;
+	}
+	const uint32_t numVertices = (uint32_t)mesh.vertices().size();
+	const uint32_t numIndices = (uint32_t)mesh.indices().size();
+	const uint32_t numSubMeshes = (uint32_t)mesh.subMeshes().size();
+
+	const bool fullVertexUpload = reserve(_vertexAllocator, _vertices, numVertices);
+	allocation.vertices = _vertexAllocator.allocate(numVertices);
+	const bool fullIndexUpload = reserve(_indexAllocator, _indices, numIndices);
+	allocation.indices = _indexAllocator.allocate(numIndices);
+	const bool fullSubMeshUpload = reserve(_subMeshAllocator, _subMeshes, numSubMeshes, 1u);
+	allocation.subMeshes = _subMeshAllocator.allocate(numSubMeshes);
+	if (allocation.vertices == core::RangeAllocator::InvalidHandle || allocation.indices == core::RangeAllocator::InvalidHandle
+			|| allocation.subMeshes == core::RangeAllocator::InvalidHandle) {
+		Log::error("Failed to allocate terrain buffer ranges");
+		remove(allocation);
+		return allocation;
+	}
+
+	const uint32_t vertexOffset = _vertexAllocator.offset(allocation.vertices);
+	const size_t vertexBytes = numVertices * sizeof(voxel::CompactVertex);
+	memcpy(&_vertices[vertexOffset], mesh.vertices().data(), vertexBytes);
+	upload(_vbo, _vertices.data(), vertexOffset * sizeof(voxel::CompactVertex), vertexBytes,
+			fullVertexUpload, _vertices.size() * sizeof(voxel::CompactVertex));
+
+	const uint32_t indexOffset = _indexAllocator.offset(allocation.indices);
+	const size_t indexBytes = numIndices * sizeof(voxel::CompactIndexType);
+	memcpy(&_indices[indexOffset], mesh.indices().data(), indexBytes);
+	upload(_ibo, _indices.data(), indexOffset * sizeof(voxel::CompactIndexType), indexBytes,
+			fullIndexUpload, _indices.size() * sizeof(voxel::CompactIndexType));
+
+	const uint32_t subMeshOffset = 1u + _subMeshAllocator.offset(allocation.subMeshes);
+	for (uint32_t i = 0u; i < numSubMeshes; ++i) {
+		const voxel::CompactSubMesh& compact = mesh.subMeshes()[i];
+		SubMesh& subMesh = _subMeshes[subMeshOffset + i];
+		subMesh.origin = glm::vec3(compact.origin);
+		subMesh.baseVertex = compact.baseVertex;
+		subMesh.firstIndex = compact.firstIndex;
+		subMesh.indexCount = compact.indexCount;
+	}
+	upload(_sbo, _subMeshes.data(), subMeshOffset * sizeof(SubMesh), numSubMeshes * sizeof(SubMesh),
+			fullSubMeshUpload, _subMeshes.size() * sizeof(SubMesh));
+	return allocation;
+}
+
+void TerrainBuffer::remove(Allocation& allocation) {
+	_vertexAllocator.free(allocation.vertices);
+	_indexAllocator.free(allocation.indices);
+	_subMeshAllocator.free(allocation.subMeshes);
+	allocation = Allocation();
+}
+
+void TerrainBuffer::clear() {
+	_vertexAllocator.clear();
+	_indexAllocator.clear();
+	_subMeshAllocator.clear();
+}
+
+void TerrainBuffer::commands(const Allocation& allocation, uint32_t offset, uint32_t count, std::vector<video::DrawElementsIndirectCommand>& out) const {
+	const uint32_t vertexOffset = _vertexAllocator.offset(allocation.vertices);
+	const uint32_t indexOffset = _indexAllocator.offset(allocation.indices);
+	const uint32_t first = 1u + _subMeshAllocator.offset(allocation.subMeshes);
+	const uint32_t end = first + _subMeshAllocator.size(allocation.subMeshes);
+	const uint32_t rangeEnd = offset + count;
+	for (uint32_t i = first; i < end; ++i) {
+		const SubMesh& subMesh = _subMeshes[i];
+		if (subMesh.firstIndex >= rangeEnd) {
+			// the sub meshes are sorted by their first index
+			break;
+		}
+		const uint32_t from = core_max(offset, subMesh.firstIndex);
+		const uint32_t to = core_min(rangeEnd, subMesh.firstIndex + subMesh.indexCount);
+		if (from >= to) {
+			continue;
+		}
+		video::DrawElementsIndirectCommand cmd;
+		cmd.count = to - from;
+		cmd.firstIndex = indexOffset + from;
+		cmd.baseVertex = vertexOffset + subMesh.baseVertex;
+		cmd.baseInstance = i;
+		out.push_back(cmd);
+	}
+}
+
+void TerrainBuffer::draw(const video::DrawElementsIndirectCommand& cmd) {
+	// without the base instance the attribute of the first instance is used
+	_subMeshes[0] = _subMeshes[cmd.baseInstance];
+	_buffer.update(_sbo, 0u, &_subMeshes[0], sizeof(SubMesh));
+	video::drawElementsBaseVertex(video::Primitive::Triangles, cmd.count, video::mapType<voxel::CompactIndexType>(),
+			sizeof(voxel::CompactIndexType), (int)cmd.firstIndex, (int)cmd.baseVertex);
+}
+
+}
@@ -0,0 +1,143 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RangeAllocator.h"
+#include "video/Buffer.h"
+#include "video/Renderer.h"
+#include "voxel/CompactMesh.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace shader {
+class WorldShader;
+}
+
+namespace voxelworldrender {
+
+/**
+ * @brief One vertex and one index buffer that hold the compact meshes of all terrain chunks
+ *
+ * The ranges of the chunks inside the buffers are managed by @c core::RangeAllocator. A cpu side copy of the
+ * geometry is kept - it is uploaded again if the buffers had to grow or were defragmented. The chunks are
+ * rendered by using the base vertex and the first index of their sub mesh ranges - this allows to render all
+ * of them with one indirect draw call. The origins of the sub meshes are an instanced attribute that is
+ * selected by the base instance of the draw command.
+ *
+ * @sa voxel::CompactMesh
+ */
+class TerrainBuffer {
+public:
+	/**
+	 * @brief The ranges of one mesh in the buffers
+	 */
+	struct Allocation {
+		core::RangeAllocator::Handle vertices = core::RangeAllocator::InvalidHandle;
+		core::RangeAllocator::Handle indices = core::RangeAllocator::InvalidHandle;
+		core::RangeAllocator::Handle subMeshes = core::RangeAllocator::InvalidHandle;
+
+		inline bool valid() const {
+			return vertices != core::RangeAllocator::InvalidHandle;
+		}
+	};
+private:
+	/**
+	 * @brief The instanced attribute data of one sub mesh - the ranges are relative to the allocation
+	 */
+	struct SubMesh {
+		glm::vec3 origin { 0.0f };
+		uint32_t baseVertex = 0u;
+		uint32_t firstIndex = 0u;
+		uint32_t indexCount = 0u;
+	};
+	core::RangeAllocator _vertexAllocator;
+	core::RangeAllocator _indexAllocator;
+	core::RangeAllocator _subMeshAllocator;
+	std::vector<voxel::CompactVertex> _vertices;
+	std::vector<voxel::CompactIndexType> _indices;
+	/**
+	 * The first entry is reserved for @c draw() - the offsets of the sub mesh allocator start at the second
+	 * entry
+	 */
+	std::vector<SubMesh> _subMeshes;
+
+	video::Buffer _buffer;
+	int32_t _vbo = -1;
+	int32_t _ibo = -1;
+	int32_t _sbo = -1;
+
+	/**
+	 * @brief Makes room for the given amount of elements by defragmenting or growing the address space
+	 * @param[in] first The amount of entries in front of the address space of the allocator
+	 * @return @c true if the whole buffer must be uploaded again
+	 */
+	template<class T>
+	bool reserve(core::RangeAllocator& allocator, std::vector<T>& data, uint32_t size, uint32_t first = 0u);
+	void upload(int32_t idx, const void* data, size_t offset, size_t size, bool full, size_t fullSize);
+public:
+	/**
+	 * @param[in] vertices The initial amount of vertices
+	 * @param[in] indices The initial amount of indices
+	 * @param[in] subMeshes The initial amount of sub meshes
+	 */
+	bool init(shader::WorldShader* worldShader, uint32_t vertices = 1u << 20, uint32_t indices = 3u << 19, uint32_t subMeshes = 1u << 12);
+	void shutdown();
+
+	/**
+	 * @brief Copies the vertices, indices and sub meshes of the given mesh into the buffers
+	 * @return An invalid allocation if the mesh is empty or the buffers could not be updated
+	 */
+	Allocation add(const voxel::CompactMesh& mesh);
+	void remove(Allocation& allocation);
+	/**
+	 * @brief Removes all meshes - the buffer sizes are kept
+	 */
+	void clear();
+
+	/**
+	 * @brief Adds the draw commands that render the given index range of the allocation - one per sub mesh
+	 * that the range intersects
+	 * @param[in] offset,count The index range relative to the mesh - e.g. a face index range
+	 */
+	void commands(const Allocation& allocation, uint32_t offset, uint32_t count, std::vector<video::DrawElementsIndirectCommand>& out) const;
+	/**
+	 * @brief Adds the draw commands that render the whole allocation
+	 */
+	void commands(const Allocation& allocation, std::vector<video::DrawElementsIndirectCommand>& out) const;
+	/**
+	 * @brief Renders one of the commands without relying on the base instance
+	 * @note Slower than rendering all commands with one indirect draw call - the origin of the sub mesh is
+	 * uploaded for every call
+	 */
+	void draw(const video::DrawElementsIndirectCommand& cmd);
+
+	bool bind() const;
+	bool unbind() const;
+
+	const core::RangeAllocator& vertexAllocator() const;
+	const core::RangeAllocator& indexAllocator() const;
+};
+
+inline bool TerrainBuffer::bind() const {
+	return _buffer.bind();
+}
+
+inline bool TerrainBuffer::unbind() const {
+	return _buffer.unbind();
+}
+
+inline const core::RangeAllocator& TerrainBuffer::vertexAllocator() const {
+	return _vertexAllocator;
+}
+
+inline const core::RangeAllocator& TerrainBuffer::indexAllocator() const {
+	return _indexAllocator;
+}
+
+inline void TerrainBuffer::commands(const Allocation& allocation, std::vector<video::DrawElementsIndirectCommand>& out) const {
+	commands(allocation, 0u, _indexAllocator.size(allocation.indices), out);
+}
+
+}
@@ -0,0 +1,257 @@
+/**
+ * @file
+ */
+
+#include "TerrainImpostors.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include <glm/common.hpp>
+
+namespace voxelworldrender {
+
+namespace {
+/** the impostors don't have any ambient occlusion */
+constexpr uint8_t ImpostorAmbientOcclusion = 3;
+
+inline voxel::IndexType addVertex(voxel::Mesh& mesh, int x, int y, int z, uint8_t color) {
+	voxel::VoxelVertex vertex;
+	vertex.position = glm::i16vec3(x, y, z);
+	vertex.ambientOcclusion = ImpostorAmbientOcclusion;
+	vertex.colorIndex = color;
+	return mesh.addVertex(vertex);
+}
+
+/**
+ * @note The vertices must be given in counter clockwise order as seen from the front side
+ */
+inline void addQuad(voxel::Mesh& mesh, const glm::ivec3& v0, const glm::ivec3& v1, const glm::ivec3& v2, const glm::ivec3& v3, uint8_t color) {
+	const voxel::IndexType i0 = addVertex(mesh, v0.x, v0.y, v0.z, color);
+	const voxel::IndexType i1 = addVertex(mesh, v1.x, v1.y, v1.z, color);
+	const voxel::IndexType i2 = addVertex(mesh, v2.x, v2.y, v2.z, color);
+	const voxel::IndexType i3 = addVertex(mesh, v3.x, v3.y, v3.z, color);
+	mesh.addTriangle(i0, i1, i2);
+	mesh.addTriangle(i0, i2, i3);
+}
+
+/**
+ * @brief Adds the side between the given heights from @c a to @c b - the side is split into parts that are not
+ * higher than a compact sub mesh
+ */
+inline void addSide(voxel::Mesh& mesh, const glm::ivec2& a, const glm::ivec2& b, int bottom, int top, uint8_t color) {
+	for (int y = bottom; y < top; y += voxel::CompactMesh::MaxExtentY) {
+		const int y1 = glm::min(top, y + voxel::CompactMesh::MaxExtentY);
+		addQuad(mesh, {a.x, y, a.y}, {b.x, y, b.y}, {b.x, y1, b.y}, {a.x, y1, a.y}, color);
+	}
+}
+
+void addColumn(const ImpostorHeightmap& heightmap, int cx, int cz, voxel::Mesh& mesh) {
+	const int h = heightmap.height(cx, cz);
+	const uint8_t color = heightmap.color(cx, cz);
+	const int x0 = heightmap.mins.x + cx * heightmap.cellSize;
+	const int z0 = heightmap.mins.y + cz * heightmap.cellSize;
+	const int x1 = x0 + heightmap.cellSize;
+	const int z1 = z0 + heightmap.cellSize;
+	addQuad(mesh, {x0, h, z0}, {x0, h, z1}, {x1, h, z1}, {x1, h, z0}, color);
+
+	// every side belongs to the higher one of the two columns
+	const int left = heightmap.height(cx - 1, cz);
+	if (left < h) {
+		addSide(mesh, {x0, z0}, {x0, z1}, left, h, color);
+	}
+	const int right = heightmap.height(cx + 1, cz);
+	if (right < h) {
+		addSide(mesh, {x1, z1}, {x1, z0}, right, h, color);
+	}
+	const int back = heightmap.height(cx, cz - 1);
+	if (back < h) {
+		addSide(mesh, {x1, z0}, {x0, z0}, back, h, color);
+	}
+	const int front = heightmap.height(cx, cz + 1);
+	if (front < h) {
+		addSide(mesh, {x0, z1}, {x1, z1}, front, h, color);
+	}
+}
+
+}
+
+void generateImpostorHeightmap(const SurfaceFunc& surface, const glm::ivec2& mins, int size, int cellSize, ImpostorHeightmap& heightmap) {
+	core_trace_scoped(GenerateImpostorHeightmap);
+	core_assert(size % cellSize == 0);
+	heightmap.mins = mins;
+	heightmap.cellSize = cellSize;
+	heightmap.cells = size / cellSize;
+	const int samples = heightmap.cells + 2;
+	heightmap.heights.resize(samples * samples);
+	heightmap.colors.resize(samples * samples);
+	const int center = cellSize / 2;
+	for (int z = -1; z <= heightmap.cells; ++z) {
+		for (int x = -1; x <= heightmap.cells; ++x) {
+			voxel::Voxel voxel;
+			const int height = surface(mins.x + x * cellSize + center, mins.y + z * cellSize + center, voxel);
+			const int idx = heightmap.index(x, z);
+			heightmap.heights[idx] = (int16_t)height;
+			heightmap.colors[idx] = voxel.getColor();
+		}
+	}
+}
+
+void buildImpostorMesh(const ImpostorHeightmap& heightmap, int tileSize, ImpostorMesh& impostor) {
+	core_trace_scoped(BuildImpostorMesh);
+	core_assert(tileSize % heightmap.cellSize == 0);
+	const int cellsPerTile = tileSize / heightmap.cellSize;
+	impostor.mins = heightmap.mins;
+	impostor.tileSize = tileSize;
+	impostor.tiles = heightmap.cells / cellsPerTile;
+	impostor.tileRanges.resize(impostor.tiles * impostor.tiles);
+	impostor.maxHeight = 0;
+	impostor.mesh.clear();
+	impostor.mesh.setOffset(glm::ivec3(heightmap.mins.x, 0, heightmap.mins.y));
+	for (int tz = 0; tz < impostor.tiles; ++tz) {
+		for (int tx = 0; tx < impostor.tiles; ++tx) {
+			voxel::IndexRange& range = impostor.tileRanges[tz * impostor.tiles + tx];
+			range.offset = (uint32_t)impostor.mesh.getNoOfIndices();
+			for (int cz = tz * cellsPerTile; cz < (tz + 1) * cellsPerTile; ++cz) {
+				for (int cx = tx * cellsPerTile; cx < (tx + 1) * cellsPerTile; ++cx) {
+					addColumn(heightmap, cx, cz, impostor.mesh);
+					impostor.maxHeight = glm::max(impostor.maxHeight, heightmap.height(cx, cz));
+				}
+			}
+			range.count = (uint32_t)impostor.mesh.getNoOfIndices() - range.offset;
+		}
+	}
+}
+
+TerrainImpostors::TerrainImpostors() :
+		_threadPool(1, "Impostors") {
+}
+
+bool TerrainImpostors::init(const SurfaceFunc& surface, int tileSize, int regionSize, int cellSize) {
+	if (tileSize <= 0 || cellSize <= 0 || regionSize % tileSize != 0 || tileSize % cellSize != 0
+			|| cellSize > voxel::CompactMesh::MaxExtentX || cellSize > voxel::CompactMesh::MaxExtentZ) {
+		Log::error("Invalid impostor sizes: region %i, tile %i, cell %i", regionSize, tileSize, cellSize);
+		return false;
+	}
+	_surface = surface;
+	_tileSize = tileSize;
+	_regionSize = regionSize;
+	_cellSize = cellSize;
+	_threadPool.init();
+	return true;
+}
+
+void TerrainImpostors::shutdown() {
+	clear();
+	// the queued tasks are dropped - nobody is waiting for them
+	_threadPool.shutdown();
+	core::ScopedLock lock(_lock);
+	_surface = SurfaceFunc();
+}
+
+void TerrainImpostors::clear() {
+	core::ScopedLock lock(_lock);
+	++_generation;
+	_heightmaps.clear();
+	_pending.clear();
+	_ready.clear();
+}
+
+bool TerrainImpostors::generate(const glm::ivec2& mins, ImpostorMesh& impostor, uint32_t generation) {
+	ImpostorHeightmap heightmap;
+	SurfaceFunc surface;
+	{
+		core::ScopedLock lock(_lock);
+		if (generation != _generation) {
+			return false;
+		}
+		auto i = _heightmaps.find(mins);
+		if (i != _heightmaps.end()) {
+			heightmap = i->second;
+		}
+		surface = _surface;
+	}
+	if (heightmap.heights.empty()) {
+		if (!surface) {
+			return false;
+		}
+		generateImpostorHeightmap(surface, mins, _regionSize, _cellSize, heightmap);
+		core::ScopedLock lock(_lock);
+		if (generation != _generation) {
+			return false;
+		}
+		_heightmaps.emplace(mins, heightmap);
+	}
+	buildImpostorMesh(heightmap, _tileSize, impostor);
+	if (!impostor.compact.encode(impostor.mesh)) {
+		Log::error("Failed to encode the impostor mesh at %i:%i", mins.x, mins.y);
+	}
+	return true;
+}
+
+void TerrainImpostors::generate(const glm::ivec2& mins, ImpostorMesh& impostor) {
+	uint32_t generation;
+	{
+		core::ScopedLock lock(_lock);
+		generation = _generation;
+	}
+	generate(mins, impostor, generation);
+}
+
+bool TerrainImpostors::schedule(const glm::ivec2& mins) {
+	uint32_t generation;
+	{
+		core::ScopedLock lock(_lock);
+		if (!_surface || !_pending.insert(mins).second) {
+			return false;
+		}
+		generation = _generation;
+	}
+	_threadPool.enqueue([this, mins, generation] () {
+		ImpostorMesh impostor;
+		if (!generate(mins, impostor, generation)) {
+			return;
+		}
+		core::ScopedLock lock(_lock);
+		if (generation == _generation) {
+			_ready.push(std::move(impostor));
+		}
+	});
+	return true;
+}
+
+bool TerrainImpostors::pop(ImpostorMesh& impostor) {
+	if (!_ready.pop(impostor)) {
+		return false;
+	}
+	core::ScopedLock lock(_lock);
+	_pending.erase(impostor.mins);
+	return true;
+}
+
+void TerrainImpostors::prune(const glm::ivec2& pos, int maxDistance) {
+	core::ScopedLock lock(_lock);
+	for (auto i = _heightmaps.begin(); i != _heightmaps.end();) {
+		const glm::ivec2 d = glm::abs(i->first + _regionSize / 2 - pos);
+		if (d.x > maxDistance || d.y > maxDistance) {
+			i = _heightmaps.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+glm::ivec2 TerrainImpostors::regionPos(int x, int z) const {
+	const float size = (float)_regionSize;
+	return glm::ivec2((int)glm::floor(x / size) * _regionSize, (int)glm::floor(z / size) * _regionSize);
+}
+
+int TerrainImpostors::pending() const {
+	core::ScopedLock lock(_lock);
+	return (int)_pending.size();
+}
+
+int TerrainImpostors::cached() const {
+	core::ScopedLock lock(_lock);
+	return (int)_heightmaps.size();
+}
+
+}
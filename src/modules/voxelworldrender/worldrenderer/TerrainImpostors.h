@@ -0,0 +1,167 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/CompactMesh.h"
+#include "voxel/Mesh.h"
+#include "voxel/Voxel.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/Trace.h"
+#include <glm/vec2.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace voxelworldrender {
+
+/**
+ * @brief Samples the terrain surface at the given world position
+ * @param[out] surface The voxel on top of the terrain column
+ * @return The height of the first voxel above the terrain
+ */
+using SurfaceFunc = std::function<int(int x, int z, voxel::Voxel& surface)>;
+
+/**
+ * @brief The height and color map of one impostor region - one sample per cell
+ *
+ * There is a border of one cell around the region to build the sides towards the neighbouring regions.
+ */
+struct ImpostorHeightmap {
+	glm::ivec2 mins { 0 };
+	int cellSize = 0;
+	/** the amount of cells per side - without the border */
+	int cells = 0;
+	std::vector<int16_t> heights;
+	std::vector<uint8_t> colors;
+
+	/**
+	 * @param[in] x,z The cell coordinates in the range [-1, cells]
+	 */
+	inline int index(int x, int z) const {
+		return (z + 1) * (cells + 2) + x + 1;
+	}
+	inline int height(int x, int z) const {
+		return heights[index(x, z)];
+	}
+	inline uint8_t color(int x, int z) const {
+		return colors[index(x, z)];
+	}
+};
+
+/**
+ * @brief The impostor geometry of one region
+ *
+ * The indices are grouped by mesh tiles. The tiles that are covered by an extracted mesh are skipped while
+ * rendering.
+ */
+struct ImpostorMesh {
+	glm::ivec2 mins { 0 };
+	voxel::Mesh mesh;
+	/** the encoded @c mesh that is uploaded - only filled by @c TerrainImpostors::generate() */
+	voxel::CompactMesh compact;
+	/** the index ranges of the mesh tiles - row by row along the x axis */
+	std::vector<voxel::IndexRange> tileRanges;
+	int tiles = 0;
+	int tileSize = 0;
+	int maxHeight = 0;
+};
+
+/**
+ * @brief Samples the heights and colors of the region with the given size
+ */
+extern void generateImpostorHeightmap(const SurfaceFunc& surface, const glm::ivec2& mins, int size, int cellSize, ImpostorHeightmap& heightmap);
+
+/**
+ * @brief Builds a column per cell - the top face and the sides towards the lower neighbours
+ * @param[in] tileSize The size of the mesh tiles - must be a multiple of the cell size
+ */
+extern void buildImpostorMesh(const ImpostorHeightmap& heightmap, int tileSize, ImpostorMesh& impostor);
+
+/**
+ * @brief Low resolution terrain for the area beyond the extracted meshes
+ *
+ * The heightmaps are generated from the terrain function of the world - no chunk is paged in and no surface
+ * is extracted for them. The generation runs on an own thread - it doesn't compete with the culling and the mesh
+ * extraction. The heightmaps are cached per region, only the meshes are built again if a region comes back into range.
+ */
+class TerrainImpostors {
+private:
+	core::ThreadPool _threadPool;
+	SurfaceFunc _surface;
+	int _tileSize = 0;
+	int _regionSize = 0;
+	int _cellSize = 0;
+
+	std::unordered_map<glm::ivec2, ImpostorHeightmap, std::hash<glm::ivec2> > _heightmaps;
+	std::unordered_set<glm::ivec2, std::hash<glm::ivec2> > _pending;
+	mutable core_trace_mutex(core::Lock, _lock, "TerrainImpostors");
+	core::ConcurrentQueue<ImpostorMesh> _ready;
+	/** bumped by @c clear() - the results of the tasks that were scheduled before are dropped */
+	uint32_t _generation core_thread_guarded_by(_lock) = 0u;
+
+	bool generate(const glm::ivec2& mins, ImpostorMesh& impostor, uint32_t generation);
+
+public:
+	TerrainImpostors();
+
+	/**
+	 * @param[in] tileSize The size of the mesh tiles
+	 * @param[in] regionSize The size of one impostor region - a multiple of the mesh tile size
+	 * @param[in] cellSize The size of one impostor column - the mesh tile size must be a multiple of it. It
+	 * must fit into a compact sub mesh (@c voxel::CompactMesh::MaxExtentX)
+	 */
+	bool init(const SurfaceFunc& surface, int tileSize, int regionSize = 256, int cellSize = 8);
+	void shutdown();
+	/**
+	 * @brief Drops the cached heightmaps and the finished meshes - the running tasks don't deliver their results
+	 */
+	void clear();
+
+	/**
+	 * @brief Builds the impostor mesh of the given region. The heightmap is generated if it's not yet cached.
+	 * @note Thread safe
+	 */
+	void generate(const glm::ivec2& mins, ImpostorMesh& impostor);
+
+	/**
+	 * @brief Generates the impostor mesh for the given region in the background
+	 * @return @c false if the region is already scheduled
+	 * @sa pop()
+	 */
+	bool schedule(const glm::ivec2& mins);
+	/**
+	 * @return @c false if there is no finished impostor mesh
+	 */
+	bool pop(ImpostorMesh& impostor);
+
+	/**
+	 * @brief Drops the cached heightmaps of the regions that are further away than the given distance
+	 */
+	void prune(const glm::ivec2& pos, int maxDistance);
+
+	/**
+	 * @brief Cuts the given world coordinates down to the mins of the region
+	 */
+	glm::ivec2 regionPos(int x, int z) const;
+	int regionSize() const;
+	int pending() const;
+	int cached() const;
+	bool enabled() const;
+};
+
+inline int TerrainImpostors::regionSize() const {
+	return _regionSize;
+}
+
+inline bool TerrainImpostors::enabled() const {
+	return (bool)_surface;
+}
+
+}
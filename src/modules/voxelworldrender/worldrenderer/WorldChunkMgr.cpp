@@ -3,138 +3,361 @@
  */
 
 #include "WorldChunkMgr.h"
+#include "core/GameConfig.h"
+#include "core/TimeProvider.h"
 #include "core/Trace.h"
 #include "video/Trace.h"
 #include "voxel/Constants.h"
-#include "voxelrender/ShaderAttribute.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <chrono>
 
 namespace voxelworldrender {
 
 namespace {
 constexpr double ScaleDuration = 1.5;
+// the impostors are generated on one thread - keep the queue short to react on camera movement
+constexpr int MaxPendingImpostors = 4;
 }
 
 WorldChunkMgr::WorldChunkMgr(core::ThreadPool& threadPool) :
-		_octree({}, 30), _threadPool(threadPool) {
+		_octree(math::AABB<int>(glm::ivec3(-MaxWorldExtent, 0, -MaxWorldExtent),
+				glm::ivec3(MaxWorldExtent, voxel::MAX_HEIGHT + 1, MaxWorldExtent))), _threadPool(threadPool) {
+	resetSlots();
 }
 
 void WorldChunkMgr::updateViewDistance(float viewDistance) {
+	_viewDistance = viewDistance;
 	const glm::vec3 cullingThreshold(_meshExtractor.meshSize());
 	const int maxCullingThreshold = core_max(cullingThreshold.x, cullingThreshold.z) * 4;
 	_maxAllowedDistance = glm::pow(viewDistance + (float)maxCullingThreshold, 2);
+	// the chunks beyond the new distance are evicted with the next update
+	_sortTile = glm::ivec3((std::numeric_limits<int>::min)());
 }
 
 bool WorldChunkMgr::init(shader::WorldShader* worldShader, voxel::PagedVolume* volume) {
 	_worldShader = worldShader;
+	_lodDistance = core::Var::getSafe(cfg::VoxelLODDistance);
+	_lodSelector = voxelrender::LODSelector(_lodDistance->floatVal());
+	_lodDistance->markClean();
+	_uploadBudget = core::Var::getSafe(cfg::VoxelUploadBudget);
+	_occlusionCulling = core::Var::getSafe(cfg::ClientOcclusionCulling);
 	if (!_meshExtractor.init(volume)) {
 		Log::error("Failed to initialize the mesh extractor");
 		return false;
 	}
+	const glm::ivec3& meshSize = _meshExtractor.meshSize();
+	// the extracted region is one voxel lower than the mesh size - the reduced levels of detail are clamped
+	// to it, too (see voxelrender::clampLODMesh())
+	if (meshSize.x > voxel::CompactMesh::MaxExtentX || meshSize.z > voxel::CompactMesh::MaxExtentZ
+			|| meshSize.y - 1 > voxel::CompactMesh::MaxExtentY) {
+		Log::error("The mesh size %i:%i:%i exceeds the compact meshes", meshSize.x, meshSize.y, meshSize.z);
+		return false;
+	}
+	if (!_terrainBuffer.init(worldShader)) {
+		Log::error("Failed to initialize the terrain buffer");
+		return false;
+	}
+	if (video::hasFeature(video::Feature::MultiDrawIndirect) && !_indirectBuffer.init()) {
+		Log::error("Failed to initialize the indirect draw buffer");
+		return false;
+	}
 	return true;
 }
 
+bool WorldChunkMgr::initImpostors(const SurfaceFunc& surface) {
+	return _impostors.init(surface, _meshExtractor.meshSize().x);
+}
+
 void WorldChunkMgr::shutdown() {
+	waitForCulling();
+	resetImpostors();
+	_impostors.shutdown();
 	_meshExtractor.shutdown();
+	_indirectBuffer.shutdown();
+	_terrainBuffer.shutdown();
+}
+
+void WorldChunkMgr::resetSlots() {
+	_chunkSlots.clear();
+	_usedSlots.clear();
+	_freeSlots.clear();
+	_freeSlots.reserve(MAX_CHUNKBUFFERS);
+	// the lowest slots are handed out first
+	for (int i = MAX_CHUNKBUFFERS - 1; i >= 0; --i) {
+		_freeSlots.push_back(i);
+	}
+	_sortTile = glm::ivec3((std::numeric_limits<int>::min)());
+}
+
+void WorldChunkMgr::releaseChunkBuffer(int slot) {
+	ChunkBuffer& chunkBuffer = _chunkBuffers[slot];
+	_terrainBuffer.remove(chunkBuffer.allocation);
+	_chunkSlots.erase(chunkBuffer.aabb().mins());
+	_freeSlots.push_back(slot);
+	chunkBuffer.inuse = false;
+	chunkBuffer.lod = 0;
 }
 
 void WorldChunkMgr::reset() {
+	waitForCulling();
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
 		chunkBuffer.inuse = false;
+		chunkBuffer.lod = 0;
+		chunkBuffer.allocation = TerrainBuffer::Allocation();
 	}
+	resetSlots();
+	resetImpostors();
+	_impostors.clear();
+	_terrainBuffer.clear();
 	_visibleBuffers.size = 0;
 	_meshExtractor.reset();
 	_octree.clear();
 }
 
-void WorldChunkMgr::handleMeshQueue() {
-	voxel::Mesh mesh;
-	if (!_meshExtractor.pop(mesh)) {
+void WorldChunkMgr::resetImpostors() {
+	_impostorBuffers.clear();
+	_visibleImpostors.clear();
+	_impostorRegion = glm::ivec2((std::numeric_limits<int>::min)());
+}
+
+bool WorldChunkMgr::isImpostorInRange(const glm::ivec2& regionMins, const glm::ivec3& focusPos, float distance) const {
+	// the distance to the closest point of the region
+	const int size = _impostors.regionSize();
+	const glm::vec2 focus(focusPos.x, focusPos.z);
+	const glm::vec2 closest = glm::clamp(focus, glm::vec2(regionMins), glm::vec2(regionMins + size));
+	return glm::distance(closest, focus) <= distance;
+}
+
+void WorldChunkMgr::uploadImpostor(const ImpostorMesh& impostor, const glm::ivec3& focusPos) {
+	if (_impostorDistance <= 0.0f || !isImpostorInRange(impostor.mins, focusPos, _impostorDistance)) {
 		return;
 	}
+	const TerrainBuffer::Allocation& allocation = _terrainBuffer.add(impostor.compact);
+	if (!allocation.valid()) {
+		return;
+	}
+	ImpostorBuffer& buffer = _impostorBuffers[impostor.mins];
+	if (buffer.allocation.valid()) {
+		_terrainBuffer.remove(buffer.allocation);
+	}
+	buffer.allocation = allocation;
+	buffer.tileRanges = impostor.tileRanges;
+	buffer.tiles = impostor.tiles;
+	buffer.tileSize = impostor.tileSize;
+	const int size = impostor.tiles * impostor.tileSize;
+	buffer.aabb = math::AABB<int>(glm::ivec3(impostor.mins.x, 0, impostor.mins.y),
+			glm::ivec3(impostor.mins.x + size, impostor.maxHeight, impostor.mins.y + size));
+}
 
-	// Now add the mesh to the list of meshes to render.
-	core_trace_scoped(WorldRendererHandleMeshQueue);
+void WorldChunkMgr::updateImpostors(const glm::ivec3& focusPos) {
+	if (!_impostors.enabled()) {
+		return;
+	}
+	core_trace_scoped(WorldRendererUpdateImpostors);
+	ImpostorMesh impostor;
+	while (_impostors.pop(impostor)) {
+		uploadImpostor(impostor, focusPos);
+	}
 
-	ChunkBuffer* freeChunkBuffer = nullptr;
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (freeChunkBuffer == nullptr && !chunkBuffer.inuse) {
-			freeChunkBuffer = &chunkBuffer;
+	const int size = _impostors.regionSize();
+	const glm::ivec2& region = _impostors.regionPos(focusPos.x, focusPos.z);
+	if (region != _impostorRegion) {
+		_impostorRegion = region;
+		// a region further away than the max distance is dropped - there is a margin of one region to not
+		// drop and rebuild them while moving along a region border
+		const float maxDistance = _impostorDistance + (float)size;
+		for (auto i = _impostorBuffers.begin(); i != _impostorBuffers.end();) {
+			if (_impostorDistance > 0.0f && isImpostorInRange(i->first, focusPos, maxDistance)) {
+				++i;
+				continue;
+			}
+			_terrainBuffer.remove(i->second.allocation);
+			i = _impostorBuffers.erase(i);
 		}
-		// check whether we update an existing one
-		if (chunkBuffer.aabb().mins() == mesh.getOffset()) {
-			freeChunkBuffer = &chunkBuffer;
+		_impostors.prune(glm::ivec2(focusPos.x, focusPos.z), (int)(2.0f * maxDistance));
+	}
+	if (_impostorDistance <= 0.0f || _impostors.pending() >= MaxPendingImpostors) {
+		return;
+	}
+
+	_impostorCandidates.clear();
+	const int regions = (int)glm::ceil(_impostorDistance / (float)size);
+	for (int z = -regions; z <= regions; ++z) {
+		for (int x = -regions; x <= regions; ++x) {
+			const glm::ivec2 mins = region + glm::ivec2(x, z) * size;
+			if (_impostorBuffers.find(mins) != _impostorBuffers.end()) {
+				continue;
+			}
+			if (!isImpostorInRange(mins, focusPos, _impostorDistance)) {
+				continue;
+			}
+			_impostorCandidates.push_back(mins);
+		}
+	}
+	const glm::ivec2 center = region + size / 2;
+	std::sort(_impostorCandidates.begin(), _impostorCandidates.end(), [&] (const glm::ivec2& a, const glm::ivec2& b) {
+		const glm::ivec2 da = a + size / 2 - center;
+		const glm::ivec2 db = b + size / 2 - center;
+		return da.x * da.x + da.y * da.y < db.x * db.x + db.y * db.y;
+	});
+	for (const glm::ivec2& mins : _impostorCandidates) {
+		if (_impostors.pending() >= MaxPendingImpostors) {
 			break;
 		}
+		_impostors.schedule(mins);
 	}
+}
 
-	if (freeChunkBuffer == nullptr) {
-		Log::warn("Could not find free chunk buffer slot");
-		return;
+bool WorldChunkMgr::uploadMesh() {
+	ExtractedMesh extracted;
+	if (!_meshExtractor.pop(extracted)) {
+		return false;
+	}
+	const voxel::CompactMesh& mesh = extracted.mesh;
+	const glm::ivec3& mins = mesh.getOffset();
+	if (_meshExtractor.lod(mins) != extracted.lod) {
+		// another level of detail was scheduled in the meantime
+		return true;
 	}
 
-	video::Buffer& buffer = freeChunkBuffer->_buffer;
-	freeChunkBuffer->_vbo = buffer.create();
-	if (freeChunkBuffer->_vbo == -1) {
-		Log::error("Failed to create vertex buffer");
-		return;
+	// Now add the mesh to the list of meshes to render.
+	core_trace_scoped(WorldRendererHandleMeshQueue);
+
+	// check whether we update an existing one
+	auto i = _chunkSlots.find(mins);
+	const bool update = i != _chunkSlots.end();
+	if (mesh.isEmpty()) {
+		if (update) {
+			// the new level of detail is empty - don't keep rendering the old one
+			const int slot = i->second;
+			_octree.remove(&_chunkBuffers[slot]);
+			releaseChunkBuffer(slot);
+			_usedSlots.erase(std::find(_usedSlots.begin(), _usedSlots.end(), slot));
+		}
+		return true;
 	}
-	const int locationPos = _worldShader->getLocationPos();
-	const video::Attribute& posAttrib = voxelrender::getPositionVertexAttribute(freeChunkBuffer->_vbo, locationPos, _worldShader->getAttributeComponents(locationPos));
-	if (!buffer.addAttribute(posAttrib)) {
-		Log::error("Failed to add position attribute");
-		return;
+	if (!update && _freeSlots.empty()) {
+		Log::warn("Could not find free chunk buffer slot");
+		return true;
 	}
-	const int locationInfo = _worldShader->getLocationInfo();
-	const video::Attribute& infoAttrib = voxelrender::getInfoVertexAttribute(freeChunkBuffer->_vbo, locationInfo, _worldShader->getAttributeComponents(locationInfo));
-	if (!buffer.addAttribute(infoAttrib)) {
-		Log::error("Failed to add info attribute");
-		return;
+
+	const TerrainBuffer::Allocation& allocation = _terrainBuffer.add(mesh);
+	if (!allocation.valid()) {
+		return true;
 	}
-	freeChunkBuffer->_ibo = buffer.create(nullptr, 0, video::BufferType::IndexBuffer);
-	if (freeChunkBuffer->_ibo == -1) {
-		Log::error("Failed to create index buffer");
-		return;
+	const int slot = update ? i->second : _freeSlots.back();
+	ChunkBuffer* chunkBuffer = &_chunkBuffers[slot];
+	if (update) {
+		// the mesh is replaced by another level of detail
+		_terrainBuffer.remove(chunkBuffer->allocation);
 	}
-	freeChunkBuffer->_compressedIndexSize = mesh.compressedIndexSize();
-
-	const voxel::VertexArray& vertices = mesh.getVertexVector();
-	const uint8_t* indices = mesh.compressedIndices();
-	buffer.update(freeChunkBuffer->_vbo, &vertices.front(), vertices.size() * sizeof(voxel::VertexArray::value_type));
-	buffer.update(freeChunkBuffer->_ibo, indices, mesh.getNoOfIndices() * freeChunkBuffer->_compressedIndexSize);
+	chunkBuffer->allocation = allocation;
 
 	const glm::ivec3& size = _meshExtractor.meshSize();
-	const glm::ivec3& mins = mesh.getOffset();
 	const glm::ivec3 maxs(mins.x + size.x, mins.y + size.y, mins.z + size.z);
-	freeChunkBuffer->_aabb = {mins, maxs};
-	if (!_octree.insert(freeChunkBuffer)) {
+	chunkBuffer->_aabb = {mins, maxs};
+	chunkBuffer->lod = extracted.lod;
+	chunkBuffer->solidHeight = extracted.solidHeight;
+	chunkBuffer->hasFaceRanges = mesh.hasFaceIndexRanges();
+	for (int face = 0; face < voxel::FaceCount; ++face) {
+		chunkBuffer->faceRanges[face] = mesh.faceIndexRange((voxel::FaceNames)face);
+	}
+	if (update) {
+		return true;
+	}
+	++chunkBuffer->generation;
+	_freeSlots.pop_back();
+	_chunkSlots.insert(std::make_pair(mins, slot));
+	// keep the used slots sorted by distance
+	const int distance = distance2(mins, _sortPosition);
+	auto pos = std::upper_bound(_usedSlots.begin(), _usedSlots.end(), distance, [this] (int d, int s) {
+		return d < distance2(_chunkBuffers[s].aabb().mins(), _sortPosition);
+	});
+	_usedSlots.insert(pos, slot);
+	if (!_octree.insert(chunkBuffer)) {
 		Log::warn("Failed to insert into octree");
 	}
-	freeChunkBuffer->inuse = true;
-	freeChunkBuffer->scaleSeconds = ScaleDuration;
+	chunkBuffer->inuse = true;
+	chunkBuffer->createdSeconds = _seconds;
+	return true;
 }
 
-void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos) {
-	handleMeshQueue();
-
-	_meshExtractor.updateExtractionOrder(focusPos);
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (!chunkBuffer.inuse) {
-			continue;
+void WorldChunkMgr::handleMeshQueue() {
+	const uint64_t start = core::TimeProvider::highResTime();
+	const uint64_t budget = (uint64_t)(_uploadBudget->floatVal() * (double)core::TimeProvider::highResTimeResolution() / 1000.0);
+	// at least one mesh is uploaded per frame
+	while (uploadMesh()) {
+		if (core::TimeProvider::highResTime() - start >= budget) {
+			break;
 		}
-		chunkBuffer.scaleSeconds -= deltaFrameSeconds;
+	}
+}
+
+int WorldChunkMgr::lod(const glm::ivec3& pos, const glm::vec3& focusPos, int currentLevel) const {
+	if (!_lodSelector.enabled()) {
+		return 0;
+	}
+	const glm::vec3& size = _meshExtractor.meshSize();
+	const glm::vec2 center(pos.x + size.x * 0.5f, pos.z + size.z * 0.5f);
+	return _lodSelector.select(glm::distance(center, glm::vec2(focusPos.x, focusPos.z)), currentLevel);
+}
+
+void WorldChunkMgr::updateSlots(const glm::ivec3& focusPos) {
+	core_trace_scoped(WorldRendererUpdateSlots);
+	_sortPosition = focusPos;
+	std::sort(_usedSlots.begin(), _usedSlots.end(), [this] (int a, int b) {
+		return distance2(_chunkBuffers[a].aabb().mins(), _sortPosition) < distance2(_chunkBuffers[b].aabb().mins(), _sortPosition);
+	});
+	while (!_usedSlots.empty()) {
+		const int slot = _usedSlots.back();
+		ChunkBuffer& chunkBuffer = _chunkBuffers[slot];
 		const glm::ivec3& pos = chunkBuffer.aabb().mins();
-		const int distance = distance2(pos, focusPos);
-		if (distance < _maxAllowedDistance) {
-			continue;
+		if (distance2(pos, focusPos) < _maxAllowedDistance) {
+			break;
 		}
-		core_assert_always(_meshExtractor.allowReExtraction(pos));
-		chunkBuffer.reset();
+		// the extractor might already have dropped the position together with the pending extractions
+		_meshExtractor.allowReExtraction(pos);
 		_octree.remove(&chunkBuffer);
+		releaseChunkBuffer(slot);
+		_usedSlots.pop_back();
 		Log::trace("Remove mesh from %i:%i", pos.x, pos.z);
 	}
+	if (!_lodSelector.enabled()) {
+		return;
+	}
+	for (int slot : _usedSlots) {
+		// the old mesh is rendered until the mesh with the new level of detail arrives
+		const glm::ivec3& pos = _chunkBuffers[slot].aabb().mins();
+		const int currentLod = _meshExtractor.lod(pos);
+		const int newLod = lod(pos, focusPos, currentLod);
+		if (newLod != currentLod) {
+			_meshExtractor.scheduleMeshExtraction(pos, newLod);
+		}
+	}
+}
+
+void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos) {
+	_seconds += deltaFrameSeconds;
+	handleMeshQueue();
+	updateImpostors(glm::ivec3(focusPos));
+
+	bool forceUpdate = false;
+	if (_lodDistance->isDirty()) {
+		_lodSelector = voxelrender::LODSelector(_lodDistance->floatVal());
+		_lodDistance->markClean();
+		forceUpdate = true;
+	}
+
+	_meshExtractor.updateExtractionOrder(focusPos, _maxAllowedDistance);
+	// the eviction and the level of detail only change if the focus moves into another mesh tile
+	const glm::ivec3& focusTile = _meshExtractor.meshPos(focusPos);
+	if (forceUpdate || focusTile != _sortTile) {
+		_sortTile = focusTile;
+		updateSlots(focusPos);
+	}
 
 	cull(camera);
 }
@@ -143,23 +366,61 @@ void WorldChunkMgr::extractScheduledMesh() {
 	_meshExtractor.extractScheduledMesh();
 }
 
-// TODO: put into background task with two states - computing and
-// next - then the indices and vertices are just swapped
+void WorldChunkMgr::waitForCulling() {
+	if (_cullTask.valid()) {
+		_cullTask.wait();
+		_cullTask = std::future<void>();
+	}
+}
+
 void WorldChunkMgr::cull(const video::Camera& camera) {
 	core_trace_scoped(WorldRendererCull);
 
-	math::AABB<float> aabb = camera.frustum().aabb();
-	// don't cull objects that might cast shadows
-	aabb.shift(camera.forward() * -10.0f);
-
-	size_t index = 0;
-	Tree::Contents contents;
-	_octree.query(math::AABB<int>(aabb.mins(), aabb.maxs()), contents);
+	if (_cullTask.valid()) {
+		if (_cullTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			// keep the visible chunks of the last result
+			return;
+		}
+		_cullTask.get();
+		size_t index = 0;
+		for (int idx : _cullVisible) {
+			const CullChunk& chunk = _cullInput.chunks[idx];
+			ChunkBuffer* chunkBuffer = &_chunkBuffers[chunk.slot];
+			// the slot was reused or freed while the culling was running
+			if (!chunkBuffer->inuse || chunkBuffer->generation != chunk.generation) {
+				continue;
+			}
+			_visibleBuffers.visible[index++] = chunkBuffer;
+		}
+		_visibleBuffers.size = index;
+	}
 
-	for (ChunkBuffer* chunkBuffer : contents) {
-		_visibleBuffers.visible[index++] = chunkBuffer;
+	_visibleImpostors.clear();
+	const math::Frustum& frustum = camera.frustum();
+	for (const auto& e : _impostorBuffers) {
+		const math::AABB<int>& aabb = e.second.aabb;
+		if (frustum.isVisible(glm::vec3(aabb.mins()), glm::vec3(aabb.maxs()))) {
+			_visibleImpostors.push_back(&e.second);
+		}
 	}
-	_visibleBuffers.size = index;
+
+	_cullInput.frustum = camera.frustum();
+	_cullInput.viewProjection = camera.viewProjectionMatrix();
+	_cullInput.eye = camera.position();
+	_cullInput.occlusion = _occlusionCulling->boolVal();
+	_cullInput.chunks.clear();
+	_octree.visit(_cullInput.frustum, [this] (const ChunkBuffer* chunkBuffer) {
+		CullChunk chunk;
+		chunk.mins = chunkBuffer->aabb().mins();
+		chunk.maxs = chunkBuffer->aabb().maxs();
+		chunk.solidHeight = (float)chunkBuffer->solidHeight;
+		chunk.slot = (int)(chunkBuffer - _chunkBuffers);
+		chunk.generation = chunkBuffer->generation;
+		_cullInput.chunks.push_back(chunk);
+	}, _cullInput.frustumMargin);
+	_cullTask = _threadPool.enqueue([this] () {
+		_culler.cull(_cullInput, _cullVisible);
+	});
 }
 
 int WorldChunkMgr::distance2(const glm::ivec3& pos, const glm::ivec3& pos2) const {
@@ -172,7 +433,8 @@ int WorldChunkMgr::distance2(const glm::ivec3& pos, const glm::ivec3& pos2) cons
 void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	core_trace_scoped(WorldRendererExtractMeshes);
 
-	const float farplane = camera.farPlane();
+	// the far plane includes the area that is covered by the impostors
+	const float farplane = _viewDistance > 0.0f ? glm::min(camera.farPlane(), _viewDistance) : camera.farPlane();
 
 	glm::vec3 mins = camera.position();
 	mins.x -= farplane;
@@ -184,36 +446,122 @@ void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	maxs.y = voxel::MAX_HEIGHT;
 	maxs.z += farplane;
 
-	_octree.visit(mins, maxs, [&] (const glm::ivec3& mins, const glm::ivec3& maxs) {
-		return !_meshExtractor.scheduleMeshExtraction(mins);
-	}, glm::vec3(_meshExtractor.meshSize()));
+	const glm::vec3& cameraPos = camera.position();
+	const glm::ivec3 imaxs(maxs);
+	const glm::ivec3& size = _meshExtractor.meshSize();
+	glm::ivec3 pos;
+	for (pos.x = (int)mins.x; pos.x < imaxs.x; pos.x += size.x) {
+		for (pos.y = (int)mins.y; pos.y < imaxs.y; pos.y += size.y) {
+			for (pos.z = (int)mins.z; pos.z < imaxs.z; pos.z += size.z) {
+				if (_meshExtractor.lod(pos) != -1) {
+					// level of detail changes are handled in update()
+					continue;
+				}
+				if (_meshExtractor.scheduleMeshExtraction(pos, lod(pos, cameraPos))) {
+					break;
+				}
+			}
+		}
+	}
 }
 
 void WorldChunkMgr::extractMesh(const glm::ivec3& pos) {
 	_meshExtractor.scheduleMeshExtraction(pos);
 }
 
-int WorldChunkMgr::renderTerrain() {
+void WorldChunkMgr::addImpostorCommands(const ImpostorBuffer& impostor) {
+	// the tile ranges follow each other in the index buffer - the ranges between the covered tiles are merged
+	voxel::IndexRange merged;
+	const glm::ivec3& mins = impostor.aabb.mins();
+	for (int tz = 0; tz < impostor.tiles; ++tz) {
+		for (int tx = 0; tx < impostor.tiles; ++tx) {
+			const voxel::IndexRange& range = impostor.tileRanges[tz * impostor.tiles + tx];
+			const glm::ivec3 tilePos(mins.x + tx * impostor.tileSize, 0, mins.z + tz * impostor.tileSize);
+			if (_chunkSlots.find(tilePos) != _chunkSlots.end()) {
+				if (merged.count > 0u) {
+					_terrainBuffer.commands(impostor.allocation, merged.offset, merged.count, _drawCommands);
+					merged.count = 0u;
+				}
+				continue;
+			}
+			if (merged.count == 0u) {
+				merged.offset = range.offset;
+			}
+			merged.count += range.count;
+		}
+	}
+	if (merged.count > 0u) {
+		_terrainBuffer.commands(impostor.allocation, merged.offset, merged.count, _drawCommands);
+	}
+}
+
+int WorldChunkMgr::renderTerrain(const glm::vec3* eye) {
 	video_trace_scoped(WorldChunkMgrRenderTerrain);
 	int drawCalls = 0;
+	if (_visibleBuffers.size == 0 && _visibleImpostors.empty()) {
+		return drawCalls;
+	}
 
+	_drawCommands.clear();
+	_terrainBuffer.bind();
 	for (int i = 0; i < _visibleBuffers.size; ++i) {
 		ChunkBuffer& chunkBuffer = *_visibleBuffers.visible[i];
-		core_assert(chunkBuffer.inuse);
-		const video::Buffer& buffer = chunkBuffer._buffer;
-		const int ibo = chunkBuffer._ibo;
-		const uint32_t numIndices = buffer.elements(ibo, 1, chunkBuffer._compressedIndexSize);
-		core_assert_msg(numIndices > 0u, "Empty meshes should not be part of the array");
-		video::ScopedBuffer scopedBuf(buffer);
+		if (!chunkBuffer.inuse) {
+			// removed after the culling result was published
+			continue;
+		}
+		core_assert_msg(chunkBuffer.allocation.valid(), "Empty meshes should not be part of the array");
+		const double scaleSeconds = ScaleDuration - (_seconds - chunkBuffer.createdSeconds);
+		if (scaleSeconds <= 0.0 || !_worldShader->isActive()) {
+			if (eye == nullptr || !chunkBuffer.hasFaceRanges) {
+				_terrainBuffer.commands(chunkBuffer.allocation, _drawCommands);
+				continue;
+			}
+			// only submit the faces that are pointing towards the viewer
+			// the reduced levels of detail might be a few voxels bigger than the chunk
+			const math::AABB<int>& aabb = chunkBuffer.aabb();
+			const glm::vec3 maxs = glm::vec3(aabb.maxs()) + (float)(1 << chunkBuffer.lod);
+			const uint8_t faceMask = voxel::visibleFaces(*eye, glm::vec3(aabb.mins()), maxs);
+			voxel::IndexRange ranges[voxel::FaceCount];
+			const int n = voxel::mergeFaceIndexRanges(chunkBuffer.faceRanges, faceMask, ranges);
+			for (int r = 0; r < n; ++r) {
+				_terrainBuffer.commands(chunkBuffer.allocation, ranges[r].offset, ranges[r].count, _drawCommands);
+			}
+			continue;
+		}
+		// chunks that are still growing in need their own model matrix
+		const double delta = glm::clamp(scaleSeconds / ScaleDuration, 0.0, 1.0);
+		const glm::vec3& size = glm::mix(glm::vec3(1.0f), glm::vec3(1.0f, 0.4f, 1.0f), (float)delta);
+		_worldShader->setModel(glm::scale(size));
+		_growingCommands.clear();
+		_terrainBuffer.commands(chunkBuffer.allocation, _growingCommands);
+		for (const video::DrawElementsIndirectCommand& cmd : _growingCommands) {
+			_terrainBuffer.draw(cmd);
+			++drawCalls;
+		}
+	}
+	for (const ImpostorBuffer* impostor : _visibleImpostors) {
+		addImpostorCommands(*impostor);
+	}
+
+	if (!_drawCommands.empty()) {
 		if (_worldShader->isActive()) {
-			const double delta = glm::clamp(core_max(0.0, chunkBuffer.scaleSeconds) / ScaleDuration, 0.0, 1.0);
-			const glm::vec3& size = glm::mix(glm::vec3(1.0f), glm::vec3(1.0f, 0.4f, 1.0f), (float)delta);
-			const glm::mat4& model = glm::scale(size);
-			_worldShader->setModel(model);
+			_worldShader->setModel(glm::mat4(1.0f));
+		}
+		if (video::hasFeature(video::Feature::MultiDrawIndirect)) {
+			_indirectBuffer.update(_drawCommands.data(), _drawCommands.size() * sizeof(video::DrawElementsIndirectCommand));
+			_indirectBuffer.bind();
+			video::drawMultiElementsIndirect<voxel::CompactIndexType>(video::Primitive::Triangles, nullptr, _drawCommands.size());
+			_indirectBuffer.unbind();
+			++drawCalls;
+		} else {
+			for (const video::DrawElementsIndirectCommand& cmd : _drawCommands) {
+				_terrainBuffer.draw(cmd);
+				++drawCalls;
+			}
 		}
-		video::drawElements(video::Primitive::Triangles, numIndices, chunkBuffer._compressedIndexSize);
-		++drawCalls;
 	}
+	_terrainBuffer.unbind();
 	return drawCalls;
 }
 
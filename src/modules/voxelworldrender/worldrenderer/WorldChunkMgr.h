@@ -4,14 +4,22 @@
 
 #pragma once
 
-#include "math/Octree.h"
+#include "math/LinearOctree.h"
 #include "WorldMeshExtractor.h"
 #include "video/Camera.h"
 #include "voxel/VoxelVertex.h"
 #include "WorldShader.h"
 #include "voxel/Mesh.h"
-#include "video/Buffer.h"
+#include "video/IndirectDrawBuffer.h"
+#include "TerrainBuffer.h"
+#include "ChunkCuller.h"
+#include "TerrainImpostors.h"
+#include "voxelrender/LOD.h"
+#include "core/Var.h"
 #include <future>
+#include <vector>
+#include <unordered_map>
+#include <limits>
 
 namespace voxelworldrender {
 
@@ -19,24 +27,20 @@ class WorldChunkMgr {
 protected:
 	struct ChunkBuffer {
 		bool inuse = false;
-		double scaleSeconds = 0.0;
+		/** the time the mesh was added - used for the grow animation */
+		double createdSeconds = 0.0;
+		/** the level of detail the mesh in this buffer was extracted with */
+		int lod = 0;
 		math::AABB<int> _aabb = {glm::ivec3(0), glm::ivec3(0)};
-		size_t _compressedIndexSize = 0;
-
-		video::Buffer _buffer;
-		int32_t _vbo = -1;
-		int32_t _ibo = -1;
-
-		~ChunkBuffer() {
-			reset();
-		}
-
-		void reset() {
-			_buffer.shutdown();
-			_vbo = -1;
-			_ibo = -1;
-			inuse = false;
-		}
+		/** the ranges of the mesh in the terrain buffer */
+		TerrainBuffer::Allocation allocation;
+		/** @sa ExtractedMesh::solidHeight */
+		int solidHeight = 0;
+		/** increased whenever the slot is used for another chunk */
+		uint32_t generation = 0u;
+		/** @sa voxel::Mesh::faceIndexRanges() - only valid if @c hasFaceRanges is @c true */
+		voxel::IndexRange faceRanges[voxel::FaceCount];
+		bool hasFaceRanges = false;
 
 		/**
 		 * This is the render aabb. There might be a scale applied here. So the mins of
@@ -48,11 +52,44 @@ protected:
 	};
 
 
-	using Tree = math::Octree<ChunkBuffer *>;
+	/** the chunks outside of this distance on the x and z axis can't be rendered */
+	static constexpr int MaxWorldExtent = 1 << 20;
+	using Tree = math::LinearOctree<ChunkBuffer *>;
+	/** the chunks in the frustum are the candidates for the culling */
 	Tree _octree;
 	static constexpr int MAX_CHUNKBUFFERS = 2048;
 	ChunkBuffer _chunkBuffers[MAX_CHUNKBUFFERS];
 	int _maxAllowedDistance = -1;
+	float _viewDistance = 0.0f;
+
+	// maps the mesh tile position to the index in _chunkBuffers
+	std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > _chunkSlots;
+	// indices of the unused slots in _chunkBuffers
+	std::vector<int> _freeSlots;
+	// indices of the used slots in _chunkBuffers - sorted by their distance to _sortPosition
+	std::vector<int> _usedSlots;
+	glm::ivec3 _sortPosition { 0 };
+	glm::ivec3 _sortTile { (std::numeric_limits<int>::min)() };
+	double _seconds = 0.0;
+
+	/**
+	 * @brief The uploaded impostor mesh of one region
+	 */
+	struct ImpostorBuffer {
+		TerrainBuffer::Allocation allocation;
+		/** @sa ImpostorMesh::tileRanges */
+		std::vector<voxel::IndexRange> tileRanges;
+		int tiles = 0;
+		int tileSize = 0;
+		math::AABB<int> aabb = {glm::ivec3(0), glm::ivec3(0)};
+	};
+	TerrainImpostors _impostors;
+	std::unordered_map<glm::ivec2, ImpostorBuffer, std::hash<glm::ivec2> > _impostorBuffers;
+	std::vector<const ImpostorBuffer*> _visibleImpostors;
+	std::vector<glm::ivec2> _impostorCandidates;
+	/** the impostors are rendered up to this distance - @c 0 disables them */
+	float _impostorDistance = 0.0f;
+	glm::ivec2 _impostorRegion { (std::numeric_limits<int>::min)() };
 
 	struct VisibleBuffers {
 		int size = 0;
@@ -62,17 +99,75 @@ protected:
 
 	shader::WorldShader* _worldShader;
 
+	// the culling runs in the background and publishes the visible chunks for the next frame
+	ChunkCuller _culler;
+	CullInput _cullInput;
+	std::vector<int> _cullVisible;
+	std::future<void> _cullTask;
+	core::VarPtr _occlusionCulling;
+
+	TerrainBuffer _terrainBuffer;
+	video::IndirectDrawBuffer _indirectBuffer;
+	std::vector<video::DrawElementsIndirectCommand> _drawCommands;
+	/** the commands of a chunk that is still growing in - rendered with its own model matrix */
+	std::vector<video::DrawElementsIndirectCommand> _growingCommands;
+
 	WorldMeshExtractor _meshExtractor;
 	core::ThreadPool &_threadPool;
 
-	int distance2(const glm::ivec3 &pos, const glm::ivec3 &pos2) const;
+	core::VarPtr _lodDistance;
+	core::VarPtr _uploadBudget;
+	voxelrender::LODSelector _lodSelector;
 
+	int distance2(const glm::ivec3 &pos, const glm::ivec3 &pos2) const;
+	/**
+	 * @return The level of detail for the mesh tile at the given position
+	 * @param[in] currentLevel The level the tile is currently rendered with or @c -1
+	 */
+	int lod(const glm::ivec3 &pos, const glm::vec3 &focusPos, int currentLevel = -1) const;
+
+	/**
+	 * @brief Publishes the result of the last culling task and starts a new one for the given camera
+	 */
 	void cull(const video::Camera &camera);
+	void waitForCulling();
+	void resetSlots();
+	void releaseChunkBuffer(int slot);
+	/**
+	 * @brief Sorts the used slots by their distance to the given position, removes the slots that are too far
+	 * away and schedules the level of detail changes.
+	 */
+	void updateSlots(const glm::ivec3 &focusPos);
+	/**
+	 * @brief Uploads the extracted meshes until the per frame time budget is used up
+	 * @sa cfg::VoxelUploadBudget
+	 */
 	void handleMeshQueue();
+	/**
+	 * @return @c false if there was no mesh in the queue
+	 */
+	bool uploadMesh();
+	/**
+	 * @brief Uploads the finished impostor meshes, drops the ones that are out of range and schedules the
+	 * generation of the missing ones - closest first
+	 */
+	void updateImpostors(const glm::ivec3 &focusPos);
+	void uploadImpostor(const ImpostorMesh &impostor, const glm::ivec3 &focusPos);
+	bool isImpostorInRange(const glm::ivec2 &regionMins, const glm::ivec3 &focusPos, float distance) const;
+	void resetImpostors();
+	/**
+	 * @brief Adds the draw commands for the impostor tiles that are not covered by an extracted mesh
+	 */
+	void addImpostorCommands(const ImpostorBuffer &impostor);
 public:
 	WorldChunkMgr(core::ThreadPool& threadPool);
 
-	int renderTerrain();
+	/**
+	 * @param[in] eye If not @c nullptr, the faces of the chunks that are pointing away from this position are
+	 * not rendered. Passes that are not rendered from the camera position (e.g. the shadow maps) need all faces.
+	 * @return The amount of draw calls
+	 */
+	int renderTerrain(const glm::vec3* eye = nullptr);
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
@@ -81,9 +176,33 @@ public:
 	void update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos);
 
 	void updateViewDistance(float viewDistance);
+	/**
+	 * @brief Renders the low resolution terrain impostors up to the given distance - they fill the area
+	 * beyond the extracted meshes
+	 * @param[in] distance @c 0 disables the impostors
+	 */
+	void updateImpostorDistance(float distance);
+	/**
+	 * @brief Enables the terrain impostors
+	 * @param[in] surface Samples the terrain surface for the impostor heightmaps
+	 * @note Must be called after @c init()
+	 */
+	bool initImpostors(const SurfaceFunc& surface);
+	/**
+	 * @brief The seed of the world the volume belongs to - the extracted meshes are cached per seed
+	 */
+	void setSeed(uint32_t seed);
 	bool init(shader::WorldShader* worldShader, voxel::PagedVolume* volume);
 	void shutdown();
 	void reset();
 };
 
+inline void WorldChunkMgr::updateImpostorDistance(float distance) {
+	_impostorDistance = distance;
+}
+
+inline void WorldChunkMgr::setSeed(uint32_t seed) {
+	_meshExtractor.setSeed(seed);
+}
+
 }
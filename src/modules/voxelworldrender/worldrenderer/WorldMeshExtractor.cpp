@@ -4,28 +4,40 @@
 
 #include "WorldMeshExtractor.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/GameConfig.h"
+#include "core/Hash.h"
+#include "core/Log.h"
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Constants.h"
+#include "voxelrender/LOD.h"
 
 namespace voxelworldrender {
 
+namespace {
+/** extracted meshes that are not yet uploaded count as in-flight, too */
+constexpr int MaxInFlightPerWorker = 16;
+}
+
 WorldMeshExtractor::WorldMeshExtractor() {
 }
 
-bool WorldMeshExtractor::init(voxel::PagedVolume *volume) {
+bool WorldMeshExtractor::init(voxel::PagedVolume *volume, int workers) {
 	_volume = volume;
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_scheduler.init(_meshSize->intVal(), glm::max(1, workers) * MaxInFlightPerWorker);
+	const int cacheSize = core::Var::getSafe(cfg::ClientMeshCacheSize)->intVal();
+	_meshCache.init("worldmeshes.cache", (size_t)glm::max(0, cacheSize) * 1024u * 1024u);
 	return true;
 }
 
 void WorldMeshExtractor::shutdown() {
-	_pendingExtraction.clear();
-	_pendingExtraction.abortWait();
-	_extracted.clear();
+	_scheduler.clear();
+	_scheduler.abortWait();
 	_extracted.abortWait();
 	_positionsExtracted.clear();
-	_extracted.clear();
+	dropExtracted();
+	_meshCache.shutdown();
 	_volume = nullptr;
 }
 
@@ -33,14 +45,25 @@ void WorldMeshExtractor::reset() {
 	if (_volume != nullptr) {
 		_volume->flushAll();
 	}
-	_extracted.clear();
+	dropExtracted();
 	_positionsExtracted.clear();
-	_pendingExtraction.clear();
+	_scheduler.clear();
+}
+
+void WorldMeshExtractor::dropExtracted() {
+	ExtractedMesh dropped;
+	while (_extracted.pop(dropped)) {
+		_scheduler.finish();
+	}
 }
 
-bool WorldMeshExtractor::pop(voxel::Mesh& item) {
+bool WorldMeshExtractor::pop(ExtractedMesh& item) {
 	core_trace_value_scoped(QueryNewMesh, _positionsExtracted.size());
-	return _extracted.pop(item);
+	if (!_extracted.pop(item)) {
+		return false;
+	}
+	_scheduler.finish();
+	return true;
 }
 
 glm::ivec3 WorldMeshExtractor::meshPos(const glm::ivec3& pos) const {
@@ -56,15 +79,21 @@ glm::ivec3 WorldMeshExtractor::meshSize() const {
 	return glm::ivec3(s, voxel::MAX_MESH_CHUNK_HEIGHT, s);
 }
 
-void WorldMeshExtractor::updateExtractionOrder(const glm::ivec3& sortPos) {
-	core_trace_value_scoped(SortExtractionOrder, _pendingExtraction.size());
-	const glm::ivec3& d = glm::abs(_pendingExtractionSortPosition - sortPos);
-	const int allowedDelta = 3 * _meshSize->intVal();
-	if (d.x < allowedDelta && d.z < allowedDelta) {
+void WorldMeshExtractor::updateExtractionOrder(const glm::ivec3& sortPos, int maxDistance2) {
+	_scheduler.trace();
+	if (!_scheduler.updateFocus(sortPos, maxDistance2) || maxDistance2 < 0) {
 		return;
 	}
-	_pendingExtractionSortPosition = sortPos;
-	_pendingExtraction.setComparator(CloseToPoint(sortPos));
+	core_trace_value_scoped(PruneExtractedPositions, _positionsExtracted.size());
+	// the canceled extractions and the meshes that are out of range are allowed to get extracted again
+	for (auto i = _positionsExtracted.begin(); i != _positionsExtracted.end();) {
+		const glm::ivec2 d(i->first.x - sortPos.x, i->first.z - sortPos.z);
+		if (d.x * d.x + d.y * d.y >= maxDistance2) {
+			i = _positionsExtracted.erase(i);
+		} else {
+			++i;
+		}
+	}
 }
 
 bool WorldMeshExtractor::allowReExtraction(const glm::ivec3& pos) {
@@ -75,37 +104,140 @@ bool WorldMeshExtractor::allowReExtraction(const glm::ivec3& pos) {
 // Extract the surface for the specified region of the volume.
 // The surface extractor outputs the mesh in an efficient compressed format which
 // is not directly suitable for rendering.
-bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p) {
+bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p, int lod) {
 	const glm::ivec3& pos = meshPos(p);
-	auto i = _positionsExtracted.insert(pos);
+	auto i = _positionsExtracted.insert(std::make_pair(pos, lod));
 	if (!i.second) {
+		if (i.first->second == lod) {
+			return false;
+		}
+		i.first->second = lod;
+	}
+	if (!_scheduler.schedule(pos, lod)) {
+		_positionsExtracted.erase(i.first);
 		return false;
 	}
-	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i)",
-			p.x, p.y, p.z, pos.x, pos.y, pos.z);
-	_pendingExtraction.push(pos);
+	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i) with lod %i",
+			p.x, p.y, p.z, pos.x, pos.y, pos.z, lod);
 	return true;
 }
 
+int WorldMeshExtractor::lod(const glm::ivec3& pos) const {
+	auto i = _positionsExtracted.find(meshPos(pos));
+	if (i == _positionsExtracted.end()) {
+		return -1;
+	}
+	return i->second;
+}
+
+int WorldMeshExtractor::solidHeight(const voxel::Region& region) const {
+	core_trace_scoped(MeshExtractionSolidHeight);
+	int height = region.getHeightInVoxels();
+	voxel::PagedVolume::Sampler sampler(_volume);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			sampler.setPosition(x, region.getLowerY(), z);
+			int columnHeight = 0;
+			while (columnHeight < height) {
+				const voxel::VoxelType material = sampler.voxel().getMaterial();
+				if (voxel::isEnterable(material) || voxel::isLeaves(material)) {
+					break;
+				}
+				++columnHeight;
+				sampler.movePositiveY();
+			}
+			height = columnHeight;
+			if (height == 0) {
+				return 0;
+			}
+		}
+	}
+	return height;
+}
+
+uint32_t WorldMeshExtractor::contentHash(const voxel::Region& region) const {
+	core_trace_scoped(MeshExtractionContentHash);
+	// the extraction culls the faces against the neighbours of the region
+	const glm::ivec3 mins = region.getLowerCorner() - 1;
+	const glm::ivec3 maxs = region.getUpperCorner() + 1;
+	const int height = maxs.y - mins.y + 1;
+	std::vector<voxel::Voxel> column(height);
+	uint32_t hash = 0u;
+	voxel::PagedVolume::Sampler sampler(_volume);
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t x = mins.x; x <= maxs.x; ++x) {
+			sampler.setPosition(x, mins.y, z);
+			for (int y = 0; y < height; ++y) {
+				column[y] = sampler.voxel();
+				sampler.movePositiveY();
+			}
+			hash = core::hash(column.data(), (int)(column.size() * sizeof(voxel::Voxel)), hash);
+		}
+	}
+	return hash;
+}
+
+void WorldMeshExtractor::push(ExtractedMesh&& extracted) {
+	// empty meshes are handed over, too - they replace the mesh of another level of detail
+	_extracted.push(std::move(extracted));
+}
+
+int WorldMeshExtractor::extractMesh(const voxel::Region& region, int lod, voxel::Mesh& mesh) const {
+	if (lod > 0) {
+		voxelrender::extractLODMesh(_volume, region, lod, &mesh, voxel::IsQuadNeeded());
+		return 0;
+	}
+	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	// the reduced levels of detail might have holes where the full resolution volume is solid - so
+	// only the full resolution meshes are used as occluders
+	return solidHeight(region);
+}
+
 void WorldMeshExtractor::extractScheduledMesh() {
-	decltype(_pendingExtraction)::Key pos;
-	if (!_pendingExtraction.waitAndPop(pos)) {
+	ExtractionRequest pending;
+	if (!_scheduler.waitAndPop(pending)) {
 		return;
 	}
+	const glm::ivec3& pos = pending.pos;
 	core_trace_scoped(MeshExtraction);
 	const glm::ivec3& size = meshSize();
 	const glm::ivec3 mins(pos);
 	const glm::ivec3 maxs(pos.x + size.x - 1, pos.y + size.y - 2, pos.z + size.z - 1);
 	const voxel::Region region(mins, maxs);
+	ExtractedMesh extracted;
+	extracted.lod = pending.lod;
+	MeshCacheKey key;
+	if (_meshCache.enabled()) {
+		key.seed = _seed;
+		key.pos = pos;
+		key.lod = pending.lod;
+		key.contentHash = contentHash(region);
+		if (_meshCache.get(key, extracted.mesh, extracted.solidHeight)) {
+			push(std::move(extracted));
+			return;
+		}
+	}
 	// these numbers are made up mostly by try-and-error - we need to revisit them from time to time to prevent extra mem allocs
 	// they also heavily depend on the size of the mesh region we extract
 	const int factor = 64;
 	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
 	voxel::Mesh mesh(vertices, vertices);
-	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
-	if (!mesh.isEmpty()) {
-		_extracted.push(std::move(mesh));
+	extracted.solidHeight = extractMesh(region, pending.lod, mesh);
+	if (!extracted.mesh.encode(mesh) && pending.lod > 0) {
+		// the full resolution always fits into the compact meshes - see WorldChunkMgr::init()
+		Log::warn("Failed to encode the mesh at %i:%i:%i with lod %i - use the full resolution",
+				pos.x, pos.y, pos.z, pending.lod);
+		mesh.clear();
+		extracted.solidHeight = extractMesh(region, 0, mesh);
+		extracted.mesh.encode(mesh);
 	}
+	if (extracted.mesh.isEmpty() && !mesh.isEmpty()) {
+		Log::error("Failed to encode the mesh at %i:%i:%i", pos.x, pos.y, pos.z);
+		_scheduler.finish();
+		return;
+	}
+	_meshCache.put(key, extracted.mesh, extracted.solidHeight);
+	push(std::move(extracted));
 }
 
-}
\ No newline at end of file
+}
@@ -4,43 +4,76 @@
 
 #pragma once
 
-#include "voxel/Mesh.h"
+#include "ExtractionScheduler.h"
+#include "MeshCache.h"
+#include "voxel/CompactMesh.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/Var.h"
 #include "core/collection/ConcurrentPriorityQueue.h"
 #include "voxel/PagedVolume.h"
 #include "core/concurrent/Atomic.h"
 
-#include <unordered_set>
+#include <unordered_map>
 #include <glm/vec3.hpp>
+#include <glm/vector_relational.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
 namespace voxelworldrender {
 
-typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
+/**
+ * @brief Maps the mesh tile positions to the level of detail they are extracted with
+ */
+typedef std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > PositionLODMap;
+
+/**
+ * @brief A mesh together with the level of detail it was extracted with
+ *
+ * The mesh is already encoded on the extraction thread - it is uploaded as it is.
+ */
+struct ExtractedMesh {
+	voxel::CompactMesh mesh;
+	int lod = 0;
+	/** the height above the lower corner up to which every column of the mesh tile is solid */
+	int solidHeight = 0;
+
+	inline bool operator<(const ExtractedMesh& rhs) const {
+		return glm::all(glm::lessThan(mesh.getOffset(), rhs.mesh.getOffset()));
+	}
+};
 
 class WorldMeshExtractor {
 private:
-	core::ConcurrentPriorityQueue<voxel::Mesh> _extracted;
-	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
-	struct CloseToPoint {
-		glm::ivec2 _refPoint;
-		CloseToPoint(const glm::ivec3& refPoint) : _refPoint(refPoint.x, refPoint.z) {
-		}
-		inline int distanceToSortPos(const glm::ivec3 &pos) const {
-			const glm::ivec2 d(_refPoint.x - pos.x, _refPoint.y - pos.z);
-			return d.x * d.x + d.y * d.y;
-		}
-		inline bool operator()(const glm::ivec3& lhs, const glm::ivec3& rhs) const {
-			return distanceToSortPos(lhs) > distanceToSortPos(rhs);
-		}
-	};
-
-	core::ConcurrentPriorityQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
+	core::ConcurrentPriorityQueue<ExtractedMesh> _extracted;
+	ExtractionScheduler _scheduler;
 	// fast lookup for positions that are already extracted
-	PositionSet _positionsExtracted;
+	PositionLODMap _positionsExtracted;
 	core::VarPtr _meshSize;
+	MeshCache _meshCache;
+	uint32_t _seed = 0u;
+
+	/**
+	 * @return The height above the lower corner of the region up to which every column is solid and opaque
+	 */
+	int solidHeight(const voxel::Region& region) const;
+	/**
+	 * @return The hash of all voxels the extraction of the given region is looking at - this includes the
+	 * neighbours of the region
+	 */
+	uint32_t contentHash(const voxel::Region& region) const;
+	/**
+	 * @brief Extracts the mesh of the given region with the given level of detail
+	 * @return The solid height of the region - always @c 0 for the reduced levels of detail
+	 */
+	int extractMesh(const voxel::Region& region, int lod, voxel::Mesh& mesh) const;
+	/**
+	 * @brief Hands the encoded mesh over to the render thread - even if it is empty
+	 */
+	void push(ExtractedMesh&& extracted);
+	/**
+	 * @brief Drops the meshes that were not yet fetched and frees their in-flight slots
+	 */
+	void dropExtracted();
 	voxel::PagedVolume *_volume = nullptr;
 
 public:
@@ -52,7 +85,7 @@ public:
 	 * @brief We need to pop the mesh extractor queue to find out if there are new and ready to use meshes for us
 	 * @return @c false if this isn't the case, @c true if the given reference was filled with valid data.
 	 */
-	bool pop(voxel::Mesh& item);
+	bool pop(ExtractedMesh& item);
 
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
@@ -63,19 +96,37 @@ public:
 
 	/**
 	 * @brief Reorder the scheduled extraction commands that the closest chunks to the given position are handled first
+	 * @param[in] maxDistance2 The squared distance on the x and z axis - scheduled extractions that are further away
+	 * are canceled and may get scheduled again. @c -1 for unlimited.
 	 */
-	void updateExtractionOrder(const glm::ivec3& sortPos);
+	void updateExtractionOrder(const glm::ivec3& sortPos, int maxDistance2 = -1);
 
 	/**
 	 * @brief Performs async mesh extraction. You need to call @c pop in order to see if some extraction is ready.
 	 *
 	 * @param[in] pos A world vector that is automatically converted into a mesh tile vector
-	 * @note This will not allow to reschedule an extraction for the same area until @c allowReExtraction was called.
+	 * @param[in] lod The level of detail to extract the mesh with
+	 * @note This will not allow to reschedule an extraction for the same area and level of detail until
+	 * @c allowReExtraction was called. Scheduling another level of detail replaces the current one.
+	 * @return @c false if the extraction is already scheduled or the position is outside of the max distance
+	 */
+	bool scheduleMeshExtraction(const glm::ivec3& pos, int lod = 0);
+
+	/**
+	 * @return The level of detail the mesh tile at the given position was scheduled with the last time,
+	 * @c -1 if there is no extraction for this position.
 	 */
-	bool scheduleMeshExtraction(const glm::ivec3& pos);
+	int lod(const glm::ivec3& pos) const;
 
 	void reset();
 
+	/**
+	 * @brief The seed of the world is part of the key for the cached meshes
+	 */
+	void setSeed(uint32_t seed);
+
+	const MeshCache& meshCache() const;
+
 	/**
 	 * @brief Cuts the given world coordinate down to mesh tile vectors
 	 */
@@ -83,8 +134,25 @@ public:
 
 	glm::ivec3 meshSize() const;
 
-	bool init(voxel::PagedVolume *volume);
+	const ExtractionScheduler& scheduler() const;
+
+	/**
+	 * @param[in] workers The amount of threads that are calling @c extractScheduledMesh()
+	 */
+	bool init(voxel::PagedVolume *volume, int workers = 1);
 	void shutdown();
 };
 
+inline void WorldMeshExtractor::setSeed(uint32_t seed) {
+	_seed = seed;
+}
+
+inline const MeshCache& WorldMeshExtractor::meshCache() const {
+	return _meshCache;
+}
+
+inline const ExtractionScheduler& WorldMeshExtractor::scheduler() const {
+	return _scheduler;
+}
+
 }
\ No newline at end of file
@@ -134,19 +134,21 @@ bool AIDebug::addToHistory(const core::String& host, int port) {
 	return false;
 }
 
-void AIDebug::onMessage(const ai::StateWorld *, const uint8_t *rawData, size_t rawDataLength) {
-	core_assert(lengthof(_stateWorldBuf) > rawDataLength);
-	core_memcpy(_stateWorldBuf, rawData, rawDataLength);
-	const ai::Message *rootMsg = ai::GetMessage(_stateWorldBuf);
-	_stateWorldMsg = (ai::StateWorld *)rootMsg->data();
-	_entityStates.clear();
+void AIDebug::onMessage(const ai::StateWorld *msg, const uint8_t *, size_t rawDataLength) {
 	_stateWorldSize += rawDataLength;
-	if (!_stateWorldMsg->states()) {
+	if (!_hasStateWorld && !msg->full()) {
+		// we missed the full snapshot - the deltas are useless without it
+		if (!_stateRequested) {
+			_stateRequested = true;
+			requestState();
+		}
 		return;
 	}
-	for (const auto &s : *_stateWorldMsg->states()) {
-		_entityStates.put(s->character_id(), s);
+	if (msg->full()) {
+		_stateRequested = false;
 	}
+	_entityStates.apply(msg);
+	_hasStateWorld = true;
 }
 
 void AIDebug::onMessage(const ai::CharacterDetails *, const uint8_t *rawData, size_t rawDataLength) {
@@ -184,7 +186,7 @@ void AIDebug::onMessage(const ai::Names *, const uint8_t *rawData, size_t rawDat
 	_namesMsg = (ai::Names *)rootMsg->data();
 	_state = State::Debugging;
 	_namesSize += rawDataLength;
-	if (_stateWorldMsg != nullptr) {
+	if (_hasStateWorld) {
 		return;
 	}
 	if (_namesMsg->names()->size() > 0) {
@@ -226,12 +228,19 @@ void AIDebug::changeZone(const char *zoneId) {
 	static flatbuffers::FlatBufferBuilder fbb;
 	_chrDetailsMsg = nullptr;
 	_chrStaticMsg = nullptr;
-	_stateWorldMsg = nullptr;
+	_entityStates.clear();
+	_hasStateWorld = false;
+	_stateRequested = false;
 	_zoneId = zoneId;
 	_messageSender->sendMessage(fbb, ai::MsgType::ChangeZone,
 								ai::CreateChangeZone(fbb, fbb.CreateString(zoneId)).Union());
 }
 
+void AIDebug::requestState() const {
+	static flatbuffers::FlatBufferBuilder fbb;
+	_messageSender->sendMessage(fbb, ai::MsgType::RequestState, ai::CreateRequestState(fbb).Union());
+}
+
 void AIDebug::selectEntity(ai::CharacterId entityId) {
 	Log::info("Select entity %" PRIChrId, entityId);
 	static flatbuffers::FlatBufferBuilder fbb;
@@ -271,14 +280,11 @@ bool AIDebug::isSelected(ai::CharacterId entityId) const {
 	return _chrDetailsMsg->character_id() == entityId;
 }
 
-const ai::State *AIDebug::entityState() const {
+const EntityState *AIDebug::entityState() const {
 	if (!hasDetails()) {
 		return nullptr;
 	}
-
-	const ai::State *state;
-	_entityStates.get(_chrDetailsMsg->character_id(), state);
-	return state;
+	return _entityStates.get(_chrDetailsMsg->character_id());
 }
 
 bool AIDebug::dbgConnect() {
@@ -329,7 +335,7 @@ bool AIDebug::dbgConnect() {
 }
 
 void AIDebug::dbgAttributes() {
-	const ai::State *state = entityState();
+	const EntityState *state = entityState();
 	if (state == nullptr) {
 		return;
 	}
@@ -340,14 +346,14 @@ void AIDebug::dbgAttributes() {
 			ImGui::TableSetupColumn("Current", ImGuiTableColumnFlags_WidthStretch);
 			ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_WidthStretch);
 			ImGui::TableHeadersRow();
-			for (const auto &a : *state->attrib()) {
+			for (int i = 0; i < (int)attrib::Type::MAX; ++i) {
 				ImGui::TableNextColumn();
-				const attrib::Type attribType = (attrib::Type)a->key();
+				const attrib::Type attribType = (attrib::Type)i;
 				ImGui::TextUnformatted(network::EnumNameAttribType(attribType));
 				ImGui::TableNextColumn();
-				ImGui::Text("%.2f", a->current());
+				ImGui::Text("%.2f", state->attribCurrent[i]);
 				ImGui::TableNextColumn();
-				ImGui::Text("%.2f", a->max());
+				ImGui::Text("%.2f", state->attribMax[i]);
 			}
 			ImGui::EndTable();
 		}
@@ -356,7 +362,7 @@ void AIDebug::dbgAttributes() {
 }
 
 void AIDebug::dbgMetaAttributes() {
-	const ai::State *state = entityState();
+	const EntityState *state = entityState();
 	if (state == nullptr) {
 		return;
 	}
@@ -367,11 +373,11 @@ void AIDebug::dbgMetaAttributes() {
 			ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
 			ImGui::TableHeadersRow();
 
-			for (const auto &a : *state->meta_attributes()) {
+			for (const EntityState::MetaAttribute &a : state->metaAttributes) {
 				ImGui::TableNextColumn();
-				ImGui::TextUnformatted(a->key()->c_str());
+				ImGui::TextUnformatted(a.key.c_str());
 				ImGui::TableNextColumn();
-				ImGui::TextUnformatted(a->value()->c_str());
+				ImGui::TextUnformatted(a.value.c_str());
 			}
 			ImGui::EndTable();
 		}
@@ -414,8 +420,8 @@ void AIDebug::dbgStats() {
 		if (_namesMsg != nullptr) {
 			ImGui::Text("Zones: %i", (int)_namesMsg->names()->size());
 		}
-		if (_stateWorldMsg != nullptr) {
-			ImGui::Text("Entities: %i", (int)_stateWorldMsg->states()->size());
+		if (_hasStateWorld) {
+			ImGui::Text("Entities: %i", (int)_entityStates.size());
 		}
 		ImGui::Separator();
 		if (ImGui::BeginTable("Network traffic", 2, priv::TableFlags)) {
@@ -446,35 +452,29 @@ void AIDebug::dbgEntities() {
 				ImGui::EndCombo();
 			}
 		}
-		if (_stateWorldMsg != nullptr) {
+		if (_hasStateWorld) {
 			ImGui::InputText(ICON_FA_SEARCH_LOCATION " Filter", _entityListFilter, sizeof(_entityListFilter));
 			if (ImGui::BeginTable("##entitylist", 2, priv::TableFlags)) {
 				ImGui::TableSetupColumn("Id", ImGuiTableColumnFlags_WidthStretch);
 				ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
 				ImGui::TableHeadersRow();
-				for (const auto &e : *_stateWorldMsg->states()) {
-					core::String name = "Unknown";
-					for (const auto &a : *e->meta_attributes()) {
-						if (!SDL_strcmp(ai::attributes::NAME, a->key()->c_str())) {
-							name = a->value()->c_str();
-							break;
-						}
-					}
+				for (const EntityState &e : _entityStates) {
+					const core::String &name = e.name;
 					if (_entityListFilter[0] != '\0') {
 						if (SDL_strstr(name.c_str(), _entityListFilter) == nullptr) {
 							char buf[32];
-							SDL_snprintf(buf, sizeof(buf), "%" PRIChrId, e->character_id());
+							SDL_snprintf(buf, sizeof(buf), "%" PRIChrId, e.id);
 							if (SDL_strstr(buf, _entityListFilter) == nullptr) {
 								continue;
 							}
 						}
 					}
 					ImGui::TableNextColumn();
-					ImGui::Text("%" PRIChrId, e->character_id());
+					ImGui::Text("%" PRIChrId, e.id);
 					ImGui::TableNextColumn();
-					if (ImGui::Selectable(name.c_str(), isSelected(e->character_id()),
+					if (ImGui::Selectable(name.c_str(), isSelected(e.id),
 										  ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
-						selectEntity(e->character_id());
+						selectEntity(e.id);
 					}
 				}
 				ImGui::EndTable();
@@ -566,14 +566,14 @@ void AIDebug::dbgTree() {
 }
 
 void AIDebug::dbgMap() {
-	if (_stateWorldMsg == nullptr || _stateWorldMsg->states() == nullptr) {
+	if (!_hasStateWorld) {
 		return;
 	}
 	if (_centerOnSelection) {
-		for (const auto &e : *_stateWorldMsg->states()) {
-			const bool selected = isSelected(e->character_id());
+		for (const EntityState &e : _entityStates) {
+			const bool selected = isSelected(e.id);
 			if (selected) {
-				_map.centerAtEntPos(e->position()->x(), e->position()->z());
+				_map.centerAtEntPos(e.position.x, e.position.z);
 				break;
 			}
 		}
@@ -609,31 +609,25 @@ void AIDebug::dbgMap() {
 		clipRectMaxs.x += clipRectMins.x;
 		clipRectMaxs.y += clipRectMins.y;
 		draw->PushClipRect(clipRectMins, clipRectMaxs, true);
-		for (const auto &e : *_stateWorldMsg->states()) {
-			const ImVec2& entPos = _map.entPosToMap(e->position()->x(), e->position()->z());
+		for (const EntityState &e : _entityStates) {
+			const ImVec2& entPos = _map.entPosToMap(e.position.x, e.position.z);
 			if (!_map.isVisible(entPos, mapMins, mapMaxs)) {
 				continue;
 			}
-			const float orientation = e->orientation();
+			const float orientation = e.orientation;
 			const glm::vec2 dir(glm::cos(orientation), glm::sin(orientation));
 			ImGui::SetCursorScreenPos({entPos.x - radius, entPos.y - radius});
-			const bool selected = isSelected(e->character_id());
+			const bool selected = isSelected(e.id);
 			ImGui::PushStyleColor(ImGuiCol_HeaderActive, ImGui::GetColorU32(ImGuiCol_HeaderActive, 0.0f));
 			ImGui::PushStyleColor(ImGuiCol_HeaderHovered, ImGui::GetColorU32(ImGuiCol_HeaderHovered, 0.0f));
 			ImGui::PushStyleColor(ImGuiCol_Header, ImGui::GetColorU32(ImGuiCol_Header, 0.0f));
 			if (ImGui::Selectable("##ent", selected, ImGuiSelectableFlags_AllowDoubleClick, entSize)) {
-				selectEntity(e->character_id());
+				selectEntity(e.id);
 			}
 			ImGui::PopStyleColor(3);
 
-			attrib::Values attribCurrent;
-			attrib::Values attribMax;
-			attribCurrent.fill(0.0);
-			attribMax.fill(0.0);
-			for (const auto& a : *e->attrib()) {
-				attribCurrent[a->key()] = a->current();
-				attribMax[a->key()] = a->max();
-			}
+			const attrib::Values& attribCurrent = e.attribCurrent;
+			const attrib::Values& attribMax = e.attribMax;
 
 			const bool hover = ImGui::TooltipText(
 					"ID: %" PRIChrId "\n"
@@ -641,10 +635,10 @@ void AIDebug::dbgMap() {
 					"Home: %f:%f:%f\n"
 					"Target: %f:%f:%f\n"
 					"Strength: %.2f/%.2f",
-					e->character_id(),
-					e->position()->x(), e->position()->y(), e->position()->z(),
-					e->home_position()->x(), e->home_position()->y(), e->home_position()->z(),
-					e->target_position()->x(), e->target_position()->y(), e->target_position()->z(),
+					e.id,
+					e.position.x, e.position.y, e.position.z,
+					e.homePosition.x, e.homePosition.y, e.homePosition.z,
+					e.targetPosition.x, e.targetPosition.y, e.targetPosition.z,
 					attribCurrent[core::enumVal(attrib::Type::STRENGTH)], attribMax[core::enumVal(attrib::Type::STRENGTH)]);
 
 			uint32_t col = entityColor;
@@ -656,8 +650,8 @@ void AIDebug::dbgMap() {
 			draw->AddCircle(entPos, radius, col, 12, 1.0f);
 			draw->AddLine(entPos, {entPos.x + dir.x * radius * 2.0f, entPos.y + dir.y * radius * 2.0f}, col, 1.0f);
 			if (selected) {
-				const ImVec2& homePos = _map.entPosToMap(e->home_position()->x(), e->home_position()->z());
-				const ImVec2& targetPos = _map.entPosToMap(e->target_position()->x(), e->target_position()->z());
+				const ImVec2& homePos = _map.entPosToMap(e.homePosition.x, e.homePosition.z);
+				const ImVec2& targetPos = _map.entPosToMap(e.targetPosition.x, e.targetPosition.z);
 				draw->AddLine(entPos, homePos, homecol, 1.0f);
 				draw->AddLine(entPos, targetPos, targetcol, 1.0f);
 			}
@@ -782,7 +776,8 @@ void AIDebug::onEvent(const network::DisconnectEvent &event) {
 	_nodeStates.clear();
 	_chrDetailsMsg = nullptr;
 	_chrStaticMsg = nullptr;
-	_stateWorldMsg = nullptr;
+	_hasStateWorld = false;
+	_stateRequested = false;
 	_namesMsg = nullptr;
 	_map.reset();
 	_pause = false;
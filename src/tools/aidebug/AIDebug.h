@@ -13,6 +13,7 @@
 #include "network/NetworkEvents.h"
 #include "ui/imgui/IMGUIApp.h"
 #include "Map.h"
+#include "EntityStates.h"
 
 /**
  * @ingroup Tools
@@ -53,13 +54,13 @@ private:
 	uint8_t _chrStaticBuf[32768];
 	ai::CharacterStatic *_chrStaticMsg = nullptr;
 
-	uint8_t _stateWorldBuf[262144];
-	ai::StateWorld *_stateWorldMsg = nullptr;
-
 	uint8_t _namesBuf[32768];
 	ai::Names *_namesMsg = nullptr;
 
-	core::Map<ai::CharacterId, const ai::State*> _entityStates;
+	EntityStates _entityStates;
+	bool _hasStateWorld = false;
+	/** a full snapshot was requested - the deltas until it arrives don't request another one */
+	bool _stateRequested = false;
 	core::Map<int, const ai::StateNodeStatic*> _nodeStates;
 
 	struct Server {
@@ -82,6 +83,7 @@ private:
 
 	void selectEntity(ai::CharacterId entityId);
 	void changeZone(const char* zoneId);
+	void requestState() const;
 	void executeCommand(const core::String& command) const;
 	void togglePause() const;
 	void step() const;
@@ -90,7 +92,7 @@ private:
 	void deleteNode(int nodeId, ai::CharacterId entityId);
 
 	bool hasDetails() const;
-	const ai::State* entityState() const;
+	const EntityState* entityState() const;
 	bool isSelected(ai::CharacterId entityId) const;
 
 	bool dbgConnect();
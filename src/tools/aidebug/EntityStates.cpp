@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#include "EntityStates.h"
+#include "AIMessages_generated.h"
+#include "ai-shared/common/CharacterMetaAttributes.h"
+
+void EntityState::update(const ai::State* state) {
+	id = state->character_id();
+	position = glm::vec3(state->position()->x(), state->position()->y(), state->position()->z());
+	homePosition = glm::vec3(state->home_position()->x(), state->home_position()->y(), state->home_position()->z());
+	targetPosition = glm::vec3(state->target_position()->x(), state->target_position()->y(), state->target_position()->z());
+	orientation = state->orientation();
+	attribCurrent.fill(0.0);
+	attribMax.fill(0.0);
+	for (const auto& a : *state->attrib()) {
+		if (a->key() < 0 || a->key() >= (int)attribCurrent.size()) {
+			continue;
+		}
+		attribCurrent[a->key()] = a->current();
+		attribMax[a->key()] = a->max();
+	}
+	metaAttributes.clear();
+	metaAttributes.reserve(state->meta_attributes()->size());
+	name = "Unknown";
+	for (const auto& a : *state->meta_attributes()) {
+		MetaAttribute attribute;
+		attribute.key = a->key()->c_str();
+		attribute.value = a->value()->c_str();
+		if (attribute.key == ai::attributes::NAME) {
+			name = attribute.value;
+		}
+		metaAttributes.push_back(core::move(attribute));
+	}
+}
+
+int EntityStates::index(ai::CharacterId id) const {
+	int low = 0;
+	int high = (int)_states.size() - 1;
+	while (low <= high) {
+		const int mid = (low + high) / 2;
+		const ai::CharacterId midId = _states[mid].id;
+		if (midId < id) {
+			low = mid + 1;
+		} else if (id < midId) {
+			high = mid - 1;
+		} else {
+			return mid;
+		}
+	}
+	return -(low + 1);
+}
+
+const EntityState* EntityStates::get(ai::CharacterId id) const {
+	const int idx = index(id);
+	if (idx < 0) {
+		return nullptr;
+	}
+	return &_states[idx];
+}
+
+void EntityStates::apply(const ai::StateWorld* msg) {
+	if (msg->full()) {
+		_states.clear();
+	}
+	if (msg->removed() != nullptr) {
+		for (const ai::CharacterId id : *msg->removed()) {
+			const int idx = index(id);
+			if (idx >= 0) {
+				_states.erase(idx);
+			}
+		}
+	}
+	if (msg->states() == nullptr) {
+		return;
+	}
+	for (const auto& s : *msg->states()) {
+		int idx = index(s->character_id());
+		if (idx < 0) {
+			// insert at the position that keeps the states sorted
+			idx = -idx - 1;
+			_states.insert(_states.begin() + idx, EntityState());
+		}
+		_states[idx].update(s);
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ai-shared/common/CharacterId.h"
+#include "attrib/ContainerValues.h"
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+
+namespace ai {
+struct StateWorld;
+struct State;
+}
+
+/**
+ * @brief The last known state of a character of the debugged zone
+ */
+struct EntityState {
+	ai::CharacterId id = 0;
+	glm::vec3 position {0.0f};
+	glm::vec3 homePosition {0.0f};
+	glm::vec3 targetPosition {0.0f};
+	float orientation = 0.0f;
+	attrib::Values attribCurrent;
+	attrib::Values attribMax;
+	struct MetaAttribute {
+		core::String key;
+		core::String value;
+	};
+	core::DynamicArray<MetaAttribute> metaAttributes;
+	core::String name;
+
+	void update(const ai::State* state);
+};
+
+/**
+ * @brief Collects the character states of the incremental @c ai::StateWorld messages
+ *
+ * The server only sends the characters that were added, removed or changed since the last message -
+ * this is the combined view of the debugged zone.
+ */
+class EntityStates {
+private:
+	/** sorted by character id */
+	core::DynamicArray<EntityState> _states;
+
+	int index(ai::CharacterId id) const;
+public:
+	void apply(const ai::StateWorld* msg);
+	void clear();
+
+	/**
+	 * @return @c nullptr if the character isn't known
+	 */
+	const EntityState* get(ai::CharacterId id) const;
+
+	size_t size() const;
+	bool empty() const;
+
+	inline auto begin() const {
+		return _states.begin();
+	}
+
+	inline auto end() const {
+		return _states.end();
+	}
+};
+
+inline void EntityStates::clear() {
+	_states.clear();
+}
+
+inline size_t EntityStates::size() const {
+	return _states.size();
+}
+
+inline bool EntityStates::empty() const {
+	return _states.empty();
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "AIMessages_generated.h"
+#include "../EntityStates.h"
+
+class EntityStatesTest: public app::AbstractTest {
+protected:
+	flatbuffers::FlatBufferBuilder _fbb;
+
+	flatbuffers::Offset<ai::State> state(ai::CharacterId id, float x) {
+		const ai::Vec3 position(x, 0.0f, 0.0f);
+		const ai::Vec3 zero(0.0f, 0.0f, 0.0f);
+		auto metaAttributes = _fbb.CreateVector<flatbuffers::Offset<ai::MapEntry>>(0, [] (size_t) {
+			return flatbuffers::Offset<ai::MapEntry>();
+		});
+		auto attributes = _fbb.CreateVector<flatbuffers::Offset<ai::AttribEntry>>(0, [] (size_t) {
+			return flatbuffers::Offset<ai::AttribEntry>();
+		});
+		return ai::CreateState(_fbb, id, &position, &zero, &zero, 0.0f, metaAttributes, attributes);
+	}
+
+	const ai::StateWorld* finish(const core::DynamicArray<flatbuffers::Offset<ai::State>>& states, bool full,
+			const core::DynamicArray<ai::CharacterId>& removed) {
+		auto stateVector = _fbb.CreateVector(states.data(), states.size());
+		auto removedVector = _fbb.CreateVector(removed.data(), removed.size());
+		_fbb.Finish(ai::CreateMessage(_fbb, ai::MsgType::StateWorld,
+			ai::CreateStateWorld(_fbb, stateVector, full, removedVector).Union()));
+		return ai::GetMessage(_fbb.GetBufferPointer())->data_as_StateWorld();
+	}
+};
+
+TEST_F(EntityStatesTest, testFullAndDelta) {
+	EntityStates entityStates;
+	core::DynamicArray<flatbuffers::Offset<ai::State>> states;
+	core::DynamicArray<ai::CharacterId> removed;
+	states.push_back(state(3, 3.0f));
+	states.push_back(state(1, 1.0f));
+	states.push_back(state(2, 2.0f));
+	entityStates.apply(finish(states, true, removed));
+	ASSERT_EQ(3u, entityStates.size());
+	ai::CharacterId expected = 1;
+	for (const EntityState& e : entityStates) {
+		EXPECT_EQ(expected++, e.id) << "The states must be sorted by id";
+	}
+
+	_fbb.Clear();
+	states.clear();
+	states.push_back(state(1, 10.0f));
+	states.push_back(state(4, 4.0f));
+	removed.push_back(2);
+	entityStates.apply(finish(states, false, removed));
+	ASSERT_EQ(3u, entityStates.size());
+	EXPECT_EQ(nullptr, entityStates.get(2));
+	ASSERT_NE(nullptr, entityStates.get(1));
+	EXPECT_FLOAT_EQ(10.0f, entityStates.get(1)->position.x);
+	ASSERT_NE(nullptr, entityStates.get(3));
+	EXPECT_FLOAT_EQ(3.0f, entityStates.get(3)->position.x) << "Unchanged states must be kept";
+	ASSERT_NE(nullptr, entityStates.get(4));
+
+	_fbb.Clear();
+	states.clear();
+	removed.clear();
+	states.push_back(state(5, 5.0f));
+	entityStates.apply(finish(states, true, removed));
+	ASSERT_EQ(1u, entityStates.size()) << "A full snapshot must replace all known states";
+	EXPECT_NE(nullptr, entityStates.get(5));
+}
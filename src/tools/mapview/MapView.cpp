@@ -163,6 +163,11 @@ app::AppState MapView::onInit() {
 
 	_worldMgr->setSeed(1);
 	_worldPager->setSeed(1);
+	_worldRenderer.setSeed(_worldMgr->seed());
+	const voxelworld::WorldPagerPtr& worldPager = _worldPager;
+	_worldRenderer.setTerrainSurface([worldPager] (int x, int z, voxel::Voxel& surface) {
+		return worldPager->surface(x, z, surface);
+	});
 
 	if (!_worldRenderer.init(_worldMgr->volumeData(), glm::ivec2(0), _frameBufferDimension)) {
 		Log::error("Failed to init world renderer");
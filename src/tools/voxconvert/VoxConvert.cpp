@@ -5,6 +5,8 @@
 #include "VoxConvert.h"
 #include "core/Color.h"
 #include "core/Var.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
 #include "command/Command.h"
 #include "io/Filesystem.h"
 #include "metric/Metric.h"
@@ -16,7 +18,7 @@
 #include "voxelutil/VolumeRescaler.h"
 
 VoxConvert::VoxConvert(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
-		Super(metric, filesystem, eventBus, timeProvider) {
+		Super(metric, filesystem, eventBus, timeProvider, core::halfcpus()) {
 	init(ORGANISATION, "voxconvert");
 	_initialLogLevel = SDL_LOG_PRIORITY_ERROR;
 }
@@ -41,6 +43,8 @@ app::AppState VoxConvert::onConstruct() {
 	_withColor->setHelp("Export with vertex colors");
 	_withTexCoords = core::Var::get("voxformat_withtexcoords", "true", core::CV_NOPERSIST);
 	_withTexCoords->setHelp("Export with uv coordinates of the palette image");
+	_binary = core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST);
+	_binary->setHelp("Export as binary file if the format supports it (ply)");
 	_palette = core::Var::get("palette", voxel::getDefaultPaletteName());
 	_palette->setHelp("This is the NAME part of palette-<NAME>.png or absolute png file to use (1x256)");
 
@@ -86,6 +90,7 @@ app::AppState VoxConvert::onInit() {
 		Log::info("* quads:            - %s", _quads->strVal().c_str());
 		Log::info("* withColor:        - %s", _withColor->strVal().c_str());
 		Log::info("* withTexCoords:    - %s", _withTexCoords->strVal().c_str());
+		Log::info("* binary:           - %s", _binary->strVal().c_str());
 	}
 	Log::info("* infile:           - %s", infile.c_str());
 	Log::info("* outfile:          - %s", outfile.c_str());
@@ -119,7 +124,7 @@ app::AppState VoxConvert::onInit() {
 
 	if (mergeVolumes) {
 		Log::info("Merge layers");
-		voxel::RawVolume* merged = volumes.merge();
+		voxel::RawVolume* merged = volumes.merge(&threadPool());
 		if (merged == nullptr) {
 			Log::error("Failed to merge volumes");
 			return app::AppState::InitFailure;
@@ -136,7 +141,7 @@ app::AppState VoxConvert::onInit() {
 			const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
 			if (destRegion.isValid()) {
 				voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-				rescaleVolume(*v.volume, *destVolume);
+				rescaleVolume(threadPool(), *v.volume, *destVolume);
 				delete v.volume;
 				v.volume = destVolume;
 			}
@@ -5,6 +5,7 @@
 #include "VoxEdit.h"
 #include "app/App.h"
 #include "core/Color.h"
+#include "core/concurrent/Concurrency.h"
 #include "voxel/MaterialColor.h"
 #include "metric/Metric.h"
 #include "core/TimeProvider.h"
@@ -24,7 +25,7 @@
 #endif
 
 VoxEdit::VoxEdit(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
-		Super(metric, filesystem, eventBus, timeProvider) {
+		Super(metric, filesystem, eventBus, timeProvider, core::halfcpus()) {
 	init(ORGANISATION, "voxedit");
 	_allowRelativeMouseMode = false;
 }
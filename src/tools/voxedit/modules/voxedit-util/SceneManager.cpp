@@ -133,7 +133,7 @@ bool SceneManager::importHeightmap(const core::String& file) {
 	}
 	voxel::RawVolumeWrapper wrapper(v);
 	voxedit::importHeightmap(wrapper, img);
-	modified(layerId, wrapper.dirtyRegion());
+	modified(layerId, wrapper);
 	return true;
 }
 
@@ -323,36 +323,33 @@ void SceneManager::handleAnimationViewUpdate(int layerId) {
 }
 
 void SceneManager::queueRegionExtraction(int layerId, const voxel::Region& region) {
-	bool addNew = true;
-	for (const auto& r : _extractRegions) {
-		if (r.layer != layerId) {
-			continue;
-		}
-		if (r.region.containsRegion(region)) {
-			addNew = false;
-			break;
-		}
-	}
-	if (addNew) {
-		_extractRegions.push_back({region, layerId});
-	}
+	_volumeRenderer.markDirty(layerId, region);
 }
 
-void SceneManager::modified(int layerId, const voxel::Region& modifiedRegion, bool markUndo) {
+void SceneManager::markModified(int layerId, const voxel::Region& modifiedRegion, bool markUndo) {
 	Log::debug("Modified layer %i, undo state: %s", layerId, markUndo ? "true" : "false");
 	voxel::logRegion("Modified", modifiedRegion);
 	if (markUndo) {
 		_mementoHandler.markUndo(layerId, _layerMgr.layer(layerId).name, _volumeRenderer.volume(layerId), MementoType::Modification, modifiedRegion);
 	}
-	if (modifiedRegion.isValid()) {
-		queueRegionExtraction(layerId, modifiedRegion);
-	}
 	_dirty = true;
 	_needAutoSave = true;
 	handleAnimationViewUpdate(layerId);
 	resetLastTrace();
 }
 
+void SceneManager::modified(int layerId, const voxel::Region& modifiedRegion, bool markUndo) {
+	if (modifiedRegion.isValid()) {
+		queueRegionExtraction(layerId, modifiedRegion);
+	}
+	markModified(layerId, modifiedRegion, markUndo);
+}
+
+void SceneManager::modified(int layerId, const voxel::RawVolumeWrapper& wrapper, bool markUndo) {
+	_volumeRenderer.markDirty(layerId, wrapper.dirtyBricks());
+	markModified(layerId, wrapper.dirtyRegion(), markUndo);
+}
+
 void SceneManager::colorToNewLayer(const voxel::Voxel voxelColor) {
 	voxel::RawVolume* newVolume = new voxel::RawVolume(region());
 	_layerMgr.foreachGroupLayer([&] (int layerId) {
@@ -363,7 +360,7 @@ void SceneManager::colorToNewLayer(const voxel::Voxel voxelColor) {
 				wrapper.setVoxel(x, y, z, voxel::Voxel());
 			}
 		});
-		modified(layerId, wrapper.dirtyRegion());
+		modified(layerId, wrapper);
 	});
 	const core::String& name = core::string::format("color: %i", (int)voxelColor.getColor());
 	_layerMgr.addLayer(name.c_str(), true, newVolume);
@@ -382,7 +379,7 @@ void SceneManager::scale(int layerId) {
 	}
 	const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
 	voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-	rescaleVolume(*srcVolume, *destVolume);
+	rescaleVolume(app::App::getInstance()->threadPool(), *srcVolume, *destVolume);
 	setNewVolume(layerId, destVolume, true);
 	modified(layerId, srcRegion);
 }
@@ -538,7 +535,7 @@ bool SceneManager::merge(int layerId1, int layerId2) {
 	if (volumes[1] == nullptr) {
 		return false;
 	}
-	voxel::RawVolume* volume = voxel::merge(volumes);
+	voxel::RawVolume* volume = voxel::merge(app::App::getInstance()->threadPool(), volumes);
 	if (!setNewVolume(layerId1, volume, true)) {
 		delete volume;
 		return false;
@@ -658,17 +655,18 @@ void SceneManager::rotate(int layerId, const glm::ivec3& angle, bool increaseSiz
 	if (model == nullptr) {
 		return;
 	}
+	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
 	voxel::RawVolume* newVolume;
 	const bool axisRotation = !rotateAroundReferencePosition && !increaseSize;
 	if (axisRotation && angle == glm::ivec3(90, 0, 0)) {
-		newVolume = voxel::rotateAxis(model, math::Axis::X);
+		newVolume = voxel::rotateAxis(threadPool, model, math::Axis::X);
 	} else if (axisRotation && angle == glm::ivec3(0, 90, 0)) {
-		newVolume = voxel::rotateAxis(model, math::Axis::Y);
+		newVolume = voxel::rotateAxis(threadPool, model, math::Axis::Y);
 	} else if (axisRotation && angle == glm::ivec3(0, 0, 90)) {
-		newVolume = voxel::rotateAxis(model, math::Axis::Z);
+		newVolume = voxel::rotateAxis(threadPool, model, math::Axis::Z);
 	} else {
 		const glm::vec3 pivot = rotateAroundReferencePosition ? glm::vec3(referencePosition()) : model->region().getCenterf();
-		newVolume = voxel::rotateVolume(model, angle, voxel::Voxel(), pivot, increaseSize);
+		newVolume = voxel::rotateVolume(threadPool, model, angle, voxel::Voxel(), pivot, increaseSize);
 	}
 	voxel::Region r = newVolume->region();
 	r.accumulate(model->region());
@@ -1337,6 +1335,7 @@ void SceneManager::construct() {
 	core::Var::get("voxformat_quads", "true", core::CV_NOPERSIST)->setHelp("Export as quads. If this false, triangles will be used.");
 	core::Var::get("voxformat_withcolor", "true", core::CV_NOPERSIST)->setHelp("Export with vertex colors");
 	core::Var::get("voxformat_withtexcoords", "true", core::CV_NOPERSIST)->setHelp("Export with uv coordinates of the palette image");
+	core::Var::get("voxformat_binary", "false", core::CV_NOPERSIST)->setHelp("Export as binary file if the format supports it (ply)");
 	core::Var::get("palette", voxel::getDefaultPaletteName())->setHelp("This is the NAME part of palette-<NAME>.png or absolute png file to use (1x256)");
 }
 
@@ -1346,7 +1345,7 @@ void SceneManager::flip(math::Axis axis) {
 		if (model == nullptr) {
 			return;
 		}
-		voxel::RawVolume* newVolume = voxel::mirrorAxis(model, axis);
+		voxel::RawVolume* newVolume = voxel::mirrorAxis(app::App::getInstance()->threadPool(), model, axis);
 		voxel::Region r = newVolume->region();
 		r.accumulate(model->region());
 		setNewVolume(layerId, newVolume);
@@ -1378,10 +1377,10 @@ void SceneManager::setVoxelsForCondition(std::function<voxel::Voxel()> voxel, st
 			wrapper.setRegion(selection);
 		}
 		const int cnt = voxelutil::visitVolume(wrapper, [&] (int32_t x, int32_t y, int32_t z, const voxel::Voxel&) {
-			v->setVoxel(x, y, z, voxel());
+			wrapper.setVoxel(x, y, z, voxel());
 		}, condition);
 		if (cnt > 0) {
-			modified(layerId, wrapper.dirtyRegion());
+			modified(layerId, wrapper);
 			Log::debug("Modified %i voxels", cnt);
 		}
 	});
@@ -1490,7 +1489,7 @@ bool SceneManager::runScript(const core::String& script, const core::DynamicArra
 		wrapper.setRegion(selection);
 	}
 	const bool retVal = _luaGenerator.exec(script, &wrapper, wrapper.region(), _modifier.cursorVoxel(), args);
-	modified(layerId, wrapper.dirtyRegion());
+	modified(layerId, wrapper);
 	return retVal;
 }
 
@@ -1530,6 +1529,10 @@ void SceneManager::zoom(video::Camera& camera, float level) const {
 }
 
 void SceneManager::update(double nowSeconds) {
+	if (_camera != nullptr) {
+		// the level of detail is shared by all viewports - the active camera is the reference
+		_volumeRenderer.updateLOD(_camera->position());
+	}
 	_volumeRenderer.update();
 	for (int i = 0; i < lengthof(DIRECTIONS); ++i) {
 		if (!_move[i].pressed()) {
@@ -1727,20 +1730,11 @@ bool SceneManager::loadAnimationEntity(const core::String& luaFile) {
 
 bool SceneManager::extractVolume() {
 	core_trace_scoped(SceneManagerExtract);
-	const size_t n = _extractRegions.size();
+	const int n = _volumeRenderer.scheduleExtractions();
 	if (n <= 0) {
 		return false;
 	}
-	Log::debug("Extract the meshes for %i regions", (int)n);
-	for (size_t i = 0; i < n; ++i) {
-		const voxel::Region& region = _extractRegions[i].region;
-		if (!_volumeRenderer.extractRegion(_extractRegions[i].layer, region)) {
-			Log::error("Failed to extract the model mesh");
-		}
-		Log::debug("Extract layer %i", _extractRegions[i].layer);
-		voxel::logRegion("Extraction", region);
-	}
-	_extractRegions.clear();
+	Log::debug("Extract the meshes for %i cells", n);
 	return true;
 }
 
@@ -1756,7 +1750,7 @@ void SceneManager::noise(int octaves, float lacunarity, float frequency, float g
 	if (!wrapper.dirtyRegion().isValid()) {
 		return;
 	}
-	modified(layerId, wrapper.dirtyRegion());
+	modified(layerId, wrapper);
 }
 
 void SceneManager::lsystem(const core::String &axiom, const core::DynamicArray<voxelgenerator::lsystem::Rule> &rules, float angle, float length,
@@ -1765,7 +1759,7 @@ void SceneManager::lsystem(const core::String &axiom, const core::DynamicArray<v
 	const int layerId = _layerMgr.activeLayer();
 	voxel::RawVolumeWrapper wrapper(volume(layerId));
 	voxelgenerator::lsystem::generate(wrapper, referencePosition(), axiom, rules, angle, length, width, widthIncrement, iterations, random, leavesRadius);
-	modified(layerId, wrapper.dirtyRegion());
+	modified(layerId, wrapper);
 }
 
 void SceneManager::createTree(const voxelgenerator::TreeContext& ctx) {
@@ -1773,7 +1767,7 @@ void SceneManager::createTree(const voxelgenerator::TreeContext& ctx) {
 	const int layerId = _layerMgr.activeLayer();
 	voxel::RawVolumeWrapper wrapper(volume(layerId));
 	voxelgenerator::tree::createTree(wrapper, ctx, random);
-	modified(layerId, wrapper.dirtyRegion());
+	modified(layerId, wrapper);
 }
 
 void SceneManager::setReferencePosition(const glm::ivec3& pos) {
@@ -8,6 +8,7 @@
 #include "core/collection/DynamicArray.h"
 #include "voxelutil/Picking.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
 #include "voxelgenerator/TreeContext.h"
 #include "voxelgenerator/LSystem.h"
 #include "voxelgenerator/NoiseGenerator.h"
@@ -114,13 +115,12 @@ private:
 
 	math::Axis _lockedAxis = math::Axis::None;
 
-	struct DirtyRegion {
-		voxel::Region region;
-		int layer;
-	};
-	using RegionQueue = core::DynamicArray<DirtyRegion>;
-	RegionQueue _extractRegions;
+	/**
+	 * @brief The affected mesh cells are collected in the renderer and extracted once per frame
+	 * @sa extractVolume()
+	 */
 	void queueRegionExtraction(int layerId, const voxel::Region& region);
+	void markModified(int layerId, const voxel::Region& modifiedRegion, bool markUndo);
 
 	bool _dirty = false;
 	// this is basically the same as the dirty state, but we stop
@@ -257,6 +257,10 @@ public:
 	const glm::ivec3& referencePosition() const;
 
 	void modified(int layerId, const voxel::Region& modifiedRegion, bool markUndo = true);
+	/**
+	 * @brief Only re-extracts the mesh cells that contain the dirty bricks of the given wrapper
+	 */
+	void modified(int layerId, const voxel::RawVolumeWrapper& wrapper, bool markUndo = true);
 	voxel::RawVolume* volume(int idx);
 	const voxel::RawVolume* volume(int idx) const;
 